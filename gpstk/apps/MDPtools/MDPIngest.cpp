@@ -0,0 +1,733 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2007, The University of Texas at Austin
+//
+//============================================================================
+
+/** @file Reads MDP from many receivers at once */
+
+#include <deque>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/epoll.h>
+
+#include "StringUtils.hpp"
+#include "TCPStreamBuff.hpp"
+#include "MDPIngest.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+// The epoll data of the wake pipe; the sources use their index
+static const uint32_t wakeId = 0xffffffff;
+
+static double wallClock()
+{
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1.e-6;
+}
+
+
+//-----------------------------------------------------------------------------
+// A receiver: where its bytes come from, its queue of messages and its
+// processors. It is the task the pool runs to empty the queue.
+class MDPIngest::Source : public ThreadPool::Task
+{
+public:
+   struct Message
+   {
+      string raw;        ///< header and body
+      double received;   ///< wall clock time it was read
+   };
+
+   Source(MDPIngest& ingest, int index, FDStreamBuff* buff,
+          const string& name);
+   ~Source();
+
+   // Processes the queue until it is empty
+   virtual void run() throw();
+
+   MDPIngest& ingest;
+   int index;
+   string name;
+   FDStreamBuff* buff;
+   vector<MDPProcessor*> pipeline;
+
+   // Only used by the worker serving the source
+   vector<bool> stopped; ///< processors that are past their stopTime
+   size_t running;       ///< processors not stopped
+
+   // Only used by the thread in MDPIngest::run()
+   string pending;       ///< bytes read and not yet framed
+   bool open;            ///< still to be read
+
+   // These are guarded by the lock
+   mutable pthread_mutex_t lock;
+   deque<Message> queue;
+   bool scheduled;       ///< submitted to the pool, or running
+   bool paused;          ///< not read until a worker takes the queue
+   bool finished;        ///< every processor stopped; to be closed
+   Counters counters;
+
+private:
+   // Decodes a message and runs it through the pipeline
+   void process(const Message& msg, Counters& done);
+
+   // Decodes the body of a message of type M; false on a bad CRC
+   template <class M>
+   bool dispatch(const MDPHeader& header, const Message& msg);
+};
+
+
+//-----------------------------------------------------------------------------
+MDPIngest::Counters::Counters()
+   : bytes(0), skipped(0), messages(0), processed(0), crcErrors(0),
+     unknown(0), stalls(0), latencySum(0), latencyMax(0)
+{}
+
+
+//-----------------------------------------------------------------------------
+MDPIngest::Source::Source(MDPIngest& ingest, int index, FDStreamBuff* buff,
+                          const string& name)
+   : ingest(ingest), index(index), name(name), buff(buff), running(0),
+     open(true), scheduled(false), paused(false), finished(false)
+{
+   pthread_mutex_init(&lock, NULL);
+}
+
+
+MDPIngest::Source::~Source()
+{
+   delete buff;
+   pthread_mutex_destroy(&lock);
+}
+
+
+void MDPIngest::Source::run() throw()
+{
+   deque<Message> batch;
+   for (;;)
+   {
+      pthread_mutex_lock(&lock);
+      if (queue.empty())
+      {
+         scheduled = false;
+         pthread_mutex_unlock(&lock);
+         return;
+      }
+      batch.swap(queue);
+      bool wasPaused = paused;
+      pthread_mutex_unlock(&lock);
+
+      // The queue is empty now; the source may be read again.
+      if (wasPaused)
+         ingest.wake();
+
+      Counters done;
+      for (; !batch.empty(); batch.pop_front())
+         process(batch.front(), done);
+
+      pthread_mutex_lock(&lock);
+      counters.processed += done.processed;
+      counters.crcErrors += done.crcErrors;
+      counters.unknown += done.unknown;
+      counters.latencySum += done.latencySum;
+      if (done.latencyMax > counters.latencyMax)
+         counters.latencyMax = done.latencyMax;
+      pthread_mutex_unlock(&lock);
+   }
+}
+
+
+void MDPIngest::Source::process(const Message& msg, Counters& done)
+{
+   // What is still queued once every processor has stopped is dropped
+   if (!running && !pipeline.empty())
+      return;
+
+   MDPHeader header;
+   header.clear(fmtbit | lenbit | crcbit);
+   header.decode(msg.raw.substr(0, MDPHeader::myLength));
+
+   bool ok;
+   switch (header.id)
+   {
+      case MDPObsEpoch::myId:
+         ok = dispatch<MDPObsEpoch>(header, msg);
+         break;
+      case MDPPVTSolution::myId:
+         ok = dispatch<MDPPVTSolution>(header, msg);
+         break;
+      case MDPNavSubframe::myId:
+         ok = dispatch<MDPNavSubframe>(header, msg);
+         break;
+      case MDPSelftestStatus::myId:
+         ok = dispatch<MDPSelftestStatus>(header, msg);
+         break;
+      default:
+         done.unknown++;
+         return;
+   }
+
+   if (!ok)
+   {
+      done.crcErrors++;
+      return;
+   }
+
+   done.processed++;
+   double latency = wallClock() - msg.received;
+   done.latencySum += latency;
+   if (latency > done.latencyMax)
+      done.latencyMax = latency;
+}
+
+
+template <class M>
+bool MDPIngest::Source::dispatch(const MDPHeader& header, const Message& msg)
+{
+   // As MDPHeader::reallyGetRecord() does it
+   M m;
+   static_cast<MDPHeader&>(m) = header;
+   m.setstate(crcbit);
+   m.checkCRC(msg.raw);
+   if (m.crcerr())
+      return false;
+   m.decode(msg.raw.substr(MDPHeader::myLength));
+
+   // A processor is done once a message is past its stopTime, as its
+   // process() returns then.
+   try
+   {
+      for (size_t i = 0; i < pipeline.size(); i++)
+      {
+         if (!stopped[i] && !pipeline[i]->processMessage(m))
+         {
+            stopped[i] = true;
+            running--;
+         }
+      }
+   }
+   catch (gpstk::Exception& e)
+   {
+      cerr << name << ": " << e << endl;
+   }
+   catch (std::exception& e)
+   {
+      cerr << name << ": " << e.what() << endl;
+   }
+
+   // Then the source need not be read any more
+   if (!running && !pipeline.empty())
+   {
+      pthread_mutex_lock(&lock);
+      finished = true;
+      pthread_mutex_unlock(&lock);
+      ingest.wake();
+   }
+   return true;
+}
+
+
+//-----------------------------------------------------------------------------
+MDPIngest::MDPIngest(unsigned workers, unsigned queueLength)
+   throw(gpstk::Exception)
+   : reportInterval(0), reportStream(&cout), pool(NULL),
+     queueLength(queueLength ? queueLength : 1), stopping(false),
+     startTime(wallClock()), active(0)
+{
+   epfd = ::epoll_create(16);
+   if (epfd < 0)
+   {
+      Exception e(string("epoll_create: ") + strerror(errno));
+      GPSTK_THROW(e);
+   }
+
+   if (::pipe(wakeFds) < 0)
+   {
+      ::close(epfd);
+      Exception e(string("pipe: ") + strerror(errno));
+      GPSTK_THROW(e);
+   }
+   for (int i = 0; i < 2; i++)
+      ::fcntl(wakeFds[i], F_SETFL, ::fcntl(wakeFds[i], F_GETFL) | O_NONBLOCK);
+
+   struct epoll_event ev;
+   ev.events = EPOLLIN;
+   ev.data.u32 = wakeId;
+   ::epoll_ctl(epfd, EPOLL_CTL_ADD, wakeFds[0], &ev);
+
+   // Without threads the pipelines run in run()'s thread.
+   try
+   {
+      pool = new ThreadPool(workers);
+   }
+   catch (Exception& e)
+   {
+      pool = NULL;
+   }
+}
+
+
+MDPIngest::~MDPIngest()
+{
+   delete pool;
+   for (size_t i = 0; i < sources.size(); i++)
+      delete sources[i];
+   ::close(wakeFds[0]);
+   ::close(wakeFds[1]);
+   ::close(epfd);
+}
+
+
+//-----------------------------------------------------------------------------
+int MDPIngest::addSource(const string& target)
+   throw(gpstk::Exception)
+{
+   if (target.substr(0, 4) == "tcp:")
+   {
+      string host = target.substr(4);
+      int port = 25;
+      string::size_type i = host.find(":");
+      if (i < host.size())
+      {
+         port = StringUtils::asInt(host.substr(i+1));
+         host.erase(i);
+      }
+
+      TCPStreamBuff* tcpbuff = new TCPStreamBuff();
+      if (tcpbuff->connect(SocketAddr(IPaddress(host), port)))
+      {
+         delete tcpbuff;
+         Exception e("Could not connect to " + target);
+         GPSTK_THROW(e);
+      }
+      int fd = tcpbuff->handle;
+      tcpbuff->handle = -1;
+      delete tcpbuff;
+      return addSource(fd, target);
+   }
+
+   if (target.substr(0, 4) == "ser:")
+   {
+      // Raw, blocking, as a DeviceStream opens it, but a read returns
+      // whatever has come in.
+      int fd = ::open(target.substr(4).c_str(), O_RDWR | O_NOCTTY);
+      if (fd < 0)
+      {
+         Exception e("Could not open " + target + ": " + strerror(errno));
+         GPSTK_THROW(e);
+      }
+      ::fcntl(fd, F_SETFL, 0);
+
+      struct termios options;
+      ::tcgetattr(fd, &options);
+      options.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR
+                           | IGNCR | ICRNL | IXON);
+      options.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHONL | ISIG | IEXTEN);
+      options.c_oflag &= ~OPOST;
+      options.c_cflag &= ~(CSIZE | PARENB);
+      options.c_cflag |= CS8 | CREAD | HUPCL | CLOCAL;
+      options.c_cc[VTIME] = 0;
+      options.c_cc[VMIN] = 1;
+      ::cfsetospeed(&options, B115200);
+      ::cfsetispeed(&options, B115200);
+      if (::tcsetattr(fd, TCSANOW, &options))
+      {
+         ::close(fd);
+         Exception e("Could not set up " + target + ": " + strerror(errno));
+         GPSTK_THROW(e);
+      }
+      return addSource(fd, target);
+   }
+
+   Exception e("Not a tcp: or ser: target: " + target);
+   GPSTK_THROW(e);
+}
+
+
+int MDPIngest::addSource(int fd, const string& name)
+   throw(gpstk::Exception)
+{
+   Source* src = new Source(*this, sources.size(), new FDStreamBuff(fd), name);
+
+   struct epoll_event ev;
+   ev.events = EPOLLIN;
+   ev.data.u32 = src->index;
+   if (::epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+   {
+      delete src;
+      Exception e("Can not wait on " + name + ": " + strerror(errno));
+      GPSTK_THROW(e);
+   }
+
+   sources.push_back(src);
+   active++;
+   return sources.size() - 1;
+}
+
+
+void MDPIngest::addProcessor(int rx, MDPProcessor* proc)
+{
+   Source& src = *sources.at(rx);
+   src.pipeline.push_back(proc);
+   src.stopped.push_back(false);
+   src.running++;
+}
+
+
+//-----------------------------------------------------------------------------
+void MDPIngest::run()
+   throw(gpstk::Exception)
+{
+   const int maxEvents = 64;
+   struct epoll_event events[maxEvents];
+   vector<char> chunk(65536);
+
+   startTime = wallClock();
+   double lastReport = startTime;
+
+   while (!stopping && active > 0)
+   {
+      int timeout = -1;
+      if (reportInterval > 0 && reportStream)
+      {
+         double left = lastReport + reportInterval - wallClock();
+         timeout = left > 0 ? int(left * 1000) + 1 : 0;
+      }
+
+      int n = ::epoll_wait(epfd, events, maxEvents, timeout);
+      if (n < 0 && errno != EINTR)
+      {
+         Exception e(string("epoll_wait: ") + strerror(errno));
+         GPSTK_THROW(e);
+      }
+
+      double now = wallClock();
+      bool woken = false;
+      for (int i = 0; i < n; i++)
+      {
+         if (events[i].data.u32 == wakeId)
+         {
+            while (::read(wakeFds[0], &chunk[0], chunk.size()) > 0)
+               ;
+            woken = true;
+            continue;
+         }
+
+         // Level triggered and blocking: one read per wakeup never blocks.
+         Source& src = *sources[events[i].data.u32];
+         int got = src.buff->read(&chunk[0], chunk.size());
+         if (got > 0)
+         {
+            src.pending.append(&chunk[0], got);
+            pthread_mutex_lock(&src.lock);
+            src.counters.bytes += got;
+            pthread_mutex_unlock(&src.lock);
+         }
+         else
+            close(src);
+
+         if (!frame(src, now))
+            pause(src);
+         else if (!src.open)
+            active--;
+      }
+
+      if (woken)
+      {
+         for (size_t i = 0; i < sources.size(); i++)
+         {
+            finish(*sources[i], now);
+            resume(*sources[i], now);
+         }
+      }
+
+      if (reportInterval > 0 && reportStream &&
+          now - lastReport >= reportInterval)
+      {
+         dumpCounters(*reportStream);
+         lastReport = now;
+      }
+   }
+
+   // Stopped early: hang up on the receivers still open, so that none is
+   // left blocked sending to a connection that is no longer read.
+   if (stopping)
+   {
+      for (size_t i = 0; i < sources.size(); i++)
+      {
+         if (!sources[i]->open)
+            continue;
+         close(*sources[i]);
+         sources[i]->buff->close();
+      }
+   }
+
+   if (pool)
+      pool->wait();
+}
+
+
+void MDPIngest::stop()
+{
+   stopping = true;
+   wake();
+}
+
+
+void MDPIngest::wake()
+{
+   char c = 0;
+   if (::write(wakeFds[1], &c, 1) < 0)
+      return;   // the pipe is full, so a wakeup is pending anyway
+}
+
+
+//-----------------------------------------------------------------------------
+bool MDPIngest::frame(Source& src, double now)
+{
+   const string& buf = src.pending;
+   const char fw = char(MDPHeader::frameWord & 0xff);
+   string::size_type pos = 0, skipped = 0;
+   bool room = true;
+   Source::Message msg;
+   msg.received = now;
+
+   for (;;)
+   {
+      // The frame word is two identical bytes, so it is looked for at
+      // every byte; a receiver need not start on an even one.
+      string::size_type start = pos;
+      while (pos + 1 < buf.size() && !(buf[pos] == fw && buf[pos+1] == fw))
+         pos++;
+      skipped += pos - start;
+
+      if (buf.size() - pos < MDPHeader::myLength)
+         break;
+
+      MDPHeader header;
+      header.decode(buf.substr(pos, MDPHeader::myLength));
+      if (header.length < MDPHeader::myLength)
+      {
+         // Insane header; look again one byte on
+         pos++;
+         skipped++;
+         continue;
+      }
+
+      if (buf.size() - pos < header.length)
+         break;
+
+      msg.raw.assign(buf, pos, header.length);
+
+      pthread_mutex_lock(&src.lock);
+      if (src.queue.size() >= queueLength)
+      {
+         if (!src.paused)
+            src.counters.stalls++;
+         src.paused = true;
+         room = false;
+         pthread_mutex_unlock(&src.lock);
+         break;
+      }
+      src.queue.push_back(msg);
+      src.counters.messages++;
+      bool submit = !src.scheduled;
+      src.scheduled = true;
+      pthread_mutex_unlock(&src.lock);
+
+      if (submit)
+      {
+         if (pool)
+            pool->submit(&src);
+         else
+            src.run();
+      }
+
+      pos += header.length;
+   }
+
+   // Nothing more will come to complete the last message
+   if (room && !src.open)
+   {
+      skipped += buf.size() - pos;
+      pos = buf.size();
+   }
+
+   if (skipped)
+   {
+      pthread_mutex_lock(&src.lock);
+      src.counters.skipped += skipped;
+      pthread_mutex_unlock(&src.lock);
+   }
+
+   src.pending.erase(0, pos);
+   return room;
+}
+
+
+void MDPIngest::pause(Source& src)
+{
+   // Removed rather than left without EPOLLIN: a hangup is reported
+   // regardless of the events asked for.
+   if (src.open)
+      ::epoll_ctl(epfd, EPOLL_CTL_DEL, src.buff->handle, NULL);
+}
+
+
+void MDPIngest::resume(Source& src, double now)
+{
+   pthread_mutex_lock(&src.lock);
+   bool waiting = src.paused && src.queue.size() <= queueLength / 2;
+   if (waiting)
+      src.paused = false;
+   pthread_mutex_unlock(&src.lock);
+
+   if (!waiting)
+      return;
+
+   if (!frame(src, now))
+      return;
+
+   if (src.open)
+   {
+      struct epoll_event ev;
+      ev.events = EPOLLIN;
+      ev.data.u32 = src.index;
+      ::epoll_ctl(epfd, EPOLL_CTL_ADD, src.buff->handle, &ev);
+   }
+   else
+      active--;
+}
+
+
+void MDPIngest::finish(Source& src, double now)
+{
+   if (!src.open)
+      return;
+
+   pthread_mutex_lock(&src.lock);
+   bool finished = src.finished;
+   bool paused = src.paused;
+   pthread_mutex_unlock(&src.lock);
+   if (!finished)
+      return;
+
+   // As if the source had closed with nothing more to frame; a paused one
+   // is counted out by resume(). The connection is closed too, so that the
+   // receiver is not left blocked on a full buffer.
+   close(src);
+   src.buff->close();
+   src.pending.clear();
+   if (!paused && frame(src, now))
+      active--;
+}
+
+
+void MDPIngest::close(Source& src)
+{
+   if (!src.open)
+      return;
+   ::epoll_ctl(epfd, EPOLL_CTL_DEL, src.buff->handle, NULL);
+   src.open = false;
+}
+
+
+//-----------------------------------------------------------------------------
+string MDPIngest::getName(int rx) const
+{
+   return sources.at(rx)->name;
+}
+
+
+MDPIngest::Counters MDPIngest::getCounters(int rx) const
+{
+   const Source& src = *sources.at(rx);
+   pthread_mutex_lock(&src.lock);
+   Counters c = src.counters;
+   pthread_mutex_unlock(&src.lock);
+   return c;
+}
+
+
+double MDPIngest::elapsed() const
+{
+   return wallClock() - startTime;
+}
+
+
+void MDPIngest::dumpCounters(ostream& s) const
+{
+   using StringUtils::asString;
+   using StringUtils::leftJustify;
+   using StringUtils::rightJustify;
+
+   double t = elapsed();
+   if (t <= 0)
+      t = 1e-6;
+
+   s << leftJustify("# receiver", 24)
+     << "   msgs  msg/s   kB/s    crc  other   skip stall  lat ms    max"
+     << endl;
+
+   Counters total;
+   for (int rx = 0; rx <= numSources(); rx++)
+   {
+      Counters c;
+      string name = "total";
+      if (rx < numSources())
+      {
+         c = getCounters(rx);
+         name = getName(rx);
+         total.bytes += c.bytes;
+         total.skipped += c.skipped;
+         total.processed += c.processed;
+         total.crcErrors += c.crcErrors;
+         total.unknown += c.unknown;
+         total.stalls += c.stalls;
+         total.latencySum += c.latencySum;
+         if (c.latencyMax > total.latencyMax)
+            total.latencyMax = c.latencyMax;
+      }
+      else
+         c = total;
+
+      double mean = c.processed ? c.latencySum / c.processed : 0;
+      s << leftJustify(name, 24)
+        << rightJustify(asString(c.processed), 7)
+        << rightJustify(asString(c.processed / t, 0), 7)
+        << rightJustify(asString(c.bytes / t / 1024, 0), 7)
+        << rightJustify(asString(c.crcErrors), 7)
+        << rightJustify(asString(c.unknown), 7)
+        << rightJustify(asString(c.skipped), 7)
+        << rightJustify(asString(c.stalls), 6)
+        << rightJustify(asString(mean * 1e3, 2), 8)
+        << rightJustify(asString(c.latencyMax * 1e3, 1), 7)
+        << endl;
+   }
+}
@@ -0,0 +1,161 @@
+#pragma ident "$Id$"
+
+/** @file Reads MDP from many receivers at once */
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2007, The University of Texas at Austin
+//
+//============================================================================
+
+#ifndef MDPINGEST_HPP
+#define MDPINGEST_HPP
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <Exception.hpp>
+#include <ThreadPool.hpp>
+
+#include "MDPProcessors.hpp"
+
+//-----------------------------------------------------------------------------
+// Takes in the MDP of many receivers, over TCP or serial lines, and runs
+// each receiver's messages through its own list of MDPProcessors.
+//
+// The thread that calls run() waits on all the sources at once (epoll, so
+// this is Linux only), reads whatever has come in and cuts it into
+// messages: it looks for the frame word, decodes the header and, once the
+// whole message is there, puts it on the queue of its receiver. The queues
+// are emptied by the workers of a ThreadPool, which check the CRCs, decode
+// the observations, PVT solutions, nav subframes and selftest messages and
+// hand them to the processors of the receiver with
+// MDPProcessor::processMessage(). A receiver is served by one worker at a
+// time, in the order its messages came in, so its processors need no
+// locking; different receivers are processed in parallel. A processor is
+// given no more messages once processMessage() has returned false, the
+// message being past its stopTime; when all the processors of a receiver
+// have stopped, the receiver is closed and the rest of its queue dropped.
+//
+// A queue holds at most queueLength messages. When it is full, its source
+// is not read until a worker has taken the messages; the receiver then
+// backs up into the kernel buffers and no other receiver is held up.
+//
+// Counters of bytes, messages, errors and latency (from the read to the
+// end of the pipeline) are kept for each receiver.
+//-----------------------------------------------------------------------------
+class MDPIngest
+{
+public:
+   struct Counters
+   {
+      Counters();
+
+      unsigned long bytes;      ///< bytes read
+      unsigned long skipped;    ///< bytes skipped between messages
+      unsigned long messages;   ///< messages queued
+      unsigned long processed;  ///< messages through the processors
+      unsigned long crcErrors;  ///< messages dropped for a bad CRC
+      unsigned long unknown;    ///< messages of other ids, dropped
+      unsigned long stalls;     ///< times the source waited on a full queue
+      double latencySum;        ///< seconds from read to end of processing
+      double latencyMax;
+   };
+
+   // 'workers' threads run the processors; 0 means one per processor.
+   MDPIngest(unsigned workers = 0, unsigned queueLength = 1024)
+      throw(gpstk::Exception);
+
+   ~MDPIngest();
+
+   // Connects to a receiver; target is tcp:host:port or ser:device, as
+   // for a DeviceStream. Returns the index of the receiver.
+   int addSource(const std::string& target)
+      throw(gpstk::Exception);
+
+   // Adds a receiver that is already open on fd, which must be in blocking
+   // mode. The fd is closed with the MDPIngest.
+   int addSource(int fd, const std::string& name)
+      throw(gpstk::Exception);
+
+   // Appends a processor to the pipeline of receiver rx. The processor is
+   // not owned and must outlast run(); its process() is not used.
+   void addProcessor(int rx, MDPProcessor* proc);
+
+   // Reads all the sources until each has closed, or stop() is called,
+   // which closes the connections still open; then waits for the messages
+   // already read to be processed. Every reportInterval seconds, if that
+   // is > 0, the counters are written to reportStream.
+   void run()
+      throw(gpstk::Exception);
+
+   // Makes run() return. This may be called from another thread or from a
+   // signal handler.
+   void stop();
+
+   double reportInterval;
+   std::ostream* reportStream;
+
+   int numSources() const { return sources.size(); }
+   std::string getName(int rx) const;
+   Counters getCounters(int rx) const;
+
+   // Seconds since run() was called
+   double elapsed() const;
+
+   // Writes a line of counters and rates for each receiver, and the totals
+   void dumpCounters(std::ostream& s) const;
+
+private:
+   class Source;
+
+   // Puts the complete messages read from src on its queue; returns false
+   // if the queue filled first.
+   bool frame(Source& src, double now);
+
+   // Frames what is left of a source that was paused on a full queue
+   void resume(Source& src, double now);
+
+   // Stops reading a source; it is done once the rest is framed
+   void pause(Source& src);
+   void close(Source& src);
+
+   // Closes a source whose processors have all passed their stopTime
+   void finish(Source& src, double now);
+
+   // Makes epoll_wait() in run() return
+   void wake();
+
+   std::vector<Source*> sources;
+   gpstk::ThreadPool* pool;
+   unsigned queueLength;
+   int epfd;
+   int wakeFds[2];
+   volatile bool stopping;
+   double startTime;
+
+   // Sources with bytes still to read or frame
+   int active;
+
+   MDPIngest(const MDPIngest&);
+   MDPIngest& operator=(const MDPIngest&);
+};
+
+#endif
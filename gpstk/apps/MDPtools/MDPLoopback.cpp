@@ -0,0 +1,239 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2007, The University of Texas at Austin
+//
+//============================================================================
+
+/** @file A made up MDP receiver on the loopback interface */
+
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "StringUtils.hpp"
+#include "GPSWeekSecond.hpp"
+#include "TCPStreamBuff.hpp"
+#include "MDPObsEpoch.hpp"
+#include "MDPPVTSolution.hpp"
+#include "MDPNavSubframe.hpp"
+#include "MDPLoopback.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+//-----------------------------------------------------------------------------
+MDPLoopback::MDPLoopback(unsigned long epochs, unsigned numSVs)
+   throw(gpstk::Exception)
+   : rate(0), corruptEvery(0), time(GPSWeekSecond(1500, 0)),
+     messages(0), corrupted(0), bytes(0),
+     epochs(epochs), numSVs(numSVs), freshnessCount(0), running(false)
+{
+   listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+   if (listenFd < 0)
+   {
+      Exception e(string("socket: ") + strerror(errno));
+      GPSTK_THROW(e);
+   }
+
+   struct sockaddr_in addr;
+   socklen_t len = sizeof(addr);
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port = 0;
+   if (::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+       ::listen(listenFd, 1) < 0 ||
+       ::getsockname(listenFd, (sockaddr*)&addr, &len) < 0)
+   {
+      ::close(listenFd);
+      Exception e(string("Can not listen on the loopback: ") +
+                  strerror(errno));
+      GPSTK_THROW(e);
+   }
+   port = ntohs(addr.sin_port);
+}
+
+
+MDPLoopback::~MDPLoopback()
+{
+   join();
+   ::close(listenFd);
+}
+
+
+string MDPLoopback::getTarget() const
+{
+   return "tcp:127.0.0.1:" + StringUtils::asString(port);
+}
+
+
+void MDPLoopback::start()
+   throw(gpstk::Exception)
+{
+   if (running)
+      return;
+   if (::pthread_create(&thread, NULL, threadMain, this))
+   {
+      Exception e("MDPLoopback: can not start the thread");
+      GPSTK_THROW(e);
+   }
+   running = true;
+}
+
+
+void MDPLoopback::join()
+{
+   if (!running)
+      return;
+   ::pthread_join(thread, NULL);
+   running = false;
+}
+
+
+void* MDPLoopback::threadMain(void* arg)
+{
+   static_cast<MDPLoopback*>(arg)->serve();
+   return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+void MDPLoopback::serve()
+{
+   TCPStreamBuff client;
+   SocketAddr peer(IPaddress(), 0);
+   client.accept(listenFd, peer);
+   if (!client.is_open())
+      return;
+
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   const double start = tv.tv_sec + tv.tv_usec * 1.e-6;
+
+   MDPPVTSolution pvt;
+   pvt.x[0] = -740289.8;
+   pvt.x[1] = -5457071.7;
+   pvt.x[2] = 3207245.6;
+   pvt.v[0] = pvt.v[1] = pvt.v[2] = 0;
+   pvt.dtime = 1e-4;
+   pvt.ddtime = 1e-9;
+   pvt.numSVs = numSVs;
+   pvt.fom = 1;
+   pvt.pvtMode = 1;
+   pvt.corrections = 0;
+
+   MDPObsEpoch oe;
+   oe.numSVs = numSVs;
+   MDPObsEpoch::Observation obs;
+   obs.carrier = ccL1;
+   obs.range = rcCA;
+   obs.bw = 1;
+   obs.snr = 45;
+
+   MDPNavSubframe sf;
+   sf.carrier = ccL1;
+   sf.range = rcCA;
+   sf.nav = ncICD_200_2;
+
+   for (unsigned long e = 0; e < epochs; e++)
+   {
+      if (rate > 0)
+      {
+         ::gettimeofday(&tv, 0);
+         double wait = start + e / rate - (tv.tv_sec + tv.tv_usec * 1.e-6);
+         // The client sends nothing, so it is readable only once it has
+         // hung up.
+         struct pollfd pfd;
+         pfd.fd = client.handle;
+         pfd.events = POLLIN;
+         if (wait > 0 && ::poll(&pfd, 1, int(wait * 1000) + 1) > 0)
+            return;
+      }
+
+      CommonTime t = time + static_cast<double>(e);
+
+      pvt.time = pvt.timep = t;
+      if (!send(client.handle, pvt))
+         return;
+
+      for (unsigned i = 0; i < numSVs; i++)
+      {
+         oe.time = t;
+         oe.channel = i + 1;
+         oe.prn = i + 1;
+         oe.elevation = 10 + 80.0 * i / numSVs;
+         oe.azimuth = 360.0 * i / numSVs;
+         obs.lockCount = e;
+         obs.pseudorange = 2.1e7 + 1e5 * i + 700.0 * e;
+         obs.phase = obs.pseudorange / 0.19029367;
+         obs.doppler = -3678.0;
+         oe.obs[MDPObsEpoch::ObsKey(obs.carrier, obs.range)] = obs;
+         if (!send(client.handle, oe))
+            return;
+      }
+
+      sf.time = t;
+      sf.prn = e % numSVs + 1;
+      for (int w = 1; w <= 10; w++)
+         sf.subframe[w] = (e * 10 + w) & 0x3fffffff;
+      if (!send(client.handle, sf))
+         return;
+   }
+}
+
+
+bool MDPLoopback::send(int fd, MDPHeader& msg)
+{
+   // As MDPHeader::reallyPutRecord() does it
+   msg.freshnessCount = freshnessCount++;
+   string body = msg.encode();
+   msg.length = body.length() + MDPHeader::myLength;
+   string str = msg.MDPHeader::encode() + body;
+   msg.setCRC(str);
+
+   messages++;
+   if (corruptEvery && messages % corruptEvery == 0)
+   {
+      str[str.size() - 1] ^= 0x5a;
+      corrupted++;
+   }
+
+   // Not FDStreamBuff::write(): a client that goes away must not raise
+   // SIGPIPE.
+   for (string::size_type pos = 0; pos < str.size(); )
+   {
+      ssize_t n = ::send(fd, str.data() + pos, str.size() - pos,
+                         MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n <= 0)
+         return false;
+      pos += n;
+      bytes += n;
+   }
+   return true;
+}
@@ -0,0 +1,104 @@
+#pragma ident "$Id$"
+
+/** @file A made up MDP receiver on the loopback interface */
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2007, The University of Texas at Austin
+//
+//============================================================================
+
+#ifndef MDPLOOPBACK_HPP
+#define MDPLOOPBACK_HPP
+
+#include <string>
+#include <pthread.h>
+
+#include <Exception.hpp>
+#include <CommonTime.hpp>
+
+#include "MDPHeader.hpp"
+
+//-----------------------------------------------------------------------------
+// Stands in for a receiver when trying out MDPIngest. It listens on a TCP
+// port of the loopback interface and, on a thread of its own, waits for
+// one client and sends it a PVT solution, an obs epoch for each of numSVs
+// SVs and a nav subframe for each second of receiver time, with
+// consecutive freshness counts. The connection is closed after the last
+// epoch, or as soon as the client hangs up.
+//-----------------------------------------------------------------------------
+class MDPLoopback
+{
+public:
+   // Listens on a port picked by the system
+   MDPLoopback(unsigned long epochs, unsigned numSVs = 8)
+      throw(gpstk::Exception);
+
+   // Waits for the thread
+   ~MDPLoopback();
+
+   // tcp:127.0.0.1:port, to give MDPIngest::addSource()
+   std::string getTarget() const;
+
+   // Starts the thread
+   void start()
+      throw(gpstk::Exception);
+
+   // Waits for the last epoch to be sent
+   void join();
+
+   // Messages sent per epoch
+   unsigned long messagesPerEpoch() const { return numSVs + 2; }
+
+   // Epochs per second; 0 sends as fast as the client takes them
+   double rate;
+
+   // Every corruptEvery'th message has the last byte of its body changed
+   // after the CRC is computed; 0 for none
+   unsigned long corruptEvery;
+
+   // Receiver time of the first epoch
+   gpstk::CommonTime time;
+
+   // Set by the thread; read them after join()
+   unsigned long messages, corrupted, bytes;
+
+private:
+   static void* threadMain(void* arg);
+
+   // Accepts the client and sends the epochs
+   void serve();
+
+   // Encodes msg, with the next freshness count, and sends it; false if
+   // the client has gone.
+   bool send(int fd, gpstk::MDPHeader& msg);
+
+   unsigned long epochs;
+   unsigned numSVs;
+   unsigned short freshnessCount;
+   int listenFd;
+   unsigned short port;
+   pthread_t thread;
+   bool running;
+
+   MDPLoopback(const MDPLoopback&);
+   MDPLoopback& operator=(const MDPLoopback&);
+};
+
+#endif
@@ -56,7 +56,7 @@ MDPProcessor::MDPProcessor() :
       timeSpan(-1), processBad(false), bugMask(0),
       debugLevel(0), verboseLevel(0), in(d1), out(d2), die(false),
       pvtOut(false), obsOut(false), navOut(false), tstOut(false),
-      followEOF(false)
+      followEOF(false), msgCount(0), fcErrorCount(0), firstFC(0), lastFC(0)
 {}
 
 MDPProcessor::MDPProcessor(gpstk::MDPStream& in, std::ofstream& out) :
@@ -66,7 +66,7 @@ MDPProcessor::MDPProcessor(gpstk::MDPStream& in, std::ofstream& out) :
       timeSpan(-1), processBad(false), bugMask(0),
       debugLevel(0), verboseLevel(0), in(in), out(out), die(false),
       pvtOut(false), obsOut(false), navOut(false), tstOut(false),
-      followEOF(false)
+      followEOF(false), msgCount(0), fcErrorCount(0), firstFC(0), lastFC(0)
 {}
 
 void MDPProcessor::process()
@@ -101,24 +101,10 @@ void MDPProcessor::process()
          continue;
       }
       
-      if (startTime == CommonTime(CommonTime::BEGINNING_OF_TIME) && timeSpan>0)
-      {
-         startTime = header.time;
-         if (debugLevel)
-            out << "startTime: " << startTime << endl;
-      }
-      
-      if (stopTime == CommonTime(CommonTime::END_OF_TIME) && timeSpan>0)
-      {
-         stopTime = startTime + timeSpan;
-         if (debugLevel)
-            out << "stopTime: " << stopTime << endl;
-      }
-
-      if (header.time > stopTime)
+      int window = checkTime(header);
+      if (window > 0)
          return;
-            
-      if (header.time < startTime)
+      if (window < 0)
          continue;
 
       msgCount++;
@@ -134,11 +120,7 @@ void MDPProcessor::process()
             gpstk::MDPObsEpoch obs;
             in >> obs;
             if (obs || processBad)
-            {
-               processFC(header);
-               if (obsOut)
-                  process(obs);
-            }
+               dispatch(obs, header, in.header);
             break;
          }
 
@@ -147,11 +129,7 @@ void MDPProcessor::process()
             gpstk::MDPPVTSolution pvt;
             in >> pvt;
             if (pvt || processBad)
-            {
-               processFC(header);
-               if (pvtOut)
-                  process(pvt);
-            }
+               dispatch(pvt, header, in.header);
             break;
          }
          
@@ -160,11 +138,7 @@ void MDPProcessor::process()
             gpstk::MDPNavSubframe nav;
             in >> nav;
             if (nav || processBad)
-            {
-               processFC(header);
-               if (navOut)
-                  process(nav);
-            }
+               dispatch(nav, header, in.header);
             break;
          }
          
@@ -173,11 +147,7 @@ void MDPProcessor::process()
             gpstk::MDPSelftestStatus sts;
             in >> sts;
             if (sts || processBad)
-            {
-               processFC(header);
-               if (tstOut) 
-                  process(sts);
-            }
+               dispatch(sts, header, in.header);
             break;
          }
          default:
@@ -189,23 +159,99 @@ void MDPProcessor::process()
 
 
 //-----------------------------------------------------------------------------
-void MDPProcessor::processFC(const MDPHeader& header)
+bool MDPProcessor::processMessage(const MDPHeader& msg)
+{
+   int window = checkTime(msg);
+   if (window > 0)
+      return false;
+   if (window < 0)
+      return true;
+
+   msgCount++;
+
+   if (msg || processBad)
+      dispatch(msg, msg, msg);
+   return true;
+}
+
+
+//-----------------------------------------------------------------------------
+int MDPProcessor::checkTime(const MDPHeader& header)
+{
+   if (startTime == CommonTime(CommonTime::BEGINNING_OF_TIME) && timeSpan>0)
+   {
+      startTime = header.time;
+      if (debugLevel)
+         out << "startTime: " << startTime << endl;
+   }
+      
+   if (stopTime == CommonTime(CommonTime::END_OF_TIME) && timeSpan>0)
+   {
+      stopTime = startTime + timeSpan;
+      if (debugLevel)
+         out << "stopTime: " << stopTime << endl;
+   }
+
+   if (header.time > stopTime)
+      return 1;
+   if (header.time < startTime)
+      return -1;
+   return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+void MDPProcessor::dispatch(const MDPHeader& msg, const MDPHeader& header,
+                            const MDPHeader& counted)
+{
+   switch (header.id)
+   {
+      case gpstk::MDPObsEpoch::myId:
+         processFC(header, counted);
+         if (obsOut)
+            process(static_cast<const MDPObsEpoch&>(msg));
+         break;
+
+      case gpstk::MDPPVTSolution::myId:
+         processFC(header, counted);
+         if (pvtOut)
+            process(static_cast<const MDPPVTSolution&>(msg));
+         break;
+
+      case gpstk::MDPNavSubframe::myId:
+         processFC(header, counted);
+         if (navOut)
+            process(static_cast<const MDPNavSubframe&>(msg));
+         break;
+
+      case gpstk::MDPSelftestStatus::myId:
+         processFC(header, counted);
+         if (tstOut) 
+            process(static_cast<const MDPSelftestStatus&>(msg));
+         break;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+void MDPProcessor::processFC(const MDPHeader& header,
+                             const MDPHeader& counted)
 {
    if (msgCount == 1)
-      firstFC = lastFC = in.header.freshnessCount;
+      firstFC = lastFC = counted.freshnessCount;
    else
    {
-      if (in.header.freshnessCount != static_cast<unsigned short>(lastFC+1))
+      if (counted.freshnessCount != static_cast<unsigned short>(lastFC+1))
       {
          fcErrorCount++;
          if (verboseLevel)
             out << printTime(header.time,timeFormat)
                 <<"  Freshness count error.  Previous was " << lastFC
-                << " current is " << in.header.freshnessCount << endl;
+                << " current is " << counted.freshnessCount << endl;
          if (debugLevel)
-            in.header.dump(cout);
+            counted.MDPHeader::dump(cout);
          }
-      lastFC = in.header.freshnessCount;
+      lastFC = counted.freshnessCount;
    }
 }
 
@@ -53,6 +53,12 @@ public:
 
    void process();
 
+   /// Processes one message that was read and decoded elsewhere (by
+   /// MDPIngest, say) as process() does the ones it reads from 'in'. The
+   /// message must be of the type its id says. Returns false once the
+   /// message is past stopTime.
+   bool processMessage(const gpstk::MDPHeader& msg);
+
    std::string timeFormat;
    int debugLevel;
    int verboseLevel;
@@ -77,7 +83,21 @@ public:
    unsigned long bugMask;
 
 protected:
-   void processFC(const gpstk::MDPHeader& hedaer);
+   /// Checks the freshness count of 'counted'; errors are reported at the
+   /// time of 'header'. process() counts the stream's last header, which
+   /// is not always the message it hands on.
+   void processFC(const gpstk::MDPHeader& header,
+                  const gpstk::MDPHeader& counted);
+
+   /// Sets the time span from this header if need be; returns 1 if the
+   /// header is past stopTime, -1 if it is before startTime, else 0.
+   int checkTime(const gpstk::MDPHeader& header);
+
+   /// Checks the freshness count, as processFC() does, and hands the
+   /// message to the process() below for the type header.id says, if
+   /// that output is enabled.
+   void dispatch(const gpstk::MDPHeader& msg, const gpstk::MDPHeader& header,
+                 const gpstk::MDPHeader& counted);
 
 private:
    /// All processors are defined so that subclasses don't have to
@@ -0,0 +1,303 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2007, The University of Texas at Austin
+//
+//============================================================================
+
+/** @file Takes in MDP from many receivers at once */
+
+#include <signal.h>
+
+#include "StringUtils.hpp"
+#include "BasicFramework.hpp"
+
+#include "MDPProcessors.hpp"
+#include "SummaryProc.hpp"
+#include "MDPIngest.hpp"
+#include "MDPLoopback.hpp"
+
+using namespace std;
+using namespace gpstk;
+
+static MDPIngest* theIngest = NULL;
+
+static void stopIngest(int sig)
+{
+   if (theIngest)
+      theIngest->stop();
+}
+
+
+class MDPIngestApp : public gpstk::BasicFramework
+{
+public:
+   MDPIngestApp(const std::string& applName)
+      throw()
+      : BasicFramework(
+         applName,
+         "Takes in MDP from many receivers at once and runs the messages of "
+         "each through its own processor, on a pool of threads. Counters "
+         "of messages, errors and latency are written as it goes and at "
+         "the end."),
+        inputOpt(
+           'i', "input",
+           "A receiver to take MDP from: tcp:host:port or ser:device. "
+           "Repeat for more receivers."),
+        outputOpt(
+           '\0', "output",
+           "Receiver n writes its output to this, followed by .n; without "
+           "it the output is thrown away."),
+        styleOpt(
+           's', "output-style",
+           "What type of output to produce for each receiver. Valid styles "
+           "are: brief, verbose, table, header, csv, summary and null. The "
+           "default is null."),
+        loopbackOpt(
+           '\0', "loopback",
+           "Make up this many receivers on the loopback interface, "
+           "for trying things out."),
+        epochsOpt(
+           '\0', "epochs",
+           "Epochs each made up receiver sends. The default is 600."),
+        workersOpt(
+           'w', "workers",
+           "Threads to run the processors on. The default is one per "
+           "processor."),
+        queueOpt(
+           'q', "queue",
+           "Messages each receiver may have waiting to be processed. The "
+           "default is 1024."),
+        rateOpt(
+           '\0', "rate",
+           "Epochs per second each made up receiver sends. The default is "
+           "as fast as they are taken."),
+        reportOpt(
+           'r', "report",
+           "Seconds between writing the counters. The default is 10; 0 "
+           "only writes them at the end."),
+        timeSpanOpt(
+           'l', "time-span",
+           "How much data to process, in seconds, from the first message "
+           "of each receiver. A receiver is closed once it is done."),
+        pvtOpt('p', "pvt",  "Enable pvt output"),
+        obsOpt('o', "obs",  "Enable obs output"),
+        navOpt('n', "nav",  "Enable nav output"),
+        tstOpt('t', "test", "Enable selftest output"),
+        badOpt('b', "bad",  "Try to process bad messages also."),
+        style("null"), ingest(NULL)
+   {
+      styleOpt.setMaxCount(1);
+   }
+
+   bool initialize(int argc, char *argv[]) throw()
+   {
+      if (!BasicFramework::initialize(argc,argv)) return false;
+
+      if (styleOpt.getCount())
+         style = styleOpt.getValue()[0];
+      if (style != "brief" && style != "verbose" && style != "table" &&
+          style != "header" && style != "csv" && style != "summary" &&
+          style != "null")
+      {
+         cout << "Style " << style << " is not a valid style." << endl;
+         return false;
+      }
+
+      if (!inputOpt.getCount() && !loopbackOpt.getCount())
+      {
+         cout << "Give at least one receiver with -i, or use --loopback."
+              << endl;
+         return false;
+      }
+
+      return true;
+   }
+
+protected:
+   virtual void spinUp()
+   {
+      unsigned workers = 0, queueLength = 1024;
+      if (workersOpt.getCount())
+         workers = StringUtils::asUnsigned(workersOpt.getValue()[0]);
+      if (queueOpt.getCount())
+         queueLength = StringUtils::asUnsigned(queueOpt.getValue()[0]);
+
+      ingest = new MDPIngest(workers, queueLength);
+      ingest->reportInterval = 10;
+      if (reportOpt.getCount())
+         ingest->reportInterval =
+            StringUtils::asDouble(reportOpt.getValue()[0]);
+
+      vector<string> targets = inputOpt.getValue();
+
+      int nloop = 0;
+      if (loopbackOpt.getCount())
+         nloop = StringUtils::asInt(loopbackOpt.getValue()[0]);
+      for (int i = 0; i < nloop; i++)
+      {
+         MDPLoopback* lb = new MDPLoopback(
+            epochsOpt.getCount() ?
+            StringUtils::asUnsigned(epochsOpt.getValue()[0]) : 600);
+         if (rateOpt.getCount())
+            lb->rate = StringUtils::asDouble(rateOpt.getValue()[0]);
+         lb->start();
+         loopbacks.push_back(lb);
+         targets.push_back(lb->getTarget());
+      }
+
+      for (size_t i = 0; i < targets.size(); i++)
+      {
+         int rx = ingest->addSource(targets[i]);
+
+         outputs.push_back(new ofstream);
+         streams.push_back(new MDPStream);
+         if (outputOpt.getCount())
+            outputs[rx]->open((outputOpt.getValue()[0] + "." +
+                               StringUtils::asString(rx)).c_str());
+
+         MDPProcessor* p = makeProcessor(*streams[rx], *outputs[rx]);
+         processors.push_back(p);
+         ingest->addProcessor(rx, p);
+
+         if (debugLevel)
+            cout << "Receiver " << rx << ": " << targets[i] << endl;
+      }
+   }
+
+   MDPProcessor* makeProcessor(MDPStream& in, ofstream& out)
+   {
+      MDPProcessor* p;
+      if (style == "brief")
+         p = new MDPBriefProcessor(in, out);
+      else if (style == "table")
+         p = new MDPTableProcessor(in, out);
+      else if (style == "header")
+         p = new MDPHeaderProcessor(in, out);
+      else if (style == "csv")
+         p = new MDPCSVProcessor(in, out);
+      else if (style == "verbose")
+         p = new MDPVerboseProcessor(in, out);
+      else if (style == "summary")
+         p = new MDPSummaryProcessor(in, out);
+      else
+         p = new MDPNullProcessor(in, out);
+
+      p->pvtOut |= pvtOpt;
+      p->obsOut |= obsOpt;
+      p->navOut |= navOpt;
+      p->tstOut |= tstOpt;
+      p->processBad |= badOpt;
+      if (timeSpanOpt.getCount())
+         p->timeSpan = StringUtils::asDouble(timeSpanOpt.getValue()[0]);
+      if (!p->pvtOut && !p->obsOut && !p->navOut && !p->tstOut)
+      {
+         if (style == "summary")
+            p->obsOut = p->pvtOut = p->navOut = p->tstOut = true;
+         else
+            p->obsOut = true;
+      }
+      p->debugLevel = debugLevel;
+      p->verboseLevel = verboseLevel;
+      return p;
+   }
+
+   virtual void process()
+   {
+      theIngest = ingest;
+      signal(SIGINT, stopIngest);
+      signal(SIGTERM, stopIngest);
+
+      try
+      {
+         ingest->run();
+      }
+      catch (gpstk::Exception &e)
+      {
+         cout << e << endl;
+      }
+
+      signal(SIGINT, SIG_DFL);
+      signal(SIGTERM, SIG_DFL);
+      theIngest = NULL;
+
+      // After a stop() the ingest has hung up on them, so the made up
+      // receivers are not left sending.
+      for (size_t i = 0; i < loopbacks.size(); i++)
+         loopbacks[i]->join();
+
+      ingest->dumpCounters(cout);
+      for (size_t i = 0; i < processors.size(); i++)
+         if (processors[i]->fcErrorCount)
+            cout << ingest->getName(i) << ": "
+                 << processors[i]->fcErrorCount
+                 << " freshness count errors" << endl;
+   }
+
+   virtual void shutDown()
+   {
+      for (size_t i = 0; i < processors.size(); i++)
+         delete processors[i];
+      delete ingest;
+      for (size_t i = 0; i < loopbacks.size(); i++)
+         delete loopbacks[i];
+      for (size_t i = 0; i < outputs.size(); i++)
+      {
+         delete outputs[i];
+         delete streams[i];
+      }
+   }
+
+private:
+   gpstk::CommandOptionWithAnyArg inputOpt, outputOpt, styleOpt;
+   gpstk::CommandOptionWithNumberArg loopbackOpt, epochsOpt, workersOpt;
+   gpstk::CommandOptionWithNumberArg queueOpt;
+   gpstk::CommandOptionWithAnyArg rateOpt, reportOpt;
+   gpstk::CommandOptionWithNumberArg timeSpanOpt;
+   gpstk::CommandOptionNoArg pvtOpt, obsOpt, navOpt, tstOpt, badOpt;
+
+   string style;
+
+   MDPIngest* ingest;
+   vector<MDPLoopback*> loopbacks;
+   vector<MDPProcessor*> processors;
+   vector<ofstream*> outputs;
+   vector<MDPStream*> streams;
+};
+
+
+int main(int argc, char *argv[])
+{
+   try
+   {
+      MDPIngestApp app(argv[0]);
+
+      if (!app.initialize(argc, argv))
+         exit(0);
+
+      app.run();
+   }
+   catch (gpstk::Exception &exc)
+   { cout << exc << endl; }
+   catch (std::exception &exc)
+   { cout << "Caught std::exception " << exc.what() << endl; }
+   catch (...)
+   { cout << "Caught unknown exception" << endl; }
+}
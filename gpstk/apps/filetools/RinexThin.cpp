@@ -42,8 +42,9 @@
 
 #include <math.h>
 #include <iostream>
-#include "RinexObsData.hpp"
-#include "RinexObsStream.hpp"
+#include "RinexObsHeader.hpp"
+#include "RinexObsEpochReader.hpp"
+#include "RinexObsEpochWriter.hpp"
 #include "CommandOption.hpp"
 #include "CommandOptionParser.hpp"
 #include "StringUtils.hpp"
@@ -75,44 +76,50 @@ int main(int argc, char* argv[])
   
    for (i=0;(i < fileOption.getCount());i++)
    {
-      RinexObsStream ros(fileOption.getValue()[i].c_str());
-      CommonTime nextTime;
-      bool firstRecord=true;
-
-      RinexObsData data;
-      RinexObsStream out(fileOutput.getValue()[i].c_str(), ios::out|ios::trunc);
-      
-      int drate= StringUtils::asInt(dashs.getValue()[0]);
-      dashs.setMaxCount(1);
-      RinexObsHeader h;
-
-
       long wcount=0, rcount=0;
-      
-      ros >> h;
 
-      while (ros >> data)
+      try
       {
-         rcount++;
+            // epochs are read ahead, and written, in background threads,
+            // and copied as text: only the epoch lines are decoded
+         RinexObsEpochReader ros(fileOption.getValue()[i]);
+         RinexObsEpochWriter out(fileOutput.getValue()[i]);
 
-	 if ( fmod(static_cast<YDSTime>(data.time).sod,drate) <= ttolerance )
-         {
- 
-          // First obs? Then update and output the header.
-         if (wcount==0)
+         int drate= StringUtils::asInt(dashs.getValue()[0]);
+         dashs.setMaxCount(1);
+         RinexObsHeader h(ros.getHeader());
+
+         RinexObsEpochReader::Epoch data;
+
+         while (ros.next(data))
          {
-            if (h.valid & RinexObsHeader::intervalValid)
-               h.interval = drate;
-         
-            if (h.valid & RinexObsHeader::firstTimeValid)
-               h.firstObs = data.time;
-      
-            out << h;
-         }
+            rcount++;
 
-            out<<data;
-            wcount++;
+            if ( fmod(static_cast<YDSTime>(data.time).sod,drate) <= ttolerance )
+            {
+
+                  // First obs? Then update and output the header.
+               if (wcount==0)
+               {
+                  if (h.valid & RinexObsHeader::intervalValid)
+                     h.interval = drate;
+
+                  if (h.valid & RinexObsHeader::firstTimeValid)
+                     h.firstObs = data.time;
+
+                  out.write(h);
+               }
+
+               out.write(data);
+               wcount++;
+            }
          }
+
+         out.close();
+      }
+      catch (Exception& e)
+      {
+         cerr << e << endl;
       }
 
       cout << "Obs read:    " << rcount << endl;
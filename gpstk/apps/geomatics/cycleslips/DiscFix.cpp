@@ -38,6 +38,9 @@
 // one routine, this program could be used to do something else to the satellite
 // passes. Note that there is a choice of when to write out the data:
 // either as soon as possible, or only at the end (cf. bool WriteASAP).
+// The passes are independent, so the GDC is run on them on a pool of threads
+// (cf. --threads), while the rest of the file is being read; the output is
+// the same as when they are processed one at a time.
 //---------------------------------------------------------------------------------
 
 /**
@@ -54,8 +57,10 @@
 #include <time.h>
 #include <string>
 #include <vector>
+#include <deque>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 
 #include "TimeString.hpp"
@@ -73,6 +78,7 @@
 #include "GloFreqIndex.hpp"
 #include "StringUtils.hpp"
 #include "TimeString.hpp"
+#include "ThreadPool.hpp"
 
 using namespace std;
 using namespace gpstk;
@@ -98,6 +104,7 @@ typedef struct configuration {
    bool UseCA,ForceCA;
    vector<GSatID> ExSV;
    GSatID SVonly;
+   int NThreads;    // threads running the GDC; 0 means one per processor
       // output files
    string LogFile,OutFile;
    ofstream oflog,ofout;
@@ -142,7 +149,8 @@ bool UsingCA;
 // Data for an entire pass is stored in SatPass object:
 // This contains all the SatPasses defined so far.
 // The parallel vector holds an iterator for use in writing out the data.
-vector<SatPass> SPList;
+// (A deque, so that adding a pass does not move the passes being processed.)
+deque<SatPass> SPList;
 // convenience
 static const string L1="L1",L2="L2",P1="P1",P2="P2",C1="C1";
 // list of observation types to be included in each SatPass
@@ -155,6 +163,59 @@ map<GSatID,int> SatToCurrentIndexMap;
 
 static const double dtTol = 0.25; // 1/4 sec tolerance used in epoch processing
 
+//------------------------------------------------------------------------------------
+// Processing the passes in parallel.
+// ProcessSatPass() queues the pass (status 10); when PassBatch passes are queued
+// they are started on the pool, largest first, and run while the following passes
+// are read. Each one has its own copy of the GDC configuration, its own debug output
+// and its own editing commands; these are written out, and the status of the pass
+// is set, in the order the passes were queued, when the next batch is started.
+// Without a pool the batch is run one pass after the other at the same point. The
+// batches do not depend on the number of threads, and neither does any output.
+class PassTask : public ThreadPool::Task
+{
+public:
+   PassTask(int in) : index(in), pass(&SPList[in]), gdc(GDConfig),
+                      iret(0), failed(false)
+   {
+      // number the passes in the GDC log in the order they are queued
+      GDConfig.setUnique(GDConfig.getUnique()+1);
+      ostringstream oss;
+      oss << "Proc " << *pass << " at " << printTime(CurrEpoch,config.format);
+      procMsg = oss.str();
+   }
+
+   virtual void run() throw()
+   {
+      try {
+         gdc.setDebugStream(debug);
+         iret = DiscontinuityCorrector(*pass, gdc, EditCmds, msg);
+         if(iret == 0 && config.smooth)
+            pass->smooth(config.smoothPR,config.smoothPH,smoothMsg);
+      }
+      catch(Exception& e) { error = e; failed = true; }
+      catch(exception& e) { error = Exception("std except: "+string(e.what()));
+                            failed = true; }
+      catch(...) { error = Exception("Unknown exception"); failed = true; }
+   }
+
+   int index;                 // index of the pass in SPList
+   SatPass *pass;             // the pass (SPList[index])
+   string procMsg;            // 'Proc' line for the log, made when queued
+   GDCconfiguration gdc;      // copy of GDConfig, writing to debug
+   ostringstream debug;       // GDC debug output
+   vector<string> EditCmds;   // output of the GDC
+   string msg,smoothMsg;
+   int iret;
+   bool failed;
+   Exception error;
+};
+
+ThreadPool *GDCPool=NULL;           // threads running the GDC, if more than one
+static const size_t PassBatch = 32; // passes queued before they are started
+vector<PassTask *> QueuedPasses;    // queued, not yet started, in order
+vector<PassTask *> RunningPasses;   // started, in the order they were queued
+
 //------------------------------------------------------------------------------------
 // Prototypes
 
@@ -171,6 +232,15 @@ int ProcessOneSatOneEpoch(GSatID, CommonTime, unsigned short&, vector<double>&,
 void ProcessSatPass(int index)
    throw(Exception);
 
+void StartSatPasses(void)
+   throw(Exception);
+
+void FinishSatPasses(void)
+   throw(Exception);
+
+void FinishSatPass(PassTask& task)
+   throw(Exception);
+
 int AfterReadingFiles(void)
    throw(Exception);
 
@@ -183,7 +253,7 @@ void WriteRINEXheader(void)
 void WriteRINEXdata(CommonTime& WriteEpoch, const CommonTime targetTime)
    throw(Exception);
 
-void PrintSPList(ostream&, string, vector<SatPass>&, bool printTime);
+void PrintSPList(ostream&, string, deque<SatPass>&, bool printTime);
 
 int GetCommandLine(int argc, char **argv)
    throw(Exception);
@@ -228,6 +298,18 @@ int main(int argc, char **argv)
          dummy.setOutputFormat(config.format);
       }
 
+         // start the threads for the GDC
+      {
+         unsigned int n = (config.NThreads > 0 ? config.NThreads
+                                               : ThreadPool::processorCount());
+         if(n > 1) {
+            try { GDCPool = new ThreadPool(n); }
+            catch(Exception& e) { GDCPool = NULL; }   // process them one at a time
+         }
+         if(config.verbose) config.oflog << "Processing passes with "
+            << (GDCPool ? GDCPool->size() : 1) << " thread(s)" << endl;
+      }
+
          // open output files
          // output for editing commands - write to this in ProcessSatPass()
       config.ofout.open(config.OutFile.c_str());
@@ -269,6 +351,8 @@ int main(int argc, char **argv)
       SatToCurrentIndexMap.clear();
       SPList.clear();
       SPIndexList.clear();
+      delete GDCPool;
+      GDCPool = NULL;
 
       totaltime = clock()-totaltime;
       config.oflog << PrgmName << " timing: " << fixed << setprecision(3)
@@ -444,7 +528,7 @@ int ProcessOneEntireEpoch(RinexObsData& roe) throw(Exception)
 
             // Is this satellite excluded ?
          sat = it->first;
-         if(sat.system != SatID::systemGPS ||
+         if(sat.system != SatID::systemGPS &&
              sat.system != SatID::systemGlonass) continue;; // ignore non-GPS satellites
          for(k=-1,i=0; i<config.ExSV.size(); i++)     // ignore input sat (--exSat)
             if(config.ExSV[i] == sat) { k = i; break; }
@@ -542,7 +626,6 @@ int ProcessOneEntireEpoch(RinexObsData& roe) throw(Exception)
             continue;                          // don't process yet
 
          ProcessSatPass(i);                    // ok, process this pass
-         if(!orfstr) SPList[i].status() = 99;    // status == 99 means 'written out'
       }
 
       // try writing more data to output RINEX file
@@ -606,9 +689,7 @@ int ProcessOneSatOneEpoch(GSatID sat, CommonTime tt, unsigned short& flag,
 
          // first process the old one
       ProcessSatPass(index);
-      if(!orfstr)                         // not writing to RINEX
-         SPList[index].status() = 99;       // status == 99 means 'written out'
-      else if(config.WriteASAP)
+      if(orfstr && config.WriteASAP)
          WriteToRINEXfile();              // try writing out
 
          // create a new SatPass for this sat
@@ -634,14 +715,10 @@ int ProcessOneSatOneEpoch(GSatID sat, CommonTime tt, unsigned short& flag,
 }
 
 //------------------------------------------------------------------------------------
-// Process the pass (call DC); if there is an output file, try writing to it.
+// Process the pass (call DC): queue it, and start the queue once it is long enough.
 void ProcessSatPass(int in) throw(Exception)
 {
    try {
-      config.oflog << "Proc " << SPList[in]
-         << " at " << printTime(CurrEpoch,config.format) << endl;
-      //SPList[in].dump(config.oflog,"RAW");      // temp
-
       // remove this SatPass from the SatToCurrentIndexMap map
       SatToCurrentIndexMap.erase(SPList[in].getSat());
 
@@ -653,40 +730,128 @@ void ProcessSatPass(int in) throw(Exception)
       {
       }
 
-
       // --------- call DC on this pass -------------------
-      string msg;
-      vector<string> EditCmds;
-      int iret = DiscontinuityCorrector(SPList[in], GDConfig, EditCmds, msg);
-      if(iret != 0) {
+      PassTask *task = new PassTask(in);
+      SPList[in].status() = 10;             // status == 10 means 'queued'.
+
+      QueuedPasses.push_back(task);
+      if(QueuedPasses.size() >= PassBatch)
+         StartSatPasses();
+   }
+   catch(Exception& e) { GPSTK_RETHROW(e); }
+   catch(exception& e)
+      { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
+   catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
+}
+
+//------------------------------------------------------------------------------------
+// larger passes first, so that the last one to finish is a short one
+static bool LargerPass(const PassTask *left, const PassTask *right)
+{
+   return (left->pass->size() > right->pass->size());
+}
+
+//------------------------------------------------------------------------------------
+// Finish the passes already started, then start the queued ones, largest first.
+void StartSatPasses(void) throw(Exception)
+{
+   try {
+      FinishSatPasses();
+      if(QueuedPasses.empty()) return;
+
+      if(GDCPool) {
+         vector<PassTask *> order(QueuedPasses);
+         stable_sort(order.begin(), order.end(), LargerPass);
+         for(size_t i=0; i<order.size(); i++)
+            GDCPool->submit(order[i]);
+      }
+      else {
+         for(size_t i=0; i<QueuedPasses.size(); i++)
+            QueuedPasses[i]->run();
+      }
+
+      RunningPasses.swap(QueuedPasses);
+      QueuedPasses.clear();
+   }
+   catch(Exception& e) { GPSTK_RETHROW(e); }
+   catch(exception& e)
+      { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
+   catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
+}
+
+//------------------------------------------------------------------------------------
+// Wait for the passes started, and write out their results in the queued order.
+void FinishSatPasses(void) throw(Exception)
+{
+   try {
+      if(RunningPasses.empty()) return;
+      if(GDCPool) GDCPool->wait();
+
+      vector<PassTask *> done;
+      done.swap(RunningPasses);
+      for(size_t i=0; i<done.size(); i++) {
+         try { FinishSatPass(*done[i]); }
+         catch(Exception& e) {
+            for(size_t j=i; j<done.size(); j++) delete done[j];
+            GPSTK_RETHROW(e);
+         }
+         delete done[i];
+      }
+   }
+   catch(Exception& e) { GPSTK_RETHROW(e); }
+   catch(exception& e)
+      { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
+   catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
+}
+
+//------------------------------------------------------------------------------------
+// Write out the results of the DC on one pass, and set its status.
+void FinishSatPass(PassTask& task) throw(Exception)
+{
+   try {
+      int in = task.index;
+      config.oflog << task.procMsg << endl;
+      config.oflog << task.debug.str();
+      //SPList[in].dump(config.oflog,"RAW");      // temp
+
+      if(task.failed) {
+         Exception e(task.error);
+         e.addText("In GDC for SatPass " + asString(in));
+         GPSTK_THROW(e);
+      }
+
+      if(task.iret != 0) {
          SPList[in].status() = 100;         // status == 100 means 'failed'
          config.oflog << "GDC failed for SatPass " << in << " : "
-            << (iret == -1 ? "Polynomial fit to GF data was singular" :
-               (iret == -2 ? "Premature end" :     // never used
-               (iret == -3 ? "Time interval DT not set" :
-               (iret == -4 ? "No data found" :
-               (iret == -5 ? "Required obs types (L1,L2,P1/C1,P2) not found" :
+            << (task.iret == -1 ? "Polynomial fit to GF data was singular" :
+               (task.iret == -2 ? "Premature end" :     // never used
+               (task.iret == -3 ? "Time interval DT not set" :
+               (task.iret == -4 ? "No data found" :
+               (task.iret == -5 ? "Required obs types (L1,L2,P1/C1,P2) not found" :
                              "Unknown"))))) << endl;
-         return;
       }
-      SPList[in].status() = 2;              // status == 2 means 'processed'.
-
-      // --------- output editing commands ----------------
-      for(int i=0; i<EditCmds.size(); i++)
-         config.ofout << EditCmds[i] << endl;
-
-      // --------- smooth pseudorange and debias phase ----
-      if(config.smooth) {
-         string msg;
-         SPList[in].smooth(config.smoothPR,config.smoothPH,msg);
-         config.oflog << msg << endl;
-         SPList[in].status() = 3;           // status == 3 means 'smoothed'.
+      else {
+         SPList[in].status() = 2;           // status == 2 means 'processed'.
+
+         // --------- output editing commands ----------------
+         for(size_t i=0; i<task.EditCmds.size(); i++)
+            config.ofout << task.EditCmds[i] << endl;
+
+         // --------- smooth pseudorange and debias phase ----
+         if(config.smooth) {
+            config.oflog << task.smoothMsg << endl;
+            SPList[in].status() = 3;        // status == 3 means 'smoothed'.
+         }
       }
 
+      if(!orfstr)                           // not writing out to RINEX
+         SPList[in].status() = 99;          // status == 99 means 'written out'
+
       // status ==   0 means 'new'
       // status ==   1 means 'still being filled', so status MUST be set to >1 here
       // status ==   2 means 'processed'
       // status ==   3 means 'smoothed'
+      // status ==  10 means 'queued' - in ProcessSatPass(), until finished here
       // status ==  98 means 'writing out'
       // status ==  99 means 'written out'
       // status == 100 means 'failed'
@@ -715,12 +880,11 @@ int AfterReadingFiles(void) throw(Exception)
 
       // process all the passes that have not been processed yet
       for(int i=0; i<SPList.size(); i++) {
-         if(SPList[i].status() <= 1) {
+         if(SPList[i].status() <= 1)
             ProcessSatPass(i);
-            if(!orfstr)                         // not writing out to RINEX
-               SPList[i].status() = 99;         // status == 99 means 'written out'
-         }
       }
+      StartSatPasses();
+      FinishSatPasses();
 
       // write out all the (processed) data that has not already been written
       WriteToRINEXfile();
@@ -747,18 +911,21 @@ void WriteToRINEXfile(void) throw(Exception)
       CommonTime targetTime=CommonTime::END_OF_TIME;
       static CommonTime WriteEpoch(CommonTime::BEGINNING_OF_TIME);
 
-      // find all passes that have been newly processed (status > 1 but < 98)
-      // mark these passes 'being written out' and initialize the iterator
+      // find all passes that have been newly processed (status > 1 but < 98,
+      // and not 10 = queued); mark these passes 'being written out' and
+      // initialize the iterator
       for(in=0; in<SPList.size(); in++) {
-         if(SPList[in].status() > 1 && SPList[in].status() < 98) {
+         if(SPList[in].status() > 1 && SPList[in].status() < 98
+                                    && SPList[in].status() != 10) {
             SPList[in].status() = 98;       // status == 98 means 'being written out'
             SPIndexList[in] = 0;          // initialize iteration over the data array
          }
       }
 
-      // find the earliest FirstTime of 'non-processed' (status==1) passes
+      // find the earliest FirstTime of 'non-processed' (status==1 or 10) passes
       for(in=0; in<SPList.size(); in++) {
-         if(SPList[in].status() == 1 && SPList[in].getFirstTime() < targetTime)
+         if((SPList[in].status() == 1 || SPList[in].status() == 10)
+               && SPList[in].getFirstTime() < targetTime)
             targetTime = SPList[in].getFirstTime();
       }
       // targetTime will == END_OF_TIME, when all passes have been processed
@@ -952,11 +1119,10 @@ void WriteRINEXdata(CommonTime& WriteEpoch, const CommonTime targetTime) throw(E
          }
 
          // actually write to RINEX
-         if(roe.numSvs > 0) {
-            config.SVonly.setfill(' ');         // just for the hell of it
+         // (RinexObsData writes RinexSatIDs, so the GSatID fill character, which
+         // the GDC threads are using, need not be changed here)
+         if(roe.numSvs > 0)
             orfstr << roe;
-            config.SVonly.setfill('0');
-         }
 
       } while(1);  // end while loop over all epochs up to targetTime
 
@@ -968,7 +1134,7 @@ void WriteRINEXdata(CommonTime& WriteEpoch, const CommonTime targetTime) throw(E
 }
 
 //------------------------------------------------------------------------------------
-void PrintSPList(ostream& os, string msg, vector<SatPass>& v, bool doPrintTime)
+void PrintSPList(ostream& os, string msg, deque<SatPass>& v, bool doPrintTime)
 {
    int i,j,gap;
    GSatID sat;
@@ -1014,6 +1180,7 @@ int GetCommandLine(int argc, char **argv) throw(Exception)
    config.begTime = CommonTime::BEGINNING_OF_TIME;
    config.endTime = CommonTime::END_OF_TIME;
    config.MaxGap = 600.0;
+   config.NThreads = 0;
    //config.MinPts = 10;
 
    config.LogFile = string("df.log");
@@ -1084,6 +1251,11 @@ int GetCommandLine(int argc, char **argv) throw(Exception)
       0,"gap"," --gap <t>           Minimum data gap (sec) separating "
       "satellite passes (" + asString(int(config.MaxGap)) + ")");
    dashGap.setMaxCount(1);
+
+   CommandOption dashThreads(CommandOption::hasArgument, CommandOption::stdType,
+      0,"threads"," --threads <n>       Number of threads processing the passes "
+      "(0: one per processor) (" + asString(config.NThreads) + ")");
+   dashThreads.setMaxCount(1);
    
    //CommandOption dashPts(CommandOption::hasArgument, CommandOption::stdType,
       //0,"Points"," --Points <n>        Minimum number of points needed to "
@@ -1322,6 +1494,12 @@ int GetCommandLine(int argc, char **argv) throw(Exception)
       config.dt = asDouble(values[0]);
       if(help) cout << "dt is set to " << config.dt << " seconds." << endl;
    }
+   if(dashThreads.getCount()) {
+      values = dashThreads.getValue();
+      config.NThreads = asInt(values[0]);
+      if(config.NThreads < 0) config.NThreads = 1;
+      if(help) cout << "Number of threads is " << config.NThreads << endl;
+   }
    if(dashGap.getCount()) {
       values = dashGap.getValue();
       config.MaxGap = asDouble(values[0]);
@@ -1494,6 +1672,8 @@ int GetCommandLine(int argc, char **argv) throw(Exception)
    config.oflog << " dt is set to " << config.dt << " seconds." << endl;
    config.oflog << " Max gap is " << config.MaxGap << " seconds which is "
       << int(config.MaxGap/config.dt) << " points." << endl;
+   config.oflog << " Number of threads is " << config.NThreads
+      << (config.NThreads == 0 ? " (one per processor)" : "") << endl;
    //config.oflog << " Minimum points is " << config.MinPts << endl;
    if(config.ExSV.size()) {
       config.oflog << " Exclude satellites";
@@ -67,6 +67,7 @@ int main(int argc, char **argv)
       Vector<double> state;
       Namelist name;
       SRI S;
+      vector<SRI> Slist;      // one per file, merged at the end
 
       if(argc <= 1) {
          cout << "Prgm mergeSRI combines solution and covariance results from "
@@ -152,7 +153,7 @@ int main(int argc, char **argv)
 
          SRI S1(name);
          S1.addAPriori(cov,state);
-         S += S1;
+         Slist.push_back(S1);
 
          nfile++;
       }
@@ -162,6 +163,10 @@ int main(int argc, char **argv)
          return 0;
       }
 
+      // merge them all, pairwise, using all the processors
+      S = SRI::treeMerge(Slist,0);
+      name = S.getNames();
+
       double small,big;
       S.getStateAndCovariance(state,cov,&small,&big);
       cout << endl;
@@ -112,6 +112,8 @@ try {
    MinDDSeg = 50;
    PhaseBiasReset = 10;
    ExSV.clear();
+      // processing
+   NThreads = 1;
       // timetable
    RefSat = GSatID(-1,SatID::systemGPS);
       // estimation
@@ -456,6 +458,11 @@ try {
       "<x,y,z> are optional baseline coordinates\n                          "
       "for comparison [repeatable] ()");
 
+   CommandOption dashthreads(CommandOption::hasArgument, CommandOption::stdType,
+      0,"Threads"," --Threads <n>         Form and edit DDs on <n> threads, 0 for one"
+      " per processor (" + asString(NThreads) + ")");
+   dashthreads.setMaxCount(1);
+
    CommandOptionNoArg dashvalid('0', "validate",
       " --validate            Read input and validate it, then quit (don't)");
    dashvalid.setMaxCount(1);
@@ -1058,6 +1065,13 @@ try {
       }
    }
 
+   if(dashthreads.getCount()) {
+      values = dashthreads.getValue();
+      NThreads = asInt(values[0]);
+      if(NThreads < 0) NThreads = 1;
+      if(help) cout << " Input: number of threads for DDs: " << NThreads << endl;
+   }
+
    if(dashvalid.getCount()) {
       Validate = true;
       if(help) cout << " Input: validate -- read, test input and quit" << endl;
@@ -1450,6 +1464,9 @@ try {
    ofs << " Maximum gap in data = " << MaxGap << " * DT" << endl;
    ofs << " Minimum DD dataset length = " << MinDDSeg << endl;
    ofs << " Phase bias reset limit is " << PhaseBiasReset << " cycles" << endl;
+   ofs << " Form and edit DDs on " << NThreads << " thread"
+      << (NThreads == 1 ? "" : "s") << (NThreads == 0 ? " (one per processor)" : "")
+      << endl;
    ofs << " Minimum elevation for DD data is "
       << fixed << setw(6) << setprecision(2) << MinElevation << " degrees." << endl;
    if(RotatedAntennaElevation > 0 || RotatedAntennaAzimuth > 0)
@@ -106,6 +106,8 @@ public:
    int MinDDSeg;
    int PhaseBiasReset;
    std::vector<gpstk::GSatID> ExSV;
+      // processing
+   int NThreads;                          // threads for DDs, 0 for one per cpu
       // timetable
    gpstk::GSatID RefSat;
       // Estimation
@@ -60,7 +60,8 @@ using namespace std;
 using namespace gpstk;
 
 //------------------------------------------------------------------------------------
-string Version("4.8 5/13/11");
+string Version("4.9 10/19/26");
+// 4.9 10/19/26 Form and edit DDs in parallel (--Threads), release raw data after DDs
 // 4.8  5/13/11 Timetable algorithm 'using' ave time btwn segments for a gap; bug213
 // 4.7b 6/23/10 Minor change so NewB trop. model works properly
 // 4.7 12/10/08 Fix empty buffers bug (131) in Timetable
@@ -48,7 +48,9 @@
 //------------------------------------------------------------------------------------
 // system includes
 #include "TimeString.hpp"
+#include <sstream>
 // GPSTk
+#include "ThreadPool.hpp"
 
 // DDBase
 #include "DDBase.hpp"
@@ -60,9 +62,13 @@ using namespace StringUtils;
 
 //------------------------------------------------------------------------------------
 // prototypes -- this module only
-void ComputeSingleDifferences(string baseline, map<SDid,RawData>& SDmap)
+int BaselineDoubleDifferences(const string& baseline, map<DDid,DDData>& DDmap,
+   ostream& os) throw(Exception);
+void ComputeSingleDifferences(string baseline, map<SDid,RawData>& SDmap, ostream& os)
    throw(Exception);
-int ComputeDoubleDifferences(map<SDid,RawData>& SDmap) throw(Exception);
+int ComputeDoubleDifferences(map<SDid,RawData>& SDmap, map<DDid,DDData>& DDmap,
+   ostream& os) throw(Exception);
+void ReleaseRawObservables(Station& st) throw();
 
 //------------------------------------------------------------------------------------
 // other prototypes
@@ -70,12 +76,46 @@ int ComputeDoubleDifferences(map<SDid,RawData>& SDmap) throw(Exception);
 bool ElevationMask(double elevation, double azimuth) throw(Exception);
 
 //------------------------------------------------------------------------------------
+// Task computing the DDs of one baseline, in its own map and with its own log, for
+// the parallel mode of DoubleDifference()
+class BaselineDDTask : public ThreadPool::Task {
+public:
+   BaselineDDTask(const string& bl) : baseline(bl), iret(0), failed(false) {}
+
+   virtual void run() throw()
+   {
+      try {
+         iret = BaselineDoubleDifferences(baseline,DDmap,log);
+         for(size_t i=0; i<release.size(); i++) ReleaseRawObservables(*release[i]);
+      }
+      catch(Exception& e) { error = e; failed = true; }
+      catch(exception& e) { error = Exception("std except: "+string(e.what()));
+                            failed = true; }
+      catch(...) { error = Exception("Unknown exception"); failed = true; }
+   }
+
+   string baseline;
+   map<DDid,DDData> DDmap;       // DDs of this baseline
+   ostringstream log;            // output for oflog, written in baseline order
+   vector<Station*> release;     // stations used by this baseline only
+   int iret;                     // return of BaselineDoubleDifferences()
+   bool failed;                  // true if an exception was caught
+   Exception error;              // the exception
+};
+
+//------------------------------------------------------------------------------------
+// Compute and buffer the DDs of every baseline. The baselines are independent (their
+// DDs have different DDids); with CI.NThreads != 1 they are differenced in parallel,
+// each one in its own map, and the maps and logs are put together in baseline order,
+// so the results are those of the serial loop. Once the DDs are formed, only the
+// elevations and counts of the raw data buffers are needed (StochasticModels.cpp);
+// the other raw observables are released, those of a station as soon as all its
+// baselines are done.
 int DoubleDifference(void) throw(Exception)
 {
 try {
-   int n,i,j,k;
-      // map to hold all buffered single differences for one baseline
-   map<SDid,RawData> SDmap;
+   size_t n;
+   int i;
 
    if(CI.Verbose) oflog << "BEGIN DoubleDifference()"
       << " at total time " << fixed << setprecision(3)
@@ -85,82 +125,154 @@ try {
       // clear any existing DDs
    DDDataMap.clear();
 
-      // loop over baselines
+      // count the baselines using each station
+   map<string,int> nuse;
    for(n=0; n<Baselines.size(); n++) {
+      nuse[word(Baselines[n],0,'-')]++;
+      nuse[word(Baselines[n],1,'-')]++;
+   }
 
-         // ----------------------------------------------------------
-         // for this baseline, compute all SDs, then DDs, and buffer them
-      if(CI.Verbose) oflog << "DoubleDifference() for baseline "
-         << Baselines[n] << endl;
-
-         // clear the SD map
-      SDmap.clear();
-
-         // ----------------------------------------------------------
-         // compute all single differences for this baseline
-         // give it same ordering as Baseline
-      ComputeSingleDifferences(Baselines[n],SDmap);
-
-         // loop over SD data, edit small ones and dump summary
-      if(CI.Verbose) oflog << "Single difference summary for baseline "
-          << Baselines[n] << endl;
-
-      vector<SDid> Remove;    // these will be small dataset to delete later
-
-      map<SDid,RawData>::const_iterator kt;
-      for(k=1,kt=SDmap.begin(); kt != SDmap.end(); k++,kt++) {
-
-         if(CI.Verbose) {
-            oflog << " " << setw(2) << k << " " << kt->first
-                  << " " << setw(5) << kt->second.count.size();
-            if(kt->second.count.size() > 0)
-               oflog << " " << setw(5) << kt->second.count.at(0) << " - "
-                     << setw(5) << kt->second.count.at(kt->second.count.size()-1);
-            else
-               oflog << "    na -    na";
-
-               // gaps - (count : number of pts)
-            if(kt->second.count.size() > 0) {      // gcc needs this ...
-               for(i=0; i<kt->second.count.size()-1; i++) {
-                  j = kt->second.count.at(i+1) - kt->second.count.at(i);
-                  if(j > 1) oflog
-                     << " (" << kt->second.count.at(i)+1 << ":" << j-1 << ")";
-               }
-            }
+   unsigned int nthreads(CI.NThreads > 0 ? CI.NThreads
+                                         : ThreadPool::processorCount());
+
+   if(nthreads <= 1 || Baselines.size() <= 1) {
+         // loop over baselines
+      for(n=0; n<Baselines.size(); n++) {
+         if(BaselineDoubleDifferences(Baselines[n],DDDataMap,oflog)) return 1;
+
+         for(i=0; i<2; i++) {
+            string site(word(Baselines[n],i,'-'));
+            if(nuse[site] == 1) ReleaseRawObservables(Stations[site]);
+         }
+      }
+   }
+   else {
+      if(CI.Verbose) oflog << "DoubleDifference() for " << Baselines.size()
+         << " baselines on " << nthreads << " threads" << endl;
+
+      vector<BaselineDDTask *> tasks;
+      for(n=0; n<Baselines.size(); n++) {
+         tasks.push_back(new BaselineDDTask(Baselines[n]));
+         for(i=0; i<2; i++) {
+            string site(word(Baselines[n],i,'-'));
+            if(nuse[site] == 1) tasks.back()->release.push_back(&Stations[site]);
          }
+      }
+
+         // the tasks only read the raw data of the stations they share
+      {
+         ThreadPool pool(nthreads);
+         for(n=0; n<tasks.size(); n++) pool.submit(tasks[n]);
+         pool.wait();
+      }
 
-            // ignore small datasets
-         if(kt->second.count.size() < 10) {   // TD make input parameter
-            Remove.push_back(kt->first);
-            if(CI.Verbose) oflog << " **Rejected";
+         // collect the results in baseline order, freeing each one as it goes
+      int iret(0);
+      Exception error;
+      bool failed(false);
+      for(n=0; n<tasks.size(); n++) {
+         if(!failed && iret == 0) {
+            oflog << tasks[n]->log.str();
+            if(tasks[n]->failed) { error = tasks[n]->error; failed = true; }
+            else if(tasks[n]->iret) iret = 1;
+            else DDDataMap.insert(tasks[n]->DDmap.begin(),tasks[n]->DDmap.end());
          }
+         delete tasks[n];
+      }
+      tasks.clear();
 
-         if(CI.Verbose) oflog << endl;
+      if(failed) GPSTK_THROW(error);
+      if(iret) return iret;
+   }
 
-      }  // end summary loop
+      // release the raw observables of the stations shared by several baselines
+   map<string,int>::const_iterator it;
+   for(it=nuse.begin(); it != nuse.end(); it++)
+      if(it->second > 1) ReleaseRawObservables(Stations[it->first]);
 
-         // delete marked SD buffers
-      for(i=0; i<Remove.size(); i++) SDmap.erase(Remove[i]);
-   
-         // ----------------------------------------------------------
-         // now compute double differences - according to timetable
-      if(ComputeDoubleDifferences(SDmap)) return 1;
+   return 0;
+}
+catch(Exception& e) { GPSTK_RETHROW(e); }
+catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
+catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
+}   // end DoubleDifference()
 
-         // check that there are non-zero double differences
+//------------------------------------------------------------------------------------
+// For one baseline, compute all SDs, then DDs, and buffer them in DDmap. Output
+// goes to os. Return non-zero on error.
+int BaselineDoubleDifferences(const string& baseline, map<DDid,DDData>& DDmap,
+   ostream& os) throw(Exception)
+{
+try {
+   size_t i;
+   int j,k;
+      // map to hold all buffered single differences for this baseline
+   map<SDid,RawData> SDmap;
+
+   if(CI.Verbose) os << "DoubleDifference() for baseline " << baseline << endl;
+
+      // ----------------------------------------------------------
+      // compute all single differences for this baseline
+      // give it same ordering as Baseline
+   ComputeSingleDifferences(baseline,SDmap,os);
+
+      // loop over SD data, edit small ones and dump summary
+   if(CI.Verbose) os << "Single difference summary for baseline "
+       << baseline << endl;
 
-   }  // end loop over baselines
+   vector<SDid> Remove;    // these will be small dataset to delete later
+
+   map<SDid,RawData>::const_iterator kt;
+   for(k=1,kt=SDmap.begin(); kt != SDmap.end(); k++,kt++) {
+
+      if(CI.Verbose) {
+         os << " " << setw(2) << k << " " << kt->first
+               << " " << setw(5) << kt->second.count.size();
+         if(kt->second.count.size() > 0)
+            os << " " << setw(5) << kt->second.count.at(0) << " - "
+                  << setw(5) << kt->second.count.at(kt->second.count.size()-1);
+         else
+            os << "    na -    na";
+
+            // gaps - (count : number of pts)
+         if(kt->second.count.size() > 0) {      // gcc needs this ...
+            for(i=0; i<kt->second.count.size()-1; i++) {
+               j = kt->second.count.at(i+1) - kt->second.count.at(i);
+               if(j > 1) os
+                  << " (" << kt->second.count.at(i)+1 << ":" << j-1 << ")";
+            }
+         }
+      }
+
+         // ignore small datasets
+      if(kt->second.count.size() < 10) {   // TD make input parameter
+         Remove.push_back(kt->first);
+         if(CI.Verbose) os << " **Rejected";
+      }
+
+      if(CI.Verbose) os << endl;
+
+   }  // end summary loop
+
+      // delete marked SD buffers
+   for(i=0; i<Remove.size(); i++) SDmap.erase(Remove[i]);
+
+      // ----------------------------------------------------------
+      // now compute double differences - according to timetable
+   if(ComputeDoubleDifferences(SDmap,DDmap,os)) return 1;
 
    return 0;
 }
 catch(Exception& e) { GPSTK_RETHROW(e); }
 catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
 catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
-}   // end DoubleDifference()
+}   // end BaselineDoubleDifferences()
 
 //------------------------------------------------------------------------------------
 // Compute all single differences 'site1' - 'site2', using the RawDataBuffers in
 // Stations[site], and store the results in the given map<SDid,RawData>.
-void ComputeSingleDifferences(string baseline, map<SDid,RawData>& SDmap)
+// Stations is only read here, so that baselines can be differenced in parallel.
+void ComputeSingleDifferences(string baseline, map<SDid,RawData>& SDmap, ostream& os)
    throw(Exception)
 {
 try {
@@ -173,24 +285,29 @@ try {
 
       // find the beginning and ending *counts* of good data for this baseline
    if(QueryTimeTable(baseline,beg,end)) {
-      oflog << "ERROR - baseline " << baseline
+      os << "ERROR - baseline " << baseline
          << " not found in timetable. No single differences computed." << endl;
       return;
    }
 
       // find satellites in common
    map<GSatID,RawData>::const_iterator it1,it2;
+   map<string,Station>::const_iterator jt1,jt2;
+   jt1 = Stations.find(site1);
+   jt2 = Stations.find(site2);
+   if(jt1 == Stations.end() || jt2 == Stations.end()) return;    // no data
+   const Station& st1(jt1->second);
+   const Station& st2(jt2->second);
 
       // loop over satellites at first site
-   for(it1 = Stations[site1].RawDataBuffers.begin();
-       it1 != Stations[site1].RawDataBuffers.end(); it1++) {
+   for(it1 = st1.RawDataBuffers.begin(); it1 != st1.RawDataBuffers.end(); it1++) {
 
       sat = it1->first;
       // it1->second is RawData={ L1,L2,P1,P2,elev,az,count buffers = vector<> }
 
          // does this sat have data at the other station?
-      it2 = Stations[site2].RawDataBuffers.find(sat);
-      if(it2 == Stations[site2].RawDataBuffers.end()) continue;    // no
+      it2 = st2.RawDataBuffers.find(sat);
+      if(it2 == st2.RawDataBuffers.end()) continue;    // no
 
          // compute single differences for this satellite
          // here is where you define the ordering of sites: first(1) - second(2)
@@ -251,8 +368,9 @@ catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 }
 
 //------------------------------------------------------------------------------------
-// Assume SDmap is all for the same baseline
-int ComputeDoubleDifferences(map<SDid,RawData>& SDmap) throw(Exception)
+// Assume SDmap is all for the same baseline; the DDs are buffered in DDmap
+int ComputeDoubleDifferences(map<SDid,RawData>& SDmap, map<DDid,DDData>& DDmap,
+   ostream& os) throw(Exception)
 {
 try {
    bool frst,ok;
@@ -291,19 +409,19 @@ try {
       if(tt > ttnext) {
          ttnext = tt;
          if(QueryTimeTable(ref, ttnext)) {         // error - timetable failed
-            oflog << "DD: Error - failed to find reference from timetable at "
+            os << "DD: Error - failed to find reference from timetable at "
                << printTime(tt,"%Y/%02m/%02d %2H:%02M:%6.3f=%F/%10.3g") << " count "
                << count << " for baseline " << ref.site1 << "-" << ref.site2 << endl;
             return 1;
          }
-         if(CI.Verbose) oflog << "DD: reference is set to " << ref << " at "
+         if(CI.Verbose) os << "DD: reference is set to " << ref << " at "
             << printTime(tt,"%Y/%02m/%02d %2H:%02M:%6.3f=%F/%10.3g")
             << " count " << count << endl;
       }
 
          // does reference satellite have data at this count?
       if(SDmap[ref].count[Inext[ref]] != count) {
-         oflog << "Error - failed to find reference data " << ref << " at "
+         os << "Error - failed to find reference data " << ref << " at "
             << printTime(tt,"%Y/%02m/%02d %2H:%02M:%6.3f=%F/%10.3g") << endl;
             // TD return here, or just skip the epoch?
             // question is do we allow 'holes' in ref sat's data?
@@ -336,7 +454,7 @@ try {
          map<DDid,DDData>::iterator jt;
          DDid ddid((ref.ssite == 1 ? ref.site1 : ref.site2),
                    (ref.ssite == 1 ? ref.site2 : ref.site1),sid.sat,ref.sat);
-         if(DDDataMap.find(ddid) == DDDataMap.end()) {
+         if(DDmap.find(ddid) == DDmap.end()) {
                // create a new DDData
             DDData tddb;
             dd = (-ddL1+ddER)/wl1;
@@ -345,21 +463,21 @@ try {
             dd = (-ddL2+ddER)/wl2;
             nn2 = int(dd + (dd > 0 ? 0.5 : -0.5));
             tddb.L2bias = wl2 * nn2;
-            oflog << " Phase bias (initial) on " << ddid
+            os << " Phase bias (initial) on " << ddid
                << " at " << setw(4) << count << " "
                << printTime(tt,"%Y/%02m/%02d %2H:%02M:%6.3f=%F/%10.3g");
-            if(CI.Frequency != 2) oflog << " L1: " << setw(10) << nn1;
-            if(CI.Frequency != 1) oflog << " L2: " << setw(10) << nn2;
-            oflog << endl;
+            if(CI.Frequency != 2) os << " L1: " << setw(10) << nn1;
+            if(CI.Frequency != 1) os << " L2: " << setw(10) << nn2;
+            os << endl;
             //tddb.lastresetcount = count;
             tddb.resets.push_back(tddb.count.size());    // always one at beginning
             tddb.prevL1 = (ddL1-ddER)+tddb.L1bias;
             tddb.prevL2 = (ddL2-ddER)+tddb.L2bias;
-            DDDataMap[ddid] = tddb;
+            DDmap[ddid] = tddb;
          }
                
             // get the current DDData structure, and relative sign
-         jt = DDDataMap.find(ddid); // never fail...
+         jt = DDmap.find(ddid); // never fail...
          ddsign = DDid::compare(ddid,jt->first);
          DDData& ddb=jt->second;
          ok = true;                 // if ok, buffer this DDData = ddb
@@ -371,12 +489,12 @@ try {
             (CI.Frequency != 1 && fabs(db2) > CI.PhaseBiasReset)) {
             long ndb1 = long(db1 + (db1 > 0 ? 0.5 : -0.5));
             long ndb2 = long(db2 + (db2 > 0 ? 0.5 : -0.5));
-            oflog << " Phase bias (reset  ) on " << ddid
+            os << " Phase bias (reset  ) on " << ddid
                << " at " << setw(4) << count << " "
                << printTime(tt,"%Y/%02m/%02d %2H:%02M:%6.3f=%F/%10.3g");
-            if(CI.Frequency != 2) oflog << " L1: " << setw(10) << ndb1;
-            if(CI.Frequency != 1) oflog << " L2: " << setw(10) << ndb2;
-            oflog << endl;
+            if(CI.Frequency != 2) os << " L1: " << setw(10) << ndb1;
+            if(CI.Frequency != 1) os << " L2: " << setw(10) << ndb2;
+            os << endl;
             ddb.L1bias -= wl1 * ndb1;
             ddb.L2bias -= wl2 * ndb2;
             //ddb.lastresetcount = count;
@@ -431,5 +549,23 @@ catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(
 catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 }
 
+//------------------------------------------------------------------------------------
+// Free the raw observables of a station, keeping elevation and count, which are
+// used by the stochastic model in Estimation().
+void ReleaseRawObservables(Station& st) throw()
+{
+   map<GSatID,RawData>::iterator it;
+   for(it=st.RawDataBuffers.begin(); it != st.RawDataBuffers.end(); it++) {
+      vector<double>().swap(it->second.L1);
+      vector<double>().swap(it->second.L2);
+      vector<double>().swap(it->second.P1);
+      vector<double>().swap(it->second.P2);
+      vector<double>().swap(it->second.S1);
+      vector<double>().swap(it->second.S2);
+      vector<double>().swap(it->second.ER);
+      vector<double>().swap(it->second.az);
+   }
+}
+
 //------------------------------------------------------------------------------------
 //------------------------------------------------------------------------------------
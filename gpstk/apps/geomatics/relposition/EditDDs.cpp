@@ -50,11 +50,13 @@
 #include "TimeString.hpp"
 // system
 #include <vector>
+#include <sstream>
 
 // GPSTk
 #include "Matrix.hpp"
 #include "Stats.hpp"
 #include "RobustStats.hpp"
+#include "ThreadPool.hpp"
 //#include "SRIFilter.hpp"
 
 // DDBase
@@ -65,16 +67,33 @@ using namespace std;
 using namespace gpstk;
 
 //------------------------------------------------------------------------------------
-static int ngood,nbad;           // number good data, number of data marked bad
-static vector<int> mark;         // parallel to count and data vectors, mark bad data
 static ofstream tddofs;          // output stream for OutputTDDFile
 
+//------------------------------------------------------------------------------------
+// State of the editing of one DD buffer; the DD buffers are edited independently,
+// each with its own DDEditor, in parallel if CI.NThreads != 1.
+class DDEditor {
+public:
+   DDEditor(ostream& logstream, ostream *tddstream)
+      : ngood(0), nbad(0), log(logstream), tdd(tddstream) {}
+
+   int ngood,nbad;      // number good data, number of data marked bad
+   vector<int> mark;    // parallel to count and data vectors, mark bad data
+   ostream& log;        // output for oflog
+   ostream *tdd;        // output for OutputTDDFile, or NULL for none
+};
+
 //------------------------------------------------------------------------------------
 // prototypes -- this module only
-int EditDDResets(const DDid& ddid, DDData& dddata) throw(Exception);
-int EditDDIsolatedPoints(const DDid& ddid, DDData& dddata) throw(Exception);
-int EditDDSlips(const DDid& ddid, DDData& dddata, int frequency) throw(Exception);
-int EditDDOutliers(const DDid& ddid, DDData& dddata, int frequency) throw(Exception);
+int EditDD(const DDid& ddid, DDData& dddata, DDEditor& ed) throw(Exception);
+void SaveEditedDD(const DDid& ddid, DDData& dddata, DDEditor& ed) throw(Exception);
+int EditDDResets(const DDid& ddid, DDData& dddata, DDEditor& ed) throw(Exception);
+int EditDDIsolatedPoints(const DDid& ddid, DDData& dddata, DDEditor& ed)
+   throw(Exception);
+int EditDDSlips(const DDid& ddid, DDData& dddata, int frequency, DDEditor& ed)
+   throw(Exception);
+int EditDDOutliers(const DDid& ddid, DDData& dddata, int frequency, DDEditor& ed)
+   throw(Exception);
 //void LSPolyFunc(Vector<double>& X, Vector<double>& f, Matrix<double>& P)
 //   throw(Exception);
 // prototypes -- DataOutput.cpp
@@ -82,6 +101,32 @@ int OutputRawDData(const DDid& ddid, const DDData& dddata, const vector<int>& ma
    throw(Exception);
 int OutputDDData(void) throw(Exception);
 
+//------------------------------------------------------------------------------------
+// Task editing one DD buffer, with its own log, for the parallel mode of EditDDs()
+class EditDDTask : public ThreadPool::Task {
+public:
+   EditDDTask(map<DDid,DDData>::iterator i, bool tddout)
+      : it(i), editor(log, tddout ? &tdd : NULL), remove(false), failed(false) {}
+
+   virtual void run() throw()
+   {
+      try {
+         remove = (EditDD(it->first, it->second, editor) != 0);
+      }
+      catch(Exception& e) { error = e; failed = true; }
+      catch(exception& e) { error = Exception("std except: "+string(e.what()));
+                            failed = true; }
+      catch(...) { error = Exception("Unknown exception"); failed = true; }
+   }
+
+   map<DDid,DDData>::iterator it;   // the DD buffer
+   ostringstream log,tdd;           // output for oflog and tddofs
+   DDEditor editor;
+   bool remove;                     // if true, delete this DD buffer
+   bool failed;                     // true if an exception was caught
+   Exception error;                 // the exception
+};
+
 //------------------------------------------------------------------------------------
 int EditDDs(void) throw(Exception)
 {
@@ -115,6 +160,7 @@ try {
    }
 
    int i,j,k;
+   size_t n;
    map<DDid,DDData>::iterator it;
 
       // -------------------------------------------------------------------
@@ -122,99 +168,56 @@ try {
       // also compute maxCount, the largest value of Count seen in all baselines
    maxCount = 0;
    vector<DDid> DDdelete;
-   for(it = DDDataMap.begin(); it != DDDataMap.end(); it++) {
-
-         // is it too small?
-      if(it->second.count.size() < CI.MinDDSeg) {
-         DDdelete.push_back(it->first);
-         continue;
-      }
-
-         // prepare 'mark' vector
-      mark.assign(it->second.count.size(),1);
-      ngood = mark.size();
-      nbad = 0;
 
-         // remove points where bias had to be reset multiple times
-      k = EditDDResets(it->first, it->second);
-      if(k || ngood < CI.MinDDSeg) {
-         DDdelete.push_back(it->first);
-         continue;
-      }
+   unsigned int nthreads(CI.NThreads > 0 ? CI.NThreads
+                                         : ThreadPool::processorCount());
 
-         // remove isolated points
-      k = EditDDIsolatedPoints(it->first, it->second);
-      if(k || ngood < CI.MinDDSeg) {
-         DDdelete.push_back(it->first);
-         continue;
-      }
-
-         // find and remove slips
-      if(CI.Frequency != 2) {                // L1
-         k = EditDDSlips(it->first, it->second,1);
-         if(k || ngood < CI.MinDDSeg) {
-            DDdelete.push_back(it->first);
-            continue;
-         }
-      }
-      if(CI.Frequency != 1) {                // L2
-         k = EditDDSlips(it->first, it->second,2);
-         if(k || ngood < CI.MinDDSeg) {
-            DDdelete.push_back(it->first);
-            continue;
-         }
-      }
-
-         // find and remove outliers
-      if(CI.Frequency != 2) {                // L1
-         k = EditDDOutliers(it->first, it->second,1);
-         if(k || ngood < CI.MinDDSeg) {
+   if(nthreads <= 1 || DDDataMap.size() <= 1) {
+      for(it = DDDataMap.begin(); it != DDDataMap.end(); it++) {
+         DDEditor ed(oflog, tddofs.is_open() ? &tddofs : NULL);
+         if(EditDD(it->first, it->second, ed)) {
             DDdelete.push_back(it->first);
             continue;
          }
+         SaveEditedDD(it->first, it->second, ed);
       }
-      if(CI.Frequency != 1) {                // L2
-         k = EditDDOutliers(it->first, it->second,2);
-         if(k || ngood < CI.MinDDSeg) {
-            DDdelete.push_back(it->first);
-            continue;
+   }
+   else {
+         // edit in batches, so that the logs and marks kept are bounded; results
+         // are output and saved in DDid order, as in the serial loop
+      const unsigned int nbatch(4*nthreads);
+      ThreadPool pool(nthreads);
+      vector<EditDDTask *> tasks;
+      it = DDDataMap.begin();
+      while(it != DDDataMap.end()) {
+         for(n=0; n<nbatch && it != DDDataMap.end(); n++, it++) {
+            tasks.push_back(new EditDDTask(it, tddofs.is_open()));
+            pool.submit(tasks.back());
          }
-      }
-
-         // output raw data with mark
-      OutputRawDData(it->first, it->second, mark);
-
-         // use vector 'mark' to delete data
-      if(nbad > 0) {
-         vector<double> nDDL1,nDDL2,nDDP1,nDDP2,nDDER;
-         vector<int> ncount;
-         for(i=0; i<it->second.count.size(); i++) {
-            if(mark[i] == 1) {
-               nDDL1.push_back(it->second.DDL1[i]);
-               nDDL2.push_back(it->second.DDL2[i]);
-               nDDP1.push_back(it->second.DDP1[i]);
-               nDDP2.push_back(it->second.DDP2[i]);
-               nDDER.push_back(it->second.DDER[i]);
-               ncount.push_back(it->second.count[i]);
+         pool.wait();
+
+         for(n=0; n<tasks.size(); n++) {
+            EditDDTask& task(*tasks[n]);
+            oflog << task.log.str();
+            if(tddofs.is_open()) tddofs << task.tdd.str();
+            if(task.failed) {
+               Exception e(task.error);
+               for( ; n<tasks.size(); n++) delete tasks[n];
+               tasks.clear();
+               GPSTK_THROW(e);
             }
+            if(task.remove)
+               DDdelete.push_back(task.it->first);
+            else
+               SaveEditedDD(task.it->first, task.it->second, task.editor);
+            delete tasks[n];
          }
-         it->second.DDL1 = nDDL1;
-         it->second.DDL2 = nDDL2;
-         it->second.DDP1 = nDDP1;
-         it->second.DDP2 = nDDP2;
-         it->second.DDER = nDDER;
-         it->second.count = ncount;
-         // ignore resets from now on...
+         tasks.clear();
       }
-
-         // find the max count
-      if(it->second.count[it->second.count.size()-1] > maxCount)
-         maxCount = it->second.count[it->second.count.size()-1];
    }
 
       // close the output file
    tddofs.close();
-   mark.clear();
 
       // now delete the ones that were marked
    for(i=0; i<DDdelete.size(); i++) {
@@ -274,26 +277,124 @@ catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(
 catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 }   // end EditDDs()
 
+//------------------------------------------------------------------------------------
+// Edit one DD buffer, marking bad data in ed.mark. Only dddata and ed are changed,
+// so different buffers may be edited at the same time. Return non-zero if the whole
+// buffer is to be deleted.
+int EditDD(const DDid& ddid, DDData& dddata, DDEditor& ed) throw(Exception)
+{
+try {
+   int k;
+
+      // is it too small?
+   if(dddata.count.size() < size_t(CI.MinDDSeg)) return 1;
+
+      // prepare 'mark' vector
+   ed.mark.assign(dddata.count.size(),1);
+   ed.ngood = ed.mark.size();
+   ed.nbad = 0;
+
+      // remove points where bias had to be reset multiple times
+   k = EditDDResets(ddid, dddata, ed);
+   if(k || ed.ngood < CI.MinDDSeg) return 1;
+
+      // remove isolated points
+   k = EditDDIsolatedPoints(ddid, dddata, ed);
+   if(k || ed.ngood < CI.MinDDSeg) return 1;
+
+      // find and remove slips
+   if(CI.Frequency != 2) {                // L1
+      k = EditDDSlips(ddid, dddata, 1, ed);
+      if(k || ed.ngood < CI.MinDDSeg) return 1;
+   }
+   if(CI.Frequency != 1) {                // L2
+      k = EditDDSlips(ddid, dddata, 2, ed);
+      if(k || ed.ngood < CI.MinDDSeg) return 1;
+   }
+
+      // find and remove outliers
+   if(CI.Frequency != 2) {                // L1
+      k = EditDDOutliers(ddid, dddata, 1, ed);
+      if(k || ed.ngood < CI.MinDDSeg) return 1;
+   }
+   if(CI.Frequency != 1) {                // L2
+      k = EditDDOutliers(ddid, dddata, 2, ed);
+      if(k || ed.ngood < CI.MinDDSeg) return 1;
+   }
+
+   return 0;
+}
+catch(Exception& e) { GPSTK_RETHROW(e); }
+catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
+catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
+}   // end EditDD()
+
+//------------------------------------------------------------------------------------
+// Output the raw DD data of an edited buffer, delete the data marked bad, and
+// update maxCount. Called in DDid order, in this thread.
+void SaveEditedDD(const DDid& ddid, DDData& dddata, DDEditor& ed) throw(Exception)
+{
+try {
+   size_t i;
+
+      // output raw data with mark
+   OutputRawDData(ddid, dddata, ed.mark);
+
+      // use vector 'mark' to delete data
+   if(ed.nbad > 0) {
+      vector<double> nDDL1,nDDL2,nDDP1,nDDP2,nDDER;
+      vector<int> ncount;
+      for(i=0; i<dddata.count.size(); i++) {
+         if(ed.mark[i] == 1) {
+            nDDL1.push_back(dddata.DDL1[i]);
+            nDDL2.push_back(dddata.DDL2[i]);
+            nDDP1.push_back(dddata.DDP1[i]);
+            nDDP2.push_back(dddata.DDP2[i]);
+            nDDER.push_back(dddata.DDER[i]);
+            ncount.push_back(dddata.count[i]);
+         }
+      }
+      dddata.DDL1 = nDDL1;
+      dddata.DDL2 = nDDL2;
+      dddata.DDP1 = nDDP1;
+      dddata.DDP2 = nDDP2;
+      dddata.DDER = nDDER;
+      dddata.count = ncount;
+      // ignore resets from now on...
+   }
+
+      // the marks are not needed any more
+   vector<int>().swap(ed.mark);
+
+      // find the max count
+   if(dddata.count[dddata.count.size()-1] > maxCount)
+      maxCount = dddata.count[dddata.count.size()-1];
+}
+catch(Exception& e) { GPSTK_RETHROW(e); }
+catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
+catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
+}   // end SaveEditedDD()
+
 //------------------------------------------------------------------------------------
 // There is no provision in DDBase for resetting a bias. This would imply
 // solving for different biases (separated in time) for the same DDid.
 // Therefore, this routine simply deletes all but the largest unbroken segment
 // separated by resets.
-int EditDDResets(const DDid& ddid, DDData& dddata) throw(Exception)
+int EditDDResets(const DDid& ddid, DDData& dddata, DDEditor& ed) throw(Exception)
 {
 try {
-   int i,j,ibeg,iend;
+   size_t i,j,ibeg,iend;
 
    // resets[0] will always be the initial count
    if(dddata.resets.size() <= 1) return 0;
 
-   oflog << " Warning - DD " << ddid << " had " << dddata.resets.size()-1
+   ed.log << " Warning - DD " << ddid << " had " << dddata.resets.size()-1
       << " resets between " << dddata.count[1]
       << " and " << dddata.count[dddata.count.size()-1] << " :";
    for(i=1; i<dddata.resets.size(); i++)
-      oflog << " " << dddata.count[dddata.resets[i]]
+      ed.log << " " << dddata.count[dddata.resets[i]]
          << "[" << dddata.resets[i] << "]";
-   oflog << endl;
+   ed.log << endl;
 
    //for(i=1; i<dddata.resets.size(); i++) {
    //   // difference in index
@@ -325,21 +426,21 @@ try {
       }
    }
 
-   if(CI.Verbose) oflog << " Delete data due to reset for DD " << ddid
+   if(CI.Verbose) ed.log << " Delete data due to reset for DD " << ddid
       << " in the range " << ibeg << " to " << iend << endl;
 
       // mark all points from beginning to just before the 'ibeg' reset
-   for(i=0; i<ibeg; i++) if(mark[i]==1) {
-      mark[i] = 0;
-      ngood--;
-      nbad++;
+   for(i=0; i<ibeg; i++) if(ed.mark[i]==1) {
+      ed.mark[i] = 0;
+      ed.ngood--;
+      ed.nbad++;
    }
    
       // mark all points from 'iend' reset to the end
-   for(i=iend; i<dddata.count.size(); i++) if(mark[i]==1) {
-      mark[i] = 0;
-      ngood--;
-      nbad++;
+   for(i=iend; i<dddata.count.size(); i++) if(ed.mark[i]==1) {
+      ed.mark[i] = 0;
+      ed.ngood--;
+      ed.nbad++;
    }
 
    return 0;
@@ -350,7 +451,8 @@ catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 }
 
 //------------------------------------------------------------------------------------
-int EditDDIsolatedPoints(const DDid& ddid, DDData& dddata) throw(Exception)
+int EditDDIsolatedPoints(const DDid& ddid, DDData& dddata, DDEditor& ed)
+   throw(Exception)
 {
 try {
    //if(CI.Verbose) oflog << "BEGIN EditDDIsolatedPoints()"
@@ -358,11 +460,12 @@ try {
    //   << double(clock()-totaltime)/double(CLOCKS_PER_SEC) << " seconds."
    //   << endl;
 
-   int i,j,gappast,gapfuture;
+   size_t i,j;
+   int gappast,gapfuture;
 
    // loop over all counts
    // i is current (good) point, j is the next good point
-   i = 0; while(i<dddata.count.size() && mark[i]==0) i++;     // find first good pt
+   i = 0; while(i<dddata.count.size() && ed.mark[i]==0) i++;     // find first good pt
 
    gapfuture = CI.MaxGap;
    while(i < dddata.count.size()) {
@@ -370,17 +473,17 @@ try {
 
       // find next good pt
       j = i+1;
-      while(j < dddata.count.size() && mark[j]==0) j++;
+      while(j < dddata.count.size() && ed.mark[j]==0) j++;
 
       if(j < dddata.count.size()) gapfuture = dddata.count[j] - dddata.count[i];
       else                        gapfuture = CI.MaxGap;
 
       if(gappast >= CI.MaxGap && gapfuture >= CI.MaxGap) {
-         if(CI.Verbose) oflog << " Mark isolated " << ddid
+         if(CI.Verbose) ed.log << " Mark isolated " << ddid
             << " " << dddata.count[i] << endl;
-         mark[i] = 0;
-         ngood--;
-         nbad++;
+         ed.mark[i] = 0;
+         ed.ngood--;
+         ed.nbad++;
       }
 
       i = j;
@@ -394,7 +497,8 @@ catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 }
 
 //------------------------------------------------------------------------------------
-int EditDDSlips(const DDid& ddid, DDData& dddata, int frequency) throw(Exception)
+int EditDDSlips(const DDid& ddid, DDData& dddata, int frequency, DDEditor& ed)
+   throw(Exception)
 {
 try {
    int i,j,k,n,m,tdcount,tddt,ii,iter;
@@ -424,7 +528,7 @@ try {
          // compute triple differences
          // j is the index of the previous good point
       for(k=0,j=-1,i=0; i<dddata.count.size(); i++) {
-         if(mark[i] == 0) {
+         if(ed.mark[i] == 0) {
             //oflog << "Data 1 marked at count " << dddata.count[i] << endl;
             continue;
          }
@@ -447,7 +551,7 @@ try {
             // look for slips
             // if frac > 0.2, call it a slip anyway and hope it will be combined
          if(fabs(slip) > tol) {  // || fslip > 0.2) 
-            oflog << " Warning - DD " << ddid << " L" << frequency << fixed
+            ed.log << " Warning - DD " << ddid << " L" << frequency << fixed
                << " slip " << setprecision(3) << setw(8) << slip << " cycles, at "
                << printTime(tt," %4F %10.3g = %Y/%02m/%02d %2H:%02M:%6.3f")
                << " = count " << dddata.count[i] << " on iteration " << iter
@@ -460,12 +564,12 @@ try {
                slipsize[n-1] += slip;
                   // mark all points from old slip to pt before this as bad
                for(m=slipindex[n-1]; m<i; m++) {
-                  mark[m] = 0;
-                  ngood--;
-                  nbad++;
+                  ed.mark[m] = 0;
+                  ed.ngood--;
+                  ed.nbad++;
                }
                slipindex[n-1] = i;
-               oflog << " Warning - DD " << ddid << " L" << frequency << fixed
+               ed.log << " Warning - DD " << ddid << " L" << frequency << fixed
                      << " last two slips combined (iter " << iter << ")"
                      << endl;
             }
@@ -475,8 +579,8 @@ try {
             }
          }
 #endif
-         if(tddofs) {
-            tddofs << "TDS " << ddid << " L" << frequency << fixed
+         if(ed.tdd) {
+            *ed.tdd << "TDS " << ddid << " L" << frequency << fixed
                << " " << iter
                << " " << setw(4) << dddata.count[i]
                << " " << printTime(tt,"%4F %10.3g")
@@ -501,7 +605,7 @@ try {
          mad = Robust::MedianAbsoluteDeviation(&td[0], td.size(), median);
          mest = Robust::MEstimate(&td[0], td.size(), median, mad, &weights[0]);
 
-         oflog << " TUR " << ddid << " L" << frequency << fixed << setprecision(3)
+         ed.log << " TUR " << ddid << " L" << frequency << fixed << setprecision(3)
             << " " << iter
             << " " << setw(5) << tsstats.N()
             << " " << setw(7) << tsstats.AverageY()
@@ -530,7 +634,7 @@ try {
          // ii is slip count, k is current correction in cycles,
          // j is index of previous good point
       for(k=0,j=-1,ii=0,i=0; i<dddata.count.size(); i++) {
-         if(mark[i] == 0) {
+         if(ed.mark[i] == 0) {
             //oflog << "Data 2 marked at " << dddata.count[i] << endl;
             continue;
          }
@@ -538,7 +642,7 @@ try {
             // fix
          if(i == slipindex[ii]) {     // new slip on this count
             k += int(slipsize[ii] + (slipsize[ii]>0 ? 0.5 : -0.5));
-            if(CI.Verbose) oflog << " Fix L" << frequency << " slip at count "
+            if(CI.Verbose) ed.log << " Fix L" << frequency << " slip at count "
                << dddata.count[i]
                << " " << printTime(tt,"%4F %10.3g")
                << " total mag " << k << " iteration " << iter
@@ -551,8 +655,8 @@ try {
             else               dddata.DDL2[i] -= k * wl2;
          }
             // output the slip-edited DDs and TDs
-         if(tddofs) {
-            tddofs << "SED " << ddid << fixed
+         if(ed.tdd) {
+            *ed.tdd << "SED " << ddid << fixed
                << " L" << frequency
                << " " << iter
                << " " << setw(4) << dddata.count[i]
@@ -577,7 +681,7 @@ try {
    } // end for loop over iterations
 
       // failed - return non-zero to delete the whole segment
-   oflog << " Warning - Delete " << ddid << " L" << frequency
+   ed.log << " Warning - Delete " << ddid << " L" << frequency
       << ": unable to fix slips" << endl;
 
    return -1;
@@ -598,7 +702,8 @@ catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 // ASWA CTRA G11 G14  T202B
 // ASWA CTRA G16 G25  T202D
 // ASWA CTRA G20 G25  T202D
-int EditDDOutliers(const DDid& ddid, DDData& dddata, int frequency) throw(Exception)
+int EditDDOutliers(const DDid& ddid, DDData& dddata, int frequency, DDEditor& ed)
+   throw(Exception)
 {
 try {
    int i,j,n,tol;
@@ -620,7 +725,7 @@ try {
 
          // pull out the good data, count it and ...
       for(M=0,i=0; i<len; i++) {
-         if(mark[i] == 0) continue;             // skip the bad points
+         if(ed.mark[i] == 0) continue;             // skip the bad points
 
          if(frequency == 1)
             dat[M] = dddata.DDL1[i] - dddata.DDER[i];
@@ -642,12 +747,13 @@ try {
          // ... compute stats on it
       tsstats.Reset();
       tsstats.Add(cnt,dat);
+      weights.resize(dat.size());
       mad = Robust::MedianAbsoluteDeviation(&dat[0], dat.size(), median);
       mest = Robust::MEstimate(&dat[0], dat.size(), median, mad, &weights[0]);
 
          // print stats to log
       if(CI.Verbose) {
-         oflog << " SUR " << ddid << " L" << frequency << " " << iter
+         ed.log << " SUR " << ddid << " L" << frequency << " " << iter
             << fixed << setprecision(3)
             << " " << setw(5) << tsstats.N()
             << " " << setw(7) << tsstats.AverageY()
@@ -662,7 +768,7 @@ try {
          // only continue if the conditional sigma is high...
       if(tsstats.SigmaYX() <= tolsigyx) return 0; // success
 
-      oflog << " Warning - high sigma (" << iter << ") for "
+      ed.log << " Warning - high sigma (" << iter << ") for "
          << ddid << " L" << frequency << " : " << fixed
          << setprecision(3) << setw(7) << tsstats.SigmaYX() << endl;
 
@@ -671,7 +777,7 @@ try {
 
          // sigma stripping ... robust fit to quadratic is too slow...
       for(n=j=0,i=0; i<len; i++) {
-         if(mark[i] == 0) continue;              // skip the bad points
+         if(ed.mark[i] == 0) continue;              // skip the bad points
 
          //oflog << "HIS " << ddid
          //   << " L" << frequency << " " << setw(3) << i
@@ -681,15 +787,15 @@ try {
          //   << endl;
 
          if(fabs(dat[j]) > tolsigstrip*mad) {
-            if(CI.Verbose) oflog << " Warning - mark outlier " << ddid
+            if(CI.Verbose) ed.log << " Warning - mark outlier " << ddid
                << " L" << frequency << fixed << setprecision(3)
                << " count " << dddata.count[i]
                << " ddph " << dat[j]
                << " res/sig " << fabs(dat[j])/(tolsigstrip*mad)
                << endl;
-            mark[i] = 0;
-            ngood--;
-            nbad++;
+            ed.mark[i] = 0;
+            ed.ngood--;
+            ed.nbad++;
             n++;
          }
          j++;
@@ -698,7 +804,7 @@ try {
    }  // end iteration loop
 
       // failed - return non-zero to delete the whole segment
-   oflog << " Warning - Delete " << ddid << " L" << frequency
+   ed.log << " Warning - Delete " << ddid << " L" << frequency
       << " : unable to sigma strip" << endl;
 
    return -1;
@@ -724,7 +830,7 @@ try {
       // robust LS will return weights in data Vector = weights
    i = robfit.leastSquaresEstimation(weights,sol,cov,&LSPolyFunc);
    if(i) {
-      oflog << " Warning - outlier check: robust fit for " << ddid
+      ed.log << " Warning - outlier check: robust fit for " << ddid
          << " returned " << i << endl;
       if(i==-1) return i;     // underdetermined
       if(i==-2) return i;     // singular
@@ -746,11 +852,11 @@ try {
       // Loop over counts (epochs)
    for(j=0,i=0; i<len; i++) {
 
-      if(mark[i] == 0) continue;              // skip the bad points
+      if(ed.mark[i] == 0) continue;              // skip the bad points
 
       double resnorm = fabs(residuals[j]/stats.StdDev());
 
-      if(CI.Verbose) oflog << "FIT " << ddid    // TD debug?
+      if(CI.Verbose) ed.log << "FIT " << ddid    // TD debug?
          << " " << setw(3) << i
          << " " << setw(3) << dddata.count[i]
          << fixed << setprecision(3)
@@ -762,15 +868,15 @@ try {
          << endl;
 
       if(weights[j] <= 0.25 && resnorm > 4.0) {
-         if(CI.Verbose) oflog << " Warning - mark outlier " << ddid
+         if(CI.Verbose) ed.log << " Warning - mark outlier " << ddid
             << fixed << setprecision(3)
             << " count " << dddata.count[i]
             << " weight " << weights[j]
             << " res/sig " << resnorm
             << endl;
-         mark[i] = 0;
-         ngood--;
-         nbad++;
+         ed.mark[i] = 0;
+         ed.ngood--;
+         ed.nbad++;
       }
 
       j++;
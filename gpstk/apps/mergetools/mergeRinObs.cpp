@@ -45,13 +45,7 @@
 
 
 
-#include "RinexObsStream.hpp"
-#include "RinexObsHeader.hpp"
-#include "RinexObsData.hpp"
-#include "RinexObsFilterOperators.hpp"
-#include "FileFilterFrameWithHeader.hpp"
-#include "SystemTime.hpp"
-#include "CivilTime.hpp"
+#include "RinexObsMerge.hpp"
 
 #include "MergeFrame.hpp"
 
@@ -64,41 +58,31 @@ public:
    MergeRinObs(char* arg0)
       : MergeFrame(arg0, 
                    std::string("RINEX Obs"),
-                   std::string("The output will be sorted by time. This program assumes all the input files are from the same station."))
+                   std::string("The output will be sorted by time. This program assumes all the input files are from the same station.")),
+        reformatOption('r', "reformat", "Read all the input into memory, "
+                       "sort it and reformat every epoch, instead of merging "
+                       "the (time ordered) inputs epoch by epoch as text.")
    {}
 
 protected:
    virtual void process();
+
+private:
+   CommandOptionNoArg reformatOption;
 };
 
 void MergeRinObs::process()
 {
    std::vector<std::string> files = inputFileOption.getValue();
+   std::string outputFile = outputFileOption.getValue().front();
 
-      // FFF will sort and merge the obs data using
-      // a simple time check
-   FileFilterFrameWithHeader<RinexObsStream, RinexObsData, RinexObsHeader> 
-      fff(files);
-
-      // get the header data
-   RinexObsHeaderTouchHeaderMerge merged;
-   fff.touchHeader(merged);
-
-      // sort and filter the data using the obs set from the merged header
-   fff.sort(RinexObsDataOperatorLessThanFull(merged.obsSet));
-   fff.unique(RinexObsDataOperatorEqualsSimple());
-   
-      // set the time of first obs in the header
-   merged.theHeader.firstObs = fff.front().time;
+   if (!reformatOption.getCount() && streamMergeRinexObs(files, outputFile))
+      return;
 
-      // set the pgm/runby/date field
-   merged.theHeader.fileProgram = std::string("mergeRinObs");
-   merged.theHeader.fileAgency = std::string("gpstk");
-   merged.theHeader.date = CivilTime(SystemTime()).asString();
+   if (!reformatOption.getCount() && verboseLevel)
+      cout << "Input is not in time order; sorting it in memory" << endl;
 
-      // write the file
-   std::string outputFile = outputFileOption.getValue().front();
-   fff.writeFile(outputFile, merged.theHeader);
+   sortMergeRinexObs(files, outputFile);
 }
 
 int main(int argc, char* argv[])
@@ -0,0 +1,165 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2004, The University of Texas at Austin
+//
+//============================================================================
+
+#include <cmath>
+#include <pthread.h>
+
+#include "GNSSconstants.hpp"
+#include "StringUtils.hpp"
+#include "CACodeGenerator.hpp"
+#include "CACodeTable.hpp"
+
+using namespace std;
+
+// Guards the map of tables and the replicas of every table
+static pthread_mutex_t tableLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+CACodeTable::CACodeTable(int prn)
+   : prn(prn)
+{
+   gpstk::CACodeGenerator gen(prn);
+   for (int w = 0; w < 32; w++)
+      bits[w] = 0;
+   for (int i = 0; i < codeLength; i++, ++gen)
+   {
+      if (*gen)
+         bits[i >> 5] |= uint32_t(1) << (31 - (i & 31));
+      levels[i] = *gen ? 1 : -1;
+   }
+}
+
+
+const CACodeTable& CACodeTable::get(int prn)
+   throw(gpstk::InvalidParameter)
+{
+   if (prn < 1 || prn > 37)
+   {
+      gpstk::InvalidParameter e("CACodeTable: invalid PRN " +
+                                gpstk::StringUtils::asString(prn));
+      GPSTK_THROW(e);
+   }
+
+   // Made once and never freed; every caller holds on to references.
+   static map<int, CACodeTable*> tables;
+
+   pthread_mutex_lock(&tableLock);
+   map<int, CACodeTable*>::const_iterator i = tables.find(prn);
+   CACodeTable* t = (i == tables.end() ? NULL : i->second);
+   pthread_mutex_unlock(&tableLock);
+   if (t)
+      return *t;
+
+   // Made outside the lock, so that nothing thrown leaves it held; if
+   // another thread made the table meanwhile, that one is kept.
+   CACodeTable* made = new CACodeTable(prn);
+   pthread_mutex_lock(&tableLock);
+   try
+   {
+      t = tables.insert(make_pair(prn, made)).first->second;
+   }
+   catch (...)
+   {
+      pthread_mutex_unlock(&tableLock);
+      delete made;
+      throw;
+   }
+   pthread_mutex_unlock(&tableLock);
+   if (t != made)
+      delete made;
+   return *t;
+}
+
+
+void CACodeTable::sample(float* out, size_t n, double chipsPerSample,
+                         double phase) const
+{
+   long index = long(floor(phase));
+   double codePhase = phase - index;
+   index %= codeLength;
+   if (index < 0)
+      index += codeLength;
+
+   for (size_t k = 0; k < n; k++)
+   {
+      out[k] = levels[index];
+
+      // CCReplica::tick() and wrapCode()
+      codePhase += chipsPerSample;
+      if (codePhase < 1)
+         continue;
+      if (codePhase < 2)
+      {
+         codePhase -= 1;
+         index++;
+      }
+      else
+      {
+         long dc = static_cast<long>(codePhase);
+         index += dc;
+         codePhase -= dc;
+      }
+      if (index >= codeLength)
+         index %= codeLength;
+   }
+}
+
+
+const vector<float>& CACodeTable::replica(double sampleRate, size_t n) const
+{
+   typedef map<pair<double, size_t>, vector<float> > ReplicaMap;
+   const pair<double, size_t> key(sampleRate, n);
+
+   pthread_mutex_lock(&tableLock);
+   ReplicaMap::const_iterator i = replicas.find(key);
+   const vector<float>* r = (i == replicas.end() ? NULL : &i->second);
+   pthread_mutex_unlock(&tableLock);
+   if (r)
+      return *r;
+
+   // Sampled outside the lock, as the tables are in get()
+   vector<float> made(n);
+   if (n)
+   {
+      // chipsPerTick as CCReplica computes it, so the phases round alike
+      sample(&made[0], n, (1 / sampleRate) * gpstk::CA_CHIP_FREQ_GPS);
+   }
+
+   pthread_mutex_lock(&tableLock);
+   try
+   {
+      pair<ReplicaMap::iterator, bool> ins =
+         replicas.insert(make_pair(key, vector<float>()));
+      if (ins.second)
+         ins.first->second.swap(made);
+      r = &ins.first->second;
+   }
+   catch (...)
+   {
+      pthread_mutex_unlock(&tableLock);
+      throw;
+   }
+   pthread_mutex_unlock(&tableLock);
+   return *r;
+}
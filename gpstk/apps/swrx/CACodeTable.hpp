@@ -0,0 +1,94 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2004, The University of Texas at Austin
+//
+//============================================================================
+
+#ifndef CACODETABLE_HPP
+#define CACODETABLE_HPP
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "gpstkplatform.h"
+#include "Exception.hpp"
+
+//-----------------------------------------------------------------------------
+// One period of the C/A code of a PRN, generated once with a
+// CACodeGenerator and kept for the life of the program, so that whoever
+// needs the whole code (a simulator, an acquisition) looks the chips up
+// instead of clocking the shift registers again.
+//
+// The chips are kept packed, 32 to a word with the first chip in the most
+// significant bit, and as +1/-1 floats. Replicas of the period sampled at
+// a given rate are made on demand and kept too.
+//
+// get() and replica() may be called from several threads; the tables are
+// never changed once made.
+//-----------------------------------------------------------------------------
+class CACodeTable
+{
+public:
+   static const int codeLength = 1023;
+
+   // The table of a PRN, 1 through 37, made on the first call
+   static const CACodeTable& get(int prn)
+      throw(gpstk::InvalidParameter);
+
+   int getPRN() const { return prn; }
+
+   // Chip i of the period, as CACodeGenerator gives it
+   bool chip(int i) const
+   { return (bits[i >> 5] >> (31 - (i & 31))) & 1; }
+
+   // The period packed, first chip in the MSB of word 0; the last 9 bits
+   // of word 31 are zero.
+   const uint32_t* packed() const { return bits; }
+
+   // The period as +1 (chip set) and -1
+   const float* chips() const { return levels; }
+
+   // Writes n samples of the code, +1/-1, starting 'phase' chips into the
+   // period and advancing chipsPerSample chips per sample. The phase is
+   // carried the way CCReplica::tick() carries it, so these are the
+   // samples a CCReplica of the same rate would give.
+   void sample(float* out, size_t n, double chipsPerSample,
+               double phase = 0) const;
+
+   // n samples at sampleRate Hz from the start of the period, made on the
+   // first call for each rate and length. The reference stays valid.
+   const std::vector<float>& replica(double sampleRate, size_t n) const;
+
+private:
+   CACodeTable(int prn);
+
+   int prn;
+   uint32_t bits[32];
+   float levels[codeLength];
+
+   mutable std::map<std::pair<double, size_t>, std::vector<float> > replicas;
+
+   CACodeTable(const CACodeTable&);
+   CACodeTable& operator=(const CACodeTable&);
+};
+
+#endif
@@ -24,6 +24,8 @@
 
 #include "EMLTracker.hpp"
 
+#include "complex_math.h"
+
 using namespace gpstk;
 using namespace std;
 
@@ -38,11 +40,17 @@ EMLTracker::EMLTracker(CCReplica& localReplica, double codeSpacing) :
    dllError(0), dllAlpha(/*6*/3), dllBeta(/*0.01*/0.005),
    iadCount(0), nav(false), baseGain(1.0/(0.1767*1.404)),
    inSumSq(0), lrSumSq(0),iadThreshold(0.02),
-   dllMode(dmFar), pllMode(pmUnlocked), navChange(true), prevNav(true),periodCount(10),prn(0)
+   dllMode(dmFar), pllMode(pmUnlocked), navChange(true), prevNav(true),periodCount(10),prn(0),
+   early(0), prompt(0), late(0), codePos(0), codeCount(0)
 {
-   early.setDelay(2*eplSpacing);
-   prompt.setDelay(eplSpacing);
-   late.setDelay(0);
+   // The late code is delayed by one sample, the prompt one by the
+   // spacing more, and the early one by twice the spacing more.
+   earlyDelay = 2*eplSpacing + 1;
+   promptDelay = eplSpacing + 1;
+   unsigned lineSize = 1;
+   while (lineSize <= earlyDelay)
+      lineSize <<= 1;
+   codeLine.resize(lineSize, 0);
 
    // Since our 'prompt' code is really a late code we should really advance 
    // our local replica by this amount but not have it count as part of our
@@ -60,6 +68,17 @@ EMLTracker::EMLTracker(CCReplica& localReplica, double codeSpacing) :
 };
 
 
+unsigned GenericTracker::process(const complex<float>* in, unsigned n,
+                                 bool& dumped)
+{
+   dumped = false;
+   unsigned i = 0;
+   while (i < n && !dumped)
+      dumped = process(complex<double>(in[i++]));
+   return i;
+}
+
+
 bool EMLTracker::process(complex<double> in)
 {
       //if(periodCount%10 == 0)
@@ -69,23 +88,58 @@ bool EMLTracker::process(complex<double> in)
          //else if(periodCount%10 != 0)
          //periodCount++;
 
-   if (++iadCount == iadCountMax)
-   {
-      updateLoop();
-      // and dump our accumulators
-      early.dump();
-      prompt.dump();
-      late.dump();
-      inSumSq = 0;
-      lrSumSq = 0;
-      iadCount=0;
-         //periodCount++;
-      return true;
-   }
-   
-   
+   ++iadCount;
+   return closeLoop();
+}
+
+
+unsigned EMLTracker::process(const complex<float>* in, unsigned n,
+                             bool& dumped)
+{
+   n = min(n, samplesToDump());
+
+   // The block integration follows the code phase in whole chips; if
+   // the code moves by a chip or more per sample, use the per sample
+   // version.
+   const double codePhaseDelta = localReplica.chipsPerTick
+                                 + localReplica.codeFreqOffset;
+   if (codePhaseDelta < 0 || codePhaseDelta >= 1 ||
+       localReplica.codePhase < 0 || localReplica.codePhase >= 1)
+      return GenericTracker::process(in, n, dumped);
+
+   integrateBlock(in, n);
+
+   iadCount += n;
+   dumped = closeLoop();
+   return n;
+}
+
 
-   return false;
+// Closes the loops and dumps the accumulators when the integration is
+// complete. Returns true when it did.
+bool EMLTracker::closeLoop()
+{
+   if (iadCount != iadCountMax)
+      return false;
+
+   updateLoop();
+   // and dump our accumulators
+   early = prompt = late = 0;
+   inSumSq = 0;
+   lrSumSq = 0;
+   iadCount=0;
+      //periodCount++;
+   return true;
+}
+
+
+void EMLTracker::pushCode(float code)
+{
+   const unsigned mask = codeLine.size() - 1;
+   if (codeCount++ == 0)
+      fill(codeLine.begin(), codeLine.end(), code);
+   codePos = (codePos + 1) & mask;
+   codeLine[codePos] = code;
 }
 
 
@@ -105,9 +159,11 @@ void EMLTracker::integrate(complex<double> in)
 
    // and sum them up.. (yea, the conj of the codes should be a NoOp)
    code = conj(code);
-   early.process(m0, code);
-   prompt.process(m0, code);
-   late.process(m0, code);
+   pushCode(code.real());
+   const unsigned mask = codeLine.size() - 1;
+   early += m0 * static_cast<double>(codeLine[(codePos - earlyDelay) & mask]);
+   prompt += m0 * static_cast<double>(codeLine[(codePos - promptDelay) & mask]);
+   late += m0 * static_cast<double>(codeLine[(codePos - 1) & mask]);
 
    // Update our sums for normalizing things...
    complex<double> lr = conj(carrier) * code;
@@ -116,23 +172,148 @@ void EMLTracker::integrate(complex<double> in)
 }
 
 
+// Sums of the products of the mixed samples (i, q) with the codes c,
+// in float. The eight partial sums are independent so that the
+// compiler can keep them in vector registers.
+static inline void correlate(const float* i, const float* q, const float* c,
+                             unsigned n, complex<double>& sum)
+{
+   float si[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+   float sq[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+   unsigned k = 0;
+   for (; k + 8 <= n; k += 8)
+      for (int l = 0; l < 8; l++)
+      {
+         si[l] += i[k+l] * c[k+l];
+         sq[l] += q[k+l] * c[k+l];
+      }
+
+   double ti = 0, tq = 0;
+   for (int l = 0; l < 8; l++)
+   {
+      ti += si[l];
+      tq += sq[l];
+   }
+   for (; k < n; k++)
+   {
+      ti += i[k] * c[k];
+      tq += q[k] * c[k];
+   }
+   sum += complex<double>(ti, tq);
+}
+
+
+// Integrates n samples at once; n must not go past the dump, and the code
+// must move by less than a chip per sample.
+void EMLTracker::integrateBlock(const complex<float>* in, unsigned n)
+{
+   CCReplica& r = localReplica;
+
+   // The code of sample k is in blockCode[h + k]; the h before are the
+   // last codes of the delay line, oldest first.
+   const unsigned h = earlyDelay;
+   blockI.resize(n);
+   blockQ.resize(n);
+   blockCode.resize(h + n);
+   blockChip.resize(n);
+
+   // The replica, as n calls to CCReplica::tick() would move it. The
+   // carrier is a phasor rotated by the phase step, and computed again
+   // from the phase every 'resync' samples.
+   const unsigned resync = 256;
+   const double codePhaseDelta = r.chipsPerTick + r.codeFreqOffset;
+   const double carrierUpdate = r.cyclesPerTick + r.carrierFreqOffset;
+   const complex<double> rotate = sincos(2.0*gpstk::PI*carrierUpdate);
+   complex<double> carrier;
+   double gainSq = baseGain * baseGain;
+   double inSq = 0, lrSq = 0;
+   unsigned chips = 0;
+
+   for (unsigned k = 0; k < n; k++)
+   {
+      r.localTime += r.tickSize;
+
+      r.codePhase += codePhaseDelta;
+      r.codePhaseOffset += r.codeFreqOffset;
+      if (r.codePhase >= 1)
+      {
+         r.codePhase -= 1;
+         chips++;
+      }
+      blockChip[k] = chips;
+
+      r.carrierPhase += carrierUpdate;
+      r.carrierPhaseOffset += r.carrierFreqOffset;
+      if (k % resync == 0)
+         carrier = r.getCarrier();
+      else
+         carrier *= rotate;
+
+      // mix in the carrier local replica
+      const double ii = in[k].real(), iq = in[k].imag();
+      const double cr = carrier.real(), ci = carrier.imag();
+      blockI[k] = baseGain * (ii*cr + iq*ci);
+      blockQ[k] = baseGain * (iq*cr - ii*ci);
+
+      inSq += ii*ii + iq*iq;
+      lrSq += cr*cr + ci*ci;
+   }
+
+   // The chips the code went through, read from the generator as the
+   // ticks would have moved it
+   gpstk::CodeGenerator& gen = *r.codeGenPtr;
+   blockChipValue.resize(chips + 1);
+   blockChipValue[0] = *gen;
+   for (unsigned c = 1; c <= chips; c++)
+   {
+      ++gen;
+      blockChipValue[c] = *gen;
+   }
+
+   float* code = &blockCode[h];
+   for (unsigned k = 0; k < n; k++)
+      code[k] = blockChipValue[blockChip[k]] ? 1 : -1;
+
+   if (codeCount == 0)
+      fill(codeLine.begin(), codeLine.end(), code[0]);
+   const unsigned mask = codeLine.size() - 1;
+   for (unsigned k = 0; k < h; k++)
+      blockCode[k] = codeLine[(codePos - h + 1 + k) & mask];
+
+   correlate(&blockI[0], &blockQ[0], code - earlyDelay, n, early);
+   correlate(&blockI[0], &blockQ[0], code - promptDelay, n, prompt);
+   correlate(&blockI[0], &blockQ[0], code - 1, n, late);
+
+   // The last codes go in the delay line
+   for (unsigned k = n; k < n + h; k++)
+   {
+      codePos = (codePos + 1) & mask;
+      codeLine[codePos] = blockCode[k];
+   }
+   codeCount += n;
+
+   inSumSq += gainSq * inSq;
+   lrSumSq += lrSq;
+}
+
+
 void EMLTracker::updateLoop()
 {
    sqrtSumSq = sqrt(inSumSq*lrSumSq);
 
-   emag = abs(early()) / sqrtSumSq;
-   pmag = abs(prompt()) / sqrtSumSq;
-   lmag = abs(late()) / sqrtSumSq;
+   emag = abs(early) / sqrtSumSq;
+   pmag = abs(prompt) / sqrtSumSq;
+   lmag = abs(late) / sqrtSumSq;
 
-   pI = prompt().real();
-   pQ = prompt().imag();
+   pI = prompt.real();
+   pQ = prompt.imag();
 
    snr= 10*log10(pmag*pmag/localReplica.tickSize);
 
    dllError = lmag - emag;
-   pllError = atan(prompt().imag() / prompt().real()) / PI;
+   pllError = atan(prompt.imag() / prompt.real()) / PI;
 
-   promptPhase =atan2(prompt().imag(), prompt().real()) / PI;
+   promptPhase =atan2(prompt.imag(), prompt.real()) / PI;
 
    DllMode oldDllMode=dllMode;
    // Do we have any idea where the peak may lie?
@@ -152,7 +333,7 @@ void EMLTracker::updateLoop()
 
    // At this point all that is left on the inphase is the nav data
    prevNav = nav;
-   nav = prompt().real() > 0;
+   nav = prompt.real() > 0;
    if(prevNav != nav)
    {
      navChange = true;
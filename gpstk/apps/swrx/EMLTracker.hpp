@@ -29,11 +29,11 @@
 #include <complex>
 #include <iostream>
 #include <list>
+#include <vector>
 
 #include "GNSSconstants.hpp"
 
 #include "CCReplica.hpp"
-#include "SimpleCorrelator.hpp"
 #include "complex_math.h"
 
 
@@ -53,6 +53,17 @@ public:
    // It returns true when a dump was performed
    virtual bool process(std::complex<double> s) = 0;
 
+   // Processes up to n consecutive samples, stopping right after a dump
+   // so that its results can be used. Returns the number of samples
+   // used; 'dumped' tells whether the last one caused a dump. This one
+   // just calls process() for each sample.
+   virtual unsigned process(const std::complex<float>* in, unsigned n,
+                            bool& dumped);
+
+   // The number of samples until the next dump, so that a whole
+   // integration can be given to the block process() at once.
+   virtual unsigned samplesToDump() const = 0;
+
    CCReplica& localReplica;
 };
 
@@ -74,6 +85,18 @@ public:
 
    virtual bool process(std::complex<double> in);
 
+   /// Block version of process(), equivalent to calling it for each
+   /// sample. The code chips for the block are read from the code
+   /// generator once, the carrier is generated by rotating a phasor, and
+   /// the early, prompt and late sums are accumulated in float, in loops
+   /// the compiler can vectorize. The loops are closed at the end of the
+   /// block, as the per sample version does.
+   virtual unsigned process(const std::complex<float>* in, unsigned n,
+                            bool& dumped);
+
+   virtual unsigned samplesToDump() const
+   { return iadCountMax - iadCount; }
+
    void dump(std::ostream& s, int detail=0) const;
 
    double pllAlpha, pllBeta, dllAlpha, dllBeta;
@@ -102,8 +125,13 @@ public:
 
 private:
    void integrate(std::complex<double> in);
+   void integrateBlock(const std::complex<float>* in, unsigned n);
+   bool closeLoop();
    void updateLoop();
 
+   // Puts the code of the current sample in the delay line
+   void pushCode(float code);
+
    double pllError, dllError, promptPhase;
 
    DllMode dllMode;
@@ -113,9 +141,23 @@ private:
    bool prevNav;
 
 
-   SimpleCorrelator<double> early, prompt, late;
+   // The early, prompt and late sums. They use the code of the local
+   // replica delayed by (in samples) earlyDelay, promptDelay and 1.
+   std::complex<double> early, prompt, late;
+   unsigned earlyDelay, promptDelay;
    double emag, pmag, lmag, pI, pQ;
 
+   // Delay line of the code, with the last codeLine.size() codes; codePos
+   // is where the most recent one is. Its size is a power of two.
+   std::vector<float> codeLine;
+   unsigned codePos;
+   unsigned long codeCount;
+
+   // Work space of integrateBlock()
+   std::vector<float> blockI, blockQ, blockCode;
+   std::vector<unsigned> blockChip;
+   std::vector<bool> blockChipValue;
+
    // These are used to normalize the correlator counts
    double inSumSq, lrSumSq, sqrtSumSq, snr;
 
@@ -0,0 +1,378 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+#include <cmath>
+
+#include "GNSSconstants.hpp"
+#include "StringUtils.hpp"
+#include "CACodeTable.hpp"
+#include "FFTAcquirer.hpp"
+
+using namespace gpstk;
+using namespace std;
+
+//-----------------------------------------------------------------------------
+class FFTAcquirer::CodeTask : public ThreadPool::Task
+{
+public:
+   CodeTask() : acq(NULL), prn(0), spectrum(NULL), failed(false) {}
+
+   virtual void run() throw()
+   {
+      try
+      {
+         acq->makeCodeSpectrum(prn, spectrum);
+      }
+      catch (...)
+      {
+         failed = true;
+      }
+   }
+
+   const FFTAcquirer* acq;
+   int prn;
+   Sample* spectrum;
+   bool failed;
+};
+
+
+//-----------------------------------------------------------------------------
+// Searches bins first, first + stride, ... for all the codes, and keeps
+// the best peak of each.
+class FFTAcquirer::BinTask : public ThreadPool::Task
+{
+public:
+   BinTask()
+      : acq(NULL), samples(NULL), codes(NULL), first(0), stride(1),
+        failed(false)
+   {}
+
+   virtual void run() throw()
+   {
+      try
+      {
+         acq->searchBins(*this);
+      }
+      catch (...)
+      {
+         failed = true;
+      }
+   }
+
+   const FFTAcquirer* acq;
+   const complex<float>* samples;
+   const vector<const Sample*>* codes;
+   int first, stride;
+   vector<Result> best;
+   bool failed;
+};
+
+
+//-----------------------------------------------------------------------------
+FFTAcquirer::FFTAcquirer(double sampleRate, double interFreq,
+                         double searchWidth, double binWidth,
+                         int periods, int blocks, unsigned threads)
+   throw(Exception)
+   : sampleRate(sampleRate), interFreq(interFreq),
+     searchWidth(searchWidth), binWidth(binWidth),
+     blockSize(int(sampleRate * 1e-3 * periods)), numBlocks(blocks),
+     bins(binWidth > 0 ? int(searchWidth / binWidth) + 1 : 0),
+     numThreads(threads ? threads : ThreadPool::processorCount()),
+     periodSamples(sampleRate * 1e-3),
+     forward(NULL), backward(NULL), pool(NULL)
+{
+   if (blockSize < 1 || numBlocks < 1 || bins < 1)
+   {
+      InvalidParameter e("FFTAcquirer: empty search");
+      GPSTK_THROW(e);
+   }
+
+   // The planner may write to the buffers, and the buffers given later to
+   // fftw_execute_dft() must be aligned like these, hence fftw_malloc.
+   Sample* a = allocate(blockSize);
+   Sample* b = allocate(blockSize);
+   forward = fftw_plan_dft_1d(blockSize, reinterpret_cast<fftw_complex*>(a),
+                              reinterpret_cast<fftw_complex*>(b),
+                              FFTW_FORWARD, FFTW_MEASURE);
+   backward = fftw_plan_dft_1d(blockSize, reinterpret_cast<fftw_complex*>(a),
+                               reinterpret_cast<fftw_complex*>(b),
+                               FFTW_BACKWARD, FFTW_MEASURE);
+   fftw_free(a);
+   fftw_free(b);
+
+   if (numThreads > unsigned(bins))
+      numThreads = bins;
+   if (numThreads > 1)
+   {
+      try
+      {
+         pool = new ThreadPool(numThreads);
+      }
+      catch (Exception&)
+      {
+         pool = NULL;          // search in this thread instead
+         numThreads = 1;
+      }
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+FFTAcquirer::~FFTAcquirer()
+{
+   delete pool;
+   map<int, Sample*>::iterator i;
+   for (i = codeSpectra.begin(); i != codeSpectra.end(); i++)
+      fftw_free(i->second);
+   fftw_destroy_plan(forward);
+   fftw_destroy_plan(backward);
+}
+
+
+//-----------------------------------------------------------------------------
+FFTAcquirer::Sample* FFTAcquirer::allocate(int n)
+{
+   return reinterpret_cast<Sample*>(fftw_malloc(sizeof(fftw_complex) * n));
+}
+
+
+//-----------------------------------------------------------------------------
+void FFTAcquirer::makeCodeSpectrum(int prn, Sample* spectrum) const
+{
+   Sample* code = allocate(blockSize);
+
+   const vector<float>& chips =
+      CACodeTable::get(prn).replica(sampleRate, blockSize);
+   for (int k = 0; k < blockSize; k++)
+      code[k] = chips[k];
+
+   fftw_execute_dft(forward, reinterpret_cast<fftw_complex*>(code),
+                    reinterpret_cast<fftw_complex*>(spectrum));
+   fftw_free(code);
+
+   // Scaled so that the inverse FFT of the product gives the correlation
+   for (int k = 0; k < blockSize; k++)
+      spectrum[k] = conj(spectrum[k]) / double(blockSize);
+}
+
+
+//-----------------------------------------------------------------------------
+void FFTAcquirer::searchBins(BinTask& task) const
+{
+   const int n = blockSize;
+   const unsigned numCodes = task.codes->size();
+
+   // The vectors, which may throw, come before the FFTW buffers, so that
+   // nothing is leaked; nothing below throws.
+   task.best.resize(numCodes);
+   for (unsigned c = 0; c < numCodes; c++)
+   {
+      task.best[c].bin = -1;
+      task.best[c].height = -1;
+   }
+   vector<double> sum(n);
+   vector<Sample*> spectra(numBlocks);
+
+   Sample* wiped = allocate(n);
+   Sample* product = allocate(n);
+   Sample* corr = allocate(n);
+   for (int j = 0; j < numBlocks; j++)
+      spectra[j] = allocate(n);
+
+   for (int bin = task.first; bin < bins; bin += task.stride)
+   {
+      // Wipe off the carrier, with a phasor that is recomputed from the
+      // sample count every 256 samples so the rounding doesn't build up.
+      const double cyclesPerSample = (interFreq + binDoppler(bin)) / sampleRate;
+      const Sample step = polar(1.0, -2 * PI * cyclesPerSample);
+      Sample lo;
+      for (int j = 0; j < numBlocks; j++)
+      {
+         const complex<float>* in = task.samples + size_t(j) * n;
+         for (int k = 0; k < n; k++)
+         {
+            if (k % 256 == 0)
+            {
+               double cycles = cyclesPerSample * (double(j) * n + k);
+               lo = polar(1.0, -2 * PI * (cycles - floor(cycles)));
+            }
+            wiped[k] = Sample(in[k].real(), in[k].imag()) * lo;
+            lo *= step;
+         }
+         fftw_execute_dft(forward, reinterpret_cast<fftw_complex*>(wiped),
+                          reinterpret_cast<fftw_complex*>(spectra[j]));
+      }
+
+      for (unsigned c = 0; c < numCodes; c++)
+      {
+         const Sample* code = (*task.codes)[c];
+         for (int k = 0; k < n; k++)
+            sum[k] = 0;
+         for (int j = 0; j < numBlocks; j++)
+         {
+            const Sample* spectrum = spectra[j];
+            for (int k = 0; k < n; k++)
+               product[k] = spectrum[k] * code[k];
+            fftw_execute_dft(backward, reinterpret_cast<fftw_complex*>(product),
+                             reinterpret_cast<fftw_complex*>(corr));
+            for (int k = 0; k < n; k++)
+               sum[k] += norm(corr[k]);
+         }
+
+         int peak = 0;
+         for (int k = 1; k < n; k++)
+            if (sum[k] > sum[peak])
+               peak = k;
+
+         double height = sqrt(sum[peak] / (double(numBlocks) * n));
+         Result& best = task.best[c];
+         if (height > best.height)
+         {
+            best.bin = bin;
+            best.height = height;
+            // The correlation peaks at minus the code phase of the input
+            best.shift = (n - peak) % n;
+         }
+      }
+   }
+
+   for (int j = 0; j < numBlocks; j++)
+      fftw_free(spectra[j]);
+   fftw_free(corr);
+   fftw_free(product);
+   fftw_free(wiped);
+}
+
+
+//-----------------------------------------------------------------------------
+void FFTAcquirer::search(const complex<float>* samples,
+                         const vector<int>& prns,
+                         vector<Result>& results)
+{
+   for (unsigned i = 0; i < prns.size(); i++)
+   {
+      if (prns[i] < 1 || prns[i] > 32)
+      {
+         InvalidParameter e("FFTAcquirer: invalid PRN " +
+                            StringUtils::asString(prns[i]));
+         GPSTK_THROW(e);
+      }
+   }
+
+   // The code spectra not computed yet
+   vector<CodeTask> codeTasks;
+   for (unsigned i = 0; i < prns.size(); i++)
+   {
+      if (codeSpectra.count(prns[i]))
+         continue;
+      codeSpectra[prns[i]] = allocate(blockSize);
+      CodeTask t;
+      t.acq = this;
+      t.prn = prns[i];
+      t.spectrum = codeSpectra[prns[i]];
+      codeTasks.push_back(t);
+   }
+
+   vector<BinTask> binTasks(numThreads);
+   vector<const Sample*> codes(prns.size());
+   for (unsigned i = 0; i < prns.size(); i++)
+      codes[i] = codeSpectra[prns[i]];
+   for (unsigned t = 0; t < numThreads; t++)
+   {
+      binTasks[t].acq = this;
+      binTasks[t].samples = samples;
+      binTasks[t].codes = &codes;
+      binTasks[t].first = t;
+      binTasks[t].stride = numThreads;
+   }
+
+   if (pool)
+   {
+      for (unsigned i = 0; i < codeTasks.size(); i++)
+         pool->submit(&codeTasks[i]);
+      pool->wait();
+   }
+   else
+   {
+      for (unsigned i = 0; i < codeTasks.size(); i++)
+         codeTasks[i].run();
+   }
+
+   // Drop every spectrum that failed, so that the next search computes
+   // them again, and report the first.
+   int failedPrn = 0;
+   for (unsigned i = 0; i < codeTasks.size(); i++)
+   {
+      if (codeTasks[i].failed)
+      {
+         fftw_free(codeSpectra[codeTasks[i].prn]);
+         codeSpectra.erase(codeTasks[i].prn);
+         if (!failedPrn)
+            failedPrn = codeTasks[i].prn;
+      }
+   }
+   if (failedPrn)
+   {
+      Exception e("FFTAcquirer: failed to compute the code of PRN " +
+                  StringUtils::asString(failedPrn));
+      GPSTK_THROW(e);
+   }
+
+   if (pool)
+   {
+      for (unsigned t = 0; t < numThreads; t++)
+         pool->submit(&binTasks[t]);
+      pool->wait();
+   }
+   else
+      binTasks[0].run();
+
+   for (unsigned t = 0; t < numThreads; t++)
+   {
+      if (binTasks[t].failed)
+      {
+         Exception e("FFTAcquirer: failed to search the Doppler bins");
+         GPSTK_THROW(e);
+      }
+   }
+
+   // Each task has the best peak of its own bins; ties go to the lower bin
+   // so that the result does not depend on the number of threads.
+   results.resize(prns.size());
+   for (unsigned c = 0; c < prns.size(); c++)
+   {
+      Result& r = results[c];
+      r = binTasks[0].best[c];
+      for (unsigned t = 1; t < numThreads; t++)
+      {
+         const Result& b = binTasks[t].best[c];
+         if (b.height > r.height || (b.height == r.height && b.bin < r.bin))
+            r = b;
+      }
+      r.prn = prns[c];
+      r.doppler = binDoppler(r.bin);
+      while (r.shift >= periodSamples)
+         r.shift = int(r.shift - periodSamples);
+   }
+}
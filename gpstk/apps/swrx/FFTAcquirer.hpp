@@ -0,0 +1,136 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+#ifndef FFTACQUIRER_HPP
+#define FFTACQUIRER_HPP
+
+#include <complex>
+#include <map>
+#include <vector>
+#include <fftw3.h>
+
+#include "Exception.hpp"
+#include "ThreadPool.hpp"
+
+//-----------------------------------------------------------------------------
+// Parallel code phase search of the C/A code of several PRNs at once.
+//
+// The input is cut into blocks of a few C/A periods. Each block is
+// correlated coherently with the code through FFTs, and the squared
+// magnitudes of the correlations of the blocks are summed (non-coherent
+// accumulation).
+//
+// For each Doppler bin the carrier is wiped off the input, and its
+// spectrum is computed once and multiplied by the conjugate spectrum of
+// the code of each PRN. The code Doppler is neglected, so the code spectra
+// do not depend on the bin; they are computed the first time a PRN is
+// searched and kept. The bins are shared among the threads of a pool.
+//
+// The two FFT plans are made once, in the constructor, and run by every
+// thread on its own buffers with fftw_execute_dft(). search() itself is
+// not reentrant.
+//
+// Since this links to FFTW, it is not part of simlib.
+//-----------------------------------------------------------------------------
+class FFTAcquirer
+{
+public:
+   struct Result
+   {
+      int prn;
+
+      // The Doppler bin of the peak, and its offset from the IF, in Hz
+      int bin;
+      double doppler;
+
+      // The code phase of the first sample, in samples, within one C/A
+      // period
+      int shift;
+
+      // The correlation peak; with one block, the magnitude of the
+      // correlation over sqrt(number of samples in a block).
+      double height;
+   };
+
+   // The search covers searchWidth Hz centered on the IF, in steps of
+   // binWidth Hz. Each block is 'periods' C/A periods long and 'blocks'
+   // of them are accumulated. With threads == 0 one thread per processor
+   // is used.
+   FFTAcquirer(double sampleRate, double interFreq,
+               double searchWidth, double binWidth,
+               int periods, int blocks, unsigned threads = 0)
+      throw(gpstk::Exception);
+
+   ~FFTAcquirer();
+
+   // The number of samples search() reads
+   size_t samplesNeeded() const { return size_t(blockSize) * numBlocks; }
+
+   int numBins() const { return bins; }
+
+   // The offset of a Doppler bin from the IF, in Hz
+   double binDoppler(int bin) const
+   { return bin * binWidth - searchWidth / 2; }
+
+   // Searches the samplesNeeded() samples for each PRN in prns; results[i]
+   // is the highest peak of prns[i].
+   void search(const std::complex<float>* samples,
+               const std::vector<int>& prns,
+               std::vector<Result>& results);
+
+private:
+   class CodeTask;
+   class BinTask;
+   friend class CodeTask;
+   friend class BinTask;
+
+   typedef std::complex<double> Sample;
+
+   // Computes the conjugate code spectrum of one PRN
+   void makeCodeSpectrum(int prn, Sample* spectrum) const;
+
+   // Searches the bins of one task for the codes given to it
+   void searchBins(BinTask& task) const;
+
+   static Sample* allocate(int n);
+
+   double sampleRate, interFreq, searchWidth, binWidth;
+   int blockSize, numBlocks, bins;
+   unsigned numThreads;
+
+   // Samples in one C/A period, which need not be a whole number
+   double periodSamples;
+
+   fftw_plan forward, backward;
+
+   // Conjugate code spectra, scaled by 1/blockSize, by PRN
+   std::map<int, Sample*> codeSpectra;
+
+   gpstk::ThreadPool* pool;
+
+   FFTAcquirer(const FFTAcquirer&);
+   FFTAcquirer& operator=(const FFTAcquirer&);
+};
+
+#endif
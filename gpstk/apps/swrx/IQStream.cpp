@@ -24,13 +24,45 @@
 
 #include "IQStream.hpp"
 
+#include <cstring>
+#include <algorithm>
+
 using namespace std;
 
 namespace gpstk
 {
+   // The sum of n bytes, modulo 256, eight bytes at a time. The bytes in
+   // even and odd places are summed in the 16 bit lanes of two words,
+   // which are folded before they can overflow.
+   static unsigned char byteSum(const unsigned char* p, size_t n)
+   {
+      const uint64_t mask = 0x00ff00ff00ff00ffULL;
+      unsigned sum = 0;
+      size_t i = 0;
+      while (i + 8 <= n)
+      {
+         uint64_t even = 0, odd = 0;
+         size_t end = min(n - n % 8, i + 8 * 256);
+         for (; i < end; i += 8)
+         {
+            uint64_t w;
+            memcpy(&w, p + i, 8);
+            even += w & mask;
+            odd += (w >> 8) & mask;
+         }
+         sum += even + (even >> 16) + (even >> 32) + (even >> 48);
+         sum += odd + (odd >> 16) + (odd >> 32) + (odd >> 48);
+      }
+      for (; i < n; i++)
+         sum += p[i];
+      return sum;
+   }
+
+
    void IQStream::init(void)
    {
       frameBuffer = new char[frameLength];
+      frameData = frameBuffer;
       readPtr = frameLength;
       writePtr = 0;
       sampleCounter = 0;
@@ -41,22 +73,24 @@ namespace gpstk
    {
       if (sampleCounter & 0x1)
          cerr << "Uh, we have a problem " << sampleCounter << endl;
-      read(frameBuffer, frameLength);
-      if (gcount() != frameLength)
+      frameData = getView(frameLength);
+      if (!frameData)
+      {
+         frameData = frameBuffer;
          return;
+      }
       if (debugLevel>1)
          cout << "Filled frame buffer" << endl;
       readPtr = 0;
 
-      unsigned char sum=0;
-      for (int i=0; i<frameLength-1; i++)
-         sum+=static_cast<unsigned char>(frameBuffer[i]);
+      const unsigned char* frame =
+         reinterpret_cast<const unsigned char*>(frameData);
+      unsigned char sum = byteSum(frame, frameLength-1);
       if (sum != 0x5a)
          cerr << "IQStream::readComplex() checksum error "
               << hex << sum << dec << endl;
 
-      uint16_t fc = frameBuffer[frameLength-3] & 0x00ff   |
-         frameBuffer[frameLength-4]<<8 & 0xff00;
+      uint16_t fc = frame[frameLength-3] | frame[frameLength-4]<<8;
       int16_t deltaFc = fc - frameCounter;
          
       if (sampleCounter && deltaFc != 1)
@@ -66,7 +100,79 @@ namespace gpstk
 
       if (debugLevel>1)
          gpstk::StringUtils::hexDumpData(
-            cout, string(frameBuffer, frameLength));
+            cout, string(frameData, frameLength));
+   }
+
+
+   size_t IQStream::readBlock(complex<float>* v, size_t n)
+   {
+      size_t i = 0;
+      while (i < n && *this >> v[i])
+         i++;
+      return i;
+   }
+
+
+   void IQStream::writeBlock(const complex<float>* v, size_t n)
+   {
+      for (size_t i = 0; i < n; i++)
+         *this << v[i];
+   }
+
+
+   size_t IQStream::readNibbles(complex<float>* v, size_t n,
+                                const complex<float>* levels)
+   {
+      size_t i = 0;
+      while (i < n)
+      {
+         if (readPtr == frameLength)
+         {
+            readBuffer();
+            if (!*this)
+               break;
+         }
+
+         const uint8_t* frame = reinterpret_cast<const uint8_t*>(frameData);
+
+         // The high nibble of a byte whose low one has been read
+         if (sampleCounter & 0x1)
+         {
+            uint8_t byte = readPtr < metaPtr ? frame[readPtr] : 0;
+            v[i++] = levels[byte >> 4];
+            readPtr++;
+            sampleCounter++;
+            continue;
+         }
+
+         // Whole bytes, up to the end of the frame. Those of the meta
+         // data are read as zero, as readComplex() does.
+         size_t bytes = min((n - i) / 2, size_t(frameLength - readPtr));
+         size_t dataBytes = 0;
+         if (readPtr < metaPtr)
+            dataBytes = min(bytes, size_t(metaPtr - readPtr));
+
+         const uint8_t* p = frame + readPtr;
+         for (size_t k = 0; k < dataBytes; k++, i += 2)
+         {
+            v[i] = levels[p[k] & 0xf];
+            v[i+1] = levels[p[k] >> 4];
+         }
+         for (size_t k = dataBytes; k < bytes; k++, i += 2)
+            v[i] = v[i+1] = levels[0];
+
+         readPtr += bytes;
+         sampleCounter += 2 * bytes;
+
+         // One sample left, in the low nibble
+         if (bytes == 0)
+         {
+            uint8_t byte = readPtr < metaPtr ? frame[readPtr] : 0;
+            v[i++] = levels[byte & 0xf];
+            sampleCounter++;
+         }
+      }
+      return i;
    }
 
 
@@ -75,9 +181,8 @@ namespace gpstk
       frameBuffer[frameLength-3] = frameCounter & 0xff;
       frameBuffer[frameLength-4] = frameCounter>>8 & 0xff;
 
-      unsigned char sum=0;
-      for (int i=0; i<frameLength-2; i++)
-         sum+=static_cast<unsigned char>(frameBuffer[i]);
+      unsigned char sum = byteSum(
+         reinterpret_cast<const unsigned char*>(frameBuffer), frameLength-2);
       frameBuffer[frameLength-2] = 0x5a-sum;
       frameBuffer[frameLength-1] = 0;
 
@@ -102,7 +207,7 @@ namespace gpstk
 
       uint8_t byte;
       if (readPtr < metaPtr)
-         byte = frameBuffer[readPtr];
+         byte = frameData[readPtr];
       else
          byte = 0;
 
@@ -131,6 +236,25 @@ namespace gpstk
    }
 
 
+   //-----------------------------------------------------------------------------
+   size_t IQ1Stream::readBlock(complex<float>* v, size_t n)
+   {
+      complex<float> levels[16];
+      for (int nibble = 0; nibble < 16; nibble++)
+         levels[nibble] = complex<float>((nibble & 4) ? +1 : -1,
+                                         (nibble & 1) ? +1 : -1);
+      return readNibbles(v, n, levels);
+   }
+
+
+   //-----------------------------------------------------------------------------
+   void IQ1Stream::writeBlock(const complex<float>* v, size_t n)
+   {
+      for (size_t i = 0; i < n; i++)
+         IQ1Stream::writeComplex(v[i]);
+   }
+
+
    //-----------------------------------------------------------------------------
    void IQ1Stream::writeComplex(const complex<short>& v)
    {
@@ -183,7 +307,7 @@ namespace gpstk
 
       uint8_t byte;
       if (readPtr < metaPtr)
-         byte = frameBuffer[readPtr];
+         byte = frameData[readPtr];
       else
          byte = 0;
 
@@ -212,6 +336,17 @@ namespace gpstk
    }
 
 
+   //-----------------------------------------------------------------------------
+   size_t IQ2Stream::readBlock(complex<float>* v, size_t n)
+   {
+      complex<float> levels[16];
+      for (int nibble = 0; nibble < 16; nibble++)
+         levels[nibble] = complex<float>(sample2Level[(nibble >> 2) & 0x3],
+                                         sample2Level[nibble & 0x3]);
+      return readNibbles(v, n, levels);
+   }
+
+
    //-----------------------------------------------------------------------------
    template<class T>
    uint8_t IQ2Stream::l2s(T v)
@@ -267,6 +402,14 @@ namespace gpstk
    }
 
 
+   //-----------------------------------------------------------------------------
+   void IQ2Stream::writeBlock(const complex<float>* v, size_t n)
+   {
+      for (size_t i = 0; i < n; i++)
+         writeNibble(l2s(v[i].real()), l2s(v[i].imag()));
+   }
+
+
 
    //-----------------------------------------------------------------------------
    //-----------------------------------------------------------------------------
@@ -275,12 +418,20 @@ namespace gpstk
       const size_t size = 2*sizeof(float);
          
       if (readPtr + size >metaPtr)
+      {
          readBuffer();
+         if (readPtr + size > metaPtr)
+         {
+            v = 0;
+            return;
+         }
+      }
 
-      float i = *(reinterpret_cast<float*>(&frameBuffer[readPtr]));
+      float i, q;
+      memcpy(&i, &frameData[readPtr], sizeof(float));
       readPtr += sizeof(float);
 
-      float q = *(reinterpret_cast<float*>(&frameBuffer[readPtr]));
+      memcpy(&q, &frameData[readPtr], sizeof(float));
       readPtr += sizeof(float);
       sampleCounter++;
 
@@ -297,6 +448,31 @@ namespace gpstk
    }
 
 
+   //-----------------------------------------------------------------------------
+   size_t IQFloatStream::readBlock(complex<float>* v, size_t n)
+   {
+      const size_t size = 2*sizeof(float);
+
+      size_t i = 0;
+      while (i < n)
+      {
+         if (readPtr + size > metaPtr)
+         {
+            readBuffer();
+            if (!*this)
+               break;
+         }
+
+         size_t k = min(n - i, (metaPtr - readPtr) / size);
+         memcpy(&v[i], &frameData[readPtr], k * size);
+         readPtr += k * size;
+         sampleCounter += k;
+         i += k;
+      }
+      return i;
+   }
+
+
    //-----------------------------------------------------------------------------
    void IQFloatStream::writeComplex(const complex<float>& v)
    {
@@ -314,6 +490,26 @@ namespace gpstk
       sampleCounter++;
    }
 
+   //-----------------------------------------------------------------------------
+   void IQFloatStream::writeBlock(const complex<float>* v, size_t n)
+   {
+      const size_t size = 2*sizeof(float);
+
+      size_t i = 0;
+      while (i < n)
+      {
+         if (writePtr + size > metaPtr)
+            writeBuffer();
+
+         size_t k = min(n - i, (metaPtr - writePtr) / size);
+         memcpy(&frameBuffer[writePtr], &v[i], k * size);
+         writePtr += k * size;
+         sampleCounter += k;
+         i += k;
+      }
+   }
+
+
    //-----------------------------------------------------------------------------
    void IQFloatStream::writeComplex(const complex<short>& v)
    {
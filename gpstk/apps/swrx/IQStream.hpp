@@ -86,6 +86,10 @@ namespace gpstk
       /// The current frame of data
       char* frameBuffer;
 
+      /// The frame being read, as getView() returned it: the frame itself
+      /// when the file is mapped
+      const char* frameData;
+
       /// Used to keep track of where we are in the frame
       unsigned readPtr;
       unsigned writePtr;
@@ -115,6 +119,23 @@ namespace gpstk
       /// Writes a single complex sample, 
       virtual void writeComplex(const std::complex<short>& v) = 0;
       virtual void writeComplex(const std::complex<float>& v) = 0;
+
+      /// Reads up to n complex samples into v, the same ones n calls to
+      /// readComplex() would return, and returns the number read. Fewer
+      /// than n are read only at the end of the input, which leaves the
+      /// stream failed as >> does. This one just calls readComplex().
+      virtual size_t readBlock(std::complex<float>* v, size_t n);
+
+      /// Writes n complex samples, as n calls to writeComplex() would.
+      /// This one just calls writeComplex().
+      virtual void writeBlock(const std::complex<float>* v, size_t n);
+
+   protected:
+      /// Decodes up to n samples packed two to a byte, the first in the
+      /// low nibble, through a table of the 16 nibble values. Used by
+      /// the readBlock() of the 1 and 2 bit streams.
+      size_t readNibbles(std::complex<float>* v, size_t n,
+                         const std::complex<float>* levels);
    }; // class IQStream
 
 
@@ -153,6 +174,12 @@ namespace gpstk
       /// Writes a single complex sample, 
       virtual void writeComplex(const std::complex<short>& v);
       virtual void writeComplex(const std::complex<float>& v);
+
+      /// Reads up to n samples, a frame at a time
+      virtual size_t readBlock(std::complex<float>* v, size_t n);
+
+      /// Writes n samples without a virtual call for each
+      virtual void writeBlock(const std::complex<float>* v, size_t n);
    }; // class IQ1Stream
 
 
@@ -185,6 +212,12 @@ namespace gpstk
       /// Writes a single complex sample, 
       virtual void writeComplex(const std::complex<short>& v);
       virtual void writeComplex(const std::complex<float>& v);
+
+      /// Reads up to n samples, a frame at a time
+      virtual size_t readBlock(std::complex<float>* v, size_t n);
+
+      /// Writes n samples without a virtual call for each
+      virtual void writeBlock(const std::complex<float>* v, size_t n);
    private:
       void writeNibble(uint8_t i, uint8_t q);
    }; // class IQ2Stream
@@ -212,6 +245,12 @@ namespace gpstk
       /// Writes a single complex sample, 
       virtual void writeComplex(const std::complex<short>& v);
       virtual void writeComplex(const std::complex<float>& v);
+
+      /// Reads up to n samples, a frame at a time
+      virtual size_t readBlock(std::complex<float>* v, size_t n);
+
+      /// Writes n samples, a frame at a time
+      virtual void writeBlock(const std::complex<float>* v, size_t n);
    }; // class IQ2Stream
 
 } // namespace gpstk
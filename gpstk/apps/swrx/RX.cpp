@@ -51,6 +51,7 @@ hilbert -i data.bin | ./RX -b 1 -q 2 -x 4.13 -r 8.184 -c c:1:30:416.789:-8800 -c
 #include "StringUtils.hpp"
 #include "GNSSconstants.hpp"
 #include "EngNav.hpp"
+#include "ThreadPool.hpp"
 #include "EMLTracker.hpp"
 #include "CCReplica.hpp"
 #include "CACodeGenerator.hpp"
@@ -58,6 +59,7 @@ hilbert -i data.bin | ./RX -b 1 -q 2 -x 4.13 -r 8.184 -c c:1:30:416.789:-8800 -c
 #include "complex_math.h"
 #include "IQStream.hpp"
 #include "NavFramer.hpp"
+#include "SampleRing.hpp"
 #include <CommonTime.hpp>
 #include <GPSEphemerisStore.hpp>
 #include <RinexNavStream.hpp>
@@ -74,30 +76,48 @@ using namespace std;
 #define exp10(x) (exp((x)*log(10.)))
 #endif
 
-struct Buffer // input buffer
+struct Edge // A subframe found by a channel in a block of samples
 {
-   vector< complex<float> > arr;
-}; 
+   bool found;
+   int dataPoint;
+   int zCount;
+};
 
-struct Par // Parameters to pass to Pthread function.
+struct Channel // A tracker and the framer of its nav data
 {
-   int dp;
-   int bufferSize; 
    EMLTracker *tr;
-   Buffer *s;
-   int *count;
-   NavFramer *nf;
-   bool v;       // verbose
+   NavFramer nf;
+   int count;
    int prn;
+
+   // The subframe found in each block of the ring, by slot. It is only
+   // written by the thread tracking this channel while it has the block,
+   // and only read by the main thread once every channel is done with it.
+   vector<Edge> edges;
+};
+
+struct Par // Parameters to pass to Pthread function.
+{
+   SampleRing *ring;
+   unsigned consumer;          // This thread, as a consumer of the ring
+   vector<Channel*> channels;  // The channels tracked by this thread
+   bool v;       // verbose
    bool solvePos;
 };
 
+struct Reader // Parameters of the input thread
+{
+   SampleRing *ring;
+   IQStream *input;
+   double timeStep;
+   double timeLimit;
+};
+
 void *Cfunction(void*); // C-style function to be called with pthreads
+void *readInput(void*);
+void track(Channel& c, const SampleRing::Block& b, bool v, bool solvePos);
 
-pthread_mutex_t mutexVec = PTHREAD_MUTEX_INITIALIZER;
-int dataPoints[32]; // variables needed by position algorithm
-bool edgeFound;
-int ZCount;
+pthread_mutex_t mutexOut = PTHREAD_MUTEX_INITIALIZER; // for the verbose dumps
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -114,6 +134,9 @@ protected:
    virtual void process();
 
 private:
+   // Solves for the position with the subframe edges found so far
+   void solvePosition();
+
    CCReplica* cc;
    vector<EMLTracker*> tr;
    int band;
@@ -128,6 +151,10 @@ private:
    IQStream *input;
    unsigned iadMax;
    int numTrackers;
+   int numThreads;
+
+   int dataPoints[32]; // variables needed by position algorithm
+   int ZCount;
 
    bool solvePos; // If false, no position solutions will be performed (default)
    string ephFile; // Parameters for position solution.
@@ -139,8 +166,12 @@ private:
 RxSim::RxSim() throw() :
    BasicFramework("rxSim", "A simulation of a gps receiver."),
    cc(NULL), tr(0), band(1), timeStep(50e-9), interFreq(0.42e6), 
-   fakeL2(false), gain(1), timeLimit(9e99), iadMax(20460), solvePos(false)
-{}
+   fakeL2(false), gain(1), timeLimit(9e99), iadMax(20460), numThreads(0),
+   ZCount(0), solvePos(false)
+{
+   for(int i = 0; i < 32; i++)
+      dataPoints[i] = 0;
+}
 
 
 bool RxSim::initialize(int argc, char *argv[]) throw()
@@ -208,7 +239,11 @@ bool RxSim::initialize(int argc, char *argv[]) throw()
 
    CommandOptionWithNumberArg 
       bandsOpt('b', "bands",
-               "The number of complex samples per epoch. The default is 2.");
+               "The number of complex samples per epoch. The default is 2."),
+
+      threadsOpt('\0', "threads",
+                 "The number of tracking threads. The default is one per "
+                 "processor, but no more than one per code.");
 
    if (!BasicFramework::initialize(argc,argv)) 
       return false;
@@ -249,7 +284,11 @@ bool RxSim::initialize(int argc, char *argv[]) throw()
       ephFile = ephFileOption.getValue()[0];
    }
 
+   if (threadsOpt.getCount())
+      numThreads = asInt(threadsOpt.getValue()[0]);
+
    numTrackers = codeOpt.getCount();
+   tr.resize(numTrackers);
    for (int i=0; i < codeOpt.getCount(); i++)
    {
       string val=codeOpt.getValue()[i];
@@ -368,207 +407,245 @@ bool RxSim::initialize(int argc, char *argv[]) throw()
 //-----------------------------------------------------------------------------
 void RxSim::process()
 {
-   pthread_t *thread_id = new pthread_t[numTrackers];
+   vector<Channel> ch(numTrackers);
+   for(int i=0;i<numTrackers;i++)
+   {
+      ch[i].tr = tr[i];
+      ch[i].nf.debugLevel = debugLevel;
+      ch[i].nf.dump(cout);
+      ch[i].count = 0;
+      ch[i].prn = tr[i]->prn;
+   }
+
+   int numThreads = this->numThreads;
+   if (numThreads <= 0)
+      numThreads = ThreadPool::processorCount();
+   numThreads = min(numThreads, numTrackers);
+
+   // The input is read ahead in blocks of 10 ms, by a thread of its own.
+   // The tracking threads stay up for the whole run; each tracks every
+   // numThreads-th channel, through every block.
+   const unsigned slots = 16;
+   unsigned blockSize = max(1, int(0.01 / timeStep + 0.5));
+   SampleRing ring(slots, blockSize, numThreads);
+
+   Edge none = {false, 0, 0};
+   for(int i = 0; i < numTrackers; i++)
+      ch[i].edges.assign(slots, none);
+
+   vector<Par> p(numThreads);
+   for(int i = 0; i < numThreads; i++)
+   {
+      p[i].ring = &ring;
+      p[i].consumer = i;
+      p[i].v = (verboseLevel);
+      p[i].solvePos = solvePos;
+   }
+   for(int i = 0; i < numTrackers; i++)
+      p[i % numThreads].channels.push_back(&ch[i]);
+
+   Reader r;
+   r.ring = &ring;
+   r.input = input;
+   r.timeStep = timeStep;
+   r.timeLimit = timeLimit;
+
+   pthread_t reader;
+   vector<pthread_t> thread_id(numThreads);
    pthread_attr_t attr;
    int rc;
    void *status;
 
-   vector<Par> p(numTrackers);
+   pthread_attr_init(&attr);
+   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
-   vector<NavFramer> nf(numTrackers);
-   long int dataPoint =0;
-   vector<int> count(numTrackers); 
-   
-   for(int i=0;i<numTrackers;i++)
+   rc = pthread_create( &reader, &attr, readInput, &r ) ;
+   if (rc)
    {
-      nf[i].debugLevel = debugLevel;
-      nf[i].dump(cout);
-      count[i]=0;
+      printf("ERROR; return code from pthread_create() is %d\n", rc);
+      exit(-1);
    }
-
-   complex<float> s;
-   while (*input >> s)
+   for(int i = 0; i < numThreads; i++)
    {
-      Buffer b;
-      b.arr.push_back(s);
-      dataPoint++;
-      int index = 0;
-      int bufferSize = 40*16367;
-      while(index < bufferSize) // Fill input buffer
-      {   
-         *input >> s;
-         b.arr.push_back(s);   
-         index++;
-         dataPoint++;
+      rc = pthread_create( &thread_id[i], &attr, Cfunction, &p[i] ) ;
+      if (rc)
+      {
+         printf("ERROR; return code from pthread_create() is %d\n", rc);
+         exit(-1);
       }
+   }
 
-      pthread_attr_init(&attr);
-      pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-      edgeFound = false;
+   // The blocks come back here in order, once every channel has been
+   // tracked through them, to gather the subframe edges found. The edges
+   // of one subframe from the different SVs come up to about 20 ms apart,
+   // so a solution is only made once the blocks since the first edge span
+   // the input buffer the solutions used to be made on (40*16367 samples).
+   const unsigned solveBlocks = (40*16367 + blockSize - 1) / blockSize;
+   unsigned gathered = 0;  // Blocks since the first edge not solved for
+   while (const SampleRing::Block* b = ring.completed())
+   {
+      bool edgeFound = false;
       for(int i = 0; i < numTrackers; i++)
       {
-         p[i].dp = dataPoint; // Set parameters for each tracker.
-         p[i].bufferSize = bufferSize;
-         p[i].s = &b;
-         p[i].count = &count[i];
-         p[i].tr = tr[i];
-         p[i].nf = &nf[i];
-         p[i].v = (verboseLevel);
-         p[i].prn = tr[i]->prn;
-         p[i].solvePos = solvePos;
-         
-   // Split
-         rc = pthread_create( &thread_id[i], &attr, Cfunction, &p[i] ) ;
-         if (rc)
+         Edge& e = ch[i].edges[b->slot];
+         if (e.found)
          {
-            printf("ERROR; return code from pthread_create() is %d\n", rc);
-            exit(-1);
+            dataPoints[ch[i].prn-1] = e.dataPoint;
+            ZCount = e.zCount;
+            edgeFound = true;
+            e.found = false;
          }
       }
+      ring.retire();
 
-   // Join
-      for(int i = 0; i < numTrackers; i++)
+      if (edgeFound || gathered > 0)
+         gathered++;
+      if (gathered >= solveBlocks)
       {
-         rc = pthread_join( thread_id[i], &status) ;
-         if (rc)
-         {
-            printf("ERROR; return code from pthread_join() is %d\n", rc);
-            exit(-1);
-         }
+         if (solvePos)
+            solvePosition();
+         gathered = 0;
       }
-      if(edgeFound == true)
-      {         
-//---------------------------------------------------------------------------
-// Position Solution
-         if(solvePos == true)
-         {
-            GPSEphemerisStore bce;
-            IonoModel iono;
-            CommonTime time;
-            double zCount = (double)ZCount - 6.0;
-            double sampleRate = 1/timeStep;
-            GPSEllipsoid gm;
-            vector<SatID> svVec;
-            vector<double> ionoVec;
-            Triple antennaPos;
-
-            time = GPSWeekZcount(gpsWeek, zCount);
-
-            RinexNavStream rns(ephFile.c_str(), ios::in);
-            rns.exceptions(ifstream::failbit);
-            RinexNavHeader hdr;
-            rns >> hdr;
-            iono = IonoModel(hdr.ionAlpha, hdr.ionBeta);
-            RinexNavData rnd;
-            while (rns >> rnd)
-               bce.addEphemeris(rnd);
-            if (time < bce.getInitialTime() || time > bce.getFinalTime())
-               cout << "Warning: Initial time does not appear to be "
-                    << "within the provided ephemeris data." << endl;
-
-            for (int i=1; i < 33; i++)
-            {
-               SatID sv(i, SatID::systemGPS);
-               svVec.push_back(sv);
-            }
-            float refDataPoint;
+   }
 
-            long int total = 0;
-            int numberSVs = 0;
+   // The edges of the last blocks, if the input ended before the window did
+   if (gathered > 0 && solvePos)
+      solvePosition();
 
-            for(int i=0; i<32;i++)
-            {
-               total += dataPoints[i];
-               if(dataPoints[i] != 0)
-                  numberSVs++;
-            }
-            refDataPoint = total/numberSVs;
-            vector<double> obsVec(32);
+   for(int i = 0; i < numThreads; i++)
+   {
+      rc = pthread_join( thread_id[i], &status) ;
+      if (rc)
+      {
+         printf("ERROR; return code from pthread_join() is %d\n", rc);
+         exit(-1);
+      }
+   }
+   pthread_join(reader, &status);
+   pthread_attr_destroy(&attr);
+}
 
 
-            for(int i=0; i<32; i++)
-            {
-               if(dataPoints[i] != 0)
-               {
-                     // 0.073 is an arbitrary guessed time of flight
-                  obsVec[i] = gpstk::C_MPS*(0.073 - (refDataPoint - 
-                       dataPoints[i])/(sampleRate)); //*2 because of hilbert
-               }  
-               else
-               {
-                  SatID temp(0, SatID::systemGPS); 
-                  svVec[i] = temp; // set SatID equal to 0, 
-                                   //the SV won't be considered
-               }
-            }
+//-----------------------------------------------------------------------------
+void RxSim::solvePosition()
+{
+   GPSEphemerisStore bce;
+   IonoModel iono;
+   CommonTime time;
+   double zCount = (double)ZCount - 6.0;
+   double sampleRate = 1/timeStep;
+   GPSEllipsoid gm;
+   vector<SatID> svVec;
+   vector<double> ionoVec;
+   Triple antennaPos;
+
+   time = GPSWeekZcount(gpsWeek, zCount);
+
+   RinexNavStream rns(ephFile.c_str(), ios::in);
+   rns.exceptions(ifstream::failbit);
+   RinexNavHeader hdr;
+   rns >> hdr;
+   iono = IonoModel(hdr.ionAlpha, hdr.ionBeta);
+   RinexNavData rnd;
+   while (rns >> rnd)
+      bce.addEphemeris(rnd);
+   if (time < bce.getInitialTime() || time > bce.getFinalTime())
+      cout << "Warning: Initial time does not appear to be "
+           << "within the provided ephemeris data." << endl;
+
+   for (int i=1; i < 33; i++)
+   {
+      SatID sv(i, SatID::systemGPS);
+      svVec.push_back(sv);
+   }
+   float refDataPoint;
+
+   long int total = 0;
+   int numberSVs = 0;
+
+   for(int i=0; i<32;i++)
+   {
+      total += dataPoints[i];
+      if(dataPoints[i] != 0)
+         numberSVs++;
+   }
+   refDataPoint = total/numberSVs;
+   vector<double> obsVec(32);
+
+
+   for(int i=0; i<32; i++)
+   {
+      if(dataPoints[i] != 0)
+      {
+            // 0.073 is an arbitrary guessed time of flight
+         obsVec[i] = gpstk::C_MPS*(0.073 - (refDataPoint - 
+              dataPoints[i])/(sampleRate)); //*2 because of hilbert
+      }  
+      else
+      {
+         SatID temp(0, SatID::systemGPS); 
+         svVec[i] = temp; // set SatID equal to 0, 
+                          //the SV won't be considered
+      }
+   }
 // Calculate initial position solution.
 
-            GGTropModel gg;
-            gg.setWeather(30., 1000., 50.);    
-            PRSolution2 prSolver;
-            prSolver.RMSLimit = 400;
-            prSolver.RAIMCompute(time, svVec, obsVec, bce, &gg); 
-            Vector<double> sol = prSolver.Solution;
-            cout << endl << "Position (ECEF): " << fixed << sol[0] 
-                 << " " << sol[1] 
-                 << " " << sol[2] << endl;
-            time -= (sol[3] / gpstk::C_MPS);
-            cout << "Time: " << time << endl;  
-               //cout << "Clock Error (includes that caused by guess): " 
-               //<< sol[3]*1000/gpstk::C_MPS << " ms" << endl;
-            cout << "# good SV's: " << prSolver.Nsvs << endl
-                 << "RMSResidual: " << prSolver.RMSResidual << " meters" 
-                 << endl;
+   GGTropModel gg;
+   gg.setWeather(30., 1000., 50.);    
+   PRSolution2 prSolver;
+   prSolver.RMSLimit = 400;
+   prSolver.RAIMCompute(time, svVec, obsVec, bce, &gg); 
+   Vector<double> sol = prSolver.Solution;
+   cout << endl << "Position (ECEF): " << fixed << sol[0] 
+        << " " << sol[1] 
+        << " " << sol[2] << endl;
+   time -= (sol[3] / gpstk::C_MPS);
+   cout << "Time: " << time << endl;  
+      //cout << "Clock Error (includes that caused by guess): " 
+      //<< sol[3]*1000/gpstk::C_MPS << " ms" << endl;
+   cout << "# good SV's: " << prSolver.Nsvs << endl
+        << "RMSResidual: " << prSolver.RMSResidual << " meters" 
+        << endl;
 
 // If we wanted to just output ranges, we can correct the obsVector
 // using the clock error and have the range to each sat.
 
-            for(int i = 0; i < 32; i++)
-               dataPoints[i] = 0;
+   for(int i = 0; i < 32; i++)
+      dataPoints[i] = 0;
 
 // Calculate Ionosphere correction.
 /*          antennaPos[0] = sol[0];
-            antennaPos[1] = sol[1];
-            antennaPos[2] = sol[2];
-            ECEF ecef(antennaPos);
-            for (int i=1; i<=32; i++)
-            {
-               SatID sv(i, SatID::systemGPS);
-               try 
-               {
-                  Xvt svpos = bce.getXvt(sv, time);
-                  double el = antennaPos.elvAngle(svpos.x);
-                  double az = antennaPos.azAngle(svpos.x);
-                  double ic = iono.getCorrection(time, ecef, el, az); // in meters
-                  ionoVec.push_back(ic);
-               }
-               catch (Exception& e)
-               {}
-            }
-            if(verboseLevel)
-            {
-               for(int i = 0; i < 32; i++)
-               {
-                  cout << svVec[i] << " "  << obsVec[i] << " " << ionoVec[i] << endl;
-         
-               }
-            }
-            for(int i=0;i<32;i++)
-            {
-               obsVec[i] -= sol[3]; // convert pseudoranges to ranges
-               obsVec[i] += ionoVec[i]; // make iono correction to ranges.
-            }*/
-               // Then plug back into RAIMCompute...
-         }
+   antennaPos[1] = sol[1];
+   antennaPos[2] = sol[2];
+   ECEF ecef(antennaPos);
+   for (int i=1; i<=32; i++)
+   {
+      SatID sv(i, SatID::systemGPS);
+      try 
+      {
+         Xvt svpos = bce.getXvt(sv, time);
+         double el = antennaPos.elvAngle(svpos.x);
+         double az = antennaPos.azAngle(svpos.x);
+         double ic = iono.getCorrection(time, ecef, el, az); // in meters
+         ionoVec.push_back(ic);
       }
-//---------------------------------------------------------------------------
+      catch (Exception& e)
+      {}
+   }
+   if(verboseLevel)
+   {
+      for(int i = 0; i < 32; i++)
+      {
+         cout << svVec[i] << " "  << obsVec[i] << " " << ionoVec[i] << endl;
 
-      if (cc->localTime > timeLimit)
-         break;
+      }
    }
-   delete thread_id;
-   pthread_attr_destroy(&attr);
-   pthread_exit(NULL);
+   for(int i=0;i<32;i++)
+   {
+      obsVec[i] -= sol[3]; // convert pseudoranges to ranges
+      obsVec[i] += ionoVec[i]; // make iono correction to ranges.
+   }*/
+      // Then plug back into RAIMCompute...
 }
 
 //-----------------------------------------------------------------------------
@@ -593,41 +670,62 @@ int main(int argc, char *argv[])
 void *Cfunction(void* p)
 {
    Par *par = (Par*)p;
-   
-   EMLTracker *tr = par->tr;
-   int *count = par->count;
-   NavFramer *nf = par->nf;
-   int bufferSize = par->bufferSize;
-   int dp = par->dp - bufferSize;
-   Buffer *b = par->s;
-   bool v = par->v;
-   int prn = par->prn;
-   bool solvePos = par->solvePos;
-   
-   int index = 0;
-   pthread_mutex_lock (&mutexVec);
-   edgeFound = false;
-   pthread_mutex_unlock (&mutexVec);
+   SampleRing& ring = *par->ring;
 
-   while(index < bufferSize + 1) // number of data points to track before join.
+   while (const SampleRing::Block* b = ring.acquire(par->consumer))
+   {
+      for (size_t i = 0; i < par->channels.size(); i++)
+         track(*par->channels[i], *b, par->v, par->solvePos);
+      ring.release(par->consumer);
+   }
+   pthread_exit((void*) 0);
+   return NULL;
+}
+
+// Tracks one channel through one block of samples, and keeps the last
+// subframe edge found in it for the main thread
+void track(Channel& c, const SampleRing::Block& b, bool v, bool solvePos)
+{
+   EMLTracker *tr = c.tr;
+   int *count = &c.count;
+   NavFramer *nf = &c.nf;
+   Edge& edge = c.edges[b.slot];
+   int dp = b.firstPoint;
+
+   unsigned index = 0;
+   while(index < b.size)
    {
-      if (tr->process(b->arr[index]))
+      // Up to the next dump at once; dp is then the data point of the
+      // last sample used.
+      bool dumped;
+      unsigned n = min(tr->samplesToDump(), b.size - index);
+      unsigned used = tr->process(&b.samples[index], n, dumped);
+      index += used;
+      dp += used - 1;
+
+      if (dumped)
       {
          if(v)
+         {
+            pthread_mutex_lock (&mutexOut);
             tr->dump(cout);
-         
+            pthread_mutex_unlock (&mutexOut);
+         }
+
          if(tr->navChange)
          {
             if(nf->process(*tr, dp, 
                            (float)tr->localReplica.getCodePhaseOffsetSec()*1e6))
             {
-               pthread_mutex_lock (&mutexVec);
-               dataPoints[prn-1] = nf->subframes.back().dataPoint;
-               edgeFound = true;
-               ZCount = EngNav::getHOWTime(nf->subframes.back().words[1]);
-               pthread_mutex_unlock (&mutexVec);
+               edge.found = true;
+               edge.dataPoint = nf->subframes.back().dataPoint;
+               edge.zCount = EngNav::getHOWTime(nf->subframes.back().words[1]);
                if(!solvePos)
-               {nf->subframes.back().dump(cout,1);}
+               {
+                  pthread_mutex_lock (&mutexOut);
+                  nf->subframes.back().dump(cout,1);
+                  pthread_mutex_unlock (&mutexOut);
+               }
                
 /*cout << "DataPoint: " << nf->subframes.back().dataPoint 
                      << "Zcount: " 
@@ -644,21 +742,45 @@ void *Cfunction(void* p)
             if(nf->process(*tr, dp, 
                            (float)tr->localReplica.getCodePhaseOffsetSec()*1e6))
             {
-               pthread_mutex_lock (&mutexVec);
-               dataPoints[prn-1] = nf->subframes.back().dataPoint;
-               edgeFound = true;
-               ZCount = EngNav::getHOWTime(nf->subframes.back().words[1]);
-               pthread_mutex_unlock (&mutexVec);
+               edge.found = true;
+               edge.dataPoint = nf->subframes.back().dataPoint;
+               edge.zCount = EngNav::getHOWTime(nf->subframes.back().words[1]);
                if(!solvePos)
-               {nf->subframes.back().dump(cout,0);}
+               {
+                  pthread_mutex_lock (&mutexOut);
+                  nf->subframes.back().dump(cout,0);
+                  pthread_mutex_unlock (&mutexOut);
+               }
             }
          }
          *count = *count + 1;
       }
-      index++;
       dp++;
    }
+}
 
-   pthread_exit((void*) 0);
+
+// Reads the input into the ring, up to the time limit
+void *readInput(void* p)
+{
+   Reader *r = (Reader*)p;
+   SampleRing& ring = *r->ring;
+   long dataPoint = 0;
+   bool more = true;
+
+   while (more)
+   {
+      SampleRing::Block& b = ring.claim();
+      b.firstPoint = dataPoint + 1;
+      b.size = r->input->readBlock(&b.samples[0], ring.blockSize());
+      dataPoint += b.size;
+
+      // The trackers' local time is that of the last sample read
+      more = (b.size == ring.blockSize() &&
+              dataPoint * r->timeStep <= r->timeLimit);
+      if (b.size)
+         ring.publish();
+   }
+   ring.close();
    return NULL;
 }
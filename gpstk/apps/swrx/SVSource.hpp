@@ -26,8 +26,8 @@
 #define SVSOURCE_HPP
 
 #include "PCodeGenerator.hpp"
-#include "CACodeGenerator.hpp"
 #include "NAVCodeGenerator.hpp"
+#include "CACodeTable.hpp"
 
 #include <math.h>
 #include <complex>
@@ -48,52 +48,83 @@ class SVSource
 public:
 
    SVSource (int SVPRNID, int bandArg) :
-      zchips_per_sample(1),
-      doppler(0),
-      zchip_fraction_accum(0),
-      p_codegen(SVPRNID),
-      ca_codegen(SVPRNID),
+      p_modulation(true),
+      ca_modulation(true),
+      p_nav(true),
+      ca_nav(true),
       ca_amplitude(1),
       p_amplitude(1),
       carrier_amplitude(1),
+      doppler(0),
+      zchips_per_sample(1),
+      zchip_fraction_accum(0),
+      carrier_multiplier(0),
       code_only(false),
-      zchip_counter(0),
-      prn(SVPRNID),
+      p_codegen(SVPRNID),
+      ca_index(0),
       band(bandArg),
-      p_modulation(true),
-      ca_modulation(true),
-      p_nav(true),
-      ca_nav(true),
-      carrier_multiplier(0)
+      prn(SVPRNID),
+      zchip_counter(0),
+      ca_epoch_counter(0)
    {
       switch(band)
       {
          case 1: carrier_multiplier = gpstk::L1_MULT_GPS; break;
          case 2: carrier_multiplier = gpstk::L2_MULT_GPS; break;
       }
+
+      // One period of the C/A code, so a chip is just a lookup
+      const CACodeTable& table = CACodeTable::get(SVPRNID);
+      for (int i=0; i<caCodeLength; i++)
+         ca_chips[i] = table.chip(i);
    }
 
 
    std::complex<double> getSample() const
    {
-      double phase = zchip_fraction_accum*carrier_multiplier*2.0*gpstk::PI;
-      std::complex<double> carrier = sincos(phase);
-
-      bool nav_bit=(*nav_codegen);
-      int p_bit=p_modulation?((*p_codegen)^(p_nav?nav_bit:0)):0;
-      int ca_bit=ca_modulation?((*ca_codegen)^(ca_nav?nav_bit:0)):0;
+      std::complex<double> sample = getCodeSample();
 
-      // Must follow guidelines in Table 3-IV of IS-GPS-200D
-      std::complex<double> sample(
-         ca_bit?(ca_amplitude):(-ca_amplitude),
-         p_bit ?(p_amplitude):(-p_amplitude));
-      
       if (!code_only)
-         sample *= carrier_amplitude * carrier;
+      {
+         double phase = zchip_fraction_accum*carrier_multiplier*2.0*gpstk::PI;
+         sample *= carrier_amplitude * sincos(phase);
+      }
 
       return sample;
    }
 
+   // Adds the next n samples to out and moves the state past them, as n
+   // calls to getSample() and incrementState() would. The carrier is
+   // turned by a fixed phasor from one sample to the next instead of
+   // being computed for each; it is recomputed from the code phase every
+   // 256 samples.
+   void render(std::complex<float>* out, size_t n)
+   {
+      const double step = zchips_per_sample + doppler;
+      const std::complex<double> turn =
+         sincos(step*carrier_multiplier*2.0*gpstk::PI);
+      std::complex<double> carrier;
+
+      for (size_t k=0; k<n; k++)
+      {
+         std::complex<double> sample = getCodeSample();
+
+         if (!code_only)
+         {
+            if (k % 256 == 0)
+               carrier = carrier_amplitude * sincos(
+                  zchip_fraction_accum*carrier_multiplier*2.0*gpstk::PI);
+            sample *= carrier;
+            carrier *= turn;
+         }
+
+         out[k] += std::complex<float>(sample);
+
+         zchip_fraction_accum += step;
+         handleWrap();
+      }
+   }
+
    void incrementState()
    {
       /* Increment internal state to prepare for the next call */
@@ -126,21 +157,36 @@ public:
 
 private:
 
+   // The code chips of this sample, without the carrier
+   std::complex<double> getCodeSample() const
+   {
+      bool nav_bit=(*nav_codegen);
+      int p_bit=p_modulation?((*p_codegen)^(p_nav?nav_bit:0)):0;
+      int ca_bit=ca_modulation?(ca_chips[ca_index]^(ca_nav?nav_bit:0)):0;
+
+      // Must follow guidelines in Table 3-IV of IS-GPS-200D
+      return std::complex<double>(
+         ca_bit?(ca_amplitude):(-ca_amplitude),
+         p_bit ?(p_amplitude):(-p_amplitude));
+   }
+
    void handleWrap()
    {
       while (zchip_fraction_accum>1.0)
       {
          if(zchip_counter==9)
          {
-            if(ca_codegen.isLastInSequence())
+            if(ca_index==caCodeLength-1)
             {
                if(ca_epoch_counter==19)
                {
                   ++nav_codegen;
                   ca_epoch_counter=0;            
                } else ++ca_epoch_counter;
+               ca_index=0;
             }
-            ++ca_codegen;
+            else
+               ++ca_index;
             zchip_counter=0;
          } 
          else
@@ -171,9 +217,13 @@ public:
    bool code_only;
 
    gpstk::PCodeGenerator p_codegen;
-   gpstk::CACodeGenerator ca_codegen;
    NAVCodeGenerator nav_codegen;
 
+   // The C/A code, from CACodeTable, and the chip being sent
+   static const int caCodeLength = 1023;
+   bool ca_chips[caCodeLength];
+   int ca_index;
+
    int band;
    int prn;
    int zchip_counter;     // Counts 0-9 to tell us when to move to the next C/A chip
@@ -0,0 +1,177 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2004, The University of Texas at Austin
+//
+//============================================================================
+
+#include "SampleRing.hpp"
+
+using namespace std;
+
+// The counters are read and written with a full barrier after the read
+// and around the write. The write of a counter followed by the read of
+// 'sleepers' in notify(), against the write of 'sleepers' followed by the
+// read of the counter in wait(), is what keeps a wake up from being lost.
+static inline unsigned long load(const unsigned long& x)
+{
+   unsigned long v = *static_cast<const volatile unsigned long*>(&x);
+   __sync_synchronize();
+   return v;
+}
+
+static inline void store(unsigned long& x, unsigned long v)
+{
+   __sync_synchronize();
+   *static_cast<volatile unsigned long*>(&x) = v;
+   __sync_synchronize();
+}
+
+
+SampleRing::SampleRing(unsigned slots, unsigned blockSize, unsigned consumers)
+   : published(0), released(consumers, 0), retired(0), closed(0),
+     blocks(slots), blockLength(blockSize), sleepers(0)
+{
+   for (unsigned i = 0; i < slots; i++)
+   {
+      blocks[i].samples.resize(blockSize);
+      blocks[i].size = 0;
+      blocks[i].firstPoint = 0;
+      blocks[i].slot = i;
+   }
+   pthread_mutex_init(&lock, NULL);
+   pthread_cond_init(&moved, NULL);
+}
+
+
+SampleRing::~SampleRing()
+{
+   pthread_cond_destroy(&moved);
+   pthread_mutex_destroy(&lock);
+}
+
+
+SampleRing::Block& SampleRing::claim()
+{
+   wait(&SampleRing::canClaim, 0);
+   return blocks[published % blocks.size()];
+}
+
+
+void SampleRing::publish()
+{
+   store(published, published + 1);
+   notify();
+}
+
+
+void SampleRing::close()
+{
+   store(closed, 1);
+   notify();
+}
+
+
+const SampleRing::Block* SampleRing::acquire(unsigned c)
+{
+   wait(&SampleRing::canAcquire, c);
+   if (released[c] == load(published))
+      return NULL;
+   return &blocks[released[c] % blocks.size()];
+}
+
+
+void SampleRing::release(unsigned c)
+{
+   store(released[c], released[c] + 1);
+   notify();
+}
+
+
+const SampleRing::Block* SampleRing::completed()
+{
+   wait(&SampleRing::canComplete, 0);
+   if (retired == load(published))
+      return NULL;
+   return &blocks[retired % blocks.size()];
+}
+
+
+void SampleRing::retire()
+{
+   store(retired, retired + 1);
+   notify();
+}
+
+
+unsigned long SampleRing::allReleased() const
+{
+   unsigned long n = load(published);
+   for (unsigned c = 0; c < released.size(); c++)
+      n = min(n, load(released[c]));
+   return n;
+}
+
+
+bool SampleRing::canClaim(unsigned) const
+{
+   return published - load(retired) < blocks.size();
+}
+
+
+// 'closed' is read before 'published', so that every block published
+// before the close is seen.
+bool SampleRing::canAcquire(unsigned c) const
+{
+   bool end = load(closed) != 0;
+   return released[c] < load(published) || end;
+}
+
+
+bool SampleRing::canComplete(unsigned) const
+{
+   bool end = load(closed) != 0;
+   return allReleased() > retired || (end && retired == load(published));
+}
+
+
+void SampleRing::notify()
+{
+   if (load(sleepers))
+   {
+      pthread_mutex_lock(&lock);
+      pthread_cond_broadcast(&moved);
+      pthread_mutex_unlock(&lock);
+   }
+}
+
+
+void SampleRing::wait(bool (SampleRing::*ready)(unsigned) const, unsigned arg)
+{
+   if ((this->*ready)(arg))
+      return;
+
+   pthread_mutex_lock(&lock);
+   store(sleepers, sleepers + 1);
+   while (!(this->*ready)(arg))
+      pthread_cond_wait(&moved, &lock);
+   store(sleepers, sleepers - 1);
+   pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,121 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2004, The University of Texas at Austin
+//
+//============================================================================
+
+#ifndef SAMPLERING_HPP
+#define SAMPLERING_HPP
+
+#include <complex>
+#include <vector>
+#include <pthread.h>
+
+//-----------------------------------------------------------------------------
+// A ring of blocks of samples, filled by one thread (the producer) and
+// read by several others (the consumers), each of which sees every
+// block, in order. A block is given back to the producer only after
+// every consumer has released it and then the finisher has retired it;
+// the finisher sees the blocks in order too, so it is the place to
+// combine what the consumers found in a block.
+//
+// Each of the counters below is written by one thread only, so passing
+// a block along takes no lock. A thread that has to wait for a block
+// sleeps on a condition variable; the others only take the lock to wake
+// it up when somebody is actually sleeping.
+//-----------------------------------------------------------------------------
+class SampleRing
+{
+public:
+   struct Block
+   {
+      std::vector< std::complex<float> > samples;
+
+      // Number of samples in this block
+      unsigned size;
+
+      // Data point of the first sample, counted from 1
+      long firstPoint;
+
+      // Where the block is in the ring, so that a consumer can keep its
+      // results for this block in slot-indexed storage until it is retired.
+      unsigned slot;
+   };
+
+   SampleRing(unsigned slots, unsigned blockSize, unsigned consumers);
+   ~SampleRing();
+
+   // The producer: claim() returns the next block to fill, waiting for
+   // it to be retired if need be; publish() makes it available to the
+   // consumers. close() tells them no more blocks will come.
+   Block& claim();
+   void publish();
+   void close();
+
+   // Consumer c gets the next block with acquire() and gives it back
+   // with release(). acquire() returns NULL after close(), once every
+   // block has been acquired.
+   const Block* acquire(unsigned c);
+   void release(unsigned c);
+
+   // The finisher gets the next block released by every consumer with
+   // completed(), and gives it back to the producer with retire().
+   // completed() returns NULL after close(), once every block has been
+   // retired.
+   const Block* completed();
+   void retire();
+
+   unsigned blockSize() const { return blockLength; }
+
+private:
+   // Blocks published, released by each consumer and retired. They are
+   // only read and written through load() and store() in SampleRing.cpp.
+   unsigned long published;
+   std::vector<unsigned long> released;
+   unsigned long retired;
+   unsigned long closed;
+
+   // Blocks released by every consumer
+   unsigned long allReleased() const;
+
+   // Called after moving one of the counters, to wake up the threads
+   // that sleep waiting for it
+   void notify();
+
+   // Sleeps until (this->*ready)(arg) is true
+   void wait(bool (SampleRing::*ready)(unsigned) const, unsigned arg);
+
+   bool canClaim(unsigned) const;
+   bool canAcquire(unsigned c) const;
+   bool canComplete(unsigned) const;
+
+   std::vector<Block> blocks;
+   unsigned blockLength;
+
+   pthread_mutex_t lock;
+   pthread_cond_t moved;
+   unsigned long sleepers;
+
+   SampleRing(const SampleRing&);
+   SampleRing& operator=(const SampleRing&);
+};
+
+#endif
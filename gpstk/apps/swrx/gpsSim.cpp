@@ -49,6 +49,8 @@
 #include "StringUtils.hpp"
 #include "GNSSconstants.hpp"
 
+#include "ThreadPool.hpp"
+
 #include "SVSource.hpp"
 #include "normal.hpp"
 #include "IQStream.hpp"
@@ -61,6 +63,46 @@ using namespace std;
 #define exp10(x) (exp((x)*log((long double)10)))
 #endif
 
+// Renders one block of the signal of one SV, or of the noise of one band.
+// Each has a buffer of its own, so they can all run at once.
+class RenderTask : public ThreadPool::Task
+{
+public:
+   RenderTask() : src(NULL), seed(NULL), amplitude(0), length(0) {}
+
+   virtual void run() throw()
+   {
+      if (src)
+      {
+         fill(samples.begin(), samples.begin() + length, complex<float>(0));
+         src->render(&samples[0], length);
+      }
+      else
+      {
+         for (size_t k=0; k<length; k++)
+         {
+            double i = generate_normal_rv(seed);
+            double q = generate_normal_rv(seed);
+            samples[k] = complex<float>(i*amplitude, q*amplitude);
+         }
+      }
+   }
+
+   // The SV, or NULL for the noise
+   SVSource* src;
+
+   // The generator of the noise, and its amplitude
+   unsigned int* seed;
+   double amplitude;
+
+   // The band, starting at 0
+   int band;
+
+   vector< complex<float> > samples;
+   size_t length;
+};
+
+
 class GpsSim : public BasicFramework
 {
 public:
@@ -106,11 +148,30 @@ public:
 
    IQStream *output;
 
+   // Samples in a block, when rendering a block at a time; 0 for a
+   // sample at a time
+   size_t blockLength;
 
+   unsigned numThreads;
 
 
 protected:
    virtual void process();
+
+   // Renders the signals a block at a time
+   void processBlocks();
+
+   // Queues (or, without a pool, runs) the tasks of one block
+   void renderBlock(vector<RenderTask>& tasks, size_t length);
+
+   // Adds up the signals of a block by band, heterodynes and writes them
+   void mixBlock(vector<RenderTask>& tasks, unsigned long first,
+                 size_t length);
+
+   ThreadPool* pool;
+
+   // The block being mixed and written
+   vector< complex<float> > mixed;
 };
 
 
@@ -128,7 +189,10 @@ GpsSim::GpsSim() throw() :
    ca_amplitude(0.1767*M_SQRT2),
    noise_amplitude(2.805),
    codeOnly(false),
-   gain(1)
+   gain(1),
+   blockLength(0),
+   numThreads(0),
+   pool(NULL)
 {}
 
 bool GpsSim::initialize(int argc, char *argv[]) throw()
@@ -184,6 +248,19 @@ bool GpsSim::initialize(int argc, char *argv[]) throw()
       outputOpt('o', "output",
                  "Where to write the output. The default is stdout");
 
+   CommandOptionWithAnyArg
+      blockOpt('\0', "block",
+               "Render the signals a block of ARG ms at a time, each SV and "
+               "the noise of each band on a thread of its own, while the "
+               "previous block is mixed and written. The noise is not the "
+               "same as when rendering a sample at a time. The default is a "
+               "sample at a time.");
+
+   CommandOptionWithAnyArg
+      threadsOpt('\0', "threads",
+                 "The number of threads rendering blocks. The default is one "
+                 "per processor.");
+
    if (!BasicFramework::initialize(argc,argv))
       return false;
 
@@ -259,6 +336,17 @@ bool GpsSim::initialize(int argc, char *argv[]) throw()
       periods_to_generate = static_cast<long unsigned>(rt*1.0e6);
    }
 
+   if (blockOpt.getCount())
+   {
+      double ms = asDouble(blockOpt.getValue()[0]);
+      blockLength = max(1L, static_cast<long>(ms * 1e-3 * rx_sample_rate + 0.5));
+   }
+
+   if (threadsOpt.getCount())
+      numThreads = asInt(threadsOpt.getValue()[0]);
+   if (numThreads == 0)
+      numThreads = ThreadPool::processorCount();
+
    if (debugLevel)
       cout << "# Running for : " << periods_to_generate
            << " periods (" << 1e3 * periods_to_generate/1.0e6
@@ -348,6 +436,12 @@ bool GpsSim::initialize(int argc, char *argv[]) throw()
 
 void GpsSim::process()
 {
+   if (blockLength)
+   {
+      processBlocks();
+      return;
+   }
+
    // Used to accumulate up the samples
    vector< complex<float> > accum(LO_COUNT);
 
@@ -414,3 +508,130 @@ int main(int argc, char *argv[])
    catch (...)
    { cerr << "Caught unknown exception" << endl; }
 }
+
+
+//-----------------------------------------------------------------------------
+void GpsSim::renderBlock(vector<RenderTask>& tasks, size_t length)
+{
+   for (size_t t=0; t < tasks.size(); t++)
+   {
+      tasks[t].length = length;
+      if (pool)
+         pool->submit(&tasks[t]);
+      else
+         tasks[t].run();
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+void GpsSim::mixBlock(vector<RenderTask>& tasks, unsigned long first,
+                      size_t length)
+{
+   vector< complex<float> > accum(length);
+   float* a = reinterpret_cast<float*>(&accum[0]);
+
+   for (int i=0; i < LO_COUNT; i++)
+   {
+      fill(accum.begin(), accum.end(), complex<float>(0));
+      const RenderTask* noise = NULL;
+
+      // Sum the signals from each SV, as floats so the loop vectorizes
+      for (size_t t=0; t < tasks.size(); t++)
+      {
+         if (tasks[t].band != i)
+            continue;
+         if (!tasks[t].src)
+         {
+            noise = &tasks[t];
+            continue;
+         }
+         const float* s = reinterpret_cast<const float*>(&tasks[t].samples[0]);
+         for (size_t k=0; k < 2*length; k++)
+            a[k] += s[k];
+      }
+
+      // Heterodyne the signals, with the local oscilator turned from one
+      // sample to the next and recomputed every 256 samples, then add
+      // the noise and apply the receiver gain
+      const complex<double> turn = conj(sincos(omega_lo[i]));
+      complex<double> lo;
+      for (size_t k=0; k < length; k++)
+      {
+         complex<float> v = accum[k];
+         if (!codeOnly)
+         {
+            if (k % 256 == 0)
+               lo = conj(sincos(omega_lo[i] * (first + k)));
+            v *= complex<float>(lo);
+            lo *= turn;
+         }
+         v += noise->samples[k];
+         v *= gain;
+         mixed[k*LO_COUNT + i] = v;
+      }
+   }
+
+   output->writeBlock(&mixed[0], length * LO_COUNT);
+}
+
+
+//-----------------------------------------------------------------------------
+void GpsSim::processBlocks()
+{
+   unsigned long max_samples =
+      periods_to_generate*static_cast<unsigned long>(samples_per_period);
+
+   if (numThreads > 1)
+      pool = new ThreadPool(numThreads);
+
+   // Every SV and the noise of every band, twice: one block is rendered
+   // while the other is mixed and written
+   vector<unsigned int> seeds(LO_COUNT);
+   vector<RenderTask> tasks[2];
+   for (int b=0; b < 2; b++)
+   {
+      list<SVSource*>::iterator i;
+      for(i = sv_sources.begin(); i != sv_sources.end(); i++)
+      {
+         RenderTask t;
+         t.src = *i;
+         t.band = (*i)->band - 1;
+         tasks[b].push_back(t);
+      }
+      for (int i=0; i < LO_COUNT; i++)
+      {
+         seeds[i] = i + 1;
+         RenderTask t;
+         t.seed = &seeds[i];
+         t.amplitude = noise_amplitude;
+         t.band = i;
+         tasks[b].push_back(t);
+      }
+      for (size_t t=0; t < tasks[b].size(); t++)
+         tasks[b][t].samples.resize(blockLength);
+   }
+   mixed.resize(blockLength * LO_COUNT);
+
+   unsigned long done = 0;
+   int current = 0;
+   renderBlock(tasks[current], min<unsigned long>(blockLength, max_samples));
+   while (done < max_samples)
+   {
+      if (pool)
+         pool->wait();
+
+      size_t length = tasks[current].front().length;
+      unsigned long next = done + length;
+      if (next < max_samples)
+         renderBlock(tasks[1-current],
+                     min<unsigned long>(blockLength, max_samples - next));
+
+      mixBlock(tasks[current], done, length);
+      done = next;
+      current = 1 - current;
+   }
+
+   delete pool;
+   pool = NULL;
+}
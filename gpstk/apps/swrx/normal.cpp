@@ -41,6 +41,18 @@ generate_normal_rv(void) {
   return ((double)accum - (double)(RAND_MAX>>1))*scaling_factor;
 }
 
+double
+generate_normal_rv(unsigned int* seed) {
+  /* The same, from the rand_r() sequence of 'seed', so that each thread can have its own */
+  int i;
+  int accum=0;
+
+  for(i=0;i<(1<<log_two_of_sum_count);i++)
+    accum+=rand_r(seed)>>log_two_of_sum_count;
+
+  return ((double)accum - (double)(RAND_MAX>>1))*scaling_factor;
+}
+
 
 #ifdef UNIT_TEST
 #include <stdlib.h>
@@ -26,4 +26,7 @@
 
 extern double generate_normal_rv();
 
+// The same, from a generator state of the caller's own
+extern double generate_normal_rv(unsigned int* seed);
+
 #endif
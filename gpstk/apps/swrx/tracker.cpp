@@ -35,6 +35,7 @@
 #include <complex>
 #include <iostream>
 #include <list>
+#include <vector>
 
 #include "BasicFramework.hpp"
 #include "CommandOption.hpp"
@@ -284,6 +285,10 @@ void RxSim::process()
    nf.debugLevel = debugLevel;
    nf.dump(cout);
 
+   // The samples of our band are given to the tracker a whole
+   // integration at a time; lastPoint is the data point of the last one.
+   vector< complex<float> > block;
+   long int lastPoint = 0;
    complex<float> s;
    int b=0;
    while (*input >> s)
@@ -291,43 +296,51 @@ void RxSim::process()
       if (b == band-1 || input->bands==1)
       {
          s *= gain;
-         if (tr->process(s))
-         {
-            if (verboseLevel)
-               tr->dump(cout);
+         block.push_back(s);
+         lastPoint = dataPoint;
+      }
+      b++;
+      b %= input->bands;
+      dataPoint++;
+
+      if (block.size() < tr->samplesToDump())
+         continue;
+
+      bool dumped;
+      tr->process(&block[0], block.size(), dumped);
+      block.clear();
+      if (dumped)
+      {
+         if (verboseLevel)
+            tr->dump(cout);
 
-               // Test code to skip input to speed up tracking.
-               /*int count2 = 0;
-            while(count2 < 3*16367)
-            {
-               count2++;
-               *input >> s;
-               }*/
+            // Test code to skip input to speed up tracking.
+            /*int count2 = 0;
+         while(count2 < 3*16367)
+         {
+            count2++;
+            *input >> s;
+            }*/
 
 // Following two if statements are specific to tracker updating every
 // 1 ms.
-            if(tr->navChange)
-            {
-               nf.process(*tr, dataPoint,
-                          (float)tr->localReplica.getCodePhaseOffsetSec()*1e6);
-               count = 0;
-            }
-            if(count == 20)
-            {
-               count = 0;
-               nf.process(*tr, dataPoint,
-                          (float)tr->localReplica.getCodePhaseOffsetSec()*1e6);
-            }
-            count++;
+         if(tr->navChange)
+         {
+            nf.process(*tr, lastPoint,
+                       (float)tr->localReplica.getCodePhaseOffsetSec()*1e6);
+            count = 0;
+         }
+         if(count == 20)
+         {
+            count = 0;
+            nf.process(*tr, lastPoint,
+                       (float)tr->localReplica.getCodePhaseOffsetSec()*1e6);
          }
+         count++;
       }
-      b++;
-      b %= input->bands;
 
       if (cc->localTime > timeLimit)
          break;
-
-      dataPoint++;
    }
 }
 
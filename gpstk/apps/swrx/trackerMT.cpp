@@ -44,6 +44,7 @@ g++ -o trackerMT trackerMT.o /.../gpstk/dev/apps/swrx/simlib.a /.../gpstk/dev/sr
 #include "CommandOption.hpp"
 #include "StringUtils.hpp"
 #include "GNSSconstants.hpp"
+#include "ThreadPool.hpp"
 
 
 #include "EMLTracker.hpp"
@@ -53,6 +54,7 @@ g++ -o trackerMT trackerMT.o /.../gpstk/dev/apps/swrx/simlib.a /.../gpstk/dev/sr
 #include "complex_math.h"
 #include "IQStream.hpp"
 #include "NavFramer.hpp"
+#include "SampleRing.hpp"
 
 using namespace gpstk;
 using namespace std;
@@ -62,23 +64,34 @@ using namespace std;
 #define exp10(x) (exp((x)*log(10.)))
 #endif
 
-struct Buffer // input buffer
+struct Channel // A tracker and the framer of its nav data
 {
-   vector< complex<float> > arr;
+   EMLTracker *tr;
+   NavFramer nf;
+   int count;
 };
 
 struct Par // Parameters to pass to Pthread function.
 {
-   int dp;
-   int bufferSize;
-   EMLTracker *tr;
-   Buffer *s;
-   int *count;
-   NavFramer *nf;
+   SampleRing *ring;
+   unsigned consumer;          // This thread, as a consumer of the ring
+   vector<Channel*> channels;  // The channels tracked by this thread
    bool v;
 };
 
+struct Reader // Parameters of the input thread
+{
+   SampleRing *ring;
+   IQStream *input;
+   double timeStep;
+   double timeLimit;
+};
+
 void *Cfunction(void*); // C-style function to be called with pthreads
+void *readInput(void*);
+void track(Channel& c, const SampleRing::Block& b, bool v);
+
+pthread_mutex_t mutexOut = PTHREAD_MUTEX_INITIALIZER; // for the verbose dumps
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -109,6 +122,7 @@ private:
    IQStream *input;
    unsigned iadMax;
    int numTrackers;
+   int numThreads;
 };
 
 
@@ -116,7 +130,7 @@ private:
 RxSim::RxSim() throw() :
    BasicFramework("rxSim", "A simulation of a gps receiver."),
    cc(NULL), tr(0), band(1), timeStep(50e-9), interFreq(0.42e6),
-   fakeL2(false), gain(1), timeLimit(9e99),iadMax(20460)
+   fakeL2(false), gain(1), timeLimit(9e99),iadMax(20460), numThreads(0)
 {}
 
 
@@ -175,7 +189,11 @@ bool RxSim::initialize(int argc, char *argv[]) throw()
 
    CommandOptionWithNumberArg
       bandsOpt('b', "bands",
-               "The number of complex samples per epoch. The default is 2.");
+               "The number of complex samples per epoch. The default is 2."),
+
+      threadsOpt('\0', "threads",
+                 "The number of tracking threads. The default is one per "
+                 "processor, but no more than one per code.");
 
    if (!BasicFramework::initialize(argc,argv))
       return false;
@@ -194,7 +212,11 @@ bool RxSim::initialize(int argc, char *argv[]) throw()
    if (interFreqOpt.getCount())
       interFreq = asDouble(interFreqOpt.getValue().front()) * 1e6;
 
+   if (threadsOpt.getCount())
+      numThreads = asInt(threadsOpt.getValue()[0]);
+
    numTrackers = codeOpt.getCount();
+   tr.resize(numTrackers);
    for (int i=0; i < codeOpt.getCount(); i++)
    {
       string val=codeOpt.getValue()[i];
@@ -312,75 +334,82 @@ bool RxSim::initialize(int argc, char *argv[]) throw()
 //-----------------------------------------------------------------------------
 void RxSim::process()
 {
-   pthread_t *thread_id = new pthread_t[numTrackers];
+   vector<Channel> ch(numTrackers);
+   for(int i=0;i<numTrackers;i++)
+   {
+      ch[i].tr = tr[i];
+      ch[i].nf.debugLevel = debugLevel;
+      ch[i].nf.dump(cout);
+      ch[i].count = 0;
+   }
+
+   int numThreads = this->numThreads;
+   if (numThreads <= 0)
+      numThreads = ThreadPool::processorCount();
+   numThreads = min(numThreads, numTrackers);
+
+   // The input is read ahead in blocks of 10 ms, by a thread of its own.
+   // The tracking threads stay up for the whole run; each tracks every
+   // numThreads-th channel, through every block.
+   unsigned blockSize = max(1, int(0.01 / timeStep + 0.5));
+   SampleRing ring(16, blockSize, numThreads);
+
+   vector<Par> p(numThreads);
+   for(int i = 0; i < numThreads; i++)
+   {
+      p[i].ring = &ring;
+      p[i].consumer = i;
+      p[i].v = (verboseLevel);
+   }
+   for(int i = 0; i < numTrackers; i++)
+      p[i % numThreads].channels.push_back(&ch[i]);
+
+   Reader r;
+   r.ring = &ring;
+   r.input = input;
+   r.timeStep = timeStep;
+   r.timeLimit = timeLimit;
+
+   pthread_t reader;
+   vector<pthread_t> thread_id(numThreads);
    pthread_attr_t attr;
    int rc;
    void *status;
 
-   vector<Par> p(numTrackers);
-
-   vector<NavFramer> nf(numTrackers);
-   long int dataPoint =0;
-   vector<int> count(numTrackers);
-
    pthread_attr_init(&attr);
    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
-   for(int i=0;i<numTrackers;i++)
+   rc = pthread_create( &reader, &attr, readInput, &r ) ;
+   if (rc)
    {
-      nf[i].debugLevel = debugLevel;
-      nf[i].dump(cout);
-      count[i]=0;
+      printf("ERROR; return code from pthread_create() is %d\n", rc);
+      exit(-1);
    }
-
-   complex<float> s;
-   while (*input >> s)
+   for(int i = 0; i < numThreads; i++)
    {
-      Buffer b;
-      b.arr.push_back(s);
-      dataPoint++;
-      int index = 0;
-      int bufferSize = 40*16367;
-      while(index < bufferSize) // Fill input buffer
+      rc = pthread_create( &thread_id[i], &attr, Cfunction, &p[i] ) ;
+      if (rc)
       {
-         *input >> s;
-         b.arr.push_back(s);
-         index++;
-         dataPoint++;
-      }
-      for(int i = 0; i < numTrackers; i++)
-      {
-         p[i].dp = dataPoint; // Set parameters for each tracker.
-         p[i].bufferSize = bufferSize;
-         p[i].s = &b;
-         p[i].count = &count[i];
-         p[i].tr = tr[i];
-         p[i].nf = &nf[i];
-         p[i].v = (verboseLevel);
-
-   // Split
-         rc = pthread_create( &thread_id[i], &attr, Cfunction, &p[i] ) ;
-         if (rc)
-         {
-            printf("ERROR; return code from pthread_create() is %d\n", rc);
-            exit(-1);
-         }
+         printf("ERROR; return code from pthread_create() is %d\n", rc);
+         exit(-1);
       }
+   }
+
+   // There is nothing to gather from the channels here, so the blocks
+   // are handed back to the reader as soon as they are tracked.
+   while (ring.completed())
+      ring.retire();
 
-   // Join
-      for(int i = 0; i < numTrackers; i++)
+   for(int i = 0; i < numThreads; i++)
+   {
+      rc = pthread_join( thread_id[i], &status) ;
+      if (rc)
       {
-         rc = pthread_join( thread_id[i], &status) ;
-         if (rc)
-         {
-            printf("ERROR; return code from pthread_join() is %d\n", rc);
-            exit(-1);
-         }
+         printf("ERROR; return code from pthread_join() is %d\n", rc);
+         exit(-1);
       }
-      if (cc->localTime > timeLimit)
-         break;
    }
-   delete thread_id;
+   pthread_join(reader, &status);
    pthread_attr_destroy(&attr);
 }
 
@@ -406,23 +435,45 @@ int main(int argc, char *argv[])
 void *Cfunction(void* p)
 {
    Par *par = (Par*)p;
+   SampleRing& ring = *par->ring;
 
-   EMLTracker *tr = par->tr;
-   int *count = par->count;
-   NavFramer *nf = par->nf;
-   int bufferSize = par->bufferSize;
-   int dp = par->dp - bufferSize;
-   Buffer *b = par->s;
-   bool v = par->v;
+   while (const SampleRing::Block* b = ring.acquire(par->consumer))
+   {
+      for (size_t i = 0; i < par->channels.size(); i++)
+         track(*par->channels[i], *b, par->v);
+      ring.release(par->consumer);
+   }
+   pthread_exit(NULL);
+   return NULL;
+}
 
-   int index = 0;
+// Tracks one channel through one block of samples
+void track(Channel& c, const SampleRing::Block& b, bool v)
+{
+   EMLTracker *tr = c.tr;
+   int *count = &c.count;
+   NavFramer *nf = &c.nf;
+   int dp = b.firstPoint;
 
-   while(index < bufferSize + 1) // number of data points to track before join.
+   unsigned index = 0;
+   while(index < b.size)
    {
-      if (tr->process(b->arr[index]))
+      // Up to the next dump at once; dp is then the data point of the
+      // last sample used.
+      bool dumped;
+      unsigned n = min(tr->samplesToDump(), b.size - index);
+      unsigned used = tr->process(&b.samples[index], n, dumped);
+      index += used;
+      dp += used - 1;
+
+      if (dumped)
       {
          if(v)
+         {
+            pthread_mutex_lock (&mutexOut);
             tr->dump(cout);
+            pthread_mutex_unlock (&mutexOut);
+         }
 
          if(tr->navChange)
          {
@@ -440,9 +491,32 @@ void *Cfunction(void* p)
 
          *count = *count + 1;
       }
-      index++;
       dp++;
    }
-   pthread_exit(NULL);
+}
+
+
+// Reads the input into the ring, up to the time limit
+void *readInput(void* p)
+{
+   Reader *r = (Reader*)p;
+   SampleRing& ring = *r->ring;
+   long dataPoint = 0;
+   bool more = true;
+
+   while (more)
+   {
+      SampleRing::Block& b = ring.claim();
+      b.firstPoint = dataPoint + 1;
+      b.size = r->input->readBlock(&b.samples[0], ring.blockSize());
+      dataPoint += b.size;
+
+      // The trackers' local time is that of the last sample read
+      more = (b.size == ring.blockSize() &&
+              dataPoint * r->timeStep <= r->timeLimit);
+      if (b.size)
+         ring.publish();
+   }
+   ring.close();
    return NULL;
 }
@@ -0,0 +1,460 @@
+#pragma ident "$Id$"
+
+/**
+ * @file ConstellationPropagator.cpp
+ * Propagate the orbits of several satellites over the same time grid.
+ */
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+
+#include "ConstellationPropagator.hpp"
+#include "ReferenceFrames.hpp"
+#include "RungeKuttaFehlberg.hpp"
+#include "StringUtils.hpp"
+
+namespace gpstk
+{
+      // Task taking one step for one satellite; the exception, if any,
+      // is kept for integrateTo()
+   class ConstellationPropagator::StepTask : public ThreadPool::Task
+   {
+   public:
+      StepTask() : cp(NULL), index(0), t(0.0), h(0.0), failed(false)
+      {}
+
+      virtual void run() throw()
+      {
+         try
+         {
+            cp->stepSatellite(index, t, h);
+         }
+         catch(Exception& e)
+         {
+            error = e;
+            failed = true;
+         }
+         catch(std::exception& e)
+         {
+            error = Exception(e.what());
+            failed = true;
+         }
+         catch(...)
+         {
+            error = Exception("Unknown error in ConstellationPropagator");
+            failed = true;
+         }
+      }
+
+      ConstellationPropagator* cp;
+      int index;
+      double t;
+      double h;
+      bool failed;
+      Exception error;
+   };
+
+
+      // Constructor
+   ConstellationPropagator::ConstellationPropagator()
+      : curT(0.0),
+        started(false),
+        stepSize(1.0),
+        numThreads(0),
+        pool(NULL)
+   {
+   }
+
+
+      // Default destructor
+   ConstellationPropagator::~ConstellationPropagator()
+   {
+      delete pool;
+
+      for(size_t i = 0; i < ownOrbits.size(); i++)
+      {
+         delete ownOrbits[i];
+      }
+   }
+
+
+      // Set the force model parameters estimated
+   ConstellationPropagator& ConstellationPropagator::setForceModelType(
+                                 std::set<ForceModel::ForceModelType> fmt)
+      throw(InvalidRequest)
+   {
+      if(!orbits.empty())
+      {
+         InvalidRequest e("Force model types set after adding satellites");
+         GPSTK_THROW(e);
+      }
+
+      setFMT = fmt;
+
+      return (*this);
+
+   }  // End of method 'ConstellationPropagator::setForceModelType()'
+
+
+      // Set the initial epoch
+   ConstellationPropagator& ConstellationPropagator::setInitEpoch(UTCTime utc)
+      throw(InvalidRequest)
+   {
+      if(!orbits.empty())
+      {
+         InvalidRequest e("Initial epoch set after adding satellites");
+         GPSTK_THROW(e);
+      }
+
+      utc0 = utc;
+      curT = 0.0;
+
+      return (*this);
+
+   }  // End of method 'ConstellationPropagator::setInitEpoch()'
+
+
+      // Set the number of threads
+   ConstellationPropagator& ConstellationPropagator::setNumThreads(
+                                                            unsigned int n)
+   {
+      if(n != numThreads)
+      {
+         delete pool;
+         pool = NULL;
+         numThreads = n;
+      }
+
+      return (*this);
+
+   }  // End of method 'ConstellationPropagator::setNumThreads()'
+
+
+      // Add a satellite at the initial epoch
+   int ConstellationPropagator::addSatellite(Vector<double> rv0,
+                                             SatOrbit* porbit)
+      throw(InvalidRequest)
+   {
+      if(started)
+      {
+         InvalidRequest e("Satellite added after the integration started");
+         GPSTK_THROW(e);
+      }
+      if(rv0.size() < 6)
+      {
+         InvalidRequest e("The size of the initial state is not valid");
+         GPSTK_THROW(e);
+      }
+
+      if(porbit == NULL)
+      {
+         porbit = new SatOrbit();
+         ownOrbits.push_back(porbit);
+      }
+      porbit->setRefEpoch(utc0);
+      porbit->setForceModelType(setFMT);
+      orbits.push_back(porbit);
+
+      // r, v and the identity for dr/dr0 and dv/dv0
+      const int np = getNP();
+      const int n = blockSize();
+      std::vector<double> y(n, 0.0);
+      for(int i = 0; i < 6; i++)
+      {
+         y[i] = rv0(i);
+      }
+      for(int i = 0; i < 3; i++)
+      {
+         y[6 + 4*i] = 1.0;
+         y[33 + 3*np + 4*i] = 1.0;
+      }
+      states.insert(states.end(), y.begin(), y.end());
+      nextStates.resize(states.size(), 0.0);
+      stages.resize(states.size() * 13, 0.0);
+
+      return (orbits.size() - 1);
+
+   }  // End of method 'ConstellationPropagator::addSatellite()'
+
+
+      // Take all the satellites to the given time, with the steps of
+      // RungeKuttaFehlberg::integrateFixedStep()
+   bool ConstellationPropagator::integrateTo(double tf)
+      throw(Exception)
+   {
+      started = true;
+
+      double tt = curT;
+      double dt = stepSize;
+
+      while(curT <= tf)
+      {
+         if((tt + dt) >= tf) break;
+
+         step(tt, dt);
+         tt += dt;
+         curT = tt;
+      }
+
+      dt = tf - tt;
+      step(tt, dt);
+      curT = tf;
+
+      return true;
+
+   }  // End of method 'ConstellationPropagator::integrateTo()'
+
+
+      // Take one RKF78 step of size h from t for all the satellites
+   void ConstellationPropagator::step(double t, double h)
+      throw(Exception)
+   {
+      const int nsat = orbits.size();
+      if(nsat == 0) return;
+
+      // The distinct stage epochs, computed as SatOrbit computes them
+      const RungeKuttaFehlberg::RKF78Param& p =
+                                       RungeKuttaFehlberg::getRKF78Param();
+      std::vector<double> times;
+      for(int s = 0; s < 13; s++)
+      {
+         double ts = (s == 0) ? t : t + p.a[s] * h;
+         bool found(false);
+         for(size_t k = 0; k < times.size() && !found; k++)
+         {
+            found = (times[k] == ts);
+         }
+         if(!found) times.push_back(ts);
+      }
+
+      std::vector<UTCTime> epochs;
+      for(size_t k = 0; k < times.size(); k++)
+      {
+         UTCTime utc = utc0;
+         utc += times[k];
+         epochs.push_back(utc);
+      }
+
+      std::vector<StepTask> tasks(nsat);
+      for(int i = 0; i < nsat; i++)
+      {
+         tasks[i].cp = this;
+         tasks[i].index = i;
+         tasks[i].t = t;
+         tasks[i].h = h;
+      }
+
+      unsigned int nthreads(numThreads);
+      if(nthreads == 0) nthreads = ThreadPool::processorCount();
+
+      if(pool == NULL && nthreads > 1 && nsat > 1)
+      {
+         try
+         {
+            pool = new ThreadPool(nthreads);
+         }
+         catch(Exception&)
+         {
+            pool = NULL;             // step them in this thread instead
+         }
+      }
+
+      // The environment, once for all the satellites
+      long sharedKey = ReferenceFrames::shareEpochs(epochs);
+
+      if(pool && nsat > 1)
+      {
+         for(int i = 0; i < nsat; i++)
+         {
+            pool->submit(&tasks[i]);
+         }
+         pool->wait();
+      }
+      else
+      {
+         for(int i = 0; i < nsat; i++)
+         {
+            tasks[i].run();
+         }
+      }
+
+      ReferenceFrames::clearSharedEpochs(sharedKey);
+
+      for(int i = 0; i < nsat; i++)
+      {
+         if(tasks[i].failed)
+         {
+            Exception e(tasks[i].error);
+            e.addText("In ConstellationPropagator, satellite "
+                      + StringUtils::asString(i));
+            GPSTK_THROW(e);
+         }
+      }
+
+      states.swap(nextStates);
+
+   }  // End of method 'ConstellationPropagator::step()'
+
+
+      // Take one RKF78 step of size h from t for one satellite. The
+      // operations are those of RungeKuttaFehlberg::rkfs78(), in the same
+      // order, so the results are the same.
+   void ConstellationPropagator::stepSatellite(int i, double t, double h)
+      throw(Exception)
+   {
+      const RungeKuttaFehlberg::RKF78Param& p =
+                                       RungeKuttaFehlberg::getRKF78Param();
+      const int n = blockSize();
+      const double* y = &states[i * n];
+      double* ynext = &nextStates[i * n];
+      double* k = &stages[i * 13 * n];
+
+      Vector<double> ytemp(n, 0.0);
+      for(int s = 0; s < 13; s++)
+      {
+         if(s == 0)
+         {
+            for(int j = 0; j < n; j++) ytemp[j] = y[j];
+         }
+         else if(s == 1)
+         {
+            const double bh = p.b[1][0] * h;
+            for(int j = 0; j < n; j++) ytemp[j] = y[j] + bh * k[j];
+         }
+         else
+         {
+            for(int j = 0; j < n; j++)
+            {
+               double sum = p.b[s][0] * k[j];
+               for(int m = 1; m < s; m++)
+               {
+                  sum += p.b[s][m] * k[m*n + j];
+               }
+               ytemp[j] = y[j] + h * sum;
+            }
+         }
+
+         double ts = (s == 0) ? t : t + p.a[s] * h;
+         Vector<double> dydt = orbits[i]->getDerivatives(ts, ytemp);
+
+         double* ks = &k[s * n];
+         for(int j = 0; j < n; j++) ks[j] = dydt[j];
+      }
+
+      // 8th order solution
+      for(int j = 0; j < n; j++)
+      {
+         double sum = p.c2[0] * k[j];
+         for(int s = 1; s < 13; s++)
+         {
+            sum += p.c2[s] * k[s*n + j];
+         }
+         ynext[j] = y[j] + h * sum;
+      }
+
+   }  // End of method 'ConstellationPropagator::stepSatellite()'
+
+
+      // return the current state of a satellite
+   Vector<double> ConstellationPropagator::getCurState(int i) const
+   {
+      const int n = blockSize();
+      const double* y = stateBlock(i);
+
+      Vector<double> state(n, 0.0);
+      for(int j = 0; j < n; j++)
+      {
+         state(j) = y[j];
+      }
+
+      return state;
+   }
+
+
+      // return the position and velocity of a satellite
+   Vector<double> ConstellationPropagator::rvState(int i) const
+   {
+      const double* y = stateBlock(i);
+
+      Vector<double> rv(6, 0.0);
+      for(int j = 0; j < 6; j++)
+      {
+         rv(j) = y[j];
+      }
+
+      return rv;
+   }
+
+
+      // return the rv state transition matrix 6*6 of a satellite
+   Matrix<double> ConstellationPropagator::transitionMatrix(int i) const
+   {
+      const int np = getNP();
+      const double* y = stateBlock(i);
+
+      // the four 3*3 blocks, row by row
+      const double* dr_dr0 = y + 6;
+      const double* dr_dv0 = y + 15;
+      const double* dv_dr0 = y + 24 + 3*np;
+      const double* dv_dv0 = y + 33 + 3*np;
+
+      Matrix<double> phi(6, 6, 0.0);
+      for(int r = 0; r < 3; r++)
+      {
+         for(int c = 0; c < 3; c++)
+         {
+            phi(r, c)     = dr_dr0[3*r + c];
+            phi(r, c+3)   = dr_dv0[3*r + c];
+            phi(r+3, c)   = dv_dr0[3*r + c];
+            phi(r+3, c+3) = dv_dv0[3*r + c];
+         }
+      }
+
+      return phi;
+
+   }  // End of method 'ConstellationPropagator::transitionMatrix()'
+
+
+      // return the sensitivity matrix 6*np of a satellite
+   Matrix<double> ConstellationPropagator::sensitivityMatrix(int i) const
+   {
+      const int np = getNP();
+      const double* y = stateBlock(i);
+
+      // 3*np blocks, row by row
+      const double* dr_dp0 = y + 24;
+      const double* dv_dp0 = y + 42 + 3*np;
+
+      Matrix<double> s(6, np, 0.0);
+      for(int r = 0; r < 3; r++)
+      {
+         for(int c = 0; c < np; c++)
+         {
+            s(r, c)   = dr_dp0[r*np + c];
+            s(r+3, c) = dv_dp0[r*np + c];
+         }
+      }
+
+      return s;
+
+   }  // End of method 'ConstellationPropagator::sensitivityMatrix()'
+
+}  // End of namespace 'gpstk'
@@ -0,0 +1,223 @@
+#pragma ident "$Id$"
+
+/**
+ * @file ConstellationPropagator.hpp
+ * Propagate the orbits of several satellites over the same time grid.
+ */
+
+#ifndef GPSTK_CONSTELLATION_PROPAGATOR_HPP
+#define GPSTK_CONSTELLATION_PROPAGATOR_HPP
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+#include <set>
+#include <vector>
+
+#include "SatOrbit.hpp"
+#include "ThreadPool.hpp"
+
+namespace gpstk
+{
+      /** @addtogroup GeoDynamics */
+      //@{
+
+      /**
+       * Propagate the orbits and variational equations of several
+       * satellites (e.g. a whole GNSS constellation) over the same time
+       * grid, with the fixed-step RKF78 integrator of SatOrbitPropagator.
+       *
+       * Each step is taken by all the satellites together:
+       * 1. The time-dependent environment (EOP, the J2000 to ECEF matrix,
+       *    and the Sun and Moon positions) is evaluated once at the 10
+       *    distinct stage epochs of the step, and shared with the force
+       *    models through ReferenceFrames::shareEpochs(). Propagators
+       *    running at the same time each share their own epochs.
+       * 2. The satellites are stepped in parallel on a pool of threads;
+       *    each one has its own SatOrbit, and so its own force models.
+       *
+       * The states of all the satellites, with the same layout as the
+       * state of SatOrbitPropagator (r, v, dr/dr0, dr/dv0, dr/dp0,
+       * dv/dr0, dv/dv0, dv/dp0), are kept in one array, in blocks of
+       * 42+6*np values, one per satellite; stateBlock() gives direct
+       * access to a block. The steps and their epochs are those of
+       * SatOrbitPropagator with the same step size, and so are the
+       * results.
+       *
+       * @code
+       * ConstellationPropagator cp;
+       * cp.setInitEpoch(utc0);
+       * cp.setStepSize(60.0);
+       * for(int i = 0; i < rv0.size(); i++)
+       * {
+       *    int k = cp.addSatellite(rv0[i]);
+       *    cp.getSatOrbit(k).enableGeopotential(SatOrbit::GM_JGM3, 12, 12);
+       * }
+       * cp.integrateTo(86400.0);
+       * Matrix<double> phi = cp.transitionMatrix(0);
+       * @endcode
+       */
+   class ConstellationPropagator
+   {
+   public:
+
+         /// Default constructor
+      ConstellationPropagator();
+
+         /// Default destructor
+      virtual ~ConstellationPropagator();
+
+         /** Set the force model parameters estimated (the same for all
+          *  the satellites). Must be called before addSatellite().
+          */
+      ConstellationPropagator& setForceModelType(
+                                 std::set<ForceModel::ForceModelType> fmt)
+         throw(InvalidRequest);
+
+         /// Set the initial epoch; must be called before addSatellite().
+      ConstellationPropagator& setInitEpoch(UTCTime utc)
+         throw(InvalidRequest);
+
+         /// Set step size of the integrator
+      ConstellationPropagator& setStepSize(double step_size = 10.0)
+      { stepSize = step_size; return (*this); }
+
+         /// Set the number of threads; 0 means one per processor.
+      ConstellationPropagator& setNumThreads(unsigned int n = 0);
+
+         /** Add a satellite at the initial epoch.
+          * @param rv0     initial position and velocity in J2000
+          * @param porbit  equation of motion of the satellite; not owned.
+          *                If NULL, a default SatOrbit is created, to be
+          *                configured with getSatOrbit().
+          * @return        index of the satellite
+          */
+      int addSatellite(Vector<double> rv0, SatOrbit* porbit = NULL)
+         throw(InvalidRequest);
+
+         /// Number of satellites
+      int numSatellites() const
+      { return orbits.size(); }
+
+         /// Get the equation of motion of a satellite
+      SatOrbit& getSatOrbit(int i)
+      { return *orbits[i]; }
+
+         /** Take all the satellites to the given time.
+          * @param tf    time since the initial epoch in seconds
+          * @return      true
+          * @throw Exception from the force models, for the first
+          *              satellite (by index) that failed; all the states
+          *              are then those of the last step done.
+          */
+      bool integrateTo(double tf)
+         throw(Exception);
+
+         /// return the current epoch
+      UTCTime getCurTime() const
+      { UTCTime utc = utc0; utc += curT; return utc; }
+
+         /// get numble of force model parameters
+      int getNP() const
+      { return setFMT.size(); }
+
+         /// Size of the state of one satellite, 42+6*np
+      int blockSize() const
+      { return 42 + 6 * getNP(); }
+
+         /// The state of a satellite in the array of all the states
+      const double* stateBlock(int i) const
+      { return &states[i * blockSize()]; }
+
+         /// return the current state of a satellite
+      Vector<double> getCurState(int i) const;
+
+         /// return the position and velocity of a satellite, in J2000
+      Vector<double> rvState(int i) const;
+
+         /// return the rv state transition matrix 6*6 of a satellite
+      Matrix<double> transitionMatrix(int i) const;
+
+         /// return the sensitivity matrix 6*np of a satellite
+      Matrix<double> sensitivityMatrix(int i) const;
+
+   protected:
+
+         /// Task taking one step for one satellite
+      class StepTask;
+
+         /// Take one RKF78 step of size h from t for all the satellites
+      void step(double t, double h)
+         throw(Exception);
+
+         /// Take one RKF78 step of size h from t for one satellite
+      void stepSatellite(int i, double t, double h)
+         throw(Exception);
+
+         /// Equations of motion, one per satellite
+      std::vector<SatOrbit*> orbits;
+
+         /// The orbits created by addSatellite(), deleted with this object
+      std::vector<SatOrbit*> ownOrbits;
+
+         /// States of all the satellites, blockSize() values each
+      std::vector<double> states;
+
+         /// States at the end of the step being taken; they replace
+         /// 'states' once all the satellites have taken the step
+      std::vector<double> nextStates;
+
+         /// Stage derivatives of the RKF78 step, 13 blocks per satellite
+      std::vector<double> stages;
+
+         /// Force model parameters estimated
+      std::set<ForceModel::ForceModelType> setFMT;
+
+         /// Initial epoch
+      UTCTime utc0;
+
+         /// current time since the initial epoch
+      double curT;
+
+         /// True once the first step has been taken
+      bool started;
+
+         /// Step size of the integrator
+      double stepSize;
+
+         /// Number of threads; 0 for one per processor
+      unsigned int numThreads;
+
+         /// Threads stepping the satellites, created by the first step
+      ThreadPool* pool;
+
+   private:
+
+         /// Not copyable
+      ConstellationPropagator(const ConstellationPropagator&);
+      ConstellationPropagator& operator=(const ConstellationPropagator&);
+
+   }; // End of class 'ConstellationPropagator'
+
+      // @}
+
+}  // End of namespace 'gpstk'
+
+#endif   // GPSTK_CONSTELLATION_PROPAGATOR_HPP
@@ -31,11 +31,16 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <map>
 #include <cmath>
 #include "StringUtils.hpp"
 #include "IERS.hpp"
 #include "ASConstant.hpp"
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 
 namespace gpstk
 {
@@ -66,6 +71,90 @@ namespace gpstk
    const double ReferenceFrames::TURNAS = 1296000.0;
 
 
+      // The sets of epochs given to shareEpochs(), by key, with the values
+      // computed for them. Written by shareEpochs() and clearSharedEpochs(),
+      // read by any number of threads at the same time.
+   namespace
+   {
+      struct SharedEpoch
+      {
+         CommonTime utc;
+         CommonTime tdb;
+         Matrix<double> POM, Theta, NP, C2T;
+         bool hasPlanets;
+         Vector<double> sun, moon;
+      };
+
+      struct SharedEpochs
+      {
+         std::map<long, std::vector<SharedEpoch> > sets;
+         long nextKey;
+#ifndef _WIN32
+         pthread_rwlock_t lock;
+#endif
+
+         SharedEpochs() : nextKey(0)
+         {
+#ifndef _WIN32
+            pthread_rwlock_init(&lock, 0);
+#endif
+         }
+      };
+
+      SharedEpochs shared;
+
+#ifndef _WIN32
+         // the JPL ephemeris, unless mapped, reads its file on demand: one
+         // reader at a time
+      pthread_mutex_t jplLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+         // exactly the same epoch, in the same time system
+      bool sameEpoch(const CommonTime& a, const CommonTime& b)
+      {
+         if(a.getTimeSystem() != b.getTimeSystem()) return false;
+
+         long aday(0), asod(0), bday(0), bsod(0);
+         double afsod(0.0), bfsod(0.0);
+         a.get(aday, asod, afsod);
+         b.get(bday, bsod, bfsod);
+
+         return (aday == bday && asod == bsod && afsod == bfsod);
+      }
+
+         // the shared epoch for this UTC (key true) or TDB (key false)
+         // epoch; call with the lock held
+      const SharedEpoch* findShared(const CommonTime& t, bool utc)
+      {
+         std::map<long, std::vector<SharedEpoch> >::const_iterator it;
+         for(it = shared.sets.begin(); it != shared.sets.end(); it++)
+         {
+            for(size_t i = 0; i < it->second.size(); i++)
+            {
+               const SharedEpoch& se = it->second[i];
+               if(sameEpoch(utc ? se.utc : se.tdb, t)) return &se;
+            }
+         }
+         return 0;
+      }
+
+      void readLockShared()
+      {
+#ifndef _WIN32
+         pthread_rwlock_rdlock(&shared.lock);
+#endif
+      }
+
+      void unlockShared()
+      {
+#ifndef _WIN32
+         pthread_rwlock_unlock(&shared.lock);
+#endif
+      }
+
+   }  // End of unnamed namespace
+
+
       /* Compute planet position in J2000
        *  
        * @param TT         Time(Modified Julian Date in TT<TAI+32.184>) of interest 
@@ -122,13 +211,47 @@ namespace gpstk
    {
       Vector<double> rvJ2k(6,0.0);
 
+      if( center == SolarSystem::Earth &&
+          (entity == SolarSystem::Sun || entity == SolarSystem::Moon) )
+      {
+         bool found(false);
+         readLockShared();
+         const SharedEpoch* pse = findShared(TT, false);
+         if(pse && pse->hasPlanets)
+         {
+            rvJ2k = (entity == SolarSystem::Sun) ? pse->sun : pse->moon;
+            found = true;
+         }
+         unlockShared();
+
+         if(found) return rvJ2k;
+      }
+
       try
       {
          double rvState[6] = {0.0};
-         int ret = solarPlanets.computeState(JD_TO_MJD + static_cast<Epoch>(TT).MJD(),
-            entity,
-            center,
-            rvState);
+#ifndef _WIN32
+         const bool locked(!solarPlanets.isMapped());
+         if(locked) pthread_mutex_lock(&jplLock);
+#endif
+         int ret(0);
+         try
+         {
+            ret = solarPlanets.computeState(JD_TO_MJD + static_cast<Epoch>(TT).MJD(),
+               entity,
+               center,
+               rvState);
+         }
+         catch(...)
+         {
+#ifndef _WIN32
+            if(locked) pthread_mutex_unlock(&jplLock);
+#endif
+            throw;
+         }
+#ifndef _WIN32
+         if(locked) pthread_mutex_unlock(&jplLock);
+#endif
          
             // change the unit to km/s from km/day
          rvState[3] /= 86400.0;
@@ -243,14 +366,76 @@ namespace gpstk
                                          Matrix<double>& NP)
       throw(Exception)
    {
-      // Earth orientation data
-      double xp = UTC.xPole() * DAS2R;
-      double yp = UTC.yPole() * DAS2R;
+      // Shared epoch ?
+      bool found(false);
+      readLockShared();
+      const SharedEpoch* pse = findShared(UTC, true);
+      if(pse)
+      {
+         POM = pse->POM;
+         Theta = pse->Theta;
+         NP = pse->NP;
+         found = true;
+      }
+      unlockShared();
+
+      if(found) return;
+
+      // Earth orientation data, from a single look-up
+      double mjdUTC = UTC.mjdUTC();
+      double xp(0.0), yp(0.0), ut1mutc(0.0);
+      try
+      {
+         EOPDataStore::EOPData eop = IERS::eopData(mjdUTC);
+         xp = eop.xp;
+         yp = eop.yp;
+         ut1mutc = eop.UT1mUTC;
+      }
+      catch(InvalidRequest&)
+      {
+         // no data: these warn and return zero
+         xp = IERS::xPole(mjdUTC);
+         yp = IERS::yPole(mjdUTC);
+         ut1mutc = IERS::UT1mUTC(mjdUTC);
+      }
+      xp *= DAS2R;
+      yp *= DAS2R;
      
       CommonTime TT = UTC.asTT();
-      CommonTime UT1 = UTC.asUT1();
+      CommonTime UT1 = UTC;
+      UT1 += ut1mutc;
+      
+      // Precession-nutation matrix and euqation of the equinoxes
+      double EE(0.0);
+      if(usingPrecessionNutationCache())
+      {
+         cachedPrecessionNutation(TT, NP, EE);
+      }
+      else
+      {
+         precessionNutation(TT, NP, EE);
+      }
+
+      // Greenwich apparent sidereal time(IAU 1982/1994)
+      double GST = normalizeAngle(iauGmst82(UT1) + EE);
       
+      Theta =  Rz(GST);
+     
+      // Polar motion matrix
+      POM = Ry(-xp) * Rx(-yp);
+      
+      // All Matrix are ready now
+
+      return;
+      
+   }  // End of method 'ReferenceFrames::J2kToECEFMatrix()'
 
+
+      // NP = N * P, and the equation of the equinoxes
+   void ReferenceFrames::precessionNutation(CommonTime TT,
+                                            Matrix<double>& NP,
+                                            double& EE)
+   {
       // IAU 1976 precession matrix       
       Matrix<double> P = iauPmat76(TT);
 
@@ -276,26 +461,267 @@ namespace gpstk
       NP = N * P;
 
       // Euqation of the equinoxes, including nutation correction
-      double EE = iauEqeq94(TT) + DDP80 * std::cos(EPSA);
+      EE = iauEqeq94(TT) + DDP80 * std::cos(EPSA);
 
-      // Greenwich apparent sidereal time(IAU 1982/1994)
-      double GST = normalizeAngle(iauGmst82(UT1) + EE);
-      
-      Theta =  Rz(GST);
-     
-      // Polar motion matrix
-      POM = Ry(-xp) * Rx(-yp);
-      
-      // All Matrix are ready now
+   }  // End of method 'ReferenceFrames::precessionNutation()'
 
-      return;
-      
-   }  // End of method 'ReferenceFrames::J2kToECEFMatrix()'
+
+      // The precession-nutation cache: a table of nodes, each holding the
+      // 9 elements of NP and the equation of the equinoxes at a multiple
+      // of 'step' seconds of TT from J2000. Node n is kept in slot
+      // n % CACHE_SIZE, which holds enough nodes for several concurrent
+      // integrations over nearby epochs.
+   namespace
+   {
+      const int CACHE_SIZE = 32;
+
+      struct PNNode
+      {
+         bool valid;
+         long index;
+         double value[10];
+      };
+
+      struct PNCache
+      {
+         bool use;
+         double step;
+         PNNode node[CACHE_SIZE];
+#ifndef _WIN32
+         pthread_mutex_t lock;
+#endif
+
+         PNCache() : use(true), step(3600.0)
+         {
+            clear();
+#ifndef _WIN32
+            pthread_mutex_init(&lock, 0);
+#endif
+         }
+
+         void clear()
+         {
+            for(int i = 0; i < CACHE_SIZE; i++)
+            {
+               node[i].valid = false;
+            }
+         }
+      };
+
+      PNCache pnCache;
+
+   }  // End of unnamed namespace
+
+
+      // Use (or not) the precession-nutation cache.
+   void ReferenceFrames::setPrecessionNutationCache(bool use, double step)
+      throw(InvalidParameter)
+   {
+      if( step < 60.0 || step > 86400.0 )
+      {
+         InvalidParameter e("Invalid precession-nutation cache step: "
+                            + StringUtils::asString(step));
+         GPSTK_THROW(e);
+      }
+
+#ifndef _WIN32
+      pthread_mutex_lock(&pnCache.lock);
+#endif
+      pnCache.use = use;
+      if(step != pnCache.step)
+      {
+         pnCache.step = step;
+         pnCache.clear();
+      }
+#ifndef _WIN32
+      pthread_mutex_unlock(&pnCache.lock);
+#endif
+
+   }  // End of method 'ReferenceFrames::setPrecessionNutationCache()'
+
+
+   bool ReferenceFrames::usingPrecessionNutationCache()
+   {
+#ifndef _WIN32
+      pthread_mutex_lock(&pnCache.lock);
+#endif
+      bool use = pnCache.use;
+#ifndef _WIN32
+      pthread_mutex_unlock(&pnCache.lock);
+#endif
+      return use;
+   }
+
+
+      // Share the Earth orientation and the Sun and Moon positions at a
+      // set of epochs among all callers.
+   long ReferenceFrames::shareEpochs(const std::vector<UTCTime>& epochs)
+      throw(Exception)
+   {
+      // Computed before they are published, so by the direct methods, or
+      // taken from a set shared by another caller
+      std::vector<SharedEpoch> table(epochs.size());
+      for(size_t i = 0; i < epochs.size(); i++)
+      {
+         UTCTime utc(epochs[i]);
+         SharedEpoch& se = table[i];
+
+         se.utc = utc;
+         J2kToECEFMatrix(utc, se.POM, se.Theta, se.NP);
+         se.C2T = se.POM * se.Theta * se.NP;
+
+         se.tdb = utc.asTDB();
+         try
+         {
+            se.sun = getJ2kPosVel(se.tdb, SolarSystem::Sun);
+            se.moon = getJ2kPosVel(se.tdb, SolarSystem::Moon);
+            se.hasPlanets = true;
+         }
+         catch(Exception&)
+         {
+            // no ephemeris: left to the direct method, which throws
+            se.hasPlanets = false;
+         }
+      }
+
+#ifndef _WIN32
+      pthread_rwlock_wrlock(&shared.lock);
+#endif
+      long key = shared.nextKey++;
+      shared.sets[key].swap(table);
+#ifndef _WIN32
+      pthread_rwlock_unlock(&shared.lock);
+#endif
+
+      return key;
+
+   }  // End of method 'ReferenceFrames::shareEpochs()'
+
+
+      // Forget the epochs given to shareEpochs() under this key
+   void ReferenceFrames::clearSharedEpochs(long key)
+   {
+      std::vector<SharedEpoch> table;
+#ifndef _WIN32
+      pthread_rwlock_wrlock(&shared.lock);
+#endif
+      std::map<long, std::vector<SharedEpoch> >::iterator it =
+                                                      shared.sets.find(key);
+      if(it != shared.sets.end())
+      {
+         it->second.swap(table);
+         shared.sets.erase(it);
+      }
+#ifndef _WIN32
+      pthread_rwlock_unlock(&shared.lock);
+#endif
+   }
+
+
+      // NP and equation of the equinoxes by interpolation between nodes
+   void ReferenceFrames::cachedPrecessionNutation(CommonTime TT,
+                                                  Matrix<double>& NP,
+                                                  double& EE)
+   {
+      // Seconds of TT from J2000 (JD 2451545.0 = day 2451545 + 43200 s)
+      long day(0), sod(0);
+      double fsod(0.0);
+      TT.get(day, sod, fsod);
+      double sec = double(day - 2451545) * 86400.0
+                 + double(sod - 43200) + fsod;
+
+      double values[4][10];
+
+#ifndef _WIN32
+      pthread_mutex_lock(&pnCache.lock);
+#endif
+      const double step = pnCache.step;
+      const long n = long(std::floor(sec / step));
+      const double u = sec / step - double(n);
+
+      for(int k = 0; k < 4; k++)
+      {
+         long index = n - 1 + k;
+         PNNode& node = pnCache.node[((index % CACHE_SIZE) + CACHE_SIZE)
+                                     % CACHE_SIZE];
+         if(!node.valid || node.index != index)
+         {
+            // node epoch, built from the index alone so that the value
+            // does not depend on the epoch that needed it first
+            double nsec = double(index) * step + 43200.0;
+            double nday = std::floor(nsec / 86400.0);
+            double nsod = nsec - nday * 86400.0;
+            CommonTime nodeTT;
+            nodeTT.set(2451545L + long(nday), long(nsod), 
+                       nsod - std::floor(nsod), TT.getTimeSystem());
+
+            Matrix<double> nodeNP;
+            double nodeEE(0.0);
+            precessionNutation(nodeTT, nodeNP, nodeEE);
+
+            for(int i = 0; i < 3; i++)
+            {
+               for(int j = 0; j < 3; j++)
+               {
+                  node.value[3*i+j] = nodeNP(i,j);
+               }
+            }
+            node.value[9] = nodeEE;
+            node.index = index;
+            node.valid = true;
+         }
+
+         for(int i = 0; i < 10; i++)
+         {
+            values[k][i] = node.value[i];
+         }
+      }
+#ifndef _WIN32
+      pthread_mutex_unlock(&pnCache.lock);
+#endif
+
+      // Cubic Lagrange weights for nodes n-1, n, n+1, n+2
+      const double w[4] = { -u * (u - 1.0) * (u - 2.0) / 6.0,
+                            (u + 1.0) * (u - 1.0) * (u - 2.0) / 2.0,
+                            -(u + 1.0) * u * (u - 2.0) / 2.0,
+                            (u + 1.0) * u * (u - 1.0) / 6.0 };
+
+      double v[10];
+      for(int i = 0; i < 10; i++)
+      {
+         v[i] = w[0] * values[0][i] + w[1] * values[1][i]
+              + w[2] * values[2][i] + w[3] * values[3][i];
+      }
+
+      NP.resize(3, 3);
+      for(int i = 0; i < 3; i++)
+      {
+         for(int j = 0; j < 3; j++)
+         {
+            NP(i,j) = v[3*i+j];
+         }
+      }
+      EE = v[9];
+
+   }  // End of method 'ReferenceFrames::cachedPrecessionNutation()'
 
 
       // return POM * Theta * NP 
    Matrix<double> ReferenceFrames::J2kToECEFMatrix(UTCTime UTC)
    {
+      Matrix<double> C2T;
+      bool found(false);
+      readLockShared();
+      const SharedEpoch* pse = findShared(UTC, true);
+      if(pse)
+      {
+         C2T = pse->C2T;
+         found = true;
+      }
+      unlockShared();
+
+      if(found) return C2T;
+
       Matrix<double> POM, Theta, NP;
       J2kToECEFMatrix(UTC,POM,Theta,NP);
 
@@ -34,6 +34,7 @@
 
 
 
+#include <vector>
 #include "Vector.hpp"
 #include "Matrix.hpp"
 #include "SolarSystem.hpp"
@@ -50,18 +51,20 @@ namespace gpstk
    {
    public:
 
-         /** Open the given binary file, 
+         /** Open the given binary file, mapped into memory so that the
+          *  planets may be computed by several threads at the same time
+          *  (see SolarSystem::initializeWithMappedFile()).
           *  
           * @param filename  name of binary file to be read.
           * @return 0 success,
-          *        -3 input stream is not open or not valid
+          *        -3 the file could not be mapped, or holds no data
           *        -4 header has not yet been read.
           * @throw if a gap in time is found between consecutive records.
           */
       static int setJPLEphFile(std::string filename) 
          throw(Exception)
       {
-         return solarPlanets.initializeWithBinaryFile(filename);
+         return solarPlanets.initializeWithMappedFile(filename);
       }
 
          /** Compute planet position in J2000
@@ -147,6 +150,59 @@ namespace gpstk
 
          /// Get ECI to ECF transform matrix, POM * Theta * NP 
       static Matrix<double> J2kToECEFMatrix(UTCTime UTC);
+
+         /** Use (or not) the precession-nutation cache.
+          *
+          * With the cache, J2kToECEFMatrix() does not evaluate the
+          * precession matrix, the nutation series and the equation of the
+          * equinoxes at every call. They are computed at nodes spaced
+          * 'step' seconds apart in TT, and the NP matrix and the equation
+          * of the equinoxes are interpolated between the four nodes around
+          * the epoch (cubic Lagrange). The nodes are kept in a small table
+          * shared by all callers, so the integration of several satellites
+          * over the same epochs computes each node once. Sidereal time and
+          * polar motion are still evaluated at the epoch itself.
+          *
+          * With the default step of 3600 s the interpolation error is
+          * below 1e-14 rad (less than 1 micrometer at GPS altitude); with
+          * 21600 s it is below 1e-11 rad. The cache is used by default.
+          *
+          * @param use     true to use the cache
+          * @param step    spacing of the nodes in seconds (60 to 86400)
+          */
+      static void setPrecessionNutationCache(bool use, double step = 3600.0)
+         throw(InvalidParameter);
+
+         /// True if J2kToECEFMatrix() uses the precession-nutation cache
+      static bool usingPrecessionNutationCache();
+
+         /** Share the Earth orientation and the Sun and Moon positions at
+          *  a set of epochs among all callers.
+          *
+          * The J2000 to ECEF matrices, and the Sun and Moon positions
+          * relative to the Earth at the TDB of each epoch, are computed
+          * here once. J2kToECEFMatrix() at one of these epochs, and
+          * getJ2kPosVel() of the Sun or the Moon at one of these TDB
+          * epochs, then return the shared values, which are those the
+          * direct evaluation gives. This is meant for the integration of
+          * several satellites over the same epochs (see
+          * ConstellationPropagator), where every satellite needs the same
+          * environment at each stage of the integration step.
+          *
+          * Each call adds a set of epochs, kept apart from the sets of
+          * other callers (e.g. several propagators running at once) until
+          * it is released with clearSharedEpochs(). Release it when the
+          * step is done: changes to the EOP data or to the JPL ephemeris
+          * are not seen at shared epochs.
+          *
+          * @param epochs  UTC epochs of interest
+          * @return        key of the set, for clearSharedEpochs()
+          */
+      static long shareEpochs(const std::vector<UTCTime>& epochs)
+         throw(Exception);
+
+         /// Forget the epochs given to shareEpochs() under this key
+      static void clearSharedEpochs(long key);
          
          /// NP TOD - TrueOfDate
       static Matrix<double> J2kToTODMatrix(UTCTime UTC);
@@ -250,6 +306,18 @@ namespace gpstk
                                     const double& dpsi, 
                                     const double& deps);
 
+         /** Precession-nutation matrix NP and equation of the equinoxes,
+          *  evaluated from the IAU 1976/1980/1994 models.
+          */
+      static void precessionNutation(CommonTime TT, 
+                                     Matrix<double>& NP, 
+                                     double& EE);
+
+         /// NP and equation of the equinoxes from the cache
+      static void cachedPrecessionNutation(CommonTime TT, 
+                                           Matrix<double>& NP, 
+                                           double& EE);
+
          /// earth rotation angle
       static double earthRotationAngle(CommonTime UT1);
 
@@ -102,6 +102,11 @@ namespace gpstk
       RungeKuttaFehlberg& setAdaptive(const bool& adaptive = true)
       { isAdaptive = adaptive; return (*this); }
 
+         /// The RKF78 coefficients, for integrators stepping several
+         /// states at once
+      static const RKF78Param& getRKF78Param()
+      { return rkf78_param; }
+
 
    protected:
          
@@ -182,8 +182,8 @@ namespace gpstk
       }
       for(int i = 0;i < 3*np; i++)
       {
-         dr_dp0 = curState(24+i);
-         dv_dp0 = curState(42+3*np+i);
+         dr_dp0(i) = curState(24+i);
+         dv_dp0(i) = curState(42+3*np+i);
       }
 
       // update phiMatrix
@@ -29,6 +29,7 @@
 
 
 
+#include <algorithm>
 #include "SphericalHarmonicGravity.hpp"
 #include "ASConstant.hpp"
 #include "IERS.hpp"
@@ -43,93 +44,305 @@ namespace gpstk
        * @param m Desired order.
        */
    SphericalHarmonicGravity::SphericalHarmonicGravity(int n, int m)
-      : desiredDegree(n),
+      : kernelDegree(0),
+        kernelOrder(0),
+        kernelSize(0),
+        kernelReady(false),
+        desiredDegree(n),
         desiredOrder(m),
         correctSolidTide(false),
-        correctOceanTide(false),
-        correctPoleTide(false)
+        correctPoleTide(false),
+        correctOceanTide(false)
    {
-      const int size = desiredDegree;
-
-      V.resize( size + 3, size + 3, 0.0);
-      W.resize( size + 3, size + 3, 0.0);
-
       //Sn0.resize(gmData.maxDegree, 0.0);
+   }
 
+
+      // Index of degree n, order m in the flat arrays
+   static inline int triIndex(int n, int m)
+   {
+      return n * (n + 1) / 2 + m;
    }
 
-   
-      /* Evaluates the two harmonic functions V and W.
-       * @param r ECI position vector.
-       * @param E ECI to ECEF transformation matrix.
+
+      /* Build the recursion coefficients and the C and S arrays for the
+       * desired degree and order.
        */
-   void SphericalHarmonicGravity::computeVW(Vector<double> r, Matrix<double> E)
-   {   
-      // dimension should be checked here
-      // I'll do it latter...
-      if((r.size()!=3) || (E.rows()!=3) || (E.cols()!=3))
+   void SphericalHarmonicGravity::prepareKernel()
+   {
+      if(kernelReady) return;
+
+      // The coefficients are only defined up to the degree of the model
+      int nmax = std::min(desiredDegree, gmData.maxDegree);
+      if(nmax < 0) nmax = 0;
+      int mmax = std::min(std::min(desiredOrder, nmax), gmData.maxOrder);
+      if(mmax < 0) mmax = 0;
+
+      kernelDegree = nmax;
+      kernelOrder = mmax;
+
+      // V and W up to degree nmax+2
+      kernelSize = triIndex(nmax + 3, 0);
+      V.assign(kernelSize, 0.0);
+      W.assign(kernelSize, 0.0);
+
+      recA.assign(kernelSize, 0.0);
+      recB.assign(kernelSize, 0.0);
+      for(int n = 2; n <= (nmax + 2); n++)
       {
-         Exception e("Wrong input for computeVW");
-         GPSTK_THROW(e);
+         for(int m = 0; m <= (n - 2); m++)
+         {
+            recA[triIndex(n,m)] = double(2*n - 1) / double(n - m);
+            recB[triIndex(n,m)] = double(n + m - 1) / double(n - m);
+         }
       }
 
-      // Rotate from ECI to ECEF
-      Vector<double> r_bf = E * r; 
+      // C[n][m] = CS[n][m], S[n][m] = CS[m-1][n]
+      const Matrix<double>& CS = gmData.unnormalizedCS;
+      const int size = triIndex(nmax + 1, 0);
+      coefC.assign(size, 0.0);
+      coefS.assign(size, 0.0);
+      for(int n = 0; n <= nmax; n++)
+      {
+         for(int m = 0; m <= std::min(n, mmax); m++)
+         {
+            coefC[triIndex(n,m)] = CS(n,m);
+            coefS[triIndex(n,m)] = (m == 0) ? 0.0 : CS(m-1,n);
+         }
+      }
+
+      kernelReady = true;
+
+   }  // End of method 'SphericalHarmonicGravity::prepareKernel()'
 
+
+      /* Evaluates V and W at a body fixed position.
+       * @param rbf body fixed position [3].
+       * @param v, w harmonic functions, kernelSize values each.
+       */
+   void SphericalHarmonicGravity::recursionVW(const double* rbf,
+                                              double* v,
+                                              double* w) const
+   {
       const double R_ref = gmData.refDistance;
 
       // Auxiliary quantities
-      double r_sqr =  dot(r_bf, r_bf);
-      double rho   =  R_ref * R_ref / r_sqr;
+      const double r_sqr = rbf[0]*rbf[0] + rbf[1]*rbf[1] + rbf[2]*rbf[2];
+      const double rho   = R_ref * R_ref / r_sqr;
 
       // Normalized coordinates
-      double x0 = R_ref * r_bf(0) / r_sqr;          
-      double y0 = R_ref * r_bf(1) / r_sqr;   
-      double z0 = R_ref * r_bf(2) / r_sqr;
-
+      const double x0 = R_ref * rbf[0] / r_sqr;
+      const double y0 = R_ref * rbf[1] / r_sqr;
+      const double z0 = R_ref * rbf[2] / r_sqr;
 
       //
       // Evaluate harmonic functions 
       //   V_nm = (R_ref/r)^(n+1) * P_nm(sin(phi)) * cos(m*lambda)
       // and 
       //   W_nm = (R_ref/r)^(n+1) * P_nm(sin(phi)) * sin(m*lambda)
-      // up to degree and order n_max+1
+      // up to degree n_max+2 and order m_max+2, one degree at a time
       //
+      const int nmax = kernelDegree + 2;
+      const int mmax = kernelOrder + 2;
 
-      // Calculate zonal terms V(n,0); set W(n,0)=0.0
-      V[0][0] = R_ref / std::sqrt(r_sqr);
-      W[0][0] = 0.0;
-
-      V[1][0] = z0 * V[0][0];
-      W[1][0] = 0.0;
+      v[0] = R_ref / std::sqrt(r_sqr);
+      w[0] = 0.0;
 
-      for(int n = 2; n <= (desiredDegree+2); n++) 
+      for(int n = 1; n <= nmax; n++)
       {
-         V[n][0] = ((2*n - 1) * z0 * V[n-1][0] - (n - 1) * rho * V[n-2][0]) /n;
-         W[n][0] = 0.0;
+         double* vn = v + triIndex(n, 0);
+         double* wn = w + triIndex(n, 0);
+         const double* vn1 = v + triIndex(n-1, 0);
+         const double* wn1 = w + triIndex(n-1, 0);
+
+         // Zonal and tesseral terms, from degrees n-1 and n-2; the
+         // orders are independent of each other
+         if(n >= 2)
+         {
+            const double* vn2 = v + triIndex(n-2, 0);
+            const double* wn2 = w + triIndex(n-2, 0);
+            const double* a = &recA[triIndex(n, 0)];
+            const double* b = &recB[triIndex(n, 0)];
+            const int mlast = std::min(n - 2, mmax);
+            for(int m = 0; m <= mlast; m++)
+            {
+               const double az = a[m] * z0;
+               const double br = b[m] * rho;
+               vn[m] = az * vn1[m] - br * vn2[m];
+               wn[m] = az * wn1[m] - br * wn2[m];
+            }
+         }
+
+         // V(n,n-1) from the sectorial term of degree n-1
+         if((n - 1) <= mmax)
+         {
+            vn[n-1] = (2 * n - 1) * z0 * vn1[n-1];
+            wn[n-1] = (2 * n - 1) * z0 * wn1[n-1];
+         }
+
+         // Sectorial term
+         if(n <= mmax)
+         {
+            vn[n] = (2 * n - 1) * ( x0 * vn1[n-1] - y0 * wn1[n-1] );
+            wn[n] = (2 * n - 1) * ( x0 * wn1[n-1] + y0 * vn1[n-1] );
+         }
       }
 
-      // Calculate tesseral and sectorial terms
-      for (int m = 1; m <= (desiredOrder+2); m++) 
+   }  // End of method 'SphericalHarmonicGravity::recursionVW()'
+
+
+      /* Sums the harmonic series for 'count' positions.
+       * @param abf body fixed accelerations [3*count], unscaled.
+       * @param gbf body fixed gradients [9*count], unscaled; NULL to
+       *            skip them.
+       */
+   void SphericalHarmonicGravity::sumSeries(int count,
+                                            const double* v,
+                                            const double* w,
+                                            double* abf,
+                                            double* gbf) const
+   {
+      for(int k = 0; k < 3*count; k++) abf[k] = 0.0;
+      if(gbf)
       {
-         // Calculate V(m,m) .. V(n_max+1,m)
+         for(int k = 0; k < 9*count; k++) gbf[k] = 0.0;
+      }
 
-         V[m][m] = (2 * m - 1) * ( x0 * V[m-1][m-1] - y0 * W[m-1][m-1] );
-         W[m][m] = (2 * m - 1) * ( x0 * W[m-1][m-1] + y0 * V[m-1][m-1] );
+      // Degree by degree, so that the coefficients of a degree are read
+      // once for all the positions
+      for(int n = 0; n <= kernelDegree; n++)
+      {
+         const double* C = &coefC[triIndex(n, 0)];
+         const double* S = &coefS[triIndex(n, 0)];
+         const int mmax = std::min(n, kernelOrder);
 
-         if (m <= (desiredDegree+1) ) 
+         for(int k = 0; k < count; k++)
          {
-            V[m+1][m] = (2 * m + 1) * z0 * V[m][m];
-            W[m+1][m] = (2 * m + 1) * z0 * W[m][m];
+            const double* v1 = v + k*kernelSize + triIndex(n+1, 0);
+            const double* w1 = w + k*kernelSize + triIndex(n+1, 0);
+
+            // Acceleration; zonal term first
+            double ax = -C[0] * v1[1];
+            double ay = -C[0] * w1[1];
+            double az = -(n+1) * C[0] * v1[0];
+            for(int m = 1; m <= mmax; m++)
+            {
+               const double Fac = 0.5 * (n-m+1) * (n-m+2);
+               ax += 0.5*(-C[m]*v1[m+1] - S[m]*w1[m+1]) 
+                     + Fac*(C[m]*v1[m-1] + S[m]*w1[m-1]);
+               ay += 0.5*(-C[m]*w1[m+1] + S[m]*v1[m+1]) 
+                     + Fac*(-C[m]*w1[m-1] + S[m]*v1[m-1]);
+               az += (n-m+1)*(-C[m]*v1[m] - S[m]*w1[m]);
+            }
+            abf[3*k]   += ax;
+            abf[3*k+1] += ay;
+            abf[3*k+2] += az;
+
+            if(!gbf) continue;
+
+            const double* v2 = v + k*kernelSize + triIndex(n+2, 0);
+            const double* w2 = w + k*kernelSize + triIndex(n+2, 0);
+
+            double xx(0.0), xy(0.0), xz(0.0), zz(0.0), yz(0.0);
+
+            // zonal term
+            xx += 0.5 * (C[0]*v2[2] - (n+2)*(n+1)*C[0]*v2[0]);
+            xy += 0.5 * C[0] * w2[2];
+            xz += (n+1) * C[0] * v2[1];
+            yz += (n+1) * C[0] * w2[1];
+            zz += (n+2)*(n+1) * C[0] * v2[0];
+
+            for(int m = 1; m <= mmax; m++)
+            {
+               const double f1 = 0.5*(n-m+1);
+               const double f2 = (n-m+3)*(n-m+2)*f1;
+
+               zz += (n-m+2)*(n-m+1)*(C[m]*v2[m] + S[m]*w2[m]);
+               xz += f1*(C[m]*v2[m+1] + S[m]*w2[m+1])
+                     - f2*(C[m]*v2[m-1] + S[m]*w2[m-1]);
+               yz += f1*(C[m]*w2[m+1] - S[m]*v2[m+1])
+                     + f2*(C[m]*w2[m-1] - S[m]*v2[m-1]);
+            }
+
+            if(mmax >= 1)
+            {
+               const double Fac = (n+1)*n;
+               xx += 0.25*(C[1]*v2[3] + S[1]*w2[3]
+                           - Fac*(3.0*C[1]*v2[1] + S[1]*w2[1]));
+               xy += 0.25*(C[1]*w2[3] - S[1]*v2[3]
+                           - Fac*(C[1]*w2[1] + S[1]*v2[1]));
+            }
+
+            for(int m = 2; m <= mmax; m++)
+            {
+               const double f1 = 2.0*(n-m+2)*(n-m+1);
+               const double f2 = (n-m+4)*(n-m+3)*f1*0.5;
+               xx += 0.25*(C[m]*v2[m+2] + S[m]*w2[m+2]
+                           - f1*(C[m]*v2[m] + S[m]*w2[m])
+                           + f2*(C[m]*v2[m-2] + S[m]*w2[m-2]));
+               xy += 0.25*(C[m]*w2[m+2] - S[m]*v2[m+2]
+                           + f2*(-C[m]*w2[m-2] + S[m]*v2[m-2]));
+            }
+
+            double* g = gbf + 9*k;
+            g[0] += xx;
+            g[1] += xy;
+            g[2] += xz;
+            g[5] += yz;
+            g[8] += zz;
          }
 
-         for (int n = (m+2); n <= (desiredDegree+2); n++) 
+      }  // End of 'for(int n = 0; n <= kernelDegree; n++)'
+
+      // Symmetric gradient, with yy = -xx - zz (Laplace)
+      if(gbf)
+      {
+         for(int k = 0; k < count; k++)
          {
-            V[n][m] = ((2*n-1)*z0*V[n-1][m] - (n+m-1)*rho*V[n-2][m]) / (n-m);
-            W[n][m] = ((2*n-1)*z0*W[n-1][m] - (n+m-1)*rho*W[n-2][m]) / (n-m);
+            double* g = gbf + 9*k;
+            g[3] = g[1];
+            g[4] = -g[0] - g[8];
+            g[6] = g[2];
+            g[7] = g[5];
          }
+      }
+
+   }  // End of method 'SphericalHarmonicGravity::sumSeries()'
+
+
+      // r_bf = E * r
+   static inline void rotateToBodyFixed(const Matrix<double>& E,
+                                        const double* r,
+                                        double* rbf)
+   {
+      for(int i = 0; i < 3; i++)
+      {
+         rbf[i] = E(i,0)*r[0] + E(i,1)*r[1] + E(i,2)*r[2];
+      }
+   }
+
+
+      /* Evaluates the two harmonic functions V and W.
+       * @param r ECI position vector.
+       * @param E ECI to ECEF transformation matrix.
+       */
+   void SphericalHarmonicGravity::computeVW(const Vector<double>& r,
+                                            const Matrix<double>& E)
+   {   
+      if((r.size()!=3) || (E.rows()!=3) || (E.cols()!=3))
+      {
+         Exception e("Wrong input for computeVW");
+         GPSTK_THROW(e);
+      }
+
+      prepareKernel();
+
+      // Rotate from ECI to ECEF
+      double ri[3] = { r(0), r(1), r(2) };
+      double rbf[3];
+      rotateToBodyFixed(E, ri, rbf);
 
-      }  // End 'for (int m = 1; m <= (desiredOrder + 2); m++) '
+      recursionVW(rbf, &V[0], &W[0]);
 
    }  // End of method 'SphericalHarmonicGravity::computeVW()'
 
@@ -139,64 +352,60 @@ namespace gpstk
        * @param E ECI to ECEF transformation matrix.
        * @return ECI acceleration in m/s^2.
        */
-   Vector<double> SphericalHarmonicGravity::gravity(Vector<double> r, Matrix<double> E)
+   Vector<double> SphericalHarmonicGravity::gravity(const Vector<double>& r,
+                                                    const Matrix<double>& E)
    {
-      // dimension should be checked here
-      // I'll do it latter...
       if((r.size()!=3) || (E.rows()!=3) || (E.cols()!=3))
       {
          Exception e("Wrong input for computeVW");
          GPSTK_THROW(e);
       }
 
-      Matrix<double> CS = gmData.unnormalizedCS;
+      prepareKernel();
 
-   
-      // Calculate accelerations ax,ay,az
-      double ax(0.0), ay(0.0), az(0.0);
+      // Body-fixed acceleration
+      double abf[3];
+      sumSeries(1, &V[0], &W[0], abf, NULL);
 
-      for (int m = 0; m <= desiredOrder; m++)
-      {
-         for (int n = m; n <= desiredDegree; n++)
-         {
-            if (m==0) 
-            {
-               double C = CS[n][0];               // = C_n,0
+      const double scale = gmData.GM / (gmData.refDistance * gmData.refDistance);
 
-               ax -=       C * V[n+1][1];
-               ay -=       C * W[n+1][1];
-               az -= (n+1)*C * V[n+1][0];
-            }
-            else 
-            {
-               double C = CS[n][m];   // = C_n,m
-               double S = CS[m-1][n]; // = S_n,m
-               double Fac = 0.5 * (n-m+1) * (n-m+2);
-               
-               ax += 0.5*(-C*V[n+1][m+1] - S*W[n+1][m+1]) + Fac*(C*V[n+1][m-1] + S*W[n+1][m-1]);
-               ay += 0.5*(-C*W[n+1][m+1] + S*V[n+1][m+1]) + Fac*(-C*W[n+1][m-1] + S*V[n+1][m-1]);
-               az += (n-m+1)*(-C*V[n+1][m] - S*W[n+1][m]);
-            }
+      // Inertial acceleration, E^T * a_bf
+      Vector<double> out(3, 0.0);
+      for(int i = 0; i < 3; i++)
+      {
+         out(i) = scale * (E(0,i)*abf[0] + E(1,i)*abf[1] + E(2,i)*abf[2]);
+      }
 
-         }  // End of 'for (int n = m; n <= (desiredDegree+1) ; n++)'
+      return out;
 
-      }  // End of 'for (int m = 0; m <= (desiredOrder+1); m++)'
+   }  // End of method 'SphericalHarmonicGravity::gravity'
 
-      // Body-fixed acceleration
-      Vector<double> a_bf(3,0.0);
-      a_bf(0) = ax;
-      a_bf(1) = ay;
-      a_bf(2) = az;
 
-      a_bf = a_bf * ( gmData.GM / (gmData.refDistance * gmData.refDistance) );
+      // E^T * G * E, scaled
+   static inline Matrix<double> rotateGradient(const Matrix<double>& E,
+                                               const double* g,
+                                               double scale)
+   {
+      double ge[9];
+      for(int i = 0; i < 3; i++)
+      {
+         for(int j = 0; j < 3; j++)
+         {
+            ge[3*i+j] = g[3*i]*E(0,j) + g[3*i+1]*E(1,j) + g[3*i+2]*E(2,j);
+         }
+      }
 
-      // Inertial acceleration
-      Matrix<double> Etrans = transpose(E);
-      Vector<double> out = Etrans * a_bf;            // this line may be wrong  matrix * vector
+      Matrix<double> out(3, 3, 0.0);
+      for(int i = 0; i < 3; i++)
+      {
+         for(int j = 0; j < 3; j++)
+         {
+            out(i,j) = scale * (E(0,i)*ge[j] + E(1,i)*ge[3+j] + E(2,i)*ge[6+j]);
+         }
+      }
 
       return out;
-
-   }  // End of method 'SphericalHarmonicGravity::gravity'
+   }
 
 
       /* Computes the partial derivative of gravity with respect to position.
@@ -204,103 +413,96 @@ namespace gpstk
        * @param r ECI position vector.
        * @param E ECI to ECEF transformation matrix.
        */
-   Matrix<double> SphericalHarmonicGravity::gravityGradient(gpstk::Vector<double> r, gpstk::Matrix<double> E)
+   Matrix<double> SphericalHarmonicGravity::gravityGradient(
+                                                   const Vector<double>& r,
+                                                   const Matrix<double>& E)
    {
-      // dimension should be checked here
-      // I'll do it latter...
       if((r.size()!=3) || (E.rows()!=3) || (E.cols()!=3))
       {
          Exception e("Wrong input for gravityGradient");
          GPSTK_THROW(e);
       }
 
-      Matrix<double> CS = gmData.unnormalizedCS;
+      prepareKernel();
 
-   
-      double xx = 0.0;     
-      double xy = 0.0;
-      double xz = 0.0;
-      double yy = 0.0;
-      double yz = 0.0;
-      double zz = 0.0;
+      double abf[3], gbf[9];
+      sumSeries(1, &V[0], &W[0], abf, gbf);
+
+      const double R_ref = gmData.refDistance;
+
+      // Rotate to ECI
+      return rotateGradient(E, gbf, gmData.GM / (R_ref * R_ref * R_ref));
+
+   }  // End of 'SphericalHarmonicGravity::gravityGradient()'
 
-      Matrix<double> out(3, 3, 0.0);
 
-      for (int m = 0; m <= desiredOrder; m++) 
+      /* Computes the acceleration and its partial derivative with respect
+       * to position at several positions, for the same ECI to ECEF
+       * transformation.
+       */
+   void SphericalHarmonicGravity::gravityBatch(
+                                 const std::vector< Vector<double> >& r,
+                                 const Matrix<double>& E,
+                                 std::vector< Vector<double> >& a,
+                                 std::vector< Matrix<double> >& da_dr,
+                                 bool gradient)
+   {
+      if((E.rows()!=3) || (E.cols()!=3))
       {
-         for (int n = m; n <= desiredDegree; n++) 
-         {
-            double Fac = (n-m+2)*(n-m+1);
-            
-            double C = CS[n][m];
-            double S = (m==0) ? 0.0 : CS[m-1][n];   // yan changed
-            //S = (m==0)?Sn0(n):CS[m-1][n];   // yan changed
+         Exception e("Wrong input for gravityBatch");
+         GPSTK_THROW(e);
+      }
 
-            zz += Fac*(C*V[n+2][m] + S*W[n+2][m]);
+      prepareKernel();
 
-            if (m==0) 
-            {
-               C = CS[n][0];   // = C_n,0
-
-               Fac = (n+2)*(n+1);
-               xx += 0.5 * (C*V[n+2][2] - Fac*C*V[n+2][0]);
-               xy += 0.5 * C * W[n+2][2];
-               
-               Fac = n + 1;
-               xz += Fac * C * V[n+2][1];
-               yz += Fac * C * W[n+2][1];
-            }
-            if (m > 0)
-            {
-               C = CS[n][m];
-               S = CS[m-1][n];
-               
-               double f1 = 0.5*(n-m+1);
-               double f2 = (n-m+3)*(n-m+2)*f1;
-
-               xz += f1*(C*V[n+2][m+1]+S*W[n+2][m+1])-f2*(C*V[n+2][m-1]+S*W[n+2][m-1]);
-               yz += f1*(C*W[n+2][m+1]-S*V[n+2][m+1])+f2*(C*W[n+2][m-1]-S*V[n+2][m-1]);         //* bug in JAT, I fix it
-          
-               if (m == 1)
-               {
-                  Fac = (n+1)*n;
-                  xx += 0.25*(C*V[n+2][3]+S*W[n+2][3]-Fac*(3.0*C*V[n+2][1]+S*W[n+2][1]));
-                  xy += 0.25*(C*W[n+2][3]-S*V[n+2][3]-Fac*(C*W[n+2][1]+S*V[n+2][1]));
-               }
-               if (m > 1) 
-               {
-                  f1 = 2.0*(n-m+2)*(n-m+1);
-                  f2 = (n-m+4)*(n-m+3)*f1*0.5;
-                  xx += 0.25*(C*V[n+2][m+2]+S*W[n+2][m+2]-f1*(C*V[n+2][m]+S*W[n+2][m])+f2*(C*V[n+2][m-2]+S*W[n+2][m-2]));
-
-                  xy += 0.25*(C*W[n+2][m+2]-S*V[n+2][m+2]+f2*(-C*W[n+2][m-2]+S*V[n+2][m-2]));
-               }
-            }
+      const int count = r.size();
+      a.resize(count);
+      da_dr.resize(gradient ? count : 0);
+      if(count == 0) return;
+
+      batchV.resize(count * kernelSize);
+      batchW.resize(count * kernelSize);
+      batchA.resize(3 * count);
+      batchG.resize(9 * count);
+
+      for(int k = 0; k < count; k++)
+      {
+         if(r[k].size() != 3)
+         {
+            Exception e("Wrong input for gravityBatch");
+            GPSTK_THROW(e);
          }
-         yy = -xx - zz;
-         
-         out(0,0) = xx;
-         out(0,1) = xy;
-         out(0,2) = xz;
-         out(1,0) = xy;
-         out(1,1) = yy;
-         out(1,2) = yz;
-         out(2,0) = xz;
-         out(2,1) = yz;
-         out(2,2) = zz;
-
-      }  // for (int m = 0; m <= desiredOrder; m++) 
+
+         double ri[3] = { r[k](0), r[k](1), r[k](2) };
+         double rbf[3];
+         rotateToBodyFixed(E, ri, rbf);
+
+         recursionVW(rbf, &batchV[k*kernelSize], &batchW[k*kernelSize]);
+      }
+
+      sumSeries(count, &batchV[0], &batchW[0], &batchA[0],
+                gradient ? &batchG[0] : NULL);
 
       const double R_ref = gmData.refDistance;
-      out = out * (gmData.GM / (R_ref * R_ref * R_ref));
+      const double scaleA = gmData.GM / (R_ref * R_ref);
+      const double scaleG = gmData.GM / (R_ref * R_ref * R_ref);
 
-      // Rotate to ECI
-      Matrix<double> Etrans = transpose(E);
-      out = Etrans*(out*E);
+      for(int k = 0; k < count; k++)
+      {
+         const double* abf = &batchA[3*k];
+         a[k].resize(3, 0.0);
+         for(int i = 0; i < 3; i++)
+         {
+            a[k](i) = scaleA * (E(0,i)*abf[0] + E(1,i)*abf[1] + E(2,i)*abf[2]);
+         }
 
-      return out;         // the result should be checked
+         if(gradient)
+         {
+            da_dr[k] = rotateGradient(E, &batchG[9*k], scaleG);
+         }
+      }
 
-   }  // End of 'SphericalHarmonicGravity::gravityGradient()'
+   }  // End of method 'SphericalHarmonicGravity::gravityBatch()'
 
    
       
@@ -339,11 +541,21 @@ namespace gpstk
       // Evaluate harmonic functions
       computeVW(sc.R(), C2T);         // update VM
 
-      // a
-      a = gravity(sc.R(), C2T);
+      // a and da_dr, in one pass over the coefficients
+      double abf[3], gbf[9];
+      sumSeries(1, &V[0], &W[0], abf, gbf);
+
+      const double R_ref = gmData.refDistance;
+      const double scale = gmData.GM / (R_ref * R_ref);
+
+      a.resize(3, 0.0);
+      for(int i = 0; i < 3; i++)
+      {
+         a(i) = scale * (C2T(0,i)*abf[0] + C2T(1,i)*abf[1] + C2T(2,i)*abf[2]);
+      }
       
       // da_dr
-      da_dr = gravityGradient(sc.R(), C2T);
+      da_dr = rotateGradient(C2T, gbf, scale / R_ref);
       
       //da_dv
       da_dv.resize(3,3,0.0);
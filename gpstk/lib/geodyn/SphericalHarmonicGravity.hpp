@@ -32,6 +32,7 @@
 //============================================================================
 
 
+#include <vector>
 #include "ForceModel.hpp"
 #include "EarthSolidTide.hpp"
 #include "EarthOceanTide.hpp"
@@ -47,6 +48,16 @@ namespace gpstk
 
       /** This class computes the body fixed acceleration due to the harmonic 
        *  gravity field of the central body
+       *
+       *  The harmonic functions V and W are kept in flat arrays, one row
+       *  per degree, and the coefficients of their recursion and the
+       *  unnormalized C and S coefficients are computed once for the
+       *  degree and order desired, in arrays of the same layout. The
+       *  recursion and the sums then run over the orders of one degree
+       *  in contiguous memory, which compilers vectorize. gravityBatch()
+       *  evaluates several positions at the same epoch (e.g. the stages
+       *  of an integration step, or several satellites) in one pass over
+       *  the coefficients.
        */
    class SphericalHarmonicGravity : public ForceModel
    {
@@ -72,7 +83,7 @@ namespace gpstk
           * @param E ECI to ECEF transformation matrix.
           * @return ECI acceleration in m/s^2.
           */
-      Vector<double> gravity(Vector<double> r, Matrix<double> E);
+      Vector<double> gravity(const Vector<double>& r, const Matrix<double>& E);
 
 
          /** Computes the partial derivative of gravity with respect to position.
@@ -80,7 +91,24 @@ namespace gpstk
           * @param r ECI position vector.
           * @param E ECI to ECEF transformation matrix.
           */
-      Matrix<double> gravityGradient(Vector<double> r, Matrix<double> E);
+      Matrix<double> gravityGradient(const Vector<double>& r, 
+                                     const Matrix<double>& E);
+
+
+         /** Computes the acceleration and its partial derivative with
+          *  respect to position at several positions, for the same
+          *  ECI to ECEF transformation. V and W are not changed.
+          * @param r ECI position vectors.
+          * @param E ECI to ECEF transformation matrix.
+          * @param a ECI accelerations in m/s^2, one per position.
+          * @param da_dr ECI gravity gradient matrices, one per position.
+          * @param gradient false to skip the gravity gradients.
+          */
+      void gravityBatch(const std::vector< Vector<double> >& r,
+                        const Matrix<double>& E,
+                        std::vector< Vector<double> >& a,
+                        std::vector< Matrix<double> >& da_dr,
+                        bool gradient = true);
       
 
          /** Call the relevant methods to compute the acceleration.
@@ -93,7 +121,7 @@ namespace gpstk
 
 
       SphericalHarmonicGravity& setDesiredDegree(const int& n, const int& m)
-      { desiredDegree = n; desiredOrder = m; return (*this); }
+      { desiredDegree = n; desiredOrder = m; kernelReady = false; return (*this); }
 
 
       /// Methods to enable earth tide correction
@@ -124,7 +152,28 @@ namespace gpstk
           * @param r ECI position vector.
           * @param E ECI to ECEF transformation matrix.
           */
-      void computeVW(Vector<double> r, Matrix<double> E);
+      void computeVW(const Vector<double>& r, const Matrix<double>& E);
+
+         /** Build the recursion coefficients and the C and S arrays for
+          *  the desired degree and order (at most those of the model),
+          *  and size V and W.
+          */
+      void prepareKernel();
+
+         /** Evaluates V and W at a body fixed position.
+          * @param rbf body fixed position [3].
+          * @param v, w harmonic functions, kernelSize values each.
+          */
+      void recursionVW(const double* rbf, double* v, double* w) const;
+
+         /** Sums the harmonic series for 'count' positions, with V and W
+          *  of position k at v + k*kernelSize and w + k*kernelSize.
+          * @param abf body fixed accelerations [3*count], unscaled.
+          * @param gbf body fixed gradients [9*count], unscaled; NULL to
+          *            skip them.
+          */
+      void sumSeries(int count, const double* v, const double* w,
+                     double* abf, double* gbf) const;
 
          /// Add tides to coefficients 
       void correctCSTides(UTCTime t,bool solidFlag = false, bool oceanFlag = false, bool poleFlag = false);
@@ -156,9 +205,25 @@ namespace gpstk
 
       } gmData;
 
-         /// V W  (nmax+3)*(nmax+3)
-         /// Harmonic function V and W
-      Matrix<double> V, W;
+         /// Harmonic function V and W, up to degree and order n+2 
+         /// (row n holds orders 0..n)
+      std::vector<double> V, W;
+
+         /// Degree and order used, and number of values of V (and W)
+      int kernelDegree, kernelOrder, kernelSize;
+
+         /// True when the arrays below match the desired degree and order
+      bool kernelReady;
+
+         /// Recursion coefficients (2n-1)/(n-m) and (n+m-1)/(n-m),
+         /// same layout as V
+      std::vector<double> recA, recB;
+
+         /// Unnormalized C and S coefficients, row n holds orders 0..n
+      std::vector<double> coefC, coefS;
+
+         /// Work space of gravityBatch()
+      std::vector<double> batchV, batchW, batchA, batchG;
 
          /// Degree and Order of gravity model desired.
       int desiredDegree, desiredOrder;
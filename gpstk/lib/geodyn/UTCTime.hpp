@@ -34,6 +34,7 @@
 #include "CommonTime.hpp"
 #include "YDSTime.hpp"
 #include "CivilTime.hpp"
+#include "MJD.hpp"
 #include "Epoch.hpp"
 #include "TimeSystem.hpp"
 namespace gpstk
@@ -65,21 +66,26 @@ namespace gpstk
    public:
 
          /// Default constructor
-      UTCTime(){TimeSystem(UTC);}
+      UTCTime(){setTimeSystem(TimeSystem::UTC);}
 
       UTCTime(CommonTime& utc) : CommonTime(utc)
-      {TimeSystem(UTC); }
+      {setTimeSystem(TimeSystem::UTC); }
 
       UTCTime(int year,int month,int day,int hour,int minute,double second)
-          {CivilTime(year, month, day, hour, minute, second);}
-      
+         : CommonTime(CivilTime(year, month, day, hour, minute, second,
+                                TimeSystem::UTC).convertToCommonTime())
+      {}
+
 
       UTCTime(int year,int doy,double sod)
-          {YDSTime(year, doy, sod);}
-      
+         : CommonTime(YDSTime(year, doy, sod,
+                              TimeSystem::UTC).convertToCommonTime())
+      {}
+
 
       UTCTime(double mjdUTC)
-         {set(mjdUTC, 0,TimeSystem::UTC);}
+         : CommonTime(MJD(mjdUTC, TimeSystem::UTC).convertToCommonTime())
+      {}
            
 
          /// Default deconstructor
@@ -161,6 +161,7 @@ void GDCconfiguration::initialize(void)
 {
 try {
    p_oflog = &cout;
+   GDCUnique = 0;
 
    // use cfg(DT) NOT dt -  dt is part of SatPass...
    setcfg(DT, -1, "nominal timestep of data (seconds) [required - no default!]");
@@ -474,21 +475,23 @@ private:
    /// keep count of various results: slips, deletions, etc.; print to log in finish()
    map<string,int> learn;
 
+   /// obs types of the data arrays: L1,L2,C1/P1,P2,A1,A2 (cf. obstypeenum)
+   vector<string> DCobstypes;
+
+   /// unique number for each (WL,GF) fix, in the log file
+   int GDCUniqueFix;
+
 }; // end class GDCPass
 
 //------------------------------------------------------------------------------------
 // local data
 //------------------------------------------------------------------------------------
-// these are used only to associate a unique number in the log file with each pass
-int GDCUnique=0;     // unique number for each call
-int GDCUniqueFix;    // unique for each (WL,GF) fix
-
 // conveniences only...
 #define log *(p_oflog)
 #define cfg(a) cfg_func(#a)
 // gcc doesn't like const enum...
+// indexes into both data and GDCPass::DCobstypes
 enum obstypeenum {  L1=0, L2=1, P1=2, P2=3, A1=4, A2=5 };   // P1 will <=> C1 or P1
-vector<string> DCobstypes;       // above are indexes into both data and this vector
 
 // constants used in linear combinations
 const double CFF=C_MPS/OSC_FREQ_GPS;
@@ -600,11 +603,13 @@ int gpstk::DiscontinuityCorrector(SatPass& svp,
 {
 try {
    int i,j,iret;
-   GDCUnique++;
+   // the number of this call, in the log file; kept in the configuration, so that
+   // calls on other threads, with other configurations, do not share it
+   gdc.setUnique(gdc.getUnique()+1);
 
    // --------------------------------------------------------------------------------
    // require obstypes L1,L2,C1/P1,P2, and add two auxiliary arrays
-   DCobstypes.clear();
+   vector<string> DCobstypes;
    DCobstypes.push_back("L1");
    DCobstypes.push_back("L2");
    DCobstypes.push_back((int(gdc.getParameter("useCA"))) == 0 ? "P1" : "C1");
@@ -714,6 +719,8 @@ GDCPass::GDCPass(SatPass& sp, const GDCconfiguration& gdc)
    }
 
    *((GDCconfiguration*)this) = gdc;
+   DCobstypes = ot;
+   GDCUniqueFix = 0;
 
    learn.clear();
 }
@@ -75,6 +75,13 @@ namespace gpstk {
          /// Tell GDCconfiguration to which stream to send debugging output.
       void setDebugStream(std::ostream& os) { p_oflog = &os; }
 
+         /// Get and set the number of the last call to the GDC with this
+         /// configuration. Each call increments it, and labels its debugging
+         /// output with it; a copy of the configuration goes on counting from
+         /// the value it was copied with.
+      int getUnique(void) const throw() { return GDCUnique; }
+      void setUnique(int n) throw() { GDCUnique = n; }
+
          /// Print help page, including descriptions and current values of all
          /// the parameters, to the ostream. If 'advanced' is true, also print
          /// advanced parameters.
@@ -95,6 +102,9 @@ namespace gpstk {
          /// Stream on which to write debug output.
       std::ostream *p_oflog;
 
+         /// Number of the last call to the GDC with this configuration
+      int GDCUnique;
+
       void initialize(void);
 
       static std::string GDCVersion;
@@ -337,8 +337,8 @@ int Robust::RobustPolyFit(double *xd, const double *td, int nd,
          ResCopy = Res = D - P*Coeff;
 #endif
 
-         // compute median and MAD. NB Median() will sort the vector...
-         mad = MedianAbsoluteDeviation(&(ResCopy[0]),ResCopy.size(),median);
+         // compute median and MAD. NB ResCopy is trashed
+         mad = MedianAbsoluteDeviation(&(ResCopy[0]),ResCopy.size(),median,false);
 
          // recompute weights
          Vector<double> OldWts(Wts);
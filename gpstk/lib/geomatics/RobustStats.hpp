@@ -39,6 +39,10 @@
 // system includes
 #include <cmath>
 #include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <algorithm>
 
 // GPSTk
 #include "Exception.hpp"
@@ -226,7 +230,20 @@ namespace gpstk {
          }
       }
    }  // end QSort
-   
+
+   /// Partial sort by selection (std::nth_element), in O(na) on average:
+   /// on output sa[k] is the element that would be there if sa were sorted in
+   /// ascending order, no element before it is larger and none after it smaller.
+   /// operator<() must be defined for T.
+   /// @param sa is the array of type T to be reordered.
+   /// @param na length of the array.
+   /// @param k index of the element to be put in place, 0 <= k < na.
+   template <typename T>
+   void QSelect(T *sa, int na, int k)
+   {
+      std::nth_element(sa, sa+k, sa+na);
+   }  // end QSelect
+
    /// Approximation to complimentary error function with fractional
    /// error everywhere less than 1.2e-7. Ref. Numerical Recipes part 6.2.
    /// NB. error function erf = 1-erfc
@@ -276,8 +293,82 @@ namespace gpstk {
    /// Robust statistics.
    namespace Robust
    {
+   /// Compute median of an array of length nd, by selection rather than sorting,
+   /// in O(nd); the array xd is reordered (but not sorted). Same value as Median().
+   /// @param xd         array of data (reordered on output).
+   /// @param nd         length of array xd.
+   /// @return median of the data in array xd.
+   template <typename T>
+   T SelectMedian(T *xd, const int nd)
+      throw(Exception)
+   {
+      if(!xd || nd < 2) {
+         Exception e("Invalid input");
+         GPSTK_THROW(e);
+      }
+
+      int k=(nd%2 ? (nd+1)/2-1 : nd/2);
+      QSelect(xd,nd,k);
+      if(nd%2) return xd[k];
+
+         // the other middle element is the largest one below k
+      return (*std::max_element(xd,xd+k)+xd[k])/T(2);
+
+   }  // end SelectMedian
+
+   /// Compute the quartiles Q1 and Q3 of an array of length nd, by selection
+   /// rather than sorting, in O(nd); the array need not be sorted, and is
+   /// reordered. Same values as Quartiles() on the sorted array.
+   /// @param xd array of data (reordered on output).
+   /// @param nd length of array xd.
+   /// @param Q1 (output) first quartile of data in array xd.
+   /// @param Q3 (output) third quartile of data in array xd.
+   template <typename T>
+   void SelectQuartiles(T *xd, const int nd, T& Q1, T& Q3)
+      throw(Exception)
+   {
+      if(!xd || nd < 2) {
+         Exception e("Invalid input");
+         GPSTK_THROW(e);
+      }
+
+      int q;
+      if(nd % 2) q = (nd+1)/2;
+      else       q = nd/2;
+
+         // elements i and nd-1-i of the sorted array, and, if q is even,
+         // the ones next to them towards the middle
+      int i = (q % 2 ? (q+1)/2-1 : q/2-1);
+      QSelect(xd,nd,i);
+      QSelect(xd+i+1,nd-i-1,nd-2*i-2);
+      Q1 = xd[i];
+      Q3 = xd[nd-1-i];
+      if(q % 2 == 0) {
+         Q1 = (Q1 + *std::min_element(xd+i+1,xd+nd-1-i))/T(2);
+         Q3 = (Q3 + *std::max_element(xd+i+1,xd+nd-1-i))/T(2);
+      }
+   }  // end SelectQuartiles
+
+   /// Compute the median absolute deviation of an array of length nd, as well
+   /// as the median M, by selection rather than sorting, in O(nd); the array xd
+   /// is trashed. Same values as MedianAbsoluteDeviation().
+   /// @param xd array of data (trashed on output).
+   /// @param nd length of array xd.
+   /// @param M median of data in array xd (output).
+   /// @return median absolute deviation of data in array xd.
+   template <typename T>
+   T SelectMAD(T *xd, int nd, T& M)
+      throw(Exception)
+   {
+      M = SelectMedian(xd, nd);
+      for(int i=0; i<nd; i++) xd[i] = ABSOLUTE(xd[i]-M);
+      return (SelectMedian(xd, nd) / T(RobustTuningE));
+   }  // end SelectMAD
+
    /// Compute median of an array of length nd;
    /// array xd is returned sorted, unless save_flag is true.
+   /// If save_flag is true the median is found by selection (cf. SelectMedian()),
+   /// in a copy of the data, in O(nd) rather than O(nd log nd).
    /// @param xd         array of data.
    /// @param nd         length of array xd.
    /// @param save_flag  if true (default) array xd will NOT be changed, otherwise
@@ -293,16 +384,12 @@ namespace gpstk {
       }
 
       try {
-         int i;
-         T med, *save;
+         T med;
 
+            // select in a temporary; the data is not changed
          if(save_flag) {
-            save = new T[nd];
-            if(!save) {
-               Exception e("Could not allocate temporary array");
-               GPSTK_THROW(e);
-            }
-            for(i=0; i<nd; i++) save[i]=xd[i];
+            std::vector<T> work(xd, xd+nd);
+            return SelectMedian(&work[0], nd);
          }
 
          QSort(xd,nd);
@@ -312,12 +399,6 @@ namespace gpstk {
          else
             med = (xd[nd/2-1]+xd[nd/2])/T(2);
 
-            // restore original data from temporary
-         if(save_flag) {
-            for(i=0; i<nd; i++) xd[i]=save[i];
-            delete[] save;
-         }
-
          return med;
       }
       catch(Exception& e) { GPSTK_RETHROW(e); }
@@ -356,7 +437,7 @@ namespace gpstk {
    }  // end Quartiles
 
    /// Compute the median absolute deviation of a double array of length nd,
-   /// as well as the median (M = Median(xd,nd));
+   /// as well as the median (M = Median(xd,nd)), by selection (cf. SelectMAD());
    /// NB this routine will trash the array xd unless save_flag is true (default).
    /// @param xd array of data (input).
    /// @param nd length of array xd (input).
@@ -367,43 +448,18 @@ namespace gpstk {
    T MedianAbsoluteDeviation(T *xd, int nd, T& M, bool save_flag=true)
       throw(Exception)
    {
-      int i;
-      T mad, *save;
-
       if(!xd || nd < 2) {
          Exception e("Invalid input");
          GPSTK_THROW(e);
       }
 
-         // store data in a temporary array
+         // work in a temporary array
       if(save_flag) {
-         save = new T[nd];
-         if(!save) {
-            Exception e("Could not allocate temporary array");
-            GPSTK_THROW(e);
-         }
-         for(i=0; i<nd; i++) save[i]=xd[i];
-      }
-
-         // get the median (don't care if xd gets sorted...)
-      M = Median(xd, nd, false);
-
-         // compute xd=abs(xd-M)
-      for(i=0; i<nd; i++) xd[i] = ABSOLUTE(xd[i]-M);
-
-         // sort xd in ascending order
-      QSort(xd, nd);
-
-         // find median and normalize to get mad
-      mad = Median(xd, nd, false) / T(RobustTuningE);
-
-         // restore original data from temporary
-      if(save_flag) {
-         for(i=0; i<nd; i++) xd[i]=save[i];
-         delete[] save;
+         std::vector<T> work(xd, xd+nd);
+         return SelectMAD(&work[0], nd, M);
       }
 
-      return mad;
+      return SelectMAD(xd, nd, M);
 
    }  // end MedianAbsoluteDeviation
 
@@ -466,6 +522,201 @@ namespace gpstk {
 
    }  // end MEstimate
 
+   /// Median of the last N values of a series, updated as each value is added,
+   /// for editors working in a sliding window. The values in the window are kept
+   /// in two halves (multisets), the lower half holding the extra value when the
+   /// count is odd, so adding a value costs O(log N) rather than the O(N log N)
+   /// of sorting the window again. The median is that of Median() on the window.
+   /// @code
+   ///    Robust::SlidingMedian<double> sm(31);
+   ///    for(i=0; i<nd; i++) {
+   ///       sm.add(xd[i]);
+   ///       if(sm.full()) med[i-15] = sm.median();   // window centered on i-15
+   ///    }
+   /// @endcode
+   template <typename T>
+   class SlidingMedian
+   {
+   public:
+      /// Constructor.
+      /// @param N width of the window; at least 1.
+      explicit SlidingMedian(int N) throw(Exception)
+         : width(N)
+      {
+         if(N < 1) {
+            Exception e("Invalid window width");
+            GPSTK_THROW(e);
+         }
+      }
+
+      /// Add a value to the window, dropping the oldest one if it is full.
+      void add(const T& x) throw()
+      {
+         if(int(window.size()) == width) {
+            T old(window.front());
+            window.pop_front();
+            typename std::multiset<T>::iterator it = lower.find(old);
+            if(it != lower.end()) lower.erase(it);
+            else upper.erase(upper.find(old));
+         }
+         window.push_back(x);
+         if(lower.empty() || !(*lower.rbegin() < x)) lower.insert(x);
+         else upper.insert(x);
+
+            // rebalance so that lower has the same count as upper, or one more
+         if(lower.size() > upper.size()+1) {
+            typename std::multiset<T>::iterator it = lower.end();
+            --it;
+            upper.insert(*it);
+            lower.erase(it);
+         }
+         else if(upper.size() > lower.size()) {
+            lower.insert(*upper.begin());
+            upper.erase(upper.begin());
+         }
+      }
+
+      /// Median of the values in the window.
+      /// @throw Exception if the window is empty.
+      T median() const throw(Exception)
+      {
+         if(lower.empty()) {
+            Exception e("No data in window");
+            GPSTK_THROW(e);
+         }
+         if(lower.size() > upper.size()) return *lower.rbegin();
+         return (*lower.rbegin() + *upper.begin())/T(2);
+      }
+
+      /// Number of values in the window.
+      int size() const throw() { return window.size(); }
+
+      /// True when the window holds N values.
+      bool full() const throw() { return (int(window.size()) == width); }
+
+      /// Empty the window.
+      void reset() throw() { window.clear(); lower.clear(); upper.clear(); }
+
+   private:
+      int width;                 ///< width N of the window
+      std::deque<T> window;      ///< values in the window, oldest first
+      std::multiset<T> lower;    ///< lower half of the values in the window
+      std::multiset<T> upper;    ///< upper half of the values in the window
+   };
+
+   /// Weighted, iteratively reweighted M-estimate of location, with either the
+   /// Huber weight function (as MEstimate()) or the Tukey bisquare. The median
+   /// and MAD that start and scale the iteration are computed by selection, and
+   /// the work arrays are kept by the object between calls, so that editing loops
+   /// calling it on many series of similar length do not allocate memory.
+   /// @code
+   ///    Robust::MEstimator<double> est(Robust::MEstimator<double>::Bisquare);
+   ///    for(k=0; k<nseries; k++) {
+   ///       mest = est.estimate(&res[k][0], res[k].size(), NULL, &wts[k][0]);
+   ///       mad = est.getMAD();
+   ///    }
+   /// @endcode
+   template <typename T>
+   class MEstimator
+   {
+   public:
+      /// Weight functions
+      enum WeightFunction
+      {
+         Huber,      ///< w = 1 for |r| <= c, c/|r| beyond
+         Bisquare    ///< w = (1-(r/c)^2)^2 for |r| < c, 0 beyond
+      };
+
+      /// Constructor.
+      /// @param wf weight function.
+      /// @param c tuning constant, in units of MAD; 0 for the default, which is
+      ///          RobustTuningT for Huber and 4.685 for Bisquare.
+      /// @param N maximum number of iterations.
+      /// @param tol convergence limit on the relative change of the estimate.
+      MEstimator(WeightFunction wf=Huber, T c=T(0), int N=10, T tol=T(0.000001))
+         throw()
+         : func(wf), tuning(c), maxIter(N), tolerance(tol),
+           med(T(0)), mad(T(0)), niter(0)
+      {
+         if(tuning <= T(0))
+            tuning = (func == Huber ? T(RobustTuningT) : T(4.685));
+      }
+
+      /// Compute the M-estimate of the data.
+      /// @param xd input array of data.
+      /// @param nd input length of array xd.
+      /// @param wd (optional) input array of length nd of a priori weights; the
+      ///           weight of each point is the product of this and the robust one.
+      /// @param w (optional) output array of length nd to contain the robust
+      ///          weights (not multiplied by wd).
+      /// @return M-estimate of data in array xd; with no a priori weights and the
+      ///         Huber function this is MEstimate(xd,nd,M,MAD,w).
+      T estimate(const T *xd, int nd, const T *wd=NULL, T *w=NULL)
+         throw(Exception)
+      {
+         if(!xd || nd < 2) {
+            Exception e("Invalid input");
+            GPSTK_THROW(e);
+         }
+
+         int i;
+         work.assign(xd, xd+nd);
+         mad = SelectMAD(&work[0], nd, med);
+         if(w == NULL) {
+            wts.resize(nd);
+            w = &wts[0];
+         }
+
+         const T tv(tuning*mad);
+         T m(med), mold, sum, sumw, r;
+         niter = 0;
+         do {
+            mold = m;
+            niter++;
+            sum = sumw = T();
+            for(i=0; i<nd; i++) {
+               r = xd[i]-m;
+               if(func == Huber) {
+                  w[i] = T(1);
+                  if(xd[i] < m-tv)      w[i] = -tv/r;
+                  else if(xd[i] > m+tv) w[i] =  tv/r;
+               }
+               else {
+                  if(ABSOLUTE(r) >= tv) w[i] = T(0);
+                  else { r /= tv; r = T(1)-r*r; w[i] = r*r; }
+               }
+               r = (wd ? wd[i]*w[i] : w[i]);
+               sumw += r;
+               sum += r*xd[i];
+            }
+            if(sumw == T(0)) break;          // all weights zero, e.g. MAD is zero
+            m = sum / sumw;
+
+         } while(T(ABSOLUTE((m-mold)/m)) > tolerance && niter < maxIter);
+
+         return m;
+      }
+
+      /// Median of the data in the last call to estimate().
+      T getMedian() const throw() { return med; }
+
+      /// Median absolute deviation of the data in the last call to estimate().
+      T getMAD() const throw() { return mad; }
+
+      /// Number of iterations in the last call to estimate().
+      int getIterations() const throw() { return niter; }
+
+   private:
+      WeightFunction func;       ///< weight function
+      T tuning;                  ///< tuning constant, in units of MAD
+      int maxIter;               ///< maximum number of iterations
+      T tolerance;               ///< convergence limit
+      T med, mad;                ///< median and MAD of the last data
+      int niter;                 ///< number of iterations in the last call
+      std::vector<T> work;       ///< work array for median and MAD
+      std::vector<T> wts;        ///< weights, when not output
+   };
+
    /// Fit a polynomial of degree n to data xd, with independent variable td,
    /// using robust techniques. The post-fit residuals are returned in the data
    /// vector, and the computed weights in the result may be output as well.
@@ -58,6 +58,7 @@
 #include "logstream.hpp"
 // GPSTk
 #include "StringUtils.hpp"
+#include "ThreadPool.hpp"
 
 using namespace std;
 
@@ -399,6 +400,20 @@ using namespace StringUtils;
       throw(MatrixException,VectorException)
    {
       try {
+            // nothing here yet: take S as it is
+         if(names.size() == 0 && R.rows() == 0) {
+            *this = S;
+            return *this;
+         }
+
+            // same state, in the same order: merge the triangular R's directly
+         if(identical(names,S.names) && R.rows() == S.R.rows()) {
+            Matrix<double> SR(S.R);
+            Vector<double> SZ(S.Z);
+            SrifMerge(R,Z,SR,SZ);
+            return *this;
+         }
+
          Namelist all(names);
          all |= S.names;      // assumes Namelist::op|= adds unique S.names to _end_
 
@@ -458,6 +473,77 @@ using namespace StringUtils;
       }
    }
 
+   // --------------------------------------------------------------------------------
+   // Task merging one SRI into another, for treeMerge(); the exception, if any,
+   // is kept for treeMerge().
+   class SRIMergeTask : public ThreadPool::Task
+   {
+   public:
+      SRIMergeTask(SRI *l, SRI *r) : left(l), right(r), failed(false) {}
+
+      virtual void run() throw()
+      {
+         try { *left += *right; }
+         catch(Exception& e) { error = e; failed = true; }
+         catch(std::exception& e) { error = Exception(e.what()); failed = true; }
+         catch(...) { error = Exception("Unknown error"); failed = true; }
+      }
+
+      SRI *left;
+      SRI *right;
+      bool failed;
+      Exception error;
+   };
+
+   // --------------------------------------------------------------------------------
+   // merge a list of SRIs, pairwise, in a binary tree: at each level S[i] += S[i+d]
+   // for i = 0, 2d, 4d, ..., the merges of one level being independent.
+   SRI SRI::treeMerge(vector<SRI>& S, unsigned int nthreads)
+      throw(MatrixException,VectorException)
+   {
+      try {
+         if(S.size() == 0) return SRI();
+
+         if(nthreads == 0) nthreads = ThreadPool::processorCount();
+         ThreadPool *pool=NULL;
+         if(nthreads > 1 && S.size() > 2) {
+            try { pool = new ThreadPool(nthreads); }
+            catch(Exception& e) { pool = NULL; }      // merge in this thread
+         }
+
+         for(size_t d=1; d<S.size(); d*=2) {
+            vector<SRIMergeTask> tasks;
+            for(size_t i=0; i+d<S.size(); i+=2*d)
+               tasks.push_back(SRIMergeTask(&S[i],&S[i+d]));
+
+            for(size_t k=0; k<tasks.size(); k++) {
+               if(pool) pool->submit(&tasks[k]);
+               else tasks[k].run();
+            }
+            if(pool) pool->wait();
+
+            for(size_t k=0; k<tasks.size(); k++) {
+               if(tasks[k].failed) {
+                  delete pool;
+                  MatrixException me(tasks[k].error.what());
+                  me.addText("In SRI::treeMerge()");
+                  GPSTK_THROW(me);
+               }
+               *(tasks[k].right) = SRI();        // free it as soon as possible
+            }
+         }
+         delete pool;
+
+         return S[0];
+      }
+      catch(MatrixException& me) {
+         GPSTK_RETHROW(me);
+      }
+      catch(VectorException& ve) {
+         GPSTK_RETHROW(ve);
+      }
+   }
+
    // --------------------------------------------------------------------------------
    // merge two SRIs to produce a third. ? should this be operator&() ?
    SRI operator+(const SRI& Sleft,
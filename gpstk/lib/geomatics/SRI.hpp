@@ -57,6 +57,7 @@
 //------------------------------------------------------------------------------------
 // system includes
 #include <string>
+#include <vector>
 // GPSTk
 #include "Matrix.hpp"
 #include "StringUtils.hpp"
@@ -218,6 +219,8 @@ public:
       throw(MatrixException,VectorException);
 
       /// merge an SRI into this one. NB names may be reordered in the result.
+      /// If the Namelists are identical, the triangular R's are merged directly
+      /// (SrifMerge()), rather than the stacked SRIs being re-triangularized.
    void merge(const SRI& S)
       throw(MatrixException,VectorException)
    { *this += S; }
@@ -232,6 +235,21 @@ public:
                         const SRI&)
       throw(MatrixException,VectorException);
 
+      /// Merge a list of SRIs into one, as S[0]+S[1]+...+S[n-1], pairwise in a
+      /// binary tree: S[0]+=S[1], S[2]+=S[3], ... then S[0]+=S[2], S[4]+=S[6], ...
+      /// The merges at each level are independent, and are done in parallel on
+      /// nthreads threads. This is for large problems where the data is divided
+      /// into parts, each accumulated into its own SRI (e.g. on its own thread or
+      /// by its own process), to be combined at the end; only the parts and one
+      /// SRI per thread are held in memory. When the SRIs have the same Namelist,
+      /// each merge uses the triangular form of R (see SrifMerge()).
+      /// @param S the SRIs to be merged; trashed on output.
+      /// @param nthreads number of threads; 0 means one per processor.
+      /// @return the merged SRI; names are in the order of operator+=().
+   static SRI treeMerge(std::vector<SRI>& S,
+                        unsigned int nthreads=1)
+      throw(MatrixException,VectorException);
+
       /// append an SRI onto this SRI. Similar to opertor+= but simpler; input SRI is
       /// simply appended, first using operator+=(Namelist), then filling the new
       /// portions of R and Z, all without final Householder transformation of result.
@@ -22,6 +22,13 @@
 // ======================================================================
 
 //------------------------------------------------------------------------------------
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "CommonTime.hpp"
 #include "SolarSystem.hpp"
 #include "Matrix.hpp"            // only for WGS84Position()
@@ -48,6 +55,7 @@ try {
    }
 
    // clear existing data
+   unmapFile();
    constants.clear();
 
    // read the file one line at a time, process depending on the value of group
@@ -589,6 +597,72 @@ catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(
 catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 }
 
+//------------------------------------------------------------------------------------
+// return 0 ok, or
+// -3 the file could not be mapped, or holds no data record
+// -4 EphemerisNumber is not defined (the header was not read)
+int SolarSystem::initializeWithMappedFile(string filename) throw(Exception)
+{
+try {
+   // the header, read as for initializeWithBinaryFile(); the data follow it
+   readBinaryHeader(filename);
+   if(EphemerisNumber == -1) { istrm.close(); return -4; }
+   size_t dataOffset = size_t(istrm.tellg());
+   istrm.clear();
+   istrm.close();
+
+#ifndef _WIN32
+   int fd(::open(filename.c_str(), O_RDONLY));
+   if(fd < 0) return -3;
+   struct stat st;
+   if(::fstat(fd, &st) != 0) { ::close(fd); return -3; }
+   void *ptr(::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0));
+   ::close(fd);
+   if(ptr == MAP_FAILED) return -3;
+   mapBase = static_cast<const char *>(ptr);
+   mapLength = st.st_size;
+#else
+   ifstream ifs(filename.c_str(), ios::in | ios::binary);
+   if(!ifs) return -3;
+   ifs.seekg(0, ios::end);
+   mapLength = ifs.tellg();
+   ifs.seekg(0, ios::beg);
+   // allocate as doubles so that the records are 8-byte aligned
+   double *buffer = new double[(mapLength+7)/8];
+   ifs.read(reinterpret_cast<char *>(buffer), mapLength);
+   mapBase = reinterpret_cast<const char *>(buffer);
+   if(!ifs) { unmapFile(); return -3; }
+#endif
+
+   // records are Ncoeff doubles; an incomplete last record is ignored, as EOF is
+   // by readBinaryData()
+   size_t recSize = Ncoeff*sizeof(double);
+   if(Ncoeff < 2 || mapLength < dataOffset + recSize) { unmapFile(); return -3; }
+   records = reinterpret_cast<const double *>(mapBase + dataOffset);
+   Nrecords = long((mapLength - dataOffset) / recSize);
+
+   // check the records follow each other, with the test of readBinaryData()
+   for(long k=1; k<Nrecords; k++) {
+      double prev = records[(k-1)*Ncoeff+1];
+      if(records[k*Ncoeff] != prev) {
+         ostringstream oss;
+         oss << "ERROR: found gap in data at " << k+1 << fixed << setprecision(6)
+            << " : prev end = " << prev << " != new beg = " << records[k*Ncoeff];
+         unmapFile();
+         Exception e(oss.str());
+         GPSTK_THROW(e);
+      }
+   }
+
+   EphemerisNumber = int(constants["DENUM"]);
+
+   return 0;
+}
+catch(Exception& e) { GPSTK_RETHROW(e); }
+catch(exception& e) { Exception E("std except: "+string(e.what())); GPSTK_THROW(E); }
+catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
+}
+
 //------------------------------------------------------------------------------------
 // return 0 ok, or (from seekToJD)
 // -1 out of range : input time is before the first time in file
@@ -611,13 +685,21 @@ try {
    // trivial; return
    if(target == center) return 0;
 
-   // get the right record from the file
-   iret = seekToJD(tt);
-   if(iret) return iret;
+   // get the right record, from the mapped file or else from the stream
+   const double *coef;
+   if(records) {
+      iret = findMappedRecord(tt, coef);
+      if(iret) return iret;
+   }
+   else {
+      iret = seekToJD(tt);
+      if(iret) return iret;
+      coef = &coefficients[0];
+   }
 
    // compute Nutations or Librations
    if(target == Nutations || target == Librations) {
-      computeState(tt, target==Nutations ? NUTATIONS : LIBRATIONS, PV);
+      computeState(coef, tt, target==Nutations ? NUTATIONS : LIBRATIONS, PV);
       return 0;
    }
 
@@ -641,18 +723,18 @@ try {
 
    // special cases of Earth OR Moon, but not both:
    if((target == Earth && center != Moon) || (center == Earth && target != Moon)) {
-      Eratio = 1.0/(1.0 + constants["EMRAT"]);
-      computeState(tt, MOON, PVMOON);
+      Eratio = 1.0/(1.0 + EMratio);
+      computeState(coef, tt, MOON, PVMOON);
    }
    if((target == Moon && center != Earth) || (center == Moon && target != Earth)) {
-      Mratio = constants["EMRAT"]/(1.0 + constants["EMRAT"]);
-      computeState(tt, EMBARY, PVEMBARY);
+      Mratio = EMratio/(1.0 + EMratio);
+      computeState(coef, tt, EMBARY, PVEMBARY);
    }
 
    // compute states for target and center
    double PVTARGET[6],PVCENTER[6];
-   computeState(tt, TARGET, PVTARGET);
-   computeState(tt, CENTER, PVCENTER);
+   computeState(coef, tt, TARGET, PVTARGET);
+   computeState(coef, tt, CENTER, PVCENTER);
 
    // handle the Earth/Moon special cases
    // convert from E-M barycenter to Earth
@@ -670,8 +752,7 @@ try {
    for(i=0; i<6; i++) PV[i] = PVTARGET[i] - PVCENTER[i];
    
    if(!kilometers) {
-      double AU = constants["AU"];
-      for(i=0; i<6; i++) PV[i] /= AU;
+      for(i=0; i<6; i++) PV[i] /= AUkm;
    }
 
    return 0;
@@ -763,6 +844,7 @@ try {
    }
 
    // initialize
+   unmapFile();
    EphemerisNumber = -1;
    constants.clear();
    store.clear();
@@ -846,6 +928,10 @@ try {
    for(i=0; i < (400-Nconst)*sizeof(double); i++)
       readBinary(buffer,1);
 
+   // constants used by computeState()
+   EMratio = constants["EMRAT"];
+   AUkm = constants["AU"];
+
    // ----------------------------------------------------------------
    // test the header
    if(denum == constants["DENUM"]) {
@@ -996,8 +1082,49 @@ catch(...) { Exception e("Unknown exception"); GPSTK_THROW(e); }
 
 //------------------------------------------------------------------------------------
 // private
-void SolarSystem::computeState(double tt, SolarSystem::computeID which, double PV[6])
-   throw(Exception)
+// return 0 ok, or
+// -1 out of range : input time is before the first time in file
+// -2 out of range : input time is after the last time in file
+// -4 no file is mapped
+int SolarSystem::findMappedRecord(double JD, const double *& coef) const throw()
+{
+   if(!records) return -4;
+   if(!(JD >= records[0])) return -1;
+
+   // the record is found from its index; rounding can put the time at the very
+   // end of the previous record, or the start of the next one
+   long k = (interval > 0.0 ? long((JD - records[0]) / interval) : 0);
+   if(k >= Nrecords) k = Nrecords-1;
+   coef = records + k*Ncoeff;
+   while(k > 0 && JD < coef[0]) { k--; coef -= Ncoeff; }
+   while(k < Nrecords-1 && JD > coef[1]) { k++; coef += Ncoeff; }
+
+   if(JD > coef[1]) return -2;
+   return 0;
+}
+
+//------------------------------------------------------------------------------------
+// private
+void SolarSystem::unmapFile(void) throw()
+{
+   if(mapBase) {
+#ifndef _WIN32
+      ::munmap(const_cast<char *>(mapBase), mapLength);
+#else
+      delete [] reinterpret_cast<const double *>(mapBase);
+#endif
+   }
+   mapBase = 0;
+   mapLength = 0;
+   records = 0;
+   Nrecords = 0;
+}
+
+//------------------------------------------------------------------------------------
+// private
+void SolarSystem::computeState(const double *coef, double tt,
+                               SolarSystem::computeID which, double PV[6])
+   const throw(Exception)
 {
 try {
    int i,j,i0,ncomp,offset;
@@ -1006,8 +1133,8 @@ try {
    if(which == NONE) return;
 
    double T,Tbeg,Tspan,Tspan0;
-   Tbeg = coefficients[0];
-   Tspan0 = Tspan = coefficients[1] - coefficients[0];
+   Tbeg = coef[0];
+   Tspan0 = Tspan = coef[1] - coef[0];
    i0 = c_offset[which]-1;                      // index of first coefficient in array
    ncomp = (which == NUTATIONS ? 2 : 3);        // number of components returned
 
@@ -1015,7 +1142,7 @@ try {
    if(c_nsets[which] > 1) {
       Tspan /= double(c_nsets[which]);
       for(j=c_nsets[which]; j>0; j--) {
-         Tbeg = coefficients[0] + double(j-1)*Tspan;
+         Tbeg = coef[0] + double(j-1)*Tspan;
          if(tt > Tbeg) {                      // == with j==1 is the default
             i0 += (j-1)*ncomp*c_ncoeff[which];
             break;
@@ -1045,9 +1172,9 @@ try {
       // compute P and V
       // done above PV[i] = PV[i+3] = 0.0;
       for(j=N-1; j>-1; j--)                              // POS
-         PV[i] += coefficients[i0+j+i*N] * C[j];
+         PV[i] += coef[i0+j+i*N] * C[j];
       for(j=N-1; j>0; j--) // j>0 b/c U[0]=0             // VEL
-         PV[i+ncomp] += coefficients[i0+j+i*N] * U[j];
+         PV[i+ncomp] += coef[i0+j+i*N] * U[j];
 
       // convert velocity to 'per day'
       PV[i+ncomp] *= 2*double(c_nsets[which])/Tspan0;
@@ -65,6 +65,10 @@ namespace gpstk {
 /// instantiates a SolarSystem object, calls initializeWithBinaryFile(file) once,
 /// passing it the name of the binary file, then calling computeState() any number
 /// of times, passing it the time and Planet of interest.
+/// Alternatively, initializeWithMappedFile(file) maps the whole binary file into
+/// memory; computeState() then finds the record of any time directly, reads the
+/// coefficients from the mapped pages and changes nothing in the object, so that
+/// one object may be used by any number of threads at the same time.
 class SolarSystem{
 public:
    /// These are indexes used by the caller of computeState().
@@ -90,7 +94,12 @@ public:
 
    /// Constructor. Set EphemerisNumber to -1 to indicate that nothing has been
    /// read yet.
-   SolarSystem(void) throw() : EphemerisNumber(-1) {};
+   SolarSystem(void) throw()
+      : EphemerisNumber(-1), EMratio(0.0), AUkm(0.0),
+        mapBase(0), mapLength(0), records(0), Nrecords(0) {};
+
+   /// Destructor; unmaps the file mapped by initializeWithMappedFile().
+   ~SolarSystem(void) throw() { unmapFile(); }
 
    /// Read the header from a JPL ASCII planetary ephemeris file. Note that this
    /// routine clears the 'store' map and defines the 'constants' hash. It also
@@ -171,6 +180,24 @@ public:
    /// @throw if a gap in time is found between consecutive records.
    int initializeWithBinaryFile(std::string filename) throw(gpstk::Exception);
 
+   /// Map the given binary file into memory (read it, on systems without mmap),
+   /// read the header and check the data records, for use by computeState().
+   /// Records are found by their index, (JD-start)/interval, rather than through
+   /// the file position map, and are never copied; once this has returned, the
+   /// object is not modified by computeState() and may be shared between threads.
+   /// @param filename  name of binary file to be mapped.
+   /// @return 0 success,
+   ///        -3 the file could not be mapped, or holds no data record
+   ///        -4 header has not been read.
+   /// @throw if the file cannot be opened or the header cannot be read.
+   /// @throw if a gap in time is found between consecutive records.
+   int initializeWithMappedFile(std::string filename) throw(gpstk::Exception);
+
+   /// @return true if the data are those of initializeWithMappedFile(), so that
+   /// computeState() may be called concurrently.
+   bool isMapped(void) const throw()
+   { return (records != 0); }
+
    /// Compute position and velocity of given 'target' body, relative to the 'center'
    /// body, at the given time. On successful return, PV contains position
    /// (in components 0-2) and velocity (components 3-5) (units: see param km) for
@@ -200,6 +227,7 @@ public:
    ///        -3 input stream is not open or not valid, or EOF was found prematurely,
    ///        -4 ephemeris is not initialized
    /// -3 or -4 => initializeWithBinaryFile() has not been called, or reading failed.
+   /// After initializeWithMappedFile(), this does not modify the object.
    int computeState(double tt,
                               Planet target,
                               Planet center,
@@ -313,19 +341,34 @@ private:
    /// -3 or -4 => initializeWithBinaryFile() has not been called, or reading failed.
    int seekToJD(double JD) throw(gpstk::Exception);
 
-   /// Compute position and velocity of given body at given time, using the current
-   /// coefficient array. NB caller MUST call seekToJD(time) BEFORE calling this.
+   /// Find the mapped record whose time limits include the given time. May be
+   /// called only after initializeWithMappedFile(); does not modify the object.
+   /// @param JD the time (Julian Date) of interest
+   /// @param coef on success, the first value of the record
+   /// @return 0 success, or
+   ///        -1 given time is before the first record in the file,
+   ///        -2 given time is after the last record,
+   ///        -4 no file is mapped
+   int findMappedRecord(double JD, const double *& coef) const throw();
+
+   /// Release the file mapped by initializeWithMappedFile(), if any.
+   void unmapFile(void) throw();
+
+   /// Compute position and velocity of given body at given time, using the given
+   /// record (the coefficient array of seekToJD() or the mapped record of
+   /// findMappedRecord()), which must include the time.
    /// On successful return, PV[0-2] contains the three position components, in km,
    /// and PV[3-5] the velocity components in km/day (for regular bodies), relative
    /// to the solar system barycenter, except for the moon, which is relative to
    /// Earth. For nutations and librations the units are radians and radians/day;
    /// nutations (components 0-3 only) are longitude and obliquity, and librations
    /// are the three euler angles.
+   /// @param  coef   the record: start and end times, then the coefficients.
    /// @param  tt     Time (Julian Date) of interest.
    /// @param  which  computeID of the body of interest.
    /// @param  PV     double(6) array containing the output position and velocity.
-   void computeState(double tt, computeID which, double PV[6])
-      throw(gpstk::Exception);
+   void computeState(const double *coef, double tt, computeID which, double PV[6])
+      const throw(gpstk::Exception);
 
    // member data ---------------------------------------------------------
 
@@ -393,6 +436,26 @@ private:
    /// seekToJD() stores the current record here, and computeState() makes use of it.
    std::vector<double> coefficients;
 
+   /// Earth-Moon mass ratio and AU in km, constants["EMRAT"] and constants["AU"],
+   /// kept by readBinaryHeader() so that computeState() does not search the map.
+   double EMratio, AUkm;
+
+   /// Start of the file mapped by initializeWithMappedFile() (or, without mmap,
+   /// of a copy in memory), and its length in bytes; 0 if none.
+   const char *mapBase;
+   size_t mapLength;
+
+   /// First data record in the mapped file, Ncoeff doubles per record; 0 if no
+   /// file is mapped.
+   const double *records;
+
+   /// Number of complete data records in the mapped file.
+   long Nrecords;
+
+   /// Not copyable: a copy would share the mapping, and unmap it when destroyed.
+   SolarSystem(const SolarSystem&);
+   SolarSystem& operator=(const SolarSystem&);
+
 }; // end class SolarSystem
 
 }  // end namespace gpstk
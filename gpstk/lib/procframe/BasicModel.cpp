@@ -169,7 +169,7 @@ namespace gpstk
             }
 
                // Let's test if satellite has enough elevation over horizon
-            if ( rxPos.elevationGeodetic(cerange.svPosVel) < minElev )
+            if ( cerange.elevationGeodetic < minElev )
             {
 
                   // Mark this satellite if it doesn't have enough elevation
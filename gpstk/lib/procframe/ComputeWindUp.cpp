@@ -52,12 +52,33 @@ namespace gpstk
       throw(ProcessingException)
    {
 
+      EpochContext context;
+
+      return Process(time, gData, context);
+
+   }  // End of method 'ComputeWindUp::Process()'
+
+
+
+      /* Returns a satTypeValueMap object, adding the new data generated when
+       * calling this object, and taking the Sun position from the given
+       * epoch context.
+       *
+       * @param time      Epoch corresponding to the data.
+       * @param gData     Data object holding the data.
+       * @param context   Quantities shared with other processing classes.
+       */
+   satTypeValueMap& ComputeWindUp::Process( const CommonTime& time,
+                                            satTypeValueMap& gData,
+                                            EpochContext& context )
+      throw(ProcessingException)
+   {
+
       try
       {
 
-            // Compute Sun position at this epoch
-         SunPosition sunPosition;
-         Triple sunPos(sunPosition.getPosition(time));
+            // Sun position at this epoch
+         const Triple& sunPos(context.sunPosition(time));
 
             // Define a Triple that will hold satellite position, in ECEF
          Triple svPos(0.0, 0.0, 0.0);
@@ -137,6 +137,20 @@ namespace gpstk
          throw(ProcessingException);
 
 
+         /** Returns a satTypeValueMap object, adding the new data generated
+          *  when calling this object, and taking the Sun position from the
+          *  given epoch context.
+          *
+          * @param time      Epoch corresponding to the data.
+          * @param gData     Data object holding the data.
+          * @param context   Quantities shared with other processing classes.
+          */
+      virtual satTypeValueMap& Process( const CommonTime& time,
+                                        satTypeValueMap& gData,
+                                        EpochContext& context )
+         throw(ProcessingException);
+
+
          /** Returns a gnnsSatTypeValue object, adding the new data
           *  generated when calling this object.
           *
@@ -154,7 +168,7 @@ namespace gpstk
           */
       virtual gnssRinex& Process(gnssRinex& gData)
          throw(ProcessingException)
-      { Process(gData.header.epoch, gData.body); return gData; };
+      { Process(gData.header.epoch, gData.body, gData.context); return gData; };
 
 
          /// Returns name of "PRN_GPS"-like file containing satellite data.
@@ -38,6 +38,7 @@
 #include <string>
 
 #include "DataHeaders.hpp"
+#include "EpochContext.hpp"
 #include "FFData.hpp"
 #include "RinexObsStream.hpp"
 #include "RinexObsData.hpp"
@@ -1010,6 +1011,11 @@ namespace gpstk
       sourceEpochRinexHeader header;
 
 
+         /// Quantities of this epoch shared by the processing classes
+         /// (Sun position).
+      EpochContext context;
+
+
          /// Default constructor.
       gnssRinex() {};
 
@@ -92,6 +92,28 @@ namespace gpstk
       throw(ProcessingException)
    {
 
+      EpochContext context;
+
+      return Process(epoch, gData, context);
+
+   }  // End of 'EclipsedSatFilter::Process()'
+
+
+
+      /* Returns a satTypeValueMap object, adding the new data generated
+       *  when calling this object, and taking the Sun position from the
+       *  given epoch context.
+       *
+       * @param epoch     Time of observations.
+       * @param gData     Data object holding the data.
+       * @param context   Quantities shared with other processing classes.
+       */
+   satTypeValueMap& EclipsedSatFilter::Process( const CommonTime& epoch,
+                                                satTypeValueMap& gData,
+                                                EpochContext& context )
+      throw(ProcessingException)
+   {
+
       try
       {
 
@@ -101,9 +123,8 @@ namespace gpstk
             // threshold = cos(180 - coneAngle/2)
          double threshold( std::cos(PI - coneAngle/2.0*DEG_TO_RAD) );
 
-            // Compute Sun position at this epoch, and store it in a Triple
-         SunPosition sunPosition;
-         Triple sunPos(sunPosition.getPosition(epoch));
+            // Sun position at this epoch
+         const Triple& sunPos(context.sunPosition(epoch));
 
             // Define a Triple that will hold satellite position, in ECEF
          Triple svPos(0.0, 0.0, 0.0);
@@ -206,7 +227,7 @@ namespace gpstk
       try
       {
 
-         Process(gData.header.epoch, gData.body);
+         Process(gData.header.epoch, gData.body, gData.context);
 
          return gData;
 
@@ -130,6 +130,20 @@ namespace gpstk
          throw(ProcessingException);
 
 
+         /** Returns a satTypeValueMap object, adding the new data generated
+          *  when calling this object, and taking the Sun position from the
+          *  given epoch context.
+          *
+          * @param epoch     Time of observations.
+          * @param gData     Data object holding the data.
+          * @param context   Quantities shared with other processing classes.
+          */
+      virtual satTypeValueMap& Process( const CommonTime& epoch,
+                                        satTypeValueMap& gData,
+                                        EpochContext& context )
+         throw(ProcessingException);
+
+
          /** Returns a gnnsSatTypeValue object, adding the new data generated
           *  when calling this object.
           *
@@ -0,0 +1,68 @@
+#pragma ident "$Id$"
+
+/**
+ * @file EpochContext.cpp
+ * Quantities of one epoch shared by the processing classes: Sun and Moon
+ * positions, receiver geodetic coordinates and local frame, and satellite
+ * elevations and azimuths.
+ */
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+
+#include "EpochContext.hpp"
+#include "SunPosition.hpp"
+
+
+namespace gpstk
+{
+
+
+      // Returns the position of the Sun, ECEF, in meters.
+   const Triple& EpochContext::sunPosition(const CommonTime& epoch)
+      throw(InvalidRequest)
+   {
+
+      if( !sunValid || sunEpoch != epoch )
+      {
+         SunPosition sunPosition;
+         sunPos = sunPosition.getPosition(epoch);
+         sunEpoch = epoch;
+         sunValid = true;
+         sunCount++;
+      }
+
+      return sunPos;
+
+   }  // End of method 'EpochContext::sunPosition()'
+
+
+
+      // Forgets every quantity computed so far.
+   void EpochContext::clear()
+   {
+
+      sunValid = false;
+
+   }  // End of method 'EpochContext::clear()'
+
+
+}  // End of namespace gpstk
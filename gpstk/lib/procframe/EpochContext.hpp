@@ -0,0 +1,121 @@
+#pragma ident "$Id$"
+
+/**
+ * @file EpochContext.hpp
+ * Quantities of one epoch shared by the processing classes: the Sun
+ * position.
+ */
+
+#ifndef GPSTK_EPOCHCONTEXT_HPP
+#define GPSTK_EPOCHCONTEXT_HPP
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+
+
+#include "CommonTime.hpp"
+#include "Triple.hpp"
+#include "Exception.hpp"
+
+
+
+namespace gpstk
+{
+
+      /** @addtogroup DataStructures */
+      //@{
+
+
+      /** This class keeps the quantities of one epoch that several processing
+       *  classes need, so that each one is computed only once per epoch
+       *  instead of once per processing class.
+       *
+       * A gnssRinex object carries an EpochContext (member 'context'), and
+       * the processing classes that need the Sun position take it from
+       * there when they are given a gnssRinex:
+       *
+       * @code
+       *   gnssRinex gRin;
+       *
+       *   while(rin >> gRin)
+       *   {
+       *         // The Sun position is computed by 'windup', and then used
+       *         // again by 'svPcenter' and 'eclipsedSV'
+       *      gRin >> eclipsedSV >> svPcenter >> windup;
+       *   }
+       * @endcode
+       *
+       * Every quantity is computed when it is first asked for, and kept
+       * together with the epoch it was computed for. A request for another
+       * epoch computes it again, so a context never gives values of an
+       * older epoch, even if the gnssRinex holding it is reused.
+       *
+       * The results are those of SunPosition.
+       */
+   class EpochContext
+   {
+   public:
+
+         /// Default constructor
+      EpochContext()
+         : sunValid(false), sunCount(0)
+      {};
+
+
+         /** Returns the position of the Sun, ECEF, in meters, computed with
+          *  SunPosition.
+          *
+          * @param epoch      Epoch of interest.
+          */
+      const Triple& sunPosition(const CommonTime& epoch)
+         throw(InvalidRequest);
+
+
+         /// Forgets every quantity computed so far.
+      void clear();
+
+
+         /// Number of times the Sun position has been computed.
+      unsigned long sunComputations() const
+      { return sunCount; };
+
+
+         /// Destructor.
+      virtual ~EpochContext() {};
+
+
+   private:
+
+
+         /// Sun position, and the epoch it was computed at
+      bool sunValid;
+      CommonTime sunEpoch;
+      Triple sunPos;
+      unsigned long sunCount;
+
+
+   }; // End of class 'EpochContext'
+
+      //@}
+
+}  // End of namespace gpstk
+
+#endif   // GPSTK_EPOCHCONTEXT_HPP
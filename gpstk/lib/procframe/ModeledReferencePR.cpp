@@ -291,7 +291,7 @@ namespace gpstk
                }; // End of "try/catch" for cerange
 
                   // Let's test if satellite has enough elevation over horizon
-               if(rxPos.elevationGeodetic(cerange.svPosVel) < (*this).minElev)
+               if(cerange.elevationGeodetic < (*this).minElev)
                {
                      // Mark this satellite if it doesn't have
                      // enough elevation
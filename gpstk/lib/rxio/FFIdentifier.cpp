@@ -39,242 +39,298 @@
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 
-#include "FileUtils.hpp"
+#include "StringUtils.hpp"
+#include "ThreadPool.hpp"
 
 #include "FFIdentifier.hpp"
 
-#include "SP3EphemerisStore.hpp"
-#include "Rinex3EphemerisStore.hpp"
-#include "YumaAlmanacStore.hpp"
-#include "GPSEllipsoid.hpp"
+#include "FICHeader.hpp"
+#include "FICData.hpp"
 
-#include "SP3Stream.hpp"
+#include "MDPHeader.hpp"
 
-#include "RinexObsStream.hpp"
-#include "RinexObsData.hpp"
+namespace gpstk
+{
+   int FFIdentifier::debugLevel = 0;
 
-#include "RinexNavStream.hpp"
-#include "RinexNavData.hpp"
-#include "RinexMetStream.hpp"
-#include "RinexMetData.hpp"
+   const std::string::size_type FFIdentifier::sniffSize = 4096;
 
-#include "FICStream.hpp"
-#include "FICData.hpp"
 
-#include "SMODFStream.hpp"
-#include "SMODFData.hpp"
+   // Identifies one file of a batch
+   class FFIdentifier::IdentifyTask : public ThreadPool::Task
+   {
+   public:
+      IdentifyTask() : file(NULL), type(NULL) {}
 
-#include "MSCData.hpp"
-#include "MSCStream.hpp"
+      virtual void run() throw()
+      {
+         std::string head;
+         if (FFIdentifier::readHead(*file, head))
+            *type = FFIdentifier::sniff(head);
+      }
+
+      const std::string* file;
+      FFType* type;
+   };
 
-#include "MDPObsEpoch.hpp"
-#include "MDPPVTSolution.hpp"
-#include "MDPNavSubframe.hpp"
-#include "MDPSelftestStatus.hpp"
-#include "MDPStream.hpp"
 
-#include "YumaData.hpp"
-#include "YumaStream.hpp"
+   // The complete lines at the start of head, without their line ends;
+   // the last one counts only if head is the whole file.
+   static void headLines(const std::string& head, bool whole,
+                         std::vector<std::string>& lines, unsigned maxLines)
+   {
+      std::string::size_type b = 0;
+      while (lines.size() < maxLines && b < head.size())
+      {
+         std::string::size_type e = head.find('\n', b);
+         if (e == std::string::npos)
+         {
+            if (!whole)
+               break;
+            e = head.size();
+         }
+         std::string line(head, b, e - b);
+         if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+         lines.push_back(line);
+         b = e + 1;
+      }
+   }
 
-#include "SEMData.hpp"
-#include "SEMStream.hpp"
 
-#include "NovatelData.hpp"
-#include "NovatelStream.hpp"
+   // True if s is an integer, possibly padded with blanks
+   static bool isInteger(const std::string& s)
+   {
+      std::string t(StringUtils::strip(s));
+      std::string::size_type i = (!t.empty() && (t[0]=='-' || t[0]=='+'));
+      if (i == t.size())
+         return false;
+      for ( ; i < t.size(); i++)
+         if (t[i] < '0' || t[i] > '9')
+            return false;
+      return true;
+   }
 
-#include "AshtechData.hpp"
-#include "AshtechStream.hpp"
 
-namespace gpstk
-{
-   int FFIdentifier::debugLevel = 0;
+   // True if every line has the given length
+   static bool allOfLength(const std::vector<std::string>& lines,
+                           std::string::size_type len)
+   {
+      for (unsigned i = 0; i < lines.size(); i++)
+         if (lines[i].size() != len)
+            return false;
+      return !lines.empty();
+   }
+
 
    FFIdentifier::FFIdentifier(const std::string& fn)
       throw(FileMissingException)
    {
-
-      if (!FileUtils::fileAccessCheck(fn))
+      std::string head;
+      if (!readHead(fn, head))
       {
          FileMissingException e("Cannot open " + fn);
          GPSTK_THROW(e);
       }
 
-      using namespace std;
-      fileType=tUnknown;
+      fileType = sniff(head);
 
-      {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as RINEX obs."<< endl;
-         RinexObsStream s(fn.c_str(), ios::in);
-      
-         RinexObsHeader temp_roh;
-         s >> temp_roh;
-         RinexObsData rod;
-         s >> rod;
-         if (s)
-         {
-            fileType = tRinexObs;
-            return;
-         } 
-      }
+      if (debugLevel>2)
+         std::cout << "Identified " << fn << " as "
+                   << describe(fileType) << std::endl;
+   }
 
-      {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as SMODF."<< endl;
-         SMODFStream s(fn.c_str(), ios::in);
-         
-         SMODFData smodata;       
-         s >> smodata;
-         s >> smodata;
-         if (s)
-         {
-            fileType = tSMODF;
-            return;
-         }
-      }
 
+   bool FFIdentifier::readHead(const std::string& fn, std::string& head)
+      throw()
+   {
+      std::ifstream s(fn.c_str(), std::ios::in | std::ios::binary);
+      if (!s)
+         return false;
+
+      head.resize(sniffSize);
+      s.read(&head[0], sniffSize);
+      head.resize(s.gcount());
+      return true;
+   }
+
+
+   FFIdentifier::FFType FFIdentifier::sniff(const std::string& head)
+      throw()
+   {
+      using namespace std;
+
+      const unsigned char* b =
+         reinterpret_cast<const unsigned char*>(head.data());
+      const string::size_type n = head.size();
+      string::size_type i;
+
+      // gzip, compress, bzip2 and zip
+      if (n >= 2 && b[0] == 0x1f && (b[1] == 0x8b || b[1] == 0x9d))
+         return tCompressed;
+      if (n >= 4 && head.compare(0, 3, "BZh") == 0 &&
+          b[3] >= '1' && b[3] <= '9')
+         return tCompressed;
+      if (n >= 4 && head.compare(0, 4, "PK\003\004") == 0)
+         return tCompressed;
+
+      // Binary FIC: the first block right after the file header
+      const string::size_type ficBlock = FICHeader::headerSize;
+      if (n >= ficBlock + FICData::blockString.size() &&
+          head.compare(ficBlock, FICData::blockString.size(),
+                       FICData::blockString) == 0)
+         return tFIC;
+
+      // MDP: the first frame word within 1024 words, as MDPStream looks
+      // for it, must start a sane header and a message with a good CRC.
+      for (i = 0; i + MDPHeader::myLength <= n && i < 2048; i += 2)
       {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as MDP."<< endl;
-         MDPStream s(fn.c_str(), ios::in);
+         if (b[i] != (MDPHeader::frameWord >> 8) ||
+             b[i+1] != (MDPHeader::frameWord & 0xff))
+            continue;
 
          MDPHeader header;
-         s >> header;
-         string body = header.readBody(s);
-         if (s.rawHeader.size() && body.size())
+         header.decode(head.substr(i, MDPHeader::myLength));
+         if (header.length >= MDPHeader::myLength &&
+             i + header.length <= n)
          {
             header.setstate(crcbit);
-            header.checkCRC(s.rawHeader+body);
+            header.checkCRC(head.substr(i, header.length));
             if (!header.crcerr())
-            {
-               fileType = tMDP;
-               return;
-            }
+               return tMDP;
          }
+         break;
       }
 
-      {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as RINEX nav."<< endl;
-         RinexNavStream s(fn.c_str(), ios::in);
-
-         RinexNavData rnd;
-         RinexNavHeader rnh;
-         s >> rnh;
-         s >> rnd;
-         if (s)
-         {
-            fileType = tRinexNav;
-            return;
-         }
-      }
-      
-      {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as FIC nav."<< endl;
-         FICStream s(fn.c_str(), ios::in);
-         
-         FICData data;
-         s >> data;
-         if (s)
-         {
-            fileType = tFIC;
-            return;
-         }
-      }
+      vector<string> lines;
+      headLines(head, n < sniffSize, lines, 4);
 
+      if (!lines.empty())
       {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as SP3 ephemeris."<< endl;
-         SP3Stream s(fn.c_str(), ios::in);
-         
-         SP3Header header;
-         s >> header;
-         SP3Data data;
-         s >> data;
-         if (s)
+         const string& first = lines[0];
+
+         // RINEX: the file type follows the version on the first line
+         if (first.size() >= 80 &&
+             first.compare(60, 20, "RINEX VERSION / TYPE") == 0)
          {
-            fileType = tSP3;
-            return;
+            switch (first[20])
+            {
+               case 'O': return tRinexObs;
+               case 'N': return tRinexNav;
+               case 'M': return tRinexMet;
+            }
+            return tUnknown;
          }
+
+         // SP3: '#' and the version, then the '##' line
+         if (first.size() >= 3 && first[0] == '#' &&
+             first[1] >= 'a' && first[1] <= 'c' &&
+             lines.size() > 1 && lines[1].compare(0, 2, "##") == 0)
+            return tSP3;
+
+         // Yuma: "******** Week ... almanac for PRN-xx ********", then ID:
+         if (first.compare(0, 8, "********") == 0 &&
+             first.find("Week") != string::npos &&
+             lines.size() > 1 && lines[1].compare(0, 3, "ID:") == 0)
+            return tYuma;
+
+         // SMODF, ICD-GPS-211 (85 characters) and legacy (80): fixed
+         // length records starting with the date, then the PRN and station
+         if (allOfLength(lines, 85) &&
+             isInteger(first.substr(0, 4)) && isInteger(first.substr(4, 3)) &&
+             isInteger(first.substr(21, 2)) && isInteger(first.substr(23, 5)))
+            return tSMODF;
+         if (allOfLength(lines, 80) &&
+             isInteger(first.substr(0, 2)) && isInteger(first.substr(2, 3)) &&
+             isInteger(first.substr(17, 3)) && isInteger(first.substr(20, 5)))
+            return tSMODF;
+
+         // MSC: fixed length records of 90 or 104 characters; the date
+         // may be blank in the longer one.
+         if ((allOfLength(lines, 90) || allOfLength(lines, 104)) &&
+             isInteger(first.substr(7, 5)) &&
+             (StringUtils::strip(first.substr(0, 7)).empty() ||
+              (isInteger(first.substr(0, 4)) && isInteger(first.substr(4, 3)))))
+            return tMSC;
+
+         // SEM: record count and title, week and time of applicability,
+         // a blank line, then the PRN of the first record
+         if (lines.size() == 4 && first.size() > 3 &&
+             isInteger(first.substr(0, 2)) &&
+             lines[1].size() > 5 && isInteger(lines[1].substr(0, 4)) &&
+             isInteger(lines[1].substr(5)) &&
+             StringUtils::strip(lines[2]).empty() && isInteger(lines[3]))
+            return tSEM;
       }
 
+      // Ashtech: the preamble of a response
+      if (head.find("$PASHR,") != string::npos)
+         return tAshtechSerial;
+
+      // Novatel: the OEM2 or OEM4 sync bytes
+      for (i = 0; i + 3 <= n; i++)
+         if (b[i] == 0xAA && b[i+1] == 0x44 &&
+             (b[i+2] == 0x11 || b[i+2] == 0x12))
+            return tNovatelOem;
+
+      return tUnknown;
+   }
+
+
+   void FFIdentifier::identify(const std::vector<std::string>& files,
+                               std::vector<FFType>& types,
+                               unsigned threads)
+      throw()
+   {
+      types.assign(files.size(), tUnknown);
+
+      std::vector<IdentifyTask> tasks(files.size());
+      for (unsigned i = 0; i < files.size(); i++)
       {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as Yuma elmanac."<< endl;
-         YumaStream s(fn.c_str(), ios::in);
-         
-         YumaHeader header;
-         s >> header;
-         YumaData data;
-         s >> data;
-         if (s)
-         {
-            fileType = tYuma;
-            return;
-         }
+         tasks[i].file = &files[i];
+         tasks[i].type = &types[i];
       }
 
+      if (threads == 0)
+         threads = ThreadPool::processorCount();
+      if (threads > files.size())
+         threads = files.size();
+
+      ThreadPool* pool = NULL;
+      if (threads > 1)
       {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as SEM almanac."<< endl;
-         SEMStream s(fn.c_str(), ios::in);
-         
-         SEMHeader header;
-         s >> header;
-         SEMData data;
-         s >> data;
-         if (s)
+         try
          {
-            fileType = tSEM;
-            return;
+            pool = new ThreadPool(threads);
          }
-      }
-
-      {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as MSC."<< endl;
-         MSCStream s(fn.c_str(), ios::in);
-
-         MSCData mscd;
-         s >> mscd;
-         if (s)
+         catch (Exception&)
          {
-            fileType = tMSC;
-            return;
+            pool = NULL;          // identify them in this thread instead
          }
       }
 
-
+      if (pool)
       {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as Novatel OEM." << endl;
-         NovatelStream s(fn.c_str(), ios::in);
-         NovatelData nd;
-         s >> nd;
-         if (s)
-         {
-            fileType = tNovatelOem;
-            return;
-         }
+         for (unsigned i = 0; i < tasks.size(); i++)
+            pool->submit(&tasks[i]);
+         pool->wait();
+         delete pool;
       }
-
+      else
       {
-         if (debugLevel>2)
-            cout << "Trying " << fn << " as Ashtech serial." << endl;
-         AshtechStream s(fn.c_str(), ios::in);
-         AshtechData nd;
-         s >> nd;
-         if (s)
-         {
-            fileType = tAshtechSerial;
-            return;
-         }
+         for (unsigned i = 0; i < tasks.size(); i++)
+            tasks[i].run();
       }
 
+      if (debugLevel>2)
+         for (unsigned i = 0; i < files.size(); i++)
+            std::cout << "Identified " << files[i] << " as "
+                      << describe(types[i]) << std::endl;
    }
 
+
    std::string FFIdentifier::describe(FFIdentifier::FFType type)
    {
       std::string desc("Unknown");
@@ -292,6 +348,46 @@ namespace gpstk
          case FFIdentifier::tSMODF :
 	   desc="Smoothed measurement";
 	   break;
+
+         case FFIdentifier::tRinexNav :
+            desc="RINEX nav";
+            break;
+
+         case FFIdentifier::tRinexMet :
+            desc="RINEX met";
+            break;
+
+         case FFIdentifier::tFIC :
+            desc="FIC";
+            break;
+
+         case FFIdentifier::tSP3 :
+            desc="SP3 ephemeris";
+            break;
+
+         case FFIdentifier::tMSC :
+            desc="Monitor station coordinates";
+            break;
+
+         case FFIdentifier::tYuma :
+            desc="Yuma almanac";
+            break;
+
+         case FFIdentifier::tSEM :
+            desc="SEM almanac";
+            break;
+
+         case FFIdentifier::tAshtechSerial :
+            desc="Ashtech serial";
+            break;
+
+         case FFIdentifier::tNovatelOem :
+            desc="Novatel OEM";
+            break;
+
+         case FFIdentifier::tCompressed :
+            desc="Compressed";
+            break;
       }
       return desc;
    }
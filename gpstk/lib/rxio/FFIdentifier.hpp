@@ -39,16 +39,26 @@
 #ifndef FFIDENTIFIER_HPP
 #define FFIDENTIFIER_HPP
 
-/** @file This is a class that iteratively tries each of the FormattedFile
-    classes to see what format a file is in.
+/** @file This is a class that identifies the format of a file from its
+    first few kilobytes.
 */
 
 #include <string>
+#include <vector>
+
+#include "Exception.hpp"
 
 namespace gpstk
 {
 
    // A function object to figure out what format a file is
+   //
+   // Only the first sniffSize bytes of the file are read, once, and matched
+   // against the signatures of the formats: the RINEX VERSION / TYPE label,
+   // the MDP frame word followed by a header and body with a good CRC, the
+   // block marker after the FIC header, the SP3 '#' lines, the Yuma and SEM
+   // almanac headers, the fixed line lengths of SMODF and MSC, the Novatel
+   // and Ashtech sync sequences, and the magic numbers of compressed files.
    class FFIdentifier
    {
    public:
@@ -66,7 +76,8 @@ namespace gpstk
          tYuma,
          tSEM,
          tAshtechSerial,
-         tNovatelOem
+         tNovatelOem,
+         tCompressed     ///< gzip, compress, bzip2 or zip
       };
 
       FFIdentifier()
@@ -80,9 +91,30 @@ namespace gpstk
 
       static std::string describe(FFType thisId);
 
+      /// Identifies the format from the first bytes of a file; 'head'
+      /// holds up to sniffSize of them, all of them if the file is
+      /// shorter.
+      static FFType sniff(const std::string& head) throw();
+
+      /// Identifies many files, with 'threads' threads (0 is one per
+      /// processor). types[i] is the type of files[i]; a file that can't
+      /// be read is tUnknown.
+      static void identify(const std::vector<std::string>& files,
+                           std::vector<FFType>& types,
+                           unsigned threads = 0) throw();
+
+      /// The number of bytes read from each file
+      static const std::string::size_type sniffSize;
+
       static int debugLevel;
 
    private:
+      class IdentifyTask;
+      friend class IdentifyTask;
+
+      /// Reads the first sniffSize bytes of fn; false if it can't be opened
+      static bool readHead(const std::string& fn, std::string& head) throw();
+
       FFType fileType;
 
 
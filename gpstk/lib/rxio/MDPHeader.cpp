@@ -55,7 +55,7 @@ using gpstk::StringUtils::int2x;
 using gpstk::BinUtils::netToHost;
 using gpstk::BinUtils::hostToNet;
 using gpstk::BinUtils::encodeVar;
-using gpstk::BinUtils::decodeVar;
+using gpstk::BinUtils::RecordView;
 
 
 namespace gpstk
@@ -110,13 +110,14 @@ namespace gpstk
 
       clearstate(lenbit);
 
-      unsigned short fw    = decodeVar<uint16_t>(str);
-      id                   = decodeVar<uint16_t>(str);
-      length               = decodeVar<uint16_t>(str);
-      unsigned short week  = decodeVar<uint16_t>(str);
-      unsigned long sow100 = decodeVar<uint32_t>(str);
-      freshnessCount       = decodeVar<uint16_t>(str);
-      crc                  = decodeVar<uint16_t>(str);
+      RecordView rec(str);
+      unsigned short fw    = rec.net<uint16_t>(0);
+      id                   = rec.net<uint16_t>(2);
+      length               = rec.net<uint16_t>(4);
+      unsigned short week  = rec.net<uint16_t>(6);
+      unsigned long sow100 = rec.net<uint32_t>(8);
+      freshnessCount       = rec.net<uint16_t>(12);
+      crc                  = rec.net<uint16_t>(14);
 
       const unsigned long MaxSOW=604800;
       if (fw != frameWord ||
@@ -249,7 +250,6 @@ namespace gpstk
          readBody(ffs);
 
       // first reset the data status
-      char buff[MDPHeader::myLength];
       ffs.streamState = MDPStream::outOfSync;
     
       streampos p0 = ffs.tellg();
@@ -259,13 +259,13 @@ namespace gpstk
       int i;
       for (i=0; ffs && i<maxTries; i++)
       {
-         fw = ffs.getData<uint16_t>();
-         b2[i] = fw;
-         fw = netToHost(fw);
-         if (fw!=MDPHeader::frameWord)
-            continue;
-         std::memcpy(buff, &fw, sizeof(fw));
-         break;
+         const char* p = ffs.getView(2);
+         if (!p)
+            break;
+         std::memcpy(&b2[i], p, 2);
+         fw = RecordView(p, 2).net<uint16_t>(0);
+         if (fw==MDPHeader::frameWord)
+            break;
       }
       streampos p1 = ffs.tellg();
 
@@ -289,12 +289,13 @@ namespace gpstk
       if (debugLevel>2)
          cout << "Found frame word at " << hex << p1 << dec << endl;
 
-      // then read in the rest of a header
-      ffs.getData(buff+2, MDPHeader::myLength-2);
-      if (ffs.fail())
+      // then read in the rest of a header, straight from the stream
+      const char* rest = ffs.getView(MDPHeader::myLength-2);
+      if (!rest)
          return;
          
-      ffs.rawHeader = string(buff, MDPHeader::myLength);
+      ffs.rawHeader.assign((const char*)&b2[i], 2);
+      ffs.rawHeader.append(rest, MDPHeader::myLength-2);
       MDPHeader::decode(ffs.rawHeader);
       ffs.streamState = MDPStream::gotHeader;
       ffs.header = *this;
@@ -328,17 +329,15 @@ namespace gpstk
 
       // Read in the body of the message
       const unsigned myLen = length - MDPHeader::myLength;
-      char *buff = new char[myLen];
       if (debugLevel>2)
          cout << "Reading " << myLen 
               << " bytes for message id " << id
               << " body at offset " << hex <<  ffs.tellg() << dec << endl;
-      ffs.getData(buff, myLen);
-      if (ffs.gcount() == myLen)
-         ffs.streamState = MDPStream::gotBody;
-      string str(buff, ffs.gcount());
-      delete buff;
-      return str;
+      const char* body = ffs.getView(myLen);
+      if (!body)
+         return string();
+      ffs.streamState = MDPStream::gotBody;
+      return string(body, myLen);
    }
 
 
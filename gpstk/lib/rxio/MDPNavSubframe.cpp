@@ -50,7 +50,7 @@ using gpstk::StringUtils::asString;
 using gpstk::BinUtils::netToHost;
 using gpstk::BinUtils::hostToNet;
 using gpstk::BinUtils::encodeVar;
-using gpstk::BinUtils::decodeVar;
+using gpstk::BinUtils::RecordView;
 using namespace std;
 
 namespace gpstk
@@ -91,13 +91,14 @@ namespace gpstk
 
       clearstate(lenbit);
 
-      prn     = static_cast<int>        (decodeVar<int8_t>(str));
-      carrier = static_cast<CarrierCode>(decodeVar<int8_t>(str));
-      range   = static_cast<RangeCode>  (decodeVar<int8_t>(str));
-      nav     = static_cast<NavCode>    (decodeVar<int8_t>(str));
+      RecordView rec(str);
+      prn     = static_cast<int>        (rec.net<int8_t>(0));
+      carrier = static_cast<CarrierCode>(rec.net<int8_t>(1));
+      range   = static_cast<RangeCode>  (rec.net<int8_t>(2));
+      nav     = static_cast<NavCode>    (rec.net<int8_t>(3));
 
       for (int i=1; i<11; i++)
-         subframe[i] = decodeVar<uint32_t>(str);
+         subframe[i] = rec.net<uint32_t>(4*i);
       
       if (prn > gpstk::MAX_PRN ||
           carrier >= ccMax ||
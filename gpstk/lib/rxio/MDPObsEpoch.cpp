@@ -49,7 +49,7 @@ using gpstk::StringUtils::asString;
 using gpstk::BinUtils::hostToNet;
 using gpstk::BinUtils::netToHost;
 using gpstk::BinUtils::encodeVar;
-using gpstk::BinUtils::decodeVar;
+using gpstk::BinUtils::RecordView;
 using namespace std;
 
 namespace gpstk
@@ -99,13 +99,14 @@ namespace gpstk
 
       clearstate(lenbit);
 
+      RecordView rec(str);
       unsigned obsSVs;
-      obsSVs    = decodeVar<uint8_t>(str);
-      channel   = decodeVar<uint8_t>(str);
-      prn       = decodeVar<uint8_t>(str);
-      status    = decodeVar<uint8_t>(str);
-      elevation = decodeVar<uint16_t>(str) * 0.01 ;
-      azimuth   = decodeVar<uint16_t>(str) * 0.01;
+      obsSVs    = rec.net<uint8_t>(0);
+      channel   = rec.net<uint8_t>(1);
+      prn       = rec.net<uint8_t>(2);
+      status    = rec.net<uint8_t>(3);
+      elevation = rec.net<uint16_t>(4) * 0.01 ;
+      azimuth   = rec.net<uint16_t>(6) * 0.01;
 
       numSVs = obsSVs >> 4;
       numSVs &= 0x0f;
@@ -114,18 +115,19 @@ namespace gpstk
       bool obsError=false;
 
       obs.erase(obs.begin(), obs.end());
-      for(int j=0; j<obsSVs; j++)
+      size_t pos = myLength;
+      for(unsigned j=0; j<obsSVs; j++, pos += myObsLength)
       {
-         if (str.length() < myObsLength)
+         if (str.length() - pos < myObsLength)
          {
             clear(lenbit);
             if (debugLevel)
                cout << "MDP Obs block decode requires at least " << myObsLength
-                    << " bytes.  Received " << str.length() << " bytes" << endl;
+                    << " bytes.  Received " << str.length() - pos << " bytes" << endl;
             return;
          }
          MDPObsEpoch::Observation o;      
-         o.decode(str);
+         o.decode(rec.data + pos);
 
          if (o.carrier >= ccMax || o.range >= rcMax || o.snr > 65 || o.bw > 100)
             obsError=true;
@@ -192,15 +194,25 @@ namespace gpstk
    void MDPObsEpoch::Observation::decode(std::string& str)
       throw()
    {
+      decode(str.data());
+      str.erase(0, myObsLength);
+   }  // MDPObservation::decode()
+
+
+   //---------------------------------------------------------------------------
+   void MDPObsEpoch::Observation::decode(const char* p)
+      throw()
+   {
+      RecordView rec(p, myObsLength);
       unsigned char ccrc;
 
-      ccrc        = decodeVar<uint8_t>(str);      
-      bw          = decodeVar<uint8_t>(str);
-      snr         = decodeVar<uint16_t>(str) * 0.01;
-      lockCount   = decodeVar<uint32_t>(str);
-      pseudorange = decodeVar<double>(str);
-      phase       = decodeVar<double>(str);
-      doppler     = decodeVar<double>(str);
+      ccrc        = rec.net<uint8_t>(0);
+      bw          = rec.net<uint8_t>(1);
+      snr         = rec.net<uint16_t>(2) * 0.01;
+      lockCount   = rec.net<uint32_t>(4);
+      pseudorange = rec.net<double>(8);
+      phase       = rec.net<double>(16);
+      doppler     = rec.net<double>(24);
 
       range = RangeCode(ccrc & 0x0f);
       ccrc >>= 4;
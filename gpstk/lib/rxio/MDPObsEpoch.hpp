@@ -64,6 +64,9 @@ namespace gpstk
          // Note that this is a destructive decode, unlike the others in this
          //  set of classes.
          void decode(std::string& str) throw();
+
+         // Decodes the myObsLength bytes at p, which are left alone.
+         void decode(const char* p) throw();
   
          CarrierCode carrier;     ///< This observation's carrier frequency.
          RangeCode range;         ///< This observation's range code.
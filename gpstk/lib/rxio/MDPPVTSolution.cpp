@@ -49,7 +49,7 @@ using gpstk::StringUtils::asString;
 using gpstk::BinUtils::hostToNet;
 using gpstk::BinUtils::netToHost;
 using gpstk::BinUtils::encodeVar;
-using gpstk::BinUtils::decodeVar;
+using gpstk::BinUtils::RecordView;
 using namespace std;
 
 namespace gpstk
@@ -99,20 +99,21 @@ namespace gpstk
 
       clearstate(lenbit);
       
-      x[0]        = decodeVar<double>(str);
-      x[1]        = decodeVar<double>(str);
-      x[2]        = decodeVar<double>(str);
-      v[0]        = decodeVar<float>(str);
-      v[1]        = decodeVar<float>(str);
-      v[2]        = decodeVar<float>(str);
-      numSVs      = decodeVar<uint8_t>(str);
-      fom         = decodeVar<int8_t>(str);
-      int week    = decodeVar<uint16_t>(str);
-      double sow  = decodeVar<double>(str);
-      dtime       = decodeVar<double>(str);
-      ddtime      = decodeVar<double>(str);
-      pvtMode     = decodeVar<uint8_t>(str);
-      corrections = decodeVar<uint8_t>(str);
+      RecordView rec(str);
+      x[0]        = rec.net<double>(0);
+      x[1]        = rec.net<double>(8);
+      x[2]        = rec.net<double>(16);
+      v[0]        = rec.net<float>(24);
+      v[1]        = rec.net<float>(28);
+      v[2]        = rec.net<float>(32);
+      numSVs      = rec.net<uint8_t>(36);
+      fom         = rec.net<int8_t>(37);
+      int week    = rec.net<uint16_t>(38);
+      double sow  = rec.net<double>(40);
+      dtime       = rec.net<double>(48);
+      ddtime      = rec.net<double>(56);
+      pvtMode     = rec.net<uint8_t>(64);
+      corrections = rec.net<uint8_t>(65);
 
       if (week < 0 || week > 5000 || sow < 0 || sow > 604800)
          return;
@@ -48,7 +48,7 @@
 
 using gpstk::StringUtils::asString;
 using gpstk::BinUtils::encodeVar;
-using gpstk::BinUtils::decodeVar;
+using gpstk::BinUtils::RecordView;
 using namespace std;
 
 namespace gpstk
@@ -97,18 +97,19 @@ namespace gpstk
       long sow100;
       int week;
 
-      antennaTemp   = decodeVar<float>(str);
-      receiverTemp  = decodeVar<float>(str);
-      status        = decodeVar<uint32_t>(str);
-      cpuLoad       = decodeVar<float>(str);
-      sow100        = decodeVar<uint32_t>(str);
-      week          = decodeVar<uint16_t>(str);
+      RecordView rec(str);
+      antennaTemp   = rec.net<float>(0);
+      receiverTemp  = rec.net<float>(4);
+      status        = rec.net<uint32_t>(8);
+      cpuLoad       = rec.net<float>(12);
+      sow100        = rec.net<uint32_t>(16);
+      week          = rec.net<uint16_t>(20);
       selfTestTime=GPSWeekSecond(week, double(sow100)*0.01);
-      week          = decodeVar<uint16_t>(str);
-      sow100        = decodeVar<uint32_t>(str);
+      week          = rec.net<uint16_t>(22);
+      sow100        = rec.net<uint32_t>(24);
       firstPVTTime=GPSWeekSecond(week, double(sow100)*0.01);
-      extFreqStatus = decodeVar<uint16_t>(str);
-      saasmStatusWord  = decodeVar<uint16_t>(str);
+      extFreqStatus = rec.net<uint16_t>(28);
+      saasmStatusWord  = rec.net<uint16_t>(30);
       
       clearstate(fmtbit);
    } // MDPSelftestStatus::decode()
@@ -28,6 +28,7 @@
 //============================================================================
 
 #include "ARLambda.hpp"
+#include "SpecialFunctions.hpp"
 
 
 namespace gpstk
@@ -56,6 +57,13 @@ namespace gpstk
             }
 
             squaredRatio = (S(0)<1e-12) ? 9999.9 : S(1)/S(0);
+
+            numFixed = nw;
+            successRate = 1.0;
+            for(int i=0; i<nw; i++)
+            {
+               successRate *= erf( 0.5/std::sqrt(2.0*wD[i]) );
+            }
             
             return ambFixed;
          }
@@ -77,33 +85,128 @@ namespace gpstk
          // it should never go here, but we sill return the float ambiguities
       return ambFloat;
 
-   }  // End of method 'ARMLambda::resolveIntegerAmbiguity()'
+   }  // End of method 'ARLambda::resolveIntegerAmbiguity()'
 
-   
-   int ARLambda::factorize( const Matrix<double>& Q, 
-                            Matrix<double>& L, 
-                            Vector<double>& D)
+
+   Vector<double> ARLambda::resolvePartialAmbiguity(
+                                               const Vector<double>& ambFloat,
+                                               const Matrix<double>& ambCov,
+                                               double minSuccessRate )
+      throw(ARException)
    {
-      // TODO: CHECK UNEXPECTED INPUT
-      // L:nxn Z:nxn 0<=(i,j)<n
+      // check input
+      if( ambFloat.size()!=ambCov.rows() || ambFloat.size()!=ambCov.cols() )
+      {
+         ARException e("The dimension of input does not match.");
+         GPSTK_THROW(e);
+      }
+
+      if( !(minSuccessRate>0.0 && minSuccessRate<=1.0) )
+      {
+         ARException e("The minimum success rate must be in (0,1].");
+         GPSTK_THROW(e);
+      }
+
+      squaredRatio = 0.0;
+      successRate = 0.0;
+      numFixed = 0;
+
+      if( ambFloat.size()==0 ) return ambFloat;
+
+      if( decorrelate(ambFloat,ambCov)!=0 )
+      {
+         ARException e("The covariance matrix is not positive definite.");
+         GPSTK_THROW(e);
+      }
+
+      const int n = nw;
+
+      // the search fixes z(n-1) first, so the subsets are the trailing
+      // ones: find the largest one with the required success rate
+      int k(n);
+      double ps(1.0);
+      while(k>0)
+      {
+         double p = ps * erf( 0.5/std::sqrt(2.0*wD[k-1]) );
+         if(p<minSuccessRate) break;
+         ps = p;
+         k--;
+      }
+
+      if(k==n) return ambFloat;     // nothing reliable enough to fix
+
+      // Q(k:,k:) = L(k:,k:)'*diag(D(k:))*L(k:,k:), search in it
+      const int nf = n-k;
+      std::vector<double> Lf(nf*nf), zf(nf*2), sf(2);
+      for(int j=0; j<nf; j++)
+      {
+         for(int i=j; i<nf; i++) Lf[i+j*nf] = wL[(k+i)+(k+j)*n];
+      }
+
+      if( search(&Lf[0],&wD[k],&wz[k],nf,&zf[0],&sf[0],2)!=0 )
+      {
+         ARException e("Failed to resolve the integer ambiguities.");
+         GPSTK_THROW(e);
+      }
+
+      // fixed ones, and the float ones conditioned on them
+      std::vector<double> zc(wz), dz(n,0.0);
+      for(int l=n-1; l>=k; l--)
+      {
+         double zb(wz[l]);
+         for(int i=l+1; i<n; i++) zb += dz[i]*wL[i+l*n];
+         zc[l] = zf[l-k];
+         dz[l] = zc[l] - zb;
+      }
+      for(int j=0; j<k; j++)
+      {
+         const double* lj = &wL[j*n];
+         for(int l=k; l<n; l++) zc[j] += dz[l]*lj[l];
+      }
+
+      // back to the original ambiguities, a = Z'\z
+      Vector<double> ambFixed(n, 0.0);
+      for(int j=0; j<n; j++)
+      {
+         const double* zij = &wZi[j*n];
+         const double zj = zc[j];
+         for(int i=0; i<n; i++) ambFixed(i) += zij[i]*zj;
+      }
 
-      const int n = static_cast<int>(Q.rows());
+      squaredRatio = (sf[0]<1e-12) ? 9999.9 : sf[1]/sf[0];
+      successRate = ps;
+      numFixed = nf;
+
+      return ambFixed;
+
+   }  // End of method 'ARLambda::resolvePartialAmbiguity()'
+
+   
+   int ARLambda::factorize( std::vector<double>& Q,
+                            std::vector<double>& L,
+                            std::vector<double>& D,
+                            int n )
+   {
+      // Q is symmetric: work on its upper triangle, whose columns are
+      // contiguous, instead of the rows of the lower one
 
-      Matrix<double> QC(Q);
-      L.resize(n, n, 0.0);
-      D.resize(n, 0.0);
+      L.assign(n*n, 0.0);
+      D.assign(n, 0.0);
 
       for(int i = n-1; i >= 0; i--) 
       {
-         D(i) = QC(i,i);
-         if( D(i) <= 0.0 ) return -1;
-         double temp = std::sqrt(D(i));
-         for(int j=0; j<=i; j++) L(i,j) = QC(i,j)/temp;
-         for(int j=0; j<=i-1; j++) 
+         const double* ai = &Q[i*n];
+         const double d = ai[i];
+         if( d <= 0.0 ) return -1;
+         D[i] = d;
+         for(int j=0; j<i; j++) 
          {
-            for(int k=0; k<=j; k++) QC(j,k) -= L(i,k) * L(i,j);
+            const double f = ai[j]/d;
+            L[i+j*n] = f;
+            double* aj = &Q[j*n];
+            for(int k=0; k<=j; k++) aj[k] -= ai[k]*f;
          }
-         for(int j=0; j<=i; j++) L(i,j) /= L(i,i);
+         L[i+i*n] = 1.0;
       }
 
       return 0;
@@ -111,59 +214,70 @@ namespace gpstk
    }  // End of method 'ARLambda::factorize()'
 
 
-   void ARLambda::gauss(Matrix<double>& L, Matrix<double>& Z, int i, int j)
+   void ARLambda::gauss(int i, int j)
    {
-      //TODO: CHECK UNEXPECTED INPUT
-      // L:nxn Z:nxn 0<=(i,j)<n
+      // L:nxn Zi:nxn z:n 0<=j<i<n
 
-      const int n = L.rows();
-      const int mu = (int)round(L(i,j));
-      if(mu != 0) 
+      const int n = nw;
+      double* Li = &wL[i*n];
+      double* Lj = &wL[j*n];
+      const double mu = round(Lj[i]);
+      if(mu != 0.0) 
       {
-         for(int k=i; k<n; k++) L(k,j) -= (double)mu*L(k,i);
-         for(int k=0; k<n; k++) Z(k,j) -= (double)mu*Z(k,i);
+         for(int k=i; k<n; k++) Lj[k] -= mu*Li[k];
+
+         wz[j] -= mu*wz[i];
+
+            // inverse of Z': column i += mu * column j
+         double* Yi = &wZi[i*n];
+         double* Yj = &wZi[j*n];
+         for(int k=0; k<n; k++) Yi[k] += mu*Yj[k];
       }
+
    }  // End of method 'ARLambda::gauss()'
 
    
-   void ARLambda::permute( Matrix<double>& L, 
-                           Vector<double>& D, 
-                           int j, 
-                           double del, 
-                           Matrix<double>& Z )
+   void ARLambda::permute(int j, double del)
    {  
-      //TODO: CHECK UNEXPECTED INPUT
-      // L:nxn D:nx1 Z:nxn 0<=j<n
+      // L:nxn D:n Zi:nxn z:n 0<=j<n-1
 
-      const int n = L.rows();
+      const int n = nw;
+      double* L = &wL[0];
+      double* D = &wD[0];
 
-      double eta=D(j)/del;
-      double lam=D(j+1)*L(j+1,j)/del;
+      const double l = L[(j+1)+j*n];
+      const double eta = D[j]/del;
+      const double lam = D[j+1]*l/del;
 
-      D[j]=eta*D(j+1); 
-      D(j+1)=del;
-      for(int k=0;k<=j-1;k++) 
+      D[j] = eta*D[j+1]; 
+      D[j+1] = del;
+      for(int k=0; k<=j-1; k++) 
       {
-         double a0=L(j,k); 
-         double a1=L(j+1,k);
-         L(j,k) =-L(j+1,j)*a0 + a1;
-         L(j+1,k) = eta*a0 + lam*a1;
+         double a0 = L[j+k*n]; 
+         double a1 = L[(j+1)+k*n];
+         L[j+k*n] = -l*a0 + a1;
+         L[(j+1)+k*n] = eta*a0 + lam*a1;
       }
-      L(j+1,j)=lam;
-      for(int k=j+2; k<n; k++) swap(L(k,j),L(k,j+1));
-      for(int k=0; k<n; k++) swap(Z(k,j),Z(k,j+1));
+      L[(j+1)+j*n] = lam;
+
+      double* Lj = &L[j*n];
+      double* Lj1 = &L[(j+1)*n];
+      for(int k=j+2; k<n; k++) swap(Lj[k],Lj1[k]);
+
+      swap(wz[j],wz[j+1]);
+
+      double* Yj = &wZi[j*n];
+      double* Yj1 = &wZi[(j+1)*n];
+      for(int k=0; k<n; k++) swap(Yj[k],Yj1[k]);
 
    }  // End of method 'ARLambda::permute()'
 
    
-   void ARLambda::reduction( Matrix<double>& L, 
-                             Vector<double>& D,
-                             Matrix<double>& Z)
+   void ARLambda::reduction()
    {
-      //TODO: CHECK UNEXPECTED INPUT
-      // L:nxn D:nx1 Z:nxn 0<=j<n
+      // L:nxn D:n Zi:nxn z:n
 
-      const int n = L.rows();
+      const int n = nw;
 
       int j(n-2), k(n-2);
       while(j>=0) 
@@ -172,15 +286,16 @@ namespace gpstk
          {
             for (int i=j+1; i<n; i++) 
             {
-               gauss(L,Z,i,j);
+               gauss(i,j);
             }
          } 
 
-         double del=D(j)+L(j+1,j)*L(j+1,j)*D(j+1);
+         const double l = wL[(j+1)+j*n];
+         const double del = wD[j] + l*l*wD[j+1];
 
-         if(del+1E-6<D(j+1)) 
+         if(del+1E-6<wD[j+1]) 
          { 
-            permute(L,D,j,del,Z);
+            permute(j,del);
             k=j; j=n-2;
          }
          else
@@ -193,76 +308,92 @@ namespace gpstk
    }  // End of method 'ARLambda::reduction()'
 
 
-   int ARLambda::search( const Matrix<double>& L, 
-                         const Vector<double>& D, 
-                         const Vector<double>& zs, 
-                         Matrix<double>& zn, 
-                         Vector<double>& s, 
-                          const int& m )
+   int ARLambda::search( const double* L,
+                         const double* D,
+                         const double* zs,
+                         int n,
+                         double* zn,
+                         double* s,
+                         int m )
    {
-
-      ARException e("The LAMBDA search method have not been implemented.");
-      GPSTK_THROW(e);
-
-      // TODO: CHECK UNEXPECTED INPUT
       // n - number of float parameters
       // m - number of fixed solutions
-      // L - nxn
-      // D - nx1
-      // zs - nxn
-      // zn - nxm
+      // L - nxn, column-major
+      // D - n
+      // zs - n
+      // zn - nxm, column-major
       // s  - m
-      const int LOOPMAX = 10000;
-      const int n = L.rows();
-
-      zn.resize(n,m,0.0);
-      s.resize(m,0.0);
 
-      Matrix<double> S(n,n,0.0);
-      Vector<double> dist(n,0.0),zb(n,0.0),z(n,0.0),step(n,0.0);
+      // P(j,i) = sum_{l>=j} (z(l)-zb(l))*L(l,i), j>i, (n+1) x n
+      // column-major, so that zb(i) = zs(i) + P(i+1,i). A column is only
+      // computed again from the highest level that changed since it was
+      // last computed, r(i), instead of from scratch at every level.
+      const int np(n+1);
+      wP.assign(np*n, 0.0);
+      wr.assign(n, n-1);
+      wdist.assign(n, 0.0);
+      wzb.assign(n, 0.0);
+      wzc.assign(n, 0.0);
+      wstep.assign(n, 0.0);
+
+      double* P = &wP[0];
+      int* r = &wr[0];
+      double* dist = &wdist[0];
+      double* zb = &wzb[0];
+      double* z = &wzc[0];
+      double* step = &wstep[0];
+
+      for(int i=0; i<n*m; i++) zn[i] = 0.0;
+      for(int i=0; i<m; i++) s[i] = 0.0;
 
       int k=n-1; dist[k]=0.0;
-      zb(k)=zs(k);
-      z(k)=round(zb(k)); 
-      double y=zb(k)-z(k); 
-      step(k)=sign(y);
+      zb[k]=zs[k];
+      z[k]=round(zb[k]); 
+      double y=zb[k]-z[k]; 
+      step[k]=sign(y);
 
       int c(0),nn(0),imax(0);
       double maxdist=1E99;
-      for(int c=0;c<LOOPMAX;c++)
+      for(c=0; c<searchLoopLimit; c++)
       {
-         double newdist=dist(k)+y*y/D(k);
+         double newdist=dist[k]+y*y/D[k];
          if(newdist<maxdist) 
          {
             if(k!=0) 
             {
-               dist(--k)=newdist;
-               for(int i=0;i<=k;i++)
+               dist[--k]=newdist;
+               if(k>0 && r[k-1]<r[k]) r[k-1]=r[k];
+               double* pk = &P[k*np];
+               const double* lk = &L[k*n];
+               for(int j=r[k];j>k;j--)
                {
-                  S(k,i)=S(k+1,i)+(z(k+1)-zb(k+1))*L(k+1,i);
+                  pk[j]=pk[j+1]+(z[j]-zb[j])*lk[j];
                }
-               zb(k)=zs(k)+S(k,k);
-               z(k)=round(zb(k)); y=zb(k)-z(k); step(k)=sign(y);
+               r[k]=k;
+               zb[k]=zs[k]+pk[k+1];
+               z[k]=round(zb[k]); y=zb[k]-z[k]; step[k]=sign(y);
+               if(k>0 && r[k-1]<k) r[k-1]=k;
             }
             else 
             {
                if(nn<m) 
                {
-                  if(nn==0||newdist>s(imax)) imax=nn;
-                  for(int i=0;i<n;i++) zn(i,nn)=z(i);
-                  s(nn++)=newdist;
+                  if(nn==0||newdist>s[imax]) imax=nn;
+                  for(int i=0;i<n;i++) zn[i+nn*n]=z[i];
+                  s[nn++]=newdist;
                }
                else 
                {
-                  if(newdist<s(imax)) 
+                  if(newdist<s[imax]) 
                   {
-                     for(int i=0;i<n;i++) zn(i,imax)=z(i);
-                     s(imax)=newdist;
-                     for(int i=imax=0;i<m;i++) if (s(imax)<s(i)) imax=i;
+                     for(int i=0;i<n;i++) zn[i+imax*n]=z[i];
+                     s[imax]=newdist;
+                     for(int i=imax=0;i<m;i++) if (s[imax]<s[i]) imax=i;
                   }
-                  maxdist=s(imax);
+                     // shrink the ellipsoid to the m-th best candidate
+                  maxdist=s[imax];
                }
-               z(0)+=step(0); y=zb(0)-z(0); step(0)=-step(0)-sign(step(0));
+               z[0]+=step[0]; y=zb[0]-z[0]; step[0]=-step[0]-sign(step[0]);
             }
          }
          else 
@@ -271,7 +402,8 @@ namespace gpstk
             else 
             {
                k++;
-               z(k)+=step(k); y=zb(k)-z(k); step(k)=-step(k)-sign(step(k));
+               z[k]+=step[k]; y=zb[k]-z[k]; step[k]=-step[k]-sign(step[k]);
+               if(r[k-1]<k) r[k-1]=k;
             }
          }
       }
@@ -279,13 +411,13 @@ namespace gpstk
       { 
          for(int j=i+1;j<m;j++) 
          {
-            if(s(i)<s(j)) continue;
-            swap(s(i),s(j));
-            for(k=0;k<n;k++) swap(zn(k,i),zn(k,j));
+            if(s[i]<s[j]) continue;
+            swap(s[i],s[j]);
+            for(k=0;k<n;k++) swap(zn[k+i*n],zn[k+j*n]);
          }
       }
 
-      if (c>=LOOPMAX) 
+      if (c>=searchLoopLimit) 
       {
          return -1;
       }
@@ -295,6 +427,34 @@ namespace gpstk
    }  // End of method 'ARLambda::search()'
 
 
+   int ARLambda::decorrelate( const Vector<double>& a,
+                              const Matrix<double>& Q )
+   {
+      const int n = static_cast<int>(a.size());
+      nw = n;
+
+      std::vector<double> A(n*n);
+      for(int j=0; j<n; j++)
+      {
+         for(int i=0; i<=j; i++) A[i+j*n] = Q(i,j);
+      }
+
+      if( factorize(A,wL,wD,n)!=0 ) return -1;
+
+      // z = Z'*a is transformed with L
+      wz.resize(n);
+      for(int i=0; i<n; i++) wz[i] = a(i);
+
+      wZi.assign(n*n, 0.0);
+      for(int i=0; i<n; i++) wZi[i+i*n] = 1.0;
+
+      reduction();
+
+      return 0;
+
+   }  // End of method 'ARLambda::decorrelate()'
+
+
    int ARLambda::lambda( const Vector<double>& a, 
                          const Matrix<double>& Q, 
                          Matrix<double>& F,
@@ -302,27 +462,26 @@ namespace gpstk
                          const int& m )
    {
       if( (a.size()!=Q.rows()) || (Q.rows()!=Q.cols()) ) return -1;
-      if( m < 1) return -1;
+      if( m < 1 || a.size() < 1 ) return -1;
 
       const int n = static_cast<int>(a.size());
 
-      Matrix<double> L(n,n,0.0),E(n,m,0.0);
-      Vector<double> D(n,0.0),z(n,0.0);
-      Matrix<double> Z = ident<double>(n);
+      if( decorrelate(a,Q)!=0 ) return -1;
 
-      if (factorize(Q,L,D)==0) 
-      {      
-         reduction(L,D,Z);
-         z = transpose(Z)*a;
+      std::vector<double> E(n*m), sv(m);
+      if( search(&wL[0],&wD[0],&wz[0],n,&E[0],&sv[0],m)!=0 ) return -1;
 
-         if (search(L,D,z,E,s,m)==0) 
+      // F=Z'\E, with the inverse of Z' kept by the reduction
+      F.resize(n,m,0.0);
+      s.resize(m,0.0);
+      for(int c=0; c<m; c++)
+      {
+         s(c) = sv[c];
+         for(int i=0; i<n; i++)
          {
-            try
-            {  // F=Z'\E - Z nxn  E nxm F nxm
-               F = transpose( inverseLUD(Z) ) * E;
-            }
-            catch(...) 
-            { return -1; }
+            double sum(0.0);
+            for(int j=0; j<n; j++) sum += wZi[i+j*n]*E[j+c*n];
+            F(i,c) = sum;
          }
       }
 
@@ -332,4 +491,3 @@ namespace gpstk
 
 
 }   // End of namespace gpstk
-
@@ -30,6 +30,7 @@
 //
 //============================================================================
 
+#include <vector>
 #include "ARBase.hpp"
 
 namespace gpstk
@@ -41,13 +42,37 @@ namespace gpstk
        *   P.J.G.Teunissen, The least-square ambiguity decorrelation adjustment:
        *   a method for fast GPS ambiguity estimation, J.Geodesy, Vol.70, 65-82,
        *   1995
+       *
+       * The integer search is that of the modified LAMBDA method (see
+       * ARMLambda), which shrinks the search ellipsoid to the m-th best
+       * candidate found so far.
+       *
+       * The L'DL factorization, the decorrelation and the search work on
+       * contiguous arrays, column by column. The decorrelation transforms
+       * the float ambiguities and the inverse of the transpose of Z as it
+       * goes, so that neither Z nor a matrix inversion is needed.
+       *
+       * Besides the full resolution of resolveIntegerAmbiguity(), the
+       * partial ambiguity resolution of resolvePartialAmbiguity() fixes only
+       * the decorrelated ambiguities whose bootstrapped success rate is high
+       * enough, which is useful when there are many ambiguities (network
+       * solutions) and some of them are still poorly determined.
+       *
+       * @code
+       *   ARLambda ar;
+       *   Vector<double> fixed = ar.resolvePartialAmbiguity(amb, cov, 0.999);
+       *   if( ar.numFixed > 0 && ar.isFixedSuccessfully(3.0) ) { ... }
+       * @endcode
        */
    class ARLambda : public ARBase
    {
    public:
       
          /// Default constructor
-      ARLambda() : squaredRatio(0.0) {}      
+      ARLambda()
+         : squaredRatio(0.0), successRate(0.0), numFixed(0),
+           searchLoopLimit(1000000)
+      {}
       
 
          /// Integer Ambiguity Resolution method
@@ -55,6 +80,27 @@ namespace gpstk
                                                 const Vector<double>& ambFloat, 
                                                 const Matrix<double>& ambCov )
          throw(ARException);
+
+
+         /** Partial ambiguity resolution: after decorrelation, only the
+          *  largest subset of the decorrelated ambiguities (in the order of
+          *  the search) whose bootstrapped success rate is at least
+          *  'minSuccessRate' is fixed, by integer least squares; the other
+          *  ones are adjusted to the fixed ones.
+          *
+          * @param ambFloat         Float ambiguities
+          * @param ambCov           Covariance of the float ambiguities
+          * @param minSuccessRate   Minimum success rate of the fixed subset,
+          *                         in (0,1]; anything else throws
+          *
+          * @return The ambiguities, conditioned on the fixed subset; they are
+          *         all integers only if numFixed equals their number, and
+          *         are the float ones if numFixed is 0.
+          */
+      Vector<double> resolvePartialAmbiguity( const Vector<double>& ambFloat,
+                                              const Matrix<double>& ambCov,
+                                              double minSuccessRate = 0.999 )
+         throw(ARException);
       
 
          /// Destractor
@@ -65,8 +111,20 @@ namespace gpstk
       { return (squaredRatio>threshhold)?true:false; }
       
 
+         /// Ratio of the second best to the best squared norm of the last
+         /// resolution
       double squaredRatio;
 
+         /// Bootstrapped success rate of the ambiguities fixed by the last
+         /// resolution
+      double successRate;
+
+         /// Number of (decorrelated) ambiguities fixed by the last resolution
+      int numFixed;
+
+         /// Limit on the number of steps of the integer search
+      int searchLoopLimit;
+
    protected:
 
       double sign(double x)
@@ -81,37 +139,46 @@ namespace gpstk
       { double t(a); a = b; b = t; }
 
 
-         // Q = L'*diag(D)*L
-      int factorize( const Matrix<double>& Q,
-                     Matrix<double>& L, 
-                     Vector<double>& D );
+         /** Q = L'*diag(D)*L, with L unit lower triangular.
+          *  Q, L: n x n column-major arrays; Q is used as work space.
+          *  Returns -1 if Q is not positive definite.
+          */
+      int factorize( std::vector<double>& Q,
+                     std::vector<double>& L,
+                     std::vector<double>& D,
+                     int n );
 
 
-         /// integer gauss transformation
-      void gauss(Matrix<double>& L, Matrix<double>& Z, int i, int j );
+         /// integer gauss transformation of column j by column i (i>j)
+      void gauss(int i, int j);
 
 
-         /// permutations
-      void permute( Matrix<double>& L, 
-                    Vector<double>& D, 
-                    int j, 
-                    double del, 
-                    Matrix<double>& Z);
+         /// permutation of the columns j and j+1
+      void permute(int j, double del);
 
 
-         /// lambda reduction (z=Z'*a, Qz=Z'*Q*Z=L'*diag(D)*L)
-      void reduction( Matrix<double>& L, 
-                      Vector<double>& D, 
-                      Matrix<double>& Z );
+         /// lambda reduction (z=Z'*a, Qz=Z'*Q*Z=L'*diag(D)*L) of the work
+         /// arrays L, D, z and Zi
+      void reduction();
 
 
-         // modified lambda (mlambda) search
-      virtual int search( const Matrix<double>& L, 
-                          const Vector<double>& D, 
-                          const Vector<double>& zs, 
-                          Matrix<double>& zn, 
-                          Vector<double>& s, 
-                          const int& m = 2 );
+         /** modified lambda (mlambda) search of the m best integer vectors
+          *  of the problem (L,D,zs) of size n.
+          * @param L    n x n column-major, unit lower triangular
+          * @param D    n
+          * @param zs   n, float (decorrelated) ambiguities
+          * @param zn   n x m column-major, the candidates, best first
+          * @param s    m, their squared norms, smallest first
+          * @return 0 if ok, -1 if the loop limit was reached
+          */
+      virtual int search( const double* L,
+                          const double* D,
+                          const double* zs,
+                          int n,
+                          double* zn,
+                          double* s,
+                          int m );
+
 
          // lambda/mlambda integer least-square estimation
          // a     Float parameters (n x 1)
@@ -125,10 +192,31 @@ namespace gpstk
                   Matrix<double>& F, 
                   Vector<double>& s, 
                   const int& m = 2 );
-      
-   protected:
+
+
+         /// Decorrelate the problem (a,Q) into the work arrays; z = Z'*a.
+         /// Returns -1 if Q is not positive definite.
+      int decorrelate( const Vector<double>& a,
+                       const Matrix<double>& Q );
 
       
+         /// Size of the problem in the work arrays
+      int nw;
+
+         /// Work arrays, n x n column-major: L of Z'QZ=L'DL, and the
+         /// inverse of Z' (so that a = Zi*z)
+      std::vector<double> wL, wZi;
+
+         /// Work arrays: D, and the decorrelated float ambiguities z
+      std::vector<double> wD, wz;
+
+         /// Work arrays of search(): partial sums, (n+1) x n column-major,
+         /// and the levels they must be computed again from
+      std::vector<double> wP;
+      std::vector<int> wr;
+
+         /// Work arrays of search(), n
+      std::vector<double> wdist, wzb, wzc, wstep;
          
    };   // End of class 'ARLambda'
    
@@ -136,4 +224,3 @@ namespace gpstk
 
 
 #endif  //GPSTK_ARLAMBDA_HPP
-
@@ -41,6 +41,8 @@ namespace gpstk
        *   X.-W.Chang, X.Yang, T.Zhou, MLAMBDA: A modified LAMBDA method for
        *   integer least-squares estimation, J.Geodesy, Vol.79, 552-565, 2005
        *
+       * The search with the shrinking ellipsoid of MLAMBDA is now the one of
+       * ARLambda, so this class is kept for the code that uses it.
        */
    class ARMLambda : public ARLambda  
    {
@@ -52,16 +54,6 @@ namespace gpstk
 
          /// Destractor
       virtual ~ARMLambda(){}
-      
-   protected:
-
-         /// modified lambda (mlambda) search
-      virtual int search( const Matrix<double>& L, 
-                          const Vector<double>& D, 
-                          const Vector<double>& zs, 
-                          Matrix<double>& zn, 
-                          Vector<double>& s, 
-                          const int& m = 2 );
          
    };   // End of class 'ARMLambda'
    
@@ -70,4 +62,3 @@ namespace gpstk
 
 
 #endif  //GPSTK_ARMLAMBDA_HPP
-
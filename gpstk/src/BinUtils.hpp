@@ -61,6 +61,8 @@
 #include <sys/machine.h>
 #endif
 
+#include <cstring>
+
 #include "Exception.hpp"
 
 #ifndef BYTE_ORDER
@@ -170,34 +172,138 @@ namespace gpstk
          return temp;
       }
 
+         /**
+          * Byte reversal of an unsigned integer of N bytes, chosen by size
+          * at compile time. The shifts compile to a single byte swap
+          * instruction where there is one, where twiddle() is a loop.
+          */
+      template <size_t N> struct ByteSwap;
+
+      template <> struct ByteSwap<1>
+      {
+         typedef uint8_t Word;
+         static Word swap(Word w) throw() { return w; }
+      };
+
+      template <> struct ByteSwap<2>
+      {
+         typedef uint16_t Word;
+         static Word swap(Word w) throw()
+            { return Word((w >> 8) | (w << 8)); }
+      };
+
+      template <> struct ByteSwap<4>
+      {
+         typedef uint32_t Word;
+         static Word swap(Word w) throw()
+            { return (w >> 24) | ((w >> 8) & 0xff00) |
+                 ((w << 8) & 0xff0000) | (w << 24); }
+      };
+
+      template <> struct ByteSwap<8>
+      {
+         typedef uint64_t Word;
+         static Word swap(Word w) throw()
+            { return (Word(ByteSwap<4>::swap(uint32_t(w))) << 32) |
+                 ByteSwap<4>::swap(uint32_t(w >> 32)); }
+      };
+
+         /**
+          * Decode a T, of 1, 2, 4 or 8 bytes, stored in network byte
+          * order at p, which need not be aligned. Whether to swap is
+          * decided at compile time.
+          */
+      template <class T> T decodeNet(const char* p)
+         throw()
+      {
+         typename ByteSwap<sizeof(T)>::Word w;
+         std::memcpy(&w, p, sizeof(T));
+#if BYTE_ORDER == LITTLE_ENDIAN
+         w = ByteSwap<sizeof(T)>::swap(w);
+#endif
+         T t;
+         std::memcpy(&t, &w, sizeof(T));
+         return t;
+      }
+
+         /**
+          * Decode a T, of 1, 2, 4 or 8 bytes, stored in Intel
+          * (little-endian) byte order at p, which need not be aligned.
+          */
+      template <class T> T decodeIntel(const char* p)
+         throw()
+      {
+         typename ByteSwap<sizeof(T)>::Word w;
+         std::memcpy(&w, p, sizeof(T));
+#if BYTE_ORDER == BIG_ENDIAN
+         w = ByteSwap<sizeof(T)>::swap(w);
+#endif
+         T t;
+         std::memcpy(&t, &w, sizeof(T));
+         return t;
+      }
+
          /** 
           * Remove (optinally) the item specified from the string and convert it
           * from network byte order to host byte order.
           * @param str the string from which to obtain data.
           * @param pos an offset into the string to pull the data from. If this
           * value is specified, the item is not removed from the string.
-          * @warn This function does not check for appropriate string length.
+          * @warn This function does not check for appropriate string length:
+          * nothing is read past the end of the string, but the bytes of the
+          * item that are not there are taken as zero (and a pos past the end
+          * throws std::out_of_range). The caller should check that the string
+          * holds sizeof(T) bytes at pos.
           */
       template <class T>
       T decodeVar( std::string& str, std::string::size_type pos = std::string::npos)
       {
+         std::string::size_type start = (pos == std::string::npos ? 0 : pos);
          T t;
-         char *cp = reinterpret_cast<char*>( &t );
-
-         if (pos == std::string::npos)
-         {
-            str.copy( cp, sizeof(T) );
-            t = gpstk::BinUtils::netToHost( t );
-            str.erase( 0, sizeof(T) );
-         }
+         if (start <= str.size() && str.size() - start >= sizeof(T))
+            t = decodeNet<T>(str.data() + start);
          else
          {
-            str.copy( cp, sizeof(T) , pos);
-            t = gpstk::BinUtils::netToHost( t );
+            char buf[sizeof(T)];
+            std::memset(buf, 0, sizeof(T));
+            str.copy(buf, sizeof(T), start);
+            t = decodeNet<T>(buf);
          }
+
+         if (pos == std::string::npos)
+            str.erase( 0, sizeof(T) );
          return t;
       }
 
+         /**
+          * A binary record held in memory, in a string or in the map of an
+          * FFBinaryStream, whose fields are decoded where they lie instead
+          * of being copied or removed from the front of a string one by
+          * one. Unlike decodeVar(), nothing here checks the length of the
+          * record: the caller must see that the size bytes hold every field
+          * it decodes, sizeof(T) bytes at pos.
+          */
+      class RecordView
+      {
+      public:
+         RecordView(const char* data, size_t size) throw()
+            : data(data), size(size) {}
+
+         RecordView(const std::string& str) throw()
+            : data(str.data()), size(str.size()) {}
+
+            /// The T at offset pos, in network byte order
+         template <class T> T net(size_t pos) const throw()
+            { return decodeNet<T>(data + pos); }
+
+            /// The T at offset pos, in Intel byte order
+         template <class T> T intel(size_t pos) const throw()
+            { return decodeIntel<T>(data + pos); }
+
+         const char* data;
+         size_t size;
+      };
+
          /** 
           * Add the network ordered binary representation of a var to the
           * the given string.
@@ -0,0 +1,381 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file BinexBatchReader.cpp
+ * Reads BINEX records a batch at a time, decoding them in parallel
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "BinexBatchReader.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   // -------------------------------------------------------------------------
+   BinexBatchReader::BinexBatchReader(BinexStream&  strm,
+                                      unsigned int  nthreads,
+                                      size_t        batchSize)
+      throw(Exception)
+         : strm(strm), batchSize(batchSize ? batchSize : 1),
+           count(0), next(0), decoded(0), heldFrom(0), scanFailed(false),
+           pool(NULL)
+   {
+      if (nthreads == 0)
+      {
+         nthreads = ThreadPool::processorCount();
+      }
+      tasks.resize(nthreads);
+      for (size_t i = 0; i < tasks.size(); i++)
+      {
+         tasks[i].reader = this;
+      }
+      if (nthreads > 1)
+      {
+         pool = new ThreadPool(nthreads);
+      }
+   }
+
+   // -------------------------------------------------------------------------
+   BinexBatchReader::~BinexBatchReader()
+   {
+      delete pool;
+   }
+
+   // -------------------------------------------------------------------------
+   size_t
+   BinexBatchReader::read(std::vector<BinexData>& recs)
+      throw(FFStreamError)
+   {
+      size_t n;
+      if (next == decoded)
+      {
+         if ( (next == count) && !scanFailed)
+         {
+            fill();
+         }
+         if (next == count)
+         {
+            if (scanFailed)
+            {
+               scanFailed = false;
+               FFStreamError err(scanError);
+               GPSTK_THROW(err);
+            }
+            return 0;
+         }
+
+         decode(recs);
+         decoded = count;
+         if (failures.empty() )
+         {
+            n = count - next;
+            next = count;
+            strm.recordNumber += n;
+            return n;
+         }
+
+            // Hold what follows the first bad record until it is thrown,
+            // and return the records before it
+         size_t bad = failures.begin()->first;
+         if (held.size() < count - bad)
+         {
+            held.resize(count - bad);
+         }
+         heldFrom = bad;
+         for (size_t i = bad; i < count; i++)
+         {
+            swapRecords(recs[i - next], held[i - bad]);
+         }
+         if (bad > next)
+         {
+            n = bad - next;
+            next = bad;
+            strm.recordNumber += n;
+            return n;
+         }
+      }
+
+         // The bad record, or the records held up to the next one
+      std::map<size_t, FFStreamError>::iterator bad = failures.begin();
+      if ( (bad != failures.end() ) && (bad->first == next) )
+      {
+         FFStreamError err(bad->second);
+         failures.erase(bad);
+         next++;
+         GPSTK_THROW(err);
+      }
+
+      n = ( (bad == failures.end() ) ? decoded : bad->first) - next;
+      if (recs.size() < n)
+      {
+         recs.resize(n);
+      }
+      for (size_t i = 0; i < n; i++)
+      {
+         swapRecords(recs[i], held[next + i - heldFrom]);
+      }
+      next += n;
+      strm.recordNumber += n;
+      return n;
+   }
+
+   // -------------------------------------------------------------------------
+   void
+   BinexBatchReader::decode(std::vector<BinexData>& recs)
+   {
+      size_t n = count - next;
+      if (recs.size() < n)
+      {
+         recs.resize(n);
+      }
+
+         // Give each task a run of records holding about as many bytes
+      size_t ntasks = std::min(tasks.size(), n);
+      size_t begin  = starts[next];
+      size_t bytes  = starts[count] - begin;
+      size_t first  = next;
+      for (size_t i = 0; i < ntasks; i++)
+      {
+         DecodeTask& t = tasks[i];
+         size_t last = count;
+         if (i + 1 < ntasks)
+         {
+            size_t split = begin + bytes * (i + 1) / ntasks;
+            size_t from  = std::min(first + 1, count);
+            last = std::lower_bound(starts.begin() + from,
+                                    starts.begin() + count,
+                                    split) - starts.begin();
+         }
+         t.recs   = &recs;
+         t.first  = first;
+         t.last   = last;
+         t.out    = first - next;
+         t.failures.clear();
+         first    = last;
+      }
+
+      if (pool && ntasks > 1)
+      {
+         for (size_t i = 0; i < ntasks; i++)
+         {
+            pool->submit(&tasks[i]);
+         }
+         pool->wait();
+      }
+      else
+      {
+         tasks[0].run();
+      }
+
+      for (size_t i = 0; i < ntasks; i++)
+      {
+         failures.insert(tasks[i].failures.begin(), tasks[i].failures.end() );
+      }
+   }
+
+   // -------------------------------------------------------------------------
+   void
+   BinexBatchReader::swapRecords(BinexData& a, BinexData& b)
+   {
+      std::swap(a.syncByte, b.syncByte);
+      std::swap(a.recID, b.recID);
+      a.msg.swap(b.msg);
+   }
+
+   // -------------------------------------------------------------------------
+   void
+   BinexBatchReader::DecodeTask::run()
+      throw()
+   {
+         // A bad record does not stop the run: the ones after it are
+         // held by read() until it has been thrown.
+      for (size_t i = first; i < last; i++)
+      {
+         try
+         {
+            size_t start = reader->starts[i];
+            (*recs)[out + i - first].decodeRecord(
+               &reader->batch[start], reader->starts[i + 1] - start, scratch);
+         }
+         catch (FFStreamError& e)
+         {
+            failures.push_back(std::make_pair(i, e) );
+         }
+         catch (std::exception& e)
+         {
+            failures.push_back(std::make_pair(i, FFStreamError(e.what() ) ) );
+         }
+      }
+   }
+
+   // -------------------------------------------------------------------------
+   void
+   BinexBatchReader::fill()
+      throw(FFStreamError)
+   {
+      batch.clear();
+      starts.clear();
+      failures.clear();
+      count = next = decoded = 0;
+
+         // Keep a failed stream failed, as getRecord() would
+      if (!strm.fail() )
+      {
+         while (count < batchSize)
+         {
+            size_t start = batch.size();
+            bool   more  = false;
+            try
+            {
+               more = scanRecord();
+            }
+            catch (FFStreamError& e)
+            {
+               scanError  = e;
+               scanFailed = true;
+               try
+               {
+                  strm.setstate(std::ios::failbit);
+               }
+               catch (std::exception&)
+               {
+                     // The stream throws on failure; scanError is thrown
+               }
+            }
+            if (!more)
+            {
+               batch.resize(start);
+               break;
+            }
+            starts.push_back(start);
+            count++;
+         }
+      }
+      starts.push_back(batch.size() );
+   }
+
+   // -------------------------------------------------------------------------
+   bool
+   BinexBatchReader::scanRecord()
+      throw(FFStreamError)
+   {
+      size_t start = batch.size();
+      if (!take(1) )
+      {
+         return false;
+      }
+
+      unsigned char sync = batch[start];
+      unsigned char expectedSyncByte;
+      size_t        rest = 0;
+
+      if (framer.isHeadSyncByteValid(sync, expectedSyncByte) )
+      {
+         bool   littleEndian = (sync & BinexData::eBigEndian) == 0;
+         takeUBNXI(littleEndian);
+         unsigned long msgLen = takeUBNXI(littleEndian);
+         size_t dataLen = batch.size() - start - 1 + msgLen;
+
+            // getCRC() writes no CRC where getCRCLength() counts an MD5
+         framer.syncByte = sync;
+         size_t crcLen = (dataLen >= 1048576) ? 0
+                                              : framer.getCRCLength(dataLen);
+         rest = msgLen + crcLen;
+         if (sync & BinexData::eReverseReadable)
+         {
+            BinexData::UBNXI recLen(1 + dataLen + crcLen);
+            rest += recLen.getSize() + 1;
+         }
+      }
+      else if (framer.isTailSyncByteValid(sync, expectedSyncByte) )
+      {
+            // The length of the reversed record follows its tail
+         rest = takeUBNXI( (expectedSyncByte & BinexData::eBigEndian) == 0);
+      }
+      else
+      {
+         std::ostringstream errStrm;
+         errStrm << "Invalid BINEX synchronization byte: "
+                 << static_cast<uint16_t>(sync);
+         FFStreamError err(errStrm.str() );
+         GPSTK_THROW(err);
+      }
+
+      if (!take(rest) )
+      {
+         FFStreamError err("Incomplete BINEX record message");
+         GPSTK_THROW(err);
+      }
+      return true;
+   }
+
+   // -------------------------------------------------------------------------
+   unsigned long
+   BinexBatchReader::takeUBNXI(bool littleEndian)
+      throw(FFStreamError)
+   {
+      size_t start = batch.size();
+      do
+      {
+         if (!take(1) )
+         {
+            FFStreamError err("Error reading BINEX UBNXI");
+            GPSTK_THROW(err);
+         }
+      } while ( (batch.back() & 0x80)
+              && (batch.size() - start < BinexData::UBNXI::MAX_BYTES) );
+
+      BinexData::UBNXI u;
+      u.decode(&batch[start], batch.size() - start, littleEndian);
+      return (unsigned long)u;
+   }
+
+   // -------------------------------------------------------------------------
+   bool
+   BinexBatchReader::take(size_t length)
+   {
+      if (length == 0)
+      {
+         return true;
+      }
+      const char* p;
+      try
+      {
+         p = strm.getView(length);
+      }
+      catch (EndOfFile& e)
+      {
+         return false;
+      }
+      if (!p)
+      {
+         return false;
+      }
+      batch.insert(batch.end(), p, p + length);
+      return true;
+   }
+
+}  // namespace gpstk
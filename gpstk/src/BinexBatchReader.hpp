@@ -0,0 +1,208 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file BinexBatchReader.hpp
+ * Reads BINEX records a batch at a time, decoding them in parallel
+ */
+
+#ifndef GPSTK_BINEXBATCHREADER_HPP
+#define GPSTK_BINEXBATCHREADER_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "BinexData.hpp"
+#include "BinexStream.hpp"
+
+namespace gpstk
+{
+   /** @addtogroup Binex */
+   //@{
+
+      /**
+       * This class reads the records of a BinexStream a batch at a time.
+       * Each BINEX record carries its own length, so the reader only
+       * follows the synchronization bytes and lengths to find where each
+       * record ends, copying the batch into one buffer; the records are
+       * then decoded, and their CRCs checked, by a pool of threads, each
+       * taking a run of consecutive records. The records come back in
+       * the order of the stream, the same as getRecord() reads them.
+       *
+       * Records that begin with their tail synchronization byte are taken
+       * as getRecord() takes them. A reverse-readable record read from its
+       * head is read to the end of its tail, which is checked.
+       *
+       * The stream is read ahead by up to a batch, so it should not be
+       * read otherwise while a reader is using it.
+       *
+       * @sa binex_batch_bench.cpp for an example.
+       * @sa BinexBatchWriter.
+       */
+   class BinexBatchReader
+   {
+   public:
+         /**
+          * Constructor
+          * @param strm      The stream to read
+          * @param nthreads  Decoding threads; 0 means one per processor
+          * @param batchSize Most records read from the stream at once
+          * @throw Exception if the threads cannot be started
+          */
+      BinexBatchReader(BinexStream& strm,
+                       unsigned int nthreads  = 0,
+                       size_t       batchSize = 4096)
+         throw(Exception);
+
+         /// Destructor
+      ~BinexBatchReader();
+
+         /**
+          * Reads the next records of the stream into the front of \a recs,
+          * in order, and returns how many; 0 at the end of the stream.
+          * \a recs is grown as needed but never shrunk, so the message
+          * buffers of its records are reused from one call to the next.
+          *
+          * A record with a bad CRC ends the records returned before it and
+          * is thrown by the next call; the call after that continues with
+          * the record following it, the rest of the batch having been
+          * decoded already. A record that cannot be framed (a bad
+          * synchronization byte, or the stream ending inside it) is thrown
+          * the same way, but leaves the stream failed.
+          *
+          * @throw FFStreamError as described above
+          */
+      size_t
+      read(std::vector<BinexData>& recs)
+         throw(FFStreamError);
+
+         /// Number of decoding threads
+      unsigned int
+      threadCount() const
+      {
+         return tasks.size();
+      };
+
+   private:
+
+         /// Decodes a run of the records of a batch on one thread
+      class DecodeTask : public ThreadPool::Task
+      {
+      public:
+         DecodeTask() : reader(NULL), recs(NULL) {}
+
+         const BinexBatchReader*  reader;
+         std::vector<BinexData>*  recs;   ///< Output
+         size_t       first;              ///< First record in the batch
+         size_t       last;               ///< One past the last
+         size_t       out;                ///< Index in recs of first
+         std::string  scratch;            ///< Kept from batch to batch
+
+            /// The bad records of the run, by index in the batch, and why
+         std::vector< std::pair<size_t, FFStreamError> >  failures;
+
+         void run() throw();
+      };
+
+         /// Decodes the records of the batch from next on into \a recs
+      void
+      decode(std::vector<BinexData>& recs);
+
+         /// Exchanges two records without copying their messages
+      static void
+      swapRecords(BinexData& a, BinexData& b);
+
+         /// Reads the next batch of records from the stream, undecoded
+      void
+      fill()
+         throw(FFStreamError);
+
+         /**
+          * Appends the next record of the stream to the batch.
+          * @return false if the stream ended before it
+          */
+      bool
+      scanRecord()
+         throw(FFStreamError);
+
+         /**
+          * Moves the stream past the next \a length bytes and appends
+          * them to the batch.
+          * @return false if the stream ended before all of them
+          */
+      bool
+      take(size_t length);
+
+         /// Takes a UBNXI from the stream
+      unsigned long
+      takeUBNXI(bool littleEndian)
+         throw(FFStreamError);
+
+      BinexStream&  strm;
+      size_t        batchSize;
+
+         /// Holds the tables of synchronization bytes and CRC lengths
+      BinexData     framer;
+
+         /// The undecoded records of the batch, one after another
+      std::vector<char>    batch;
+
+         /// Where each record starts in batch, and where the last ends
+      std::vector<size_t>  starts;
+
+         /// Number of records in the batch
+      size_t        count;
+
+         /// Next record of the batch to be returned
+      size_t        next;
+
+         /// Records of the batch before this have been decoded; those from
+         /// next on wait in held, behind a bad one still to be thrown.
+      size_t        decoded;
+
+         /// The decoded records from heldFrom on, held[i - heldFrom]
+      std::vector<BinexData>  held;
+      size_t        heldFrom;
+
+         /// The bad records of the batch not yet thrown, and why
+      std::map<size_t, FFStreamError>  failures;
+
+         /// Set when the batch was ended by a record that cannot be framed
+      bool          scanFailed;
+      FFStreamError scanError;
+
+      std::vector<DecodeTask>  tasks;
+      ThreadPool*              pool;
+
+         /// Not copyable
+      BinexBatchReader(const BinexBatchReader&);
+      BinexBatchReader& operator=(const BinexBatchReader&);
+
+   }; // class BinexBatchReader
+
+   //@}
+
+} // namespace gpstk
+
+#endif // GPSTK_BINEXBATCHREADER_HPP
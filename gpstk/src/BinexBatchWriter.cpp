@@ -0,0 +1,149 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file BinexBatchWriter.cpp
+ * Writes BINEX records a batch at a time, encoding them in parallel
+ */
+
+#include <algorithm>
+
+#include "BinexBatchWriter.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   // -------------------------------------------------------------------------
+   BinexBatchWriter::BinexBatchWriter(BinexStream&  strm,
+                                      unsigned int  nthreads)
+      throw(Exception)
+         : strm(strm), pool(NULL)
+   {
+      if (nthreads == 0)
+      {
+         nthreads = ThreadPool::processorCount();
+      }
+      tasks.resize(nthreads);
+      if (nthreads > 1)
+      {
+         pool = new ThreadPool(nthreads);
+      }
+   }
+
+   // -------------------------------------------------------------------------
+   BinexBatchWriter::~BinexBatchWriter()
+   {
+      delete pool;
+   }
+
+   // -------------------------------------------------------------------------
+   void
+   BinexBatchWriter::write(const BinexData* recs,
+                           size_t           n)
+      throw(FFStreamError)
+   {
+      if (n == 0)
+      {
+         return;
+      }
+
+      size_t ntasks = std::min(tasks.size(), n);
+      for (size_t i = 0; i < ntasks; i++)
+      {
+         EncodeTask& t = tasks[i];
+         t.recs   = recs;
+         t.first  = n * i / ntasks;
+         t.last   = n * (i + 1) / ntasks;
+         t.failed = false;
+      }
+
+      if (pool && ntasks > 1)
+      {
+         for (size_t i = 0; i < ntasks; i++)
+         {
+            pool->submit(&tasks[i]);
+         }
+         pool->wait();
+      }
+      else
+      {
+         tasks[0].run();
+      }
+
+         // Write up to the first record that could not be encoded
+      for (size_t i = 0; i < ntasks; i++)
+      {
+         EncodeTask& t = tasks[i];
+         try
+         {
+            strm.write(t.buf.data(), t.buf.size() );
+         }
+         catch (std::exception&)
+         {
+               // Where the stream throws on failure; checked below
+         }
+         if (strm.fail() || strm.bad() )
+         {
+            FFStreamError err("Error writing data");
+            GPSTK_THROW(err);
+         }
+         if (t.failed)
+         {
+            strm.recordNumber += t.failedAt - t.first;
+            FFStreamError err(t.error);
+            GPSTK_THROW(err);
+         }
+         strm.recordNumber += t.last - t.first;
+      }
+   }
+
+   // -------------------------------------------------------------------------
+   void
+   BinexBatchWriter::EncodeTask::run()
+      throw()
+   {
+      buf.clear();
+      for (size_t i = first; i < last; i++)
+      {
+         size_t good = buf.size();
+         try
+         {
+            recs[i].encodeRecord(buf);
+            continue;
+         }
+         catch (FFStreamError& e)
+         {
+            error = e;
+         }
+         catch (std::exception& e)
+         {
+            error = FFStreamError(e.what() );
+         }
+         buf.resize(good);
+         failed   = true;
+         failedAt = i;
+         return;
+      }
+   }
+
+}  // namespace gpstk
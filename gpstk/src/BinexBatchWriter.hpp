@@ -0,0 +1,133 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file BinexBatchWriter.hpp
+ * Writes BINEX records a batch at a time, encoding them in parallel
+ */
+
+#ifndef GPSTK_BINEXBATCHWRITER_HPP
+#define GPSTK_BINEXBATCHWRITER_HPP
+
+#include <string>
+#include <vector>
+
+#include "ThreadPool.hpp"
+#include "BinexData.hpp"
+#include "BinexStream.hpp"
+
+namespace gpstk
+{
+   /** @addtogroup Binex */
+   //@{
+
+      /**
+       * This class writes BINEX records to a BinexStream a batch at a time.
+       * A pool of threads each encodes a run of consecutive records into
+       * a buffer of its own, kept from one batch to the next, and the
+       * buffers are then written in order. The bytes written are the same
+       * as putRecord() writes for each record.
+       *
+       * @sa binex_batch_bench.cpp for an example.
+       * @sa BinexBatchReader.
+       */
+   class BinexBatchWriter
+   {
+   public:
+         /**
+          * Constructor
+          * @param strm      The stream to write
+          * @param nthreads  Encoding threads; 0 means one per processor
+          * @throw Exception if the threads cannot be started
+          */
+      BinexBatchWriter(BinexStream& strm,
+                       unsigned int nthreads = 0)
+         throw(Exception);
+
+         /// Destructor
+      ~BinexBatchWriter();
+
+         /**
+          * Writes the \a n records at \a recs, in order. If one of them
+          * cannot be encoded, those before it are written and the error
+          * is thrown.
+          * @throw FFStreamError if a record cannot be encoded or the
+          *  stream cannot be written
+          */
+      void
+      write(const BinexData* recs,
+            size_t           n)
+         throw(FFStreamError);
+
+         /// Writes all of \a recs, as above.
+      void
+      write(const std::vector<BinexData>& recs)
+         throw(FFStreamError)
+      {
+         if (!recs.empty() )
+         {
+            write(&recs[0], recs.size() );
+         }
+      };
+
+         /// Number of encoding threads
+      unsigned int
+      threadCount() const
+      {
+         return tasks.size();
+      };
+
+   private:
+
+         /// Encodes a run of the records of a batch on one thread
+      class EncodeTask : public ThreadPool::Task
+      {
+      public:
+         EncodeTask() : recs(NULL), failed(false) {}
+
+         const BinexData*  recs;          ///< Input
+         size_t       first;              ///< First record to encode
+         size_t       last;               ///< One past the last
+         std::string  buf;                ///< Output, kept between batches
+         bool         failed;             ///< True if a record was bad
+         size_t       failedAt;           ///< The bad record
+         FFStreamError error;             ///< Why it was bad
+
+         void run() throw();
+      };
+
+      BinexStream&  strm;
+
+      std::vector<EncodeTask>  tasks;
+      ThreadPool*              pool;
+
+         /// Not copyable
+      BinexBatchWriter(const BinexBatchWriter&);
+      BinexBatchWriter& operator=(const BinexBatchWriter&);
+
+   }; // class BinexBatchWriter
+
+   //@}
+
+} // namespace gpstk
+
+#endif // GPSTK_BINEXBATCHWRITER_HPP
@@ -119,6 +119,42 @@ namespace gpstk
    }
 
 
+   // -------------------------------------------------------------------------
+   size_t
+   BinexData::UBNXI::decode(
+      const char*  inBuffer,
+      size_t       length,
+      bool         littleEndian)
+         throw(FFStreamError)
+   {
+      bool more = true;
+      for (size = 0, value = 0L; (size < MAX_BYTES) && more; size++)
+      {
+         if (size >= length)
+         {
+            FFStreamError err("Incomplete BINEX UBNXI");
+            GPSTK_THROW(err);
+         }
+         unsigned char mask = (size < 3) ? 0x7f : 0xff;
+         unsigned char b    = static_cast<unsigned char>(inBuffer[size]);
+         if (littleEndian)
+         {
+            value |= ( (unsigned long)b & mask) << (7 * size);
+         }
+         else
+         {
+            value <<= (size < 3) ? 7 : 8;
+            value |= ( (unsigned long)b & mask);
+         }
+         if ( (b & 0x80) != 0x80)
+         {
+            more = false;
+         }
+      }
+      return size;
+   }
+
+
    // -------------------------------------------------------------------------
    size_t
    BinexData::UBNXI::encode(
@@ -1149,75 +1185,176 @@ namespace gpstk
    }  // BinexData::extractMessageData()
 
    // -------------------------------------------------------------------------
-   void
-   BinexData::reallyPutRecord(FFStream& ffs) const
-      throw(std::exception, FFStreamError, 
-            StringUtils::StringException)
+   size_t
+   BinexData::encodeRecord(std::string& buf) const
+      throw(std::exception, FFStreamError)
    {
-      //std::cout << "BinexData::reallyPutRecord: ENTER" << std::endl;
+      unsigned char syncTail;
+      if (!isHeadSyncByteValid(syncByte, syncTail) )
+      {
+         std::ostringstream errStrm;
+         errStrm << "Invalid BINEX synchronization byte: "
+                 << static_cast<uint16_t>(syncByte);
+         FFStreamError err(errStrm.str() );
+         GPSTK_THROW(err);
+      }
 
-      BinexStream* strm = dynamic_cast<BinexStream*>(&ffs);
-      if (NULL == strm)
+      bool    littleEndian = (syncByte&eBigEndian)==0 ? true : false;
+      size_t  start        = buf.size();
+
+      buf.append(1, syncByte);
+
+      UBNXI r(recID);
+      r.encode(buf, buf.size(), littleEndian);
+      UBNXI m(msg.size() );
+      m.encode(buf, buf.size(), littleEndian);
+      size_t  headLen      = r.getSize() + m.getSize();
+
+      buf.append(msg);
+
+         // The CRC covers the record ID, length, and message
+      std::string  crc;
+      getCRC(buf.data() + start + 1, headLen, msg.data(), msg.size(), crc);
+      buf.append(crc);
+
+      if (syncByte & eReverseReadable)
       {
-         FFStreamError e("Attempt to read a BinexData object"
-                         " from a non-BinexStream FFStream.");
-         GPSTK_THROW(e);
+         UBNXI  recLen(1 + headLen + msg.size() + crc.size() );
+         size_t tail = buf.size();
+         recLen.encode(buf, tail, littleEndian);
+         reverseBuffer(buf, tail);
+         buf.append(1, syncTail);
       }
 
-      try
+      return buf.size() - start;
+
+   }  // BinexData::encodeRecord()
+
+   // -------------------------------------------------------------------------
+   void
+   BinexData::decodeRecord(const char*   rec,
+                           size_t        length,
+                           std::string&  scratch)
+      throw(std::exception, FFStreamError)
+   {
+      unsigned char  expectedSyncByte;
+      unsigned char  sync = (length > 0) ? rec[0] : 0;
+      bool           withTail = true;
+
+      if (isTailSyncByteValid(sync, expectedSyncByte) )
       {
-         unsigned char syncTail;
-         if (!isHeadSyncByteValid(syncByte, syncTail) )
+            // Put the record back in order; its tail is not in it then.
+         bool  littleEndian = (expectedSyncByte & eBigEndian) == 0;
+         UBNXI b;
+         size_t n = 1 + b.decode(rec + 1, length - 1, littleEndian);
+         if (n + (unsigned long)b != length)
          {
-            std::ostringstream errStrm;
-            errStrm << "Invalid BINEX synchronization byte: "
-                    << static_cast<uint16_t>(syncByte);
-            FFStreamError err(errStrm.str() );
+            FFStreamError err("Incomplete BINEX record message");
             GPSTK_THROW(err);
          }
-            // Buffer, etc. for non-msg data
-         std::string    headBuf;
-         size_t         bufLen = 0;  // Total buffer data length
-         size_t         crcLen = 0;  // Length of calculated CRC
-
-         bool    littleEndian = (syncByte&eBigEndian)==0 ? true : false;
+         scratch.assign(rec + n, length - n);
+         reverseBuffer(scratch);
+         if ( (unsigned char)scratch[0] != expectedSyncByte)
+         {
+            FFStreamError err("BINEX head/tail synchronization byte mismatch");
+            GPSTK_THROW(err);
+         }
+         rec      = scratch.data();
+         length   = scratch.size();
+         sync     = expectedSyncByte;
+         withTail = false;
+      }
+      else if (!isHeadSyncByteValid(sync, expectedSyncByte) )
+      {
+         std::ostringstream errStrm;
+         errStrm << "Invalid BINEX synchronization byte: "
+                 << static_cast<uint16_t>(sync);
+         FFStreamError err(errStrm.str() );
+         GPSTK_THROW(err);
+      }
 
-         headBuf.reserve(9);  // 1+4+4
+      syncByte = sync;
+      bool  littleEndian = (syncByte & eBigEndian) == 0;
 
-            // Copy sync byte to header buffer
-         headBuf.append(1, syncByte);
-         bufLen += 1;
+      UBNXI  r, m;
+      size_t offset = 1;
+      offset += r.decode(rec + offset, length - offset, littleEndian);
+      offset += m.decode(rec + offset, length - offset, littleEndian);
+      size_t headLen = offset - 1;
+      unsigned long msgLen = (unsigned long)m;
+      if (offset + msgLen > length)
+      {
+         FFStreamError err("Incomplete BINEX record message");
+         GPSTK_THROW(err);
+      }
+      setRecordID((unsigned long)r);
+      msg.assign(rec + offset, msgLen);
+      offset += msgLen;
 
-            // Copy record ID to header buffer
-         UBNXI r(recID);
-         bufLen += r.encode(headBuf, bufLen, littleEndian);
+      std::string  expectedCrc;
+      getCRC(rec + 1, headLen, msg.data(), msg.size(), expectedCrc);
+      if ( (offset + expectedCrc.size() > length)
+         || std::memcmp(rec + offset, expectedCrc.data(), expectedCrc.size() ) )
+      {
+         FFStreamError err("Bad BINEX CRC");
+         GPSTK_THROW(err);
+      }
+      offset += expectedCrc.size();
+
+         // The tail of a reverse-readable record: the length back to the
+         // head, reversed, and the tail synchronization byte
+      if (withTail && (syncByte & eReverseReadable) )
+      {
+         UBNXI  recLen(offset);
+         size_t tailLen = recLen.getSize() + 1;
+         std::string  tail;
+         recLen.encode(tail, 0, littleEndian);
+         reverseBuffer(tail);
+         tail.append(1, expectedSyncByte);
+         if ( (offset + tailLen > length)
+            || tail.compare(0, tailLen, rec + offset, tailLen) )
+         {
+            FFStreamError err("Bad BINEX reverse-readable record tail");
+            GPSTK_THROW(err);
+         }
+         offset += tailLen;
+      }
 
-            // Copy message length to header buffer
-         UBNXI m(msg.size() );
-         bufLen += m.encode(headBuf, bufLen, littleEndian);
+      if (offset != length)
+      {
+         FFStreamError err("BINEX record length mismatch");
+         GPSTK_THROW(err);
+      }
 
-            // Write header buffer and message to the output stream
-         strm->write(headBuf.data(), headBuf.size() );
-         strm->write(msg.data(), msg.size() );
+   }  // BinexData::decodeRecord()
 
-            // Calculate CRC and store it in the tail buffer
-         std::string  tailBuf;
-         tailBuf.reserve(21);  // 16+4+1
-         headBuf.erase(0, 1);  // Exclude sync byte from CRC calculation
-         getCRC(headBuf, msg, tailBuf);
-         crcLen = tailBuf.size();
+   // -------------------------------------------------------------------------
+   void
+   BinexData::reallyPutRecord(FFStream& ffs) const
+      throw(std::exception, FFStreamError, 
+            StringUtils::StringException)
+   {
+      //std::cout << "BinexData::reallyPutRecord: ENTER" << std::endl;
 
-            // Copy enhanced CRC record items into the tail buffer
-         if (syncByte & eReverseReadable)
-         {
-            UBNXI recLen(1 + r.getSize() + m.getSize() + msg.size() + crcLen);
-            recLen.encode(tailBuf, crcLen, littleEndian);
-            reverseBuffer(tailBuf, crcLen);
-            tailBuf.append(1, syncTail);
-         }
+      BinexStream* strm = dynamic_cast<BinexStream*>(&ffs);
+      if (NULL == strm)
+      {
+         FFStreamError e("Attempt to read a BinexData object"
+                         " from a non-BinexStream FFStream.");
+         GPSTK_THROW(e);
+      }
 
-            // Write the tail buffer to the output stream.
-         strm->write(tailBuf.data(), tailBuf.size() );
+      try
+      {
+            // Frame the whole record, then write it at once
+         std::string  buf;
+         buf.reserve(getRecordSize() );
+         encodeRecord(buf);
+         strm->write(buf.data(), buf.size() );
+      }
+      catch(FFStreamError& exc)
+      {
+         GPSTK_RETHROW(exc);
       }
       catch(std::exception& exc)
       {
@@ -1350,9 +1487,9 @@ namespace gpstk
                GPSTK_THROW(err);
             }
             std::string revRecBuf( (char*)&revRecVec[0], revRecSize);
-            reverseBuffer(revRecBuf, revRecSize);
+            reverseBuffer(revRecBuf);
 
-            if (revRecBuf[0] != expectedSyncByte)
+            if ( (unsigned char)revRecBuf[0] != expectedSyncByte)
             {
                FFStreamError err("BINEX head/tail synchronization byte mismatch");
                GPSTK_THROW(err);
@@ -1413,7 +1550,18 @@ namespace gpstk
                      const std::string&  message,
                      std::string&        crc) const
    {
-      size_t crcDataLen = head.size() + message.size();
+      getCRC(head.data(), head.size(), message.data(), message.size(), crc);
+   }
+
+   // -------------------------------------------------------------------------
+   void
+   BinexData::getCRC(const char*         head,
+                     size_t              headLength,
+                     const char*         message,
+                     size_t              messageLength,
+                     std::string&        crc) const
+   {
+      size_t crcDataLen = headLength + messageLength;
       size_t crcLen     = 0;
       unsigned long crcTmp = 0;
 
@@ -1430,12 +1578,12 @@ namespace gpstk
             {
                   // Use 2-byte CRC (CRC16)
                BinUtils::CRCParam params(BinUtils::CRC16);
-               crcTmp = BinUtils::computeCRC((const unsigned char*)head.data(),
-                                             head.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)head,
+                                             headLength,
                                              params);
                params.initial = crcTmp;
-               crcTmp = BinUtils::computeCRC((const unsigned char*)message.data(),
-                                             message.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)message,
+                                             messageLength,
                                              params);
                crcLen = 2;
             }
@@ -1443,12 +1591,12 @@ namespace gpstk
             {
                   // Use 4-byte CRC (CRC32)
                BinUtils::CRCParam params(BinUtils::CRC32);
-               crcTmp = BinUtils::computeCRC((const unsigned char*)head.data(),
-                                             head.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)head,
+                                             headLength,
                                              params);
                params.initial = crcTmp;
-               crcTmp = BinUtils::computeCRC((const unsigned char*)message.data(),
-                                             message.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)message,
+                                             messageLength,
                                              params);
                crcLen = 4;
             }
@@ -1460,13 +1608,13 @@ namespace gpstk
                   // Use 1-byte checksum: 8-bit XOR of all bytes
                size_t b;
                const char *ptr;
-               ptr = head.data();
-               for (b = head.size(); b > 0 ; b--, ptr++)
+               ptr = head;
+               for (b = headLength; b > 0 ; b--, ptr++)
                {
                   crcTmp ^= *ptr;
                }
-               ptr = message.data();
-               for (b = message.size(); b > 0 ; b--, ptr++)
+               ptr = message;
+               for (b = messageLength; b > 0 ; b--, ptr++)
                {
                   crcTmp ^= *ptr;
                }
@@ -1476,12 +1624,12 @@ namespace gpstk
             {
                   // Use 2-byte CRC (CRC16)
                BinUtils::CRCParam params(BinUtils::CRC16);
-               crcTmp = BinUtils::computeCRC((const unsigned char*)head.data(),
-                                             head.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)head,
+                                             headLength,
                                              params);
                params.initial = crcTmp;
-               crcTmp = BinUtils::computeCRC((const unsigned char*)message.data(),
-                                             message.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)message,
+                                             messageLength,
                                              params);
                crcLen = 2;
             }
@@ -1489,12 +1637,12 @@ namespace gpstk
             {
                   // Use 4-byte CRC (CRC32)
                BinUtils::CRCParam params(BinUtils::CRC32);
-               crcTmp = BinUtils::computeCRC((const unsigned char*)head.data(),
-                                             head.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)head,
+                                             headLength,
                                              params);
                params.initial = crcTmp;
-               crcTmp = BinUtils::computeCRC((const unsigned char*)message.data(),
-                                             message.size(),
+               crcTmp = BinUtils::computeCRC((const unsigned char*)message,
+                                             messageLength,
                                              params);
                crcLen = 4;
             }
@@ -210,6 +210,18 @@ namespace gpstk
                 bool               littleEndian = false)
              throw(FFStreamError);
 
+            /**
+             * Decodes a UBNXI from the first of the \a length bytes at
+             * \a inBuffer, as decode() above does from a string.
+             * @throw FFStreamError if the UBNXI runs past \a length bytes
+             * @return Number of bytes decoded
+             */
+         size_t
+         decode(const char*        inBuffer,
+                size_t             length,
+                bool               littleEndian = false)
+             throw(FFStreamError);
+
             /**
              * Converts the UBNXI to a series of bytes placed in outBuffer.
              * The bytes are output in normal order (i.e. not reversed) but
@@ -571,6 +583,35 @@ namespace gpstk
       size_t
       getRecordSize() const;
 
+         /**
+          * Appends the record to \a buf exactly as putRecord() writes it,
+          * so that records can be encoded away from the stream and written
+          * many at a time.
+          *
+          * @return Number of bytes appended
+          * @throw FFStreamError if the record cannot be encoded
+          */
+      size_t
+      encodeRecord(std::string& buf) const
+         throw(std::exception, FFStreamError);
+
+         /**
+          * Replaces the record ID, flags, and message with those of the
+          * whole record in the \a length bytes at \a rec, which begins
+          * with either its head or, as getRecord() also reads them, its
+          * tail synchronization byte.  The message buffer is reused.
+          *
+          * @param scratch Holds a record that starts at its tail while it
+          *                is put back in order, so a caller decoding many
+          *                records can keep one and not allocate for each
+          * @throw FFStreamError if the record is malformed or its CRC bad
+          */
+      void
+      decodeRecord(const char*  rec,
+                   size_t       length,
+                   std::string& scratch)
+         throw(std::exception, FFStreamError);
+
          /**
           * Remove all data from the record message buffer.
           */
@@ -875,6 +916,13 @@ namespace gpstk
                   const std::string& message,
                   std::string&       crc) const;
 
+         /// As above, for a head and message that are not strings.
+      void getCRC(const char*        head,
+                  size_t             headLength,
+                  const char*        message,
+                  size_t             messageLength,
+                  std::string&       crc) const;
+
          /**
           * Returns the number of bytes required to store the record's CRC
           * based on the record's current contents. 
@@ -945,6 +993,9 @@ namespace gpstk
 
    private:
 
+         /// Reads the framing of records, through the protected members
+      friend class BinexBatchReader;
+
    };  // class BinexData
 
    //@}
@@ -0,0 +1,127 @@
+#pragma ident "$Id$"
+
+/// @file BoundedQueue.hpp
+/// A first-in first-out queue of limited size, shared between threads that
+/// produce items and threads that consume them.
+
+#ifndef GPSTK_BOUNDED_QUEUE_INCLUDE
+#define GPSTK_BOUNDED_QUEUE_INCLUDE
+
+#ifndef _WIN32
+
+#include <cstddef>
+#include <deque>
+#include <pthread.h>
+
+namespace gpstk
+{
+   /** @addtogroup General */
+   //@{
+
+   /// A thread-safe FIFO queue holding at most a fixed number of items (POSIX
+   /// threads). push() blocks while the queue is full and pop() blocks while it
+   /// is empty, so a fast producer cannot run arbitrarily far ahead of its
+   /// consumer. close() ends the exchange: later pushes are refused, and pop()
+   /// returns the items still queued, then reports the end.
+   ///
+   /// Items are copied in and out; T must be copyable and assignable.
+   template <class T>
+   class BoundedQueue
+   {
+   public:
+
+      /// Constructor
+      /// @param cap maximum number of items in the queue (at least 1)
+      BoundedQueue(std::size_t cap) throw()
+         : capacity(cap > 0 ? cap : 1), closed(false)
+      {
+         ::pthread_mutex_init(&lock, 0);
+         ::pthread_cond_init(&notFull, 0);
+         ::pthread_cond_init(&notEmpty, 0);
+      }
+
+      /// Destructor
+      ~BoundedQueue() throw()
+      {
+         ::pthread_cond_destroy(&notEmpty);
+         ::pthread_cond_destroy(&notFull);
+         ::pthread_mutex_destroy(&lock);
+      }
+
+      /// Add an item at the end of the queue, waiting for room if it is full.
+      /// @return false if the queue has been closed (the item is not added)
+      bool push(const T& item)
+      {
+         ::pthread_mutex_lock(&lock);
+         while(items.size() >= capacity && !closed)
+            ::pthread_cond_wait(&notFull, &lock);
+         bool ok(!closed);
+         if(ok) {
+            items.push_back(item);
+            ::pthread_cond_signal(&notEmpty);
+         }
+         ::pthread_mutex_unlock(&lock);
+         return ok;
+      }
+
+      /// Remove the item at the front of the queue, waiting for one if the
+      /// queue is empty.
+      /// @return false if the queue is closed and empty (item is unchanged)
+      bool pop(T& item)
+      {
+         ::pthread_mutex_lock(&lock);
+         while(items.empty() && !closed)
+            ::pthread_cond_wait(&notEmpty, &lock);
+         bool ok(!items.empty());
+         if(ok) {
+            item = items.front();
+            items.pop_front();
+            ::pthread_cond_signal(&notFull);
+         }
+         ::pthread_mutex_unlock(&lock);
+         return ok;
+      }
+
+      /// Refuse further pushes, and wake all waiting threads.
+      void close() throw()
+      {
+         ::pthread_mutex_lock(&lock);
+         closed = true;
+         ::pthread_cond_broadcast(&notFull);
+         ::pthread_cond_broadcast(&notEmpty);
+         ::pthread_mutex_unlock(&lock);
+      }
+
+   private:
+
+      /// Maximum number of items
+      std::size_t capacity;
+
+      /// True once close() has been called
+      bool closed;
+
+      /// The items, oldest first
+      std::deque<T> items;
+
+      /// Protects everything above
+      pthread_mutex_t lock;
+
+      /// Signaled when an item is removed, or the queue is closed
+      pthread_cond_t notFull;
+
+      /// Signaled when an item is added, or the queue is closed
+      pthread_cond_t notEmpty;
+
+      /// Not copyable
+      BoundedQueue(const BoundedQueue&);
+      BoundedQueue& operator=(const BoundedQueue&);
+
+   }; // end class BoundedQueue
+
+   //@}
+
+}  // End of namespace gpstk
+
+#endif // _WIN32
+
+#endif // GPSTK_BOUNDED_QUEUE_INCLUDE
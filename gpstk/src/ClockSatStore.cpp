@@ -291,17 +291,7 @@ namespace gpstk
          if(tables.find(sat) != tables.end() &&
             tables[sat].find(ttag) != tables[sat].end()) {
                // record already exists in the table
-            ClockRecord& oldrec(tables[sat][ttag]);
-            oldrec.bias = rec.bias;
-            oldrec.sig_bias = rec.sig_bias;
-            if(haveClockDrift) {
-               oldrec.drift = rec.drift;
-               oldrec.sig_drift = rec.sig_drift;
-            }
-            if(haveClockAccel) {
-               oldrec.accel = rec.accel;
-               oldrec.sig_accel = rec.sig_accel;
-            }
+            updateRecord(tables[sat][ttag], rec, haveClockDrift, haveClockAccel);
          }
          else  // create a new entry in the table
             tables[sat][ttag] = rec;
@@ -309,6 +299,57 @@ namespace gpstk
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
    }
 
+   // Add many complete ClockRecords at once; same result as addClockRecord() on
+   // each, in order, but each table is built in one pass in time order.
+   void ClockSatStore::addClockRecords(const vector<SatID>& sats,
+                                       const vector<CommonTime>& ttags,
+                                       const vector<ClockRecord>& recs)
+      throw(InvalidRequest)
+   {
+      try {
+         size_t i,k,n(recs.size());
+         if(sats.size() != n || ttags.size() != n) {
+            InvalidRequest ir("Input vectors have different lengths");
+            GPSTK_THROW(ir);
+         }
+         for(i=0; i<n; i++)
+            checkTimeSystem(ttags[i].getTimeSystem());
+
+         // addClockRecord() sets the drift and accel flags as it goes, and an
+         // existing record is updated according to the flags at that point; find
+         // the first record (in input order) that sets each flag.
+         size_t firstDrift(haveClockDrift ? 0 : n), firstAccel(haveClockAccel ? 0 : n);
+         for(i=0; i<n && (firstDrift == n || firstAccel == n); i++) {
+            if(firstDrift == n && recs[i].drift != 0.0) firstDrift = i;
+            if(firstAccel == n && recs[i].accel != 0.0) firstAccel = i;
+         }
+
+         vector<size_t> index;
+         sortBySatTime(sats, ttags, index);
+
+         // insert in time order, using the previous entry as a hint, so that
+         // appending to a table costs no search
+         DataTable *table(0);
+         DataTable::iterator it;
+         for(k=0; k<n; k++) {
+            i = index[k];
+            if(k == 0 || sats[i] != sats[index[k-1]]) {
+               table = &tables[sats[i]];
+               it = table->end();
+            }
+
+            size_t size(table->size());
+            it = table->insert(it, make_pair(ttags[i], recs[i]));
+            if(table->size() == size)      // record already exists in the table
+               updateRecord(it->second, recs[i], firstDrift <= i, firstAccel <= i);
+         }
+
+         if(firstDrift < n) haveClockDrift = true;
+         if(firstAccel < n) haveClockAccel = true;
+      }
+      catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
+   }
+
    // Add clock bias (only) data to the store
    void ClockSatStore::addClockBias(const SatID& sat, const CommonTime& ttag,
                                     const double& bias, const double& sig)
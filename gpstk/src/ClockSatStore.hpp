@@ -10,6 +10,7 @@
 #define GPSTK_CLOCK_SAT_STORE_INCLUDE
 
 #include <map>
+#include <vector>
 #include <iostream>
 
 #include "Exception.hpp"
@@ -33,6 +34,25 @@ namespace gpstk
    /// Output stream operator is used by dump() in TabularSatStore
    std::ostream& operator<<(std::ostream& os, const ClockRecord& rec) throw();
 
+   /// Number of doubles in a ClockRecord, as written to binary snapshots
+   static const int ClockRecordSize = 6;
+
+   /// Copy a ClockRecord into an array of ClockRecordSize doubles
+   inline void packClockRecord(const ClockRecord& rec, double *data) throw()
+   {
+      data[0] = rec.bias;  data[1] = rec.sig_bias;
+      data[2] = rec.drift; data[3] = rec.sig_drift;
+      data[4] = rec.accel; data[5] = rec.sig_accel;
+   }
+
+   /// Copy an array of ClockRecordSize doubles into a ClockRecord
+   inline void unpackClockRecord(const double *data, ClockRecord& rec) throw()
+   {
+      rec.bias = data[0];  rec.sig_bias = data[1];
+      rec.drift = data[2]; rec.sig_drift = data[3];
+      rec.accel = data[4]; rec.sig_accel = data[5];
+   }
+
    /// Store a table of data vs time for each of several satellites.
    /// The data are stored as ClockRecords, one for each (satellite,time) pair.
    /// The getValue(sat, t) routine interpolates the table for sat at time t and
@@ -154,6 +174,23 @@ namespace gpstk
                           const ClockRecord& rec)
          throw(InvalidRequest);
 
+      /// Add many complete ClockRecords at once, for example the contents of several
+      /// files. The result is the same as calling addClockRecord(sats[i], ttags[i],
+      /// recs[i]) for i=0,1,...,in order, including the rules for a record that is
+      /// already in the store; however the records are first sorted on satellite
+      /// and time, so that each table is built in a single ordered pass.
+      /// Unlike repeated calls to addClockRecord(), nothing is added if any ttag
+      /// has the wrong time system.
+      /// @param sats vector of satellites
+      /// @param ttags vector of time tags, same length as sats
+      /// @param recs vector of records, same length as sats
+      /// @throw InvalidRequest if the vectors have different lengths, or a time
+      ///    system is inconsistent with the store.
+      void addClockRecords(const std::vector<SatID>& sats,
+                           const std::vector<CommonTime>& ttags,
+                           const std::vector<ClockRecord>& recs)
+         throw(InvalidRequest);
+
       /// Add clock bias data (only) to the store
       void addClockBias(const SatID& sat, const CommonTime& ttag,
                         const double& bias, const double& sig=0.0)
@@ -194,6 +231,26 @@ namespace gpstk
       void setLinearInterp(void) throw()
          { interpType = 1; setInterpolationOrder(1); }
 
+   private:
+
+      /// Replace the values in an existing record with those in rec, for
+      /// addClockRecord(s); drift and accel are replaced only if the store has
+      /// (or rec brings) that type of data.
+      static void updateRecord(ClockRecord& oldrec, const ClockRecord& rec,
+                               bool drift, bool accel) throw()
+      {
+         oldrec.bias = rec.bias;
+         oldrec.sig_bias = rec.sig_bias;
+         if(drift) {
+            oldrec.drift = rec.drift;
+            oldrec.sig_drift = rec.sig_drift;
+         }
+         if(accel) {
+            oldrec.accel = rec.accel;
+            oldrec.sig_accel = rec.sig_accel;
+         }
+      }
+
    }; // end class ClockSatStore
 
       //@}
@@ -0,0 +1,367 @@
+#pragma ident "$Id$"
+
+/**
+ * @file FFBinaryStream.cpp
+ * An FFStream for binary file reading
+ */
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2004, The University of Texas at Austin
+//
+//============================================================================
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <signal.h>
+#include <pthread.h>
+#include <cstring>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#include "FFBinaryStream.hpp"
+
+namespace gpstk
+{
+#ifndef _WIN32
+      // A file cut short while it is mapped raises SIGBUS when a page past
+      // its new end is read. The maps of all MapBuffers are listed here so
+      // that the handler can tell one of theirs: it puts a page of zeros
+      // where the fault was, marks the map cut and lets the read go on;
+      // the MapBuffer then ends where the file now does.
+   struct MapSlot
+   {
+      char* volatile base;
+      volatile size_t size;
+      volatile sig_atomic_t cut;
+   };
+
+   static const int maxMaps = 64;
+   static MapSlot mapSlots[maxMaps];
+   static pthread_mutex_t mapSlotLock = PTHREAD_MUTEX_INITIALIZER;
+   static bool busHandlerSet = false;
+   static struct sigaction oldBusAction;
+   static size_t pageSize = 0;
+
+   static void busHandler(int sig, siginfo_t* info, void* context)
+   {
+      char* addr = static_cast<char*>(info->si_addr);
+      for (int i = 0; i < maxMaps; i++)
+      {
+         char* base = mapSlots[i].base;
+         if (!base || addr < base || addr >= base + mapSlots[i].size)
+            continue;
+         char* page = base + (addr - base) / pageSize * pageSize;
+         if (::mmap(page, pageSize, PROT_READ,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0)
+             == MAP_FAILED)
+            break;
+         mapSlots[i].cut = 1;
+         return;
+      }
+
+         // Not ours: to whoever had it before, or fault again without us
+      if (oldBusAction.sa_flags & SA_SIGINFO)
+         oldBusAction.sa_sigaction(sig, info, context);
+      else if (oldBusAction.sa_handler != SIG_DFL &&
+               oldBusAction.sa_handler != SIG_IGN)
+         oldBusAction.sa_handler(sig);
+      else
+         ::sigaction(SIGBUS, &oldBusAction, NULL);
+   }
+
+      /// A free slot, with the handler installed; NULL if there is none,
+      /// and then the file is not mapped.
+   static MapSlot* takeMapSlot()
+   {
+      MapSlot* slot = NULL;
+      pthread_mutex_lock(&mapSlotLock);
+      if (!busHandlerSet)
+      {
+         pageSize = ::sysconf(_SC_PAGESIZE);
+         struct sigaction sa;
+         memset(&sa, 0, sizeof(sa));
+         sa.sa_sigaction = busHandler;
+         sa.sa_flags = SA_SIGINFO;
+         sigemptyset(&sa.sa_mask);
+         busHandlerSet = (::sigaction(SIGBUS, &sa, &oldBusAction) == 0);
+      }
+      for (int i = 0; busHandlerSet && i < maxMaps && !slot; i++)
+      {
+         if (mapSlots[i].size == 0)
+         {
+            slot = &mapSlots[i];
+            slot->cut = 0;
+            slot->size = 1;     // taken, with nothing mapped yet
+         }
+      }
+      pthread_mutex_unlock(&mapSlotLock);
+      return slot;
+   }
+
+   static void giveMapSlot(MapSlot* slot)
+   {
+      pthread_mutex_lock(&mapSlotLock);
+      slot->base = NULL;
+      slot->size = 0;
+      pthread_mutex_unlock(&mapSlotLock);
+   }
+
+
+      // A read only streambuf over a private map of a whole file. The file
+      // descriptor is kept so the map can follow the file as it grows.
+   class FFBinaryStream::MapBuffer : public std::streambuf
+   {
+   public:
+      MapBuffer(int fd)
+         : fd(fd), base(NULL), mapSize(0), slot(takeMapSlot())
+      {
+         if (slot)
+            remap();
+      }
+
+      ~MapBuffer()
+      {
+         if (slot)
+            slot->base = NULL;
+         if (base)
+            ::munmap(base, mapSize);
+         if (slot)
+            giveMapSlot(slot);
+         ::close(fd);
+      }
+
+         /// False if the file could not be mapped
+      bool mapped() const
+         { return base != NULL; }
+
+         /// Moves past the next n bytes and returns them, or returns NULL
+         /// and moves nowhere if there are not that many.
+      const char* take(size_t n)
+      {
+         checkCut();
+         if (static_cast<size_t>(egptr() - gptr()) < n &&
+             (!remap() || static_cast<size_t>(egptr() - gptr()) < n))
+            return NULL;
+         const char* p = gptr();
+         gbump(static_cast<int>(n));
+         return p;
+      }
+
+   protected:
+      virtual int_type underflow()
+      {
+         checkCut();
+         if (gptr() < egptr() || (remap() && gptr() < egptr()))
+            return traits_type::to_int_type(*gptr());
+         return traits_type::eof();
+      }
+
+      virtual std::streamsize xsgetn(char* s, std::streamsize n)
+      {
+         checkCut();
+         std::streamsize pos = gptr() - eback();
+         std::streamsize got = std::streambuf::xsgetn(s, n);
+
+            // What was copied from past the new end is zeros; give back
+            // only what is still in the file.
+         if (checkCut())
+         {
+            std::streamsize left = egptr() - eback() - pos;
+            if (got > left)
+               got = left > 0 ? left : 0;
+            setg(eback(), eback() + pos + got, egptr());
+         }
+         return got;
+      }
+
+      virtual std::streamsize showmanyc()
+      {
+         checkCut();
+         if (gptr() == egptr())
+            remap();
+         return gptr() < egptr() ? egptr() - gptr() : -1;
+      }
+
+      virtual pos_type seekoff(off_type off, std::ios::seekdir dir,
+                               std::ios::openmode which = std::ios::in)
+      {
+         if (!(which & std::ios::in))
+            return pos_type(off_type(-1));
+         checkCut();
+         if (dir == std::ios::end)
+            remap();
+         off_type size = egptr() - eback();
+         off_type pos = off;
+         if (dir == std::ios::cur)
+            pos += gptr() - eback();
+         else if (dir == std::ios::end)
+            pos += size;
+         if (pos > size && remap())
+            size = egptr() - eback();
+         if (pos < 0 || pos > size)
+            return pos_type(off_type(-1));
+         setg(eback(), eback() + pos, egptr());
+         return pos_type(pos);
+      }
+
+      virtual pos_type seekpos(pos_type pos,
+                               std::ios::openmode which = std::ios::in)
+      { return seekoff(off_type(pos), std::ios::beg, which); }
+
+   private:
+         /// Maps the file again if it has grown; true if it did. A file
+         /// that has been cut is not mapped again.
+      bool remap()
+      {
+         struct stat st;
+         if (!slot || slot->cut || ::fstat(fd, &st) < 0 ||
+             static_cast<size_t>(st.st_size) <= mapSize)
+            return false;
+
+         size_t pos = gptr() - eback();
+         void *ptr = ::mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+         if (ptr == MAP_FAILED)
+            return false;
+#ifdef MADV_SEQUENTIAL
+         ::madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+#endif
+         slot->base = NULL;
+         if (base)
+            ::munmap(base, mapSize);
+         base = static_cast<char*>(ptr);
+         mapSize = st.st_size;
+         slot->size = mapSize;
+         slot->base = base;
+         setg(base, base + pos, base + mapSize);
+         return true;
+      }
+
+         /// If the file has been cut while mapped, ends the get area where
+         /// the file now ends; true if it has been.
+      bool checkCut()
+      {
+         if (!slot || !slot->cut)
+            return false;
+         struct stat st;
+         size_t size = egptr() - eback();
+         if (::fstat(fd, &st) < 0)
+            size = 0;
+         else if (static_cast<size_t>(st.st_size) < size)
+            size = st.st_size;
+         size_t pos = gptr() - eback();
+         setg(eback(), eback() + (pos < size ? pos : size), eback() + size);
+         return true;
+      }
+
+      int fd;
+      char* base;
+      size_t mapSize;
+      MapSlot* slot;
+   };
+#else
+   class FFBinaryStream::MapBuffer : public std::streambuf
+   {
+   public:
+      const char* take(size_t n) { return NULL; }
+   };
+#endif
+
+
+   FFBinaryStream::~FFBinaryStream()
+   {
+      unmapFile();
+   }
+
+
+   bool FFBinaryStream::isMapped() const
+   {
+      return mapBuffer != NULL && std::basic_ios<char>::rdbuf() == mapBuffer;
+   }
+
+
+   const char* FFBinaryStream::getView(size_t length)
+      throw(FFStreamError, EndOfFile)
+   {
+      if (isMapped() && good())
+      {
+         const char* p = mapBuffer->take(length);
+         if (p)
+            return p;
+      }
+
+         // Not mapped, or too near the end: read it, so that what is left
+         // is consumed and the stream state set as getData() would.
+      if (viewBuffer.size() < length)
+         viewBuffer.resize(length);
+      getData(&viewBuffer[0], length);
+      if (static_cast<size_t>(gcount()) < length)
+         return NULL;
+      return &viewBuffer[0];
+   }
+
+
+   void FFBinaryStream::mapFile(std::ios::openmode mode)
+   {
+#ifndef _WIN32
+      if (!(mode & std::ios::in) || (mode & std::ios::out) || !is_open())
+         return;
+
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd < 0)
+         return;
+      struct stat st;
+      if (::fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+      {
+         ::close(fd);
+         return;
+      }
+
+         // A file that can't be mapped, an empty one among them, is read
+         // through the filebuf as before.
+      mapBuffer = new MapBuffer(fd);
+      if (!mapBuffer->mapped())
+      {
+         delete mapBuffer;
+         mapBuffer = NULL;
+         return;
+      }
+      std::basic_ios<char>::rdbuf(mapBuffer);
+#endif
+   }
+
+
+   void FFBinaryStream::unmapFile()
+   {
+      if (!mapBuffer)
+         return;
+         // Leave alone a streambuf someone else put in
+      if (std::basic_ios<char>::rdbuf() == mapBuffer)
+         std::basic_ios<char>::rdbuf(std::fstream::rdbuf());
+      delete mapBuffer;
+      mapBuffer = NULL;
+   }
+
+}  // End of namespace gpstk
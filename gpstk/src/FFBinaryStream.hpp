@@ -51,6 +51,7 @@
 
 
 
+#include <vector>
 #include "FFStream.hpp"
 
 namespace gpstk
@@ -62,15 +63,28 @@ namespace gpstk
        * This is an FFStream that is required to be binary.  It also includes
        * functions for reading and writing binary file.  Otherwise, this
        * is the same as FFStream.
+       *
+       * A regular file opened for input only is mapped into memory, and
+       * the stream reads from the map instead of through a filebuf: reads
+       * are copies out of the map, and tellg() and seekg() are arithmetic
+       * rather than system calls. getView() goes further and hands back
+       * the bytes of a record where they lie in the map. A file that grows
+       * while it is read is mapped again when the reader reaches the old
+       * end, so following a file still works. A file cut short while
+       * it is mapped ends where it now does, as through a filebuf, rather
+       * than raising SIGBUS; bytes it lost while they were being read, or
+       * while a view of them was held, read as zeros. Other streams
+       * (pipes, output, another streambuf given to rdbuf(), or a file
+       * that can't be mapped, an empty one among them) read as before.
        */
    class FFBinaryStream : public FFStream
    {
    public:
          /// destructor
-      virtual ~FFBinaryStream() {};
+      virtual ~FFBinaryStream();
       
          /// Default constructor
-      FFBinaryStream() {}
+      FFBinaryStream() : mapBuffer(NULL) {}
 
          /**
           * Constructor - opens the stream in binary mode if not set.
@@ -79,11 +93,34 @@ namespace gpstk
           */
       FFBinaryStream(const char* fn, 
                      std::ios::openmode mode=std::ios::in|std::ios::binary)
-         : FFStream(fn, mode|std::ios::binary) {}
+         : FFStream(fn, mode|std::ios::binary), mapBuffer(NULL)
+         { mapFile(mode); }
 
          /// Overrides open to ensure binary mode opens
       virtual void open(const char* fn, std::ios::openmode mode)
-         { FFStream::open(fn, mode|std::ios::binary); }
+      {
+         unmapFile();
+         FFStream::open(fn, mode|std::ios::binary);
+         mapFile(mode);
+      }
+
+         /// Closes the file, and the map of it
+      void close()
+         { unmapFile(); std::fstream::close(); }
+
+         /// True when the stream reads from a map of the file
+      bool isMapped() const;
+
+         /**
+          * Moves past the next 'length' bytes of the stream and returns
+          * them. If the stream is mapped they are not copied: this points
+          * into the map. Otherwise they are read, as getData() does, into
+          * a buffer of the stream. Either way they are valid until the
+          * next read from the stream. If fewer than 'length' bytes are left
+          * the rest are read, the stream is failed, and NULL is returned
+          * (or EndOfFile thrown, when the stream throws on failbit).
+          */
+      const char* getView(size_t length) throw(FFStreamError, EndOfFile);
 
          /**
           * Reads a T-object directly from the stream
@@ -168,6 +205,22 @@ namespace gpstk
          return;
       } // end of writeData(const char*, size_t)
 
+   private:
+         /// The streambuf over the map of the file
+      class MapBuffer;
+
+         /// Maps the file, if it is a regular file opened for input only,
+         /// and reads from the map from then on
+      void mapFile(std::ios::openmode mode);
+
+         /// Goes back to the filebuf, if it was replaced by the map
+      void unmapFile();
+
+      MapBuffer* mapBuffer;
+
+         /// Holds what getView() returns when the stream is not mapped
+      std::vector<char> viewBuffer;
+
    };
    //@}
 }
@@ -47,6 +47,7 @@
 
 
 #include "FFStream.hpp"
+#include "FormattedLine.hpp"
 
 namespace gpstk
 {
@@ -136,6 +137,19 @@ namespace gpstk
          throw(EndOfFile, FFStreamError, gpstk::StringUtils::StringException);
 
 
+         /// Buffer in which the record writers build one output line at a
+         /// time; it keeps its memory from one line to the next.
+      FormattedLine formattedLine;
+
+
+         /**
+          * Write formattedLine and a newline to the stream, without
+          * flushing, and increment lineNumber. The line is not cleared.
+          */
+      void formattedPutLine()
+      { formattedLine.write(*this); lineNumber++; };
+
+
    protected:
 
 
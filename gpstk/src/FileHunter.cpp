@@ -48,10 +48,19 @@
  * Find all files matching a specification.
  */
 
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #include "FileHunter.hpp"
 #include "YDSTime.hpp"
 #include "CivilTime.hpp"
 #include "GPSWeekSecond.hpp"
+#include "ThreadPool.hpp"
 
 using namespace std;
 using namespace gpstk;
@@ -71,30 +80,53 @@ namespace gpstk
 {
    FileHunter::FileHunter(const string& filespec)
       throw(FileHunterException)
+         : index(NULL), indexMaxAge(60.0)
    {
+#ifndef _WIN32
+      pthread_mutex_init(&indexLock, NULL);
+#endif
       try
       {
          init(filespec);
       }
       catch (FileHunterException& e)
       {
+#ifndef _WIN32
+         pthread_mutex_destroy(&indexLock);
+#endif
          GPSTK_RETHROW(e);
       }
    }
 
    FileHunter::FileHunter(const FileSpec& filespec)
       throw(FileHunterException)
+         : index(NULL), indexMaxAge(60.0)
    {
+#ifndef _WIN32
+      pthread_mutex_init(&indexLock, NULL);
+#endif
       try
       {
          init(filespec.getSpecString());
       }
       catch (FileHunterException& e)
       {
+#ifndef _WIN32
+         pthread_mutex_destroy(&indexLock);
+#endif
          GPSTK_RETHROW(e);
       }
    }
 
+   FileHunter::~FileHunter()
+      throw()
+   {
+      dropIndex();
+#ifndef _WIN32
+      pthread_mutex_destroy(&indexLock);
+#endif
+   }
+
    FileHunter& FileHunter::newHunt(const string& filespec)
       throw(FileHunterException)
    {
@@ -174,7 +206,30 @@ namespace gpstk
                               static_cast<CivilTime>(start).minute, 0.0);
             break;
       }
-      
+
+      if (index != NULL)
+      {
+         vector<string> found;
+#ifndef _WIN32
+         pthread_mutex_lock(&indexLock);
+#endif
+         try
+         {
+            found = findInIndex(exStart, end, fsst);
+         }
+         catch (FileHunterException& e)
+         {
+#ifndef _WIN32
+            pthread_mutex_unlock(&indexLock);
+#endif
+            GPSTK_RETHROW(e);
+         }
+#ifndef _WIN32
+         pthread_mutex_unlock(&indexLock);
+#endif
+         return found;
+      }
+
       vector<string> toReturn;
          // seed the return vector with an empty string.  you'll see why later
       toReturn.push_back(string());
@@ -362,6 +417,7 @@ namespace gpstk
       {
          fileSpecList.clear();
          filterList.clear();
+         dropIndex();
 
          string fs(filespec);
 
@@ -706,6 +762,557 @@ namespace gpstk
    }
 
 
+      // A directory or file in the index.  The children are the entries
+      // matching the FileSpec of the next level, sorted with those that
+      // have no time first, then by time.
+   struct FileHunter::IndexNode
+   {
+      IndexNode() : hasTime(false), mtime(-1) {}
+      ~IndexNode()
+      {
+         for (size_t i = 0; i < children.size(); i++)
+            delete children[i];
+      }
+
+      string name;                  ///< name in the parent directory
+      string path;                  ///< full path
+      bool hasTime;                 ///< true if the FileSpec gives a time
+      CommonTime time;              ///< the time, if hasTime
+      long mtime;                   ///< modification time when read; -1 if
+                                    ///< the directory must be read again
+      vector<IndexNode*> children;  ///< matching entries
+
+         // Order of the children
+      static bool less(const IndexNode *a, const IndexNode *b)
+      {
+         if (a->hasTime != b->hasTime)
+            return !a->hasTime;
+         if (a->hasTime && a->time != b->time)
+            return a->time < b->time;
+         return a->name < b->name;
+      }
+
+         // Writes the subtree below this node to an index file, one line
+         // per entry, preceded by its depth below the root.
+      void save(ostream& s, int depth) const
+      {
+         for (size_t i = 0; i < children.size(); i++)
+         {
+            const IndexNode& child = *children[i];
+            long day = 0, msod = 0;
+            double fsod = 0.0;
+            TimeSystem ts;
+            if (child.hasTime)
+               child.time.getInternal(day, msod, fsod, ts);
+            s << depth << ' ' << child.mtime << ' '
+              << (child.hasTime ? 1 : 0) << ' ' << day << ' ' << msod << ' '
+              << fsod << ' ' << int(ts.getTimeSystem()) << ' ' << child.name
+              << '\n';
+            child.save(s, depth+1);
+         }
+      }
+   };
+
+      // The index
+   struct FileHunter::Index
+   {
+      Index() : firstLevel(0), nthreads(0), refreshed(0) {}
+
+      IndexNode root;         ///< the starting directory
+      size_t firstLevel;      ///< level of fileSpecList below root
+      unsigned int nthreads;  ///< threads used to read directories
+      time_t refreshed;       ///< when the last refresh started
+   };
+
+      // Path of an entry of a directory, as find() makes it
+   static string joinPath(const string& dir, const string& name)
+   {
+#ifdef _WIN32
+      if (dir.empty())
+         return name;
+      if (dir[dir.size()-1] == '\\')
+         return dir + name;
+      return dir + string(1,'\\') + name;
+#else
+      return dir + string(1,slash) + name;
+#endif
+   }
+
+      // Reads one directory of the index, if it was modified since it was
+      // last read.  Entries already in the index keep their subtrees.
+   class FileHunter::ScanTask : public ThreadPool::Task
+   {
+   public:
+      ScanTask() : hunter(NULL), node(NULL), spec(NULL), started(0),
+                   failed(false) {}
+
+      const FileHunter *hunter;  ///< for searchHelper()
+      IndexNode *node;           ///< the directory
+      const FileSpec *spec;      ///< FileSpec of the entries
+      time_t started;            ///< when the refresh started
+      bool failed;               ///< true if run() caught an exception
+      Exception error;           ///< the exception, if failed
+
+      void run() throw()
+      {
+         try
+         {
+            scan();
+         }
+         catch (Exception& e)
+         {
+            error = e;
+            failed = true;
+         }
+         catch (std::exception& e)
+         {
+            error = Exception("std::exception: " + string(e.what()));
+            failed = true;
+         }
+         catch (...)
+         {
+            error = Exception("unknown exception");
+            failed = true;
+         }
+      }
+
+   private:
+      void scan()
+      {
+         string dir(node->path.empty() ? string(1,slash) : node->path);
+         struct stat st;
+         if ((stat(dir.c_str(), &st) != 0) || !S_ISDIR(st.st_mode))
+         {
+               // gone, or not a directory: nothing below it
+            clear();
+            return;
+         }
+         if ((node->mtime >= 0) && (long(st.st_mtime) == node->mtime))
+            return;
+
+         vector<string> names;
+         try
+         {
+            names = hunter->searchHelper(node->path, *spec);
+         }
+         catch (FileHunterException& e)
+         {
+               // unreadable; try again at the next refresh
+            clear();
+            return;
+         }
+
+         map<string, IndexNode*> old;
+         for (size_t i = 0; i < node->children.size(); i++)
+            old[node->children[i]->name] = node->children[i];
+
+         vector<IndexNode*> children;
+         for (size_t i = 0; i < names.size(); i++)
+         {
+            map<string, IndexNode*>::iterator itr = old.find(names[i]);
+            if (itr != old.end())
+            {
+               children.push_back(itr->second);
+               old.erase(itr);
+               continue;
+            }
+
+            IndexNode *child = new IndexNode;
+            child->name = names[i];
+            child->path = joinPath(node->path, names[i]);
+            try
+            {
+               child->time = spec->extractCommonTime(names[i]);
+               child->hasTime = true;
+            }
+            catch (FileSpecException& e)
+            {
+                  // find() keeps such entries for any time range
+            }
+            children.push_back(child);
+         }
+
+         for (map<string, IndexNode*>::iterator itr = old.begin();
+              itr != old.end(); itr++)
+            delete itr->second;
+
+         sort(children.begin(), children.end(), IndexNode::less);
+         node->children.swap(children);
+
+            // a directory modified during the second it was read may have
+            // changed after it was read: read it again next time.
+         node->mtime = (st.st_mtime >= started) ? -1 : long(st.st_mtime);
+      }
+
+      void clear()
+      {
+         for (size_t i = 0; i < node->children.size(); i++)
+            delete node->children[i];
+         node->children.clear();
+         node->mtime = -1;
+      }
+   };
+
+   void FileHunter::buildIndex(unsigned int nthreads)
+      throw(FileHunterException)
+   {
+      dropIndex();
+      index = new Index;
+      index->nthreads = nthreads;
+
+         // start where find() does
+#ifdef _WIN32
+      if (!fileSpecList.empty())
+      {
+         index->root.path = fileSpecList[0].getSpecString() + string(1,'\\');
+         index->firstLevel = 1;
+      }
+#endif
+#ifdef __CYGWIN__
+      if (!fileSpecList.empty())
+      {
+         index->root.path = string(1,slash) + fileSpecList[0].getSpecString();
+         index->firstLevel = 1;
+      }
+#endif
+
+      try
+      {
+         updateIndex();
+      }
+      catch (FileHunterException& e)
+      {
+         dropIndex();
+         GPSTK_RETHROW(e);
+      }
+   }
+
+   void FileHunter::refreshIndex()
+      throw(FileHunterException)
+   {
+      try
+      {
+         if (index == NULL)
+            buildIndex();
+         else
+            updateIndex();
+      }
+      catch (FileHunterException& e)
+      {
+         GPSTK_RETHROW(e);
+      }
+   }
+
+   void FileHunter::setIndexMaxAge(double seconds)
+      throw()
+   {
+      indexMaxAge = seconds;
+   }
+
+   void FileHunter::dropIndex()
+      throw()
+   {
+      delete index;
+      index = NULL;
+   }
+
+   void FileHunter::updateIndex() const
+      throw(FileHunterException)
+   {
+      time_t started = time(NULL);
+
+      ThreadPool *pool = NULL;
+      try
+      {
+            // the directories of one level are read together; the
+            // next level is the entries found in them.
+         vector<IndexNode*> level(1, &index->root);
+         for (size_t lev = index->firstLevel;
+              (lev < fileSpecList.size()) && !level.empty(); lev++)
+         {
+            vector<ScanTask> tasks(level.size());
+            for (size_t i = 0; i < level.size(); i++)
+            {
+               tasks[i].hunter = this;
+               tasks[i].node = level[i];
+               tasks[i].spec = &fileSpecList[lev];
+               tasks[i].started = started;
+            }
+
+            unsigned int nthreads = index->nthreads;
+            if (nthreads == 0)
+               nthreads = ThreadPool::processorCount();
+            if ((nthreads > 1) && (tasks.size() > 1))
+            {
+               if (pool == NULL)
+                  pool = new ThreadPool(nthreads);
+               for (size_t i = 0; i < tasks.size(); i++)
+                  pool->submit(&tasks[i]);
+               pool->wait();
+            }
+            else
+            {
+               for (size_t i = 0; i < tasks.size(); i++)
+                  tasks[i].run();
+            }
+
+            for (size_t i = 0; i < tasks.size(); i++)
+            {
+               if (tasks[i].failed)
+               {
+                  FileHunterException fhe(tasks[i].error);
+                  fhe.addText("Index update failed");
+                  GPSTK_THROW(fhe);
+               }
+            }
+
+               // the entries of the last level are files
+            vector<IndexNode*> next;
+            if (lev+1 < fileSpecList.size())
+            {
+               for (size_t i = 0; i < level.size(); i++)
+                  next.insert(next.end(), level[i]->children.begin(),
+                              level[i]->children.end());
+            }
+            level.swap(next);
+         }
+      }
+      catch (FileHunterException& e)
+      {
+         delete pool;
+         GPSTK_RETHROW(e);
+      }
+      catch (Exception& e)
+      {
+         delete pool;
+         FileHunterException fhe(e);
+         fhe.addText("Index update failed");
+         GPSTK_THROW(fhe);
+      }
+      delete pool;
+
+      index->refreshed = started;
+   }
+
+   vector<string> FileHunter::findInIndex(const CommonTime& start,
+                                          const CommonTime& end,
+                                          const FileSpec::FileSpecSortType fsst)
+      const throw(FileHunterException)
+   {
+      if ((indexMaxAge >= 0) &&
+          (difftime(time(NULL), index->refreshed) >= indexMaxAge))
+      {
+         try
+         {
+            updateIndex();
+         }
+         catch (FileHunterException& e)
+         {
+            GPSTK_RETHROW(e);
+         }
+      }
+
+      vector<string> toReturn;
+      if (index->firstLevel >= fileSpecList.size())
+         return toReturn;
+
+         // keeps the entries inside the time range, as find() does;
+         // the times of the file names have no time system.
+      IndexNode key;
+      key.hasTime = true;
+      key.time = start;
+      key.time.setTimeSystem(TimeSystem::Any);
+      CommonTime last(end);
+      last.setTimeSystem(TimeSystem::Any);
+
+      vector<const IndexNode*> level(1, &index->root);
+      for (size_t lev = index->firstLevel; lev < fileSpecList.size(); lev++)
+      {
+         vector<const IndexNode*> next;
+         for (size_t i = 0; i < level.size(); i++)
+         {
+            const vector<IndexNode*>& children = level[i]->children;
+            vector<IndexNode*>::const_iterator itr =
+               lower_bound(children.begin(), children.end(), &key,
+                           IndexNode::less);
+            vector<IndexNode*> found;
+            for (size_t j = 0; (j < children.size()) &&
+                    !children[j]->hasTime; j++)
+               found.push_back(children[j]);
+            for (; (itr != children.end()) && ((*itr)->time <= last); itr++)
+               found.push_back(*itr);
+
+            if (filterList.empty())
+            {
+               next.insert(next.end(), found.begin(), found.end());
+               continue;
+            }
+
+               // filterHelper() keeps the order of the names
+            vector<string> names;
+            for (size_t j = 0; j < found.size(); j++)
+               names.push_back(found[j]->name);
+            try
+            {
+               filterHelper(names, fileSpecList[lev]);
+            }
+            catch (FileHunterException& e)
+            {
+               GPSTK_RETHROW(e);
+            }
+            size_t k = 0;
+            for (size_t j = 0; (j < found.size()) && (k < names.size()); j++)
+            {
+               if (found[j]->name == names[k])
+               {
+                  next.push_back(found[j]);
+                  k++;
+               }
+            }
+         }
+         level.swap(next);
+         if (level.empty())
+            return toReturn;
+      }
+
+      for (size_t i = 0; i < level.size(); i++)
+         toReturn.push_back(level[i]->path);
+
+      try
+      {
+         fileSpecList.back().sortList(toReturn, fsst);
+      }
+      catch (FileSpecException& e)
+      {
+         FileHunterException fhe(e);
+         fhe.addText("Sorting the index search failed");
+         GPSTK_THROW(fhe);
+      }
+      return toReturn;
+   }
+
+   void FileHunter::saveIndex(const string& filename) const
+      throw(FileHunterException)
+   {
+      if (index == NULL)
+      {
+         FileHunterException fhe("There is no index to save");
+         GPSTK_THROW(fhe);
+      }
+
+      ofstream s(filename.c_str());
+      s.precision(17);
+      s << "FileHunter index 1\n"
+        << fileSpecList.size() << '\n';
+      for (size_t i = 0; i < fileSpecList.size(); i++)
+         s << fileSpecList[i].getSpecString() << '\n';
+#ifndef _WIN32
+      pthread_mutex_lock(&indexLock);
+#endif
+      s << index->firstLevel << ' ' << long(index->refreshed) << ' '
+        << index->root.path << '\n';
+      index->root.save(s, 0);
+#ifndef _WIN32
+      pthread_mutex_unlock(&indexLock);
+#endif
+
+      s.close();
+      if (!s)
+      {
+         FileHunterException fhe("Cannot write the index file " + filename);
+         GPSTK_THROW(fhe);
+      }
+   }
+
+   void FileHunter::loadIndex(const string& filename, unsigned int nthreads)
+      throw(FileHunterException)
+   {
+      ifstream s(filename.c_str());
+      if (!s)
+      {
+         FileHunterException fhe("Cannot open the index file " + filename);
+         GPSTK_THROW(fhe);
+      }
+
+      string line;
+      size_t n = 0;
+      getline(s, line);
+      bool ok = (line == "FileHunter index 1");
+      if (ok && getline(s, line))
+         ok = (asInt(line) == int(fileSpecList.size()));
+      for (n = 0; ok && (n < fileSpecList.size()); n++)
+         ok = (getline(s, line) &&
+               (line == fileSpecList[n].getSpecString()));
+      if (!ok)
+      {
+         FileHunterException fhe("The index file " + filename +
+                                 " is not for this file specification");
+         GPSTK_THROW(fhe);
+      }
+
+      Index *newIndex = new Index;
+      newIndex->nthreads = nthreads;
+      {
+         long refreshed = 0;
+         getline(s, line);
+         istringstream is(line);
+         is >> newIndex->firstLevel >> refreshed;
+         is.get();
+         getline(is, newIndex->root.path);
+         newIndex->refreshed = time_t(refreshed);
+         ok = !is.fail() || is.eof();
+      }
+
+         // the path from the root to the last node read
+      vector<IndexNode*> parents(1, &newIndex->root);
+      while (ok && getline(s, line))
+      {
+         istringstream is(line);
+         size_t depth;
+         long mtime, day, msod;
+         int hasTime, system;
+         double fsod;
+         is >> depth >> mtime >> hasTime >> day >> msod >> fsod >> system;
+         if (!is || (is.get() != ' ') || (depth >= parents.size()))
+         {
+            ok = false;
+            break;
+         }
+
+         IndexNode *node = new IndexNode;
+         parents[depth]->children.push_back(node);
+         getline(is, node->name);
+         node->mtime = mtime;
+         node->hasTime = (hasTime != 0);
+         if (node->hasTime)
+         {
+            try
+            {
+               node->time.setInternal(day, msod, fsod,
+                                      TimeSystem(TimeSystem::Systems(system)));
+            }
+            catch (Exception& e)
+            {
+               ok = false;
+               break;
+            }
+         }
+         node->path = joinPath(parents[depth]->path, node->name);
+         parents.resize(depth+1);
+         parents.push_back(node);
+      }
+
+      if (!ok || s.bad())
+      {
+         delete newIndex;
+         FileHunterException fhe("Error reading the index file " + filename);
+         GPSTK_THROW(fhe);
+      }
+
+      dropIndex();
+      index = newIndex;
+   }
+
    void FileHunter::dump(ostream& o) const
    {
       vector<FileSpec>::const_iterator itr = fileSpecList.begin();
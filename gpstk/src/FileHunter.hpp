@@ -53,6 +53,10 @@
 
 #include "FileSpec.hpp"
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 namespace gpstk
 {
    /** @addtogroup filedirgroup */
@@ -100,6 +104,18 @@ namespace gpstk
        * be reurned.  You can either use extractField() on the returned files
        * to determine the latest version or select the version you want
        * returned by using setFilter().
+       *
+       * Index:  When the same specification is searched many times (for
+       * instance, once per day over a large archive), call buildIndex()
+       * once.  This reads every directory that matches the specification,
+       * several directories at a time, and keeps the matching names and
+       * their times in memory.  find() then answers from the index, going
+       * only into the directories whose times fall in the requested range,
+       * without reading the disk.  When the index is older than the age set
+       * with setIndexMaxAge(), find() first refreshes it: each indexed
+       * directory is checked with stat(), and only those modified since
+       * they were read are read again.  saveIndex() and loadIndex() keep
+       * the index in a file, for use by later programs.
        */
    class FileHunter
    {
@@ -136,7 +152,10 @@ namespace gpstk
       FileHunter(const FileSpec& filespec)
          throw(FileHunterException);
 
-         /** 
+         /// Destructor; frees the index.
+      ~FileHunter() throw();
+
+         /**
           * Rather than building a new file hunter, this lets you change
           * the filespec you're searching for.
           * @throw FileHunterException when there's a problem with the filespec
@@ -167,7 +186,9 @@ namespace gpstk
           * Does the searching for the files.  Set /a start and /a end
           * for specifying times of files (according to their file names)
           * for returning.
-          * \warning This method is NOT MT-Safe.
+          * \warning This method is NOT MT-Safe, except with an index
+          * where threads are available: the index is locked while it is
+          * refreshed and searched, so several threads can share it.
           * @param start the start time to limit the search
           * @param end the end time to limit the search
           * @param fsst set to change the order the list is returned
@@ -175,15 +196,74 @@ namespace gpstk
           * @return a list of files matching the file specification,
           *   start and end times, and filters ordered according to fsst.
           *   This list can be empty if no files are found.
+          *   If there is an index, it is used (and refreshed if it is too
+          *   old), and an unsorted list is in time order.
           * @throw FileHunterException when there's a problem searching.
           */
-      std::vector<std::string> 
+      std::vector<std::string>
       find(const gpstk::CommonTime& start = gpstk::CommonTime::BEGINNING_OF_TIME,
            const gpstk::CommonTime& end = gpstk::CommonTime::END_OF_TIME,
            const FileSpec::FileSpecSortType fsst = FileSpec::ascending,
            enum FileChunking chunk = DAY) const
          throw(FileHunterException);
 
+         /**
+          * Reads all the directories matching the file specification and
+          * keeps the matching entries in an index, used by find() from
+          * then on.  Directories of the same level are read concurrently.
+          * A directory that cannot be read is indexed as empty, and read
+          * again by the next refresh.
+          * \warning This method is NOT MT-Safe.
+          * @param nthreads number of threads reading directories; 0 means
+          *   one per processor.
+          * @throw FileHunterException when there's a problem searching.
+          */
+      void buildIndex(unsigned int nthreads = 0)
+         throw(FileHunterException);
+
+         /**
+          * Brings the index up to date, reading again only the directories
+          * modified since they were read.  Builds the index if there is
+          * none.
+          * @throw FileHunterException when there's a problem searching.
+          */
+      void refreshIndex()
+         throw(FileHunterException);
+
+         /**
+          * Sets how old the index may get before find() refreshes it.
+          * @param seconds maximum age; 0 refreshes on every find(), and a
+          *   negative age never refreshes automatically.  The default is
+          *   60 seconds.
+          */
+      void setIndexMaxAge(double seconds) throw();
+
+         /// Returns true if find() uses an index.
+      bool hasIndex() const throw()
+         {return (index != NULL);}
+
+         /// Frees the index; find() searches the disk again.
+      void dropIndex() throw();
+
+         /**
+          * Writes the index to a text file.
+          * @throw FileHunterException if there is no index or the file
+          *   cannot be written.
+          */
+      void saveIndex(const std::string& filename) const
+         throw(FileHunterException);
+
+         /**
+          * Reads an index written by saveIndex() for the same file
+          * specification.  The age of the index is that of the saved one.
+          * @param filename the index file
+          * @param nthreads number of threads used to refresh the index
+          * @throw FileHunterException if the file cannot be read, or was
+          *   written for a different file specification.
+          */
+      void loadIndex(const std::string& filename, unsigned int nthreads = 0)
+         throw(FileHunterException);
+
          /// outputs the file spec into a semi-readable format
       void dump(std::ostream& o) const;
 
@@ -212,11 +292,47 @@ namespace gpstk
                         const FileSpec& fs) const
          throw(FileHunterException);
 
+         /// A directory or file in the index, and the matching entries
+         /// below it.  Defined in FileHunter.cpp.
+      struct IndexNode;
+
+         /// The index: its tree, settings and age.  Defined in
+         /// FileHunter.cpp.
+      struct Index;
+
+         /// Task reading one directory of the index.  Defined in
+         /// FileHunter.cpp.
+      class ScanTask;
+
+         /// Reads again the modified directories of the index, level by
+         /// level.  The index is a cache, so this is allowed in find(),
+         /// which holds indexLock while it runs.
+      void updateIndex() const
+         throw(FileHunterException);
+
+         /// find() using the index; the caller holds indexLock.
+      std::vector<std::string>
+      findInIndex(const gpstk::CommonTime& start,
+                  const gpstk::CommonTime& end,
+                  const FileSpec::FileSpecSortType fsst) const
+         throw(FileHunterException);
+
          /// Holds the broken down list of the file specification for searching
       std::vector<FileSpec> fileSpecList;
 
          /// Stores the list of things to filter for
       std::vector<FilterPair> filterList;
+
+         /// The index, or NULL if find() searches the disk
+      Index *index;
+
+         /// Maximum age of the index, in seconds, before find() refreshes it
+      double indexMaxAge;
+
+#ifndef _WIN32
+         /// Held by find() and saveIndex() while they use the index
+      mutable pthread_mutex_t indexLock;
+#endif
    }; // FileHunter
 
    //@}
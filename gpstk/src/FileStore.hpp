@@ -5,6 +5,8 @@
 #ifndef GPSTK_FILE_STORE_INCLUDE
 #define GPSTK_FILE_STORE_INCLUDE
 
+#include <map>
+#include <string>
 #include <vector>
 #include <iostream>
 #include <iomanip>
@@ -28,10 +30,17 @@ namespace gpstk
       /// A store of all headers loaded, indexed by file name
       std::map<std::string, HeaderType> headerMap;
 
+      /// Directory holding binary snapshots (see StoreCache) of the files loaded
+      /// into the store that owns this FileStore; empty means no snapshots.
+      std::string cacheDir;
+
+      /// Number of files whose records were taken from their snapshots
+      unsigned snapshotReads;
+
    public:
 
       /// Constructor.
-      FileStore() throw() {};
+      FileStore() throw() : snapshotReads(0) {};
 
       /// destructor
       ~FileStore() {};
@@ -58,6 +67,10 @@ namespace gpstk
          headerMap.insert(make_pair(fn,header));
       }
 
+      /// Return true if the file name is in the store
+      bool hasFile(const std::string& fn) const throw()
+         { return (headerMap.find(fn) != headerMap.end()); }
+
       /// Access the header for a given filename
       const HeaderType& getHeader(const std::string& fn) const throw(InvalidRequest)
       {
@@ -92,9 +105,33 @@ namespace gpstk
          throw()
       {
         headerMap.clear();
+        snapshotReads = 0;
       }
 
 
+      /// Set the directory in which binary snapshots of loaded files are kept.
+      /// When it is set, the owning store's loadFile() reads a file's snapshot,
+      /// if one exists and is up to date, instead of parsing the file, and
+      /// writes one after parsing otherwise. An empty string turns this off.
+      void setCacheDirectory(const std::string& dir) throw()
+         { cacheDir = dir; }
+
+      /// Get the snapshot directory; empty if snapshots are not used
+      const std::string& getCacheDirectory() const throw()
+         { return cacheDir; }
+
+      /// Return true if a snapshot directory has been set
+      bool isCaching() const throw()
+         { return !cacheDir.empty(); }
+
+      /// Count a file loaded from its snapshot rather than parsed
+      void countSnapshotRead() throw()
+         { snapshotReads++; }
+
+      /// Return the number of files loaded from their snapshots
+      unsigned getSnapshotReads() const throw()
+         { return snapshotReads; }
+
       /// Return the size of the (filename,header) map
       unsigned size() const throw() { return headerMap.size(); }
 
@@ -0,0 +1,260 @@
+#pragma ident "$Id$"
+
+/// @file FormattedLine.cpp
+/// A reusable character buffer for building one line of a fixed-format text
+/// file (RINEX, SP3, ...) field by field, without temporary strings.
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "FormattedLine.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   using namespace StringUtils;
+
+   /// Size of the scratch buffer used to format one number; enough for any
+   /// number in scientific notation, and for fixed-point numbers of moderate size.
+   static const size_t scratchSize = 64;
+
+   FormattedLine::FormattedLine()
+      : buffer(new char[128]), length(0), capacity(128)
+   {
+      buffer[0] = '\0';
+   }
+
+   FormattedLine::FormattedLine(const FormattedLine& right)
+      : buffer(new char[right.capacity]), length(right.length),
+        capacity(right.capacity)
+   {
+      ::memcpy(buffer, right.buffer, length+1);
+   }
+
+   FormattedLine& FormattedLine::operator=(const FormattedLine& right)
+   {
+      if(this != &right) {
+         length = 0;
+         reserve(right.length);
+         ::memcpy(buffer, right.buffer, right.length+1);
+         length = right.length;
+      }
+      return *this;
+   }
+
+   // Make room for n more characters and the terminating zero
+   void FormattedLine::reserve(size_t n)
+   {
+      if(length + n + 1 <= capacity) return;
+
+      size_t newcap(2*capacity);
+      if(newcap < length + n + 1) newcap = length + n + 1;
+      char *newbuf = new char[newcap];
+      ::memcpy(newbuf, buffer, length+1);
+      delete[] buffer;
+      buffer = newbuf;
+      capacity = newcap;
+   }
+
+   // Append the n characters at s right justified in a field of width
+   // characters; if n > width, only the last width characters are kept.
+   void FormattedLine::appendRight(const char *s, size_t n, size_t width, char pad)
+   {
+      reserve(width);
+      if(n > width) {
+         ::memcpy(buffer+length, s+n-width, width);
+      }
+      else {
+         ::memset(buffer+length, pad, width-n);
+         ::memcpy(buffer+length+width-n, s, n);
+      }
+      length += width;
+      buffer[length] = '\0';
+   }
+
+   FormattedLine& FormattedLine::add(char c, size_t n)
+   {
+      reserve(n);
+      ::memset(buffer+length, c, n);
+      length += n;
+      buffer[length] = '\0';
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::add(const char *s)
+   {
+      size_t n(::strlen(s));
+      reserve(n);
+      ::memcpy(buffer+length, s, n+1);
+      length += n;
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::add(const string& s)
+   {
+      reserve(s.size());
+      ::memcpy(buffer+length, s.data(), s.size());
+      length += s.size();
+      buffer[length] = '\0';
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::addRight(const string& s, size_t width, char pad)
+   {
+      appendRight(s.data(), s.size(), width, pad);
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::addInt(long value, size_t width, char pad)
+   {
+      char tmp[scratchSize];
+      int n = ::snprintf(tmp, scratchSize, "%ld", value);
+      appendRight(tmp, n, width, pad);
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::addUnsigned(unsigned long value, size_t width,
+                                             char pad)
+   {
+      char tmp[scratchSize];
+      int n = ::snprintf(tmp, scratchSize, "%lu", value);
+      appendRight(tmp, n, width, pad);
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::addPadded(long value, size_t width, char fill)
+   {
+      char tmp[scratchSize];
+      size_t n = ::snprintf(tmp, scratchSize, "%ld", value);
+      appendRight(tmp, n, (n > width ? n : width), fill);
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::addFixed(double value, int precision, size_t width)
+   {
+      char tmp[scratchSize];
+      int n = ::snprintf(tmp, scratchSize, "%.*f", precision, value);
+      if(n >= 0 && size_t(n) < scratchSize)
+         appendRight(tmp, n, width, ' ');
+      else {                                 // very large number
+         string str(StringUtils::asString(value, precision));
+         appendRight(str.data(), str.size(), width, ' ');
+      }
+      return *this;
+   }
+
+   // Same as doubleToScientific(value, length, precision, explen, showPlus)
+   FormattedLine& FormattedLine::addScientific(double value, size_t fieldlen,
+                                               size_t precision, size_t explen,
+                                               bool showPlus)
+   {
+      // the StringUtils routine does odd things with inf and nan
+      if(!(::fabs(value) <= HUGE_VAL) || ::fabs(value) == HUGE_VAL) {
+         add(doubleToScientific(value, fieldlen, precision, explen, showPlus));
+         return *this;
+      }
+
+      size_t elen = (explen > 0 ? (explen < 3 ? explen : 3) : 1);
+      int prec = (precision > 0 ? int(precision) : 1);
+      size_t leng = (fieldlen > 0 ? fieldlen : 1);
+
+      char tmp[scratchSize];
+      int n = ::snprintf(tmp, scratchSize, (showPlus ? "%+.*e" : "%.*e"),
+                         prec, value);
+      if(n < 0 || size_t(n) >= scratchSize) {
+         add(doubleToScientific(value, fieldlen, precision, explen, showPlus));
+         return *this;
+      }
+
+      // mantissa, 'e' and the sign of the exponent; then the exponent
+      // rewritten with elen digits
+      const char *e = ::strchr(tmp, 'e');
+      size_t nman(e - tmp + 2);
+      char exp[scratchSize];
+      size_t nexp = ::snprintf(exp, scratchSize, "%ld", ::strtol(e+2, 0, 10));
+
+      size_t total(nman + elen);
+      if(total < leng) add(' ', leng-total);
+      reserve(nman);
+      ::memcpy(buffer+length, tmp, nman);
+      length += nman;
+      appendRight(exp, nexp, elen, '0');
+      return *this;
+   }
+
+   // Same as doub2for(value, length, explen, checkSwitch)
+   FormattedLine& FormattedLine::addFortran(double value, size_t fieldlen,
+                                            size_t explen, bool checkSwitch)
+   {
+      short exponentLength = explen;
+      if(exponentLength < 0) exponentLength = 1;
+      if(exponentLength > 3 && checkSwitch) exponentLength = 3;
+
+      // leave inf, nan, numbers so small that the StringUtils routine may not
+      // recognize them as non-zero, and fields too short to hold a decimal
+      // point, to the StringUtils routine
+      double mag(::fabs(value));
+      if(!(mag < HUGE_VAL) || (mag != 0.0 && mag < 1.e-290) ||
+         fieldlen < size_t(exponentLength) + 6)
+      {
+         add(doub2for(value, fieldlen, explen, checkSwitch));
+         return *this;
+      }
+
+      char tmp[scratchSize];
+      int n = ::snprintf(tmp, scratchSize, "%.*e",
+                         int(fieldlen - exponentLength - 5), value);
+      if(n < 0 || size_t(n) >= scratchSize) {
+         add(doub2for(value, fieldlen, explen, checkSwitch));
+         return *this;
+      }
+
+      // tmp is [-]d.ddde+xx; write [-| ][0].dddd{D|E}+xx, where the exponent
+      // is one larger unless the value is zero
+      const char *e = ::strchr(tmp, 'e');
+      const char *digit = (tmp[0] == '-' ? tmp+1 : tmp);
+      long iexp(::strtol(e+1, 0, 10) + (value != 0.0 ? 1 : 0));
+
+      reserve((e - tmp) + 4);
+      buffer[length++] = (tmp[0] == '-' ? '-' : ' ');
+      if(!checkSwitch) buffer[length++] = '0';
+      buffer[length++] = '.';
+      buffer[length++] = *digit;
+      for(const char *p = digit+2; p < e; p++)
+         buffer[length++] = *p;
+      buffer[length++] = (checkSwitch ? 'D' : 'E');
+      buffer[length++] = (iexp < 0 ? '-' : '+');
+      buffer[length] = '\0';
+
+      char exp[scratchSize];
+      size_t nexp = ::snprintf(exp, scratchSize, "%ld", (iexp < 0 ? -iexp : iexp));
+      appendRight(exp, nexp, exponentLength, '0');
+      return *this;
+   }
+
+   FormattedLine& FormattedLine::print(const char *fmt, ...)
+   {
+      char tmp[256];
+      va_list ap;
+      va_start(ap, fmt);
+      int n = ::vsnprintf(tmp, sizeof(tmp), fmt, ap);
+      va_end(ap);
+      if(n < 0) return *this;
+
+      reserve(n);
+      if(size_t(n) < sizeof(tmp))
+         ::memcpy(buffer+length, tmp, n+1);
+      else {
+         va_start(ap, fmt);
+         ::vsnprintf(buffer+length, n+1, fmt, ap);
+         va_end(ap);
+      }
+      length += n;
+      return *this;
+   }
+
+}  // End of namespace gpstk
@@ -0,0 +1,154 @@
+#pragma ident "$Id$"
+
+/// @file FormattedLine.hpp
+/// A reusable character buffer for building one line of a fixed-format text
+/// file (RINEX, SP3, ...) field by field, without temporary strings.
+
+#ifndef GPSTK_FORMATTED_LINE_INCLUDE
+#define GPSTK_FORMATTED_LINE_INCLUDE
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+#include "StringUtils.hpp"
+
+namespace gpstk
+{
+   /** @addtogroup formattedfile */
+   //@{
+
+   /// Build a line of text field by field in a buffer that keeps its memory from
+   /// one line to the next; once the buffer has grown to the longest line, no
+   /// further allocation is done.
+   ///
+   /// Each add routine produces exactly the characters of the StringUtils
+   /// expression named in its documentation, including the way a value that
+   /// does not fit the field is handled (rightJustify() keeps the rightmost
+   /// characters, printf-style widths never truncate). Unusual values (e.g. NaN,
+   /// or fixed-point numbers of more than 60 characters) are passed to the
+   /// StringUtils routine itself, so the output is always the same.
+   ///
+   /// FFTextStream holds one of these per stream (FFTextStream::formattedLine),
+   /// for use by the reallyPutRecord() routines of the text formats:
+   /// @code
+   ///    FormattedLine& line(strm.formattedLine);
+   ///    line.clear();
+   ///    line.add(' ').addInt(epochFlag,1).addFixed(clockOffset,9,12);
+   ///    strm.formattedPutLine();
+   /// @endcode
+   class FormattedLine
+   {
+   public:
+
+      /// Constructor
+      FormattedLine();
+
+      /// Destructor
+      ~FormattedLine() throw()
+         { delete[] buffer; }
+
+      /// Copy constructor
+      FormattedLine(const FormattedLine& right);
+
+      /// Assignment
+      FormattedLine& operator=(const FormattedLine& right);
+
+      /// Empty the line; the memory is kept.
+      void clear() throw()
+         { length = 0; buffer[0] = '\0'; }
+
+      /// Number of characters in the line
+      std::size_t size() const throw()
+         { return length; }
+
+      /// The line as a zero-terminated string
+      const char *c_str() const throw()
+         { return buffer; }
+
+      /// The line as a std::string (this allocates)
+      std::string asString() const
+         { return std::string(buffer, length); }
+
+      /// Access one character of the line; i must be < size()
+      char& operator[](std::size_t i) throw()
+         { return buffer[i]; }
+
+      /// Append n copies of the character c
+      FormattedLine& add(char c, std::size_t n = 1);
+
+      /// Append a zero-terminated string
+      FormattedLine& add(const char *s);
+
+      /// Append a string
+      FormattedLine& add(const std::string& s);
+
+      /// Append s right justified in a field of the given width:
+      /// same as rightJustify(s, width, pad).
+      FormattedLine& addRight(const std::string& s, std::size_t width,
+                              char pad = ' ');
+
+      /// Append an integer right justified in a field of the given width:
+      /// same as rightJustify(asString(value), width, pad).
+      FormattedLine& addInt(long value, std::size_t width, char pad = ' ');
+
+      /// Append an unsigned integer right justified in a field of the given
+      /// width: same as rightJustify(asString(value), width, pad).
+      FormattedLine& addUnsigned(unsigned long value, std::size_t width,
+                                 char pad = ' ');
+
+      /// Append an integer padded on the left with fill to at least width
+      /// characters, but never truncated: same as ostream output with
+      /// setw(width) and setfill(fill).
+      FormattedLine& addPadded(long value, std::size_t width, char fill);
+
+      /// Append a fixed-point number right justified in a field of the given
+      /// width: same as rightJustify(asString(value, precision), width).
+      FormattedLine& addFixed(double value, int precision, std::size_t width);
+
+      /// Append a number in scientific notation:
+      /// same as doubleToScientific(value, length, precision, explen, showPlus).
+      FormattedLine& addScientific(double value, std::size_t length,
+                                   std::size_t precision, std::size_t explen,
+                                   bool showPlus = false);
+
+      /// Append a number in FORTRAN notation:
+      /// same as doub2for(value, length, explen, checkSwitch).
+      /// @throw StringUtils::StringException as doub2for() does (never for finite
+      ///    numbers with length > explen+5)
+      FormattedLine& addFortran(double value, std::size_t length,
+                                std::size_t explen, bool checkSwitch = true);
+
+      /// Append the output of printf(fmt, ...); same as sprintf() into a buffer
+      /// of sufficient size, appended to the line.
+      FormattedLine& print(const char *fmt, ...);
+
+      /// Write the line and a newline (without flushing) to a stream
+      void write(std::ostream& os) const
+         { os.write(buffer, length); os.put('\n'); }
+
+   private:
+
+      /// Make room for n more characters and the terminating zero
+      void reserve(std::size_t n);
+
+      /// Append the n characters at s right justified in a field of the given
+      /// width, as rightJustify() does.
+      void appendRight(const char *s, std::size_t n, std::size_t width, char pad);
+
+      /// The characters of the line, zero-terminated
+      char *buffer;
+
+      /// Number of characters in the line
+      std::size_t length;
+
+      /// Size of buffer
+      std::size_t capacity;
+
+   }; // end class FormattedLine
+
+   //@}
+
+}  // End of namespace gpstk
+
+#endif // GPSTK_FORMATTED_LINE_INCLUDE
@@ -47,6 +47,8 @@
 
 #include "StringUtils.hpp"
 #include "GPSEphemerisStore.hpp"
+#include "Rinex3NavData.hpp"
+#include "StoreCache.hpp"
 #include "MathBase.hpp"
 #include "CivilTime.hpp"
 #include "TimeString.hpp"
@@ -441,5 +443,126 @@ namespace gpstk
       }
       return(prn_i->second);
    }
-   
+
+//-----------------------------------------------------------------------------
+
+   // A GPS ephemeris as stored in a binary snapshot: the fields of the
+   // Rinex3NavData record that EngEphemeris is converted to and from.
+   struct GPSEphCacheRecord
+   {
+      StoreCache::TimeRecord time;
+      Int32 PRNID, HOWtime, weeknum, health, codeflgs, L2Pdata;
+      double accuracy, IODC, IODE, fitint;
+      double Toc, af0, af1, af2, Tgd;
+      double Cuc, Cus, Crc, Crs, Cic, Cis;
+      double Toe, M0, dn, ecc, Ahalf, OMEGA0, i0, w, OMEGAdot, idot;
+   };
+
+   // build the snapshot key from the source file names, sizes and times
+   static string gpsEphCacheKey(const vector<string>& sources)
+      throw(FileMissingException)
+   {
+      string key;
+      for(size_t i=0; i<sources.size(); i++)
+         key += StoreCache::sourceKey(sources[i]);
+      return key;
+   }
+
+   void GPSEphemerisStore::saveCache( const string& cacheFile,
+                                      const vector<string>& sources ) const
+      throw( Exception )
+   {
+      try
+      {
+         vector<GPSEphCacheRecord> recs;
+         recs.reserve(ubeSize());
+
+         UBEMap::const_iterator prn_i;
+         for (prn_i = ube.begin(); prn_i != ube.end(); prn_i++)
+         {
+            const EngEphMap& em = prn_i->second;
+            EngEphMap::const_iterator ei;
+            for (ei = em.begin(); ei != em.end(); ei++)
+            {
+               Rinex3NavData rnd(ei->second);
+               GPSEphCacheRecord rec;
+               rec.time = StoreCache::packTime(rnd.time);
+               rec.PRNID = rnd.PRNID;       rec.HOWtime = rnd.HOWtime;
+               rec.weeknum = rnd.weeknum;   rec.health = rnd.health;
+               rec.codeflgs = rnd.codeflgs; rec.L2Pdata = rnd.L2Pdata;
+               rec.accuracy = rnd.accuracy; rec.IODC = rnd.IODC;
+               rec.IODE = rnd.IODE;         rec.fitint = rnd.fitint;
+               rec.Toc = rnd.Toc;           rec.af0 = rnd.af0;
+               rec.af1 = rnd.af1;           rec.af2 = rnd.af2;
+               rec.Tgd = rnd.Tgd;
+               rec.Cuc = rnd.Cuc;           rec.Cus = rnd.Cus;
+               rec.Crc = rnd.Crc;           rec.Crs = rnd.Crs;
+               rec.Cic = rnd.Cic;           rec.Cis = rnd.Cis;
+               rec.Toe = rnd.Toe;           rec.M0 = rnd.M0;
+               rec.dn = rnd.dn;             rec.ecc = rnd.ecc;
+               rec.Ahalf = rnd.Ahalf;       rec.OMEGA0 = rnd.OMEGA0;
+               rec.i0 = rnd.i0;             rec.w = rnd.w;
+               rec.OMEGAdot = rnd.OMEGAdot; rec.idot = rnd.idot;
+               recs.push_back(rec);
+            }
+         }
+
+         StoreCache cache;
+         cache.addSection("GEPH", recs);
+         cache.write(cacheFile, "GPSE", gpsEphCacheKey(sources));
+      }
+      catch(Exception& e) { GPSTK_RETHROW(e); }
+   }
+
+   bool GPSEphemerisStore::loadCache( const string& cacheFile,
+                                      const vector<string>& sources )
+      throw()
+   {
+      try
+      {
+         StoreCache cache;
+         const GPSEphCacheRecord *recs;
+         size_t nrec;
+         if(!cache.open(cacheFile, "GPSE", gpsEphCacheKey(sources)) ||
+            !cache.getSection("GEPH", recs, nrec))
+            return false;
+
+         // convert everything before changing the store
+         vector<EngEphemeris> ephs;
+         ephs.reserve(nrec);
+         for (size_t k = 0; k < nrec; k++)
+         {
+            const GPSEphCacheRecord& rec(recs[k]);
+            Rinex3NavData rnd;
+            rnd.time = StoreCache::unpackTime(rec.time);
+            rnd.satSys = "G";
+            rnd.PRNID = rec.PRNID;
+            rnd.sat = RinexSatID(rec.PRNID, SatID::systemGPS);
+            rnd.HOWtime = rec.HOWtime;       rnd.weeknum = rec.weeknum;
+            rnd.health = rec.health;         rnd.codeflgs = rec.codeflgs;
+            rnd.L2Pdata = rec.L2Pdata;       rnd.accuracy = rec.accuracy;
+            rnd.IODC = rec.IODC;             rnd.IODE = rec.IODE;
+            rnd.fitint = rec.fitint;
+            rnd.Toc = rec.Toc;               rnd.af0 = rec.af0;
+            rnd.af1 = rec.af1;               rnd.af2 = rec.af2;
+            rnd.Tgd = rec.Tgd;
+            rnd.Cuc = rec.Cuc;               rnd.Cus = rec.Cus;
+            rnd.Crc = rec.Crc;               rnd.Crs = rec.Crs;
+            rnd.Cic = rec.Cic;               rnd.Cis = rec.Cis;
+            rnd.Toe = rec.Toe;               rnd.M0 = rec.M0;
+            rnd.dn = rec.dn;                 rnd.ecc = rec.ecc;
+            rnd.Ahalf = rec.Ahalf;           rnd.OMEGA0 = rec.OMEGA0;
+            rnd.i0 = rec.i0;                 rnd.w = rec.w;
+            rnd.OMEGAdot = rec.OMEGAdot;     rnd.idot = rec.idot;
+            ephs.push_back(EngEphemeris(rnd));
+         }
+
+         for (size_t k = 0; k < ephs.size(); k++)
+            addEphemeris(ephs[k]);
+
+         return true;
+      }
+      catch(Exception& e) { return false; }
+   }
+
 } // namespace
@@ -48,6 +48,8 @@
 #include <iostream>
 #include <list>
 #include <map>
+#include <string>
+#include <vector>
 
 #include "Exception.hpp"
 #include "SatID.hpp"
@@ -260,6 +262,32 @@ namespace gpstk
       const EngEphMap& getEphMap( const SatID& sat ) const
          throw( InvalidRequest );
 
+      /// Save all the ephemerides in the store to a binary snapshot file (see
+      /// StoreCache), keyed on the names, sizes and modification times of the
+      /// files they were read from. Each ephemeris is stored as the values of
+      /// a RINEX navigation record, so quantities that RINEX does not carry
+      /// (TLM words, tracker, per-subframe HOW times and A-S flags) are not
+      /// preserved, just as when the store is written to a RINEX nav file.
+      /// @param cacheFile name of the snapshot file to write
+      /// @param sources names of the files that were loaded into the store
+      /// @throw Exception if a source file is missing or the snapshot cannot
+      ///    be written
+      void saveCache( const std::string& cacheFile,
+                      const std::vector<std::string>& sources ) const
+         throw( Exception );
+
+      /// Add the ephemerides in a binary snapshot file, written by saveCache(),
+      /// to the store, provided the snapshot was made from the same source
+      /// files, with the same sizes and modification times.
+      /// @param cacheFile name of the snapshot file to read
+      /// @param sources names of the files the caller would otherwise load
+      /// @return true if the snapshot was loaded, false if it does not exist,
+      ///    is out of date or is unreadable; then the store is unchanged and
+      ///    the caller should load the source files.
+      bool loadCache( const std::string& cacheFile,
+                      const std::vector<std::string>& sources )
+         throw();
+
       protected:
       void validSatSystem(const SatID sat)
           const throw(InvalidRequest)
@@ -30,7 +30,10 @@
 //============================================================================
 
 
+#include <vector>
+
 #include "IonexStore.hpp"
+#include "StoreCache.hpp"
 
 using namespace gpstk::StringUtils;
 using namespace gpstk;
@@ -44,6 +47,123 @@ namespace gpstk
    static const double C2_FACT   = 40.3e+16;
 
 
+      // Record of one IonexData object in a binary snapshot (see StoreCache).
+      // The map values themselves are kept in a separate section, and this
+      // record points into it.
+   struct IonexCacheRecord
+   {
+      StoreCache::TimeRecord time;  ///< epoch of the map
+      Int32 mapID;                  ///< internal number of the map
+      Int32 dim[3];                 ///< number of values in lat, lon, height
+      Int32 exponent;               ///< exponent of the values
+      Int32 type;                   ///< 0 unknown, 1 TEC, 2 RMS
+      double lat[3];                ///< grid in latitude
+      double lon[3];                ///< grid in longitude
+      double hgt[3];                ///< grid in height
+      UInt64 offset;                ///< index of first value in "VALS" section
+      UInt64 count;                 ///< number of values
+   };
+
+
+      // Append an IonexData object to the snapshot records and values
+   static void appendCacheRecord( const IonexData& iod,
+                                  std::vector<IonexCacheRecord>& recs,
+                                  std::vector<double>& values )
+   {
+
+      IonexCacheRecord rec;
+
+      rec.time = StoreCache::packTime(iod.time);
+      rec.mapID = iod.mapID;
+      rec.exponent = iod.exponent;
+      rec.type = ( iod.type == IonexData::TEC ? 1 :
+                   iod.type == IonexData::RMS ? 2 : 0 );
+
+      for (int i = 0; i < 3; i++)
+      {
+         rec.dim[i] = iod.dim[i];
+         rec.lat[i] = iod.lat[i];
+         rec.lon[i] = iod.lon[i];
+         rec.hgt[i] = iod.hgt[i];
+      }
+
+      rec.offset = values.size();
+      rec.count = iod.data.size();
+      for (size_t i = 0; i < iod.data.size(); i++)
+      {
+         values.push_back(iod.data[i]);
+      }
+
+      recs.push_back(rec);
+
+   }  // End of function 'appendCacheRecord()'
+
+
+      // Load the maps of an up-to-date snapshot into the store. Return false,
+      // without changing the store, if the snapshot cannot be used.
+   static bool loadCacheFile( IonexStore& store,
+                              const std::string& cacheFile,
+                              const std::string& cacheKey )
+   {
+
+      StoreCache cache;
+      const IonexCacheRecord *recs;
+      const double *values;
+      size_t nrec, nval;
+
+      if ( !cache.open(cacheFile, "INX ", cacheKey)   ||
+           !cache.getSection("MAPS", recs, nrec)       ||
+           !cache.getSection("VALS", values, nval) )
+      {
+         return false;
+      }
+
+         // check all the records before changing the store
+      for (size_t k = 0; k < nrec; k++)
+      {
+         if ( recs[k].offset + recs[k].count > nval )
+         {
+            return false;
+         }
+      }
+
+      for (size_t k = 0; k < nrec; k++)
+      {
+
+         const IonexCacheRecord& rec(recs[k]);
+         IonexData iod;
+
+         iod.time = StoreCache::unpackTime(rec.time);
+         iod.mapID = rec.mapID;
+         iod.exponent = rec.exponent;
+         iod.type = ( rec.type == 1 ? IonexData::TEC :
+                      rec.type == 2 ? IonexData::RMS : IonexData::UN );
+
+         for (int i = 0; i < 3; i++)
+         {
+            iod.dim[i] = rec.dim[i];
+            iod.lat[i] = rec.lat[i];
+            iod.lon[i] = rec.lon[i];
+            iod.hgt[i] = rec.hgt[i];
+         }
+
+         iod.data = Vector<double>(rec.count);
+         for (size_t i = 0; i < rec.count; i++)
+         {
+            iod.data[i] = values[rec.offset + i];
+         }
+
+         iod.valid = true;
+
+         store.addMap(iod);
+
+      }
+
+      return true;
+
+   }  // End of function 'loadCacheFile()'
+
+
       // Load the given IONEX file
    void IonexStore::loadFile( const std::string& filename )
       throw(FileMissingException)
@@ -84,11 +204,54 @@ namespace gpstk
             // this map is useful in finding DCB value
          inxDCBMap[header.firstEpoch] = header.svsmap;
 
+            // If the cache directory holds an up-to-date snapshot of this
+            // file, take the maps from it instead of parsing them
+         std::string cacheFile, cacheKey;
+         if ( isCaching() )
+         {
+
+            cacheFile = StoreCache::cacheFileName( getCacheDirectory(),
+                                                   filename, "INX " );
+            cacheKey = StoreCache::sourceKey(filename);
+
+            if ( loadCacheFile(*this, cacheFile, cacheKey) )
+            {
+               return;
+            }
+
+         }
+
             // object data. If valid, add to the map
+         std::vector<IonexCacheRecord> cacheRecs;
+         std::vector<double> cacheValues;
          IonexData iod;
          while ( strm >> iod && iod.isValid() )
          {
             addMap(iod);
+
+            if ( !cacheFile.empty() )
+            {
+               appendCacheRecord(iod, cacheRecs, cacheValues);
+            }
+         }
+
+            // Save the snapshot for the next load. It is only an
+            // optimization, so failure to write it is not an error.
+         if ( !cacheFile.empty() )
+         {
+
+            try
+            {
+               StoreCache cache;
+               cache.addSection("MAPS", cacheRecs);
+               cache.addSection("VALS", cacheValues);
+               cache.write(cacheFile, "INX ", cacheKey);
+            }
+            catch (gpstk::Exception& e)
+            {
+               ;
+            }
+
          }
 
       }
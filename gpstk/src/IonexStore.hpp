@@ -80,7 +80,13 @@ namespace gpstk
       virtual ~IonexStore() {};
 
 
-         /// Load the given IONEX file
+         /** Load the given IONEX file.
+          *
+          * If a cache directory has been set with setCacheDirectory(), the
+          * header is read from the file but the maps are taken from the
+          * file's binary snapshot (see StoreCache) when it is up to date;
+          * otherwise the file is parsed and the snapshot is written.
+          */
       virtual void loadFile(const std::string& filename)
          throw(FileMissingException);
 
@@ -328,11 +328,7 @@ namespace gpstk
          if(tables.find(sat) != tables.end() &&
             tables[sat].find(ttag) != tables[sat].end()) {
                   // record already exists in table
-            PositionRecord& oldrec(tables[sat][ttag]);
-            oldrec.Pos = rec.Pos;
-            oldrec.sigPos = rec.sigPos;
-            if(haveVelocity) { oldrec.Vel = rec.Vel; oldrec.sigVel = rec.sigVel; }
-            if(haveAcceleration) { oldrec.Acc = rec.Acc; oldrec.sigAcc = rec.sigAcc; }
+            updateRecord(tables[sat][ttag], rec, haveVelocity, haveAcceleration);
          }
          else {   // create a new entry in the table
             tables[sat][ttag] = rec;
@@ -341,6 +337,59 @@ namespace gpstk
       catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
    }
 
+   // Add many complete PositionRecords at once; same result as addPositionRecord()
+   // on each, in order, but each table is built in one pass in time order.
+   void PositionSatStore::addPositionRecords(const vector<SatID>& sats,
+                                             const vector<CommonTime>& ttags,
+                                             const vector<PositionRecord>& recs)
+      throw(InvalidRequest)
+   {
+      try {
+         size_t i,k,n(recs.size());
+         if(sats.size() != n || ttags.size() != n) {
+            InvalidRequest ir("Input vectors have different lengths");
+            GPSTK_THROW(ir);
+         }
+         for(i=0; i<n; i++)
+            checkTimeSystem(ttags[i].getTimeSystem());
+
+         // addPositionRecord() sets the velocity and acceleration flags as it goes,
+         // and an existing record is updated according to the flags at that point;
+         // find the first record (in input order) that sets each flag.
+         size_t firstVel(haveVelocity ? 0 : n), firstAcc(haveAcceleration ? 0 : n);
+         for(i=0; i<n && (firstVel == n || firstAcc == n); i++) {
+            for(k=0; firstVel == n && k<3; k++)
+               if(recs[i].Vel[k] != 0.0) firstVel = i;
+            for(k=0; firstAcc == n && k<3; k++)
+               if(recs[i].Acc[k] != 0.0) firstAcc = i;
+         }
+
+         vector<size_t> index;
+         sortBySatTime(sats, ttags, index);
+
+         // insert in time order, using the previous entry as a hint, so that
+         // appending to a table costs no search
+         DataTable *table(0);
+         DataTable::iterator it;
+         for(k=0; k<n; k++) {
+            i = index[k];
+            if(k == 0 || sats[i] != sats[index[k-1]]) {
+               table = &tables[sats[i]];
+               it = table->end();
+            }
+
+            size_t size(table->size());
+            it = table->insert(it, make_pair(ttags[i], recs[i]));
+            if(table->size() == size)      // record already exists in the table
+               updateRecord(it->second, recs[i], firstVel <= i, firstAcc <= i);
+         }
+
+         if(firstVel < n) haveVelocity = true;
+         if(firstAcc < n) haveAcceleration = true;
+      }
+      catch(InvalidRequest& ir) { GPSTK_RETHROW(ir); }
+   }
+
    // Add position data (only) to the store
    void PositionSatStore::addPositionData(const SatID& sat, const CommonTime& ttag,
                      const Triple& Pos, const Triple& Sig)
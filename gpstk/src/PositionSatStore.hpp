@@ -9,6 +9,7 @@
 #define GPSTK_POSITION_SAT_STORE_INCLUDE
 
 #include <map>
+#include <vector>
 #include <iostream>
 
 #include "TabularSatStore.hpp"
@@ -34,6 +35,31 @@ namespace gpstk
    /// Output stream operator is used by dump() in TabularSatStore
    std::ostream& operator<<(std::ostream& os, const PositionRecord& cdr) throw();
 
+   /// Number of doubles in a PositionRecord, as written to binary snapshots
+   static const int PositionRecordSize = 18;
+
+   /// Copy a PositionRecord into an array of PositionRecordSize doubles
+   inline void packPositionRecord(const PositionRecord& rec, double *data) throw()
+   {
+      for(int i=0; i<3; i++) {
+         data[i]    = rec.Pos[i]; data[i+3]  = rec.sigPos[i];
+         data[i+6]  = rec.Vel[i]; data[i+9]  = rec.sigVel[i];
+         data[i+12] = rec.Acc[i]; data[i+15] = rec.sigAcc[i];
+      }
+   }
+
+   /// Copy an array of PositionRecordSize doubles into a PositionRecord
+   inline void unpackPositionRecord(const double *data, PositionRecord& rec)
+      throw()
+   {
+      rec.Pos = Triple(data[0], data[1], data[2]);
+      rec.sigPos = Triple(data[3], data[4], data[5]);
+      rec.Vel = Triple(data[6], data[7], data[8]);
+      rec.sigVel = Triple(data[9], data[10], data[11]);
+      rec.Acc = Triple(data[12], data[13], data[14]);
+      rec.sigAcc = Triple(data[15], data[16], data[17]);
+   }
+
    /// Store a table of data vs time for each of several satellites.
    /// The data are stored as PositionRecords, one for each (satellite,time) pair.
    /// The getValue(sat, t) routine interpolates the table for sat at time t and
@@ -162,6 +188,23 @@ namespace gpstk
                              const PositionRecord& rec)
          throw(InvalidRequest);
 
+      /// Add many complete PositionRecords at once, for example the contents of
+      /// several files. The result is the same as calling addPositionRecord(
+      /// sats[i], ttags[i], recs[i]) for i=0,1,...,in order, including the rules for
+      /// a record that is already in the store; however the records are first
+      /// sorted on satellite and time, so that each table is built in a single
+      /// ordered pass. Unlike repeated calls to addPositionRecord(), nothing is
+      /// added if any ttag has the wrong time system.
+      /// @param sats vector of satellites
+      /// @param ttags vector of time tags, same length as sats
+      /// @param recs vector of records, same length as sats
+      /// @throw InvalidRequest if the vectors have different lengths, or a time
+      ///    system is inconsistent with the store.
+      void addPositionRecords(const std::vector<SatID>& sats,
+                              const std::vector<CommonTime>& ttags,
+                              const std::vector<PositionRecord>& recs)
+         throw(InvalidRequest);
+
       /// Add position data to the store; nothing else is changed
       void addPositionData(const SatID& sat, const CommonTime& ttag,
                            const Triple& Pos, const Triple& Sig=Triple())
@@ -190,6 +233,20 @@ namespace gpstk
       void rejectBadPositions(const bool flag)
          { rejectBadPosFlag=flag; }
 
+   private:
+
+      /// Replace the values in an existing record with those in rec, for
+      /// addPositionRecord(s); velocity and acceleration are replaced only if the
+      /// store has (or rec brings) that type of data.
+      static void updateRecord(PositionRecord& oldrec, const PositionRecord& rec,
+                               bool vel, bool acc) throw()
+      {
+         oldrec.Pos = rec.Pos;
+         oldrec.sigPos = rec.sigPos;
+         if(vel) { oldrec.Vel = rec.Vel; oldrec.sigVel = rec.sigVel; }
+         if(acc) { oldrec.Acc = rec.Acc; oldrec.sigAcc = rec.sigAcc; }
+      }
+
    }; // end class PositionSatStore
 
       //@}
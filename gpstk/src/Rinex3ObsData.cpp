@@ -55,6 +55,32 @@ using namespace std;
 namespace gpstk
 {
 
+      // Append the epoch time, as written by Rinex3ObsData::writeTime(),
+      // to line.
+   static void putTime(FormattedLine& line, const CommonTime& ct)
+   {
+      if(ct == CommonTime::BEGINNING_OF_TIME)
+      {
+         line.add(' ', 26);
+         return;
+      }
+
+      CivilTime civtime(ct);
+      line.add(' ').addInt(short(civtime.year  ), 4);
+      line.add(' ').addInt(short(civtime.month ), 2, '0');
+      line.add(' ').addInt(short(civtime.day   ), 2, '0');
+      line.add(' ').addInt(short(civtime.hour  ), 2, '0');
+      line.add(' ').addInt(short(civtime.minute), 2, '0');
+      line.addFixed(civtime.second, 7, 11);
+   }
+
+
+      // Append sat.toString() to line.
+   static void putSat(FormattedLine& line, RinexSatID sat)
+   {
+      line.add(sat.systemChar()).addPadded(sat.id, 2, sat.getfill());
+   }
+
 
    void reallyPutRecordVer2( Rinex3ObsStream& strm,
                              const Rinex3ObsData& rod )
@@ -71,26 +97,22 @@ namespace gpstk
 
       // first the epoch line to 'line'
       //line  = writeTime(rod.time); // (ver 2 RinexObsData::writeTime)
-      string line;
+      FormattedLine& line(strm.formattedLine);
+      line.clear();
       if(rod.time == CommonTime::BEGINNING_OF_TIME)
-         line = string(26, ' ');
+         line.add(' ', 26);
       else
       {
          CivilTime civTime(rod.time);
-         line  = string(1, ' ');
-         line += rightJustify(asString<short>(civTime.year),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.month),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.day),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.hour),2);
-         line += string(1, ' ');
-         line += rightJustify(asString<short>(civTime.minute),2);
-         line += rightJustify(asString(civTime.second, 7),11);
-         line += string(2, ' ');
-         line += rightJustify(asString<short>(rod.epochFlag), 1);
-         line += rightJustify(asString<short>(rod.numSVs), 3);
+         line.add(' ').addInt(short(civTime.year), 2);
+         line.add(' ').addInt(short(civTime.month), 2);
+         line.add(' ').addInt(short(civTime.day), 2);
+         line.add(' ').addInt(short(civTime.hour), 2);
+         line.add(' ').addInt(short(civTime.minute), 2);
+         line.addFixed(civTime.second, 7, 11);
+         line.add(' ', 2);
+         line.addInt(short(rod.epochFlag), 1);
+         line.addInt(short(rod.numSVs), 3);
       }
 
          // write satellite ids to 'line'
@@ -103,7 +125,7 @@ namespace gpstk
       {
          while( itr != rod.obs.end() && satsWritten < maxPrnsPerLine )
          {
-            line += itr->first.toString();
+            putSat(line, itr->first);
             satsWritten++;
             itr++;
          }
@@ -111,8 +133,8 @@ namespace gpstk
             // add clock offset
          if( rod.clockOffset != 0.0 )
          {
-            line += string(68 - line.size(), ' ');
-            line += rightJustify( asString(rod.clockOffset, 9), 12 );
+            line.add(' ', 68 - line.size());
+            line.addFixed(rod.clockOffset, 9, 12);
          }
    
             // continuation lines
@@ -120,11 +142,11 @@ namespace gpstk
          {
             if((satsWritten % maxPrnsPerLine) == 0)
             {
-               strm << line << endl;
-               strm.lineNumber++;
-               line  = string(32, ' ');
+               strm.formattedPutLine();
+               line.clear();
+               line.add(' ', 32);
             }
-            line += itr->first.toString();
+            putSat(line, itr->first);
             satsWritten++;
             itr++;
          }
@@ -132,8 +154,7 @@ namespace gpstk
       }  // End of 'if( rod.epochFlag==0 || rod.epochFlag==1 || ...'
 
          // write the epoch line
-      strm << line << endl;
-      strm.lineNumber++;         
+      strm.formattedPutLine();
 
          // write the auxiliary header records, if any
       if( rod.epochFlag >= 2 && rod.epochFlag <= 5 )
@@ -164,7 +185,7 @@ namespace gpstk
             string sys(string(1,sat.systemChar()));   // system
             itr = rod.obs.find(sat);           // get data vector to be written
             int obsWritten(0);
-            line = string("");
+            line.clear();
 
                // loop over R2 obstypes
             for( i=0; i<strm.header.R2ObsTypes.size(); i++ )
@@ -188,26 +209,26 @@ namespace gpstk
                   // need a continuation line?
                if( obsWritten != 0 && (obsWritten % maxObsPerLine) == 0 )
                {
-                  strm << line << endl;
-                  strm.lineNumber++;
-                  line = string("");
+                  strm.formattedPutLine();
+                  line.clear();
                }
 
                   // write the line
-               line += rightJustify(asString(            // double 14.3
-                          ( ind == -1 ? 0.0 : itr->second[ind].data),3),14 );
-               line += (ind == -1 || itr->second[ind].lli == 0)
-                       ? string(1, ' ')
-                       : rightJustify(asString<short>(itr->second[ind].lli),1);
-               line += (ind == -1 || itr->second[ind].ssi == 0)
-                       ? string(1, ' ')
-                       : rightJustify(asString<short>(itr->second[ind].ssi),1);
+               line.addFixed(                                // double 14.3
+                          ( ind == -1 ? 0.0 : itr->second[ind].data), 3, 14);
+               if(ind == -1 || itr->second[ind].lli == 0)
+                  line.add(' ');
+               else
+                  line.addInt(short(itr->second[ind].lli), 1);
+               if(ind == -1 || itr->second[ind].ssi == 0)
+                  line.add(' ');
+               else
+                  line.addInt(short(itr->second[ind].ssi), 1);
                obsWritten++;
 
             }  // End of 'for( i=0; i<strm.header.R2ObsTypes.size(); i++ )'
 
-            strm << line << endl;
-            strm.lineNumber++;
+            strm.formattedPutLine();
 
          }  // End of 'for( itr = rod.obs.begin(); itr != rod.obs.end();...'
 
@@ -301,46 +322,44 @@ namespace gpstk
          return;
       }
         
-      string line;
+      FormattedLine& line(strm.formattedLine);
 
       // first the epoch line
-      line  = ">";
-      line += writeTime(time);
-      line += string(2, ' ');
-      line += rightJustify(asString<short>(epochFlag), 1);
-      line += rightJustify(asString<short>(numSVs   ), 3);
-      line += string(6, ' ');
+      line.clear();
+      line.add('>');
+      putTime(line, time);
+      line.add(' ', 2);
+      line.addInt(epochFlag, 1);
+      line.addInt(numSVs, 3);
+      line.add(' ', 6);
       if(clockOffset != 0.0) // optional data; need to test for its existence
-      line += rightJustify(asString(clockOffset, 12), 15);
+      line.addFixed(clockOffset, 12, 15);
 
-      strm << line << endl;
-      strm.lineNumber++;
-      line.erase();
+      strm.formattedPutLine();
 
       if(epochFlag == 0 || epochFlag == 1 || epochFlag == 6) {
          DataMap::const_iterator itr = obs.begin();
 
          while(itr != obs.end()) {
-            line = itr->first.toString();
+            line.clear();
+            putSat(line, itr->first);
 
             for(int i=0; i < itr->second.size(); i++) {
-               RinexDatum thisData = itr->second[i];
-               line += rightJustify(asString(thisData.data,3),14);
+               const RinexDatum& thisData = itr->second[i];
+               line.addFixed(thisData.data, 3, 14);
 
                if(thisData.lli == 0)
-                  line += string(1, ' ');
+                  line.add(' ');
                else
-                  line += rightJustify(asString<short>(thisData.lli),1);
+                  line.addInt(short(thisData.lli), 1);
 
                if(thisData.ssi == 0)
-                  line += string(1, ' ');
+                  line.add(' ');
                else
-                  line += rightJustify(asString<short>(thisData.ssi),1);
+                  line.addInt(short(thisData.ssi), 1);
             }
             // write the data line out
-            strm << line << endl;
-            strm.lineNumber++;
-            line.erase();
+            strm.formattedPutLine();
 
             itr++;
          } // end loop over sats and data
@@ -715,25 +734,9 @@ namespace gpstk
    string Rinex3ObsData::writeTime(const CommonTime& ct) const
       throw(StringException)
    {
-      if(ct == CommonTime::BEGINNING_OF_TIME)
-         return string(26, ' ');
-
-      CivilTime civtime(ct);
-      string line;
-
-      line  = string(1, ' ');
-      line += rightJustify(asString<short>(civtime.year    ), 4);
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.month   ), 2, '0');
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.day     ), 2, '0');
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.hour    ), 2, '0');
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civtime.minute  ), 2, '0');
-      line += rightJustify(asString       (civtime.second,7),11);
-
-      return line;
+      FormattedLine line;
+      putTime(line, ct);
+      return line.asString();
    }  // end writeTime
 
 
@@ -23,28 +23,31 @@ namespace gpstk
       // cast the stream to be an RinexClockStream
       RinexClockStream& strm = dynamic_cast<RinexClockStream&>(ffs);
 
-      int i;
-      string line;
+      FormattedLine& line(strm.formattedLine);
+      line.clear();
 
-      line = datatype;
-      line += string(1,' ');
+      line.add(datatype);
+      line.add(' ');
 
       if(datatype == string("AR")) {
-         line += rightJustify(site,4);
+         line.addRight(site,4);
       }
       else if(datatype == string("AS")) {
-         line += string(1,sat.systemChar());
-         line += rightJustify(asString(sat.id),2);
+         line.add(sat.systemChar());
+         line.addInt(sat.id,2);
          if(line[4] == ' ') line[4] = '0';
-         line += string(1,' ');
+         line.add(' ');
       }
       else {
          FFStreamError e("Unknown data type: " + datatype);
          GPSTK_THROW(e);
       }
-      line += string(1,' ');
+      line.add(' ');
 
-      line += printTime(time,"%4Y %02m %02d %02H %02M %9.6f");
+      // same as printTime(time,"%4Y %02m %02d %02H %02M %9.6f")
+      CivilTime civTime(time);
+      line.print("%4d %02d %02d %02d %02d %9.6f", civTime.year, civTime.month,
+                 civTime.day, civTime.hour, civTime.minute, civTime.second);
 
       // must count the data to output
       int n(2);
@@ -52,34 +55,33 @@ namespace gpstk
       if(sig_drift != 0.0) n=4;
       if(accel != 0.0) n=5;
       if(sig_accel != 0.0) n=6;
-      line += rightJustify(asString(n),3);
-      line += string(3,' ');
+      line.addInt(n,3);
+      line.add(' ',3);
 
-      line += doubleToScientific(bias, 19, 12, 2);
-      line += string(1,' ');
-      line += doubleToScientific(sig_bias, 19, 12, 2);
+      line.addScientific(bias, 19, 12, 2);
+      line.add(' ');
+      line.addScientific(sig_bias, 19, 12, 2);
 
-      strm << line << endl;
-      strm.lineNumber++;
+      strm.formattedPutLine();
 
       // continuation line
       if(n > 2) {
-         line = doubleToScientific(drift, 19, 12, 2);
-         line += string(1,' ');
+         line.clear();
+         line.addScientific(drift, 19, 12, 2);
+         line.add(' ');
          if(n > 3) {
-            line += doubleToScientific(sig_drift, 19, 12, 2);
-            line += string(1,' ');
+            line.addScientific(sig_drift, 19, 12, 2);
+            line.add(' ');
          }
          if(n > 4) {
-            line += doubleToScientific(accel, 19, 12, 2);
-            line += string(1,' ');
+            line.addScientific(accel, 19, 12, 2);
+            line.add(' ');
          }
          if(n > 5) {
-            line += doubleToScientific(sig_accel, 19, 12, 2);
-            line += string(1,' ');
+            line.addScientific(sig_accel, 19, 12, 2);
+            line.add(' ');
          }
-         strm << line << endl;
-         strm.lineNumber++;
+         strm.formattedPutLine();
       }
 
    }  // end reallyPutRecord()
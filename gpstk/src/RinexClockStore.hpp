@@ -10,10 +10,14 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include "Exception.hpp"
 #include "ClockSatStore.hpp"
 #include "FileStore.hpp"
+#include "StoreCache.hpp"
+#include "ThreadPool.hpp"
 #include "RinexClockStream.hpp"
 #include "RinexClockHeader.hpp"
 #include "RinexClockData.hpp"
@@ -67,8 +71,8 @@ namespace gpstk
                finalTime == CommonTime::BEGINNING_OF_TIME)
                   os << "(there are no time limits)" << std::endl;
             else
-               os << initialTime.printf(fmt) << " TO "
-                  << finalTime.printf(fmt) << std::endl;
+               os << printTime(initialTime,fmt) << " TO "
+                  << printTime(finalTime,fmt) << std::endl;
 
             os << " This store contains:"
                << (haveClockBias ? "":" not") << " bias,"
@@ -104,7 +108,7 @@ namespace gpstk
                os << "  Data:" << std::endl;
                DataTable::const_iterator jt;
                for(jt=it->second.begin(); jt!=it->second.end(); jt++) {
-                  os << " " << jt->first.printf(fmt)
+                  os << " " << printTime(jt->first,fmt)
                      << " " << it->first
                      << std::scientific << std::setprecision(12)
                      << " " << std::setw(19) << jt->second.bias
@@ -123,8 +127,33 @@ namespace gpstk
       }
 
 
-      /// Load a RINEX clock file; may set the drift and accel flags.
-      bool loadFile(const std::string& filename) throw(Exception)
+      /// Set the directory in which binary snapshots of the loaded files are kept
+      /// (see StoreCache); empty turns snapshots off.
+      void setCacheDirectory(const std::string& dir) throw()
+         { clkFiles.setCacheDirectory(dir); }
+
+      /// Get the directory in which binary snapshots are kept
+      const std::string& getCacheDirectory(void) const throw()
+         { return clkFiles.getCacheDirectory(); }
+
+      /// Snapshot record of the clock table (see StoreCache); also used to hold
+      /// the records of a file between reading it and adding it to a store.
+      typedef StoreCache::SatTimeRecord<ClockRecordSize> ClockCacheRecord;
+
+      /// Read a RINEX clock file into its header and a list of its 'AS' clock
+      /// records, in file order, without changing any store. If cacheDir is not
+      /// empty, the records are taken from the file's snapshot when it is up to
+      /// date, and the snapshot is written otherwise. Since no object is changed,
+      /// this may be called concurrently for different files.
+      /// @param filename name of the RINEX clock file
+      /// @param cacheDir directory of snapshots, or empty
+      /// @param head output header of the file
+      /// @param recs output records, appended to the vector
+      /// @throw Exception if the file cannot be opened or read
+      static void readFile(const std::string& filename, const std::string& cacheDir,
+                           RinexClockHeader& head,
+                           std::vector<ClockCacheRecord>& recs)
+         throw(Exception)
       {
       try {
          // open the input stream
@@ -136,10 +165,6 @@ namespace gpstk
          strm.exceptions(std::ios::failbit);
          //cout << "Opened file " << filename << endl;
 
-         // declare header and data
-         RinexClockHeader head;
-         RinexClockData data;
-
          // read the RINEX clock header
          try {
             strm >> head;
@@ -150,10 +175,28 @@ namespace gpstk
          }
          //cout << "Read header" << endl; head.dump();
 
-         // save in FileStore
-         clkFiles.addFile(filename, head);
+         // if there is an up-to-date snapshot of this file, take the data from it
+         StoreCache cache;
+         std::string cacheFile, cacheKey;
+         if(!cacheDir.empty()) {
+            cacheFile = StoreCache::cacheFileName(cacheDir, filename, "RCLK");
+            cacheKey = StoreCache::sourceKey(filename);
+
+            const ClockCacheRecord *crecs;
+            size_t nclk;
+            if(cache.open(cacheFile, "RCLK", cacheKey) &&
+               cache.getSection("CLK ", crecs, nclk))
+            {
+               recs.insert(recs.end(), crecs, crecs+nclk);
+               strm.close();
+               return;
+            }
+            cache.close();
+         }
 
          // read data
+         size_t nstart(recs.size());
+         RinexClockData data;
          try {
             while(strm >> data) {
                //data.dump(cout);
@@ -164,7 +207,12 @@ namespace gpstk
                   rec.bias = data.bias; rec.sig_bias = data.sig_bias,
                   rec.drift = data.drift; rec.sig_drift = data.sig_drift,
                   rec.accel = data.accel; rec.sig_accel = data.sig_accel;
-                  addClockRecord(data.sat, data.time, rec);
+
+                  ClockCacheRecord crec;
+                  crec.time = StoreCache::packTime(data.time);
+                  crec.sat = StoreCache::packSat(data.sat);
+                  packClockRecord(rec, crec.data);
+                  recs.push_back(crec);
                }
             }
          }
@@ -176,10 +224,148 @@ namespace gpstk
          // close
          strm.close();
 
+         // save the snapshot for the next load; failure is not an error
+         if(!cacheFile.empty()) {
+            try {
+               cache.addSection("CLK ", sizeof(ClockCacheRecord),
+                                recs.size()-nstart,
+                                recs.size() > nstart ? &recs[nstart] : 0);
+               cache.write(cacheFile, "RCLK", cacheKey);
+            }
+            catch(Exception& e) { ; }
+         }
+      }
+      catch(Exception& e) { GPSTK_RETHROW(e); }
+
+      }  // end RinexClockStore::readFile()
+
+      /// Append the contents of records read by readFile() to vectors of the form
+      /// used by ClockSatStore::addClockRecords().
+      /// @throw InvalidRequest if a record has an invalid time
+      static void unpackRecords(const std::vector<ClockCacheRecord>& recs,
+                                std::vector<SatID>& sats,
+                                std::vector<CommonTime>& ttags,
+                                std::vector<ClockRecord>& crecs)
+         throw(InvalidRequest)
+      {
+         try {
+            size_t i, n(sats.size());
+            sats.resize(n + recs.size());
+            ttags.resize(n + recs.size());
+            crecs.resize(n + recs.size());
+            for(i=0; i<recs.size(); i++) {
+               sats[n+i] = StoreCache::unpackSat(recs[i].sat);
+               ttags[n+i] = StoreCache::unpackTime(recs[i].time);
+               unpackClockRecord(recs[i].data, crecs[n+i]);
+            }
+         }
+         catch(InvalidParameter& ip) {
+            InvalidRequest ir(ip);
+            GPSTK_THROW(ir);
+         }
+      }
+
+      /// Load a RINEX clock file; may set the drift and accel flags.
+      /// If a cache directory is set, the data are taken from the file's snapshot
+      /// when it is up to date, and the snapshot is written otherwise.
+      bool loadFile(const std::string& filename) throw(Exception)
+      {
+         try {
+            loadFiles(std::vector<std::string>(1, filename), 1);
+            return true;
+         }
+         catch(Exception& e) { GPSTK_RETHROW(e); }
+      }
+
+      /// Load several RINEX clock files; may set the drift and accel flags. The
+      /// files are read concurrently, each into its own list of records, and the
+      /// records are then added to the store in one sorted pass. The result is the
+      /// same as calling loadFile() for each file in the order given; in
+      /// particular, where files overlap, a record from a later file replaces
+      /// that of an earlier one.
+      /// @param filenames names of the RINEX clock files
+      /// @param nthreads number of reading threads; 0 means one per processor.
+      ///    No more threads than files are used.
+      /// @throw Exception if any file cannot be read, or is already in the store;
+      ///    in that case nothing is loaded.
+      void loadFiles(const std::vector<std::string>& filenames,
+                     unsigned int nthreads = 0)
+         throw(Exception)
+      {
+      try {
+         size_t i, n(filenames.size());
+         for(i=0; i<n; i++) {
+            if(clkFiles.hasFile(filenames[i]) ||
+               std::find(filenames.begin(), filenames.begin()+i, filenames[i])
+                  != filenames.begin()+i)
+            {
+               InvalidRequest e("Duplicate file name " + filenames[i]);
+               GPSTK_THROW(e);
+            }
+         }
+
+         // read the files into separate lists
+         std::vector<ReadTask> tasks(n);
+         for(i=0; i<n; i++) {
+            tasks[i].filename = filenames[i];
+            tasks[i].cacheDir = clkFiles.getCacheDirectory();
+         }
+         if(nthreads == 0) nthreads = ThreadPool::processorCount();
+         if(nthreads > n) nthreads = n;
+         if(nthreads <= 1) {
+            for(i=0; i<n; i++) tasks[i].run();
+         }
+         else {
+            ThreadPool pool(nthreads);
+            for(i=0; i<n; i++) pool.submit(&tasks[i]);
+            pool.wait();
+         }
+         for(i=0; i<n; i++) {
+            if(tasks[i].failed) {
+               Exception e(tasks[i].error);
+               GPSTK_THROW(e);
+            }
+         }
+
+         // add all the records in one pass, in file order
+         std::vector<SatID> sats;
+         std::vector<CommonTime> ttags;
+         std::vector<ClockRecord> crecs;
+         for(i=0; i<n; i++) {
+            unpackRecords(tasks[i].recs, sats, ttags, crecs);
+            std::vector<ClockCacheRecord>().swap(tasks[i].recs);
+         }
+         addClockRecords(sats, ttags, crecs);
+
+         // save in FileStore
+         for(i=0; i<n; i++)
+            clkFiles.addFile(filenames[i], tasks[i].head);
       }
       catch(Exception& e) { GPSTK_RETHROW(e); }
 
-      }  // end RinexClockStore::loadFile()
+      }  // end RinexClockStore::loadFiles()
+
+   private:
+
+      /// Task for loadFiles(): read one file with readFile()
+      class ReadTask : public ThreadPool::Task
+      {
+      public:
+         ReadTask() : failed(false) {}
+
+         std::string filename, cacheDir;   ///< input
+         RinexClockHeader head;            ///< output header
+         std::vector<ClockCacheRecord> recs; ///< output records
+         bool failed;                      ///< true if readFile() threw
+         Exception error;                  ///< the exception, if failed
+
+         void run() throw()
+         {
+            try { readFile(filename, cacheDir, head, recs); }
+            catch(Exception& e) { error = e; failed = true; }
+            catch(std::exception& e) { error = Exception(e.what()); failed = true; }
+         }
+      };
 
    }; // end class RinexClockStore
 
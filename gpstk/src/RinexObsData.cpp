@@ -55,6 +55,30 @@ namespace gpstk
       // Definition of static variable to be used across RinexObsData objects
    CommonTime gpstk::RinexObsData::previousTime;
 
+      // Append the epoch time, as written by writeTime(), to line.
+   static void putTime(FormattedLine& line, const CommonTime& dt)
+   {
+      if (dt == CommonTime::BEGINNING_OF_TIME)
+      {
+         line.add(' ', 26);
+         return;
+      }
+
+      CivilTime civTime(dt);
+      line.add(' ').addInt(short(civTime.year), 2);
+      line.add(' ').addInt(short(civTime.month), 2);
+      line.add(' ').addInt(short(civTime.day), 2);
+      line.add(' ').addInt(short(civTime.hour), 2);
+      line.add(' ').addInt(short(civTime.minute), 2);
+      line.addFixed(civTime.second, 7, 11);
+   }
+
+      // Append RinexSatID(sat).toString() to line.
+   static void putSat(FormattedLine& line, RinexSatID sat)
+   {
+      line.add(sat.systemChar()).addPadded(sat.id, 2, sat.getfill());
+   }
+
    void RinexObsData::reallyPutRecord(FFStream& ffs) const
       throw(std::exception, FFStreamError, StringException)
    {
@@ -65,13 +89,14 @@ namespace gpstk
             auxHeader.NumberHeaderRecordsToBeWritten()==0) return;
 
       RinexObsStream& strm = dynamic_cast<RinexObsStream&>(ffs);
-      string line;
+      FormattedLine& line(strm.formattedLine);
 
       // first the epoch line to 'line'
-      line  = writeTime(time);
-      line += string(2, ' ');
-      line += rightJustify(asString<short>(epochFlag), 1);
-      line += rightJustify(asString<short>(numSvs), 3);
+      line.clear();
+      putTime(line, time);
+      line.add(' ', 2);
+      line.addInt(epochFlag, 1);
+      line.addInt(numSvs, 3);
 
       // write satellite ids to 'line'
       const int maxPrnsPerLine = 12;
@@ -81,8 +106,7 @@ namespace gpstk
       {
          while ((obsItr != obs.end()) && (satsWritten < maxPrnsPerLine))
          {
-            RinexSatID prn((*obsItr).first);
-            line += prn.toString();
+            putSat(line, (*obsItr).first);
             satsWritten++;
             obsItr++;
          }
@@ -90,8 +114,8 @@ namespace gpstk
             // add clock offset
          if(clockOffset != 0.0)
          {
-            line += string(68 - line.size(), ' ');
-            line += rightJustify(asString(clockOffset, 9), 12);
+            line.add(' ', 68 - line.size());
+            line.addFixed(clockOffset, 9, 12);
          }
 
         // continuation lines
@@ -99,20 +123,18 @@ namespace gpstk
          {
             if ((satsWritten % maxPrnsPerLine) == 0)
             {
-               strm << line << endl;
-               strm.lineNumber++;
-               line  = string(32, ' ');
+               strm.formattedPutLine();
+               line.clear();
+               line.add(' ', 32);
             }
-            RinexSatID prn(obsItr->first);
-            line += prn.toString();
+            putSat(line, obsItr->first);
             satsWritten++;
             obsItr++;
          }
       }
 
       // write the epoch line
-      strm << line << endl;
-      strm.lineNumber++;
+      strm.formattedPutLine();
 
       // write the auxiliary header records, if any
       if(epochFlag >= 2 && epochFlag <= 5)
@@ -143,7 +165,7 @@ namespace gpstk
             vector<RinexObsHeader::RinexObsType>::iterator obsTypeItr =
                strm.header.obsTypeList.begin();
 
-            line.erase();
+            line.clear();
             int obsWritten = 0;
 
             while (obsTypeItr != strm.header.obsTypeList.end())
@@ -151,29 +173,27 @@ namespace gpstk
                if (  ((obsWritten % maxObsPerLine) == 0) &&
                      (obsWritten != 0))
                {
-                  strm << line << endl;
-                  strm.lineNumber++;
-                  line.erase();
+                  strm.formattedPutLine();
+                  line.clear();
                }
 
                RinexObsTypeMap::const_iterator rotmi(obsItr->second.find(*obsTypeItr));
                RinexDatum thisData;
                if (rotmi != obsItr->second.end())
                   thisData = rotmi->second;
-               line += rightJustify(asString(thisData.data,3),14);
+               line.addFixed(thisData.data, 3, 14);
                if (thisData.lli == 0)
-                  line += string(1, ' ');
+                  line.add(' ');
                else
-                  line += rightJustify(asString<short>(thisData.lli),1);
+                  line.addInt(short(thisData.lli), 1);
                if (thisData.ssi == 0)
-                  line += string(1, ' ');
+                  line.add(' ');
                else
-                  line += rightJustify(asString<short>(thisData.ssi),1);
+                  line.addInt(short(thisData.ssi), 1);
                obsWritten++;
                obsTypeItr++;
             }
-            strm << line << endl;
-            strm.lineNumber++;
+            strm.formattedPutLine();
             obsItr++;
          }
       }
@@ -422,26 +442,9 @@ namespace gpstk
    string RinexObsData::writeTime(const CommonTime& dt) const
       throw(StringException)
    {
-      if (dt == CommonTime::BEGINNING_OF_TIME)
-      {
-         return string(26, ' ');
-      }
-
-      string line;
-      CivilTime civTime(dt);
-      line  = string(1, ' ');
-      line += rightJustify(asString<short>(civTime.year),2);
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civTime.month),2);
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civTime.day),2);
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civTime.hour),2);
-      line += string(1, ' ');
-      line += rightJustify(asString<short>(civTime.minute),2);
-      line += rightJustify(asString(civTime.second, 7),11);
-
-      return line;
+      FormattedLine line;
+      putTime(line, dt);
+      return line.asString();
    }
 
 
@@ -151,6 +151,9 @@ namespace gpstk
                gpstk::StringUtils::StringException);
 
    private:
+         /// Uses parseTime() to find epoch lines without decoding the data
+      friend class RinexObsEpochReader;
+
          ///<Time corresponding to previous set of oberservations
          /// Used in cases where epoch time of a epoch flag==0
       static gpstk::CommonTime previousTime;
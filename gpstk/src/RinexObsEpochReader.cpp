@@ -0,0 +1,285 @@
+#pragma ident "$Id$"
+
+/// @file RinexObsEpochReader.cpp
+/// Read the epochs of a RINEX 2 observation file as raw text, for tools that
+/// copy, merge or thin observation files without decoding the data.
+
+#include "RinexObsEpochReader.hpp"
+#include "RinexObsData.hpp"
+#include "StringUtils.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   using namespace StringUtils;
+
+   // Constructor; opens the file and reads its header.
+   RinexObsEpochReader::RinexObsEpochReader(const string& fn, unsigned int dep)
+      throw(FileMissingException, FFStreamError)
+      : filename(fn), strm(fn.c_str()), passThrough(true),
+        depth(dep > 0 ? dep : 1), started(false), finished(false), failed(false)
+#ifndef _WIN32
+        , queue(0), threadRunning(false)
+#endif
+   {
+      if(!strm) {
+         FileMissingException e("Could not open file " + filename);
+         GPSTK_THROW(e);
+      }
+      strm.exceptions(fstream::failbit);
+
+      try {
+         strm >> header;
+      }
+      catch(FFStreamError& e) { GPSTK_RETHROW(e); }
+      catch(Exception& e) {
+         FFStreamError fse(e);
+         GPSTK_THROW(fse);
+      }
+      catch(exception& e) {
+         FFStreamError fse(string("std::exception: ") + e.what());
+         GPSTK_THROW(fse);
+      }
+
+      for(size_t i=0; i<header.obsTypeList.size(); i++)
+         columns.push_back(i);
+   }
+
+   // Destructor; stops the read-ahead and closes the file.
+   RinexObsEpochReader::~RinexObsEpochReader() throw()
+   {
+#ifndef _WIN32
+      if(threadRunning) {
+         queue->close();               // a blocked push() returns false
+         ::pthread_join(thread, 0);
+      }
+      delete queue;
+#endif
+   }
+
+   // Deliver the observations for the given list of observation types.
+   void RinexObsEpochReader::setObsTypes(
+      const vector<RinexObsHeader::RinexObsType>& types)
+      throw(InvalidRequest)
+   {
+      if(started) {
+         InvalidRequest e("setObsTypes() called after next() for " + filename);
+         GPSTK_THROW(e);
+      }
+
+      const vector<RinexObsHeader::RinexObsType>& hdrTypes(header.obsTypeList);
+      vector<int> cols;
+      for(size_t i=0; i<types.size(); i++) {
+         size_t j;
+         for(j=0; j<hdrTypes.size(); j++)
+            if(hdrTypes[j] == types[i]) break;
+         if(j == hdrTypes.size()) {
+            InvalidRequest e("Observation type " + types[i].type
+                             + " is not in the header of " + filename);
+            GPSTK_THROW(e);
+         }
+         cols.push_back(j);
+      }
+
+      columns = cols;
+      passThrough = (columns.size() == hdrTypes.size());
+      for(size_t i=0; passThrough && i<columns.size(); i++)
+         if(columns[i] != int(i)) passThrough = false;
+   }
+
+   // Get the next epoch of the file.
+   bool RinexObsEpochReader::next(Epoch& epoch) throw(FFStreamError)
+   {
+      if(finished) {
+         if(failed) GPSTK_THROW(error);
+         return false;
+      }
+      started = true;
+
+#ifndef _WIN32
+      if(!queue) {
+         queue = new BoundedQueue<Epoch>(depth);
+         threadRunning = (::pthread_create(&thread, 0, prefetchMain, this) == 0);
+         if(!threadRunning) {          // read in this thread instead
+            delete queue;
+            queue = 0;
+         }
+      }
+
+      if(threadRunning) {
+         if(queue->pop(epoch)) return true;
+
+         // the thread has closed the queue: end of file or error
+         ::pthread_join(thread, 0);
+         threadRunning = false;
+         finished = true;
+         if(failed) GPSTK_THROW(error);
+         return false;
+      }
+#endif
+
+      try {
+         if(readEpoch(epoch)) return true;
+         finished = true;
+         return false;
+      }
+      catch(FFStreamError& e) {
+         finished = failed = true;
+         e.addText("In file " + filename);
+         error = e;
+         GPSTK_RETHROW(e);
+      }
+   }
+
+#ifndef _WIN32
+   // Entry point of the read-ahead thread
+   void *RinexObsEpochReader::prefetchMain(void *arg)
+   {
+      static_cast<RinexObsEpochReader *>(arg)->prefetch();
+      return 0;
+   }
+
+   // Read epochs into the queue until the end of the file, an error, or the
+   // queue is closed by the destructor.
+   void RinexObsEpochReader::prefetch() throw()
+   {
+      try {
+         Epoch epoch;
+         while(readEpoch(epoch))
+            if(!queue->push(epoch)) break;
+      }
+      catch(FFStreamError& e) {
+         error = e;
+         error.addText("In file " + filename);
+         failed = true;
+      }
+      catch(exception& e) {
+         error = FFStreamError(string("std::exception: ") + e.what());
+         error.addText("In file " + filename);
+         failed = true;
+      }
+      queue->close();   // failed and error are read only after pthread_join()
+   }
+#endif
+
+   // Read one epoch from the file; return false at the end of the file.
+   bool RinexObsEpochReader::readEpoch(Epoch& epoch) throw(FFStreamError)
+   {
+      RinexObsData rod;                // for parseTime()
+      string line;
+
+      // find the epoch line, skipping invalid lines, with the same tests as
+      // RinexObsData::reallyGetRecord()
+      while(1) {
+         try {
+            strm.formattedGetLine(line, true);
+         }
+         catch(EndOfFile&) {
+            return false;
+         }
+         catch(StringException& e) {
+            FFStreamError fse(e);
+            GPSTK_THROW(fse);
+         }
+
+         if(line.size() > 80) continue;
+         try {
+            epoch.time = rod.parseTime(line, header);
+            if(epoch.time == CommonTime::BEGINNING_OF_TIME) continue;
+            asInt(line.substr(29,3));
+         }
+         catch(...) {
+            continue;
+         }
+         break;
+      }
+
+      epoch.epochFlag = asInt(line.substr(28,1));
+      if(epoch.epochFlag < 0 || epoch.epochFlag > 6) {
+         FFStreamError e("Invalid epoch flag: " + asString(epoch.epochFlag));
+         GPSTK_THROW(e);
+      }
+      epoch.numSvs = asInt(line.substr(29,3));
+
+      epoch.text = line;
+      epoch.text += '\n';
+
+      if(epoch.epochFlag == 0 || epoch.epochFlag == 1 || epoch.epochFlag == 6) {
+         // continuation lines of the satellite list
+         for(int n = 12; n < epoch.numSvs; n += 12) {
+            readLine(line);
+            epoch.text += line;
+            epoch.text += '\n';
+         }
+
+         // observations, one line per 5 types for each satellite
+         int nlines((header.obsTypeList.size() + 4) / 5);
+         vector<string> lines(nlines);
+         for(int isv = 0; isv < epoch.numSvs; isv++) {
+            for(int i = 0; i < nlines; i++)
+               readLine(lines[i]);
+            appendObs(lines, epoch.text);
+         }
+      }
+      else {
+         // auxiliary header records
+         for(int i = 0; i < epoch.numSvs; i++) {
+            readLine(line);
+            epoch.text += line;
+            epoch.text += '\n';
+         }
+      }
+
+      return true;
+   }
+
+   // Read a line of an epoch after the epoch line, and check its length.
+   void RinexObsEpochReader::readLine(string& line) throw(FFStreamError)
+   {
+      try {
+         strm.formattedGetLine(line);
+      }
+      catch(StringException& e) {
+         FFStreamError fse(e);
+         GPSTK_THROW(fse);
+      }
+      if(line.size() > 80) {
+         FFStreamError e("Invalid line size:" + asString(line.size()));
+         GPSTK_THROW(e);
+      }
+   }
+
+   // Append the observation lines of one satellite to text, in the order given
+   // by columns.
+   void RinexObsEpochReader::appendObs(const vector<string>& lines, string& text)
+      const throw()
+   {
+      if(passThrough) {
+         for(size_t i=0; i<lines.size(); i++) {
+            text += lines[i];
+            text += '\n';
+         }
+         return;
+      }
+
+      // 16 characters per type (data F14.3, LLI, SSI), 5 types per line
+      static const string blank(16, ' ');
+      for(size_t i=0; i<columns.size(); i++) {
+         const string& line(lines[columns[i] / 5]);
+         size_t pos(16 * (columns[i] % 5));
+         if(pos + 16 <= line.size())
+            text.append(line, pos, 16);
+         else if(pos < line.size()) {
+            text.append(line, pos, string::npos);
+            text.append(pos + 16 - line.size(), ' ');
+         }
+         else
+            text += blank;
+
+         if(i % 5 == 4 || i+1 == columns.size())
+            text += '\n';
+      }
+   }
+
+}  // End of namespace gpstk
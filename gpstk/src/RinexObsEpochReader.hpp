@@ -0,0 +1,192 @@
+#pragma ident "$Id$"
+
+/// @file RinexObsEpochReader.hpp
+/// Read the epochs of a RINEX 2 observation file as raw text, for tools that
+/// copy, merge or thin observation files without decoding the data.
+
+#ifndef GPSTK_RINEX_OBS_EPOCH_READER_INCLUDE
+#define GPSTK_RINEX_OBS_EPOCH_READER_INCLUDE
+
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "BoundedQueue.hpp"
+#include "CommonTime.hpp"
+#include "RinexObsHeader.hpp"
+#include "RinexObsStream.hpp"
+
+namespace gpstk
+{
+   /** @addtogroup RinexObs */
+   //@{
+
+   /// Read a RINEX 2 observation file one epoch at a time, keeping each epoch
+   /// as the text of its lines. Only the epoch line is decoded (time, epoch
+   /// flag and number of satellites or records), which is enough to find the
+   /// extent of the epoch, to order epochs by time and to select them; the
+   /// observations themselves are left as text.
+   ///
+   /// Epochs are delimited exactly as RinexObsData::reallyGetRecord() does it:
+   /// lines that are not valid epoch lines (e.g. comments between spliced
+   /// files) are skipped, the satellite list may continue on further lines
+   /// (12 satellites per line), and each satellite has one line for every 5
+   /// observation types of the header. Epoch flags 2 to 5 are followed by
+   /// numSvs header lines.
+   ///
+   /// After the header has been read by the constructor, a background thread
+   /// (POSIX threads, started by the first call to next()) reads ahead up to
+   /// a fixed number of epochs, so that the reading of several files overlaps
+   /// with the processing. Where threads are not available (_WIN32) epochs
+   /// are read by next() itself.
+   ///
+   /// @code
+   ///    RinexObsEpochReader reader(filename);
+   ///    RinexObsEpochReader::Epoch epoch;
+   ///    while(reader.next(epoch))
+   ///       if(!epoch.empty()) out << epoch.text;
+   /// @endcode
+   class RinexObsEpochReader
+   {
+   public:
+
+      /// One epoch of a RINEX observation file
+      struct Epoch
+      {
+         /// Constructor
+         Epoch() throw()
+            : epochFlag(0), numSvs(0)
+         {}
+
+         /// True if RinexObsData would write nothing for this epoch (no
+         /// satellites, or no auxiliary header records).
+         bool empty() const throw()
+            { return (numSvs <= 0); }
+
+         /// Epoch time
+         CommonTime time;
+
+         /// Epoch flag (0-6)
+         short epochFlag;
+
+         /// Number of satellites (flags 0, 1 and 6), or of header records
+         /// that follow (flags 2 to 5)
+         short numSvs;
+
+         /// All the lines of the epoch, each followed by a newline
+         std::string text;
+      };
+
+      /// Constructor; opens the file and reads its header.
+      /// @param filename name of the RINEX observation file
+      /// @param depth maximum number of epochs read ahead of next()
+      /// @throw FileMissingException if the file cannot be opened
+      /// @throw FFStreamError if the header cannot be read
+      RinexObsEpochReader(const std::string& filename, unsigned int depth = 256)
+         throw(FileMissingException, FFStreamError);
+
+      /// Destructor; stops the read-ahead and closes the file.
+      ~RinexObsEpochReader() throw();
+
+      /// Name of the file
+      const std::string& getFilename() const throw()
+         { return filename; }
+
+      /// The header of the file
+      const RinexObsHeader& getHeader() const throw()
+         { return header; }
+
+      /// Deliver the observations of each satellite for the given list of
+      /// observation types, in that order, instead of the types of the
+      /// header. The fields are copied as text (14 characters of data, the
+      /// LLI and the SSI), so numbers are not reformatted. The epoch lines
+      /// are not changed. Must be called before the first call to next().
+      /// @param types observation types, all of which must be in the header
+      /// @throw InvalidRequest if a type is not in the header, or epochs have
+      ///    already been read
+      void setObsTypes(const std::vector<RinexObsHeader::RinexObsType>& types)
+         throw(InvalidRequest);
+
+      /// Get the next epoch of the file.
+      /// @param epoch output epoch
+      /// @return false at the end of the file
+      /// @throw FFStreamError if the file is not a valid RINEX file; the
+      ///    epochs before the error have all been returned.
+      bool next(Epoch& epoch) throw(FFStreamError);
+
+   private:
+
+      /// Read one epoch from the file.
+      /// @return false at the end of the file
+      bool readEpoch(Epoch& epoch) throw(FFStreamError);
+
+      /// Read a line of an epoch after the epoch line, and check its length.
+      void readLine(std::string& line) throw(FFStreamError);
+
+      /// Append the observation lines of one satellite to text, in the order
+      /// given by columns.
+      void appendObs(const std::vector<std::string>& lines, std::string& text)
+         const throw();
+
+      /// Name of the file
+      std::string filename;
+
+      /// The file
+      RinexObsStream strm;
+
+      /// The header of the file
+      RinexObsHeader header;
+
+      /// For each observation type delivered, its index in the header
+      std::vector<int> columns;
+
+      /// True when the observation lines are copied without change
+      bool passThrough;
+
+      /// Maximum number of epochs read ahead
+      unsigned int depth;
+
+      /// True once the first epoch has been requested
+      bool started;
+
+      /// True once the end of file, or an error, has been seen by next()
+      bool finished;
+
+      /// True if reading stopped on an error
+      bool failed;
+
+      /// The error, if failed
+      FFStreamError error;
+
+#ifndef _WIN32
+      /// Entry point of the read-ahead thread
+      static void *prefetchMain(void *arg);
+
+      /// Read epochs into the queue until the end of the file, an error, or
+      /// the queue is closed by the destructor.
+      void prefetch() throw();
+
+      /// Epochs read ahead
+      BoundedQueue<Epoch> *queue;
+
+      /// The read-ahead thread
+      pthread_t thread;
+
+      /// True while the read-ahead thread is running
+      bool threadRunning;
+#endif
+
+      /// Not copyable
+      RinexObsEpochReader(const RinexObsEpochReader&);
+      RinexObsEpochReader& operator=(const RinexObsEpochReader&);
+
+   }; // end class RinexObsEpochReader
+
+   //@}
+
+}  // End of namespace gpstk
+
+#endif // GPSTK_RINEX_OBS_EPOCH_READER_INCLUDE
@@ -0,0 +1,183 @@
+#pragma ident "$Id$"
+
+/// @file RinexObsEpochWriter.cpp
+/// Write a RINEX 2 observation file from epochs kept as raw text, with the
+/// file output done by a background thread.
+
+#include "RinexObsEpochWriter.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   /// Size at which the pending text is passed on as a block
+   static const size_t blockSize = 65536;
+
+   // Constructor; creates (truncates) the file.
+   RinexObsEpochWriter::RinexObsEpochWriter(const string& fn, unsigned int dep)
+      throw(FileMissingException)
+      : filename(fn), strm(fn.c_str(), ios::out|ios::trunc),
+        depth(dep > 0 ? dep : 1), closed(false), failed(false)
+#ifndef _WIN32
+        , queue(0), threadRunning(false)
+#endif
+   {
+      if(!strm) {
+         FileMissingException e("Could not create file " + filename);
+         GPSTK_THROW(e);
+      }
+#ifndef _WIN32
+      ::pthread_mutex_init(&failLock, 0);
+#endif
+      pending.reserve(blockSize + 8192);
+   }
+
+   // Destructor; calls close(), ignoring errors.
+   RinexObsEpochWriter::~RinexObsEpochWriter() throw()
+   {
+      try { close(); }
+      catch(...) { ; }
+#ifndef _WIN32
+      ::pthread_mutex_destroy(&failLock);
+#endif
+   }
+
+   // Write the header; must come before any epoch.
+   void RinexObsEpochWriter::write(const RinexObsHeader& header)
+      throw(FFStreamError)
+   {
+      // The stream does not throw on failure: an I/O error thrown through
+      // RinexObsHeader::WriteHeaderRecords() would violate its exception
+      // specification. Errors are found from the stream state instead.
+      strm << header;
+      if(!strm) {
+         FFStreamError e(strm.mostRecentException);
+         e.addText("Error writing header to file " + filename);
+         GPSTK_THROW(e);
+      }
+   }
+
+   // Write an epoch.
+   void RinexObsEpochWriter::write(const RinexObsEpochReader::Epoch& epoch)
+      throw(FFStreamError)
+   {
+      if(epoch.empty()) return;
+
+      pending += epoch.text;
+      if(pending.size() >= blockSize)
+         flushPending();
+   }
+
+   // Write everything still pending and close the file.
+   void RinexObsEpochWriter::close() throw(FFStreamError)
+   {
+      if(closed) return;
+
+      if(!pending.empty() && !hasFailed()) {
+         try { flushPending(); }
+         catch(FFStreamError&) { ; }         // reported below
+      }
+      closed = true;
+
+#ifndef _WIN32
+      if(threadRunning) {
+         queue->close();                      // the thread writes what is left
+         ::pthread_join(thread, 0);
+         threadRunning = false;
+      }
+      delete queue;
+      queue = 0;
+#endif
+
+      strm.close();
+      if(!strm) setFailed();
+
+      if(hasFailed()) {
+         FFStreamError e("Error writing file " + filename);
+         GPSTK_THROW(e);
+      }
+   }
+
+   // Pass the pending block to the output thread (or write it).
+   void RinexObsEpochWriter::flushPending() throw(FFStreamError)
+   {
+      if(closed) {
+         FFStreamError e("Write after close of file " + filename);
+         GPSTK_THROW(e);
+      }
+
+#ifndef _WIN32
+      if(!queue) {
+         queue = new BoundedQueue<string>(depth);
+         threadRunning = (::pthread_create(&thread, 0, outputMain, this) == 0);
+         if(!threadRunning) {                 // write in this thread instead
+            delete queue;
+            queue = 0;
+         }
+      }
+
+      if(threadRunning)
+         queue->push(pending);
+      else
+#endif
+         writeBlock(pending);
+
+      pending.clear();
+
+      if(hasFailed()) {
+         FFStreamError e("Error writing file " + filename);
+         GPSTK_THROW(e);
+      }
+   }
+
+   // Write a block to the file; sets failed on error.
+   void RinexObsEpochWriter::writeBlock(const string& block) throw()
+   {
+      if(hasFailed()) return;
+      strm.write(block.data(), block.size());
+      if(!strm) setFailed();
+   }
+
+   // Read failed; it is set by the output thread.
+   bool RinexObsEpochWriter::hasFailed() const throw()
+   {
+#ifndef _WIN32
+      ::pthread_mutex_lock(&failLock);
+      bool f(failed);
+      ::pthread_mutex_unlock(&failLock);
+      return f;
+#else
+      return failed;
+#endif
+   }
+
+   // Set failed.
+   void RinexObsEpochWriter::setFailed() throw()
+   {
+#ifndef _WIN32
+      ::pthread_mutex_lock(&failLock);
+#endif
+      failed = true;
+#ifndef _WIN32
+      ::pthread_mutex_unlock(&failLock);
+#endif
+   }
+
+#ifndef _WIN32
+   // Entry point of the output thread
+   void *RinexObsEpochWriter::outputMain(void *arg)
+   {
+      static_cast<RinexObsEpochWriter *>(arg)->output();
+      return 0;
+   }
+
+   // Write blocks from the queue until it is closed.
+   void RinexObsEpochWriter::output() throw()
+   {
+      string block;
+      while(queue->pop(block))
+         writeBlock(block);
+   }
+#endif
+
+}  // End of namespace gpstk
@@ -0,0 +1,126 @@
+#pragma ident "$Id$"
+
+/// @file RinexObsEpochWriter.hpp
+/// Write a RINEX 2 observation file from epochs kept as raw text, with the
+/// file output done by a background thread.
+
+#ifndef GPSTK_RINEX_OBS_EPOCH_WRITER_INCLUDE
+#define GPSTK_RINEX_OBS_EPOCH_WRITER_INCLUDE
+
+#include <string>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "BoundedQueue.hpp"
+#include "RinexObsEpochReader.hpp"
+#include "RinexObsHeader.hpp"
+#include "RinexObsStream.hpp"
+
+namespace gpstk
+{
+   /** @addtogroup RinexObs */
+   //@{
+
+   /// Write a RINEX 2 observation file: first the header, then epochs read
+   /// with RinexObsEpochReader (or any text in the same format), which are
+   /// copied to the file unchanged.
+   ///
+   /// Epochs are collected into blocks of about 64 kB that a background
+   /// thread (POSIX threads) writes to the file, so the caller can go on
+   /// reading and merging while the output is written. Where threads are not
+   /// available (_WIN32) each block is written by the calling thread.
+   /// close() must be called to write the last block and to learn of any
+   /// output error.
+   class RinexObsEpochWriter
+   {
+   public:
+
+      /// Constructor; creates (truncates) the file.
+      /// @param filename name of the output file
+      /// @param depth maximum number of blocks waiting to be written
+      /// @throw FileMissingException if the file cannot be created
+      RinexObsEpochWriter(const std::string& filename, unsigned int depth = 16)
+         throw(FileMissingException);
+
+      /// Destructor; calls close(), ignoring errors.
+      ~RinexObsEpochWriter() throw();
+
+      /// Write the header; must come before any epoch.
+      /// @throw FFStreamError if the header is not valid or cannot be written
+      void write(const RinexObsHeader& header) throw(FFStreamError);
+
+      /// Write an epoch. Epochs for which RinexObsData would write nothing
+      /// (see RinexObsEpochReader::Epoch::empty()) are skipped likewise.
+      /// @throw FFStreamError if an earlier block could not be written
+      void write(const RinexObsEpochReader::Epoch& epoch) throw(FFStreamError);
+
+      /// Write everything still pending and close the file.
+      /// @throw FFStreamError if any part of the output could not be written
+      void close() throw(FFStreamError);
+
+   private:
+
+      /// Pass the pending block to the output thread (or write it).
+      void flushPending() throw(FFStreamError);
+
+      /// Write a block to the file; sets failed on error.
+      void writeBlock(const std::string& block) throw();
+
+      /// Read failed; it is set by the output thread.
+      bool hasFailed() const throw();
+
+      /// Set failed.
+      void setFailed() throw();
+
+      /// Name of the file
+      std::string filename;
+
+      /// The file
+      RinexObsStream strm;
+
+      /// Text collected for the next block
+      std::string pending;
+
+      /// Maximum number of blocks waiting to be written
+      unsigned int depth;
+
+      /// True once close() has been called
+      bool closed;
+
+      /// True if writing to the file failed; read and set only through
+      /// hasFailed() and setFailed()
+      bool failed;
+
+#ifndef _WIN32
+      /// Protects failed
+      mutable pthread_mutex_t failLock;
+
+      /// Entry point of the output thread
+      static void *outputMain(void *arg);
+
+      /// Write blocks from the queue until it is closed.
+      void output() throw();
+
+      /// Blocks waiting to be written
+      BoundedQueue<std::string> *queue;
+
+      /// The output thread
+      pthread_t thread;
+
+      /// True while the output thread is running
+      bool threadRunning;
+#endif
+
+      /// Not copyable
+      RinexObsEpochWriter(const RinexObsEpochWriter&);
+      RinexObsEpochWriter& operator=(const RinexObsEpochWriter&);
+
+   }; // end class RinexObsEpochWriter
+
+   //@}
+
+}  // End of namespace gpstk
+
+#endif // GPSTK_RINEX_OBS_EPOCH_WRITER_INCLUDE
@@ -0,0 +1,149 @@
+#pragma ident "$Id$"
+
+/// @file RinexObsMerge.cpp
+/// Merge RINEX 2 observation files into one file sorted by time.
+
+#include "RinexObsMerge.hpp"
+#include "RinexObsStream.hpp"
+#include "RinexObsHeader.hpp"
+#include "RinexObsData.hpp"
+#include "RinexObsFilterOperators.hpp"
+#include "RinexObsEpochReader.hpp"
+#include "RinexObsEpochWriter.hpp"
+#include "FileFilterFrameWithHeader.hpp"
+#include "SystemTime.hpp"
+#include "CivilTime.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   // Merge time ordered inputs epoch by epoch as text.
+   bool streamMergeRinexObs(const vector<string>& files,
+                            const string& outputFile)
+   {
+      size_t i, n(files.size());
+
+         // open every input; each reader reads ahead in its own thread
+      vector<RinexObsEpochReader*> readers(n, (RinexObsEpochReader*)0);
+      try
+      {
+         for (i = 0; i < n; i++)
+            readers[i] = new RinexObsEpochReader(files[i]);
+
+            // get the header data
+         RinexObsHeaderTouchHeaderMerge merged;
+         for (i = 0; i < n; i++)
+            merged(readers[i]->getHeader());
+
+            // every input delivers the obs types of the merged header
+         for (i = 0; i < n; i++)
+            readers[i]->setObsTypes(merged.theHeader.obsTypeList);
+
+            // the first epoch of each input
+         vector<RinexObsEpochReader::Epoch> epochs(n);
+         vector<bool> more(n);
+         for (i = 0; i < n; i++)
+            more[i] = readers[i]->next(epochs[i]);
+
+            // set the time of first obs in the header
+         bool first(true);
+         for (i = 0; i < n; i++)
+         {
+            if (more[i] && (first || epochs[i].time < merged.theHeader.firstObs))
+               merged.theHeader.firstObs = epochs[i].time;
+            if (more[i]) first = false;
+         }
+
+            // set the pgm/runby/date field
+         merged.theHeader.fileProgram = string("mergeRinObs");
+         merged.theHeader.fileAgency = string("gpstk");
+         merged.theHeader.date = CivilTime(SystemTime()).asString();
+
+         RinexObsEpochWriter writer(outputFile);
+         writer.write(merged.theHeader);
+
+            // write the epochs in time order; for equal times, inputs in the
+            // order given. An epoch with the same time and epoch flag as one
+            // already written from another input is a duplicate.
+         CommonTime lastTime(CommonTime::BEGINNING_OF_TIME);
+         vector< pair<short, size_t> > written;
+         while (1)
+         {
+            size_t next(n);
+            for (i = 0; i < n; i++)
+               if (more[i] && (next == n || epochs[i].time < epochs[next].time))
+                  next = i;
+            if (next == n)
+               break;
+
+            RinexObsEpochReader::Epoch& epoch(epochs[next]);
+            if (epoch.time < lastTime)
+            {
+               for (i = 0; i < n; i++)
+                  delete readers[i];
+               return false;
+            }
+            if (epoch.time != lastTime)
+            {
+               lastTime = epoch.time;
+               written.clear();
+            }
+
+            bool duplicate(false);
+            for (i = 0; i < written.size(); i++)
+               if (written[i].first == epoch.epochFlag && written[i].second != next)
+                  duplicate = true;
+            if (!duplicate)
+            {
+               writer.write(epoch);
+               written.push_back(make_pair(epoch.epochFlag, next));
+            }
+
+            more[next] = readers[next]->next(epoch);
+         }
+
+         writer.close();
+      }
+      catch (...)
+      {
+         for (i = 0; i < n; i++)
+            delete readers[i];
+         throw;
+      }
+
+      for (i = 0; i < n; i++)
+         delete readers[i];
+      return true;
+   }
+
+   // Read everything, sort by time, and write every epoch anew.
+   void sortMergeRinexObs(const vector<string>& files,
+                          const string& outputFile)
+   {
+         // FFF will sort and merge the obs data using
+         // a simple time check
+      FileFilterFrameWithHeader<RinexObsStream, RinexObsData, RinexObsHeader>
+         fff(files);
+
+         // get the header data
+      RinexObsHeaderTouchHeaderMerge merged;
+      fff.touchHeader(merged);
+
+         // sort and filter the data using the obs set from the merged header
+      fff.sort(RinexObsDataOperatorLessThanFull(merged.obsSet));
+      fff.unique(RinexObsDataOperatorEqualsSimple());
+
+         // set the time of first obs in the header
+      merged.theHeader.firstObs = fff.front().time;
+
+         // set the pgm/runby/date field
+      merged.theHeader.fileProgram = string("mergeRinObs");
+      merged.theHeader.fileAgency = string("gpstk");
+      merged.theHeader.date = CivilTime(SystemTime()).asString();
+
+         // write the file
+      fff.writeFile(outputFile, merged.theHeader);
+   }
+
+}  // End of namespace gpstk
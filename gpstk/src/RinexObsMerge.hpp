@@ -0,0 +1,47 @@
+#pragma ident "$Id$"
+
+/// @file RinexObsMerge.hpp
+/// Merge RINEX 2 observation files into one file sorted by time.
+
+#ifndef GPSTK_RINEX_OBS_MERGE_INCLUDE
+#define GPSTK_RINEX_OBS_MERGE_INCLUDE
+
+#include <string>
+#include <vector>
+
+#include "Exception.hpp"
+
+namespace gpstk
+{
+   /** @addtogroup RinexObs */
+   //@{
+
+   /// Merge time ordered RINEX obs files epoch by epoch, copying each epoch
+   /// as text (see RinexObsEpochReader and RinexObsEpochWriter). The header
+   /// is merged as RinexObsHeaderTouchHeaderMerge does, and every input
+   /// delivers the obs types of the merged header. For equal times, inputs
+   /// are taken in the order given; an epoch with the same time and epoch
+   /// flag as one already written from another input is dropped as a
+   /// duplicate.
+   /// @param files names of the input files
+   /// @param outputFile name of the output file
+   /// @return false, leaving an incomplete output file, if an input is found
+   ///    not to be in time order; true otherwise
+   /// @throw Exception if an input cannot be read or the output written
+   bool streamMergeRinexObs(const std::vector<std::string>& files,
+                            const std::string& outputFile);
+
+   /// Merge RINEX obs files by reading them all into memory, sorting by time,
+   /// dropping epochs with equal times, and writing every epoch anew. The
+   /// inputs need not be in time order.
+   /// @param files names of the input files
+   /// @param outputFile name of the output file
+   /// @throw Exception if an input cannot be read or the output written
+   void sortMergeRinexObs(const std::vector<std::string>& files,
+                          const std::string& outputFile);
+
+   //@}
+
+}  // End of namespace gpstk
+
+#endif // GPSTK_RINEX_OBS_MERGE_INCLUDE
@@ -314,10 +314,10 @@ namespace gpstk
    void SP3Data::reallyPutRecord(FFStream& ffs) const 
       throw(exception, FFStreamError, StringException)
    {
-      string line;
-
       // cast the stream to be an SP3Stream
       SP3Stream& strm = dynamic_cast<SP3Stream&>(ffs);
+      FormattedLine& line(strm.formattedLine);
+      line.clear();
 
       // version to be written out is determined by written header (stored in strm)
       bool isVerA = (strm.header.getVersion() == SP3Header::SP3a);
@@ -326,42 +326,46 @@ namespace gpstk
       // output Epoch Header Record
       if(RecType == '*') {
          CivilTime civTime(time);
-         line = "* ";
-         line += civTime.printf(" %4Y %2m %2d %2H %2M");
-         line += " " + rightJustify(civTime.printf("%.8f"),11);
+         line.add("* ");
+         line.print(" %4d %2d %2d %2d %2d", civTime.year, civTime.month,
+                    civTime.day, civTime.hour, civTime.minute);
+         line.add(' ').addFixed(civTime.second, 8, 11);
       }
 
       // output Position and Clock OR Velocity and Clock Rate Record
       else {
-         line = RecType;                                    // P or V
+         line.add(RecType);                                 // P or V
          if(isVerA) {
             if(sat.system != SatID::systemGPS) {
                FFStreamError fse("Cannot output non-GPS to SP3a");
                GPSTK_THROW(fse);
             }
-            line += rightJustify(asString(sat.id),3);
+            line.addInt(sat.id, 3);
+         }
+         else {                                             // sat ID
+            SP3SatID sp3sat(sat);
+            line.add(sp3sat.systemChar());
+            line.addPadded(sp3sat.id, 2, sp3sat.getfill());
          }
-         else
-            line += static_cast<SP3SatID>(sat).toString();  // sat ID
 
-         line += rightJustify(asString(x[0],6),14);         // XYZ
-         line += rightJustify(asString(x[1],6),14);
-         line += rightJustify(asString(x[2],6),14);
-         line += rightJustify(asString(clk,6),14);          // Clock
+         line.addFixed(x[0], 6, 14);                        // XYZ
+         line.addFixed(x[1], 6, 14);
+         line.addFixed(x[2], 6, 14);
+         line.addFixed(clk, 6, 14);                         // Clock
 
          if(isVerC) {
-            line += rightJustify(asString(sig[0]),3);       // sigma XYZ
-            line += rightJustify(asString(sig[1]),3);
-            line += rightJustify(asString(sig[2]),3);
-            line += rightJustify(asString(sig[3]),4);       // sigma Clock
+            line.addInt(sig[0], 3);                         // sigma XYZ
+            line.addInt(sig[1], 3);
+            line.addInt(sig[2], 3);
+            line.addInt(sig[3], 4);                         // sigma Clock
             
             if(RecType == 'P') {                            // flags or blanks
-               line += string(" ");
-               line += (clockEventFlag ? string("E") : string(" "));
-               line += (clockPredFlag ? string("P") : string(" "));
-               line += string("  ");
-               line += (orbitManeuverFlag ? string("M") : string(" "));
-               line += (orbitPredFlag ? string("P") : string(" "));
+               line.add(' ');
+               line.add(clockEventFlag ? 'E' : ' ');
+               line.add(clockPredFlag ? 'P' : ' ');
+               line.add(' ', 2);
+               line.add(orbitManeuverFlag ? 'M' : ' ');
+               line.add(orbitPredFlag ? 'P' : ' ');
             }
          }
 
@@ -370,26 +374,25 @@ namespace gpstk
          if(isVerC && correlationFlag) {
 
             // first output the P|V record you just built
-            strm << line << endl;
-            strm.lineNumber++;
+            strm.formattedPutLine();
 
             // now build and output the correlation record
+            line.clear();
             if(RecType == 'P')                                 // P or V
-               line = "EP ";
+               line.add("EP ");
             else
-               line = "EV ";
-            line += rightJustify(asString(sdev[0]),5);         // stddev X
-            line += rightJustify(asString(sdev[1]),5);         // stddev Y
-            line += rightJustify(asString(sdev[2]),5);         // stddev Z
-            line += rightJustify(asString(sdev[3]),8);         // stddev Clk
+               line.add("EV ");
+            line.addUnsigned(sdev[0], 5);                      // stddev X
+            line.addUnsigned(sdev[1], 5);                      // stddev Y
+            line.addUnsigned(sdev[2], 5);                      // stddev Z
+            line.addUnsigned(sdev[3], 8);                      // stddev Clk
             for(int i=0; i<6; i++)                             // correlations
-               line += rightJustify(asString(correlation[i]),9);
+               line.addInt(correlation[i], 9);
          }
       }
 
       // write the line just built
-      strm << line << endl;
-      strm.lineNumber++;
+      strm.formattedPutLine();
 
    }  // end reallyPutRecord()
 
@@ -9,6 +9,8 @@
 /// interpolation algorithm.
 
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 #include "Exception.hpp"
 #include "SatID.hpp"
@@ -24,6 +26,8 @@
 #include "RinexClockData.hpp"
 
 #include "FileStore.hpp"
+#include "StoreCache.hpp"
+#include "ThreadPool.hpp"
 #include "ClockSatStore.hpp"
 #include "PositionSatStore.hpp"
 
@@ -35,6 +39,32 @@ namespace gpstk
 {
    using namespace StringUtils;
 
+   /// Snapshot records of the position and clock tables
+   typedef StoreCache::SatTimeRecord<PositionRecordSize> PositionCacheRecord;
+   typedef StoreCache::SatTimeRecord<ClockRecordSize> ClockCacheRecord;
+
+   static PositionCacheRecord makeCacheRecord(const SatID& sat,
+                                              const CommonTime& ttag,
+                                              const PositionRecord& rec)
+   {
+      PositionCacheRecord crec;
+      crec.time = StoreCache::packTime(ttag);
+      crec.sat = StoreCache::packSat(sat);
+      packPositionRecord(rec, crec.data);
+      return crec;
+   }
+
+   static ClockCacheRecord makeCacheRecord(const SatID& sat,
+                                           const CommonTime& ttag,
+                                           const ClockRecord& rec)
+   {
+      ClockCacheRecord crec;
+      crec.time = StoreCache::packTime(ttag);
+      crec.sat = StoreCache::packSat(sat);
+      packClockRecord(rec, crec.data);
+      return crec;
+   }
+
 
    // Returns the position, velocity, and clock offset of the indicated
    // object in ECEF coordinates (meters) at the indicated time.
@@ -198,11 +228,14 @@ namespace gpstk
    }
 
 
-   // This is a private utility routine used by the loadFile and loadSP3File routines.
-   // Store position (velocity) and clock data from SP3 files in clock and position
-   // stores. Also update the FileStore with the filename and SP3 header.
-   void SP3EphemerisStore::loadSP3Store(const string& filename, bool fillClockStore)
-      throw(Exception)
+   // Private utility routine used by loadFileList(). Read position (velocity)
+   // and, if fillClockStore, clock data from an SP3 file, applying the reject
+   // flags, into the header and lists of records, in file order.
+   bool SP3EphemerisStore::readSP3File(const string& filename, bool fillClockStore,
+                                       SP3Header& head,
+                                       vector<PositionCacheRecord>& posRecs,
+                                       vector<ClockCacheRecord>& clkRecs)
+      const throw(Exception)
    {
       try {
          // open the input stream
@@ -214,9 +247,6 @@ namespace gpstk
          strm.exceptions(ios::failbit);
          //cout << "Opened file " << filename << endl;
 
-         // declare header and data
-         SP3Header head;
-
          // read the SP3 ephemeris header
          try {
             strm >> head;
@@ -227,31 +257,29 @@ namespace gpstk
          }
          //cout << "Read header" << endl; head.dump();
 
-         // check/save TimeSystem to storeTimeSystem
-         if(head.timeSystem != TimeSystem::Any &&
-            head.timeSystem != TimeSystem::Unknown)
-         {
-            // if store time system has not been set, do so
-            if(storeTimeSystem == TimeSystem::Any) {
-               // NB. store-, pos- and clk- TimeSystems must always be the same
-               storeTimeSystem = head.timeSystem;
-               posStore.setTimeSystem(head.timeSystem);
-               clkStore.setTimeSystem(head.timeSystem);
-            }
-
-            // if store system has been set, and it doesn't agree, throw
-            else if(storeTimeSystem != head.timeSystem)
+         // if there is an up-to-date snapshot of this file, take the data from it
+         StoreCache cache;
+         string cacheFile, cacheKey;
+         if(SP3Files.isCaching()) {
+            cacheFile = StoreCache::cacheFileName(SP3Files.getCacheDirectory(),
+                                                  filename, "SP3 ");
+            cacheKey = SP3CacheKey(filename, fillClockStore);
+
+            const PositionCacheRecord *precs;
+            const ClockCacheRecord *crecs;
+            size_t npos, nclk;
+            if(cache.open(cacheFile, "SP3 ", cacheKey) &&
+               cache.getSection("POS ", precs, npos) &&
+               cache.getSection("CLK ", crecs, nclk))
             {
-               InvalidRequest ir("Time system of file " + filename
-                  + " (" + head.timeSystem.asString()
-                  + ") is incompatible with store time system ("
-                  + storeTimeSystem.asString() + ").");
-               GPSTK_THROW(ir);
+               posRecs.insert(posRecs.end(), precs, precs+npos);
+               clkRecs.insert(clkRecs.end(), crecs, crecs+nclk);
+               strm.close();
+               return true;
             }
-         }  // end if header time system is set
-
-         // save in FileStore
-         SP3Files.addFile(filename, head);
+            cache.close();
+         }
+         size_t nposStart(posRecs.size()), nclkStart(clkRecs.size());
 
          // read data
          bool isC(head.version==SP3Header::SP3c);
@@ -397,10 +425,12 @@ namespace gpstk
                   }
                   else {
                      //cout << "Add rec: " << sat << " " << ttag << " " << prec<<endl;
-                     if(!rejectPredPosFlag || !predP)
-                        posStore.addPositionRecord(sat,ttag,prec);
-                     if(fillClockStore && (!rejectPredClockFlag || !predC))
-                        clkStore.addClockRecord(sat,ttag,crec);
+                     if(!rejectPredPosFlag || !predP) {
+                        posRecs.push_back(makeCacheRecord(sat,ttag,prec));
+                     }
+                     if(fillClockStore && (!rejectPredClockFlag || !predC)) {
+                        clkRecs.push_back(makeCacheRecord(sat,ttag,crec));
+                     }
 
                      // prepare for next
                      haveP = haveV = haveEP = haveEV = predP = predC = false;
@@ -427,10 +457,12 @@ namespace gpstk
                }
                else {
                   //cout << "Add last rec: "<< sat <<" "<< ttag <<" "<< prec << endl;
-                  if(!rejectPredPosFlag || !predP)
-                     posStore.addPositionRecord(sat,ttag,prec);
-                  if(fillClockStore && (!rejectPredClockFlag || !predC))
-                     clkStore.addClockRecord(sat,ttag,crec);
+                  if(!rejectPredPosFlag || !predP) {
+                     posRecs.push_back(makeCacheRecord(sat,ttag,prec));
+                  }
+                  if(fillClockStore && (!rejectPredClockFlag || !predC)) {
+                     clkRecs.push_back(makeCacheRecord(sat,ttag,crec));
+                  }
                }
             }
          }
@@ -442,11 +474,46 @@ namespace gpstk
          // close
          strm.close();
 
+         // save the snapshot for the next load; the snapshot is only an
+         // optimization, so failure to write it is not an error
+         if(!cacheFile.empty()) {
+            try {
+               cache.addSection("POS ", sizeof(PositionCacheRecord),
+                                posRecs.size()-nposStart,
+                                posRecs.size() > nposStart ? &posRecs[nposStart] : 0);
+               cache.addSection("CLK ", sizeof(ClockCacheRecord),
+                                clkRecs.size()-nclkStart,
+                                clkRecs.size() > nclkStart ? &clkRecs[nclkStart] : 0);
+               cache.write(cacheFile, "SP3 ", cacheKey);
+            }
+            catch(Exception& e) { ; }
+         }
+
+         return false;
       }
       catch(Exception& e) { GPSTK_RETHROW(e); }
 
    }
 
+   // Build the key of the binary snapshot of an SP3 file; this includes the flags
+   // that determine which records readSP3File() returns.
+   string SP3EphemerisStore::SP3CacheKey(const string& filename,
+                                         bool fillClockStore)
+      const throw(FileMissingException)
+   {
+      try {
+         ostringstream oss;
+         oss << StoreCache::sourceKey(filename)
+             << "clock=" << fillClockStore
+             << ";badPos=" << rejectBadPosFlag
+             << ";badClock=" << rejectBadClockFlag
+             << ";predPos=" << rejectPredPosFlag
+             << ";predClock=" << rejectPredClockFlag << ";";
+         return oss.str();
+      }
+      catch(FileMissingException& e) { GPSTK_RETHROW(e); }
+   }
+
    // Load an SP3 ephemeris file; if the clock store uses RINEX clock files,
    // this routine will also accept that file type and load the data into the
    // clock store. This routine will may set the velocity, acceleration, bias
@@ -454,42 +521,7 @@ namespace gpstk
    void SP3EphemerisStore::loadFile(const string& filename) throw(Exception)
    {
       try {
-         // if using only SP3, simply read the SP3
-         if(useSP3clock) {
-            loadSP3Store(filename, true);
-            return;
-         }
-
-         // must determine what kind of file it is
-         bool isSP3(true);
-         while(1) {                    // decide if the file is SP3
-            SP3Stream strm;
-
-            // open
-            try {
-               strm.open(filename.c_str(),std::ios::in);
-               if(!strm.is_open()) { isSP3 = false; break; }
-               strm.exceptions(std::fstream::failbit);
-            }
-            catch(Exception& e) { isSP3 = false; break; }
-            catch(std::exception& e) { isSP3 = false; break; }
-
-            // read the header
-            SP3Header header;
-            try {
-               strm >> header;
-               strm.close();           // close will throw when file does not exist
-            }
-            catch(Exception& e) { isSP3 = false; break; }
-            catch(std::exception& e) { isSP3 = false; break; }
-
-            break;      // mandatory
-         }
-
-         // call the appropriate load routine
-         if(isSP3) loadSP3File(filename);
-         else      loadRinexClockFile(filename);
-
+         loadFiles(vector<string>(1, filename), 1);
       }
       catch(Exception& e) { GPSTK_RETHROW(e); }
    }
@@ -500,7 +532,7 @@ namespace gpstk
       throw(Exception)
    {
       try {
-         loadSP3Store(filename, useSP3clock);
+         loadFileList(vector<string>(1, filename), vector<FileKind>(1, SP3Kind), 1);
       }
       catch(Exception& e) { GPSTK_RETHROW(e); }
    }
@@ -512,77 +544,211 @@ namespace gpstk
       try {
          if(useSP3clock) useRinexClockData();
 
-         // open the input stream
-         RinexClockStream strm(filename.c_str());
-         if(!strm.is_open()) {
-            Exception e("File " + filename + " could not be opened");
-            GPSTK_THROW(e);
-         }
-         strm.exceptions(std::ios::failbit);
-         //cout << "Opened file " << filename << endl;
+         loadFileList(vector<string>(1, filename),
+                      vector<FileKind>(1, RinexClockKind), 1);
+      }
+      catch(Exception& e) { GPSTK_RETHROW(e); }
+   }
 
-         // declare header and data
-         RinexClockHeader head;
-         RinexClockData data;
+   // Load several files, as loadFile() does for each, reading them concurrently.
+   void SP3EphemerisStore::loadFiles(const vector<string>& filenames,
+                                     unsigned int nthreads)
+      throw(Exception)
+   {
+      try {
+         // if using only SP3, every file is SP3; otherwise the type of each file
+         // is decided when it is read
+         loadFileList(filenames,
+                      vector<FileKind>(filenames.size(),
+                                       useSP3clock ? SP3Kind : UnknownKind),
+                      nthreads);
+      }
+      catch(Exception& e) { GPSTK_RETHROW(e); }
+   }
 
-         // read the RINEX clock header
+   // Return true if the file can be opened and has a valid SP3 header
+   bool SP3EphemerisStore::isSP3File(const string& filename) throw()
+   {
+      SP3Stream strm;
+
+      // open
+      try {
+         strm.open(filename.c_str(),std::ios::in);
+         if(!strm.is_open()) return false;
+         strm.exceptions(std::fstream::failbit);
+      }
+      catch(Exception& e) { return false; }
+      catch(std::exception& e) { return false; }
+
+      // read the header
+      SP3Header header;
+      try {
+         strm >> header;
+         strm.close();           // close will throw when file does not exist
+      }
+      catch(Exception& e) { return false; }
+      catch(std::exception& e) { return false; }
+
+      return true;
+   }
+
+   // Task used by loadFileList() to read one file into its own header and lists
+   // of records; any exception is saved, to be thrown by loadFileList().
+   class SP3EphemerisStore::ReadTask : public ThreadPool::Task
+   {
+   public:
+      ReadTask() : store(0), fromSnapshot(false), failed(false) {}
+
+      const SP3EphemerisStore *store;     ///< store whose settings are used
+      string filename;                    ///< file to read
+      FileKind kind;                      ///< type of the file; set if Unknown
+      SP3Header sp3head;                  ///< header, if SP3
+      RinexClockHeader clkhead;           ///< header, if RINEX clock
+      vector<PositionCacheRecord> posRecs;///< position records
+      vector<ClockCacheRecord> clkRecs;   ///< clock records
+      bool fromSnapshot;                  ///< true if read from a SP3 snapshot
+      bool failed;                        ///< true if reading threw
+      Exception error;                    ///< the exception, if failed
+
+      void run() throw()
+      {
          try {
-            strm >> head;
+            if(kind == UnknownKind)
+               kind = (isSP3File(filename) ? SP3Kind : RinexClockKind);
+
+            if(kind == SP3Kind)
+               fromSnapshot = store->readSP3File(filename, store->useSP3clock,
+                                                 sp3head, posRecs, clkRecs);
+            else
+               RinexClockStore::readFile(filename,
+                                         store->clkFiles.getCacheDirectory(),
+                                         clkhead, clkRecs);
          }
-         catch(Exception& e) {
-            e.addText("Error reading header of file " + filename);
-            GPSTK_RETHROW(e);
+         catch(Exception& e) { error = e; failed = true; }
+         catch(std::exception& e) { error = Exception(e.what()); failed = true; }
+      }
+   };
+
+   // Private utility routine used by all the load routines. Read the files, then
+   // add everything to the store, in file order, or nothing.
+   void SP3EphemerisStore::loadFileList(const vector<string>& filenames,
+                                        const vector<FileKind>& kinds,
+                                        unsigned int nthreads)
+      throw(Exception)
+   {
+      try {
+         size_t i,n(filenames.size());
+
+         // read the files, each into its own lists; nothing is changed yet
+         vector<ReadTask> tasks(n);
+         for(i=0; i<n; i++) {
+            tasks[i].store = this;
+            tasks[i].filename = filenames[i];
+            tasks[i].kind = kinds[i];
+         }
+         if(nthreads == 0) nthreads = ThreadPool::processorCount();
+         if(nthreads > n) nthreads = n;
+         if(nthreads <= 1) {
+            for(i=0; i<n; i++) tasks[i].run();
+         }
+         else {
+            ThreadPool pool(nthreads);
+            for(i=0; i<n; i++) pool.submit(&tasks[i]);
+            pool.wait();
+         }
+         for(i=0; i<n; i++) {
+            if(tasks[i].failed) {
+               Exception e(tasks[i].error);
+               GPSTK_THROW(e);
+            }
          }
-         //cout << "Read header" << endl; head.dump();
 
-         // check/save TimeSystem to storeTimeSystem
-         if(head.timeSystem != TimeSystem::Any &&
-            head.timeSystem != TimeSystem::Unknown)
-         {
-            // if store time system has not been set, do so
-            if(storeTimeSystem == TimeSystem::Any) {
-               // NB. store-, pos- and clk- TimeSystems must always be the same
-               storeTimeSystem = head.timeSystem;
-               posStore.setTimeSystem(head.timeSystem);
-               clkStore.setTimeSystem(head.timeSystem);
+         // check file names and time systems, in file order, before changing
+         // anything
+         TimeSystem sys(storeTimeSystem);
+         for(i=0; i<n; i++) {
+            bool isSP3(tasks[i].kind == SP3Kind);
+            bool dup(isSP3 ? SP3Files.hasFile(filenames[i])
+                           : clkFiles.hasFile(filenames[i]));
+            for(size_t j=0; !dup && j<i; j++)
+               dup = (tasks[j].kind == tasks[i].kind && filenames[j] == filenames[i]);
+            if(dup) {
+               InvalidRequest ir("Duplicate file name " + filenames[i]);
+               GPSTK_THROW(ir);
             }
 
+            TimeSystem fileSys(isSP3 ? tasks[i].sp3head.timeSystem
+                                     : tasks[i].clkhead.timeSystem);
+            if(fileSys == TimeSystem::Any || fileSys == TimeSystem::Unknown)
+               continue;
+
+            // if store time system has not been set, do so
+            if(sys == TimeSystem::Any)
+               sys = fileSys;
+
             // if store system has been set, and it doesn't agree, throw
-            else if(storeTimeSystem != head.timeSystem)
-            {
-               InvalidRequest ir("Time system of file " + filename
-                  + " (" + head.timeSystem.asString()
+            else if(sys != fileSys) {
+               InvalidRequest ir("Time system of file " + filenames[i]
+                  + " (" + fileSys.asString()
                   + ") is incompatible with store time system ("
-                  + storeTimeSystem.asString() + ").");
+                  + sys.asString() + ").");
                GPSTK_THROW(ir);
             }
-         }  // end if header time system is set
+         }
 
-         // save in FileStore
-         clkFiles.addFile(filename, head);
+         if(storeTimeSystem == TimeSystem::Any && sys != TimeSystem::Any) {
+            // NB. store-, pos- and clk- TimeSystems must always be the same
+            storeTimeSystem = sys;
+            posStore.setTimeSystem(sys);
+            clkStore.setTimeSystem(sys);
+         }
 
-         // read data
+         // gather the records of all files, in file order, then add them to the
+         // tables in one sorted pass; the rules for records at the same
+         // (sat,time) in more than one file are those of loading the files one
+         // at a time, in this order.
+         vector<SatID> sats;
+         vector<CommonTime> ttags;
+         vector<PositionRecord> precs;
+         vector<ClockRecord> crecs;
          try {
-            while(strm >> data) {
-               //data.dump(cout);
-
-               if(data.datatype == std::string("AS")) {
-                  // add this data
-                  ClockRecord rec;
-                  rec.bias = data.bias; rec.sig_bias = data.sig_bias,
-                  rec.drift = data.drift; rec.sig_drift = data.sig_drift,
-                  rec.accel = data.accel; rec.sig_accel = data.sig_accel;
-                  clkStore.addClockRecord(data.sat, data.time, rec);
+            for(i=0; i<n; i++) {
+               const vector<PositionCacheRecord>& recs(tasks[i].posRecs);
+               size_t k, m(sats.size());
+               sats.resize(m + recs.size());
+               ttags.resize(m + recs.size());
+               precs.resize(m + recs.size());
+               for(k=0; k<recs.size(); k++) {
+                  sats[m+k] = StoreCache::unpackSat(recs[k].sat);
+                  ttags[m+k] = StoreCache::unpackTime(recs[k].time);
+                  unpackPositionRecord(recs[k].data, precs[m+k]);
                }
+               vector<PositionCacheRecord>().swap(tasks[i].posRecs);
             }
          }
-         catch(Exception& e) {
-            e.addText("Error reading data of file " + filename);
-            GPSTK_RETHROW(e);
+         catch(InvalidParameter& ip) {
+            InvalidRequest ir(ip);
+            GPSTK_THROW(ir);
          }
+         posStore.addPositionRecords(sats, ttags, precs);
 
-         strm.close();
+         sats.clear();
+         ttags.clear();
+         for(i=0; i<n; i++) {
+            RinexClockStore::unpackRecords(tasks[i].clkRecs, sats, ttags, crecs);
+            vector<ClockCacheRecord>().swap(tasks[i].clkRecs);
+         }
+         clkStore.addClockRecords(sats, ttags, crecs);
 
+         // save in FileStore
+         for(i=0; i<n; i++) {
+            if(tasks[i].kind == SP3Kind) {
+               SP3Files.addFile(filenames[i], tasks[i].sp3head);
+               if(tasks[i].fromSnapshot) SP3Files.countSnapshotRead();
+            }
+            else
+               clkFiles.addFile(filenames[i], tasks[i].clkhead);
+         }
       }
       catch(Exception& e) { GPSTK_RETHROW(e); }
    }
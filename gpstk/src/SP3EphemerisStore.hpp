@@ -22,8 +22,10 @@
 #include "XvtStore.hpp"
 
 #include "FileStore.hpp"
+#include "StoreCache.hpp"
 #include "ClockSatStore.hpp"
 #include "PositionSatStore.hpp"
+#include "RinexClockStore.hpp"
 
 #include "SP3Header.hpp"
 #include "RinexClockHeader.hpp"
@@ -81,13 +83,56 @@ namespace gpstk
 
    // member functions
 
-      /// Private utility routine used by the loadFile and loadSP3File routines.
-      /// Store position (velocity) and clock data from SP3 files in clock and
-      /// position stores. Also update the FileStore with the filename and SP3 header.
-      /// Check time systems consistentcy, and if possible set store time system.
-      void loadSP3Store(const std::string& filename, bool fillClockStore)
+      /// Snapshot record of the position table (see StoreCache); also used to
+      /// hold the records of a file between reading it and adding it to a store.
+      typedef StoreCache::SatTimeRecord<PositionRecordSize> PositionCacheRecord;
+
+      /// Snapshot record of the clock table
+      typedef RinexClockStore::ClockCacheRecord ClockCacheRecord;
+
+      /// Kinds of file handled by loadFileList()
+      enum FileKind {
+         SP3Kind,             ///< SP3 file; clock data used only if useSP3clock
+         RinexClockKind,      ///< RINEX clock file
+         UnknownKind          ///< either; decided by reading the header
+      };
+
+      /// Task used by loadFileList() to read one file
+      class ReadTask;
+      friend class ReadTask;
+
+      /// Private utility routine used by all the load routines. Read the given
+      /// files (concurrently, if nthreads > 1) without changing the store; then
+      /// check the time systems, add all the position and clock records to the
+      /// tables in one sorted pass, in the order of the files, and add the files
+      /// and their headers to the FileStores. If any step fails, nothing is added.
+      void loadFileList(const std::vector<std::string>& filenames,
+                        const std::vector<FileKind>& kinds,
+                        unsigned int nthreads)
          throw(Exception);
 
+      /// Private utility routine used by loadFileList(). Read position (velocity)
+      /// and, if fillClockStore, clock data from an SP3 file, applying the reject
+      /// flags, into the header and lists of records, in file order. This does not
+      /// change the object, and may be called concurrently for different files.
+      /// If a cache directory is set, the records are taken from the file's
+      /// snapshot when it is up to date, and the snapshot is written otherwise.
+      /// @return true if the records were taken from the snapshot
+      bool readSP3File(const std::string& filename, bool fillClockStore,
+                       SP3Header& head,
+                       std::vector<PositionCacheRecord>& posRecs,
+                       std::vector<ClockCacheRecord>& clkRecs)
+         const throw(Exception);
+
+      /// Private utility routine used by readSP3File; build the key of the
+      /// binary snapshot of an SP3 file from the file's name, size and time and
+      /// the flags that determine which records are stored.
+      std::string SP3CacheKey(const std::string& filename, bool fillClockStore)
+         const throw(FileMissingException);
+
+      /// Return true if the file can be opened and has a valid SP3 header
+      static bool isSP3File(const std::string& filename) throw();
+
    public:
 
       /// Default constructor
@@ -450,6 +495,22 @@ namespace gpstk
       /// @throw if time step is inconsistent with previous value
       void loadRinexClockFile(const std::string& filename) throw(Exception);
 
+      /// Load several files, as loadFile() does for each. The files are read
+      /// concurrently, each into its own lists of records, and the records are
+      /// then added to the tables in one sorted pass. The result is the same as
+      /// calling loadFile() for each file in the order given; in particular, where
+      /// files overlap (e.g. the boundary epoch of consecutive daily files), a
+      /// record from a later file replaces that of an earlier one.
+      /// @param filenames names of files (SP3, or RINEX clock if the clock store
+      ///    uses RINEX clock files) to load
+      /// @param nthreads number of reading threads; 0 means one per processor.
+      ///    No more threads than files are used.
+      /// @throw Exception if any file cannot be read, is already loaded, or has a
+      ///    time system inconsistent with the store; in that case nothing is loaded.
+      void loadFiles(const std::vector<std::string>& filenames,
+                     unsigned int nthreads = 0)
+         throw(Exception);
+
 
       /// Add a complete PositionRecord to the store; this is the preferred method
       /// of adding data to the tables.
@@ -522,6 +583,22 @@ namespace gpstk
       }
 
 
+      /// Set the directory in which binary snapshots of the loaded SP3 and RINEX
+      /// clock files are kept (see StoreCache). When set, loadFile() and friends
+      /// still read each file's header, but take the data records from an
+      /// up-to-date snapshot if one exists, and write the snapshot otherwise.
+      /// @param dir directory for snapshots; empty turns snapshots off.
+      void setCacheDirectory(const std::string& dir) throw()
+         { SP3Files.setCacheDirectory(dir); clkFiles.setCacheDirectory(dir); }
+
+      /// Get the directory in which binary snapshots are kept
+      std::string getCacheDirectory(void) const throw()
+         { return SP3Files.getCacheDirectory(); }
+
+      /// Get number of SP3 files whose data were taken from their snapshots
+      unsigned nSP3SnapshotReads(void) const throw()
+         { return SP3Files.getSnapshotReads(); }
+
       /// Get number of files (all types) in FileStore.
       int nfiles(void) throw()
          { return (SP3Files.size() + (useSP3clock ? 0 : clkFiles.size())); }
@@ -103,13 +103,20 @@ namespace gpstk
       pcb.updateBufferStatus( currentZTime, P_CODE );
    
          // Starting at the beginning of the interval, step through
-         // the six second period loading the code buffer as we go.
-      for ( long i=0;i<NUM_6SEC_WORDS;++i )
+         // the six second period loading the code buffer as we go,
+         // two words (64 chips) at a time.
+      long i = 0;
+      for ( ; i+1<NUM_6SEC_WORDS; i+=2 )
       {
-         pcb[i] = X1Seq[i] ^ X2Seq[X2count];
-         X2count += MAX_BIT;
+         uint64_t X1bits = (uint64_t(X1Seq[i]) << MAX_BIT) | X1Seq[i+1];
+         uint64_t bits = X1bits ^ X2Seq.get64(X2count);
+         pcb[i] = uint32_t(bits >> MAX_BIT);
+         pcb[i+1] = uint32_t(bits);
+         X2count += 2*MAX_BIT;
          if (X2count>=MAX_X2_TEST) X2count -= MAX_X2_TEST;
       }
+      if (i<NUM_6SEC_WORDS)
+         pcb[i] = X1Seq[i] ^ X2Seq[X2count];
    }
 
    void SVPCodeGen::increment4ZCounts( )
@@ -0,0 +1,285 @@
+#pragma ident "$Id$"
+
+/// @file StoreCache.cpp
+/// Binary snapshot files for the data tables of the ephemeris, clock and IONEX
+/// stores.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "StoreCache.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   const UInt32 StoreCache::layoutVersion;
+
+   const string StoreCache::extension(".gsc");
+
+   static const char magicString[8] = { 'G','P','S','T','K','S','C','\0' };
+   static const UInt32 byteOrderMark = 0x01020304;
+
+   // Convert CommonTime to TimeRecord
+   StoreCache::TimeRecord StoreCache::packTime(const CommonTime& t) throw()
+   {
+      long day, msod;
+      double fsod;
+      TimeSystem sys;
+      t.getInternal(day, msod, fsod, sys);
+
+      TimeRecord rec;
+      rec.day = static_cast<Int32>(day);
+      rec.msod = static_cast<Int32>(msod);
+      rec.fsod = fsod;
+      rec.system = static_cast<Int32>(sys.getTimeSystem());
+      rec.pad = 0;
+      return rec;
+   }
+
+   // Convert TimeRecord to CommonTime
+   CommonTime StoreCache::unpackTime(const TimeRecord& rec)
+      throw(InvalidParameter)
+   {
+      CommonTime t;
+      t.setInternal(rec.day, rec.msod, rec.fsod,
+                    TimeSystem(static_cast<TimeSystem::Systems>(rec.system)));
+      return t;
+   }
+
+   // Build the part of a key that identifies a source file
+   string StoreCache::sourceKey(const string& filename)
+      throw(FileMissingException)
+   {
+      struct stat st;
+      if(::stat(filename.c_str(), &st) != 0) {
+         FileMissingException e("Cannot stat file " + filename);
+         GPSTK_THROW(e);
+      }
+
+      ostringstream oss;
+      oss << "file=" << filename
+          << ";size=" << static_cast<UInt64>(st.st_size)
+          << ";mtime=" << static_cast<Int64>(st.st_mtime) << ";";
+      return oss.str();
+   }
+
+   // Build the name of the snapshot file for the given source file and type.
+   string StoreCache::cacheFileName(const string& dir, const string& filename,
+                                    const string& type) throw()
+   {
+      // FNV-1a hash of the full name, so that files with the same base name in
+      // different directories do not share a snapshot
+      UInt64 hash(14695981039346656037ULL);
+      string full(filename + '|' + type);
+      for(size_t i=0; i<full.size(); i++) {
+         hash ^= static_cast<unsigned char>(full[i]);
+         hash *= 1099511628211ULL;
+      }
+
+      string::size_type pos(filename.find_last_of("/\\"));
+      string base(pos == string::npos ? filename : filename.substr(pos+1));
+
+      char hex[17];
+      ::sprintf(hex, "%016llx", static_cast<unsigned long long>(hash));
+
+      string path(dir);
+      if(!path.empty() && path[path.size()-1] != '/') path += '/';
+      return path + base + "." + hex + extension;
+   }
+
+   StoreCache::StoreCache() throw()
+      : base(0), length(0), mapped(false)
+   { }
+
+   UInt32 StoreCache::fourCC(const string& str) throw()
+   {
+      UInt32 code(0);
+      for(size_t i=0; i<4; i++)
+         code = (code << 8) | (i < str.size() ? static_cast<unsigned char>(str[i])
+                                              : static_cast<unsigned char>(' '));
+      return code;
+   }
+
+   // Add a section of nrec records of size recSize for writing.
+   void StoreCache::addSection(const string& tag, size_t recSize, size_t nrec,
+                               const void *data) throw()
+   {
+      PendingSection sec;
+      sec.tag = fourCC(tag);
+      sec.recSize = recSize;
+      sec.nrec = nrec;
+      sec.data = data;
+      pending.push_back(sec);
+   }
+
+   // Write the pending sections to a snapshot file
+   void StoreCache::write(const string& path, const string& type,
+                          const string& key) throw(Exception)
+   {
+      static const char zeros[8] = { 0,0,0,0,0,0,0,0 };
+      string tmpname(path + ".tmp");
+
+      {
+         ofstream ofs(tmpname.c_str(), ios::out | ios::binary | ios::trunc);
+         if(!ofs) {
+            Exception e("Cannot open cache file " + tmpname + " for writing");
+            GPSTK_THROW(e);
+         }
+
+         FileHeader head;
+         ::memcpy(head.magic, magicString, 8);
+         head.version = layoutVersion;
+         head.byteOrder = byteOrderMark;
+         head.storeType = fourCC(type);
+         head.keyLength = static_cast<UInt32>(key.size());
+         head.nsections = static_cast<UInt32>(pending.size());
+         head.reserved = 0;
+         ofs.write(reinterpret_cast<const char *>(&head), sizeof(head));
+
+         ofs.write(key.data(), key.size());
+         ofs.write(zeros, pad8(key.size()) - key.size());
+
+         for(size_t i=0; i<pending.size(); i++) {
+            SectionHeader sec;
+            sec.tag = pending[i].tag;
+            sec.recSize = static_cast<UInt32>(pending[i].recSize);
+            sec.nrec = pending[i].nrec;
+            ofs.write(reinterpret_cast<const char *>(&sec), sizeof(sec));
+
+            size_t nbytes(pending[i].recSize * pending[i].nrec);
+            if(nbytes > 0)
+               ofs.write(static_cast<const char *>(pending[i].data), nbytes);
+            ofs.write(zeros, pad8(nbytes) - nbytes);
+         }
+
+         if(!ofs) {
+            ofs.close();
+            ::remove(tmpname.c_str());
+            Exception e("Failed writing cache file " + tmpname);
+            GPSTK_THROW(e);
+         }
+      }
+
+      if(::rename(tmpname.c_str(), path.c_str()) != 0) {
+         ::remove(tmpname.c_str());
+         Exception e("Cannot rename cache file " + tmpname + " to " + path);
+         GPSTK_THROW(e);
+      }
+
+      pending.clear();
+   }
+
+   // Open a snapshot file for reading and validate its header
+   bool StoreCache::open(const string& path, const string& type, const string& key)
+      throw()
+   {
+      close();
+
+#ifndef _WIN32
+      int fd(::open(path.c_str(), O_RDONLY));
+      if(fd < 0) return false;
+      struct stat st;
+      if(::fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader)) {
+         ::close(fd);
+         return false;
+      }
+      void *ptr(::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0));
+      ::close(fd);
+      if(ptr == MAP_FAILED) return false;
+      base = static_cast<const char *>(ptr);
+      length = st.st_size;
+      mapped = true;
+#else
+      ifstream ifs(path.c_str(), ios::in | ios::binary);
+      if(!ifs) return false;
+      ifs.seekg(0, ios::end);
+      length = ifs.tellg();
+      ifs.seekg(0, ios::beg);
+      if(length < sizeof(FileHeader)) { length = 0; return false; }
+      // allocate as doubles so that the sections are 8-byte aligned
+      double *buffer = new double[(length+7)/8];
+      ifs.read(reinterpret_cast<char *>(buffer), length);
+      base = reinterpret_cast<const char *>(buffer);
+      mapped = false;
+      if(!ifs) { close(); return false; }
+#endif
+
+      const FileHeader *head(reinterpret_cast<const FileHeader *>(base));
+      if(::memcmp(head->magic, magicString, 8) != 0
+         || head->version != layoutVersion
+         || head->byteOrder != byteOrderMark
+         || head->storeType != fourCC(type)
+         || head->keyLength != key.size()
+         || sizeof(FileHeader) + pad8(head->keyLength) > length
+         || key.compare(0, key.size(), base + sizeof(FileHeader), head->keyLength)
+               != 0)
+      {
+         close();
+         return false;
+      }
+
+      // walk the sections once, to make sure the file is complete
+      size_t offset(sizeof(FileHeader) + pad8(head->keyLength));
+      for(UInt32 i=0; i<head->nsections; i++) {
+         if(offset + sizeof(SectionHeader) > length) { close(); return false; }
+         const SectionHeader *sec(
+            reinterpret_cast<const SectionHeader *>(base + offset));
+         offset += sizeof(SectionHeader) + pad8(sec->recSize * sec->nrec);
+         if(offset > length) { close(); return false; }
+      }
+
+      return true;
+   }
+
+   // Find a section in the open snapshot
+   bool StoreCache::getSection(const string& tag, size_t recSize,
+                               const void *& data, size_t& nrec) const throw()
+   {
+      if(!base) return false;
+
+      const FileHeader *head(reinterpret_cast<const FileHeader *>(base));
+      UInt32 code(fourCC(tag));
+      size_t offset(sizeof(FileHeader) + pad8(head->keyLength));
+      for(UInt32 i=0; i<head->nsections; i++) {
+         const SectionHeader *sec(
+            reinterpret_cast<const SectionHeader *>(base + offset));
+         if(sec->tag == code) {
+            if(sec->recSize != recSize) return false;
+            data = base + offset + sizeof(SectionHeader);
+            nrec = static_cast<size_t>(sec->nrec);
+            return true;
+         }
+         offset += sizeof(SectionHeader) + pad8(sec->recSize * sec->nrec);
+      }
+      return false;
+   }
+
+   // Close the open snapshot
+   void StoreCache::close() throw()
+   {
+      if(base) {
+#ifndef _WIN32
+         if(mapped)
+            ::munmap(const_cast<char *>(base), length);
+         else
+#endif
+            delete[] reinterpret_cast<const double *>(base);
+      }
+      base = 0;
+      length = 0;
+      mapped = false;
+      pending.clear();
+   }
+
+}  // End of namespace gpstk
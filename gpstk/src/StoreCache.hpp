@@ -0,0 +1,240 @@
+#pragma ident "$Id$"
+
+/// @file StoreCache.hpp
+/// Binary snapshot files for the data tables of the ephemeris, clock and IONEX
+/// stores. A snapshot is written after a text file has been parsed into a store,
+/// and is read back instead of the text file on later loads, as long as the
+/// source file name, size and modification time (and the store options that
+/// affect parsing) have not changed.
+
+#ifndef GPSTK_STORE_CACHE_INCLUDE
+#define GPSTK_STORE_CACHE_INCLUDE
+
+#include <string>
+#include <vector>
+
+#include "gpstkplatform.h"
+#include "Exception.hpp"
+#include "CommonTime.hpp"
+#include "SatID.hpp"
+
+namespace gpstk
+{
+
+   /** @addtogroup filedirgroup */
+   //@{
+
+   /// Read and write a versioned binary snapshot of (part of) a data store.
+   ///
+   /// The file consists of
+   ///   FileHeader (32 bytes)
+   ///   the key string, zero padded to a multiple of 8 bytes
+   ///   nsections times:
+   ///      SectionHeader (16 bytes)
+   ///      nrec records of recSize bytes, zero padded to a multiple of 8 bytes
+   /// Records are plain structs of 8-byte doubles and 4-byte integers, in host
+   /// byte order, with every section starting on an 8-byte boundary; therefore
+   /// a memory-mapped file is used in place, without copying or decoding.
+   /// A file written on a host of different byte order, by a different version
+   /// of this layout, for a different store type, or with a different key is
+   /// simply rejected by open(), and the caller falls back to the text file.
+   ///
+   /// Writing: call addSection() for each table, then write(). The data passed
+   /// to addSection() is not copied and must stay valid until write() returns.
+   /// Reading: open(), then getSection() for each table, then close() (or let
+   /// the destructor unmap the file).
+   class StoreCache
+   {
+   public:
+
+      /// Version of the binary layout; must be changed whenever the file header,
+      /// the section header or any of the record structs below is changed.
+      static const UInt32 layoutVersion = 1;
+
+      /// File name extension of snapshot files
+      static const std::string extension;
+
+      /// A CommonTime as stored in a snapshot (see CommonTime::getInternal())
+      struct TimeRecord {
+         Int32 day;           ///< Julian day
+         Int32 msod;          ///< milliseconds of day
+         double fsod;         ///< fractional seconds of day
+         Int32 system;        ///< TimeSystem::Systems
+         Int32 pad;           ///< keeps the size a multiple of 8
+      };
+
+      /// A SatID as stored in a snapshot
+      struct SatRecord {
+         Int32 id;            ///< satellite id, e.g. PRN
+         Int32 system;        ///< SatID::SatelliteSystem
+      };
+
+      /// A record of N doubles for one (satellite, time) entry of a data table
+      template <int N> struct SatTimeRecord {
+         TimeRecord time;     ///< time tag
+         SatRecord sat;       ///< satellite
+         double data[N];      ///< the values, in an order defined by the store
+      };
+
+      /// Convert CommonTime to TimeRecord
+      static TimeRecord packTime(const CommonTime& t) throw();
+
+      /// Convert TimeRecord to CommonTime
+      static CommonTime unpackTime(const TimeRecord& rec)
+         throw(InvalidParameter);
+
+      /// Convert SatID to SatRecord
+      static SatRecord packSat(const SatID& sat) throw()
+      {
+         SatRecord rec;
+         rec.id = sat.id;
+         rec.system = static_cast<Int32>(sat.system);
+         return rec;
+      }
+
+      /// Convert SatRecord to SatID
+      static SatID unpackSat(const SatRecord& rec) throw()
+         { return SatID(rec.id, static_cast<SatID::SatelliteSystem>(rec.system)); }
+
+      /// Build the part of a key that identifies a source file: its name, size
+      /// and modification time.
+      /// @param filename name of the source file
+      /// @throw FileMissingException if the file cannot be stat'ed
+      static std::string sourceKey(const std::string& filename)
+         throw(FileMissingException);
+
+      /// Build the name of the snapshot file, within the given directory, for the
+      /// given source file and store type. The name is derived from the source
+      /// file name only; the full key is checked when the snapshot is opened.
+      /// @param dir cache directory
+      /// @param filename name of the source file
+      /// @param type four-character store type, e.g. "SP3 "
+      static std::string cacheFileName(const std::string& dir,
+                                       const std::string& filename,
+                                       const std::string& type) throw();
+
+      /// Constructor
+      StoreCache() throw();
+
+      /// Destructor; closes (unmaps) an open snapshot
+      ~StoreCache() throw()
+         { close(); }
+
+      /// Add a section of nrec records of size recSize for writing.
+      /// @param tag four-character name of the section, e.g. "POS "
+      /// @param recSize size in bytes of each record
+      /// @param nrec number of records
+      /// @param data pointer to the records; must remain valid until write()
+      void addSection(const std::string& tag, size_t recSize, size_t nrec,
+                      const void *data) throw();
+
+      /// Add the contents of a vector of records as a section for writing.
+      template <class RecType>
+      void addSection(const std::string& tag, const std::vector<RecType>& recs)
+         throw()
+      {
+         addSection(tag, sizeof(RecType), recs.size(),
+                    recs.empty() ? 0 : &recs[0]);
+      }
+
+      /// Write the sections added by addSection() to a snapshot file. The file is
+      /// written under a temporary name and renamed when complete, so a reader
+      /// never sees a partial snapshot.
+      /// @param path name of the snapshot file
+      /// @param type four-character store type, e.g. "SP3 "
+      /// @param key key string, usually built with sourceKey()
+      /// @throw Exception if the file cannot be written
+      void write(const std::string& path, const std::string& type,
+                 const std::string& key) throw(Exception);
+
+      /// Open a snapshot file for reading, and check that it has the current
+      /// layout, byte order, store type and key.
+      /// @param path name of the snapshot file
+      /// @param type four-character store type, e.g. "SP3 "
+      /// @param key key string, usually built with sourceKey()
+      /// @return true if the file is usable, false otherwise (missing, stale or
+      ///    corrupt files are not an error, they are just not used).
+      bool open(const std::string& path, const std::string& type,
+                const std::string& key) throw();
+
+      /// Find a section in an open snapshot.
+      /// @param tag four-character name of the section
+      /// @param recSize expected record size; the section is rejected if different
+      /// @param data output pointer to the first record
+      /// @param nrec output number of records
+      /// @return true if the section was found with the expected record size
+      bool getSection(const std::string& tag, size_t recSize,
+                      const void *& data, size_t& nrec) const throw();
+
+      /// Find a section of records of type RecType in an open snapshot.
+      template <class RecType>
+      bool getSection(const std::string& tag, const RecType *& recs, size_t& nrec)
+         const throw()
+      {
+         const void *ptr(0);
+         if(!getSection(tag, sizeof(RecType), ptr, nrec)) return false;
+         recs = static_cast<const RecType *>(ptr);
+         return true;
+      }
+
+      /// Close the snapshot opened with open(), and forget sections added for
+      /// writing.
+      void close() throw();
+
+   private:
+
+      /// Fixed header at the start of every snapshot file
+      struct FileHeader {
+         char magic[8];          ///< "GPSTKSC" and a terminating zero
+         UInt32 version;         ///< layoutVersion
+         UInt32 byteOrder;       ///< 0x01020304, as written by the host
+         UInt32 storeType;       ///< four-character store type
+         UInt32 keyLength;       ///< length of the key string
+         UInt32 nsections;       ///< number of sections that follow the key
+         UInt32 reserved;        ///< zero
+      };
+
+      /// Header of each section
+      struct SectionHeader {
+         UInt32 tag;             ///< four-character section name
+         UInt32 recSize;         ///< size of each record in bytes
+         UInt64 nrec;            ///< number of records
+      };
+
+      /// A section waiting to be written
+      struct PendingSection {
+         UInt32 tag;
+         size_t recSize, nrec;
+         const void *data;
+      };
+
+      /// Pack a four-character string into a UInt32
+      static UInt32 fourCC(const std::string& str) throw();
+
+      /// Round n up to a multiple of 8
+      static size_t pad8(size_t n) throw()
+         { return (n + 7) & ~static_cast<size_t>(7); }
+
+      /// Sections added for writing
+      std::vector<PendingSection> pending;
+
+      /// Start of the open (mapped) snapshot, or 0
+      const char *base;
+
+      /// Size of the open snapshot in bytes
+      size_t length;
+
+      /// True if base was mapped with mmap, false if it was read into memory
+      bool mapped;
+
+      /// Not copyable, since it may own a mapping
+      StoreCache(const StoreCache&);
+      StoreCache& operator=(const StoreCache&);
+
+   }; // end class StoreCache
+
+   //@}
+
+}  // End of namespace gpstk
+
+#endif // GPSTK_STORE_CACHE_INCLUDE
@@ -8,6 +8,8 @@
 #define GPSTK_TABULAR_SAT_STORE_INCLUDE
 
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -77,6 +79,36 @@ namespace gpstk
 
       typedef typename DataTable::const_iterator DataTableIterator;
 
+      /// Comparison of (satellite,time) pairs given by index into two vectors,
+      /// used by sortBySatTime()
+      class SatTimeLess
+      {
+      public:
+         SatTimeLess(const std::vector<SatID>& s, const std::vector<CommonTime>& t)
+            : sats(s), ttags(t) {}
+         bool operator()(size_t i, size_t j) const
+         {
+            if(sats[i] != sats[j]) return (sats[i] < sats[j]);
+            return (ttags[i] < ttags[j]);
+         }
+      private:
+         const std::vector<SatID>& sats;
+         const std::vector<CommonTime>& ttags;
+      };
+
+      /// Fill index with 0,1,...,n-1 sorted on satellite, then time; records with
+      /// the same (sat,ttag) keep their order in the input. Used by the routines
+      /// in derived classes that add many records at once, so that each table is
+      /// built in one pass, in time order, instead of by a search per record.
+      static void sortBySatTime(const std::vector<SatID>& sats,
+                                const std::vector<CommonTime>& ttags,
+                                std::vector<size_t>& index) throw()
+      {
+         index.resize(sats.size());
+         for(size_t i=0; i<index.size(); i++) index[i] = i;
+         std::stable_sort(index.begin(), index.end(), SatTimeLess(sats,ttags));
+      }
+
    // member functions
    public:
 
@@ -287,11 +319,12 @@ namespace gpstk
                   // NB cannot access DataRecord without operator<<(DataRecord)
                   os << "   Data:" << std::endl;
                   typename DataTable::const_iterator jt;
-                  for(jt=it->second.begin(); jt!=it->second.end(); jt++)
+                  for(jt=it->second.begin(); jt!=it->second.end(); jt++) {
                      os << " " << printTime(jt->first,fmt)
                         << " " << it->first << " ";
                      os << jt->second // NB requires operator<<(DataRecord)
                         << std::endl;
+                  }
                }
             }
          }
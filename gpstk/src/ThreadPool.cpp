@@ -0,0 +1,138 @@
+#pragma ident "$Id$"
+
+/// @file ThreadPool.cpp
+/// A fixed set of worker threads that run queued tasks.
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+namespace gpstk
+{
+   // Number of processors on this host; 1 if it cannot be determined.
+   unsigned int ThreadPool::processorCount() throw()
+   {
+#if !defined(_WIN32) && defined(_SC_NPROCESSORS_ONLN)
+      long n(::sysconf(_SC_NPROCESSORS_ONLN));
+      if(n > 0) return static_cast<unsigned int>(n);
+#endif
+      return 1;
+   }
+
+   // Constructor; starts the worker threads.
+   ThreadPool::ThreadPool(unsigned int nthreads) throw(Exception)
+      : nworkers(0), outstanding(0), stopping(false)
+   {
+#ifndef _WIN32
+      if(nthreads == 0) nthreads = processorCount();
+
+      ::pthread_mutex_init(&lock, 0);
+      ::pthread_cond_init(&workReady, 0);
+      ::pthread_cond_init(&allDone, 0);
+
+      threads.resize(nthreads);
+      for(unsigned int i=0; i<nthreads; i++) {
+         if(::pthread_create(&threads[nworkers], 0, workerMain, this) != 0)
+            break;
+         nworkers++;
+      }
+      threads.resize(nworkers);
+
+      if(nworkers == 0) {
+         ::pthread_cond_destroy(&allDone);
+         ::pthread_cond_destroy(&workReady);
+         ::pthread_mutex_destroy(&lock);
+         Exception e("ThreadPool could not start any worker thread");
+         GPSTK_THROW(e);
+      }
+#endif
+   }
+
+   // Destructor; waits for all tasks to finish, then stops the workers.
+   ThreadPool::~ThreadPool() throw()
+   {
+#ifndef _WIN32
+      wait();
+
+      ::pthread_mutex_lock(&lock);
+      stopping = true;
+      ::pthread_cond_broadcast(&workReady);
+      ::pthread_mutex_unlock(&lock);
+
+      for(unsigned int i=0; i<nworkers; i++)
+         ::pthread_join(threads[i], 0);
+
+      ::pthread_cond_destroy(&allDone);
+      ::pthread_cond_destroy(&workReady);
+      ::pthread_mutex_destroy(&lock);
+#endif
+   }
+
+   // Queue a task to be run by one of the workers.
+   void ThreadPool::submit(Task *task) throw()
+   {
+      if(!task) return;
+
+#ifndef _WIN32
+      if(nworkers > 0) {
+         ::pthread_mutex_lock(&lock);
+         queue.push_back(task);
+         outstanding++;
+         ::pthread_cond_signal(&workReady);
+         ::pthread_mutex_unlock(&lock);
+         return;
+      }
+#endif
+
+      try { task->run(); }
+      catch(...) { ; }
+   }
+
+   // Block until every task submitted so far has finished.
+   void ThreadPool::wait() throw()
+   {
+#ifndef _WIN32
+      ::pthread_mutex_lock(&lock);
+      while(outstanding > 0)
+         ::pthread_cond_wait(&allDone, &lock);
+      ::pthread_mutex_unlock(&lock);
+#endif
+   }
+
+   // Entry point of the worker threads
+   void *ThreadPool::workerMain(void *arg)
+   {
+      static_cast<ThreadPool *>(arg)->work();
+      return 0;
+   }
+
+   // Loop run by each worker: take tasks from the queue until stopped
+   void ThreadPool::work() throw()
+   {
+#ifndef _WIN32
+      ::pthread_mutex_lock(&lock);
+      while(1) {
+         while(queue.empty() && !stopping)
+            ::pthread_cond_wait(&workReady, &lock);
+         if(queue.empty()) break;            // stopping, and nothing left to do
+
+         Task *task(queue.front());
+         queue.pop_front();
+         ::pthread_mutex_unlock(&lock);
+
+         try { task->run(); }
+         catch(...) { ; }
+
+         ::pthread_mutex_lock(&lock);
+         if(--outstanding == 0)
+            ::pthread_cond_broadcast(&allDone);
+      }
+      ::pthread_mutex_unlock(&lock);
+#endif
+   }
+
+}  // End of namespace gpstk
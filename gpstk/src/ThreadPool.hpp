@@ -0,0 +1,116 @@
+#pragma ident "$Id$"
+
+/// @file ThreadPool.hpp
+/// A fixed set of worker threads that run queued tasks, used where independent
+/// pieces of work (e.g. reading several input files) can be done concurrently.
+
+#ifndef GPSTK_THREAD_POOL_INCLUDE
+#define GPSTK_THREAD_POOL_INCLUDE
+
+#include <deque>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "Exception.hpp"
+
+namespace gpstk
+{
+   /** @addtogroup General */
+   //@{
+
+   /// A pool of worker threads (POSIX threads) that run Task objects.
+   ///
+   /// Tasks are submitted with submit() and run in an unspecified order on any of
+   /// the workers; wait() blocks until every submitted task has finished. The pool
+   /// does not own the tasks; they must stay valid until wait() returns.
+   /// A task must not let an exception escape from run(); any exception the work
+   /// may throw should be caught and saved in the task, and examined by the caller
+   /// after wait(). (An escaping exception is caught and discarded by the worker.)
+   ///
+   /// Where threads are not available (_WIN32), or the pool has no workers, tasks
+   /// are run by the calling thread inside submit().
+   class ThreadPool
+   {
+   public:
+
+      /// Base class of the work items run by the pool.
+      class Task
+      {
+      public:
+         /// Destructor
+         virtual ~Task() {}
+
+         /// Do the work; called exactly once, on one of the worker threads.
+         virtual void run() throw() = 0;
+      };
+
+      /// Number of processors on this host; 1 if it cannot be determined.
+      static unsigned int processorCount() throw();
+
+      /// Constructor; starts the worker threads.
+      /// @param nthreads number of workers; 0 means processorCount().
+      /// @throw Exception if no worker can be started.
+      ThreadPool(unsigned int nthreads = 0) throw(Exception);
+
+      /// Destructor; waits for all tasks to finish, then stops the workers.
+      ~ThreadPool() throw();
+
+      /// Number of worker threads
+      unsigned int size() const throw()
+         { return nworkers; }
+
+      /// Queue a task to be run by one of the workers.
+      /// @param task the task; not owned by the pool
+      void submit(Task *task) throw();
+
+      /// Block until every task submitted so far has finished.
+      void wait() throw();
+
+   private:
+
+      /// Entry point of the worker threads
+      static void *workerMain(void *arg);
+
+      /// Loop run by each worker: take tasks from the queue until stopped
+      void work() throw();
+
+      /// Number of worker threads
+      unsigned int nworkers;
+
+#ifndef _WIN32
+      /// Worker threads
+      std::vector<pthread_t> threads;
+
+      /// Protects the queue and the counters below
+      pthread_mutex_t lock;
+
+      /// Signaled when a task is queued, or the pool is stopping
+      pthread_cond_t workReady;
+
+      /// Signaled when the last outstanding task has finished
+      pthread_cond_t allDone;
+#endif
+
+      /// Tasks not yet started
+      std::deque<Task *> queue;
+
+      /// Number of tasks submitted and not yet finished
+      unsigned int outstanding;
+
+      /// Set by the destructor to stop the workers
+      bool stopping;
+
+      /// Not copyable
+      ThreadPool(const ThreadPool&);
+      ThreadPool& operator=(const ThreadPool&);
+
+   }; // end class ThreadPool
+
+   //@}
+
+}  // End of namespace gpstk
+
+#endif // GPSTK_THREAD_POOL_INCLUDE
@@ -183,6 +183,14 @@ namespace gpstk
              */
          uint32_t operator[]( long i );
 
+            /** The 64 bits starting with bit i: operator[](i) in the high
+             *  half and the 32 bits after them, wrapped back by MAX_X2_TEST
+             *  past the end of the sequence as SVPCodeGen does, in the low
+             *  half.  Away from the end of the sequence, the bits are taken
+             *  from three consecutive words at once.
+             */
+         uint64_t get64( long i );
+
             /**  Controls whether the X2 Epoch is set to EOW condition
              *   or normal condition.  Should only be set true for the final
              *   X2 epoch of the week.
@@ -290,6 +298,28 @@ namespace gpstk
       }
       return(retArg);
    }
+
+   inline uint64_t X2Sequence::get64( long i )
+   {
+      long adjustedCount = i + X2A_EPOCH_DELAY;
+
+      if ( (adjustedCount + 2*MAX_BIT) <= MAX_X2_COUNT )
+      {
+         long ndx = adjustedCount / MAX_BIT;
+         int offset = adjustedCount - (ndx * MAX_BIT);
+         uint64_t retArg = (uint64_t(bitsP[ndx]) << MAX_BIT) | bitsP[ndx+1];
+         if (offset!=0)
+         {
+            retArg <<= offset;
+            retArg |= bitsP[ndx+2] >> (MAX_BIT - offset);
+         }
+         return(retArg);
+      }
+
+      long next = i + MAX_BIT;
+      if (next>=MAX_X2_TEST) next -= MAX_X2_TEST;
+      return( (uint64_t((*this)[i]) << MAX_BIT) | (*this)[next] );
+   }
    //@}
 }  // end of namespace
 
@@ -0,0 +1,252 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file lambda_bench.cpp
+ *
+ * Times the full and the partial ambiguity resolutions of gpstk::ARLambda
+ * on synthetic, highly correlated float ambiguities (Q = s^2 I + H P H',
+ * as for a short baseline after a few epochs) of growing dimension, and
+ * reports how often the full resolution gives the true integers, and how
+ * many ambiguities the partial one fixes. The checks of the search and of
+ * the partial resolution are in the xARLambda test.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+
+#include "StringUtils.hpp"
+#include "Matrix.hpp"
+#include "MatrixFunctors.hpp"
+#include "ARLambda.hpp"
+#include "BasicFramework.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+class LambdaBench : public BasicFramework
+{
+public:
+
+   LambdaBench(char* arg0);
+
+   virtual ~LambdaBench() {};
+
+   virtual bool initialize(int argc, char *argv[]) throw();
+
+      /// Number of resolutions that failed
+   unsigned long failures() const
+      { return nfail; }
+
+protected:
+
+   virtual void process();
+
+      /// Timings of the full and partial resolutions
+   void timeSynthetic();
+
+      /// Normal random number
+   static double gaussian();
+
+      /// Covariance s^2 I + H P H' of n ambiguities
+   static Matrix<double> syntheticCov(int n, double sigma, double sigmaPos);
+
+      /// Float ambiguities around the integers 'fixed', with covariance Q
+   static Vector<double> floatAmb(const Matrix<double>& Q,
+                                  const Vector<double>& fixed);
+
+      /// Largest dimension of the timings
+   CommandOptionWithNumberArg dimOpt;
+
+      /// Number of problems of each dimension
+   CommandOptionWithNumberArg countOpt;
+
+   unsigned long nfail;
+
+}; // class LambdaBench
+
+
+//---------------------------------------------------------------------------
+LambdaBench::LambdaBench(char* arg0)
+   : BasicFramework(arg0, "Times the full and the partial resolutions of "
+                    "ARLambda"),
+     dimOpt('n', "dimension", "Largest number of ambiguities (default 160)"),
+     countOpt('c', "count", "Number of problems of each dimension "
+              "(default 20)"),
+     nfail(0)
+{
+}
+
+
+//---------------------------------------------------------------------------
+bool LambdaBench::initialize(int argc, char *argv[]) throw()
+{
+   if(!BasicFramework::initialize(argc, argv)) return false;
+
+   ::srand48(12345);
+
+   return true;
+}
+
+
+//---------------------------------------------------------------------------
+double LambdaBench::gaussian()
+{
+   double u1(::drand48()), u2(::drand48());
+   if(u1 < 1e-300) u1 = 1e-300;
+   return ::sqrt(-2.0 * ::log(u1)) * ::cos(2.0 * M_PI * u2);
+}
+
+
+//---------------------------------------------------------------------------
+Matrix<double> LambdaBench::syntheticCov(int n, double sigma, double sigmaPos)
+{
+      // geometry of a baseline in cycles (L1)
+   const double lambda(0.19029367);
+   Matrix<double> H(n, 3, 0.0);
+   for(int i=0; i<n; i++)
+   {
+      double el(0.1 + 1.4 * ::drand48()), az(2.0 * M_PI * ::drand48());
+      H(i,0) = ::cos(el) * ::sin(az) / lambda;
+      H(i,1) = ::cos(el) * ::cos(az) / lambda;
+      H(i,2) = ::sin(el) / lambda;
+   }
+
+   Matrix<double> Q(n, n, 0.0);
+   for(int i=0; i<n; i++)
+   {
+      for(int j=0; j<=i; j++)
+      {
+         double q(0.0);
+         for(int k=0; k<3; k++) q += H(i,k) * H(j,k) * sigmaPos * sigmaPos;
+         if(i == j) q += sigma * sigma;
+         Q(i,j) = Q(j,i) = q;
+      }
+   }
+
+   return Q;
+}
+
+
+//---------------------------------------------------------------------------
+Vector<double> LambdaBench::floatAmb(const Matrix<double>& Q,
+                                     const Vector<double>& fixed)
+{
+   const int n(fixed.size());
+   Cholesky<double> ch;
+   ch(Q);
+
+   Vector<double> w(n), a(fixed);
+   for(int i=0; i<n; i++) w(i) = gaussian();
+   for(int i=0; i<n; i++)
+   {
+      for(int j=0; j<=i; j++) a(i) += ch.L(i,j) * w(j);
+   }
+
+   return a;
+}
+
+
+//---------------------------------------------------------------------------
+void LambdaBench::timeSynthetic()
+{
+   int maxDim(dimOpt.getCount() ? asInt(dimOpt.getValue()[0]) : 160);
+   int count(countOpt.getCount() ? asInt(countOpt.getValue()[0]) : 20);
+
+   cout << "   n   full (ms)  correct  partial (ms)  fixed  success rate"
+        << endl;
+
+   for(int n=10; n<=maxDim; n*=2)
+   {
+      double tfull(0.0), tpart(0.0), rate(0.0);
+      long nfix(0), ncorrect(0), ntotal(0), nprob(0);
+
+      for(int p=0; p<count; p++)
+      {
+         Matrix<double> Q(syntheticCov(n, 0.05, 0.3));
+         Vector<double> fixed(n);
+         for(int i=0; i<n; i++) fixed(i) = double(::lrand48() % 2001 - 1000);
+         Vector<double> a(floatAmb(Q, fixed));
+
+         ARLambda ar;
+         Vector<double> full, part;
+
+         clock_t start(::clock());
+         try
+         {
+            full = ar.resolveIntegerAmbiguity(a, Q);
+         }
+         catch(Exception& e)
+         {
+            nfail++;
+            cout << " FAIL - full resolution, n = " << n << ": "
+                 << e.getText() << endl;
+            continue;
+         }
+         tfull += double(::clock() - start) / CLOCKS_PER_SEC;
+
+         nprob++;
+         bool correct(true);
+         for(int i=0; correct && i<n; i++) correct = (full(i) == fixed(i));
+         if(correct) ncorrect++;
+
+         start = ::clock();
+         part = ar.resolvePartialAmbiguity(a, Q, 0.999);
+         tpart += double(::clock() - start) / CLOCKS_PER_SEC;
+
+         nfix += ar.numFixed;
+         rate += ar.successRate;
+         ntotal += n;
+      }
+
+      cout << rightJustify(asString(n), 4)
+           << rightJustify(asString(1000.0*tfull/nprob, 3), 12)
+           << rightJustify(asString(100.0*ncorrect/nprob, 1), 8) << "%"
+           << rightJustify(asString(1000.0*tpart/nprob, 3), 14)
+           << rightJustify(asString(100.0*nfix/ntotal, 1), 6) << "%"
+           << rightJustify(asString(rate/nprob, 4), 14) << endl;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+void LambdaBench::process()
+{
+   timeSynthetic();
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   LambdaBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return (app.failures() > 0 ? 1 : 0);
+}
@@ -0,0 +1,272 @@
+// file: xARLambda.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#include "xARLambda.hpp"
+
+#include <cmath>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xARLambda);
+
+using namespace gpstk;
+
+	// ARLambda, with access to the two best candidates of lambda()
+class LambdaCheck : public ARLambda
+{
+public:
+	int best (const Vector<double>& a, const Matrix<double>& Q,
+		Matrix<double>& F, Vector<double>& s)
+	{ return lambda(a, Q, F, s, 2); }
+};
+
+
+void xARLambda :: setUp (void)
+{
+	seed = 12345;
+}
+
+	// Uniform in [-1,1), from a linear congruential generator
+double xARLambda :: random (void)
+{
+	seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+	return double(seed) / 1073741824.0 - 1.0;
+}
+
+	// Normal, by Box-Muller
+double xARLambda :: gaussian (void)
+{
+	double u1 = 0.5 * (random() + 1.0), u2 = 0.5 * (random() + 1.0);
+	if (u1 < 1e-300) u1 = 1e-300;
+	return ::sqrt(-2.0 * ::log(u1)) * ::cos(2.0 * M_PI * u2);
+}
+
+	// Covariance s^2 I + H P H' of n L1 ambiguities of a short baseline
+Matrix<double> xARLambda :: syntheticCov (int n, double sigma, double sigmaPos)
+{
+	const double lambda = 0.19029367;
+	Matrix<double> H(n, 3, 0.0);
+	for (int i = 0; i < n; i++)
+	{
+		double el = 0.85 + 0.7 * random(), az = M_PI * random();
+		H(i,0) = ::cos(el) * ::sin(az) / lambda;
+		H(i,1) = ::cos(el) * ::cos(az) / lambda;
+		H(i,2) = ::sin(el) / lambda;
+	}
+
+	Matrix<double> Q(n, n, 0.0);
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j <= i; j++)
+		{
+			double q = 0.0;
+			for (int k = 0; k < 3; k++)
+				q += H(i,k) * H(j,k) * sigmaPos * sigmaPos;
+			if (i == j)
+				q += sigma * sigma;
+			Q(i,j) = Q(j,i) = q;
+		}
+
+	return Q;
+}
+
+	// Float ambiguities around the integers 'fixed', with covariance Q
+Vector<double> xARLambda :: floatAmb (const Matrix<double>& Q,
+	const Vector<double>& fixed)
+{
+	const int n = fixed.size();
+	Cholesky<double> ch;
+	ch(Q);
+
+	Vector<double> w(n), a(fixed);
+	for (int i = 0; i < n; i++)
+		w(i) = gaussian();
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j <= i; j++)
+			a(i) += ch.L(i,j) * w(j);
+
+	return a;
+}
+
+/*
+**** The two best candidates of lambda() against an exhaustive search of a
+**** box around the best one, for small correlated problems
+*/
+void xARLambda :: exhaustiveSearchTest (void)
+{
+	for (int p = 0; p < 100; p++)
+	{
+		const int n = 2 + p % 4;
+
+		Matrix<double> A(n, n), Q(n, n, 0.0);
+		for (int i = 0; i < n; i++)
+			for (int j = 0; j < n; j++)
+				A(i,j) = 0.4 * gaussian();
+		for (int i = 0; i < n; i++)
+		{
+			for (int j = 0; j < n; j++)
+				for (int k = 0; k < n; k++)
+					Q(i,j) += A(i,k) * A(j,k);
+			Q(i,i) += 0.01;
+		}
+		Matrix<double> W(inverse(Q));
+
+		Vector<double> a(n);
+		for (int i = 0; i < n; i++)
+			a(i) = 10.0 * random();
+
+		LambdaCheck ar;
+		Matrix<double> F;
+		Vector<double> s;
+		CPPUNIT_ASSERT_EQUAL(0, ar.best(a, Q, F, s));
+		CPPUNIT_ASSERT(s(0) <= s(1));
+
+		const int half = 4, width = 2*half + 1;
+		int total = 1;
+		for (int i = 0; i < n; i++)
+			total *= width;
+
+		double best = 1e99, second = 1e99;
+		Vector<double> z(n), d(n);
+		for (int c = 0; c < total; c++)
+		{
+			int r = c;
+			for (int i = 0; i < n; i++)
+			{
+				z(i) = F(i,0) + (r % width) - half;
+				r /= width;
+				d(i) = a(i) - z(i);
+			}
+			double q = 0.0;
+			for (int i = 0; i < n; i++)
+				for (int j = 0; j < n; j++)
+					q += d(i) * W(i,j) * d(j);
+			if (q < best)
+			{
+				second = best;
+				best = q;
+			}
+			else if (q < second)
+				second = q;
+		}
+
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(best, s(0), 1e-8 * (1.0 + best));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(second, s(1), 1e-8 * (1.0 + second));
+
+			// the full resolution returns the best candidate
+		Vector<double> fixed = ar.resolveIntegerAmbiguity(a, Q);
+		for (int i = 0; i < n; i++)
+			CPPUNIT_ASSERT_EQUAL(F(i,0), fixed(i));
+		CPPUNIT_ASSERT_EQUAL(n, ar.numFixed);
+	}
+}
+
+/*
+**** Reaching searchLoopLimit throws, instead of returning a truncated search
+*/
+void xARLambda :: loopLimitTest (void)
+{
+	const int n = 20;
+	Matrix<double> Q(syntheticCov(n, 0.05, 0.3));
+	Vector<double> fixed(n);
+	for (int i = 0; i < n; i++)
+		fixed(i) = double(int(1000.0 * random()));
+	Vector<double> a(floatAmb(Q, fixed));
+
+	ARLambda ar;
+	Vector<double> full = ar.resolveIntegerAmbiguity(a, Q);
+	CPPUNIT_ASSERT_EQUAL(n, int(full.size()));
+
+	ar.searchLoopLimit = 3;
+	CPPUNIT_ASSERT_THROW(ar.resolveIntegerAmbiguity(a, Q), ARException);
+	CPPUNIT_ASSERT_THROW(ar.resolvePartialAmbiguity(a, Q, 1e-6), ARException);
+}
+
+/*
+**** The partial resolution fixes a subset with the required success rate;
+**** fixing all of them is the full resolution
+*/
+void xARLambda :: partialResolutionTest (void)
+{
+	int nsome = 0;
+	for (int p = 0; p < 20; p++)
+	{
+		const int n = 10 + p;
+		Matrix<double> Q(syntheticCov(n, 0.05, 0.3));
+		Vector<double> fixed(n);
+		for (int i = 0; i < n; i++)
+			fixed(i) = double(int(1000.0 * random()));
+		Vector<double> a(floatAmb(Q, fixed));
+
+		ARLambda ar;
+		Vector<double> full = ar.resolveIntegerAmbiguity(a, Q);
+
+		Vector<double> part = ar.resolvePartialAmbiguity(a, Q, 0.999);
+		CPPUNIT_ASSERT_EQUAL(n, int(part.size()));
+		CPPUNIT_ASSERT(ar.numFixed >= 0 && ar.numFixed <= n);
+		if (ar.numFixed > 0)
+		{
+			CPPUNIT_ASSERT(ar.successRate >= 0.999);
+			CPPUNIT_ASSERT(ar.successRate <= 1.0);
+		}
+		else
+			for (int i = 0; i < n; i++)
+				CPPUNIT_ASSERT_EQUAL(a(i), part(i));
+		if (ar.numFixed > 0 && ar.numFixed < n)
+			nsome++;
+
+			// the subset only grows as the required rate goes down
+		int numFixed = ar.numFixed;
+		ar.resolvePartialAmbiguity(a, Q, 0.9);
+		CPPUNIT_ASSERT(ar.numFixed >= numFixed);
+
+		Vector<double> all = ar.resolvePartialAmbiguity(a, Q, 1e-300);
+		CPPUNIT_ASSERT_EQUAL(n, ar.numFixed);
+		for (int i = 0; i < n; i++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(full(i), all(i), 1e-6);
+	}
+		// a short baseline with a few epochs: some of them, not all
+	CPPUNIT_ASSERT(nsome > 0);
+}
+
+/*
+**** Mismatched dimensions and success rates outside (0,1] throw
+*/
+void xARLambda :: invalidInputTest (void)
+{
+	const int n = 5;
+	Matrix<double> Q(syntheticCov(n, 0.05, 0.3));
+	Vector<double> a(n, 0.3), b(n+1, 0.3);
+
+	ARLambda ar;
+	CPPUNIT_ASSERT_THROW(ar.resolveIntegerAmbiguity(b, Q), ARException);
+	CPPUNIT_ASSERT_THROW(ar.resolvePartialAmbiguity(b, Q), ARException);
+
+	CPPUNIT_ASSERT_THROW(ar.resolvePartialAmbiguity(a, Q, 0.0), ARException);
+	CPPUNIT_ASSERT_THROW(ar.resolvePartialAmbiguity(a, Q, -0.5), ARException);
+	CPPUNIT_ASSERT_THROW(ar.resolvePartialAmbiguity(a, Q, 1.5), ARException);
+	CPPUNIT_ASSERT_THROW(ar.resolvePartialAmbiguity(a, Q, ::sqrt(-1.0)), ARException);
+
+	ar.resolvePartialAmbiguity(a, Q, 1.0);
+	CPPUNIT_ASSERT(ar.numFixed >= 0 && ar.numFixed <= n);
+}
@@ -0,0 +1,68 @@
+// file: xARLambda.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#ifndef XARLAMBDA_HPP
+#define XARLAMBDA_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ARLambda.hpp"
+
+
+using namespace std;
+
+
+class xARLambda: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xARLambda);
+	CPPUNIT_TEST (exhaustiveSearchTest);
+	CPPUNIT_TEST (loopLimitTest);
+	CPPUNIT_TEST (partialResolutionTest);
+	CPPUNIT_TEST (invalidInputTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Sets up test enviornment
+
+	protected:
+		void exhaustiveSearchTest (void);
+		void loopLimitTest (void);
+		void partialResolutionTest (void);
+		void invalidInputTest (void);
+
+	private:
+		unsigned long seed;
+		double random (void);
+		double gaussian (void);
+		gpstk::Matrix<double> syntheticCov (int n, double sigma, double sigmaPos);
+		gpstk::Vector<double> floatAmb (const gpstk::Matrix<double>& Q,
+			const gpstk::Vector<double>& fixed);
+
+};
+
+#endif
@@ -25,6 +25,7 @@
 
 #include "xBinUtils.hpp"
 #include <iostream>
+#include <stdexcept>
 
 CPPUNIT_TEST_SUITE_REGISTRATION (xBinUtils);
 
@@ -168,3 +169,42 @@ void xBinUtils :: firstTest (void)
 	CPPUNIT_ASSERT_DOUBLES_EQUAL(g1,g,1e-50);
 	
 }
+
+void xBinUtils :: viewTest (void)
+{
+	// The fields of a record, in network byte order, at odd offsets
+	const unsigned char rec[] = {0x7f,
+	                             0x01,0x02,
+	                             0x01,0x02,0x03,0x04,
+	                             0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,
+	                             0x40,0x09,0x21,0xfb,0x54,0x44,0x2d,0x18};
+	gpstk::BinUtils::RecordView view((const char*)rec, sizeof(rec));
+
+	CPPUNIT_ASSERT_EQUAL((uint8_t)0x7f, view.net<uint8_t>(0));
+	CPPUNIT_ASSERT_EQUAL((uint16_t)0x0102, view.net<uint16_t>(1));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x01020304, view.net<uint32_t>(3));
+	CPPUNIT_ASSERT_EQUAL((uint64_t)0x0102030405060708ULL, view.net<uint64_t>(7));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(3.141592653589793, view.net<double>(15), 1e-15);
+
+	CPPUNIT_ASSERT_EQUAL((uint16_t)0x0201, view.intel<uint16_t>(1));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x04030201, view.intel<uint32_t>(3));
+	CPPUNIT_ASSERT_EQUAL((uint64_t)0x0807060504030201ULL, view.intel<uint64_t>(7));
+
+	// decodeVar() takes the same fields off the front of a string
+	string str((const char*)rec, sizeof(rec));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x01020304, gpstk::BinUtils::decodeVar<uint32_t>(str, 3));
+	CPPUNIT_ASSERT_EQUAL((uint8_t)0x7f, gpstk::BinUtils::decodeVar<uint8_t>(str));
+	CPPUNIT_ASSERT_EQUAL((uint16_t)0x0102, gpstk::BinUtils::decodeVar<uint16_t>(str));
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x01020304, gpstk::BinUtils::decodeVar<uint32_t>(str));
+	CPPUNIT_ASSERT_EQUAL((size_t)16, str.size());
+
+	// A string too short for the field is not read past its end; the
+	// bytes that are missing read as zero
+	string shortStr((const char*)rec + 3, 3);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x01020300, gpstk::BinUtils::decodeVar<uint32_t>(shortStr, 0));
+	CPPUNIT_ASSERT_EQUAL((uint16_t)0x0300, gpstk::BinUtils::decodeVar<uint16_t>(shortStr, 2));
+	CPPUNIT_ASSERT_EQUAL((uint16_t)0x0000, gpstk::BinUtils::decodeVar<uint16_t>(shortStr, 3));
+	CPPUNIT_ASSERT_THROW(gpstk::BinUtils::decodeVar<uint16_t>(shortStr, 4), std::out_of_range);
+	CPPUNIT_ASSERT_EQUAL((uint32_t)0x01020300, gpstk::BinUtils::decodeVar<uint32_t>(shortStr));
+	CPPUNIT_ASSERT(shortStr.empty());
+}
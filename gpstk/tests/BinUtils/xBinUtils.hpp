@@ -38,6 +38,7 @@ class xBinUtils: public CPPUNIT_NS :: TestFixture
 	//Test Fixture information, e.g. what tests will be run
 	CPPUNIT_TEST_SUITE (xBinUtils);
 	CPPUNIT_TEST (firstTest);
+	CPPUNIT_TEST (viewTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 	public:
@@ -46,6 +47,7 @@ class xBinUtils: public CPPUNIT_NS :: TestFixture
 	protected:
 		
 		void firstTest (void); // Test constructors
+		void viewTest (void); // Test decodeNet, decodeIntel and RecordView
 		
 	private:
 };		
@@ -0,0 +1,265 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file binex_batch_bench.cpp
+ *
+ * Writes a file of BINEX records of all sizes and flags with putRecord()
+ * and with BinexBatchWriter, then reads it back with getRecord() and with
+ * BinexBatchReader, and reports records and megabytes per second for one
+ * thread and for several. The records themselves are checked by the
+ * xBinexBatch fixture.
+ *
+ * g++ -O -I../../src binex_batch_bench.cpp ../../src/libgpstk.a -lpthread
+ */
+
+#include <cstdio>
+#include <sys/time.h>
+
+#include "StringUtils.hpp"
+#include "BasicFramework.hpp"
+#include "BinexData.hpp"
+#include "BinexStream.hpp"
+#include "BinexBatchReader.hpp"
+#include "BinexBatchWriter.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+class BinexBatchBench : public BasicFramework
+{
+public:
+
+   BinexBatchBench(char* arg0);
+
+   virtual ~BinexBatchBench() {};
+
+protected:
+
+   typedef vector<BinexData> RecordList;
+
+   virtual void process();
+
+      /// Makes up 'n' records with the flags given, of every size
+   void makeRecords(RecordList& recs, size_t n,
+                    const vector<unsigned char>& flags);
+
+      /// Writes 'recs' to 'fn', with putRecord() if threads is 0
+   double writeFile(const string& fn, const RecordList& recs,
+                    unsigned threads);
+
+      /// Reads 'fn' into 'recs', with getRecord() if threads is 0
+   double readFile(const string& fn, RecordList& recs, unsigned threads);
+
+      /// Writes one line of the table of rates
+   void report(const string& what, double t, size_t n, const string& fn);
+
+      /// File written and read
+   CommandOptionWithAnyArg fileOpt;
+
+      /// Records written
+   CommandOptionWithNumberArg recordsOpt;
+
+      /// Threads of the parallel runs
+   CommandOptionWithNumberArg threadsOpt;
+
+   string fileName;
+
+   unsigned long records;
+
+}; // class BinexBatchBench
+
+
+//---------------------------------------------------------------------------
+BinexBatchBench::BinexBatchBench(char* arg0)
+   : BasicFramework(arg0, "Times the batched BINEX reader and writer "
+                    "against getRecord() and putRecord()"),
+     fileOpt('f', "file", "File to write and read (default "
+             "binex_batch_bench.bnx, removed at the end)"),
+     recordsOpt('n', "records", "Records written (default 200000)"),
+     threadsOpt('t', "threads", "Threads of the parallel runs (default "
+                "one per processor, at least 2)"),
+     fileName("binex_batch_bench.bnx"), records(200000)
+{
+}
+
+
+//---------------------------------------------------------------------------
+static double wallClock()
+{
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1.e-6;
+}
+
+
+//---------------------------------------------------------------------------
+void BinexBatchBench::makeRecords(RecordList& recs, size_t n,
+                                  const vector<unsigned char>& flags)
+{
+   srand(2009);
+   recs.clear();
+   recs.reserve(n);
+   for(size_t i = 0; i < n; i++)
+   {
+      BinexData rec(i % 3 ? i % 128 : 0x7f00 + i % 300000,
+                    flags[i % flags.size()]);
+
+         // Mostly short, with some long enough for each CRC
+      size_t len = rand() % 200 + 1;
+      if(i % 10 == 0)
+         len = rand() % 3000 + 100;
+      if(i % 1000 == 999)
+         len = rand() % 20000 + 4000;
+
+      string data(len, '\0');
+      for(size_t j = 0; j < len; j++)
+         data[j] = (char)(rand() % 0x100);
+      size_t offset = 0;
+      rec.updateMessageData(offset, data, len);
+      recs.push_back(rec);
+   }
+}
+
+
+//---------------------------------------------------------------------------
+double BinexBatchBench::writeFile(const string& fn, const RecordList& recs,
+                                  unsigned threads)
+{
+   BinexStream out(fn.c_str(), ios::out | ios::binary | ios::trunc);
+   double start(wallClock());
+   if(threads == 0)
+   {
+      for(size_t i = 0; i < recs.size(); i++)
+         recs[i].putRecord(out);
+   }
+   else
+   {
+         // As a program writing as it goes would, a batch at a time
+      BinexBatchWriter writer(out, threads);
+      const size_t batch = 4096;
+      for(size_t i = 0; i < recs.size(); i += batch)
+         writer.write(&recs[i], std::min(batch, recs.size() - i));
+   }
+   out.close();
+   return wallClock() - start;
+}
+
+
+//---------------------------------------------------------------------------
+double BinexBatchBench::readFile(const string& fn, RecordList& recs,
+                                 unsigned threads)
+{
+   recs.clear();
+   BinexStream in(fn.c_str(), ios::in | ios::binary);
+
+   double start(wallClock());
+   if(threads == 0)
+   {
+      BinexData rec;
+      while(in >> rec)
+         recs.push_back(rec);
+   }
+   else
+   {
+      BinexBatchReader reader(in, threads);
+      RecordList batch;
+      size_t n;
+      while((n = reader.read(batch)) > 0)
+         recs.insert(recs.end(), batch.begin(), batch.begin() + n);
+   }
+   return wallClock() - start;
+}
+
+
+//---------------------------------------------------------------------------
+void BinexBatchBench::report(const string& what, double t, size_t n,
+                             const string& fn)
+{
+   FILE* fp = fopen(fn.c_str(), "rb");
+   fseek(fp, 0, SEEK_END);
+   double size = ftell(fp);
+   fclose(fp);
+
+   cout << leftJustify(what, 24)
+        << rightJustify(asString(n / t, 0), 12)
+        << rightJustify(asString(size / t / 1e6, 1), 10) << endl;
+}
+
+
+//---------------------------------------------------------------------------
+void BinexBatchBench::process()
+{
+   if(fileOpt.getCount())
+      fileName = fileOpt.getValue()[0];
+   if(recordsOpt.getCount())
+      records = asUnsigned(recordsOpt.getValue()[0]);
+   unsigned threads(threadsOpt.getCount() ?
+                    asInt(threadsOpt.getValue()[0]) :
+                    std::max(2U, ThreadPool::processorCount()));
+
+      // Every combination that getRecord() reads from the head
+   vector<unsigned char> flags;
+   flags.push_back(0);
+   flags.push_back(BinexData::eEnhancedCRC);
+   flags.push_back(BinexData::eBigEndian);
+   flags.push_back(BinexData::eBigEndian | BinexData::eEnhancedCRC);
+   RecordList recs, got;
+   makeRecords(recs, records, flags);
+
+   const string serialName(fileName + ".put");
+   cout << records << " records" << endl
+        << "                             rec/s      MB/s" << endl;
+
+   report("putRecord()", writeFile(serialName, recs, 0),
+          records, serialName);
+   report("batch write, 1 thread", writeFile(fileName, recs, 1),
+          records, fileName);
+   report("batch write, " + asString(threads) + " threads",
+          writeFile(fileName, recs, threads), records, fileName);
+   remove(serialName.c_str());
+
+   report("getRecord()", readFile(fileName, got, 0), records, fileName);
+   report("batch read, 1 thread", readFile(fileName, got, 1),
+          records, fileName);
+   report("batch read, " + asString(threads) + " threads",
+          readFile(fileName, got, threads), records, fileName);
+
+   if(!fileOpt.getCount())
+      remove(fileName.c_str());
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   BinexBatchBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return 0;
+}
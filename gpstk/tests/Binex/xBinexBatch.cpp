@@ -0,0 +1,366 @@
+// file: xBinexBatch.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#include "xBinexBatch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "BinexStream.hpp"
+#include "BinexBatchReader.hpp"
+#include "BinexBatchWriter.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xBinexBatch);
+
+using namespace gpstk;
+
+void xBinexBatch :: setUp (void)
+{
+	seed = 12345;
+	fileName = "xBinexBatch.tmp";
+}
+
+void xBinexBatch :: tearDown (void)
+{
+	remove(fileName.c_str());
+}
+
+unsigned long xBinexBatch :: random (unsigned long n)
+{
+	seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+	return (seed >> 8) % n;
+}
+
+/*
+**** 'n' records with the flags given in turn, mostly short, with some long
+**** enough for each length of CRC
+*/
+void xBinexBatch :: makeRecords (RecordList& recs, size_t n,
+	const vector<unsigned char>& flags)
+{
+	recs.clear();
+	for (size_t i = 0; i < n; i++)
+	{
+		BinexData rec(i % 3 ? i % 128 : 0x7f00 + i % 300000,
+			flags[i % flags.size()]);
+
+		size_t len = random(200) + 1;
+		if (i % 10 == 0)
+			len = random(3000) + 100;
+		if (i % 100 == 99)
+			len = random(20000) + 4000;
+
+		string data(len, '\0');
+		for (size_t j = 0; j < len; j++)
+			data[j] = char(random(0x100));
+		size_t offset = 0;
+		rec.updateMessageData(offset, data, len);
+		recs.push_back(rec);
+	}
+}
+
+/*
+**** Writes the file with putRecord() if threads is 0, else with a
+**** BinexBatchWriter, a batch of 1000 records at a time
+*/
+void xBinexBatch :: writeFile (const RecordList& recs, unsigned threads)
+{
+	BinexStream out(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+	if (threads == 0)
+	{
+		for (size_t i = 0; i < recs.size(); i++)
+			recs[i].putRecord(out);
+	}
+	else
+	{
+		BinexBatchWriter writer(out, threads);
+		for (size_t i = 0; i < recs.size(); i += 1000)
+			writer.write(&recs[i], std::min(size_t(1000), recs.size() - i));
+	}
+}
+
+string xBinexBatch :: fileBytes (void)
+{
+	ifstream in(fileName.c_str(), ios::binary);
+	return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+/*
+**** Reads the file with getRecord() if threads is 0, else with a
+**** BinexBatchReader; through the map of the file or a filebuf
+*/
+void xBinexBatch :: readFile (RecordList& recs, unsigned threads,
+	size_t batchSize, bool mapped)
+{
+	recs.clear();
+	BinexStream in;
+	filebuf fb;
+	if (mapped)
+		in.open(fileName.c_str(), ios::in | ios::binary);
+	else
+	{
+		fb.open(fileName.c_str(), ios::in | ios::binary);
+		in.basic_ios<char>::rdbuf(&fb);
+	}
+
+	if (threads == 0)
+	{
+		BinexData rec;
+		while (in >> rec)
+			recs.push_back(rec);
+	}
+	else
+	{
+		BinexBatchReader reader(in, threads, batchSize);
+		RecordList batch;
+		size_t n;
+		while ((n = reader.read(batch)) > 0)
+			recs.insert(recs.end(), batch.begin(), batch.begin() + n);
+	}
+}
+
+/*
+**** Changes the byte of the file at pos
+*/
+void xBinexBatch :: corrupt (size_t pos)
+{
+	fstream f(fileName.c_str(), ios::in | ios::out | ios::binary);
+	f.seekg(pos);
+	char c = f.get() ^ 0x5a;
+	f.seekp(pos);
+	f.put(c);
+}
+
+/*
+**** BinexBatchWriter writes the same bytes as putRecord(), with one
+**** thread and several, for every combination of flags and CRC length
+*/
+void xBinexBatch :: writerTest (void)
+{
+	vector<unsigned char> flags;
+	flags.push_back(0);
+	flags.push_back(BinexData::eEnhancedCRC);
+	flags.push_back(BinexData::eBigEndian);
+	flags.push_back(BinexData::eBigEndian | BinexData::eEnhancedCRC);
+	flags.push_back(BinexData::eReverseReadable);
+	flags.push_back(BinexData::eReverseReadable | BinexData::eBigEndian |
+		BinexData::eEnhancedCRC);
+	RecordList recs;
+	makeRecords(recs, 3000, flags);
+
+	writeFile(recs, 0);
+	string expected(fileBytes());
+	size_t size = 0;
+	for (size_t i = 0; i < recs.size(); i++)
+		size += recs[i].getRecordSize();
+	CPPUNIT_ASSERT_EQUAL(size, expected.size());
+
+	for (unsigned threads = 1; threads <= 3; threads += 2)
+	{
+		writeFile(recs, threads);
+		CPPUNIT_ASSERT(fileBytes() == expected);
+	}
+}
+
+/*
+**** BinexBatchReader returns every record getRecord() reads, in order,
+**** across batches, with one thread and several, mapped or not
+*/
+void xBinexBatch :: readerTest (void)
+{
+	vector<unsigned char> flags;
+	flags.push_back(0);
+	flags.push_back(BinexData::eEnhancedCRC);
+	flags.push_back(BinexData::eBigEndian);
+	flags.push_back(BinexData::eBigEndian | BinexData::eEnhancedCRC);
+	RecordList recs, got;
+	makeRecords(recs, 3000, flags);
+	writeFile(recs, 0);
+
+	readFile(got, 0);
+	CPPUNIT_ASSERT(got == recs);
+
+	readFile(got, 1);
+	CPPUNIT_ASSERT(got == recs);
+	readFile(got, 3, 700);
+	CPPUNIT_ASSERT(got == recs);
+	readFile(got, 3, 700, false);
+	CPPUNIT_ASSERT(got == recs);
+	readFile(got, 4, 1);
+	CPPUNIT_ASSERT(got == recs);
+}
+
+/*
+**** Reverse-readable records read from their heads, which getRecord()
+**** does not read past; and records that start at their tails, which
+**** both read
+*/
+void xBinexBatch :: reverseTest (void)
+{
+	vector<unsigned char> flags;
+	flags.push_back(BinexData::eReverseReadable);
+	flags.push_back(BinexData::eReverseReadable | BinexData::eBigEndian);
+	flags.push_back(BinexData::eReverseReadable | BinexData::eEnhancedCRC);
+	flags.push_back(BinexData::eReverseReadable | BinexData::eBigEndian |
+		BinexData::eEnhancedCRC);
+	RecordList recs, got;
+	makeRecords(recs, 1000, flags);
+
+	writeFile(recs, 3);
+	readFile(got, 3, 300);
+	CPPUNIT_ASSERT(got == recs);
+
+		// Each record the other way round, so it starts at its tail
+	{
+		ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+		for (size_t i = 0; i < recs.size(); i++)
+		{
+			string buf;
+			recs[i].encodeRecord(buf);
+			string back(buf.rbegin(), buf.rend());
+			out.write(back.data(), back.size());
+		}
+	}
+	readFile(got, 0);
+	CPPUNIT_ASSERT(got == recs);
+	readFile(got, 3, 300);
+	CPPUNIT_ASSERT(got == recs);
+}
+
+/*
+**** Records with a bad CRC, at the start and in the middle of batches,
+**** one after another and last, are each thrown once, in their place,
+**** and the good records around them all come back in order
+*/
+void xBinexBatch :: badCRCTest (void)
+{
+	vector<unsigned char> flags;
+	flags.push_back(0);
+	flags.push_back(BinexData::eEnhancedCRC);
+	flags.push_back(BinexData::eBigEndian);
+	RecordList recs;
+	makeRecords(recs, 3000, flags);
+	writeFile(recs, 0);
+
+	const size_t bad[] = { 0, 10, 11, 700, 1000, 1499, 2999 };
+	const size_t nbad = sizeof(bad) / sizeof(bad[0]);
+	size_t pos = 0, b = 0;
+	for (size_t i = 0; i < recs.size() && b < nbad; i++)
+	{
+		pos += recs[i].getRecordSize();
+			// The last byte of a record is its CRC
+		if (i == bad[b])
+		{
+			corrupt(pos - 1);
+			b++;
+		}
+	}
+
+	for (unsigned threads = 1; threads <= 3; threads += 2)
+	{
+		BinexStream in(fileName.c_str());
+		BinexBatchReader reader(in, threads, 500);
+		RecordList batch;
+		vector<size_t> got, thrown;
+		size_t rec = 0;
+		for (;;)
+		{
+			size_t n;
+			try
+			{
+				n = reader.read(batch);
+			}
+			catch (FFStreamError& e)
+			{
+				thrown.push_back(rec++);
+				continue;
+			}
+			if (n == 0)
+				break;
+			for (size_t i = 0; i < n; i++, rec++)
+			{
+				CPPUNIT_ASSERT(batch[i] == recs[rec]);
+				got.push_back(rec);
+			}
+		}
+
+		CPPUNIT_ASSERT_EQUAL(recs.size(), rec);
+		CPPUNIT_ASSERT(thrown == vector<size_t>(bad, bad + nbad));
+		CPPUNIT_ASSERT_EQUAL(recs.size() - nbad, got.size());
+	}
+}
+
+/*
+**** A file that ends inside a record: the records before it come back,
+**** the cut one is thrown once, and the stream is left failed
+*/
+void xBinexBatch :: truncatedTest (void)
+{
+	vector<unsigned char> flags;
+	flags.push_back(0);
+	RecordList recs, got;
+	makeRecords(recs, 100, flags);
+	writeFile(recs, 0);
+
+	size_t size = 0;
+	for (size_t i = 0; i < 60; i++)
+		size += recs[i].getRecordSize();
+	string bytes(fileBytes());
+	{
+		ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+		out.write(bytes.data(), size + 5);
+	}
+
+	readFile(got, 0);
+	CPPUNIT_ASSERT_EQUAL(size_t(60), got.size());
+
+	BinexStream in(fileName.c_str());
+	BinexBatchReader reader(in, 3, 40);
+	RecordList batch;
+	size_t n = 0, read;
+	int errors = 0;
+	for (;;)
+	{
+		try
+		{
+			read = reader.read(batch);
+		}
+		catch (FFStreamError& e)
+		{
+			errors++;
+			continue;
+		}
+		if (read == 0)
+			break;
+		for (size_t i = 0; i < read; i++)
+			CPPUNIT_ASSERT(batch[i] == recs[n + i]);
+		n += read;
+	}
+	CPPUNIT_ASSERT_EQUAL(size_t(60), n);
+	CPPUNIT_ASSERT_EQUAL(1, errors);
+	CPPUNIT_ASSERT(in.fail());
+}
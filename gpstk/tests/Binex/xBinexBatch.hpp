@@ -0,0 +1,80 @@
+// file: xBinexBatch.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#ifndef XBINEXBATCH_HPP
+#define XBINEXBATCH_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+#include "BinexData.hpp"
+
+
+using namespace std;
+
+
+class xBinexBatch: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xBinexBatch);
+	CPPUNIT_TEST (writerTest);
+	CPPUNIT_TEST (readerTest);
+	CPPUNIT_TEST (reverseTest);
+	CPPUNIT_TEST (badCRCTest);
+	CPPUNIT_TEST (truncatedTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Sets up test enviornment
+		void tearDown (void); //Tears down test environment
+
+	protected:
+		void writerTest (void);
+		void readerTest (void);
+		void reverseTest (void);
+		void badCRCTest (void);
+		void truncatedTest (void);
+
+	private:
+		typedef vector<gpstk::BinexData> RecordList;
+
+		string fileName;
+		unsigned long seed;
+		unsigned long random (unsigned long n);
+		void makeRecords (RecordList& recs, size_t n,
+			const vector<unsigned char>& flags);
+		void writeFile (const RecordList& recs, unsigned threads);
+		string fileBytes (void);
+		void readFile (RecordList& recs, unsigned threads,
+			size_t batchSize = 4096, bool mapped = true);
+		void corrupt (size_t pos);
+
+};
+
+#endif
@@ -0,0 +1,108 @@
+// file: xEpochContext.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+#include "xEpochContext.hpp"
+
+#include "CivilTime.hpp"
+#include "SunPosition.hpp"
+#include "EclipsedSatFilter.hpp"
+#include "ComputeSatPCenter.hpp"
+#include "ComputeWindUp.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xEpochContext);
+
+using namespace gpstk;
+
+void xEpochContext :: setUp (void)
+{
+	epoch1 = CivilTime(2010, 6, 1, 12, 0, 0.0).convertToCommonTime();
+	epoch2 = CivilTime(2010, 6, 1, 12, 0, 30.0).convertToCommonTime();
+}
+
+/*
+**** The Sun position is that of SunPosition, computed once per epoch.
+*/
+void xEpochContext :: sunPositionTest (void)
+{
+	EpochContext context;
+	SunPosition sun;
+	Triple expected1(sun.getPosition(epoch1)), expected2(sun.getPosition(epoch2));
+
+	CPPUNIT_ASSERT_EQUAL(0UL, context.sunComputations());
+	for (int k = 0; k < 3; k++)
+	{
+		const Triple& pos(context.sunPosition(epoch1));
+		for (int i = 0; i < 3; i++)
+			CPPUNIT_ASSERT_EQUAL(expected1[i], pos[i]);
+	}
+	CPPUNIT_ASSERT_EQUAL(1UL, context.sunComputations());
+
+	const Triple& pos(context.sunPosition(epoch2));
+	for (int i = 0; i < 3; i++)
+		CPPUNIT_ASSERT_EQUAL(expected2[i], pos[i]);
+	CPPUNIT_ASSERT_EQUAL(2UL, context.sunComputations());
+
+		// after clear() the same epoch is computed again
+	context.clear();
+	context.sunPosition(epoch2);
+	CPPUNIT_ASSERT_EQUAL(3UL, context.sunComputations());
+}
+
+/*
+**** A chain eclipsed >> pcenter >> windup computes the Sun position once
+**** per epoch, also when the gnssRinex is reused for a new epoch.
+*/
+void xEpochContext :: processingChainTest (void)
+{
+	Position nominal(3855263.3407, -89.3716, 5092633.8097);
+	EclipsedSatFilter eclipsed;
+	ComputeSatPCenter pcenter(nominal);
+	ComputeWindUp windup;
+	windup.setNominalPosition(nominal);
+
+		// one satellite, with its position already computed
+	SatID sat(1, SatID::systemGPS);
+	typeValueMap tvMap;
+	tvMap[TypeID::satX] = 15510870.0;
+	tvMap[TypeID::satY] = -1563490.0;
+	tvMap[TypeID::satZ] = 21468720.0;
+
+	SunPosition sun;
+	gnssRinex gRin;
+	CommonTime epochs[2] = { epoch1, epoch2 };
+	for (int k = 0; k < 2; k++)
+	{
+		gRin.header.epoch = epochs[k];
+		gRin.body[sat] = tvMap;
+		gRin >> eclipsed >> pcenter >> windup;
+
+		CPPUNIT_ASSERT_EQUAL((unsigned long)(k+1), gRin.context.sunComputations());
+		Triple expected(sun.getPosition(epochs[k]));
+		const Triple& pos(gRin.context.sunPosition(epochs[k]));
+		for (int i = 0; i < 3; i++)
+			CPPUNIT_ASSERT_EQUAL(expected[i], pos[i]);
+		CPPUNIT_ASSERT_EQUAL((unsigned long)(k+1), gRin.context.sunComputations());
+	}
+}
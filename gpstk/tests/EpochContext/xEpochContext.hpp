@@ -0,0 +1,59 @@
+// file: xEpochContext.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+#ifndef XEPOCHCONTEXT_HPP
+#define XEPOCHCONTEXT_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "EpochContext.hpp"
+#include "DataStructures.hpp"
+
+
+using namespace std;
+
+
+class xEpochContext: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xEpochContext);
+	CPPUNIT_TEST (sunPositionTest);
+	CPPUNIT_TEST (processingChainTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Sets up test enviornment
+
+	protected:
+		void sunPositionTest (void);
+		void processingChainTest (void);
+
+	private:
+		gpstk::CommonTime epoch1, epoch2;
+
+};
+
+#endif
@@ -0,0 +1,312 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file binary_read_bench.cpp
+ *
+ * Writes a file of MDP messages and reads it back with an FFBinaryStream
+ * that maps the file and with one reading through a filebuf, as it does
+ * from a pipe, and reports messages and megabytes per second. The reads
+ * themselves are checked by the xFFBinaryStream fixture.
+ *
+ * This links to librxio:
+ *
+ * g++ -O -I../../lib/rxio -I../../src binary_read_bench.cpp
+ *    ../../lib/rxio/librxio.a ../../src/libgpstk.a -lpthread
+ */
+
+#include <cstdio>
+#include <sys/time.h>
+
+#include "StringUtils.hpp"
+#include "BasicFramework.hpp"
+#include "GPSWeekSecond.hpp"
+#include "MDPStream.hpp"
+#include "MDPObsEpoch.hpp"
+#include "MDPPVTSolution.hpp"
+#include "MDPNavSubframe.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+   /// What was read from a stream of MDP
+struct ReadSum
+{
+   ReadSum()
+      : messages(0), obs(0), pvt(0), nav(0), bad(0), sum(0) {}
+
+   unsigned long messages, obs, pvt, nav, bad;
+
+      /// Of fields of every type, so a misplaced byte shows
+   double sum;
+};
+
+
+class BinaryReadBench : public BasicFramework
+{
+public:
+
+   BinaryReadBench(char* arg0);
+
+   virtual ~BinaryReadBench() {};
+
+protected:
+
+   virtual void process();
+
+      /// Appends epochs [first, first+count) to the file
+   void writeEpochs(unsigned long first, unsigned long count);
+
+      /// Reads messages from 'in' until it ends
+   void readAll(MDPStream& in, ReadSum& rs);
+
+      /// Reads the file 'runs' times, mapped or through a filebuf, and
+      /// reports the rate
+   ReadSum timeRead(const string& what, bool mapped, int runs);
+
+      /// File written and read
+   CommandOptionWithAnyArg fileOpt;
+
+      /// Epochs written
+   CommandOptionWithNumberArg epochsOpt;
+
+      /// Number of timed reads
+   CommandOptionWithNumberArg runsOpt;
+
+   string fileName;
+
+   unsigned long epochs;
+
+   static const unsigned numSVs = 8;
+
+}; // class BinaryReadBench
+
+
+//---------------------------------------------------------------------------
+BinaryReadBench::BinaryReadBench(char* arg0)
+   : BasicFramework(arg0, "Times the reading of a file of MDP "
+                    "through a map and through a filebuf"),
+     fileOpt('f', "file", "File to write and read (default "
+             "binary_read_bench.mdp, removed at the end)"),
+     epochsOpt('e', "epochs", "Epochs written (default 20000)"),
+     runsOpt('c', "count", "Number of timed reads (default 3)"),
+     fileName("binary_read_bench.mdp"), epochs(20000)
+{
+}
+
+
+//---------------------------------------------------------------------------
+static double wallClock()
+{
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1.e-6;
+}
+
+
+//---------------------------------------------------------------------------
+void BinaryReadBench::writeEpochs(unsigned long first, unsigned long count)
+{
+   MDPStream out(fileName.c_str(),
+                 ios::out | (first ? ios::app : ios::trunc));
+
+   MDPPVTSolution pvt;
+   pvt.v[0] = pvt.v[1] = pvt.v[2] = 0.5;
+   pvt.dtime = 1e-4;
+   pvt.ddtime = 1e-9;
+   pvt.numSVs = numSVs;
+   pvt.fom = 1;
+   pvt.pvtMode = 1;
+   pvt.corrections = 0;
+
+   MDPObsEpoch oe;
+   oe.numSVs = numSVs;
+   MDPObsEpoch::Observation obs;
+   obs.carrier = ccL1;
+   obs.range = rcCA;
+   obs.bw = 1;
+   obs.snr = 45;
+
+   MDPNavSubframe sf;
+   sf.carrier = ccL1;
+   sf.range = rcCA;
+   sf.nav = ncICD_200_2;
+
+   unsigned short fc = first * (numSVs + 2);
+   for(unsigned long e = first; e < first + count; e++)
+   {
+      CommonTime t = GPSWeekSecond(1500, 0).convertToCommonTime() +
+         static_cast<double>(e);
+
+      pvt.time = pvt.timep = t;
+      pvt.x[0] = -740289.8 + e;
+      pvt.x[1] = -5457071.7;
+      pvt.x[2] = 3207245.6;
+      pvt.freshnessCount = fc++;
+      out << pvt;
+
+      for(unsigned i = 0; i < numSVs; i++)
+      {
+         oe.time = t;
+         oe.channel = i + 1;
+         oe.prn = i + 1;
+         oe.elevation = 10 + 80.0 * i / numSVs;
+         oe.azimuth = 360.0 * i / numSVs;
+         oe.freshnessCount = fc++;
+         obs.lockCount = e;
+         obs.pseudorange = 2.1e7 + 1e5 * i + 700.0 * e;
+         obs.phase = obs.pseudorange / 0.19029367;
+         obs.doppler = -3678.0;
+         oe.obs[MDPObsEpoch::ObsKey(obs.carrier, obs.range)] = obs;
+         out << oe;
+      }
+
+      sf.time = t;
+      sf.prn = e % numSVs + 1;
+      sf.freshnessCount = fc++;
+      for(int w = 1; w <= 10; w++)
+         sf.subframe[w] = (e * 10 + w) & 0x3fffffff;
+      out << sf;
+   }
+}
+
+
+//---------------------------------------------------------------------------
+void BinaryReadBench::readAll(MDPStream& in, ReadSum& rs)
+{
+   MDPHeader header;
+   while(in >> header)
+   {
+      rs.messages++;
+      switch(header.id)
+      {
+         case MDPObsEpoch::myId:
+         {
+            MDPObsEpoch oe;
+            in >> oe;
+            if(!oe)
+               rs.bad++;
+            rs.obs++;
+            MDPObsEpoch::ObsMap::const_iterator i;
+            for(i = oe.obs.begin(); i != oe.obs.end(); i++)
+               rs.sum += i->second.pseudorange + i->second.lockCount;
+            rs.sum += oe.elevation + oe.prn;
+            break;
+         }
+
+         case MDPPVTSolution::myId:
+         {
+            MDPPVTSolution pvt;
+            in >> pvt;
+            if(!pvt)
+               rs.bad++;
+            rs.pvt++;
+            rs.sum += pvt.x[0] + pvt.v[1] + pvt.numSVs;
+            break;
+         }
+
+         case MDPNavSubframe::myId:
+         {
+            MDPNavSubframe sf;
+            in >> sf;
+            if(!sf)
+               rs.bad++;
+            rs.nav++;
+            rs.sum += sf.subframe[10] + sf.prn;
+            break;
+         }
+
+         default:
+            rs.bad++;
+      }
+   }
+}
+
+
+//---------------------------------------------------------------------------
+ReadSum BinaryReadBench::timeRead(const string& what, bool mapped, int runs)
+{
+   ReadSum rs;
+   double start(wallClock());
+   for(int r = 0; r < runs; r++)
+   {
+      rs = ReadSum();
+      MDPStream in;
+      filebuf fb;
+      if(mapped)
+         in.open(fileName.c_str(), ios::in);
+      else
+      {
+         fb.open(fileName.c_str(), ios::in | ios::binary);
+         in.basic_ios<char>::rdbuf(&fb);
+      }
+      readAll(in, rs);
+   }
+   double t((wallClock() - start) / runs);
+
+   FILE* fp = fopen(fileName.c_str(), "rb");
+   fseek(fp, 0, SEEK_END);
+   double size = ftell(fp);
+   fclose(fp);
+
+   cout << leftJustify(what, 16)
+        << rightJustify(asString(rs.messages / t, 0), 12)
+        << rightJustify(asString(size / t / 1e6, 1), 10) << endl;
+   return rs;
+}
+
+
+//---------------------------------------------------------------------------
+void BinaryReadBench::process()
+{
+   if(fileOpt.getCount())
+      fileName = fileOpt.getValue()[0];
+   if(epochsOpt.getCount())
+      epochs = asUnsigned(epochsOpt.getValue()[0]);
+   int runs(runsOpt.getCount() ? asInt(runsOpt.getValue()[0]) : 3);
+
+   writeEpochs(0, epochs);
+   cout << epochs * (numSVs + 2) << " messages" << endl
+        << "                       msg/s      MB/s" << endl;
+
+   timeRead("filebuf", false, runs);
+   timeRead("mapped", true, runs);
+
+   if(!fileOpt.getCount())
+      remove(fileName.c_str());
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   BinaryReadBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return 0;
+}
@@ -0,0 +1,264 @@
+// file: xFFBinaryStream.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#include "xFFBinaryStream.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xFFBinaryStream);
+
+using namespace gpstk;
+
+void xFFBinaryStream :: setUp (void)
+{
+	fileName = "xFFBinaryStream.tmp";
+	remove(fileName.c_str());
+}
+
+void xFFBinaryStream :: tearDown (void)
+{
+	remove(fileName.c_str());
+}
+
+/*
+**** The byte at each position of the files written; no two neighbours
+**** are the same, so a misplaced read shows
+*/
+char xFFBinaryStream :: byteAt (size_t pos)
+{
+	return char((pos * 7) % 251);
+}
+
+void xFFBinaryStream :: writeBytes (size_t from, size_t to)
+{
+	ofstream out(fileName.c_str(), ios::out | ios::binary |
+		(from ? ios::app : ios::trunc));
+	for (size_t i = from; i < to; i++)
+		out.put(byteAt(i));
+}
+
+bool xFFBinaryStream :: sameBytes (const char* p, size_t from, size_t length)
+{
+	if (!p)
+		return false;
+	for (size_t i = 0; i < length; i++)
+		if (p[i] != byteAt(from + i))
+			return false;
+	return true;
+}
+
+/*
+**** The same reads of getData() and getView() through the map of a file
+**** and through the filebuf of one opened for output too, which is not
+**** mapped
+*/
+void xFFBinaryStream :: readTest (void)
+{
+	writeBytes(0, 10000);
+
+	for (int mapped = 0; mapped < 2; mapped++)
+	{
+		FFBinaryStream s(fileName.c_str(), mapped ? ios::in : ios::in | ios::out);
+		CPPUNIT_ASSERT_EQUAL(mapped == 1, s.isMapped());
+
+		size_t pos = 0;
+		while (pos + 150 <= 10000)
+		{
+			unsigned short u = s.getData<unsigned short>();
+			CPPUNIT_ASSERT(sameBytes((const char*)&u, pos, sizeof(u)));
+			pos += sizeof(u);
+
+			char buff[17];
+			s.getData(buff, sizeof(buff));
+			CPPUNIT_ASSERT(sameBytes(buff, pos, sizeof(buff)));
+			pos += sizeof(buff);
+
+			CPPUNIT_ASSERT(sameBytes(s.getView(100), pos, 100));
+			pos += 100;
+		}
+		CPPUNIT_ASSERT(s.good());
+		CPPUNIT_ASSERT_EQUAL(streampos(pos), s.tellg());
+	}
+}
+
+/*
+**** getView() of exactly what is left returns it; one more byte, or a
+**** view longer than what is left, fails the stream and consumes the rest,
+**** or throws EndOfFile when the stream throws on failbit
+*/
+void xFFBinaryStream :: viewAtEndTest (void)
+{
+	writeBytes(0, 1000);
+
+	for (int mapped = 0; mapped < 2; mapped++)
+	{
+		ios::openmode mode(mapped ? ios::in : ios::in | ios::out);
+
+		FFBinaryStream s(fileName.c_str(), mode);
+		CPPUNIT_ASSERT(sameBytes(s.getView(900), 0, 900));
+		CPPUNIT_ASSERT(sameBytes(s.getView(100), 900, 100));
+		CPPUNIT_ASSERT(s.good());
+		CPPUNIT_ASSERT(s.getView(1) == NULL);
+		CPPUNIT_ASSERT(s.fail());
+
+		FFBinaryStream t(fileName.c_str(), mode);
+		t.seekg(990);
+		CPPUNIT_ASSERT(t.getView(20) == NULL);
+		CPPUNIT_ASSERT_EQUAL(streamsize(10), t.gcount());
+		CPPUNIT_ASSERT(t.fail() && t.eof());
+
+		FFBinaryStream u(fileName.c_str(), mode);
+		u.exceptions(ios::failbit);
+		u.seekg(990);
+		CPPUNIT_ASSERT_THROW(u.getView(20), EndOfFile);
+	}
+}
+
+/*
+**** seekg() and tellg() from the start, the current position and the end
+**** agree between the map and the filebuf; a seek past the end fails
+*/
+void xFFBinaryStream :: seekTest (void)
+{
+	writeBytes(0, 5000);
+
+	for (int mapped = 0; mapped < 2; mapped++)
+	{
+		FFBinaryStream s(fileName.c_str(), mapped ? ios::in : ios::in | ios::out);
+		CPPUNIT_ASSERT_EQUAL(streampos(0), s.tellg());
+
+		s.seekg(1234);
+		CPPUNIT_ASSERT_EQUAL(streampos(1234), s.tellg());
+		CPPUNIT_ASSERT(sameBytes(s.getView(10), 1234, 10));
+
+		s.seekg(-100, ios::cur);
+		CPPUNIT_ASSERT_EQUAL(streampos(1144), s.tellg());
+		CPPUNIT_ASSERT_EQUAL(byteAt(1144), s.getData<char>());
+
+		s.seekg(-8, ios::end);
+		CPPUNIT_ASSERT_EQUAL(streampos(4992), s.tellg());
+		CPPUNIT_ASSERT(sameBytes(s.getView(8), 4992, 8));
+
+		s.seekg(0, ios::end);
+		CPPUNIT_ASSERT_EQUAL(streampos(5000), s.tellg());
+		s.seekg(0);
+		CPPUNIT_ASSERT(sameBytes(s.getView(5000), 0, 5000));
+
+		if (mapped)
+		{
+				// A filebuf seeks past the end of a file open for output
+			s.seekg(5001);
+			CPPUNIT_ASSERT(s.fail());
+		}
+	}
+}
+
+/*
+**** A file that grows while it is read is mapped again when the reader
+**** gets to the old end, and a seek to the end finds the new one
+*/
+void xFFBinaryStream :: growthTest (void)
+{
+	writeBytes(0, 3000);
+
+	FFBinaryStream s(fileName.c_str());
+	CPPUNIT_ASSERT(s.isMapped());
+	CPPUNIT_ASSERT(sameBytes(s.getView(3000), 0, 3000));
+	CPPUNIT_ASSERT(s.getView(1) == NULL);
+
+	writeBytes(3000, 10000);
+	s.clear();
+	s.seekg(3000);
+	char buff[500];
+	s.getData(buff, sizeof(buff));
+	CPPUNIT_ASSERT(s.good());
+	CPPUNIT_ASSERT(sameBytes(buff, 3000, sizeof(buff)));
+	CPPUNIT_ASSERT(sameBytes(s.getView(6500), 3500, 6500));
+
+	writeBytes(10000, 20000);
+	s.seekg(0, ios::end);
+	CPPUNIT_ASSERT_EQUAL(streampos(20000), s.tellg());
+	s.seekg(15000);
+	CPPUNIT_ASSERT(sameBytes(s.getView(5000), 15000, 5000));
+	CPPUNIT_ASSERT(s.isMapped());
+}
+
+/*
+**** An empty file can't be mapped; it is read through the filebuf, which
+**** sees what is added to it
+*/
+void xFFBinaryStream :: emptyFileTest (void)
+{
+	writeBytes(0, 0);
+
+	FFBinaryStream s(fileName.c_str());
+	CPPUNIT_ASSERT(s.is_open());
+	CPPUNIT_ASSERT(!s.isMapped());
+	CPPUNIT_ASSERT(s.getView(1) == NULL);
+
+	writeBytes(0, 100);
+	s.clear();
+	CPPUNIT_ASSERT(sameBytes(s.getView(100), 0, 100));
+	CPPUNIT_ASSERT(!s.isMapped());
+}
+
+/*
+**** A file cut short while it is mapped ends where it now does: a read
+**** across the new end gets what is left, instead of a SIGBUS from the
+**** pages past it
+*/
+void xFFBinaryStream :: truncateTest (void)
+{
+	const size_t page = ::sysconf(_SC_PAGESIZE);
+	writeBytes(0, 4 * page);
+
+	FFBinaryStream s(fileName.c_str());
+	CPPUNIT_ASSERT(s.isMapped());
+	CPPUNIT_ASSERT(sameBytes(s.getView(10), 0, 10));
+
+	CPPUNIT_ASSERT_EQUAL(0, ::truncate(fileName.c_str(), page + 50));
+
+		// Still in the file
+	CPPUNIT_ASSERT(sameBytes(s.getView(page), 10, page));
+
+		// Across the new end, into a page that is gone
+	vector<char> buff(2 * page);
+	s.getData(&buff[0], buff.size());
+	CPPUNIT_ASSERT_EQUAL(streamsize(40), s.gcount());
+	CPPUNIT_ASSERT(s.fail() && s.eof());
+	CPPUNIT_ASSERT(sameBytes(&buff[0], page + 10, 40));
+
+	s.clear();
+	s.seekg(0, ios::end);
+	CPPUNIT_ASSERT_EQUAL(streampos(page + 50), s.tellg());
+
+		// A view past the new end
+	s.seekg(page);
+	CPPUNIT_ASSERT(s.getView(100) == NULL);
+	CPPUNIT_ASSERT_EQUAL(streamsize(50), s.gcount());
+}
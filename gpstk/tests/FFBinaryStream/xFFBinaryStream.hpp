@@ -0,0 +1,73 @@
+// file: xFFBinaryStream.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#ifndef XFFBINARYSTREAM_HPP
+#define XFFBINARYSTREAM_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "FFBinaryStream.hpp"
+
+
+using namespace std;
+
+
+class xFFBinaryStream: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xFFBinaryStream);
+	CPPUNIT_TEST (readTest);
+	CPPUNIT_TEST (viewAtEndTest);
+	CPPUNIT_TEST (seekTest);
+	CPPUNIT_TEST (growthTest);
+	CPPUNIT_TEST (emptyFileTest);
+	CPPUNIT_TEST (truncateTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Sets up test enviornment
+		void tearDown (void); //Tears down test environment
+
+	protected:
+		void readTest (void);
+		void viewAtEndTest (void);
+		void seekTest (void);
+		void growthTest (void);
+		void emptyFileTest (void);
+		void truncateTest (void);
+
+	private:
+		string fileName;
+		static char byteAt (size_t pos);
+		void writeBytes (size_t from, size_t to);
+		bool sameBytes (const char* p, size_t from, size_t length);
+
+};
+
+#endif
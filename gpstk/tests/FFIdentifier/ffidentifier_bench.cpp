@@ -0,0 +1,167 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file ffidentifier_bench.cpp
+ *
+ * Identifies the files given on the command line one by one and in
+ * batches of one and several threads and reports files per second. The
+ * format signatures are checked by the xFFIdentifier fixture. For example
+ *
+ * ffidentifier_bench ../../examples/bahr1620.04? ../../examples/igs1481?.sp3
+ *
+ * This links to librxio:
+ *
+ * g++ -O -I../../lib/rxio -I../../src ffidentifier_bench.cpp
+ *    ../../lib/rxio/librxio.a ../../src/libgpstk.a -lpthread
+ */
+
+#include <sys/time.h>
+
+#include "StringUtils.hpp"
+#include "BasicFramework.hpp"
+#include "ThreadPool.hpp"
+#include "FFIdentifier.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+class FFIdentifierBench : public BasicFramework
+{
+public:
+
+   FFIdentifierBench(char* arg0);
+
+   virtual ~FFIdentifierBench() {};
+
+protected:
+
+   virtual void process();
+
+      /// Identify the files 'runs' times in batches of 'threads' threads
+      /// and report the rate
+   void timeBatch(unsigned threads, int runs);
+
+      /// Files to identify
+   CommandOptionRest filesOpt;
+
+      /// Threads of the parallel batches
+   CommandOptionWithNumberArg threadsOpt;
+
+      /// Number of timed batches
+   CommandOptionWithNumberArg runsOpt;
+
+   vector<string> files;
+
+}; // class FFIdentifierBench
+
+
+//---------------------------------------------------------------------------
+FFIdentifierBench::FFIdentifierBench(char* arg0)
+   : BasicFramework(arg0, "Times the identification of the files given"),
+     filesOpt("Files to identify"),
+     threadsOpt('t', "threads", "Threads of the parallel batches (default "
+                "one per processor, at least 2)"),
+     runsOpt('c', "count", "Number of timed batches (default 3)")
+{
+}
+
+
+//---------------------------------------------------------------------------
+static double wallClock()
+{
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1.e-6;
+}
+
+
+//---------------------------------------------------------------------------
+void FFIdentifierBench::timeBatch(unsigned threads, int runs)
+{
+   vector<FFIdentifier::FFType> types;
+
+   double start(wallClock());
+   for(int r = 0; r < runs; r++)
+      FFIdentifier::identify(files, types, threads);
+   double t((wallClock() - start) / runs);
+
+   cout << "Batch of " << threads << " thread(s): "
+        << (t > 0 ? asString(files.size() / t, 0) : string("-"))
+        << " files/s" << endl;
+}
+
+
+//---------------------------------------------------------------------------
+void FFIdentifierBench::process()
+{
+   files = filesOpt.getValue();
+   if(files.empty())
+      return;
+
+   vector<FFIdentifier::FFType> single(files.size());
+   double start(wallClock());
+   for(size_t i = 0; i < files.size(); i++)
+   {
+      try
+      {
+         single[i] = FFIdentifier(files[i]);
+      }
+      catch(Exception&)
+      {
+         single[i] = FFIdentifier::tUnknown;
+      }
+   }
+   double t(wallClock() - start);
+   cout << "One by one: "
+        << (t > 0 ? asString(files.size() / t, 0) : string("-"))
+        << " files/s" << endl;
+
+   unsigned threads(threadsOpt.getCount() ?
+                    asInt(threadsOpt.getValue()[0]) :
+                    std::max(2U, ThreadPool::processorCount()));
+   int runs(runsOpt.getCount() ? asInt(runsOpt.getValue()[0]) : 3);
+
+   timeBatch(1, runs);
+   timeBatch(threads, runs);
+
+   if(verboseLevel)
+      for(size_t i = 0; i < files.size(); i++)
+         cout << files[i] << ": " << FFIdentifier::describe(single[i])
+              << endl;
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   FFIdentifierBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return 0;
+}
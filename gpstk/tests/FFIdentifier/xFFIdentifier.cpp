@@ -0,0 +1,290 @@
+// file: xFFIdentifier.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#include "xFFIdentifier.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "GPSWeekSecond.hpp"
+#include "FICHeader.hpp"
+#include "MDPHeader.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xFFIdentifier);
+
+using namespace gpstk;
+
+void xFFIdentifier :: setUp (void)
+{
+}
+
+/*
+**** The first line of a RINEX file of the given type
+*/
+string xFFIdentifier :: rinex (char type)
+{
+	string line(string(5, ' ') + "2.11" + string(11, ' ') + type +
+		string(39, ' ') + "RINEX VERSION / TYPE\n");
+	return line;
+}
+
+/*
+**** An MDP message of a header and an eight byte body, with its CRC
+**** set or spoiled
+*/
+string xFFIdentifier :: mdp (bool goodCRC)
+{
+	MDPHeader header;
+	header.id = 300;
+	header.length = MDPHeader::myLength + 8;
+	header.freshnessCount = 1;
+	header.time = GPSWeekSecond(1500, 3600);
+
+	string msg(header.encode() + string(8, '\001'));
+	header.setCRC(msg);
+	if (!goodCRC)
+		msg[MDPHeader::myLength] ^= 0x40;
+	return msg;
+}
+
+/*
+**** 'lines' records of the ICD-GPS-211 SMODF format, 85 characters each
+*/
+string xFFIdentifier :: smodf (unsigned lines)
+{
+	string line("2008279 1000.0000000  585401 10  2.00000000000000D+07 "
+		"1.00000D+00 000 20.01000.0 50.0\n");
+	string s;
+	for (unsigned i = 0; i < lines; i++)
+		s += line;
+	return s;
+}
+
+/*
+**** One small sample of each format sniff() knows
+*/
+void xFFIdentifier :: formatsTest (void)
+{
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tRinexObs, FFIdentifier::sniff(rinex('O')));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tRinexNav, FFIdentifier::sniff(rinex('N')));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tRinexMet, FFIdentifier::sniff(rinex('M')));
+
+		// With DOS line ends too
+	string crlf(rinex('O'));
+	crlf.insert(crlf.size() - 1, "\r");
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tRinexObs, FFIdentifier::sniff(crlf));
+
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tSP3, FFIdentifier::sniff(
+		"#cP2009  7  4  0  0  0.00000000     288 ORBIT IGS05 HLM  IGS\n"
+		"## 1539 345600.00000000   900.00000000 55016 0.0000000000000\n"));
+
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tYuma, FFIdentifier::sniff(
+		"******** Week  377 almanac for PRN-01 ********\n"
+		"ID:                         01\n"));
+
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tSEM, FFIdentifier::sniff(
+		"30  CURRENT.ALM\n 385 405504\n\n1\n32\n"));
+
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tSMODF, FFIdentifier::sniff(smodf(3)));
+
+		// The legacy SMODF records are 80 characters long
+	string legacy("082791000.0000000 1085401");
+	legacy.resize(80, ' ');
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tSMODF,
+		FFIdentifier::sniff(legacy + "\n" + legacy + "\n"));
+
+		// MSC records of 104 characters, and of 90
+	string msc("200136011111AAA    2001 001 000002001 001 00000"
+		"-1111111.295-2222222.239 3333333.175-0.0111 0.0222-0.0333\n");
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tMSC, FFIdentifier::sniff(msc + msc));
+	string msc90("200136022222BBB");
+	msc90.resize(90, ' ');
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tMSC, FFIdentifier::sniff(msc90 + "\n"));
+
+	string fic(FICHeader::headerSize, ' ');
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tFIC,
+		FFIdentifier::sniff(fic + "BLK " + string(16, '\0')));
+
+		// MDP, also after some noise ahead of the frame word
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tMDP, FFIdentifier::sniff(mdp(true)));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tMDP,
+		FFIdentifier::sniff(string(6, '\0') + mdp(true) + mdp(true)));
+
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tAshtechSerial,
+		FFIdentifier::sniff("\001\002$PASHR,PBN,"));
+
+		// Novatel OEM2 and OEM4 sync bytes
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tNovatelOem,
+		FFIdentifier::sniff(string("\252\104\021\034", 4)));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tNovatelOem,
+		FFIdentifier::sniff(string("\000\252\104\022\034", 5)));
+}
+
+/*
+**** Files that look like none of them, or almost like one
+*/
+void xFFIdentifier :: unknownTest (void)
+{
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(""));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown,
+		FFIdentifier::sniff("Just some text\nand some more\n"));
+
+		// A RINEX file of a type that isn't identified, and the label
+		// out of its column
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(rinex('G')));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown,
+		FFIdentifier::sniff(" " + rinex('O')));
+
+		// An SP3 line without the '##' line, and a Yuma header without ID:
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(
+		"#cP2009  7  4  0  0  0.00000000     288 ORBIT IGS05 HLM  IGS\n"
+		"+   29   G01G02G03G04G05G06G07G08G09G10G11G12G13G14G15G16G17\n"));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(
+		"******** Week  377 almanac for PRN-01 ********\n"
+		"Health:                     000\n"));
+
+		// SMODF records of mixed lengths
+	string mixed(smodf(2));
+	mixed.insert(10, " ");
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(mixed));
+
+		// An MDP frame word and header with a bad CRC
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(mdp(false)));
+
+		// Novatel sync bytes of another receiver
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown,
+		FFIdentifier::sniff(string("\252\104\023\034", 4)));
+}
+
+/*
+**** Heads cut short: the file ends inside a signature, or the head ends
+**** inside a line
+*/
+void xFFIdentifier :: truncatedTest (void)
+{
+		// RINEX cut before the label
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown,
+		FFIdentifier::sniff(rinex('O').substr(0, 70)));
+
+		// FIC cut inside the block marker
+	string fic(FICHeader::headerSize, ' ');
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(fic + "BL"));
+
+		// MDP cut inside the body, whose CRC can't be checked
+	string msg(mdp(true));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown,
+		FFIdentifier::sniff(msg.substr(0, msg.size() - 1)));
+
+		// SP3 cut inside its first line
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown,
+		FFIdentifier::sniff("#cP2009  7  4  0  0"));
+
+		// A SEM file of fewer than four lines
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown,
+		FFIdentifier::sniff("30  CURRENT.ALM\n 385 405504\n\n"));
+
+		// A whole SMODF file whose last line is cut short is not SMODF, but
+		// a head of sniffSize bytes ending inside a line only counts its
+		// complete lines.
+	string s(smodf(100));
+	CPPUNIT_ASSERT(s.size() > FFIdentifier::sniffSize);
+	string cut(s.substr(0, 3 * 86 + 40));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff(cut));
+	string head(s.substr(0, FFIdentifier::sniffSize));
+	CPPUNIT_ASSERT(head[head.size() - 1] != '\n');
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tSMODF, FFIdentifier::sniff(head));
+
+		// ... and a whole file may end without a line end.
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tSMODF,
+		FFIdentifier::sniff(s.substr(0, 2 * 86 + 85)));
+}
+
+/*
+**** The magic numbers of compressed files, before anything else
+*/
+void xFFIdentifier :: compressedTest (void)
+{
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tCompressed,
+		FFIdentifier::sniff(string("\037\213\010\000", 4)));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tCompressed,
+		FFIdentifier::sniff("\037\235\220"));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tCompressed,
+		FFIdentifier::sniff("BZh91AY&SY"));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tCompressed,
+		FFIdentifier::sniff(string("PK\003\004\024\000", 6)));
+
+		// A gzipped RINEX file is compressed, not RINEX
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tCompressed,
+		FFIdentifier::sniff(string("\037\213", 2) + rinex('O')));
+
+		// Too short, or not quite, a magic number
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff("\037"));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff("BZh"));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff("BZh0"));
+	CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, FFIdentifier::sniff("PK\003"));
+}
+
+/*
+**** Files identified one by one and in batches of one and several
+**** threads agree; a missing file throws, or is unknown in a batch
+*/
+void xFFIdentifier :: fileTest (void)
+{
+	const char* names[] = { "ffid_o.tmp", "ffid_n.tmp", "ffid_smodf.tmp",
+		"ffid_mdp.tmp", "ffid_gz.tmp", "ffid_empty.tmp" };
+	string contents[] = { rinex('O'), rinex('N'), smodf(100),
+		mdp(true) + mdp(true), string("\037\213\010\000", 4), "" };
+	FFIdentifier::FFType types[] = { FFIdentifier::tRinexObs,
+		FFIdentifier::tRinexNav, FFIdentifier::tSMODF, FFIdentifier::tMDP,
+		FFIdentifier::tCompressed, FFIdentifier::tUnknown };
+
+	vector<string> files;
+	for (int i = 0; i < 6; i++)
+	{
+		ofstream out(names[i], ios::out | ios::binary);
+		out << contents[i];
+		files.push_back(names[i]);
+	}
+	files.push_back("ffid_missing.tmp");
+
+	for (int i = 0; i < 6; i++)
+		CPPUNIT_ASSERT_EQUAL(types[i], FFIdentifier::FFType(FFIdentifier(names[i])));
+	CPPUNIT_ASSERT_THROW(FFIdentifier missing(files[6]), FileMissingException);
+
+	for (unsigned threads = 1; threads <= 3; threads += 2)
+	{
+		vector<FFIdentifier::FFType> found;
+		FFIdentifier::identify(files, found, threads);
+		CPPUNIT_ASSERT_EQUAL(files.size(), found.size());
+		for (int i = 0; i < 6; i++)
+			CPPUNIT_ASSERT_EQUAL(types[i], found[i]);
+		CPPUNIT_ASSERT_EQUAL(FFIdentifier::tUnknown, found[6]);
+	}
+
+	for (int i = 0; i < 6; i++)
+		remove(names[i]);
+}
@@ -0,0 +1,69 @@
+// file: xFFIdentifier.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#ifndef XFFIDENTIFIER_HPP
+#define XFFIDENTIFIER_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "FFIdentifier.hpp"
+
+
+using namespace std;
+
+
+class xFFIdentifier: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xFFIdentifier);
+	CPPUNIT_TEST (formatsTest);
+	CPPUNIT_TEST (unknownTest);
+	CPPUNIT_TEST (truncatedTest);
+	CPPUNIT_TEST (compressedTest);
+	CPPUNIT_TEST (fileTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Sets up test enviornment
+
+	protected:
+		void formatsTest (void);
+		void unknownTest (void);
+		void truncatedTest (void);
+		void compressedTest (void);
+		void fileTest (void);
+
+	private:
+		string rinex (char type);
+		string mdp (bool goodCRC);
+		string smodf (unsigned lines);
+
+};
+
+#endif
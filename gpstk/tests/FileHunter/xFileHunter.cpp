@@ -0,0 +1,156 @@
+// file: xFileHunter.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+#include "xFileHunter.hpp"
+#include "CommonTime.hpp"
+#include "YDSTime.hpp"
+#include "StringUtils.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xFileHunter);
+
+using namespace gpstk;
+
+/*
+**** Builds a small archive: two years of five days, with two stations per day
+**** and a file in each day that does not match the specification.
+*/
+void xFileHunter :: setUp (void)
+{
+	char cwd[4096];
+	CPPUNIT_ASSERT(getcwd(cwd, sizeof(cwd)) != NULL);
+	root = string(cwd) + "/Logs/archive";
+	spec = root + "/%4Y/%3j/S%3n%3j0.%2yo";
+
+	for (int year = 2011; year <= 2012; year++)
+	{
+		for (int doy = 1; doy <= 5; doy++)
+		{
+			string day = root + "/" + StringUtils::asString(year) + "/"
+				+ StringUtils::rightJustify(StringUtils::asString(doy), 3, '0');
+			string name = StringUtils::rightJustify(StringUtils::asString(doy), 3, '0')
+				+ "0." + StringUtils::asString(year).substr(2) + "o";
+			makeFile(day + "/S401" + name);
+			makeFile(day + "/S402" + name);
+			makeFile(day + "/README");
+		}
+	}
+}
+
+/*
+**** Compares find() with an index against find() on the disk, over several time ranges,
+**** in both sorted orders, with and without a filter.
+*/
+void xFileHunter :: indexFindTest (void)
+{
+	FileHunter disk(spec);
+	FileHunter indexed(spec);
+	indexed.buildIndex(2);
+	CPPUNIT_ASSERT(indexed.hasIndex());
+	CPPUNIT_ASSERT_EQUAL((size_t)20, indexed.find().size());
+	compare(disk, indexed);
+
+	vector<string> stations(1, "401");
+	disk.setFilter(FileSpec::station, stations);
+	indexed.setFilter(FileSpec::station, stations);
+	CPPUNIT_ASSERT_EQUAL((size_t)10, indexed.find().size());
+	compare(disk, indexed);
+}
+
+/*
+**** Adds files to the archive and checks that a refreshed index finds them.
+*/
+void xFileHunter :: indexRefreshTest (void)
+{
+	FileHunter disk(spec);
+	FileHunter indexed(spec);
+	indexed.buildIndex(2);
+	size_t before = indexed.find().size();
+
+	makeFile(root + "/2012/006/S4010060.12o");
+	makeFile(root + "/2012/003/S4030030.12o");
+	indexed.setIndexMaxAge(0);
+	CPPUNIT_ASSERT_EQUAL(before + 2, indexed.find().size());
+	compare(disk, indexed);
+
+	remove((root + "/2012/006/S4010060.12o").c_str());
+	remove((root + "/2012/006").c_str());
+	remove((root + "/2012/003/S4030030.12o").c_str());
+	indexed.refreshIndex();
+	CPPUNIT_ASSERT_EQUAL(before, indexed.find().size());
+	compare(disk, indexed);
+}
+
+/*
+**** Saves an index and checks that the loaded index gives the same files as the disk.
+*/
+void xFileHunter :: indexSaveLoadTest (void)
+{
+	FileHunter disk(spec);
+	FileHunter saved(spec);
+	saved.buildIndex(2);
+	saved.saveIndex("Logs/archive.idx");
+
+	FileHunter loaded(spec);
+	loaded.loadIndex("Logs/archive.idx", 2);
+	loaded.setIndexMaxAge(-1);
+	CPPUNIT_ASSERT(loaded.hasIndex());
+	compare(disk, loaded);
+
+	FileHunter other(root + "/%4Y/%3j/R%3n%3j0.%2yo");
+	CPPUNIT_ASSERT_THROW(other.loadIndex("Logs/archive.idx"), FileHunterException);
+}
+
+void xFileHunter :: compare (FileHunter& disk, FileHunter& indexed)
+{
+	CommonTime all[2] = {CommonTime::BEGINNING_OF_TIME, CommonTime::END_OF_TIME};
+	CommonTime ranges[][2] = {
+		{all[0], all[1]},
+		{YDSTime(2011, 3, 0.0), YDSTime(2011, 3, 0.0)},
+		{YDSTime(2011, 4, 43200.0), YDSTime(2012, 2, 0.0)},
+		{YDSTime(2012, 5, 0.0), all[1]},
+		{YDSTime(2013, 1, 0.0), all[1]}
+	};
+	for (size_t i = 0; i < sizeof(ranges)/sizeof(ranges[0]); i++)
+	{
+		CPPUNIT_ASSERT(disk.find(ranges[i][0], ranges[i][1], FileSpec::ascending) ==
+			indexed.find(ranges[i][0], ranges[i][1], FileSpec::ascending));
+		CPPUNIT_ASSERT(disk.find(ranges[i][0], ranges[i][1], FileSpec::descending) ==
+			indexed.find(ranges[i][0], ranges[i][1], FileSpec::descending));
+	}
+}
+
+void xFileHunter :: makeFile (const string& path)
+{
+	for (string::size_type pos = path.find('/', 1); pos != string::npos;
+		pos = path.find('/', pos + 1))
+		mkdir(path.substr(0, pos).c_str(), 0755);
+	ofstream f(path.c_str());
+	CPPUNIT_ASSERT(f);
+}
@@ -0,0 +1,69 @@
+// file: xFileHunter.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+#ifndef XFILEHUNTER_HPP
+#define XFILEHUNTER_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "FileHunter.hpp"
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+class xFileHunter: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xFileHunter);
+	CPPUNIT_TEST (indexFindTest);
+	CPPUNIT_TEST (indexRefreshTest);
+	CPPUNIT_TEST (indexSaveLoadTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Builds the archive searched by the tests
+
+	protected:
+
+		void indexFindTest (void);
+		void indexRefreshTest (void);
+		void indexSaveLoadTest (void);
+
+	private:
+
+		//Checks that the index and a disk search give the same files
+		void compare (gpstk::FileHunter& disk, gpstk::FileHunter& indexed);
+
+		//Creates an empty file, and the directories above it
+		void makeFile (const string& path);
+
+		string root;	//Absolute path of the archive
+		string spec;	//File specification of the archive
+
+};
+#endif
@@ -0,0 +1,278 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file formatted_line_bench.cpp
+ *
+ * Checks that gpstk::FormattedLine produces exactly the characters of the
+ * StringUtils expressions it replaces in the RINEX, SP3 and RINEX clock
+ * writers, for random and special values; then times the building of
+ * RINEX observation data lines both ways and reports lines per second.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+
+#include "StringUtils.hpp"
+#include "FormattedLine.hpp"
+#include "BasicFramework.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+class FormattedLineBench : public BasicFramework
+{
+public:
+
+   FormattedLineBench(char* arg0);
+
+   virtual ~FormattedLineBench() {};
+
+   virtual bool initialize(int argc, char *argv[]) throw();
+
+      /// Number of fields that differ
+   unsigned long failures() const
+      { return nfail; }
+
+protected:
+
+   virtual void process();
+
+      /// Compare one field; print it if different
+   void check(const string& what, const string& expected,
+              const FormattedLine& actual);
+
+      /// Random double with a random magnitude between 1e-lo and 1e+hi
+   static double randomValue(int lo, int hi);
+
+      /// Number of lines to build for the timing
+   CommandOptionWithNumberArg linesOpt;
+
+   unsigned long nfail, nchecked;
+
+}; // class FormattedLineBench
+
+
+//---------------------------------------------------------------------------
+FormattedLineBench::FormattedLineBench(char* arg0)
+   : BasicFramework(arg0, "Checks FormattedLine against StringUtils, and "
+                    "times both"),
+     linesOpt('n', "lines", "Number of lines to build for the timing "
+              "(default 200000)"),
+     nfail(0), nchecked(0)
+{
+}
+
+
+//---------------------------------------------------------------------------
+bool FormattedLineBench::initialize(int argc, char *argv[]) throw()
+{
+   if(!BasicFramework::initialize(argc, argv)) return false;
+   ::srand48(12345);
+   return true;
+}
+
+
+//---------------------------------------------------------------------------
+double FormattedLineBench::randomValue(int lo, int hi)
+{
+   double mag = ::pow(10.0, -lo + (lo + hi) * ::drand48());
+   return (::drand48() < 0.5 ? -mag : mag);
+}
+
+
+//---------------------------------------------------------------------------
+void FormattedLineBench::check(const string& what, const string& expected,
+                               const FormattedLine& actual)
+{
+   nchecked++;
+   if(expected == actual.asString())
+   {
+      if(verboseLevel > 1)
+         cout << " PASS - " << what << " [" << expected << "]" << endl;
+      return;
+   }
+   nfail++;
+   cout << " FAIL - " << what << endl
+        << "   expected [" << expected << "]" << endl
+        << "   got      [" << actual.c_str() << "]" << endl;
+}
+
+
+//---------------------------------------------------------------------------
+void FormattedLineBench::process()
+{
+   FormattedLine line;
+
+      // special values, then random ones over a wide range of magnitudes
+   vector<double> values;
+   values.push_back(0.0);
+   values.push_back(-0.0);
+   values.push_back(1.0);
+   values.push_back(-1.0);
+   values.push_back(0.5e-3);
+   values.push_back(9.9999999999995);
+   values.push_back(-99999999.9999999);
+   values.push_back(1.e-310);
+   values.push_back(1.e100);
+   values.push_back(-1.e-100);
+   values.push_back(numeric_limits<double>::max());
+   values.push_back(numeric_limits<double>::infinity());
+   values.push_back(-numeric_limits<double>::infinity());
+   values.push_back(numeric_limits<double>::quiet_NaN());
+   for(int i=0; i<20000; i++)
+      values.push_back(randomValue(12, 12));
+   for(int i=0; i<2000; i++)
+      values.push_back(randomValue(300, 300));
+
+   for(size_t i=0; i<values.size(); i++)
+   {
+      double d(values[i]);
+      string v(asString(d, 17));
+
+      line.clear(); line.addFixed(d, 3, 14);
+      check("addFixed(" + v + ",3,14)", rightJustify(asString(d, 3), 14), line);
+      line.clear(); line.addFixed(d, 7, 11);
+      check("addFixed(" + v + ",7,11)", rightJustify(asString(d, 7), 11), line);
+      line.clear(); line.addFixed(d, 12, 15);
+      check("addFixed(" + v + ",12,15)", rightJustify(asString(d, 12), 15),
+            line);
+
+      line.clear(); line.addScientific(d, 19, 12, 2);
+      check("addScientific(" + v + ",19,12,2)",
+            doubleToScientific(d, 19, 12, 2), line);
+      line.clear(); line.addScientific(d, 13, 4, 3, true);
+      check("addScientific(" + v + ",13,4,3,true)",
+            doubleToScientific(d, 13, 4, 3, true), line);
+      line.clear(); line.addScientific(d, 0, 0, 0);
+      check("addScientific(" + v + ",0,0,0)",
+            doubleToScientific(d, 0, 0, 0), line);
+
+         // doub2for throws for inf and nan
+      if(!(::fabs(d) < numeric_limits<double>::infinity())) continue;
+      line.clear(); line.addFortran(d, 19, 2);
+      check("addFortran(" + v + ",19,2)", doub2for(d, 19, 2), line);
+      line.clear(); line.addFortran(d, 19, 2, false);
+      check("addFortran(" + v + ",19,2,false)", doub2for(d, 19, 2, false), line);
+      line.clear(); line.addFortran(d, 10, 3);
+      check("addFortran(" + v + ",10,3)", doub2for(d, 10, 3), line);
+   }
+
+   for(int i=0; i<20000; i++)
+   {
+      long n(::lrand48() - (1L << 30));
+      if(i < 5) n = (i == 0 ? 0 : (i % 2 ? 1 : -1) * 10 * i);
+      if(i > 10) n >>= (::lrand48() % 31);
+      string v(asString(n));
+
+      line.clear(); line.addInt(n, 3);
+      check("addInt(" + v + ",3)", rightJustify(asString(n), 3), line);
+      line.clear(); line.addInt(n, 9);
+      check("addInt(" + v + ",9)", rightJustify(asString(n), 9), line);
+      line.clear(); line.addInt(n, 2, '0');
+      check("addInt(" + v + ",2,'0')", rightJustify(asString(n), 2, '0'), line);
+      line.clear(); line.addUnsigned((unsigned)n, 8);
+      check("addUnsigned(" + v + ",8)", rightJustify(asString((unsigned)n), 8),
+            line);
+      line.clear(); line.addPadded(n, 2, '0');
+      ostringstream oss;
+      oss.fill('0');
+      oss << setw(2) << n;
+      check("addPadded(" + v + ",2,'0')", oss.str(), line);
+   }
+
+   line.clear(); line.add("AS G").addRight("ABCDE", 4).addRight("XY", 4, '.');
+   check("add/addRight", string("AS G") + rightJustify("ABCDE", 4)
+         + rightJustify("XY", 4, '.'), line);
+   line.clear(); line.print("%4d %02d %02d %02d %02d %9.6f", 2012, 6, 18, 0, 5,
+                            59.5);
+   check("print", "2012 06 18 00 05 59.500000", line);
+
+   cout << "Checked " << nchecked << " fields, " << nfail << " different"
+        << endl;
+
+      // time the building of RINEX observation data lines (5 fields 14.3
+      // with LLI and SSI) both ways
+   unsigned long nlines(linesOpt.getCount() ? asUnsigned(linesOpt.getValue()[0])
+                                            : 200000);
+   vector<double> obs(5*1024);
+   for(size_t i=0; i<obs.size(); i++)
+      obs[i] = randomValue(1, 8);
+
+   size_t total(0);
+   clock_t start(::clock());
+   for(unsigned long n=0; n<nlines; n++)
+   {
+      string str;
+      for(int j=0; j<5; j++)
+      {
+         str += rightJustify(asString(obs[(5*n+j) % obs.size()], 3), 14);
+         str += string(1, ' ');
+         str += rightJustify(asString<short>(j+1), 1);
+      }
+      total += str.size();
+   }
+   double tstr = double(::clock() - start) / CLOCKS_PER_SEC;
+
+   start = ::clock();
+   for(unsigned long n=0; n<nlines; n++)
+   {
+      line.clear();
+      for(int j=0; j<5; j++)
+      {
+         line.addFixed(obs[(5*n+j) % obs.size()], 3, 14);
+         line.add(' ');
+         line.addInt(j+1, 1);
+      }
+      total -= line.size();
+   }
+   double tfl = double(::clock() - start) / CLOCKS_PER_SEC;
+
+   if(total != 0)
+   {
+      nfail++;
+      cout << " FAIL - line lengths differ in the timing loops" << endl;
+   }
+
+   cout << "RINEX obs data lines per second: StringUtils "
+        << (tstr > 0 ? asString(nlines/tstr, 0) : string("-"))
+        << ", FormattedLine "
+        << (tfl > 0 ? asString(nlines/tfl, 0) : string("-")) << endl;
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   FormattedLineBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return (app.failures() > 0 ? 1 : 0);
+}
@@ -0,0 +1,242 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file mdp_ingest_bench.cpp
+ *
+ * Runs MDPIngest of apps/MDPtools against receivers made up by MDPLoopback
+ * on the loopback interface and checks that every message arrives, once
+ * and in order, for each receiver: with one worker and with several, with
+ * a queue short enough to hold the receivers back, and with some messages
+ * sent with a bad CRC, which must be counted and dropped. Reports messages
+ * per second and the latency from read to end of processing.
+ *
+ * This is Linux only (epoll) and links to mdplib and the stream buffers of
+ * apps/rfw:
+ *
+ * g++ -O -I../../apps/MDPtools -I../../apps/rfw -I../../lib/rxio -I../../src
+ *    mdp_ingest_bench.cpp ../../apps/MDPtools/MDPIngest.cpp
+ *    ../../apps/MDPtools/MDPLoopback.cpp ../../apps/rfw/FDStreamBuff.cpp
+ *    ../../apps/rfw/TCPStreamBuff.cpp ../../apps/MDPtools/libmdplib.a
+ *    ../../lib/rxio/librxio.a ../../src/libgpstk.a -lpthread
+ */
+
+#include "StringUtils.hpp"
+#include "BasicFramework.hpp"
+#include "ThreadPool.hpp"
+#include "MDPIngest.hpp"
+#include "MDPLoopback.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+   /// Counts the messages of a receiver and checks they come in order
+class CheckProcessor : public MDPProcessor
+{
+public:
+   CheckProcessor()
+      : count(0), outOfOrder(0)
+   { obsOut = pvtOut = navOut = tstOut = true; }
+
+   unsigned long count, outOfOrder;
+
+private:
+   void check(const MDPHeader& msg)
+   {
+      if (count++ && msg.time < last)
+         outOfOrder++;
+      last = msg.time;
+   }
+
+   void process(const MDPObsEpoch& oe)        { check(oe); }
+   void process(const MDPPVTSolution& pvt)    { check(pvt); }
+   void process(const MDPNavSubframe& sf)     { check(sf); }
+   void process(const MDPSelftestStatus& sts) { check(sts); }
+
+   CommonTime last;
+};
+
+
+class MDPIngestBench : public BasicFramework
+{
+public:
+
+   MDPIngestBench(char* arg0);
+
+   virtual ~MDPIngestBench() {};
+
+      /// Number of failed checks
+   unsigned long failures() const
+      { return nfail; }
+
+protected:
+
+   virtual void process();
+
+      /// Ingest 'receivers' made up receivers; check what arrives and
+      /// report the rates.
+   void runIngest(const string& what, unsigned workers, unsigned queue,
+                  unsigned long corruptEvery);
+
+      /// Number of made up receivers
+   CommandOptionWithNumberArg receiversOpt;
+
+      /// Epochs each receiver sends
+   CommandOptionWithNumberArg epochsOpt;
+
+      /// Workers of the parallel runs
+   CommandOptionWithNumberArg threadsOpt;
+
+   int receivers;
+
+   unsigned long epochs;
+
+   unsigned long nfail;
+
+}; // class MDPIngestBench
+
+
+//---------------------------------------------------------------------------
+MDPIngestBench::MDPIngestBench(char* arg0)
+   : BasicFramework(arg0, "Checks and times MDPIngest against receivers "
+                    "made up on the loopback interface"),
+     receiversOpt('n', "receivers", "Number of receivers (default 4)"),
+     epochsOpt('e', "epochs", "Epochs each receiver sends (default 2000)"),
+     threadsOpt('t', "threads", "Workers of the parallel runs (default "
+                "one per processor, at least 2)"),
+     receivers(4), epochs(2000), nfail(0)
+{
+}
+
+
+//---------------------------------------------------------------------------
+void MDPIngestBench::runIngest(const string& what, unsigned workers,
+                               unsigned queue, unsigned long corruptEvery)
+{
+   MDPIngest ingest(workers, queue);
+   vector<MDPLoopback*> loops;
+   vector<CheckProcessor*> procs;
+
+   for(int i = 0; i < receivers; i++)
+   {
+      loops.push_back(new MDPLoopback(epochs));
+      loops[i]->corruptEvery = corruptEvery;
+      loops[i]->start();
+      procs.push_back(new CheckProcessor);
+      ingest.addProcessor(ingest.addSource(loops[i]->getTarget()), procs[i]);
+   }
+
+   ingest.run();
+   double t(ingest.elapsed());
+
+   MDPIngest::Counters total;
+   for(int i = 0; i < receivers; i++)
+   {
+      loops[i]->join();
+      MDPIngest::Counters c(ingest.getCounters(i));
+      const MDPLoopback& lb(*loops[i]);
+      const CheckProcessor& p(*procs[i]);
+
+      total.processed += c.processed;
+      total.crcErrors += c.crcErrors;
+      total.stalls += c.stalls;
+      total.latencySum += c.latencySum;
+      total.latencyMax = std::max(total.latencyMax, c.latencyMax);
+
+      string fail;
+      if(c.processed + c.crcErrors != lb.messages || c.messages != lb.messages)
+         fail += " " + asString(c.messages) + " of " +
+            asString(lb.messages) + " messages arrived;";
+      if(c.crcErrors != lb.corrupted)
+         fail += " " + asString(c.crcErrors) + " CRC errors, " +
+            asString(lb.corrupted) + " expected;";
+      if(c.skipped || c.unknown)
+         fail += " " + asString(c.skipped) + " bytes skipped;";
+      if(p.count != c.processed || p.outOfOrder)
+         fail += " " + asString(p.count) + " processed, " +
+            asString(p.outOfOrder) + " out of order;";
+      if(!corruptEvery && p.fcErrorCount)
+         fail += " " + asString(p.fcErrorCount) + " freshness count errors;";
+
+      if(!fail.empty())
+      {
+         nfail++;
+         cout << " FAIL - " << what << ", " << ingest.getName(i) << ":"
+              << fail << endl;
+      }
+   }
+
+   cout << leftJustify(what, 28)
+        << rightJustify(asString(total.processed / t, 0), 10)
+        << rightJustify(asString(total.stalls), 8)
+        << rightJustify(asString(total.crcErrors), 6)
+        << rightJustify(asString(total.processed ?
+                                 1e3 * total.latencySum / total.processed :
+                                 0.0, 2), 9)
+        << rightJustify(asString(1e3 * total.latencyMax, 1), 8) << endl;
+
+   for(int i = 0; i < receivers; i++)
+   {
+      delete procs[i];
+      delete loops[i];
+   }
+}
+
+
+//---------------------------------------------------------------------------
+void MDPIngestBench::process()
+{
+   if(receiversOpt.getCount())
+      receivers = asInt(receiversOpt.getValue()[0]);
+   if(epochsOpt.getCount())
+      epochs = asUnsigned(epochsOpt.getValue()[0]);
+
+   unsigned threads(threadsOpt.getCount() ?
+                    asInt(threadsOpt.getValue()[0]) :
+                    std::max(2U, ThreadPool::processorCount()));
+
+   cout << receivers << " receivers, " << epochs << " epochs of "
+        << MDPLoopback(0).messagesPerEpoch() << " messages each" << endl
+        << "                              msg/s  stalls   crc  lat ms     max"
+        << endl;
+
+   runIngest("1 worker", 1, 1024, 0);
+   runIngest(asString(threads) + " workers", threads, 1024, 0);
+   runIngest(asString(threads) + " workers, queue of 4", threads, 4, 0);
+   runIngest(asString(threads) + " workers, bad CRCs", threads, 1024, 97);
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   MDPIngestBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return (app.failures() > 0 ? 1 : 0);
+}
@@ -252,6 +252,164 @@ void xRinexObs :: filterOperatorsTest (void)
 
 }
 
+/*
+**** This test writes RinexObsFile.06o with the threaded RinexObsEpochWriter and checks the result
+**** against the same epochs written directly to a RinexObsStream.  It then writes to /dev/full
+**** and checks that write errors, from the calling thread and from the output thread, reach the caller.
+*/
+void xRinexObs :: epochWriterTest (void)
+{
+	{
+		gpstk::RinexObsEpochReader reader("Logs/RinexObsFile.06o");
+		gpstk::RinexObsStream direct("Logs/EpochWriterDirect.06o",ios::out|ios::trunc);
+		gpstk::RinexObsEpochWriter writer("Logs/EpochWriterOutput.06o",2);
+		gpstk::RinexObsEpochReader::Epoch epoch;
+
+		direct << reader.getHeader();
+		writer.write(reader.getHeader());
+		while (reader.next(epoch))
+		{
+			if (!epoch.empty())
+				direct << epoch.text;
+			writer.write(epoch);
+		}
+		direct.close();
+		CPPUNIT_ASSERT_NO_THROW(writer.close());
+	}
+	CPPUNIT_ASSERT(fileEqualTest((char*)"Logs/EpochWriterDirect.06o",(char*)"Logs/EpochWriterOutput.06o"));
+
+#ifdef __linux__
+		// The header is written by the calling thread
+	bool thrown = false;
+	try
+	{
+		gpstk::RinexObsEpochReader reader("Logs/RinexObsFile.06o");
+		gpstk::RinexObsEpochWriter writer("/dev/full");
+		writer.write(reader.getHeader());
+	}
+	catch (gpstk::FFStreamError& e)
+	{
+		thrown = true;
+	}
+	CPPUNIT_ASSERT(thrown);
+
+		// Epochs are written by the output thread; its error is reported
+		// by a later write() or by close()
+	thrown = false;
+	try
+	{
+		gpstk::RinexObsEpochWriter writer("/dev/full",1);
+		gpstk::RinexObsEpochReader::Epoch epoch;
+		for (int i = 0; i < 20; i++)
+		{
+			gpstk::RinexObsEpochReader reader("Logs/RinexObsFile.06o");
+			while (reader.next(epoch))
+				writer.write(epoch);
+		}
+		writer.close();
+	}
+	catch (gpstk::FFStreamError& e)
+	{
+		thrown = true;
+	}
+	CPPUNIT_ASSERT(thrown);
+#endif
+}
+
+/*
+**** Write a RINEX obs file with the header given and the epochs (as text)
+**** picked, in order, by the digits of which.
+*/
+static void writeEpochs (const char* name, const gpstk::RinexObsHeader& header,
+	const std::vector<std::string>& epochs, const char* which)
+{
+	gpstk::RinexObsStream out(name,ios::out|ios::trunc);
+	out << header;
+	for (const char* c = which; *c; c++)
+		out << epochs[*c-'0'];
+}
+
+/*
+**** Check that two RINEX obs files have the same epochs, decoded; the obs
+**** types may be listed in a different order.
+*/
+static void checkSameEpochs (const char* name1, const char* name2)
+{
+	std::vector<gpstk::RinexObsData> data1, data2;
+	gpstk::RinexObsHeader header;
+	gpstk::RinexObsData epoch;
+	gpstk::RinexObsStream in1(name1), in2(name2);
+	in1 >> header;
+	while (in1 >> epoch)
+		data1.push_back(epoch);
+	in2 >> header;
+	while (in2 >> epoch)
+		data2.push_back(epoch);
+
+	CPPUNIT_ASSERT_EQUAL(data1.size(),data2.size());
+	for (size_t i = 0; i < data1.size(); i++)
+	{
+		CPPUNIT_ASSERT_EQUAL(data1[i].time,data2[i].time);
+		CPPUNIT_ASSERT_EQUAL(data1[i].epochFlag,data2[i].epochFlag);
+		CPPUNIT_ASSERT_EQUAL(data1[i].obs.size(),data2[i].obs.size());
+		gpstk::RinexObsData::RinexSatMap::const_iterator it, jt;
+		for (it = data1[i].obs.begin(), jt = data2[i].obs.begin();
+		     it != data1[i].obs.end(); it++, jt++)
+		{
+			CPPUNIT_ASSERT(it->first == jt->first);
+			CPPUNIT_ASSERT_EQUAL(it->second.size(),jt->second.size());
+			gpstk::RinexObsData::RinexObsTypeMap::const_iterator kt, lt;
+			for (kt = it->second.begin(), lt = jt->second.begin();
+			     kt != it->second.end(); kt++, lt++)
+			{
+				CPPUNIT_ASSERT(kt->first == lt->first);
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(kt->second.data,lt->second.data,1e-3);
+				CPPUNIT_ASSERT_EQUAL(kt->second.lli,lt->second.lli);
+				CPPUNIT_ASSERT_EQUAL(kt->second.ssi,lt->second.ssi);
+			}
+		}
+	}
+}
+
+void xRinexObs :: mergeTest (void)
+{
+		// RinexObsFile.06o has six epochs; split it into overlapping parts
+	std::vector<std::string> epochs;
+	gpstk::RinexObsHeader header;
+	{
+		gpstk::RinexObsEpochReader reader("Logs/RinexObsFile.06o");
+		gpstk::RinexObsEpochReader::Epoch epoch;
+		header = reader.getHeader();
+		while (reader.next(epoch))
+			epochs.push_back(epoch.text);
+	}
+	CPPUNIT_ASSERT_EQUAL((size_t)6,epochs.size());
+	writeEpochs("Logs/MergePart1.06o",header,epochs,"0123");
+	writeEpochs("Logs/MergePart2.06o",header,epochs,"2345");
+	writeEpochs("Logs/MergePart3.06o",header,epochs,"5314");
+
+		// Time ordered inputs, given out of order: the k-way merge writes
+		// every epoch once, in time order, and drops the repeated ones
+	std::vector<std::string> files;
+	files.push_back("Logs/MergePart2.06o");
+	files.push_back("Logs/MergePart1.06o");
+	CPPUNIT_ASSERT(gpstk::streamMergeRinexObs(files,"Logs/MergeOutput.06o"));
+	checkSameEpochs("Logs/RinexObsFile.06o","Logs/MergeOutput.06o");
+	{
+		gpstk::RinexObsStream in("Logs/MergeOutput.06o");
+		gpstk::RinexObsHeader merged;
+		in >> merged;
+		CPPUNIT_ASSERT_EQUAL(header.firstObs,merged.firstObs);
+	}
+
+		// An input not in time order stops the k-way merge; sortMerge
+		// reads it all and writes the epochs anew
+	files[0] = "Logs/MergePart3.06o";
+	CPPUNIT_ASSERT(!gpstk::streamMergeRinexObs(files,"Logs/MergeOutput2.06o"));
+	gpstk::sortMergeRinexObs(files,"Logs/MergeOutput2.06o");
+	checkSameEpochs("Logs/RinexObsFile.06o","Logs/MergeOutput2.06o");
+}
+
 /*
 **** A helper function for xRinexObs to line by line, check if the two files given are the same.
 **** Takes in two file names within double quotes "FILEONE.TXT" "FILETWO.TXT".  Returns true if
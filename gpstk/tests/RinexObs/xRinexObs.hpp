@@ -32,6 +32,9 @@
 #include "RinexObsStream.hpp"
 #include "RinexObsHeader.hpp"
 #include "RinexObsFilterOperators.hpp"
+#include "RinexObsEpochReader.hpp"
+#include "RinexObsEpochWriter.hpp"
+#include "RinexObsMerge.hpp"
 
 using namespace std;
 
@@ -42,6 +45,8 @@ class xRinexObs: public CPPUNIT_NS :: TestFixture
 	CPPUNIT_TEST (hardCodeTest);
 	CPPUNIT_TEST (filterOperatorsTest);
 	CPPUNIT_TEST (dataExceptionsTest);
+	CPPUNIT_TEST (epochWriterTest);
+	CPPUNIT_TEST (mergeTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 	public:
@@ -52,6 +57,8 @@ class xRinexObs: public CPPUNIT_NS :: TestFixture
 		void hardCodeTest (void);
 		void filterOperatorsTest (void);
 		void dataExceptionsTest (void);
+		void epochWriterTest (void);
+		void mergeTest (void);
 		bool fileEqualTest (char*, char*);
 
 	private:
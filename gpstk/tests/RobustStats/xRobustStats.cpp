@@ -0,0 +1,257 @@
+// file: xRobustStats.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+#include "xRobustStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xRobustStats);
+
+using namespace gpstk;
+
+/*
+**** The naive references: each sorts a copy of the data and takes the
+**** middle, as Median(xd,nd,false) did before the selection routines.
+*/
+static double naiveMedian (vector<double> v)
+{
+	sort(v.begin(), v.end());
+	int n = v.size();
+	if (n % 2) return v[(n+1)/2-1];
+	return (v[n/2-1] + v[n/2]) / 2.0;
+}
+
+static double naiveMAD (const vector<double>& v, double& M)
+{
+	M = naiveMedian(v);
+	vector<double> dev(v.size());
+	for (size_t i = 0; i < v.size(); i++) dev[i] = fabs(v[i] - M);
+	return naiveMedian(dev) / RobustTuningE;
+}
+
+	// Iteratively reweighted bisquare estimate, written out with the
+	// sorted median and MAD
+static double naiveBisquare (const vector<double>& v, const vector<double>& wd,
+                             double c, vector<double>& w)
+{
+	double M, mad = naiveMAD(v, M), tv = c * mad, m = M, mold;
+	int n = 0;
+	w.resize(v.size());
+	do
+	{
+		mold = m;
+		n++;
+		double sum = 0.0, sumw = 0.0;
+		for (size_t i = 0; i < v.size(); i++)
+		{
+			double r = (v[i] - m) / tv;
+			w[i] = (fabs(r) >= 1.0 ? 0.0 : (1.0 - r*r) * (1.0 - r*r));
+			double ww = (wd.empty() ? w[i] : wd[i] * w[i]);
+			sumw += ww;
+			sum += ww * v[i];
+		}
+		if (sumw == 0.0) break;
+		m = sum / sumw;
+	} while (fabs((m - mold) / m) > 0.000001 && n < 10);
+	return m;
+}
+
+void xRobustStats :: setUp (void)
+{
+	seed = 12345;
+}
+
+/*
+**** A linear congruential generator, so the series are the same on every
+**** platform. Values are on a grid of 0.01 so that some repeat, and about
+**** one in ten is an outlier.
+*/
+vector<double> xRobustStats :: series (int n)
+{
+	vector<double> v(n);
+	for (int i = 0; i < n; i++)
+	{
+		seed = (seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+		v[i] = double((seed >> 8) % 500) / 100.0;
+		if ((seed >> 4) % 10 == 0) v[i] *= 40.0;
+	}
+	return v;
+}
+
+void xRobustStats :: selectMedianTest (void)
+{
+	for (int n = 2; n <= 60; n++)
+	{
+		vector<double> v = series(n), w(v);
+		CPPUNIT_ASSERT_EQUAL(naiveMedian(v), Robust::SelectMedian(&w[0], n));
+
+			// Median() selects in a copy, and leaves the data alone
+		w = v;
+		CPPUNIT_ASSERT_EQUAL(naiveMedian(v), Robust::Median(&w[0], n));
+		CPPUNIT_ASSERT(w == v);
+	}
+
+	vector<double> one(1, 1.0);
+	CPPUNIT_ASSERT_THROW(Robust::SelectMedian(&one[0], 1), Exception);
+	CPPUNIT_ASSERT_THROW(Robust::SelectMedian((double *)0, 5), Exception);
+}
+
+void xRobustStats :: selectQuartilesTest (void)
+{
+	for (int n = 2; n <= 60; n++)
+	{
+		vector<double> v = series(n), s(v);
+		sort(s.begin(), s.end());
+		double Q1, Q3, q1, q3;
+		Robust::Quartiles(&s[0], n, Q1, Q3);
+		Robust::SelectQuartiles(&v[0], n, q1, q3);
+		CPPUNIT_ASSERT_EQUAL(Q1, q1);
+		CPPUNIT_ASSERT_EQUAL(Q3, q3);
+	}
+}
+
+void xRobustStats :: selectMADTest (void)
+{
+	for (int n = 2; n <= 60; n++)
+	{
+		vector<double> v = series(n), w(v);
+		double M, m, mad = naiveMAD(v, M);
+		CPPUNIT_ASSERT_EQUAL(mad, Robust::SelectMAD(&w[0], n, m));
+		CPPUNIT_ASSERT_EQUAL(M, m);
+
+		w = v;
+		CPPUNIT_ASSERT_EQUAL(mad, Robust::MedianAbsoluteDeviation(&w[0], n, m));
+		CPPUNIT_ASSERT_EQUAL(M, m);
+		CPPUNIT_ASSERT(w == v);
+	}
+}
+
+/*
+**** The sliding median is compared, after every value, with the median of
+**** the last N values (all of them until there are N).
+*/
+void xRobustStats :: slidingMedianTest (void)
+{
+	int widths[] = { 1, 2, 3, 8, 31 };
+	vector<double> v = series(200);
+
+	for (int k = 0; k < 5; k++)
+	{
+		int N = widths[k];
+		Robust::SlidingMedian<double> sm(N);
+		CPPUNIT_ASSERT_THROW(sm.median(), Exception);
+
+		for (int i = 0; i < (int)v.size(); i++)
+		{
+			sm.add(v[i]);
+			int first = (i+1 > N ? i+1-N : 0);
+			vector<double> window(v.begin() + first, v.begin() + i + 1);
+			CPPUNIT_ASSERT_EQUAL((int)window.size(), sm.size());
+			CPPUNIT_ASSERT_EQUAL(i+1 >= N, sm.full());
+			CPPUNIT_ASSERT_EQUAL(naiveMedian(window), sm.median());
+		}
+
+		sm.reset();
+		CPPUNIT_ASSERT_EQUAL(0, sm.size());
+		CPPUNIT_ASSERT_THROW(sm.median(), Exception);
+		sm.add(v[7]);
+		CPPUNIT_ASSERT_EQUAL(v[7], sm.median());
+	}
+
+	CPPUNIT_ASSERT_THROW(Robust::SlidingMedian<double> bad(0), Exception);
+}
+
+/*
+**** With no a priori weights, the Huber estimate is MEstimate() given the
+**** sorted median and MAD, weights and all; a priori weights of one change
+**** nothing.
+*/
+void xRobustStats :: mEstimatorHuberTest (void)
+{
+	Robust::MEstimator<double> est;
+	for (int n = 2; n <= 60; n++)
+	{
+		vector<double> v = series(n), w(n), wref(n), ones(n, 1.0);
+		double M, mad = naiveMAD(v, M);
+		double ref = Robust::MEstimate(&v[0], n, M, mad, &wref[0]);
+
+		CPPUNIT_ASSERT_EQUAL(ref, est.estimate(&v[0], n, NULL, &w[0]));
+		CPPUNIT_ASSERT(w == wref);
+		CPPUNIT_ASSERT_EQUAL(M, est.getMedian());
+		CPPUNIT_ASSERT_EQUAL(mad, est.getMAD());
+
+		CPPUNIT_ASSERT_EQUAL(ref, est.estimate(&v[0], n, &ones[0]));
+	}
+
+	CPPUNIT_ASSERT_THROW(est.estimate((double *)0, 5), Exception);
+}
+
+void xRobustStats :: mEstimatorBisquareTest (void)
+{
+	Robust::MEstimator<double> est(Robust::MEstimator<double>::Bisquare);
+	for (int n = 5; n <= 60; n++)
+	{
+		vector<double> v = series(n), w(n), wref, wd(n), none;
+		for (int i = 0; i < n; i++) wd[i] = 0.5 + (i % 4) * 0.25;
+
+		double ref = naiveBisquare(v, none, 4.685, wref);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(ref, est.estimate(&v[0], n, NULL, &w[0]), 1.e-12);
+		for (int i = 0; i < n; i++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(wref[i], w[i], 1.e-12);
+
+		ref = naiveBisquare(v, wd, 4.685, wref);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(ref, est.estimate(&v[0], n, &wd[0], &w[0]), 1.e-12);
+		for (int i = 0; i < n; i++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(wref[i], w[i], 1.e-12);
+	}
+
+		// An outlier gets no weight at all
+	double data[] = { 1.0, 1.1, 0.9, 1.05, 0.95, 1.02, 0.98, 50.0 };
+	double w[8];
+	double m = est.estimate(data, 8, NULL, w);
+	CPPUNIT_ASSERT_EQUAL(0.0, w[7]);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, m, 0.05);
+}
+
+/*
+**** The work arrays kept between calls must not change the result: series
+**** of decreasing and increasing length give what a new estimator gives.
+*/
+void xRobustStats :: mEstimatorReuseTest (void)
+{
+	int lengths[] = { 50, 7, 33, 2, 60, 10 };
+	Robust::MEstimator<double> kept(Robust::MEstimator<double>::Bisquare, 3.0);
+
+	for (int k = 0; k < 6; k++)
+	{
+		vector<double> v = series(lengths[k]);
+		Robust::MEstimator<double> fresh(Robust::MEstimator<double>::Bisquare, 3.0);
+		CPPUNIT_ASSERT_EQUAL(fresh.estimate(&v[0], v.size()),
+		                     kept.estimate(&v[0], v.size()));
+		CPPUNIT_ASSERT_EQUAL(fresh.getMedian(), kept.getMedian());
+		CPPUNIT_ASSERT_EQUAL(fresh.getMAD(), kept.getMAD());
+		CPPUNIT_ASSERT_EQUAL(fresh.getIterations(), kept.getIterations());
+	}
+}
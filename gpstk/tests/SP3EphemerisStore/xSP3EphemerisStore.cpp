@@ -28,6 +28,7 @@
 #include "CivilTime.hpp"
 #include "CommonTime.hpp"
 #include "SP3EphemerisStore.hpp"
+#include <sstream>
 
 CPPUNIT_TEST_SUITE_REGISTRATION (xSP3EphemerisStore);
 
@@ -252,6 +253,122 @@ void xSP3EphemerisStore :: SP3getVelocityTest (void)
 
 }
 
+/*
+ * Test for the binary snapshot cache
+ * -- Loads the SP3 file with a cache directory twice, once writing the
+ * -- snapshot and once reading it, and checks that the second load came
+ * -- from the snapshot and gives the same results as a store loaded without
+ * -- the cache
+ */
+
+void xSP3EphemerisStore :: SP3CacheTest (void)
+{
+	SP3EphemerisStore Plain, Writer, Reader;
+	Writer.setCacheDirectory("Logs");
+	Reader.setCacheDirectory("Logs");
+
+	CPPUNIT_ASSERT_NO_THROW(Plain.loadFile("igs09000.sp3"));
+	CPPUNIT_ASSERT_NO_THROW(Writer.loadFile("igs09000.sp3"));
+	CPPUNIT_ASSERT_NO_THROW(Reader.loadFile("igs09000.sp3"));
+
+	CPPUNIT_ASSERT_EQUAL(Plain.ndataPosition(),Reader.ndataPosition());
+	CPPUNIT_ASSERT_EQUAL(Plain.ndataClock(),Reader.ndataClock());
+	CPPUNIT_ASSERT_EQUAL(Plain.getInitialTime(),Reader.getInitialTime());
+	CPPUNIT_ASSERT_EQUAL(Plain.getFinalTime(),Reader.getFinalTime());
+	CPPUNIT_ASSERT_EQUAL(1,Reader.nSP3files());
+	CPPUNIT_ASSERT_EQUAL(0U,Plain.nSP3SnapshotReads());
+	CPPUNIT_ASSERT_EQUAL(1U,Reader.nSP3SnapshotReads());
+
+	SatID sid1(1,SatID::systemGPS);
+	CivilTime eTime_civ(1997,4,6,6,17,36); // between epochs
+	CommonTime eTime = eTime_civ.convertToCommonTime();
+
+	Xvt plainXvt = Plain.getXvt(sid1,eTime);
+	Xvt readerXvt = Reader.getXvt(sid1,eTime);
+	for(int i=0; i<3; i++)
+	{
+		CPPUNIT_ASSERT_EQUAL(plainXvt.x[i],readerXvt.x[i]);
+		CPPUNIT_ASSERT_EQUAL(plainXvt.v[i],readerXvt.v[i]);
+	}
+	CPPUNIT_ASSERT_EQUAL(plainXvt.clkbias,readerXvt.clkbias);
+}
+
+/*
+ * Loading several files at once must give the same store as loading
+ * them one at a time, in the same order
+ */
+void xSP3EphemerisStore :: SP3LoadFilesTest (void)
+{
+	SP3EphemerisStore Serial, Parallel;
+	std::vector<std::string> files;
+	files.push_back("igs09000.sp3");
+	files.push_back("apc01000");
+
+	for(size_t i=0; i<files.size(); i++)
+		CPPUNIT_ASSERT_NO_THROW(Serial.loadFile(files[i]));
+	CPPUNIT_ASSERT_NO_THROW(Parallel.loadFiles(files,2));
+
+	CPPUNIT_ASSERT_EQUAL(2,Parallel.nSP3files());
+	CPPUNIT_ASSERT_EQUAL(Serial.ndataPosition(),Parallel.ndataPosition());
+	CPPUNIT_ASSERT_EQUAL(Serial.ndataClock(),Parallel.ndataClock());
+	CPPUNIT_ASSERT_EQUAL(Serial.getInitialTime(),Parallel.getInitialTime());
+	CPPUNIT_ASSERT_EQUAL(Serial.getFinalTime(),Parallel.getFinalTime());
+	CPPUNIT_ASSERT_EQUAL(Serial.hasVelocity(),Parallel.hasVelocity());
+
+	SatID sid1(1,SatID::systemGPS);
+	CommonTime eTime[2] = {
+		CivilTime(1997,4,6,6,17,36).convertToCommonTime(),
+		CivilTime(2001,7,22,6,17,36).convertToCommonTime() };
+	for(int k=0; k<2; k++)
+	{
+		Xvt serialXvt = Serial.getXvt(sid1,eTime[k]);
+		Xvt parallelXvt = Parallel.getXvt(sid1,eTime[k]);
+		for(int i=0; i<3; i++)
+		{
+			CPPUNIT_ASSERT_EQUAL(serialXvt.x[i],parallelXvt.x[i]);
+			CPPUNIT_ASSERT_EQUAL(serialXvt.v[i],parallelXvt.v[i]);
+		}
+		CPPUNIT_ASSERT_EQUAL(serialXvt.clkbias,parallelXvt.clkbias);
+	}
+
+	// a file already in the store is rejected, and nothing is added
+	int ndata = Parallel.ndataPosition();
+	CPPUNIT_ASSERT_THROW(Parallel.loadFiles(files),gpstk::Exception);
+	CPPUNIT_ASSERT_EQUAL(ndata,Parallel.ndataPosition());
+	CPPUNIT_ASSERT_EQUAL(2,Parallel.nSP3files());
+
+	// igs09000a.sp3 and igs09000b.sp3 split igs09000.sp3 and share the
+	// epochs 11:30 to 12:15, where b has every X moved by 1 m; the file
+	// loaded last supplies those epochs
+	std::vector<std::string> split;
+	split.push_back("igs09000a.sp3");
+	split.push_back("igs09000b.sp3");
+	SP3EphemerisStore Whole, SerialAB, ParallelAB, ParallelBA;
+	Whole.loadFile("igs09000.sp3");
+	SerialAB.loadFile(split[0]);
+	SerialAB.loadFile(split[1]);
+	ParallelAB.loadFiles(split,2);
+	std::vector<std::string> reversed(split.rbegin(),split.rend());
+	ParallelBA.loadFiles(reversed,2);
+
+	std::ostringstream serialDump, parallelDump;
+	SerialAB.dumpPosition(serialDump,2);
+	ParallelAB.dumpPosition(parallelDump,2);
+	CPPUNIT_ASSERT(serialDump.str() == parallelDump.str());
+	CPPUNIT_ASSERT_EQUAL(Whole.ndataPosition(),ParallelAB.ndataPosition());
+	CPPUNIT_ASSERT_EQUAL(Whole.ndataPosition(),ParallelBA.ndataPosition());
+	CPPUNIT_ASSERT_EQUAL(Whole.getInitialTime(),ParallelAB.getInitialTime());
+	CPPUNIT_ASSERT_EQUAL(Whole.getFinalTime(),ParallelAB.getFinalTime());
+
+	CommonTime shared = CivilTime(1997,4,6,11,45,0).convertToCommonTime();
+	CommonTime single = CivilTime(1997,4,6,15,0,0).convertToCommonTime();
+	double whole = Whole.getPosition(sid1,shared)[0];
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(whole+1.0,ParallelAB.getPosition(sid1,shared)[0],1.e-2);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(whole,ParallelBA.getPosition(sid1,shared)[0],1.e-6);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(Whole.getPosition(sid1,single)[0],
+		ParallelAB.getPosition(sid1,single)[0],1.e-6);
+}
+
 /*
  * Can compare two files--necessary for getXvt test
  */
@@ -46,6 +46,8 @@ class xSP3EphemerisStore: public CPPUNIT_NS :: TestFixture
 	CPPUNIT_TEST (SP3getFinalTimeTest);
 	CPPUNIT_TEST (SP3getPositionTest);
 	CPPUNIT_TEST (SP3getVelocityTest);
+	CPPUNIT_TEST (SP3CacheTest);
+	CPPUNIT_TEST (SP3LoadFilesTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 	public:
@@ -59,6 +61,8 @@ class xSP3EphemerisStore: public CPPUNIT_NS :: TestFixture
 		void SP3getFinalTimeTest (void);
 		void SP3getPositionTest (void);
 		void SP3getVelocityTest (void);
+		void SP3CacheTest (void);
+		void SP3LoadFilesTest (void);
 		bool fileEqualTest (char[], char[]);
 
 	private:
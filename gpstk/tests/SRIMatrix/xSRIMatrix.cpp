@@ -0,0 +1,285 @@
+// file: xSRIMatrix.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+#include "xSRIMatrix.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xSRIMatrix);
+
+using namespace gpstk;
+
+/*
+**** The column by column Householder update, as SrifMU(R,Z,A,M) does it for
+**** small problems.
+*/
+static void columnSrifMU (Matrix<double>& R, Vector<double>& Z, Matrix<double>& A,
+	unsigned int M)
+{
+	const double EPS = -1.e-200;
+	unsigned int m = M, n = R.rows(), np1 = n+1, i, j, k;
+	if (m == 0 || m > A.rows()) m = A.rows();
+	double dum, delta, beta;
+
+	for (j = 0; j < n; j++)
+	{
+		double sum = 0.0;
+		for (i = 0; i < m; i++)
+			sum += A(i,j)*A(i,j);
+		if (sum <= 0.0) continue;
+
+		dum = R(j,j);
+		sum += dum * dum;
+		sum = (dum > 0.0 ? -1.0 : 1.0) * ::sqrt(sum);
+		delta = dum - sum;
+		R(j,j) = sum;
+
+		beta = sum*delta;
+		if (beta > EPS) continue;
+		beta = 1.0/beta;
+
+		for (k = j+1; k < np1; k++)
+		{
+			sum = delta * (k == n ? Z(j) : R(j,k));
+			for (i = 0; i < m; i++)
+				sum += A(i,j) * A(i,k);
+			if (sum == 0.0) continue;
+
+			sum *= beta;
+			if (k == n) Z(j) += sum*delta;
+			else R(j,k) += sum*delta;
+
+			for (i = 0; i < m; i++)
+				A(i,k) += sum * A(i,j);
+		}
+	}
+}
+
+/*
+**** The information matrix R^T*R and vector R^T*Z; these do not depend on
+**** the orthogonal transformations that formed R and Z.
+*/
+static void information (const Matrix<double>& R, const Vector<double>& Z,
+	Matrix<double>& I, Vector<double>& b)
+{
+	unsigned int n = R.rows(), i, j, k;
+	I = Matrix<double>(n, n, 0.0);
+	b = Vector<double>(n, 0.0);
+	for (i = 0; i < n; i++)
+		for (j = 0; j < n; j++)
+			for (k = 0; k <= std::min(i,j); k++)
+				I(i,j) += R(k,i) * R(k,j);
+	for (i = 0; i < n; i++)
+		for (k = 0; k <= i; k++)
+			b(i) += R(k,i) * Z(k);
+}
+
+void xSRIMatrix :: setUp (void)
+{
+	seed = 12345;
+}
+
+	// Uniform in [-1,1), from a linear congruential generator
+double xSRIMatrix :: random (void)
+{
+	seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+	return double(seed) / 1073741824.0 - 1.0;
+}
+
+	// An upper triangular R with a dominant diagonal, and Z
+void xSRIMatrix :: randomSRI (unsigned int n, Matrix<double>& R, Vector<double>& Z)
+{
+	R = Matrix<double>(n, n, 0.0);
+	Z = Vector<double>(n);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		R(i,i) = 2.0 + random();
+		for (unsigned int j = i+1; j < n; j++)
+			R(i,j) = random();
+		Z(i) = 10.0 * random();
+	}
+}
+
+/*
+**** SrifMUBlock with panels of nb columns gives the column by column
+**** update, for n states and m rows of data; A has 'extra' more rows, which
+**** are not data (M = m) and are left as they are.
+*/
+void xSRIMatrix :: checkUpdate (unsigned int n, unsigned int m, unsigned int extra,
+	unsigned int nb)
+{
+	Matrix<double> R, A(m+extra, n+1);
+	Vector<double> Z;
+	randomSRI(n, R, Z);
+	for (unsigned int i = 0; i < A.rows(); i++)
+		for (unsigned int j = 0; j <= n; j++)
+			A(i,j) = random();
+	if (n > 2)
+		R(1,1) = 0.0;           // a zero diagonal, as for a state with no information
+
+	Matrix<double> Rc(R), Rb(R), Ac(A), Ab(A);
+	Vector<double> Zc(Z), Zb(Z);
+	unsigned int M = (extra > 0 ? m : 0);
+	columnSrifMU(Rc, Zc, Ac, M);
+	SrifMUBlock(Rb, Zb, Ab, M, nb);
+
+	for (unsigned int i = 0; i < n; i++)
+	{
+		for (unsigned int j = 0; j < n; j++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(Rc(i,j), Rb(i,j), 1.e-11 * std::max(1.0, std::fabs(Rc(i,j))));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(Zc(i), Zb(i), 1.e-11 * std::max(1.0, std::fabs(Zc(i))));
+	}
+		// residuals of fit
+	for (unsigned int i = 0; i < m; i++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(Ac(i,n), Ab(i,n), 1.e-11 * std::max(1.0, std::fabs(Ac(i,n))));
+		// rows past M are not touched
+	for (unsigned int i = m; i < A.rows(); i++)
+		for (unsigned int j = 0; j <= n; j++)
+			CPPUNIT_ASSERT_EQUAL(A(i,j), Ab(i,j));
+}
+
+/*
+**** The blocked update at the edges of the panels, with and without rows
+**** past M, and with panels of one column and of the largest size.
+*/
+void xSRIMatrix :: blockUpdateTest (void)
+{
+	const unsigned int sizes[] = { 1, 2, 15, 16, 17, 31, 32, 33, 48, 70 };
+	for (unsigned int k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++)
+	{
+		checkUpdate(sizes[k], 40, 0, 16);
+		checkUpdate(sizes[k], 40, 7, 16);
+		checkUpdate(sizes[k], 5, 3, 16);
+	}
+	checkUpdate(20, 10, 0, 1);
+	checkUpdate(70, 40, 5, 64);
+	checkUpdate(70, 40, 5, 100);    // nb is limited to 64
+	checkUpdate(33, 600, 2, 16);    // more than one chunk of rows
+}
+
+/*
+**** SrifMU passes large problems to SrifMUBlock; the result is still that
+**** of the column by column update.
+*/
+void xSRIMatrix :: largeUpdateTest (void)
+{
+	const unsigned int n = 80, m = 50;
+	Matrix<double> R, A(m, n+1);
+	Vector<double> Z;
+	randomSRI(n, R, Z);
+	for (unsigned int i = 0; i < m; i++)
+		for (unsigned int j = 0; j <= n; j++)
+			A(i,j) = random();
+
+	Matrix<double> Rc(R), Ac(A);
+	Vector<double> Zc(Z);
+	columnSrifMU(Rc, Zc, Ac, 0);
+	SrifMU(R, Z, A, 0);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		for (unsigned int j = 0; j < n; j++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(Rc(i,j), R(i,j), 1.e-11 * std::max(1.0, std::fabs(Rc(i,j))));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(Zc(i), Z(i), 1.e-11 * std::max(1.0, std::fabs(Zc(i))));
+	}
+}
+
+/*
+**** SrifMerge gives SrifMU with A = R2 || Z2.
+*/
+void xSRIMatrix :: mergeTest (void)
+{
+	const unsigned int n = 25;
+	Matrix<double> R, R2;
+	Vector<double> Z, Z2;
+	randomSRI(n, R, Z);
+	randomSRI(n, R2, Z2);
+
+	Matrix<double> Rc(R), A(n, n+1);
+	Vector<double> Zc(Z);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		for (unsigned int j = 0; j < n; j++)
+			A(i,j) = R2(i,j);
+		A(i,n) = Z2(i);
+	}
+	columnSrifMU(Rc, Zc, A, 0);
+	SrifMerge(R, Z, R2, Z2);
+	for (unsigned int i = 0; i < n; i++)
+	{
+		for (unsigned int j = 0; j < n; j++)
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(Rc(i,j), R(i,j), 1.e-11 * std::max(1.0, std::fabs(Rc(i,j))));
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(Zc(i), Z(i), 1.e-11 * std::max(1.0, std::fabs(Zc(i))));
+	}
+}
+
+/*
+**** treeMerge gives the SRI of S[0] += S[1] += ... in turn, with the same
+**** Namelist order, for SRIs with the same names and with different ones.
+*/
+void xSRIMatrix :: treeMergeTest (void)
+{
+	const char* pool[] = { "X", "Y", "Z", "clk", "trop", "N1", "N2", "N3", "N4" };
+	const unsigned int npool = sizeof(pool)/sizeof(pool[0]);
+
+	for (int same = 0; same < 2; same++)
+	{
+		vector<SRI> S;
+		for (unsigned int k = 0; k < 7; k++)
+		{
+				// names in a shifted order, and not all of them
+			vector<string> labels;
+			unsigned int n = (same ? npool : 4 + k % 4);
+			for (unsigned int i = 0; i < n; i++)
+				labels.push_back(pool[same ? i : (3*k + 2*i) % npool]);
+			Matrix<double> R;
+			Vector<double> Z;
+			randomSRI(n, R, Z);
+			S.push_back(SRI(R, Z, Namelist(labels)));
+		}
+
+		SRI sequential(S[0]);
+		for (unsigned int k = 1; k < S.size(); k++)
+			sequential += S[k];
+
+		for (unsigned int nthreads = 1; nthreads <= 3; nthreads += 2)
+		{
+			vector<SRI> T(S);
+			SRI tree = SRI::treeMerge(T, nthreads);
+
+			CPPUNIT_ASSERT(identical(sequential.getNames(), tree.getNames()));
+			Matrix<double> I1, I2;
+			Vector<double> b1, b2;
+			information(sequential.getR(), sequential.getZ(), I1, b1);
+			information(tree.getR(), tree.getZ(), I2, b2);
+			for (unsigned int i = 0; i < I1.rows(); i++)
+			{
+				for (unsigned int j = 0; j < I1.cols(); j++)
+					CPPUNIT_ASSERT_DOUBLES_EQUAL(I1(i,j), I2(i,j), 1.e-10 * std::max(1.0, std::fabs(I1(i,j))));
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(b1(i), b2(i), 1.e-10 * std::max(1.0, std::fabs(b1(i))));
+			}
+		}
+	}
+}
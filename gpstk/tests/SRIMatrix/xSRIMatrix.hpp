@@ -0,0 +1,66 @@
+// file: xSRIMatrix.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+#ifndef XSRIMATRIX_HPP
+#define XSRIMATRIX_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SRI.hpp"
+#include "SRIMatrix.hpp"
+
+
+using namespace std;
+
+
+class xSRIMatrix: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xSRIMatrix);
+	CPPUNIT_TEST (blockUpdateTest);
+	CPPUNIT_TEST (largeUpdateTest);
+	CPPUNIT_TEST (mergeTest);
+	CPPUNIT_TEST (treeMergeTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Sets up test enviornment
+
+	protected:
+		void blockUpdateTest (void);
+		void largeUpdateTest (void);
+		void mergeTest (void);
+		void treeMergeTest (void);
+
+	private:
+		unsigned long seed;
+		double random (void);
+		void randomSRI (unsigned int n, gpstk::Matrix<double>& R, gpstk::Vector<double>& Z);
+		void checkUpdate (unsigned int n, unsigned int m, unsigned int extra, unsigned int nb);
+
+};
+
+#endif
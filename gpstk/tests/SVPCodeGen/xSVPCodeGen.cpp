@@ -0,0 +1,133 @@
+// file: xSVPCodeGen.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#include "xSVPCodeGen.hpp"
+
+#include "GPSWeekZcount.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xSVPCodeGen);
+
+using namespace gpstk;
+
+void xSVPCodeGen :: setUp (void)
+{
+		// Only once per program; later calls throw
+	try
+	{
+		X1Sequence::allocateMemory();
+		X2Sequence::allocateMemory();
+	}
+	catch (Exception& e)
+	{}
+}
+
+/*
+**** The six seconds of P-code of a PRN starting at a Z-count, a word at a
+**** time, as getCurrentSixSeconds() made them before it took two words at
+**** a time through X2Sequence::get64()
+*/
+static void oldSixSeconds (int PRNID, long X1count, CodeBuffer& pcb)
+{
+	X1Sequence X1Seq;
+	X2Sequence X2Seq;
+	long X2count;
+
+	if (X1count == 0 && PRNID <= 37)
+		X2count = -PRNID;
+	else
+	{
+		int dayAdvance = (PRNID - 1) / 37;
+		int EffPRNID = PRNID - dayAdvance * 37;
+		long cumulativeX2Delay = X1count * X2A_EPOCH_DELAY
+			+ dayAdvance * X1_PER_DAY * X2A_EPOCH_DELAY + EffPRNID;
+		X2count = MAX_X2_TEST - cumulativeX2Delay;
+		if (X2count < 0)
+			X2count += MAX_X2_TEST;
+	}
+
+	X2Seq.setEOWX2Epoch(X1count == 403200 - 4);
+
+	for (long i = 0; i < NUM_6SEC_WORDS; ++i)
+	{
+		pcb[i] = X1Seq[i] ^ X2Seq[X2count];
+		X2count += MAX_BIT;
+		if (X2count >= MAX_X2_TEST)
+			X2count -= MAX_X2_TEST;
+	}
+}
+
+/*
+**** get64(i) is operator[](i) followed by the 32 bits after it, wrapped
+**** back by MAX_X2_TEST, at the start of the week, in the middle of the
+**** sequence and across its end, for the regular and end of week epochs
+*/
+void xSVPCodeGen :: get64Test (void)
+{
+	X2Sequence X2Seq;
+	for (int eow = 0; eow < 2; eow++)
+	{
+		X2Seq.setEOWX2Epoch(eow == 1);
+
+		long starts[] = { -37, 1000003, MAX_X2_TEST / 2, MAX_X2_TEST - 200 };
+		long counts[] = { 200, 100, 100, 200 };
+		for (int s = 0; s < 4; s++)
+			for (long i = starts[s]; i < starts[s] + counts[s]; i++)
+			{
+				long next = i + MAX_BIT;
+				if (next >= MAX_X2_TEST)
+					next -= MAX_X2_TEST;
+				uint64_t expected = (uint64_t(X2Seq[i]) << MAX_BIT) | X2Seq[next];
+				CPPUNIT_ASSERT(X2Seq.get64(i) == expected);
+			}
+	}
+}
+
+/*
+**** getCurrentSixSeconds() gives the buffers of the word at a time loop at
+**** the start of the week, mid-week and the last (end of week) X2 epoch,
+**** for PRNs with and without the day advance
+*/
+void xSVPCodeGen :: sixSecondsTest (void)
+{
+	const int prns[] = { 1, 23, 37, 38, 100 };
+	const long zcounts[] = { 0, 201600, 403200 - 4 };
+
+	for (int p = 0; p < 5; p++)
+		for (int z = 0; z < 3; z++)
+		{
+			CodeBuffer expected(prns[p]), buffer(prns[p]);
+			oldSixSeconds(prns[p], zcounts[z], expected);
+
+			SVPCodeGen svp(prns[p], GPSWeekZcount(1498, zcounts[z]));
+			svp.getCurrentSixSeconds(buffer);
+
+			long bad = 0;
+			for (long i = 0; i < NUM_6SEC_WORDS; i++)
+				if (buffer[i] != expected[i])
+					bad++;
+			CPPUNIT_ASSERT_EQUAL(0L, bad);
+		}
+}
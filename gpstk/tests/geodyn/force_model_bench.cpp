@@ -0,0 +1,436 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file force_model_bench.cpp
+ *
+ * Times the evaluation of the equations of motion (SatOrbit::getDerivatives)
+ * for several satellites at the same epochs, as a Runge-Kutta-Fehlberg 7(8)
+ * integration of all of them would do, and reports force evaluations per
+ * second with and without the precession-nutation cache of ReferenceFrames.
+ * Also checks that the cached celestial-to-terrestrial matrix agrees with
+ * the directly evaluated one, and compares the propagation of all the
+ * satellites by ConstellationPropagator with that of SatOrbitPropagator,
+ * one satellite at a time: results and wall-clock time. Finally compares
+ * SphericalHarmonicGravity::gravityBatch() with the evaluation of one
+ * position at a time.
+ */
+
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <sys/time.h>
+
+#include "StringUtils.hpp"
+#include "Logger.hpp"
+#include "IERS.hpp"
+#include "ReferenceFrames.hpp"
+#include "SatOrbit.hpp"
+#include "SatOrbitPropagator.hpp"
+#include "ConstellationPropagator.hpp"
+#include "JGM3GravityModel.hpp"
+#include "BasicFramework.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+   /// Gives access to SphericalHarmonicGravity::computeVW()
+class BenchGravity : public JGM3GravityModel
+{
+public:
+   BenchGravity(int n, int m) : JGM3GravityModel(n, m) {}
+
+   void harmonics(const Vector<double>& r, const Matrix<double>& E)
+      { computeVW(r, E); }
+};
+
+class ForceModelBench : public BasicFramework
+{
+public:
+
+   ForceModelBench(char* arg0);
+
+   virtual ~ForceModelBench() {};
+
+   virtual bool initialize(int argc, char *argv[]) throw();
+
+      /// Number of failed checks
+   unsigned long failures() const
+      { return nfail; }
+
+protected:
+
+   virtual void process();
+
+      /// Evaluate the derivatives of every satellite at the stage epochs of
+      /// nsteps integration steps; return the number of evaluations per
+      /// second.
+   double timeEvaluations(int nsteps);
+
+      /// Largest element difference between cached and direct
+      /// J2kToECEFMatrix() over a day
+   double matrixDifference();
+
+      /// Propagate all the satellites over nsteps steps with
+      /// SatOrbitPropagator and with ConstellationPropagator, check that
+      /// the results agree, and report the times.
+   void comparePropagators(int nsteps);
+
+      /// Evaluate the geopotential at the positions of all the satellites,
+      /// one at a time and in one batch; check that the results agree and
+      /// report the times.
+   void compareGravityBatch();
+
+      /// EOP file (IERS finals.data)
+   CommandOptionWithAnyArg eopOpt;
+
+      /// Number of satellites
+   CommandOptionWithNumberArg satOpt;
+
+      /// Number of integration steps
+   CommandOptionWithNumberArg stepsOpt;
+
+      /// Degree and order of the geopotential
+   CommandOptionWithNumberArg degreeOpt;
+
+      /// Threads of ConstellationPropagator
+   CommandOptionWithNumberArg threadsOpt;
+
+   int degree;
+
+   UTCTime utc0;
+
+   vector<SatOrbit*> orbits;
+
+   vector< Vector<double> > states;
+
+   unsigned long nfail;
+
+}; // class ForceModelBench
+
+
+//---------------------------------------------------------------------------
+ForceModelBench::ForceModelBench(char* arg0)
+   : BasicFramework(arg0, "Times force evaluations for several satellites "
+                    "with and without the precession-nutation cache"),
+     eopOpt('e', "eop", "EOP file (IERS finals.data); without it the EOP "
+            "are taken as zero"),
+     satOpt('n', "satellites", "Number of satellites (default 8)"),
+     stepsOpt('s', "steps", "Number of integration steps (default 20)"),
+     degreeOpt('g', "degree", "Degree and order of the JGM3 geopotential "
+               "(default 12)"),
+     threadsOpt('t', "threads", "Threads propagating the satellites "
+                "(default one per processor)"),
+     utc0(2010, 6, 1, 0, 0, 0.0),
+     nfail(0)
+{
+}
+
+
+//---------------------------------------------------------------------------
+bool ForceModelBench::initialize(int argc, char *argv[]) throw()
+{
+   if(!BasicFramework::initialize(argc, argv)) return false;
+
+   try
+   {
+      if(eopOpt.getCount())
+         IERS::loadIERSFile(eopOpt.getValue()[0]);
+      else
+         Logger::get("").setLevel(LEVEL_ERROR);
+   }
+   catch(Exception& e)
+   {
+      cerr << e << endl;
+      return false;
+   }
+
+   int nsat(satOpt.getCount() ? asInt(satOpt.getValue()[0]) : 8);
+   degree = (degreeOpt.getCount() ? asInt(degreeOpt.getValue()[0]) : 12);
+
+      // GPS-like circular orbits in six planes
+   const double a(26560.0e3), v(std::sqrt(3.986004418e14 / a));
+   const double inc(55.0 * PI / 180.0);
+   for(int i=0; i<nsat; i++)
+   {
+      SatOrbit *orbit = new SatOrbit;
+      orbit->setRefEpoch(utc0);
+      orbit->enableGeopotential(SatOrbit::GM_JGM3, degree, degree,
+                                false, false, false);
+      orbits.push_back(orbit);
+
+      double node(i * PI / 3.0), u(i * 0.7);
+      double cn(std::cos(node)), sn(std::sin(node));
+      double ci(std::cos(inc)), si(std::sin(inc));
+      double cu(std::cos(u)), su(std::sin(u));
+
+         // position, velocity, then the identity for dr/dr0 and dv/dv0
+      Vector<double> y(42, 0.0);
+      y(0) = a * (cn * cu - sn * su * ci);
+      y(1) = a * (sn * cu + cn * su * ci);
+      y(2) = a * su * si;
+      y(3) = v * (-cn * su - sn * cu * ci);
+      y(4) = v * (-sn * su + cn * cu * ci);
+      y(5) = v * cu * si;
+      for(int j=0; j<3; j++)
+      {
+         y(6 + 4*j) = 1.0;
+         y(24 + 4*j + 9) = 1.0;
+      }
+      states.push_back(y);
+   }
+
+   return true;
+}
+
+
+//---------------------------------------------------------------------------
+double ForceModelBench::timeEvaluations(int nsteps)
+{
+      // stage nodes of RKF 7(8)
+   const double c[13] = { 0.0, 2.0/27.0, 1.0/9.0, 1.0/6.0, 5.0/12.0, 0.5,
+                          5.0/6.0, 1.0/6.0, 2.0/3.0, 1.0/3.0, 1.0, 0.0,
+                          1.0 };
+   const double step(60.0);
+
+   unsigned long count(0);
+   clock_t start(::clock());
+   for(int k=0; k<nsteps; k++)
+   {
+      for(int s=0; s<13; s++)
+      {
+         double t((k + c[s]) * step);
+         for(size_t i=0; i<orbits.size(); i++)
+         {
+            Vector<double> dy = orbits[i]->getDerivatives(t, states[i]);
+            count++;
+         }
+      }
+   }
+   double seconds = double(::clock() - start) / CLOCKS_PER_SEC;
+
+   return (seconds > 0.0 ? count / seconds : 0.0);
+}
+
+
+//---------------------------------------------------------------------------
+double ForceModelBench::matrixDifference()
+{
+   double maxdiff(0.0);
+   for(int i=0; i<1000; i++)
+   {
+      UTCTime utc(utc0);
+      utc += i * 86.4 + 0.123;
+
+      ReferenceFrames::setPrecessionNutationCache(false);
+      Matrix<double> direct = ReferenceFrames::J2kToECEFMatrix(utc);
+      ReferenceFrames::setPrecessionNutationCache(true);
+      Matrix<double> cached = ReferenceFrames::J2kToECEFMatrix(utc);
+
+      for(int r=0; r<3; r++)
+         for(int c=0; c<3; c++)
+            maxdiff = std::max(maxdiff, std::fabs(direct(r,c) - cached(r,c)));
+   }
+   return maxdiff;
+}
+
+
+//---------------------------------------------------------------------------
+static double wallClock()
+{
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1.e-6;
+}
+
+
+//---------------------------------------------------------------------------
+void ForceModelBench::comparePropagators(int nsteps)
+{
+   const double step(60.0), tf(nsteps * step);
+   const size_t nsat(orbits.size());
+
+   vector< Vector<double> > single(nsat);
+   double start(wallClock());
+   for(size_t i=0; i<nsat; i++)
+   {
+      SatOrbitPropagator sop;
+      sop.getSatOrbitPointer()->enableGeopotential(SatOrbit::GM_JGM3,
+                                                   degree, degree);
+      sop.setInitState(utc0, states[i]);
+      sop.setStepSize(step);
+      sop.integrateTo(tf);
+      single[i] = sop.getCurState();
+   }
+   double singleTime(wallClock() - start);
+
+   ConstellationPropagator cp;
+   cp.setInitEpoch(utc0);
+   cp.setStepSize(step);
+   if(threadsOpt.getCount())
+      cp.setNumThreads(asInt(threadsOpt.getValue()[0]));
+   for(size_t i=0; i<nsat; i++)
+   {
+      int k = cp.addSatellite(states[i]);
+      cp.getSatOrbit(k).enableGeopotential(SatOrbit::GM_JGM3, degree, degree);
+   }
+   start = wallClock();
+   cp.integrateTo(tf);
+   double batchTime(wallClock() - start);
+
+      // relative difference of the whole state
+   double maxdiff(0.0);
+   for(size_t i=0; i<nsat; i++)
+   {
+      Vector<double> y = cp.getCurState(i);
+      for(size_t j=0; j<y.size(); j++)
+         maxdiff = std::max(maxdiff, std::fabs(y(j) - single[i](j))
+                            / std::max(1.0, std::fabs(single[i](j))));
+   }
+
+   cout << "Largest relative difference of ConstellationPropagator: "
+        << maxdiff << endl;
+   if(maxdiff > 1.e-12)
+   {
+      nfail++;
+      cout << " FAIL - the propagators differ by more than 1e-12" << endl;
+   }
+
+   cout << "Propagation of " << nsat << " satellites over " << nsteps
+        << " steps: one at a time " << asString(singleTime, 3)
+        << " s, together " << asString(batchTime, 3) << " s" << endl;
+}
+
+
+//---------------------------------------------------------------------------
+void ForceModelBench::compareGravityBatch()
+{
+   const size_t nsat(orbits.size());
+   const int reps(200);
+
+   BenchGravity grav(degree, degree);
+   Matrix<double> E = ReferenceFrames::J2kToECEFMatrix(utc0);
+
+   vector< Vector<double> > r(nsat);
+   for(size_t i=0; i<nsat; i++)
+   {
+      r[i].resize(3);
+      for(int j=0; j<3; j++)
+         r[i](j) = states[i](j);
+   }
+
+   vector< Vector<double> > a1(nsat), a2;
+   vector< Matrix<double> > g1(nsat), g2;
+
+   double start(wallClock());
+   for(int k=0; k<reps; k++)
+   {
+      for(size_t i=0; i<nsat; i++)
+      {
+         grav.harmonics(r[i], E);
+         a1[i] = grav.gravity(r[i], E);
+         g1[i] = grav.gravityGradient(r[i], E);
+      }
+   }
+   double singleTime(wallClock() - start);
+
+   start = wallClock();
+   for(int k=0; k<reps; k++)
+      grav.gravityBatch(r, E, a2, g2);
+   double batchTime(wallClock() - start);
+
+   double maxdiff(0.0);
+   for(size_t i=0; i<nsat; i++)
+   {
+      double as(norm(a1[i])), gs(0.0);
+      for(int j=0; j<9; j++)
+         gs = std::max(gs, std::fabs(g1[i](j/3, j%3)));
+      for(int j=0; j<3; j++)
+         maxdiff = std::max(maxdiff, std::fabs(a1[i](j) - a2[i](j)) / as);
+      for(int j=0; j<9; j++)
+         maxdiff = std::max(maxdiff,
+                            std::fabs(g1[i](j/3, j%3) - g2[i](j/3, j%3)) / gs);
+   }
+
+   cout << "Largest relative difference of gravityBatch: " << maxdiff
+        << endl;
+   if(maxdiff > 1.e-13)
+   {
+      nfail++;
+      cout << " FAIL - gravityBatch differs by more than 1e-13" << endl;
+   }
+
+   double evals(double(reps) * nsat);
+   cout << "Geopotential " << degree << "x" << degree << " with gradient, "
+        << "evaluations per second: one at a time "
+        << asString(evals / singleTime, 0) << ", batch "
+        << asString(evals / batchTime, 0) << endl;
+}
+
+
+//---------------------------------------------------------------------------
+void ForceModelBench::process()
+{
+   int nsteps(stepsOpt.getCount() ? asInt(stepsOpt.getValue()[0]) : 20);
+
+   double maxdiff = matrixDifference();
+   cout << "Largest difference of cached J2kToECEFMatrix: " << maxdiff
+        << endl;
+   if(maxdiff > 1.e-13)
+   {
+      nfail++;
+      cout << " FAIL - the cached matrix differs by more than 1e-13" << endl;
+   }
+
+   ReferenceFrames::setPrecessionNutationCache(false);
+   double direct = timeEvaluations(nsteps);
+   ReferenceFrames::setPrecessionNutationCache(true);
+   double cached = timeEvaluations(nsteps);
+
+   cout << "Force evaluations per second (" << orbits.size()
+        << " satellites): direct " << asString(direct, 0)
+        << ", cached " << asString(cached, 0) << endl;
+
+   comparePropagators(nsteps);
+
+   compareGravityBatch();
+
+   for(size_t i=0; i<orbits.size(); i++)
+      delete orbits[i];
+   orbits.clear();
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   ForceModelBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return (app.failures() > 0 ? 1 : 0);
+}
@@ -0,0 +1,235 @@
+// file: xConstellationPropagator.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+#include "xConstellationPropagator.hpp"
+
+#include "Logger.hpp"
+
+#include <cmath>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xConstellationPropagator);
+
+using namespace gpstk;
+
+	// Degree and order of the geopotential, step size and number of steps
+static const int degree = 8;
+static const double stepSize = 60.0;
+static const int nsteps = 10;
+
+/*
+**** Propagate one satellite with SatOrbitPropagator.
+*/
+static Vector<double> propagateOne (const UTCTime& utc0, const Vector<double>& y)
+{
+	SatOrbitPropagator sop;
+	sop.getSatOrbitPointer()->enableGeopotential(SatOrbit::GM_JGM3, degree, degree);
+	sop.setInitState(utc0, y);
+	sop.setStepSize(stepSize);
+	sop.integrateTo(nsteps * stepSize);
+	return sop.getCurState();
+}
+
+/*
+**** Propagate all the satellites with ConstellationPropagator.
+*/
+static vector< Vector<double> > propagateAll (const UTCTime& utc0,
+	const vector< Vector<double> >& y, unsigned int nthreads)
+{
+	ConstellationPropagator cp;
+	cp.setInitEpoch(utc0);
+	cp.setStepSize(stepSize);
+	cp.setNumThreads(nthreads);
+	for (size_t i = 0; i < y.size(); i++)
+	{
+		int k = cp.addSatellite(y[i]);
+		cp.getSatOrbit(k).enableGeopotential(SatOrbit::GM_JGM3, degree, degree);
+	}
+	cp.integrateTo(nsteps * stepSize);
+
+	vector< Vector<double> > out;
+	for (size_t i = 0; i < y.size(); i++)
+		out.push_back(cp.getCurState(i));
+	return out;
+}
+
+/*
+**** Check that two states agree to 1e-12, relative.
+*/
+static void checkSameState (const Vector<double>& a, const Vector<double>& b)
+{
+	CPPUNIT_ASSERT_EQUAL(a.size(), b.size());
+	for (size_t j = 0; j < a.size(); j++)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(a(j), b(j), 1.e-12 * std::max(1.0, std::fabs(a(j))));
+}
+
+void xConstellationPropagator :: setUp (void)
+{
+		// no EOP are loaded; they are taken as zero, which is logged
+	Logger::get("").setLevel(LEVEL_ERROR);
+
+		// GPS-like circular orbits in four planes, with the identity for
+		// dr/dr0 and dv/dv0
+	const double a(26560.0e3), v(std::sqrt(3.986004418e14 / a));
+	const double inc(55.0 * ASConstant::PI / 180.0);
+	states.clear();
+	for (int i = 0; i < 4; i++)
+	{
+		double node(i * ASConstant::PI / 2.0), u(i * 0.7);
+		double cn(std::cos(node)), sn(std::sin(node));
+		double ci(std::cos(inc)), si(std::sin(inc));
+		double cu(std::cos(u)), su(std::sin(u));
+
+		Vector<double> y(42, 0.0);
+		y(0) = a * (cn * cu - sn * su * ci);
+		y(1) = a * (sn * cu + cn * su * ci);
+		y(2) = a * su * si;
+		y(3) = v * (-cn * su - sn * cu * ci);
+		y(4) = v * (-sn * su + cn * cu * ci);
+		y(5) = v * cu * si;
+		for (int j = 0; j < 3; j++)
+		{
+			y(6 + 4*j) = 1.0;
+			y(33 + 4*j) = 1.0;
+		}
+		states.push_back(y);
+	}
+}
+
+/*
+**** The satellites stepped together, in this thread or on two, end in the
+**** states SatOrbitPropagator gives one at a time.
+*/
+void xConstellationPropagator :: sameAsSatOrbitPropagatorTest (void)
+{
+	UTCTime utc0(2010, 6, 1, 0, 0, 0.0);
+
+	vector< Vector<double> > serial = propagateAll(utc0, states, 1);
+	vector< Vector<double> > parallel = propagateAll(utc0, states, 2);
+	for (size_t i = 0; i < states.size(); i++)
+	{
+		Vector<double> single = propagateOne(utc0, states[i]);
+		checkSameState(single, serial[i]);
+		checkSameState(single, parallel[i]);
+	}
+}
+
+#ifndef _WIN32
+	// A propagation run on its own thread
+struct PropagationJob
+{
+	UTCTime utc0;
+	const vector< Vector<double> >* states;
+	vector< Vector<double> > result;
+	bool failed;
+};
+
+static void* runPropagation (void* arg)
+{
+	PropagationJob* job = static_cast<PropagationJob*>(arg);
+	try
+	{
+		job->result = propagateAll(job->utc0, *job->states, 2);
+	}
+	catch (...)
+	{
+		job->failed = true;
+	}
+	return 0;
+}
+#endif
+
+/*
+**** Two propagators running at once, over different epochs, each keep the
+**** environment they share with ReferenceFrames, and get the results each
+**** gets alone.
+*/
+void xConstellationPropagator :: concurrentPropagatorsTest (void)
+{
+#ifndef _WIN32
+	PropagationJob jobs[2];
+	jobs[0].utc0 = UTCTime(2010, 6, 1, 0, 0, 0.0);
+	jobs[1].utc0 = UTCTime(2010, 6, 1, 0, 0, 30.0);
+	pthread_t threads[2];
+	for (int k = 0; k < 2; k++)
+	{
+		jobs[k].states = &states;
+		jobs[k].failed = false;
+		CPPUNIT_ASSERT_EQUAL(0, pthread_create(&threads[k], 0, runPropagation, &jobs[k]));
+	}
+	for (int k = 0; k < 2; k++)
+		pthread_join(threads[k], 0);
+
+	for (int k = 0; k < 2; k++)
+	{
+		CPPUNIT_ASSERT(!jobs[k].failed);
+		for (size_t i = 0; i < states.size(); i++)
+			checkSameState(propagateOne(jobs[k].utc0, states[i]), jobs[k].result[i]);
+	}
+#endif
+}
+
+	// Gives access to SatOrbitPropagator::setState()
+class StatePropagator : public SatOrbitPropagator
+{
+public:
+	void set (const Vector<double>& y)
+	{ setState(y); }
+};
+
+/*
+**** updateMatrix() takes every element of dr/dp0 and dv/dp0 from the
+**** state into the sensitivity matrix.
+*/
+void xConstellationPropagator :: updateMatrixTest (void)
+{
+	const int np = 2;
+	Vector<double> y(42 + 6*np);
+	for (size_t j = 0; j < y.size(); j++)
+		y(j) = 1.0 + 0.25 * j;
+
+	StatePropagator sp;
+	sp.set(y);
+
+	Matrix<double> phi = sp.transitionMatrix();
+	Matrix<double> s = sp.sensitivityMatrix();
+	CPPUNIT_ASSERT_EQUAL((size_t)6, s.rows());
+	CPPUNIT_ASSERT_EQUAL((size_t)np, s.cols());
+	for (int r = 0; r < 3; r++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			CPPUNIT_ASSERT_EQUAL(y(6 + 3*r + c), phi(r, c));
+			CPPUNIT_ASSERT_EQUAL(y(33 + 3*np + 3*r + c), phi(3 + r, 3 + c));
+		}
+		for (int i = 0; i < np; i++)
+		{
+			CPPUNIT_ASSERT_EQUAL(y(24 + r*np + i), s(r, i));
+			CPPUNIT_ASSERT_EQUAL(y(42 + 3*np + r*np + i), s(3 + r, i));
+		}
+	}
+}
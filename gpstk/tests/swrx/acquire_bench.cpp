@@ -0,0 +1,275 @@
+#pragma ident "$Id$"
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//============================================================================
+
+/**
+ * @file acquire_bench.cpp
+ *
+ * Searches all 32 PRNs with the FFTAcquirer of apps/swrx and reports
+ * acquisitions (one PRN over every Doppler bin) per second: the first
+ * search, which also makes the FFT plans and the code spectra, and the
+ * following ones, with one thread and with several. The input is gpsSim
+ * output (-i), or else a few C/A signals simulated here as gpsSim would,
+ * with its default amplitudes and noise. The checks of the results, and
+ * of one against several threads, are in the xFFTAcquirer test.
+ *
+ * Like acquire, this links to FFTW:
+ *
+ * g++ -O -I../../apps/swrx -I../../src acquire_bench.cpp
+ *    ../../apps/swrx/FFTAcquirer.cpp ../../apps/swrx/simlib.a
+ *    ../../src/libgpstk.a -lfftw3 -lm -lpthread
+ */
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <sys/time.h>
+
+#include "StringUtils.hpp"
+#include "GNSSconstants.hpp"
+#include "BasicFramework.hpp"
+#include "CACodeGenerator.hpp"
+#include "IQStream.hpp"
+#include "normal.hpp"
+#include "FFTAcquirer.hpp"
+
+using namespace std;
+using namespace gpstk;
+using namespace gpstk::StringUtils;
+
+   /// One simulated signal
+struct SimSignal
+{
+   int prn;
+   double offset;       ///< code offset, in chips
+   double doppler;      ///< Hz
+};
+
+
+class AcquireBench : public BasicFramework
+{
+public:
+
+   AcquireBench(char* arg0);
+
+   virtual ~AcquireBench() {};
+
+   virtual bool initialize(int argc, char *argv[]) throw();
+
+      /// 1 if the input was too short
+   unsigned long failures() const
+      { return nfail; }
+
+protected:
+
+   virtual void process();
+
+      /// Fill 'samples' with the C/A signals in 'signals', plus noise
+   void simulate(vector< complex<float> >& samples);
+
+      /// Search all the PRNs 'runs' times with one acquirer of 'threads'
+      /// threads, and report the rates
+   void timeSearch(const vector< complex<float> >& s, unsigned threads,
+                   int runs);
+
+      /// gpsSim output; without it the signals are simulated here
+   CommandOptionWithAnyArg inputOpt;
+
+      /// Complex samples per epoch of the input
+   CommandOptionWithNumberArg bandsOpt;
+
+      /// Sample rate and IF, in MHz
+   CommandOptionWithAnyArg rateOpt, ifOpt;
+
+      /// Number of blocks accumulated non-coherently
+   CommandOptionWithNumberArg blocksOpt;
+
+      /// Threads of the parallel searches
+   CommandOptionWithNumberArg threadsOpt;
+
+      /// Number of timed searches
+   CommandOptionWithNumberArg runsOpt;
+
+   double sampleRate, interFreq;
+
+   int blocks;
+
+   vector<SimSignal> signals;
+
+   unsigned long nfail;
+
+}; // class AcquireBench
+
+
+//---------------------------------------------------------------------------
+AcquireBench::AcquireBench(char* arg0)
+   : BasicFramework(arg0, "Times the search of all the C/A codes by "
+                    "FFTAcquirer, with one and several threads"),
+     inputOpt('i', "input", "gpsSim output, in floats; without it C/A "
+              "signals are simulated"),
+     bandsOpt('b', "bands", "Complex samples per epoch of the input "
+              "(default 2)"),
+     rateOpt('r', "rate", "Sample rate in MHz (default 5)"),
+     ifOpt('x', "inter-freq", "Intermediate frequency in MHz (default 1.25)"),
+     blocksOpt('n', "non-coherent", "Number of 1 ms blocks summed "
+               "non-coherently (default 4)"),
+     threadsOpt('t', "threads", "Threads of the parallel searches (default "
+                "one per processor, at least 2)"),
+     runsOpt('c', "count", "Number of timed searches (default 3)"),
+     sampleRate(5e6), interFreq(1.25e6), blocks(4), nfail(0)
+{
+}
+
+
+//---------------------------------------------------------------------------
+bool AcquireBench::initialize(int argc, char *argv[]) throw()
+{
+   if(!BasicFramework::initialize(argc, argv)) return false;
+
+   if(rateOpt.getCount())
+      sampleRate = asDouble(rateOpt.getValue()[0]) * 1e6;
+   if(ifOpt.getCount())
+      interFreq = asDouble(ifOpt.getValue()[0]) * 1e6;
+   if(blocksOpt.getCount())
+      blocks = asInt(blocksOpt.getValue()[0]);
+
+   SimSignal sim[] = { { 3, 101.5, -3200.0 }, { 11, 512.25, 1400.0 },
+                       { 21, 866.0, 4800.0 }, { 29, 17.75, -600.0 } };
+   signals.assign(sim, sim + sizeof(sim) / sizeof(sim[0]));
+
+   return true;
+}
+
+
+//---------------------------------------------------------------------------
+static double wallClock()
+{
+   struct timeval tv;
+   ::gettimeofday(&tv, 0);
+   return tv.tv_sec + tv.tv_usec * 1.e-6;
+}
+
+
+//---------------------------------------------------------------------------
+void AcquireBench::simulate(vector< complex<float> >& samples)
+{
+      // gpsSim's default C/A amplitude and noise
+   const double amplitude(0.1767 * M_SQRT2), noise(2.805);
+   const double chipsPerSample(CA_CHIP_FREQ_GPS / sampleRate);
+
+   for(size_t n = 0; n < samples.size(); n++)
+      samples[n] = complex<float>(generate_normal_rv() * noise,
+                                  generate_normal_rv() * noise);
+
+   for(size_t i = 0; i < signals.size(); i++)
+   {
+      CACodeGenerator gen(signals[i].prn);
+      vector<double> chips(1023);
+      for(int k = 0; k < 1023; k++, ++gen) chips[k] = *gen ? 1.0 : -1.0;
+
+      const double cycles((interFreq + signals[i].doppler) / sampleRate);
+      for(size_t n = 0; n < samples.size(); n++)
+      {
+         double chip(::fmod(signals[i].offset + n * chipsPerSample, 1023.0));
+         double phase(2 * PI * ::fmod(cycles * n, 1.0));
+         samples[n] += complex<float>(polar(amplitude * chips[int(chip)],
+                                            phase));
+      }
+   }
+}
+
+
+//---------------------------------------------------------------------------
+void AcquireBench::timeSearch(const vector< complex<float> >& s,
+                              unsigned threads, int runs)
+{
+   vector<int> prns;
+   for(int prn = 1; prn <= 32; prn++) prns.push_back(prn);
+
+   vector<FFTAcquirer::Result> results;
+
+   double start(wallClock());
+   FFTAcquirer acq(sampleRate, interFreq, 20000, 200, 1, blocks, threads);
+   acq.search(&s[0], prns, results);
+   double first(wallClock() - start);
+
+   start = wallClock();
+   for(int r = 0; r < runs; r++) acq.search(&s[0], prns, results);
+   double rest((wallClock() - start) / runs);
+
+   cout << rightJustify(asString(threads), 8)
+        << rightJustify(asString(prns.size() / first, 1), 14)
+        << rightJustify(asString(prns.size() / rest, 1), 14)
+        << rightJustify(asString(1000.0 * rest, 1), 12) << endl;
+}
+
+
+//---------------------------------------------------------------------------
+void AcquireBench::process()
+{
+   const size_t numSamples(size_t(sampleRate * 1e-3) * blocks);
+   vector< complex<float> > samples(numSamples);
+
+   if(inputOpt.getCount())
+   {
+      int bands(bandsOpt.getCount() ? asInt(bandsOpt.getValue()[0]) : 2);
+      IQFloatStream input(inputOpt.getValue()[0].c_str());
+      vector< complex<float> > all(numSamples * bands);
+      size_t n(input.readBlock(&all[0], all.size()));
+      if(n < all.size())
+      {
+         cout << "Only " << n << " samples in " << inputOpt.getValue()[0]
+              << ", " << all.size() << " needed" << endl;
+         nfail++;
+         return;
+      }
+      for(size_t k = 0; k < numSamples; k++) samples[k] = all[k * bands];
+   }
+   else
+      simulate(samples);
+
+   unsigned threads(threadsOpt.getCount() ?
+                    asInt(threadsOpt.getValue()[0]) :
+                    std::max(2U, ThreadPool::processorCount()));
+   int runs(runsOpt.getCount() ? asInt(runsOpt.getValue()[0]) : 3);
+
+   cout << "32 PRNs, 101 Doppler bins, " << blocks << " x 1 ms at "
+        << sampleRate * 1e-6 << " MHz" << endl
+        << " threads   first (acq/s)  next (acq/s)  next (ms)" << endl;
+
+   timeSearch(samples, 1, runs);
+   timeSearch(samples, threads, runs);
+}
+
+
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+   AcquireBench app(argv[0]);
+
+   if(!app.initialize(argc, argv))
+      return 0;
+
+   if(!app.run())
+      return 1;
+
+   return (app.failures() > 0 ? 1 : 0);
+}
@@ -0,0 +1,159 @@
+// file: xFFTAcquirer.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#include "xFFTAcquirer.hpp"
+
+#include <cmath>
+
+#include "GNSSconstants.hpp"
+#include "CACodeGenerator.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xFFTAcquirer);
+
+using namespace gpstk;
+
+	// The simulated signals: PRN, code offset in chips, Doppler in Hz
+static const int numSignals = 4;
+static const int simPrn[numSignals] = { 3, 11, 21, 29 };
+static const double simOffset[numSignals] = { 101.5, 512.25, 866.0, 17.75 };
+static const double simDoppler[numSignals] = { -3200.0, 1400.0, 4800.0, -600.0 };
+
+	// The search: 2048 samples a period, 41 bins of 250 Hz, 4 blocks
+static const double sampleRate = 2.048e6, interFreq = 0.5e6;
+
+void xFFTAcquirer :: setUp (void)
+{
+	seed = 12345;
+}
+
+	// Uniform in [-1,1), from a linear congruential generator
+double xFFTAcquirer :: random (void)
+{
+	seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+	return double(seed) / 1073741824.0 - 1.0;
+}
+
+	// Normal, by Box-Muller
+double xFFTAcquirer :: gaussian (void)
+{
+	double u1 = 0.5 * (random() + 1.0), u2 = 0.5 * (random() + 1.0);
+	if (u1 < 1e-300) u1 = 1e-300;
+	return ::sqrt(-2.0 * ::log(u1)) * ::cos(2.0 * M_PI * u2);
+}
+
+	// The C/A signals at the IF, in noise
+void xFFTAcquirer :: simulate (vector< complex<float> >& samples)
+{
+	for (size_t n = 0; n < samples.size(); n++)
+		samples[n] = complex<float>(gaussian(), gaussian());
+
+	const double chipsPerSample = CA_CHIP_FREQ_GPS / sampleRate;
+	for (int i = 0; i < numSignals; i++)
+	{
+		CACodeGenerator gen(simPrn[i]);
+		vector<double> chips(1023);
+		for (int k = 0; k < 1023; k++, ++gen)
+			chips[k] = *gen ? 0.3 : -0.3;
+
+		const double cycles = (interFreq + simDoppler[i]) / sampleRate;
+		for (size_t n = 0; n < samples.size(); n++)
+		{
+			double chip = ::fmod(simOffset[i] + n * chipsPerSample, 1023.0);
+			double phase = 2 * M_PI * ::fmod(cycles * n, 1.0);
+			samples[n] += complex<float>(polar(chips[int(chip)], phase));
+		}
+	}
+}
+
+	// Searches all the PRNs in the simulated signals
+void xFFTAcquirer :: search (unsigned threads, vector<FFTAcquirer::Result>& results)
+{
+	FFTAcquirer acq(sampleRate, interFreq, 10000, 250, 1, 4, threads);
+	vector< complex<float> > samples(acq.samplesNeeded());
+	simulate(samples);
+
+	vector<int> prns;
+	for (int prn = 1; prn <= 32; prn++)
+		prns.push_back(prn);
+	acq.search(&samples[0], prns, results);
+	CPPUNIT_ASSERT_EQUAL(prns.size(), results.size());
+}
+
+/*
+**** The simulated signals are found at their code phase and Doppler, above
+**** every PRN that is not there
+*/
+void xFFTAcquirer :: signalsTest (void)
+{
+	vector<FFTAcquirer::Result> results;
+	search(1, results);
+
+	const double period = sampleRate * 1e-3;
+	double weakest = 1e99, strongest = 0.0;
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const FFTAcquirer::Result& r = results[i];
+		CPPUNIT_ASSERT_EQUAL(int(i) + 1, r.prn);
+
+		int sim = -1;
+		for (int j = 0; j < numSignals; j++)
+			if (simPrn[j] == r.prn)
+				sim = j;
+		if (sim < 0)
+		{
+			strongest = std::max(strongest, r.height);
+			continue;
+		}
+		weakest = std::min(weakest, r.height);
+
+		double shift = simOffset[sim] * sampleRate / CA_CHIP_FREQ_GPS;
+		double dshift = ::fabs(::fmod(r.shift - shift + 1.5 * period, period)
+			- 0.5 * period);
+		CPPUNIT_ASSERT(dshift <= 1.0);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(simDoppler[sim], r.doppler, 250.0);
+	}
+	CPPUNIT_ASSERT(weakest > 1.5 * strongest);
+}
+
+/*
+**** One thread and several find the same peaks, bit for bit
+*/
+void xFFTAcquirer :: threadsTest (void)
+{
+	vector<FFTAcquirer::Result> one, several;
+	search(1, one);
+	seed = 12345;
+	search(3, several);
+
+	CPPUNIT_ASSERT_EQUAL(one.size(), several.size());
+	for (size_t i = 0; i < one.size(); i++)
+	{
+		CPPUNIT_ASSERT_EQUAL(one[i].prn, several[i].prn);
+		CPPUNIT_ASSERT_EQUAL(one[i].bin, several[i].bin);
+		CPPUNIT_ASSERT_EQUAL(one[i].shift, several[i].shift);
+		CPPUNIT_ASSERT(one[i].height == several[i].height);
+	}
+}
@@ -0,0 +1,394 @@
+// file: xswrx.cpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#include "xswrx.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "CACodeGenerator.hpp"
+#include "CACodeTable.hpp"
+#include "SVSource.hpp"
+#include "ThreadPool.hpp"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (xswrx);
+
+using namespace gpstk;
+
+void xswrx :: setUp (void)
+{
+	seed = 12345;
+}
+
+	// Uniform in [-1,1), from a linear congruential generator
+double xswrx :: random (void)
+{
+	seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+	return double(seed) / 1073741824.0 - 1.0;
+}
+
+	// Normal, by Box-Muller
+double xswrx :: gaussian (void)
+{
+	double u1 = 0.5 * (random() + 1.0), u2 = 0.5 * (random() + 1.0);
+	if (u1 < 1e-300) u1 = 1e-300;
+	return ::sqrt(-2.0 * ::log(u1)) * ::cos(2.0 * M_PI * u2);
+}
+
+	// One C/A signal at the IF, offset by 'offset' chips, plus noise
+void xswrx :: simulate (vector< complex<float> >& samples, double sampleRate,
+	double interFreq, int prn, double offset, double doppler)
+{
+	CACodeGenerator gen(prn);
+	vector<double> chips(1023);
+	for (int k = 0; k < 1023; k++, ++gen)
+		chips[k] = *gen ? 1.0 : -1.0;
+
+	const double chipsPerSample = CA_CHIP_FREQ_GPS / sampleRate;
+	const double cycles = (interFreq + doppler) / sampleRate;
+	for (size_t n = 0; n < samples.size(); n++)
+	{
+		double chip = ::fmod(offset + n * chipsPerSample, 1023.0);
+		double phase = 2 * M_PI * ::fmod(cycles * n, 1.0);
+		samples[n] = complex<float>(polar(chips[int(chip)], phase))
+			+ complex<float>(gaussian(), gaussian());
+	}
+}
+
+IQStream* xswrx :: newStream (char quantization, const char* fn,
+	ios::openmode mode)
+{
+	IQStream* s;
+	switch (quantization)
+	{
+		case '1': s = new IQ1Stream(); break;
+		case '2': s = new IQ2Stream(); break;
+		default:  s = new IQFloatStream(); break;
+	}
+	s->open(fn, mode);
+	return s;
+}
+
+	// All the samples of s, with >> if block is 0, else with readBlock() in
+	// blocks of alternately block and block+3 samples
+void xswrx :: readAll (IQStream& s, size_t block, vector< complex<float> >& v)
+{
+	v.clear();
+	complex<float> c;
+	if (block == 0)
+	{
+		while (s >> c)
+			v.push_back(c);
+		return;
+	}
+
+	vector< complex<float> > buf(block + 3);
+	for (size_t k = 0; ; k++)
+	{
+		size_t want = block + (k % 2) * 3;
+		size_t got = s.readBlock(&buf[0], want);
+		v.insert(v.end(), buf.begin(), buf.begin() + got);
+		if (got < want)
+		{
+			CPPUNIT_ASSERT(!s);
+			break;
+		}
+	}
+}
+
+static string fileContents (const char* fn)
+{
+	ifstream f(fn, ios::in | ios::binary);
+	return string(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+}
+
+/*
+**** For each quantization, writeBlock() writes the bytes writeComplex() does,
+**** and readBlock() reads the samples >> does, from a mapped file and from
+**** one that is not (opened for writing too)
+*/
+void xswrx :: iqStreamTest (void)
+{
+	const size_t n = 5000;
+	vector< complex<float> > v(n);
+	for (size_t i = 0; i < n; i++)
+		v[i] = complex<float>(3.0 * gaussian(), 3.0 * gaussian());
+
+	const char* fa = "xswrxSample.bin";
+	const char* fb = "xswrxBlock.bin";
+	const char quantizations[] = "12f";
+	for (int q = 0; q < 3; q++)
+	{
+		IQStream* a = newStream(quantizations[q], fa, ios::out);
+		for (size_t i = 0; i < n; i++)
+			*a << v[i];
+		delete a;
+
+		IQStream* b = newStream(quantizations[q], fb, ios::out);
+		b->writeBlock(&v[0], n);
+		delete b;
+
+		string bytes = fileContents(fa);
+		CPPUNIT_ASSERT(bytes.size() > 1000);
+		CPPUNIT_ASSERT(bytes == fileContents(fb));
+
+		vector< complex<float> > one, blocks;
+		IQStream* s = newStream(quantizations[q], fa, ios::in);
+		CPPUNIT_ASSERT(s->isMapped());
+		readAll(*s, 0, one);
+		delete s;
+		CPPUNIT_ASSERT(one.size() > n/2 && one.size() <= n);
+
+		size_t sizes[] = { 1, 7, 250, 999 };
+		for (int k = 0; k < 4; k++)
+		{
+			s = newStream(quantizations[q], fa, ios::in);
+			readAll(*s, sizes[k], blocks);
+			delete s;
+			CPPUNIT_ASSERT(blocks == one);
+
+			s = newStream(quantizations[q], fa, ios::in | ios::out);
+			CPPUNIT_ASSERT(!s->isMapped());
+			readAll(*s, sizes[k], blocks);
+			delete s;
+			CPPUNIT_ASSERT(blocks == one);
+		}
+
+		s = newStream(quantizations[q], fa, ios::in | ios::out);
+		readAll(*s, 0, blocks);
+		delete s;
+		CPPUNIT_ASSERT(blocks == one);
+	}
+
+	std::remove(fa);
+	std::remove(fb);
+}
+
+/*
+**** The block process() of EMLTracker dumps at the same samples as the per
+**** sample one, with the same loop states, and sums that only differ by the
+**** rounding of their float accumulation
+*/
+void xswrx :: trackerTest (void)
+{
+	const double sampleRate = 8.184e6, interFreq = 1.25e6;
+	const int prn = 15;
+	const double offset = 211.3, doppler = 1200.0;
+	vector< complex<float> > s(size_t(0.1 * sampleRate));
+	simulate(s, sampleRate, interFreq, prn, offset, doppler);
+
+	EMLTracker* tr[2];
+	for (int t = 0; t < 2; t++)
+	{
+		CCReplica* cc = new CCReplica(1.0 / sampleRate, CA_CHIP_FREQ_GPS,
+			interFreq, new CACodeGenerator(prn));
+		cc->moveCodePhase(offset - 0.2);
+		cc->setCodeFreqOffsetHz(doppler * CA_CHIP_FREQ_GPS / L1_FREQ_GPS);
+		cc->setCarrierFreqOffsetHz(doppler + 20.0);
+		tr[t] = new EMLTracker(*cc, 0.5 * cc->codeChipLen);
+		tr[t]->debugLevel = 0;
+	}
+
+	size_t k = 0;
+	int dumps = 0;
+	while (k < s.size())
+	{
+		size_t n = min<size_t>(tr[1]->samplesToDump(), s.size() - k);
+		bool dumped;
+		unsigned used = tr[1]->process(&s[k], n, dumped);
+		CPPUNIT_ASSERT(used > 0);
+
+		bool dumpedOne = false;
+		for (unsigned i = 0; i < used; i++)
+		{
+			CPPUNIT_ASSERT(!dumpedOne);
+			dumpedOne = tr[0]->process(complex<double>(s[k+i]));
+		}
+		CPPUNIT_ASSERT_EQUAL(dumpedOne, dumped);
+		k += used;
+		if (!dumped)
+			continue;
+
+		dumps++;
+		CPPUNIT_ASSERT_EQUAL(tr[0]->getDllMode(), tr[1]->getDllMode());
+		CPPUNIT_ASSERT_EQUAL(tr[0]->getPllMode(), tr[1]->getPllMode());
+		CPPUNIT_ASSERT_EQUAL(tr[0]->getNav(), tr[1]->getNav());
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(tr[0]->getPmag(), tr[1]->getPmag(),
+			1e-4 * tr[0]->getPmag());
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(tr[0]->getPromptPhase(),
+			tr[1]->getPromptPhase(), 1e-4);
+	}
+	CPPUNIT_ASSERT(dumps >= 90);
+	CPPUNIT_ASSERT(tr[1]->getDllMode() != EMLTracker::dmFar);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(
+		tr[0]->localReplica.getCodePhaseOffsetSec(),
+		tr[1]->localReplica.getCodePhaseOffsetSec(), 1e-10);
+
+	for (int t = 0; t < 2; t++)
+	{
+		CCReplica* cc = &tr[t]->localReplica;
+		delete tr[t];
+		delete cc;
+	}
+}
+
+	// Renders a part of an SV's samples, as gpsSim does in block mode
+class RenderTask : public ThreadPool::Task
+{
+public:
+	SVSource* src;
+	vector< complex<float> > samples;
+	virtual void run() throw()
+	{
+		samples.assign(samples.size(), complex<float>(0, 0));
+		src->render(&samples[0], samples.size());
+	}
+};
+
+/*
+**** SVSource::render() gives the samples of getSample() and incrementState(),
+**** exactly for the codes alone and within float rounding with the carrier;
+**** several SVs rendered on several threads give what one thread does
+*/
+void xswrx :: renderTest (void)
+{
+	const double zchipsPerSample = PY_CHIP_FREQ_GPS / 20e6;
+	const size_t n = 100000;
+	const int prns[] = { 3, 15, 29 };
+
+	for (int codeOnly = 1; codeOnly >= 0; codeOnly--)
+	{
+		SVSource a(15, 1), b(15, 1);
+		SVSource* src[] = { &a, &b };
+		for (int i = 0; i < 2; i++)
+		{
+			src[i]->zchips_per_sample = zchipsPerSample;
+			src[i]->doppler = 1500.0 / 20e6 / L1_MULT_GPS;
+			src[i]->code_only = (codeOnly == 1);
+			src[i]->slewZChipFraction(1234.5);
+		}
+
+		vector< complex<float> > block(n, complex<float>(0, 0));
+		b.render(&block[0], 40000);
+		b.render(&block[40000], n - 40000);
+		for (size_t k = 0; k < n; k++)
+		{
+			complex<float> one(a.getSample());
+			a.incrementState();
+			if (codeOnly)
+				CPPUNIT_ASSERT(one == block[k]);
+			else
+				CPPUNIT_ASSERT(abs(one - block[k]) < 1e-5);
+		}
+		CPPUNIT_ASSERT_EQUAL(a.p_codegen.getIndex(), b.p_codegen.getIndex());
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(a.zchip_fraction_accum,
+			b.zchip_fraction_accum, 1e-9);
+	}
+
+		// Two blocks of three SVs, on one thread and on three
+	vector< complex<float> > result[2];
+	for (int t = 0; t < 2; t++)
+	{
+		ThreadPool pool(t == 0 ? 1 : 3);
+		vector<SVSource*> svs;
+		vector<RenderTask> tasks(3);
+		for (int i = 0; i < 3; i++)
+		{
+			svs.push_back(new SVSource(prns[i], 1));
+			svs[i]->zchips_per_sample = zchipsPerSample;
+			svs[i]->doppler = (i - 1) * 2000.0 / 20e6 / L1_MULT_GPS;
+			tasks[i].src = svs[i];
+			tasks[i].samples.resize(n / 2);
+		}
+		for (int blk = 0; blk < 2; blk++)
+		{
+			for (int i = 0; i < 3; i++)
+				pool.submit(&tasks[i]);
+			pool.wait();
+			for (size_t k = 0; k < n / 2; k++)
+			{
+				complex<float> sum(0, 0);
+				for (int i = 0; i < 3; i++)
+					sum += tasks[i].samples[k];
+				result[t].push_back(sum);
+			}
+		}
+		for (int i = 0; i < 3; i++)
+			delete svs[i];
+	}
+	CPPUNIT_ASSERT(result[0] == result[1]);
+}
+
+/*
+**** CACodeTable::sample() gives the codes of the ticks of a CCReplica at
+**** the same rate, from the same phase, with less and more than a chip a
+**** sample; replica() gives those of a CCReplica from phase 0
+*/
+void xswrx :: caCodeTableTest (void)
+{
+	const double sampleRates[] = { 20e6, 8.184e6, 2.046e6, 0.7e6, 0.4e6 };
+	const double phases[] = { 0.0, 0.3, 1.0, 511.5, 1022.7 };
+	const int prns[] = { 1, 15, 32, 37 };
+
+	for (int p = 0; p < 4; p++)
+	{
+		const CACodeTable& table = CACodeTable::get(prns[p]);
+		CPPUNIT_ASSERT_EQUAL(prns[p], table.getPRN());
+
+		for (int r = 0; r < 5; r++)
+		{
+			const size_t n = size_t(3e-3 * sampleRates[r]);
+			vector<float> samples(n);
+			for (int f = 0; f < 5; f++)
+			{
+				CCReplica cc(1 / sampleRates[r], CA_CHIP_FREQ_GPS, 0.0,
+					new CACodeGenerator(prns[p]));
+				cc.moveCodePhase(phases[f]);
+				table.sample(&samples[0], n, cc.chipsPerTick, phases[f]);
+				for (size_t k = 0; k < n; k++)
+				{
+					CPPUNIT_ASSERT_EQUAL(cc.getCode() ? 1.0f : -1.0f, samples[k]);
+					cc.tick();
+				}
+			}
+
+			CCReplica cc(1 / sampleRates[r], CA_CHIP_FREQ_GPS, 0.0,
+				new CACodeGenerator(prns[p]));
+			const vector<float>& replica = table.replica(sampleRates[r], n);
+			CPPUNIT_ASSERT_EQUAL(n, replica.size());
+			for (size_t k = 0; k < n; k++)
+			{
+				CPPUNIT_ASSERT_EQUAL(cc.getCode() ? 1.0f : -1.0f, replica[k]);
+				cc.tick();
+			}
+		}
+	}
+
+	CPPUNIT_ASSERT_THROW(CACodeTable::get(0), InvalidParameter);
+	CPPUNIT_ASSERT_THROW(CACodeTable::get(38), InvalidParameter);
+}
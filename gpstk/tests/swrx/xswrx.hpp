@@ -0,0 +1,75 @@
+// file: xswrx.hpp
+
+//============================================================================
+//
+//  This file is part of GPSTk, the GPS Toolkit.
+//
+//  The GPSTk is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as published
+//  by the Free Software Foundation; either version 2.1 of the License, or
+//  any later version.
+//
+//  The GPSTk is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with GPSTk; if not, write to the Free Software Foundation,
+//  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110, USA
+//
+//  Copyright 2009, The University of Texas at Austin
+//
+//============================================================================
+
+
+
+#ifndef XSWRX_HPP
+#define XSWRX_HPP
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <complex>
+#include <string>
+#include <vector>
+
+#include "IQStream.hpp"
+#include "EMLTracker.hpp"
+
+
+using namespace std;
+
+
+class xswrx: public CPPUNIT_NS :: TestFixture
+{
+	//Test Fixture information, e.g. what tests will be run
+	CPPUNIT_TEST_SUITE (xswrx);
+	CPPUNIT_TEST (iqStreamTest);
+	CPPUNIT_TEST (trackerTest);
+	CPPUNIT_TEST (renderTest);
+	CPPUNIT_TEST (caCodeTableTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+	public:
+		void setUp (void); //Sets up test enviornment
+
+	protected:
+		void iqStreamTest (void);
+		void trackerTest (void);
+		void renderTest (void);
+		void caCodeTableTest (void);
+
+	private:
+		unsigned long seed;
+		double random (void);
+		double gaussian (void);
+		void simulate (vector< complex<float> >& samples, double sampleRate,
+			double interFreq, int prn, double offset, double doppler);
+		gpstk::IQStream* newStream (char quantization, const char* fn,
+			ios::openmode mode);
+		void readAll (gpstk::IQStream& s, size_t block, vector< complex<float> >& v);
+
+};
+
+#endif